@@ -0,0 +1,63 @@
+#version 450
+
+layout(local_size_x = 64) in;
+
+// Экземпляр для отсечения на GPU. Должен совпадать с VulkanCullInstance.
+struct cull_instance {
+	mat4 model;
+	vec4 bounds;  // xyz — центр в локальных координатах, w — радиус.
+	uint index_count;
+	uint first_index;
+	int vertex_offset;
+	uint padding;
+};
+
+// Должна совпадать с VkDrawIndexedIndirectCommand.
+struct draw_command {
+	uint index_count;
+	uint instance_count;
+	uint first_index;
+	int vertex_offset;
+	uint first_instance;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer cull_instances {
+	cull_instance instances[];
+};
+
+layout(std430, set = 0, binding = 1) writeonly buffer draw_commands {
+	draw_command commands[];
+};
+
+layout(push_constant) uniform push_constants {
+	// Плоскости пирамиды: xyz — нормаль внутрь, w — смещение. Точка внутри, если dot(xyz, p) + w >= 0.
+	vec4 planes[6];  // 96 байт
+	uint count;
+} u_push_constants;
+
+void main() {
+	uint i = gl_GlobalInvocationID.x;
+	if (i >= u_push_constants.count) {
+		return;
+	}
+
+	cull_instance instance = instances[i];
+
+	// Сфера в мировом пространстве: центр переносится матрицей модели, радиус умножается на наибольший масштаб.
+	vec3 center = vec3(instance.model * vec4(instance.bounds.xyz, 1.0));
+	float scale = max(max(length(instance.model[0].xyz), length(instance.model[1].xyz)), length(instance.model[2].xyz));
+	float radius = instance.bounds.w * scale;
+
+	bool visible = true;
+	for (int p = 0; p < 6; ++p) {
+		visible = visible && dot(u_push_constants.planes[p].xyz, center) + u_push_constants.planes[p].w > -radius;
+	}
+
+	// Команда пишется для каждого экземпляра, отсеченный рисуется с нулем копий. Без уплотнения
+	// не нужен vkCmdDrawIndexedIndirectCount, поэтому путь работает и на программных реализациях вроде lavapipe.
+	commands[i].index_count = instance.index_count;
+	commands[i].instance_count = visible ? 1 : 0;
+	commands[i].first_index = instance.first_index;
+	commands[i].vertex_offset = instance.vertex_offset;
+	commands[i].first_instance = i;
+}
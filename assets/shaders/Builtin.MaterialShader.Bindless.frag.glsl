@@ -0,0 +1,180 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) out vec4 out_colour;
+
+struct directional_light {
+    vec4 colour;
+    vec3 direction;
+};
+
+struct point_light {
+    vec4 colour;
+    vec3 position;
+    // Обычно 1, следите за тем, чтобы знаменатель никогда не был меньше 1.
+    float constant_f;
+    // Линейно снижает интенсивность света
+    float linear;
+    // Заставляет свет падать медленнее на больших расстояниях.
+    float quadratic;
+};
+
+const int MAX_POINT_LIGHTS = 10;
+
+// Записи материалов всех экземпляров. Запись начинается со слова material_word: униформы экземпляра
+// в порядке .shadercfg без выравнивания (dir_light, p_lights, properties, num_p_lights), за ними индексы текстур.
+layout(std430, set = 1, binding = 0) readonly buffer material_buffer {
+    uint words[];
+} materials;
+
+// Общая таблица текстур режима без привязки.
+layout(set = 2, binding = 0) uniform texture2D textures[];
+layout(set = 2, binding = 1) uniform sampler samplers[];
+
+layout(push_constant) uniform push_constants {
+    layout(offset = 124) uint material_word;
+} u_push_constants;
+
+// Смещения полей записи в словах.
+const uint DIR_LIGHT_WORD = 0;        // struct32: colour, direction.
+const uint P_LIGHTS_WORD = 8;         // struct480: 10 источников по 12 слов.
+const uint P_LIGHT_WORDS = 12;
+const uint PROPERTIES_WORD = 128;     // struct32: diffuse_colour, padding, specular.
+const uint NUM_P_LIGHTS_WORD = 136;
+const uint TEXTURES_WORD = 137;
+
+// Samplers, diffuse, spec
+const uint SAMP_DIFFUSE = 0;
+const uint SAMP_SPECULAR = 1;
+const uint SAMP_NORMAL = 2;
+
+layout(location = 0) flat in int in_mode;
+// Data Transfer Object
+layout(location = 1) in struct dto {
+    vec4 ambient;
+	vec2 tex_coord;
+    vec3 normal;
+    vec3 view_position;
+	vec3 frag_position;
+    vec4 colour;
+	vec3 tangent;
+} in_dto;
+
+mat3 TBN;
+vec4 diffuse_colour;
+float specular_power;
+
+uint material_uint(uint word) {
+    return materials.words[u_push_constants.material_word + word];
+}
+
+float material_float(uint word) {
+    return uintBitsToFloat(material_uint(word));
+}
+
+vec3 material_vec3(uint word) {
+    return vec3(material_float(word), material_float(word + 1), material_float(word + 2));
+}
+
+vec4 material_vec4(uint word) {
+    return vec4(material_vec3(word), material_float(word + 3));
+}
+
+vec4 material_texture(uint index, vec2 uv) {
+    // Младшие 16 бит — слот изображения, старшие — сэмплер.
+    uint packed = material_uint(TEXTURES_WORD + index);
+    return texture(sampler2D(textures[nonuniformEXT(packed & 0xFFFFu)], samplers[nonuniformEXT(packed >> 16)]), uv);
+}
+
+point_light material_point_light(uint index) {
+    uint base = P_LIGHTS_WORD + index * P_LIGHT_WORDS;
+    point_light light;
+    light.colour = material_vec4(base);
+    light.position = material_vec3(base + 4);
+    light.constant_f = material_float(base + 7);
+    light.linear = material_float(base + 8);
+    light.quadratic = material_float(base + 9);
+    return light;
+}
+
+vec4 calculate_directional_light(directional_light light, vec3 normal, vec3 view_direction);
+vec4 calculate_point_light(point_light light, vec3 normal, vec3 frag_position, vec3 view_direction);
+
+void main() {
+    diffuse_colour = material_vec4(PROPERTIES_WORD);
+    specular_power = material_float(PROPERTIES_WORD + 7);
+
+    vec3 normal = in_dto.normal;
+    vec3 tangent = in_dto.tangent;
+    tangent = (tangent - dot(tangent, normal) *  normal);
+    vec3 bitangent = cross(in_dto.normal, in_dto.tangent);
+    TBN = mat3(tangent, bitangent, normal);
+
+    // Обновите нормаль, чтобы использовать образец из карты нормалей.
+    vec3 localNormal = 2.0 * material_texture(SAMP_NORMAL, in_dto.tex_coord).rgb - 1.0;
+    normal = normalize(TBN * localNormal);
+
+    if(in_mode == 0 || in_mode == 1) {
+        vec3 view_direction = normalize(in_dto.view_position - in_dto.frag_position);
+
+        directional_light dir_light;
+        dir_light.colour = material_vec4(DIR_LIGHT_WORD);
+        dir_light.direction = material_vec3(DIR_LIGHT_WORD + 4);
+        out_colour = calculate_directional_light(dir_light, normal, view_direction);
+
+        int num_p_lights = min(int(material_uint(NUM_P_LIGHTS_WORD)), MAX_POINT_LIGHTS);
+        for(int i = 0; i < num_p_lights; ++i) {
+            out_colour += calculate_point_light(material_point_light(uint(i)), normal, in_dto.frag_position, view_direction);
+        }
+    } else if(in_mode == 2) {
+        out_colour = vec4(abs(normal), 1.0);
+    }
+}
+
+vec4 calculate_directional_light(directional_light light, vec3 normal, vec3 view_direction) {
+    float diffuse_factor = max(dot(normal, -light.direction.xyz), 0.0);
+
+    vec3 half_direction = normalize(view_direction - light.direction.xyz);
+    float specular_factor = pow(max(dot(half_direction, normal), 0.0), specular_power);
+
+    vec4 diff_samp = material_texture(SAMP_DIFFUSE, in_dto.tex_coord);
+    vec4 ambient = vec4(vec3(in_dto.ambient * diffuse_colour), diff_samp.a);
+    vec4 diffuse = vec4(vec3(light.colour * diffuse_factor), diff_samp.a);
+    vec4 specular = vec4(vec3(light.colour * specular_factor), diff_samp.a);
+    
+    if(in_mode == 0) {
+        diffuse *= diff_samp;
+        ambient *= diff_samp;
+        specular *= vec4(material_texture(SAMP_SPECULAR, in_dto.tex_coord).rgb, diffuse.a);
+    }
+
+    return (ambient + diffuse + specular);
+}
+
+vec4 calculate_point_light(point_light light, vec3 normal, vec3 frag_position, vec3 view_direction) {
+    vec3 light_direction =  normalize(light.position.xyz - frag_position);
+    float diff = max(dot(normal, light_direction), 0.0);
+
+    vec3 reflect_direction = reflect(-light_direction, normal);
+    float spec = pow(max(dot(view_direction, reflect_direction), 0.0), specular_power);
+
+    // Рассчитайте затухание или затухание света с расстоянием.
+    float distance = length(light.position.xyz - frag_position);
+    float attenuation = 1.0 / (light.constant_f + light.linear * distance + light.quadratic * (distance * distance));
+
+    vec4 ambient  = in_dto.ambient;
+    vec4 diffuse  = light.colour * diff;
+    vec4 specular = light.colour * spec;
+    
+    if(in_mode == 0) {
+        vec4 diff_samp = material_texture(SAMP_DIFFUSE, in_dto.tex_coord);
+        diffuse *= diff_samp;
+        ambient *= diff_samp;
+        specular *= vec4(material_texture(SAMP_SPECULAR, in_dto.tex_coord).rgb, diffuse.a);
+    }
+
+    ambient *= attenuation;
+    diffuse *= attenuation;
+    specular *= attenuation;
+    return (ambient + diffuse + specular);
+}
@@ -0,0 +1,63 @@
+#version 450
+
+layout(location = 0) in vec3 in_position;
+layout(location = 1) in vec3 in_normal;
+layout(location = 2) in vec2 in_texcoord;
+layout(location = 3) in vec4 in_colour;
+layout(location = 4) in vec3 in_tangent;
+
+layout(set = 0, binding = 0) uniform global_uniform_object {
+    mat4 projection;
+	mat4 view;
+	vec4 ambient_colour;
+	vec3 view_position;
+	int mode;
+} global_ubo;
+
+// Экземпляр для отсечения на GPU. Должен совпадать с VulkanCullInstance.
+struct cull_instance {
+	mat4 model;
+	vec4 bounds;  // xyz — центр в локальных координатах, w — радиус.
+	uint index_count;
+	uint first_index;
+	int vertex_offset;
+	uint padding;
+};
+
+// Набор экземпляров следует за наборами шейдера материала: 0 — глобальный, 1 — экземпляр.
+layout(std430, set = 2, binding = 0) readonly buffer cull_instances {
+	cull_instance instances[];
+};
+
+layout(location = 0) out int out_mode;
+
+// Объект передачи данных
+layout(location = 1) out struct dto {
+	vec4 ambient;
+	vec2 tex_coord;
+	vec3 normal;
+	vec3 view_position;
+	vec3 frag_position;
+	vec4 colour;
+	vec3 tangent; // vec4 tangent;
+} out_dto;
+
+
+void main() {
+	// Команда отрисовки экземпляра i записана с firstInstance = i.
+	mat4 model = instances[gl_InstanceIndex].model;
+
+	out_dto.tex_coord = in_texcoord;
+	out_dto.colour = in_colour;
+	// Положение фрагмента в мировом пространстве.
+	out_dto.frag_position = vec3(model * vec4(in_position, 1.0));
+	// Скопируйте нормальный вариант.
+	mat3 m3_model = mat3(model);
+	out_dto.normal = normalize(m3_model * in_normal);
+	out_dto.tangent = normalize(m3_model * in_tangent);
+	out_dto.ambient = global_ubo.ambient_colour;
+	out_dto.view_position = global_ubo.view_position;
+    gl_Position = global_ubo.projection * global_ubo.view * model * vec4(in_position, 1.0);
+
+	out_mode = global_ubo.mode;
+}
@@ -0,0 +1,42 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) out vec4 out_colour;
+
+// Записи материалов всех экземпляров. Запись начинается со слова material_word:
+// униформы экземпляра (properties), за ними индексы текстур.
+layout(std430, set = 1, binding = 0) readonly buffer material_buffer {
+    uint words[];
+} materials;
+
+// Общая таблица текстур режима без привязки.
+layout(set = 2, binding = 0) uniform texture2D textures[];
+layout(set = 2, binding = 1) uniform sampler samplers[];
+
+layout(push_constant) uniform push_constants {
+    layout(offset = 124) uint material_word;
+} u_push_constants;
+
+// Samplers
+const uint SAMP_DIFFUSE = 0;
+const uint PROPERTIES_WORDS = 4; // ui_properties: vec4 diffuse_colour.
+
+// Объект передачи данных
+layout(location = 1) in struct dto {
+	vec2 tex_coord;
+} in_dto;
+
+vec4 material_vec4(uint word) {
+    uint base = u_push_constants.material_word + word;
+    return uintBitsToFloat(uvec4(materials.words[base], materials.words[base + 1], materials.words[base + 2], materials.words[base + 3]));
+}
+
+vec4 material_texture(uint index, vec2 uv) {
+    // Младшие 16 бит — слот изображения, старшие — сэмплер.
+    uint packed = materials.words[u_push_constants.material_word + PROPERTIES_WORDS + index];
+    return texture(sampler2D(textures[nonuniformEXT(packed & 0xFFFFu)], samplers[nonuniformEXT(packed >> 16)]), uv);
+}
+
+void main() {
+    out_colour = material_vec4(0) * material_texture(SAMP_DIFFUSE, in_dto.tex_coord);
+}
@@ -0,0 +1,54 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) out vec4 out_colour;
+
+// Записи материалов всех экземпляров. Запись начинается со слова material_word:
+// униформы экземпляра (properties), за ними индексы текстур.
+layout(std430, set = 1, binding = 0) readonly buffer material_buffer {
+    uint words[];
+} materials;
+
+// Общая таблица текстур режима без привязки.
+layout(set = 2, binding = 0) uniform texture2D textures[];
+layout(set = 2, binding = 1) uniform sampler samplers[];
+
+layout(push_constant) uniform push_constants {
+    layout(offset = 124) uint material_word;
+} u_push_constants;
+
+// Samplers
+const uint SAMP_DIFFUSE = 0;
+const uint PROPERTIES_WORDS = 4; // ui_properties: vec4 diffuse_colour.
+
+// Ширина поля расстояний в пикселях атласа, FONT_MSDF_RANGE.
+const float PX_RANGE = 4.0;
+
+// Объект передачи данных
+layout(location = 1) in struct dto {
+	vec2 tex_coord;
+} in_dto;
+
+vec4 material_vec4(uint word) {
+    uint base = u_push_constants.material_word + word;
+    return uintBitsToFloat(uvec4(materials.words[base], materials.words[base + 1], materials.words[base + 2], materials.words[base + 3]));
+}
+
+float median(vec3 v) {
+    return max(min(v.r, v.g), min(max(v.r, v.g), v.b));
+}
+
+void main() {
+    // Младшие 16 бит — слот изображения, старшие — сэмплер.
+    uint packed = materials.words[u_push_constants.material_word + PROPERTIES_WORDS + SAMP_DIFFUSE];
+    uint image = packed & 0xFFFFu;
+    vec4 msdf = texture(sampler2D(textures[nonuniformEXT(image)], samplers[nonuniformEXT(packed >> 16)]), in_dto.tex_coord);
+
+    // Медиана каналов — расстояние до края; переводится в пиксели экрана.
+    vec2 unit_range = vec2(PX_RANGE) / vec2(textureSize(textures[nonuniformEXT(image)], 0));
+    vec2 screen_tex_size = vec2(1.0) / fwidth(in_dto.tex_coord);
+    float screen_px_range = max(0.5 * dot(unit_range, screen_tex_size), 1.0);
+    float opacity = clamp(screen_px_range * (median(msdf.rgb) - 0.5) + 0.5, 0.0, 1.0);
+    vec4 diffuse = material_vec4(0);
+    out_colour = vec4(diffuse.rgb, diffuse.a * opacity);
+}
@@ -0,0 +1,39 @@
+#version 450
+
+layout(location = 0) out vec4 out_colour;
+
+struct ui_properties {
+    vec4 diffuse_colour;
+};
+
+layout(set = 1, binding = 0) uniform local_uniform_object {
+    ui_properties properties;
+} object_ubo;
+
+// Samplers
+const int SAMP_DIFFUSE = 0;
+layout(set = 1, binding = 1) uniform sampler2D samplers[1];
+
+// Ширина поля расстояний в пикселях атласа, FONT_MSDF_RANGE.
+const float PX_RANGE = 4.0;
+
+// Объект передачи данных
+layout(location = 1) in struct dto {
+	vec2 tex_coord;
+} in_dto;
+
+float median(vec3 v) {
+    return max(min(v.r, v.g), min(max(v.r, v.g), v.b));
+}
+
+void main() {
+    // Медиана каналов — расстояние до края с острыми углами. Переводится в пиксели экрана, чтобы край оставался
+    // шириной в пиксель при любом размере текста.
+    vec2 unit_range = vec2(PX_RANGE) / vec2(textureSize(samplers[SAMP_DIFFUSE], 0));
+    vec2 screen_tex_size = vec2(1.0) / fwidth(in_dto.tex_coord);
+    float screen_px_range = max(0.5 * dot(unit_range, screen_tex_size), 1.0);
+    float dist = median(texture(samplers[SAMP_DIFFUSE], in_dto.tex_coord).rgb) - 0.5;
+    float opacity = clamp(screen_px_range * dist + 0.5, 0.0, 1.0);
+    vec4 diffuse = object_ubo.properties.diffuse_colour;
+    out_colour = vec4(diffuse.rgb, diffuse.a * opacity);
+}
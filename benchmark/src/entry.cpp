@@ -0,0 +1,507 @@
+#include <entry.h>
+
+#include "platform/platform.hpp"
+#include <core/clock.h>
+#include <core/event.h>
+#include <core/mvar.h>
+#include <math/math.h>
+#include <renderer/rendering_system.h>
+#include <renderer/render_view.h>
+#include <renderer/ui_batch.h>
+#include <resources/ui_text.h>
+#include <systems/camera_system.hpp>
+#include <systems/font_system.h>
+#include <utils/sort.h>
+#include "renderer/headless/headless_api.h"
+#include <new>
+
+using PFN_PluginCreate = RendererPlugin*(*)();
+
+constexpr u32 BENCHMARK_WARMUP_FRAMES = 120;    // Кадры на загрузку сцены и прогрев кешей, не входят в замеры.
+constexpr u32 BENCHMARK_PATH_FRAMES   = 1000;   // Кадры на каждый маршрут камеры.
+constexpr u32 BENCHMARK_MAX_VIEWS     = 8;      // Максимальное количество представлений, для которых ведется учет.
+constexpr u32 BENCHMARK_UI_TEXTS      = 5000;   // Тексты интерфейса в замере пакета текста, из них каждый кадр меняется один.
+constexpr u32 BENCHMARK_UI_COLUMNS    = 50;     // Тексты в строке сетки замера пакета текста.
+constexpr u32 BENCHMARK_UI_FRAMES     = 200;    // Кадры замера пакета текста в каждом режиме.
+constexpr u32 BENCHMARK_LAYOUT_SIZE   = 100 * 1024; // Размер текста замера раскладки в байтах.
+constexpr u32 BENCHMARK_LAYOUT_RUNS   = 20;     // Полные раскладки текста в замере.
+
+// Размеры растровых атласов, с которыми сравнивается один атлас MSDF.
+static const u16 BenchmarkFontSizes[] = { 12, 14, 16, 18, 24, 32, 48, 64 };
+
+/// @brief Маршруты камеры, по которым проходит замер.
+namespace BenchmarkPath
+{
+    enum Type {
+        Orbit,       // Облет вокруг центра сцены.
+        FlyThrough,  // Пролет сквозь сцену по прямой.
+        Count
+    };
+
+    static const char* names[Count] = { "orbit", "fly-through" };
+}
+
+/// @brief Режимы записи команд, в которых проходит каждый маршрут.
+namespace BenchmarkMode
+{
+    enum Type {
+        Serial,      // Все представления записываются основным потоком.
+        Parallel,    // Группы представлений записываются в параллельных потоках.
+        Count
+    };
+
+    static const char* names[Count] = { "serial", "parallel" };
+}
+
+constexpr u32 BENCHMARK_SEGMENT_COUNT = BenchmarkPath::Count * BenchmarkMode::Count;
+
+// Группы представлений тестового стенда: мир, редактор мира, каркас, UI. Мир и редактор мира используют общий шейдер.
+static const u8 BenchmarkViewGroups[] = { 0, 0, 1, 2 };
+
+/// @brief Накопленные затраты на одно представление.
+struct BenchmarkView {
+    const char* name;
+    f64 total;
+    u32 count;
+};
+
+/// @brief Состояние замера. Функции игры оборачиваются, поэтому исходные указатели хранятся здесь.
+static struct BenchmarkState {
+    bool (*GameUpdate)(Application& app, const FrameData& rFrameData);
+    bool (*GamePrepareRenderPacket)(Application* app, RenderPacket& packet, FrameData& rFrameData);
+
+    Clock clock;
+    u32 frame;
+    f64 LastFrameStart;
+    Camera* camera;
+    HeadlessAPI* backend;
+
+    f64* FrameTimes;                        // Время кадров по отрезкам: BENCHMARK_SEGMENT_COUNT * BENCHMARK_PATH_FRAMES.
+    f64 PrepareTotal;                       // Суммарное время подготовки пакетов рендеринга.
+    BenchmarkMode::Type mode;               // Режим записи текущего отрезка.
+    bool ParallelRecorded;                  // Указывает, записывались ли представления параллельно хотя бы раз.
+    f64 RecordTotal[BenchmarkMode::Count];  // Суммарное время записи всех представлений в каждом режиме.
+    BenchmarkView views[BENCHMARK_MAX_VIEWS]; // Затраты по представлениям; измеряются только в последовательном режиме.
+    u64 commands;
+    u64 draws;
+    u64 primitives;
+} bench;
+
+static i32 CompareF64(void* a, void* b)
+{
+    const f64 x = *reinterpret_cast<f64*>(a);
+    const f64 y = *reinterpret_cast<f64*>(b);
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+/// @brief Возвращает процентиль отсортированной выборки.
+static f64 Percentile(const f64* sorted, u32 count, f64 p)
+{
+    u32 index = (u32)(p * (count - 1) + 0.5);
+    return sorted[index < count ? index : count - 1];
+}
+
+/// @brief Отрезок замера: маршрут камеры, пройденный в одном из режимов записи.
+MINLINE BenchmarkPath::Type SegmentPath(u32 segment) { return (BenchmarkPath::Type)(segment % BenchmarkPath::Count); }
+MINLINE BenchmarkMode::Type SegmentMode(u32 segment) { return (BenchmarkMode::Type)(segment / BenchmarkPath::Count); }
+
+/// @brief Устанавливает камеру в положение маршрута.
+/// @param path маршрут камеры.
+/// @param t положение на маршруте от 0 до 1.
+static void ApplyCameraPath(BenchmarkPath::Type path, f32 t)
+{
+    if (!bench.camera) {
+        return;
+    }
+
+    if (path == BenchmarkPath::Orbit) {
+        // Камера смотрит на центр сцены: поворот вперед (0, 0, -1) на угол рыскания angle направлен к началу координат.
+        const f32 angle = t * M_2PI;
+        const f32 radius = 30.F;
+        bench.camera->SetPosition(FVec3(radius * Math::sin(angle), 10.F, radius * Math::cos(angle)));
+        bench.camera->SetRotationEuler(FVec3(-15.F * M_DEG2RAD_MULTIPLIER, angle, 0.F));
+    } else {
+        bench.camera->SetPosition(FVec3(-40.F + 80.F * t, 5.F, 0.F));
+        bench.camera->SetRotationEuler(FVec3(0.F, -M_HALF_PI, 0.F));
+    }
+}
+
+/// @brief Замер сборки пакета текста интерфейса: сетка из BENCHMARK_UI_TEXTS текстов, в которой каждый кадр меняется
+/// одна метка, с повторным использованием неизмененных текстов и с полной пересборкой (ui_retained = 0).
+static void ReportTextBatch()
+{
+    Text label {};
+    if (!label.Create("bench_ui_label", TextType::Bitmap, "Metrika 21px", 21, "0")) {
+        MWARN("  Замер пакета текста пропущен: не удалось создать метку.");
+        return;
+    }
+    label.SetPosition(FVec3(10.F, 10.F, 0.F));
+
+    // Остальные тексты — копии геометрии метки в ячейках сетки. Пакет только собирается и загружается,
+    // поэтому ресурсы шейдера и буферы самих текстов им не нужны.
+    const u32 CellCount = BENCHMARK_UI_TEXTS - 1;
+    auto cells = reinterpret_cast<Text*>(MemorySystem::Allocate(sizeof(Text) * CellCount, Memory::Game, true));
+    auto texts = MemorySystem::TAllocate<Text*>(Memory::Game, BENCHMARK_UI_TEXTS);
+    for (u32 i = 0; i < CellCount; ++i) {
+        auto cell = new(cells + i) Text();
+        cell->type = label.type;
+        cell->data = label.data;
+        cell->FontScale = label.FontScale;
+        cell->FontGeneration = label.FontGeneration;
+        cell->QuadCount = label.QuadCount;
+        cell->revision = 1;
+        cell->vertices.Resize(label.vertices.Length());
+        MemorySystem::CopyMem(cell->vertices.Data(), label.vertices.Data(), sizeof(Vertex2D) * label.vertices.Length());
+        cell->transform = Transform(FVec3(10.F + (i % BENCHMARK_UI_COLUMNS) * 25.F, 40.F + (i / BENCHMARK_UI_COLUMNS) * 7.F, 0.F));
+        texts[i] = cell;
+    }
+    texts[CellCount] = &label;
+
+    i32 PreviousMode = 1;
+    MVar::GetInt("ui_retained", PreviousMode);
+    static const char* ModeNames[2] = { "полная пересборка", "повторное использование" };
+    for (i32 mode = 0; mode < 2; ++mode) {
+        MVar::SetInt("ui_retained", mode);
+        UiBatch batch;
+        Clock timer;
+        f64 total = 0;
+        u64 reused = 0;
+        u32 draws = 0;
+        for (u32 frame = 0; frame < BENCHMARK_UI_FRAMES; ++frame) {
+            char buffer[16]{};
+            MString::Format(buffer, "%u", frame);
+            label.SetText(buffer);
+
+            timer.Start();
+            batch.Build(nullptr, 0, texts, BENCHMARK_UI_TEXTS, false);
+            batch.Upload(frame);
+            timer.Update();
+            total += timer.elapsed;
+            reused += batch.ReusedVertexCount / 4;
+            draws = batch.commands.Length();
+        }
+        MINFO("  ui text %-24s %.3f мс/кадр, %u четырехугольников, %llu повторно использовано/кадр, %u отрисовок",
+              ModeNames[mode], total / BENCHMARK_UI_FRAMES * 1000.0, batch.indices.Length() / 6, reused / BENCHMARK_UI_FRAMES, draws);
+        batch.Destroy();
+    }
+    MVar::SetInt("ui_retained", PreviousMode);
+
+    for (u32 i = 0; i < CellCount; ++i) {
+        cells[i].vertices.Destroy();
+    }
+    MemorySystem::Free(cells, sizeof(Text) * CellCount, Memory::Game);
+    MemorySystem::Free(texts, sizeof(Text*) * BENCHMARK_UI_TEXTS, Memory::Game);
+    label.Destroy();
+}
+
+static u32 BenchmarkEncodeUtf8(i32 codepoint, char* out)
+{
+    if (codepoint < 0x80) {
+        out[0] = (char)codepoint;
+        return 1;
+    }
+    if (codepoint < 0x800) {
+        out[0] = (char)(0xC0 | (codepoint >> 6));
+        out[1] = (char)(0x80 | (codepoint & 0x3F));
+        return 2;
+    }
+    if (codepoint < 0x10000) {
+        out[0] = (char)(0xE0 | (codepoint >> 12));
+        out[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (codepoint & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (codepoint >> 18));
+    out[1] = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (codepoint & 0x3F));
+    return 4;
+}
+
+/// @brief Заполняет текст замера раскладки словами разных письменностей, в том числе символами, которых нет в шрифте.
+/// @param text буфер не меньше BENCHMARK_LAYOUT_SIZE + 4 байт.
+/// @return длина текста в байтах.
+static u32 BenchmarkLayoutTextCreate(char* text)
+{
+    u32 length = 0;
+    u32 seed = 12345;
+    while (length < BENCHMARK_LAYOUT_SIZE) {
+        seed = seed * 1664525 + 1013904223;
+        const u32 script = (seed >> 24) % 8;
+        const u32 WordLength = 2 + (seed >> 16) % 8;
+        for (u32 i = 0; i < WordLength && length < BENCHMARK_LAYOUT_SIZE; ++i) {
+            seed = seed * 1664525 + 1013904223;
+            const u32 r = seed >> 8;
+            i32 codepoint;
+            switch (script) {
+                case 0: case 1: case 2: codepoint = r % 52 < 26 ? 'A' + r % 52 : 'a' + r % 52 - 26; break;
+                case 3: codepoint = 0xC0 + r % 64; break;
+                case 4: case 5: codepoint = 0x410 + r % 64; break;
+                case 6: codepoint = 0x4E00 + r % 3200; break;
+                default: codepoint = 0x1F600 + r % 64; break;   // Эмодзи в шрифте нет, они раскладываются неизвестным глифом.
+            }
+            length += BenchmarkEncodeUtf8(codepoint, text + length);
+        }
+        if (length < BENCHMARK_LAYOUT_SIZE) {
+            text[length++] = ' ';
+        }
+    }
+    text[length] = 0;
+    return length;
+}
+
+/// @brief Замер раскладки текста: 100 КБ смешанного текста (латиница, кириллица, CJK, отсутствующие в шрифте символы)
+/// раскладываются системным шрифтом через Text::SetText — поиск глифов и кернинга, построение и загрузка вершин.
+static void ReportTextLayout()
+{
+    Text text {};
+    if (!text.Create("bench_layout_text", TextType::System, "Noto Sans", 20, "0")) {
+        MWARN("  Замер раскладки текста пропущен: не удалось создать текст.");
+        return;
+    }
+
+    char* contents = reinterpret_cast<char*>(MemorySystem::Allocate(BENCHMARK_LAYOUT_SIZE + 4, Memory::Game, true));
+    const u32 length = BenchmarkLayoutTextCreate(contents);
+
+    // Первая раскладка добавляет глифы в атлас шрифта и не входит в замер.
+    text.SetText(contents);
+
+    // Первый байт меняется каждый раз, поэтому текст раскладывается заново целиком.
+    Clock timer;
+    f64 total = 0;
+    for (u32 run = 0; run < BENCHMARK_LAYOUT_RUNS; ++run) {
+        contents[0] = run % 2 ? 'A' : 'B';
+        timer.Start();
+        text.SetText(contents);
+        timer.Update();
+        total += timer.elapsed;
+    }
+    MINFO("  text layout %u КБ, %u четырехугольников: %.3f мс/раскладку", length / 1024, text.QuadCount, total / BENCHMARK_LAYOUT_RUNS * 1000.0);
+
+    MemorySystem::Free(contents, BENCHMARK_LAYOUT_SIZE + 4, Memory::Game);
+    text.Destroy();
+}
+
+static void Report()
+{
+    const u32 count = BENCHMARK_PATH_FRAMES;
+
+    MINFO("Результаты замера (headless, %u кадров на маршрут):", count);
+    if (!bench.ParallelRecorded) {
+        MINFO("  Рендерер не поддерживает параллельную запись, режим parallel совпадает с serial.");
+    }
+    for (u32 segment = 0; segment < BENCHMARK_SEGMENT_COUNT; ++segment) {
+        f64* times = bench.FrameTimes + segment * count;
+        Moon::QuickSort(sizeof(f64), times, 0, count - 1, CompareF64);
+
+        f64 sum = 0;
+        for (u32 i = 0; i < count; ++i) {
+            sum += times[i];
+        }
+        MINFO("  %-12s %-9s p50 %.3f мс, p99 %.3f мс, среднее %.3f мс",
+              BenchmarkPath::names[SegmentPath(segment)], BenchmarkMode::names[SegmentMode(segment)],
+              Percentile(times, count, 0.5) * 1000.0, Percentile(times, count, 0.99) * 1000.0, sum / count * 1000.0);
+    }
+
+    const u32 measured = count * BENCHMARK_SEGMENT_COUNT;
+    const u32 MeasuredPerMode = count * BenchmarkPath::Count;
+    MINFO("  %-12s %.3f мс/кадр", "prepare", bench.PrepareTotal / measured * 1000.0);
+    for (u32 m = 0; m < BenchmarkMode::Count; ++m) {
+        MINFO("  %-12s %-9s %.3f мс/кадр", "record", BenchmarkMode::names[m], bench.RecordTotal[m] / MeasuredPerMode * 1000.0);
+    }
+    for (u32 i = 0; i < BENCHMARK_MAX_VIEWS; ++i) {
+        const auto& view = bench.views[i];
+        if (view.name && view.count) {
+            MINFO("  %-12s %.3f мс/кадр", view.name, view.total / view.count * 1000.0);
+        }
+    }
+    MINFO("  Команд %llu, отрисовок %llu, примитивов %llu на кадр.", bench.commands / measured, bench.draws / measured, bench.primitives / measured);
+
+    // Память атласов и время запекания шрифта: растровые атласы по размерам против одного атласа MSDF.
+    SystemFontConfig FontConfig { MString("Metrika"), 21, MString("Metrika") };
+    if (FontSystem::LoadFont(FontConfig)) {
+        FontSystem::ReportBakeModes("Metrika", BenchmarkFontSizes, sizeof(BenchmarkFontSizes) / sizeof(BenchmarkFontSizes[0]));
+    }
+
+    ReportTextBatch();
+    ReportTextLayout();
+}
+
+constexpr u32 BENCHMARK_TOTAL_FRAMES = BENCHMARK_WARMUP_FRAMES + BENCHMARK_PATH_FRAMES * BENCHMARK_SEGMENT_COUNT;
+
+/// @brief Возвращает true, если текущий кадр входит в замер.
+/// @note Счетчик кадров увеличивается в конце обновления, поэтому при подготовке пакета и рендеринге он уже указывает на следующий кадр.
+MINLINE bool Measuring() { return bench.frame > BENCHMARK_WARMUP_FRAMES && bench.frame <= BENCHMARK_TOTAL_FRAMES; }
+
+/// @brief Возвращает время с начала замера в секундах.
+MINLINE f64 Now() { bench.clock.Update(); return bench.clock.elapsed; }
+
+bool BenchmarkUpdate(Application& app, const FrameData& rFrameData)
+{
+    const f64 now = Now();
+    // Время предыдущего кадра считается между началами соседних обновлений, то есть включает весь цикл движка.
+    if (Measuring()) {
+        bench.FrameTimes[bench.frame - 1 - BENCHMARK_WARMUP_FRAMES] = now - bench.LastFrameStart;
+    }
+    bench.LastFrameStart = now;
+
+    if (bench.frame >= BENCHMARK_TOTAL_FRAMES) {
+        if (bench.frame == BENCHMARK_TOTAL_FRAMES) {
+            Report();
+            EventContext context = {};
+            EventSystem::Fire(EventSystem::ApplicationQuit, nullptr, context);
+            bench.frame++;
+        }
+        return true;
+    }
+
+    if (bench.frame == 0) {
+        // Загрузить тестовую сцену.
+        EventContext context = {};
+        EventSystem::Fire(EventSystem::DEBUG1, &app, context);
+        bench.camera = CameraSystem::Acquire("world");
+    }
+
+    if (!bench.GameUpdate(app, rFrameData)) {
+        return false;
+    }
+
+    // Положение камеры задается после обновления игры, чтобы ввод не влиял на маршрут.
+    const u32 PathFrame = bench.frame >= BENCHMARK_WARMUP_FRAMES ? bench.frame - BENCHMARK_WARMUP_FRAMES : 0;
+    const u32 segment = PathFrame / BENCHMARK_PATH_FRAMES;
+    ApplyCameraPath(SegmentPath(segment), (f32)(PathFrame % BENCHMARK_PATH_FRAMES) / BENCHMARK_PATH_FRAMES);
+    if (PathFrame % BENCHMARK_PATH_FRAMES == 0 && bench.mode != SegmentMode(segment)) {
+        bench.mode = SegmentMode(segment);
+        RenderingSystem::SetMultithreadedRecording(bench.mode == BenchmarkMode::Parallel);
+    }
+
+    bench.frame++;
+    return true;
+}
+
+bool BenchmarkPrepareRenderPacket(Application* app, RenderPacket& packet, FrameData& rFrameData)
+{
+    const f64 start = Now();
+    const bool result = bench.GamePrepareRenderPacket(app, packet, rFrameData);
+    if (Measuring()) {
+        bench.PrepareTotal += Now() - start;
+    }
+    return result;
+}
+
+bool BenchmarkRender(Application& app, RenderPacket& packet, FrameData& rFrameData)
+{
+    if (!RenderingSystem::PrepareFrame(rFrameData)) {
+        return true;
+    }
+
+    RenderingSystem::Begin(rFrameData);
+
+    const f64 RecordStart = Now();
+    if (RenderingSystem::MultithreadedRecordingEnabled() && packet.ViewCount == sizeof(BenchmarkViewGroups)) {
+        // Представления записываются параллельно, поэтому измеряется только общее время.
+        RenderingSystem::RenderViews(packet.views, BenchmarkViewGroups, packet.ViewCount, rFrameData);
+        if (Measuring()) {
+            bench.RecordTotal[bench.mode] += Now() - RecordStart;
+            bench.ParallelRecorded = true;
+        }
+    } else {
+        for (u32 i = 0; i < packet.ViewCount && i < BENCHMARK_MAX_VIEWS; ++i) {
+            auto& ViewPacket = packet.views[i];
+            const f64 start = Now();
+            ViewPacket.view->Render(ViewPacket.view, ViewPacket, rFrameData);
+            if (Measuring()) {
+                auto& view = bench.views[i];
+                view.name = ViewPacket.view->name;
+                view.total += Now() - start;
+                view.count++;
+            }
+        }
+        if (Measuring()) {
+            bench.RecordTotal[bench.mode] += Now() - RecordStart;
+        }
+    }
+
+    RenderingSystem::End(rFrameData);
+
+    if (Measuring()) {
+        const auto& stats = bench.backend->LastFrameStats();
+        bench.commands += stats.commands;
+        bench.draws += stats.draws;
+        bench.primitives += stats.primitives;
+    }
+
+    return RenderingSystem::Present(rFrameData);
+}
+
+bool LoadGameLib(Application& app)
+{
+    // Библиотека загружается без копии: горячая перезагрузка во время замера не нужна.
+    if (!PlatformDynamicLibraryLoad("testbed_lib", app.GameLibrary)) {
+        return false;
+    }
+
+    const char* names[] = {
+        "ApplicationBoot", "ApplicationInitialize", "ApplicationUpdate", "ApplicationPrepareRenderPacket", "ApplicationRender",
+        "ApplicationOnResize", "ApplicationShutdown", "ApplicationLibOnLoad", "ApplicationLibOnUnload"
+    };
+    for (auto name : names) {
+        if (!PlatformDynamicLibraryLoadFunction(name, app.GameLibrary)) {
+            return false;
+        }
+    }
+
+    // назначить указатели функций
+    app.Boot = (bool(*)(Application&))app.GameLibrary.functions[0].pfn;
+    app.Initialize = (bool(*)(Application&))app.GameLibrary.functions[1].pfn;
+    bench.GameUpdate = (bool(*)(Application&, const FrameData&))app.GameLibrary.functions[2].pfn;
+    bench.GamePrepareRenderPacket = (bool(*)(Application*, RenderPacket&, FrameData&))app.GameLibrary.functions[3].pfn;
+    app.OnResize = (void(*)(Application&, u32, u32))app.GameLibrary.functions[5].pfn;
+    app.Shutdown = (void(*)(Application&))app.GameLibrary.functions[6].pfn;
+    app.LibOnLoad = (void(*)(Application&))app.GameLibrary.functions[7].pfn;
+    app.LibOnUnload = (void(*)(Application&))app.GameLibrary.functions[8].pfn;
+
+    // Обновление, подготовка пакета и рендеринг оборачиваются для замеров.
+    app.Update = BenchmarkUpdate;
+    app.PrepareRenderPacket = BenchmarkPrepareRenderPacket;
+    app.Render = BenchmarkRender;
+
+    app.LibOnLoad(app);
+
+    return true;
+}
+
+bool CreateApplication(Application& OutApplication)
+{
+    OutApplication.AppConfig.StartPosX = 100;
+    OutApplication.AppConfig.StartPosY = 100;
+    OutApplication.AppConfig.StartWidth = 1280;
+    OutApplication.AppConfig.StartHeight = 720;
+    OutApplication.AppConfig.name = "Moon Engine Benchmark";
+    OutApplication.AppConfig.FrameAllocatorSize = MEBIBYTES(64);
+
+    if (!LoadGameLib(OutApplication)) {
+        MERROR("Загрузка библиотеки игры не удалась!");
+        return false;
+    }
+
+    if (!PlatformDynamicLibraryLoad("headless_renderer", OutApplication.RendererLibrary)) {
+        return false;
+    }
+
+    if (!PlatformDynamicLibraryLoadFunction("PluginCreate", OutApplication.RendererLibrary)) {
+        return false;
+    }
+    auto PluginCreate = reinterpret_cast<PFN_PluginCreate>(OutApplication.RendererLibrary.functions[0].pfn);
+    OutApplication.AppConfig.plugin = PluginCreate();
+    bench.backend = static_cast<HeadlessAPI*>(OutApplication.AppConfig.plugin);
+
+    return true;
+}
+
+bool InitializeApplication(Application &app)
+{
+    bench.FrameTimes = reinterpret_cast<f64*>(MemorySystem::Allocate(sizeof(f64) * BENCHMARK_PATH_FRAMES * BENCHMARK_SEGMENT_COUNT, Memory::Game, true));
+    bench.clock.Start();
+    return true;
+}
@@ -52,6 +52,14 @@ then
 echo "Ошибка:"$errorlevel | sed -e "s/error/${txtred}error${txtrst}/g" && exit
 fi
 
+# Headless Renderer Lib
+make -f Makefile.library.mak $ACTION TARGET=$TARGET ASSEMBLY=headless_renderer VER_MAJOR=0 VER_MINOR=1 DO_VERSION=no ADDL_INC_FLAGS="-Iengine/src" ADDL_LINK_FLAGS="-lengine"
+ERRORLEVEL=$?
+if [ $ERRORLEVEL -ne 0 ]
+then
+echo "Ошибка:"$errorlevel | sed -e "s/error/${txtred}error${txtrst}/g" && exit
+fi
+
 # Testbed Lib
 make -f Makefile.library.mak $ACTION TARGET=$TARGET ASSEMBLY=testbed_lib VER_MAJOR=0 VER_MINOR=1 DO_VERSION=no ADDL_INC_FLAGS="-Iengine/src" ADDL_LINK_FLAGS="-lengine"
 ERRORLEVEL=$?
@@ -68,6 +76,14 @@ then
 echo "Ошибка:"$errorlevel | sed -e "s/error/${txtred}error${txtrst}/g" && exit
 fi
 
+# Benchmark
+make -f Makefile.executable.mak $ACTION TARGET=$TARGET ASSEMBLY=benchmark ADDL_INC_FLAGS="-Iengine/src -Iheadless_renderer/src" ADDL_LINK_FLAGS="-lengine -lheadless_renderer"
+ERRORLEVEL=$?
+if [ $ERRORLEVEL -ne 0 ]
+then
+echo "Ошибка:"$errorlevel | sed -e "s/error/${txtred}error${txtrst}/g" && exit
+fi
+
 # Tests
 make -f Makefile.executable.mak $ACTION TARGET=$TARGET ASSEMBLY=tests ADDL_INC_FLAGS=-Iengine/src ADDL_LINK_FLAGS=-lengine
 ERRORLEVEL=$?
@@ -0,0 +1,87 @@
+#include "retention_list.hpp"
+#include "core/memory_system.h"
+
+u64 RetentionList::GetMemoryRequirement(u32 SlotCount)
+{
+    return (sizeof(u32) * 2 + sizeof(u64)) * SlotCount;
+}
+
+void RetentionList::Create(u32 SlotCount, u64 budget, void *memory)
+{
+    this->SlotCount = SlotCount;
+    bytes = reinterpret_cast<u64*>(memory);
+    prev = reinterpret_cast<u32*>(bytes + SlotCount);
+    next = prev + SlotCount;
+    MemorySystem::ZeroMem(bytes, sizeof(u64) * SlotCount);
+    head = tail = INVALID::ID;
+    stats = Stats();
+    stats.budget = budget;
+}
+
+bool RetentionList::Retain(u32 slot, u64 size)
+{
+    if (!bytes || slot >= SlotCount || stats.budget == 0 || size > stats.budget) {
+        return false;
+    }
+    if (Contains(slot)) {
+        Unlink(slot);
+    }
+
+    bytes[slot] = size > 0 ? size : 1;
+    prev[slot] = INVALID::ID;
+    next[slot] = head;
+    if (head != INVALID::ID) {
+        prev[head] = slot;
+    }
+    head = slot;
+    if (tail == INVALID::ID) {
+        tail = slot;
+    }
+
+    stats.RetainedBytes += bytes[slot];
+    stats.RetainedCount++;
+    return true;
+}
+
+bool RetentionList::Revive(u32 slot)
+{
+    if (!Contains(slot)) {
+        return false;
+    }
+    Unlink(slot);
+    stats.hits++;
+    return true;
+}
+
+u32 RetentionList::EvictionCandidate() const
+{
+    return stats.RetainedBytes > stats.budget ? tail : INVALID::ID;
+}
+
+void RetentionList::Evict(u32 slot)
+{
+    if (!Contains(slot)) {
+        return;
+    }
+    Unlink(slot);
+    stats.evictions++;
+}
+
+void RetentionList::Unlink(u32 slot)
+{
+    if (prev[slot] != INVALID::ID) {
+        next[prev[slot]] = next[slot];
+    } else {
+        head = next[slot];
+    }
+    if (next[slot] != INVALID::ID) {
+        prev[next[slot]] = prev[slot];
+    } else {
+        tail = prev[slot];
+    }
+
+    stats.RetainedBytes -= bytes[slot];
+    stats.RetainedCount--;
+    bytes[slot] = 0;
+    prev[slot] = next[slot] = INVALID::ID;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "defines.h"
+
+/// @brief Список удержания ресурсов без ссылок, упорядоченный по давности освобождения (LRU). 
+/// Работает со слотами фиксированного массива ресурсов системы: вставка, удаление и возврат 
+/// ресурса выполняются за O(1) с помощью двусвязного списка индексов. Ресурсы удерживаются, 
+/// пока суммарный объем не превышает бюджет; вытесняются сначала дольше всех не использованные.
+class MAPI RetentionList
+{
+public:
+    /// @brief Счетчики кэша удержания.
+    struct Stats {
+        u64 hits;           // Количество получений ресурса, возвращенного из списка удержания.
+        u64 misses;         // Количество получений ресурса, который пришлось загрузить.
+        u64 evictions;      // Количество ресурсов, вытесненных из списка удержания.
+        u64 RetainedBytes;  // Суммарный объем удерживаемых ресурсов в байтах.
+        u64 budget;         // Бюджет удержания в байтах.
+        u32 RetainedCount;  // Количество удерживаемых ресурсов.
+    };
+
+private:
+    u32* prev;
+    u32* next;
+    u64* bytes;         // Объем каждого удерживаемого слота. 0 - слот не удерживается.
+    u32 SlotCount;
+    u32 head;           // Последний освобожденный слот.
+    u32 tail;           // Дольше всех не использованный слот.
+    Stats stats;
+
+public:
+    constexpr RetentionList() : prev(nullptr), next(nullptr), bytes(nullptr), SlotCount(), head(INVALID::ID), tail(INVALID::ID), stats() {}
+
+    /// @brief Возвращает объем памяти, необходимой списку для заданного количества слотов.
+    static u64 GetMemoryRequirement(u32 SlotCount);
+
+    /// @brief Создает список в предварительно выделенном блоке памяти.
+    /// @param SlotCount количество слотов в массиве ресурсов системы.
+    /// @param budget бюджет удержания в байтах. 0 - ресурсы не удерживаются.
+    /// @param memory блок памяти размером не меньше GetMemoryRequirement(SlotCount).
+    void Create(u32 SlotCount, u64 budget, void* memory);
+
+    /// @brief Помещает освобожденный ресурс в начало списка.
+    /// @param slot индекс ресурса в массиве системы.
+    /// @param size объем ресурса в байтах. Значения меньше 1 байта считаются 1 байтом.
+    /// @return true, если ресурс удерживается; false, если удержание выключено или ресурс больше бюджета.
+    bool Retain(u32 slot, u64 size);
+
+    /// @brief Возвращает ресурс из списка удержания, если он там есть, и учитывает попадание.
+    /// @param slot индекс ресурса в массиве системы.
+    /// @return true, если ресурс был удержан; в противном случае false.
+    bool Revive(u32 slot);
+
+    /// @brief Учитывает получение ресурса, который пришлось загрузить.
+    MINLINE void Miss() { stats.misses++; }
+
+    /// @brief Возвращает слот, который следует вытеснить, или INVALID::ID, если бюджет не превышен.
+    u32 EvictionCandidate() const;
+
+    /// @brief Возвращает дольше всех не использованный слот независимо от бюджета, или INVALID::ID, если список пуст.
+    /// Используется, когда системе нужен слот массива, а свободных не осталось.
+    MINLINE u32 Oldest() const { return tail; }
+
+    /// @brief Удаляет вытесняемый ресурс из списка. Ресурс уничтожается вызывающей стороной.
+    /// @param slot индекс ресурса в массиве системы.
+    void Evict(u32 slot);
+
+    /// @brief Указывает, удерживается ли ресурс в данном слоте.
+    MINLINE bool Contains(u32 slot) const { return bytes && slot < SlotCount && bytes[slot] > 0; }
+
+    MINLINE const Stats& GetStats() const { return stats; }
+private:
+    void Unlink(u32 slot);
+};
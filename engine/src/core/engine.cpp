@@ -7,7 +7,9 @@
 #include "console.hpp"
 #include "mvar.h"
 #include "input.h"
+#include "frame_pacer.h"
 #include "metrics.h"
+#include "profiler.h"
 
 // Системы
 #include "systems/texture_system.h"
@@ -108,18 +110,23 @@ bool Engine::Run() {
     clock.Update();
     LastTime = clock.elapsed;
     // f64 RunningTime = 0;
-    [[maybe_unused]]u8 FrameCount = 0;      // 
-    f64 TargetFrameSeconds = 1.F / 60;
     f64 FrameElapsedTime = 0;
 
     MINFO(MemorySystem::GetMemoryUsageStr().c_str());
+    Profiler::SetThreadName("Основной поток");
 
     while (IsRunning) {
+        // В режиме малой задержки ожидание кадра происходит здесь, чтобы сообщения окна и ввод опрашивались как можно позже.
+        FramePacer::BeginFrame();
+
         if(!WindowSystem::Messages()) {
             IsRunning = false;
         }
 
         if(!IsSuspended) {
+            Profiler::FrameMark();
+            MPROFILE_SCOPE("Engine::Frame");
+
             // Обновите часы и получите разницу во времени.
             clock.Update();
             f64 CurrentTime = clock.elapsed;
@@ -138,7 +145,12 @@ bool Engine::Run() {
             //Обновление метрик(статистики)
             Metrics::Update(FrameElapsedTime);
 
-            if (!GameInst->Update(*GameInst, frameData)) {
+            bool UpdateResult;
+            {
+                MPROFILE_SCOPE("Application::Update");
+                UpdateResult = GameInst->Update(*GameInst, frameData);
+            }
+            if (!UpdateResult) {
                 MFATAL("Ошибка обновления игры, выключение.");
                 IsRunning = false;
                 break;
@@ -147,14 +159,23 @@ bool Engine::Run() {
             RenderPacket packet = {};
 
             // Позвольте приложению сгенерировать пакет рендеринга.
-            bool PrepareResult = pEngine->GameInst->PrepareRenderPacket(pEngine->GameInst, packet, pEngine->frameData);
+            bool PrepareResult;
+            {
+                MPROFILE_SCOPE("Application::PrepareRenderPacket");
+                PrepareResult = pEngine->GameInst->PrepareRenderPacket(pEngine->GameInst, packet, pEngine->frameData);
+            }
             if (!PrepareResult) {
                 MERROR("Приложению не удалось подготовить пакет рендеринга. Пропускаем этот кадр.");
                 continue;
             }
 
             // Вызовите процедуру рендеринга игры.
-            if (!GameInst->Render(*GameInst, packet, frameData)) {
+            bool RenderResult;
+            {
+                MPROFILE_SCOPE("Application::Render");
+                RenderResult = GameInst->Render(*GameInst, packet, frameData);
+            }
+            if (!RenderResult) {
                 MFATAL("Ошибка рендеринга игры, выключение.");
                 IsRunning = false;
                 break;
@@ -162,23 +183,13 @@ bool Engine::Run() {
             
             packet.Destroy();
 
-            // Выясните, сколько времени занял кадр и, если ниже
+            // Выясните, сколько времени занял кадр.
             f64 FrameEndTime = WindowSystem::PlatformGetAbsoluteTime();
             FrameElapsedTime = FrameEndTime - FrameStartTime;
             // RunningTime += FrameElapsedTime;
-            f64 RemainingSeconds = TargetFrameSeconds - FrameElapsedTime;
-
-            if (RemainingSeconds > 0) {
-                u64 Remaining_ms = (RemainingSeconds * 1000);
 
-                // Если осталось время, верните его ОС.
-                bool LimitFrames = false;
-                if (Remaining_ms > 0 && LimitFrames) {
-                    PlatformSleep(Remaining_ms - 1);
-                }
-
-                FrameCount++;
-            }
+            // Ограничение частоты кадров: в режиме пропускной способности ожидание срока кадра происходит здесь.
+            FramePacer::EndFrame();
 
             // ПРИМЕЧАНИЕ. Обновление/копирование состояния ввода всегда
             // должно выполняться после записи любого ввода; т.е. перед этой
@@ -271,3 +282,8 @@ const FrameData &Engine::GetFrameData() const
 {
     return frameData;
 }
+
+LinearAllocator *Engine::GetFrameAllocator()
+{
+    return pEngine ? &pEngine->FrameAllocator : nullptr;
+}
@@ -73,6 +73,9 @@ public:
     static void OnEventSystemInitialized();
 
     MAPI const FrameData& GetFrameData() const;
+    /// @brief Распределитель кадра для временных данных, которые нужны только до конца текущего кадра.
+    /// @return указатель на распределитель кадра; nullptr, если движок еще не создан.
+    MAPI static LinearAllocator* GetFrameAllocator();
 
 private:
     // Обработчики событий
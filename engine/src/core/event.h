@@ -164,6 +164,14 @@ namespace EventSystem
         // u16 button = context.data.u16[2]
         MouseDragEnd = 0x22,
 
+        /// @brief Событие, запускаемое бэкэндом рендеринга, когда GPU завершил пакет загрузок текстур и геометрии.
+        /// Пакеты завершаются в порядке номеров, см. RenderingSystem::UploadTicket.
+        /// Контекст использования:
+        /// u64 ticket = context.data.u64[0];
+        /// u32 TextureCount = context.data.u32[2];
+        /// u32 GeometryCount = context.data.u32[3];
+        RenderUploadsCompleted = 0x23,
+
         MaxEventCode = 0xFF       // Максимальный код события, который можно использовать внутри.
     };
 };
@@ -0,0 +1,250 @@
+#include "frame_pacer.h"
+#include "console.hpp"
+#include "mvar.h"
+#include "profiler.h"
+#include "math/math.h"
+#include "platform/platform.hpp"
+#include <new>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define FRAME_PACER_SPIN_PAUSE() _mm_pause()
+#else
+#define FRAME_PACER_SPIN_PAUSE()
+#endif
+
+constexpr f64 FRAME_PACER_SMOOTHING = 0.125;         // Вес нового измерения в скользящих средних.
+constexpr f64 FRAME_PACER_MIN_SLEEP_MARGIN = 0.00005;
+constexpr f64 FRAME_PACER_MAX_SLEEP_MARGIN = 0.004;
+constexpr f64 FRAME_PACER_WORK_SLACK = 0.0002;     // Запас к ожидаемой работе кадра в режиме малой задержки.
+
+struct sFramePacer {
+    FramePacerConfig clock;  // Источник времени и сон.
+    i32 limit;              // Значение frame_rate_limit, по которому вычислен период.
+    i32 mode;
+    f64 period;             // Целевой интервал кадров в секундах; 0 — без ограничения.
+    f64 deadline;           // Момент, к которому должен закончиться текущий кадр; 0 — срок не назначен.
+    f64 FrameStart;         // Момент опроса ввода текущего кадра.
+    f64 LastFrameEnd;
+
+    // Скользящие среднее и среднее отклонение длительности работы кадра и пересыпа сна ОС.
+    f64 WorkMean, WorkDeviation;
+    f64 OversleepMean, OversleepDeviation;
+
+    f64 intervals[FRAME_PACER_HISTORY];
+    f64 latencies[FRAME_PACER_HISTORY];
+    bool missed[FRAME_PACER_HISTORY];
+    u32 HistoryCount;
+    u32 HistoryHead;
+    u64 MissedTotal;
+    u64 FrameCount;
+
+    constexpr sFramePacer()
+    : clock(), limit(), mode(FramePacer::Throughput), period(), deadline(), FrameStart(), LastFrameEnd(), WorkMean(), WorkDeviation(),
+    OversleepMean(0.0005), OversleepDeviation(), intervals(), latencies(), missed(), HistoryCount(), HistoryHead(), MissedTotal(), FrameCount() {}
+};
+
+static sFramePacer* pState = nullptr;
+
+static f64 FramePacerPlatformTime() { return WindowSystem::PlatformGetAbsoluteTime(); }
+
+static void FramePacerCommandStats(ConsoleCommandContext context);
+
+bool FramePacer::Initialize(u64 &MemoryRequirement, void *memory, void *config)
+{
+    MemoryRequirement = sizeof(sFramePacer);
+    if (!memory) {
+        return true;
+    }
+
+    pState = new(memory) sFramePacer();
+    auto pConfig = reinterpret_cast<FramePacerConfig*>(config);
+    pState->clock.GetTime = pConfig && pConfig->GetTime ? pConfig->GetTime : FramePacerPlatformTime;
+    pState->clock.Sleep = pConfig && pConfig->Sleep ? pConfig->Sleep : PlatformSleepPrecise;
+
+    // Частота кадров не ограничена по умолчанию: темп задает вертикальная синхронизация рендерера.
+    MVar::CreateInt("frame_rate_limit", 0);
+    MVar::CreateInt("frame_pacing_mode", Throughput);
+
+    Console::RegisterCommand("frame_pacing_stats", 0, FramePacerCommandStats);
+    return true;
+}
+
+void FramePacer::Shutdown()
+{
+    if (pState) {
+        Console::UnregisterCommand("frame_pacing_stats");
+    }
+    pState = nullptr;
+}
+
+/// @brief Обновляет скользящие среднее и среднее отклонение измерения.
+static void FramePacerSmooth(f64& mean, f64& deviation, f64 value)
+{
+    mean += (value - mean) * FRAME_PACER_SMOOTHING;
+    deviation += (Math::abs((f32)(value - mean)) - deviation) * FRAME_PACER_SMOOTHING;
+}
+
+/// @brief Ожидаемая длительность работы кадра с запасом на ее разброс.
+static f64 FramePacerPredictedWork()
+{
+    return pState->WorkMean + 2.0 * pState->WorkDeviation + FRAME_PACER_WORK_SLACK;
+}
+
+void FramePacer::WaitUntil(f64 time)
+{
+    if (!pState) {
+        return;
+    }
+
+    MPROFILE_SCOPE("FramePacer::Wait");
+    while (true) {
+        const f64 now = pState->clock.GetTime();
+        const f64 remaining = time - now;
+        if (remaining <= 0.0) {
+            return;
+        }
+
+        // Сон ОС просыпается с опозданием; последние margin секунд досыпаются циклом. Запас следует за наблюдаемым
+        // опозданием сна, поэтому на точном таймере цикл короткий, а на грубом — длиннее, но срок не пропускается.
+        f64 margin = pState->OversleepMean + 2.0 * pState->OversleepDeviation;
+        margin = MMIN(MMAX(margin, FRAME_PACER_MIN_SLEEP_MARGIN), FRAME_PACER_MAX_SLEEP_MARGIN);
+        if (remaining > margin) {
+            const f64 request = remaining - margin;
+            pState->clock.Sleep(request);
+            const f64 slept = pState->clock.GetTime() - now;
+            FramePacerSmooth(pState->OversleepMean, pState->OversleepDeviation, slept - request);
+            continue;
+        }
+
+        while (pState->clock.GetTime() < time) {
+            FRAME_PACER_SPIN_PAUSE();
+        }
+        return;
+    }
+}
+
+void FramePacer::BeginFrame()
+{
+    if (!pState) {
+        return;
+    }
+
+    i32 limit = 0, mode = Throughput;
+    MVar::GetInt("frame_rate_limit", limit);
+    MVar::GetInt("frame_pacing_mode", mode);
+    if (limit != pState->limit) {
+        pState->limit = limit;
+        pState->period = limit > 0 ? 1.0 / limit : 0.0;
+        pState->deadline = 0.0;
+    }
+    pState->mode = mode;
+
+    // Ввод опрашивается после этого ожидания: чем ближе начало работы к сроку, тем свежее ввод в выведенном кадре.
+    if (pState->period > 0.0 && pState->mode == LowLatency && pState->deadline > 0.0) {
+        WaitUntil(pState->deadline - FramePacerPredictedWork());
+    }
+
+    pState->FrameStart = pState->clock.GetTime();
+    if (pState->period > 0.0 && pState->deadline <= 0.0) {
+        pState->deadline = pState->FrameStart + pState->period;
+    }
+}
+
+void FramePacer::EndFrame()
+{
+    if (!pState) {
+        return;
+    }
+
+    const f64 WorkEnd = pState->clock.GetTime();
+    FramePacerSmooth(pState->WorkMean, pState->WorkDeviation, WorkEnd - pState->FrameStart);
+
+    bool missed = false;
+    if (pState->period > 0.0 && pState->deadline > 0.0) {
+        missed = WorkEnd > pState->deadline;
+        if (pState->mode == Throughput) {
+            WaitUntil(pState->deadline);
+        }
+    }
+
+    const f64 end = pState->clock.GetTime();
+    if (pState->period > 0.0) {
+        // Сроки идут с постоянным шагом, чтобы ошибка не накапливалась; после пропуска отсчет начинается заново,
+        // а не догоняет пропущенные кадры серией без ожидания.
+        pState->deadline += pState->period;
+        if (pState->deadline < end) {
+            pState->deadline = end + pState->period;
+        }
+    }
+
+    if (pState->LastFrameEnd > 0.0) {
+        const u32 slot = pState->HistoryHead;
+        pState->intervals[slot] = end - pState->LastFrameEnd;
+        pState->latencies[slot] = end - pState->FrameStart;
+        pState->missed[slot] = missed;
+        pState->HistoryHead = (slot + 1) % FRAME_PACER_HISTORY;
+        pState->HistoryCount = MMIN(pState->HistoryCount + 1, FRAME_PACER_HISTORY);
+    }
+    pState->LastFrameEnd = end;
+    pState->MissedTotal += missed;
+    pState->FrameCount++;
+}
+
+void FramePacer::GetStats(FramePacerStats &OutStats)
+{
+    OutStats = {};
+    if (!pState) {
+        return;
+    }
+
+    OutStats.TargetMs = pState->period * 1000.0;
+    OutStats.mode = pState->mode;
+    OutStats.PredictedWorkMs = FramePacerPredictedWork() * 1000.0;
+    OutStats.SleepMarginMs = MMIN(MMAX(pState->OversleepMean + 2.0 * pState->OversleepDeviation, FRAME_PACER_MIN_SLEEP_MARGIN), FRAME_PACER_MAX_SLEEP_MARGIN) * 1000.0;
+    OutStats.MissedTotal = pState->MissedTotal;
+    OutStats.FrameCount = pState->FrameCount;
+
+    const u32 count = pState->HistoryCount;
+    if (!count) {
+        return;
+    }
+    f64 sum = 0.0, LatencySum = 0.0;
+    for (u32 i = 0; i < count; ++i) {
+        sum += pState->intervals[i];
+        LatencySum += pState->latencies[i];
+        OutStats.MaxMs = MMAX(OutStats.MaxMs, pState->intervals[i] * 1000.0);
+        OutStats.MissedRecent += pState->missed[i];
+    }
+    const f64 mean = sum / count;
+    f64 variance = 0.0;
+    for (u32 i = 0; i < count; ++i) {
+        variance += (pState->intervals[i] - mean) * (pState->intervals[i] - mean);
+    }
+    OutStats.MeanMs = mean * 1000.0;
+    OutStats.DeviationMs = Math::sqrt((f32)(variance / count)) * 1000.0;
+    OutStats.LatencyMs = LatencySum / count * 1000.0;
+}
+
+/// @brief Выводит в консоль статистику темпа кадров.
+static void FramePacerCommandStats(ConsoleCommandContext context)
+{
+    FramePacerStats stats;
+    FramePacer::GetStats(stats);
+
+    char line[256] = {0};
+    if (stats.TargetMs > 0.0) {
+        MString::Format(line, "цель %.3f мс, режим %s", stats.TargetMs, stats.mode == FramePacer::LowLatency ? "малая задержка" : "пропускная способность");
+    } else {
+        MString::Format(line, "частота кадров не ограничена");
+    }
+    Console::WriteLine(Log::Level::Info, line);
+    MString::Format(line, "интервал: среднее %.3f мс, отклонение %.3f мс, максимум %.3f мс", stats.MeanMs, stats.DeviationMs, stats.MaxMs);
+    Console::WriteLine(Log::Level::Info, line);
+    MString::Format(line, "от опроса ввода до конца кадра %.3f мс; ожидаемая работа %.3f мс, запас сна %.3f мс",
+        stats.LatencyMs, stats.PredictedWorkMs, stats.SleepMarginMs);
+    Console::WriteLine(Log::Level::Info, line);
+    MString::Format(line, "пропущено сроков: %u из последних %u кадров, всего %llu из %llu",
+        stats.MissedRecent, (u32)MMIN((u64)FRAME_PACER_HISTORY, stats.FrameCount), stats.MissedTotal, stats.FrameCount);
+    Console::WriteLine(Log::Level::Info, line);
+}
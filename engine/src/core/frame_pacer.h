@@ -0,0 +1,59 @@
+/// @file frame_pacer.h
+/// @brief Темп кадров: ограничение частоты кадров точным ожиданием (сон ОС с досыпанием в цикле) и режим малой задержки,
+/// в котором ожидание переносится в начало кадра, чтобы ввод опрашивался как можно ближе к выводу кадра.
+/// Управляется переменными mvar: frame_rate_limit — целевая частота кадров (0 — без ограничения) и
+/// frame_pacing_mode — 0 для пропускной способности, 1 для малой задержки.
+#pragma once
+
+#include "defines.h"
+
+constexpr u32 FRAME_PACER_HISTORY = 120;    // Кадров в статистике интервалов.
+
+/// @brief Конфигурация темпа кадров: источник времени и сон. Передается в FramePacer::Initialize;
+/// без конфигурации используются часы и сон платформы. Тесты подставляют управляемые часы.
+struct FramePacerConfig {
+    f64 (*GetTime)();               // Абсолютное время в секундах.
+    void (*Sleep)(f64 seconds);     // Сон ОС; может проснуться позже запрошенного.
+};
+
+/// @brief Статистика темпа кадров за последние FRAME_PACER_HISTORY кадров.
+struct FramePacerStats {
+    f64 TargetMs;           // Целевой интервал кадров; 0, если частота не ограничена.
+    i32 mode;               // Режим FramePacer::Mode.
+    f64 MeanMs;             // Средний интервал между концами кадров.
+    f64 DeviationMs;        // Стандартное отклонение интервала.
+    f64 MaxMs;              // Наибольший интервал.
+    f64 LatencyMs;          // Среднее время от опроса ввода до конца кадра.
+    f64 PredictedWorkMs;    // Ожидаемая длительность работы кадра, по которой режим малой задержки выбирает момент опроса ввода.
+    f64 SleepMarginMs;      // Запас, который досыпается циклом, а не сном ОС.
+    u32 MissedRecent;       // Кадров, закончившихся позже срока, в истории.
+    u64 MissedTotal;        // Кадров, закончившихся позже срока, за все время.
+    u64 FrameCount;
+};
+
+namespace FramePacer
+{
+    enum Mode : i32 {
+        /// @brief Ожидание в конце кадра: ввод опрашивается сразу после вывода предыдущего кадра.
+        Throughput = 0,
+        /// @brief Ожидание в начале кадра, до опроса ввода, на ожидаемую длительность работы кадра раньше срока.
+        LowLatency = 1,
+    };
+
+    bool Initialize(u64& MemoryRequirement, void* memory, void* config);
+    void Shutdown();
+
+    /// @brief Начинает кадр; вызывается основным циклом до опроса ввода. В режиме малой задержки ждет здесь.
+    MAPI void BeginFrame();
+
+    /// @brief Завершает кадр после его вывода. В режиме пропускной способности ждет здесь срока кадра.
+    MAPI void EndFrame();
+
+    /// @brief Точно ждет заданного момента: спит, пока до него дальше запаса сна, затем досыпает в цикле.
+    /// @param time момент абсолютного времени платформы в секундах.
+    MAPI void WaitUntil(f64 time);
+
+    /// @brief Получает статистику темпа кадров.
+    /// @param OutStats ссылка на структуру для хранения статистики.
+    MAPI void GetStats(FramePacerStats& OutStats);
+} // namespace FramePacer
@@ -19,8 +19,43 @@ struct sMetrics
         Clock timer;
     } function; 
 
+    struct TextureStreaming {
+        u64 ResidentBytes;
+        u64 BudgetBytes;
+        u32 PendingRequests;
+    } textures;
+
+    struct GpuFrame {
+        f64 LastMs;
+        f64 AverageMs;
+    } gpu;
+
+    struct Uniforms {
+        u64 BytesUploaded;
+        u32 DescriptorUpdates;
+    } uniforms;
+
+    struct TextGeometry {
+        f64 seconds;
+        u32 QuadCount;
+        u64 BytesUploaded;
+    } text, LastText;  // Накопление текущего кадра и итоги последнего завершенного.
+
+    struct UiBatch {
+        f64 BuildSeconds;
+        u32 DrawCount;
+        u32 QuadCount;
+    } ui;
+
+    struct Terrain {
+        f64 SelectSeconds;
+        u32 TriangleCount;
+        u32 ChunkCount;
+        u32 ResidentChunkCount;
+    } terrain;
+
     /// @brief Инициализирует систему метрик.
-    constexpr sMetrics() : FrameAvgCounter(), MsTimes(), MsAvg(), frames(), AccumulatedFrameMs(), fps(), function() {}
+    constexpr sMetrics() : FrameAvgCounter(), MsTimes(), MsAvg(), frames(), AccumulatedFrameMs(), fps(), function(), textures(), gpu(), uniforms(), text(), LastText(), ui(), terrain() {}
 
     void* operator new(u64 size) {
         return MemorySystem::Allocate(size, Memory::Engine);
@@ -59,6 +94,9 @@ void Metrics::Update(f64 FrameElapsedTime)
 
     // Подсчитать все кадры.
     pMetrics->frames++;
+
+    pMetrics->LastText = pMetrics->text;
+    pMetrics->text = {};
 }
 
 const f64& Metrics::FPS()
@@ -77,6 +115,104 @@ void Metrics::Frame(f64 &OutFPS, f64 &OutFrameMs)
     OutFrameMs = pMetrics->MsAvg;
 }
 
+void Metrics::SetTextureStreaming(u64 ResidentBytes, u64 BudgetBytes, u32 PendingRequests)
+{
+    if (pMetrics) {
+        pMetrics->textures.ResidentBytes = ResidentBytes;
+        pMetrics->textures.BudgetBytes = BudgetBytes;
+        pMetrics->textures.PendingRequests = PendingRequests;
+    }
+}
+
+void Metrics::TextureStreaming(u64 &OutResidentBytes, u64 &OutBudgetBytes, u32 &OutPendingRequests)
+{
+    OutResidentBytes = pMetrics->textures.ResidentBytes;
+    OutBudgetBytes = pMetrics->textures.BudgetBytes;
+    OutPendingRequests = pMetrics->textures.PendingRequests;
+}
+
+void Metrics::SetGpuFrameTime(f64 LastMs, f64 AverageMs)
+{
+    if (pMetrics) {
+        pMetrics->gpu.LastMs = LastMs;
+        pMetrics->gpu.AverageMs = AverageMs;
+    }
+}
+
+void Metrics::GpuFrameTime(f64 &OutLastMs, f64 &OutAverageMs)
+{
+    if (!pMetrics) {
+        OutLastMs = OutAverageMs = 0.0;
+        return;
+    }
+    OutLastMs = pMetrics->gpu.LastMs;
+    OutAverageMs = pMetrics->gpu.AverageMs;
+}
+
+void Metrics::SetUniformUploads(u64 BytesUploaded, u32 DescriptorUpdates)
+{
+    if (pMetrics) {
+        pMetrics->uniforms.BytesUploaded = BytesUploaded;
+        pMetrics->uniforms.DescriptorUpdates = DescriptorUpdates;
+    }
+}
+
+void Metrics::UniformUploads(u64 &OutBytesUploaded, u32 &OutDescriptorUpdates)
+{
+    OutBytesUploaded = pMetrics->uniforms.BytesUploaded;
+    OutDescriptorUpdates = pMetrics->uniforms.DescriptorUpdates;
+}
+
+void Metrics::AddTextGeometry(f64 seconds, u32 QuadCount, u64 BytesUploaded)
+{
+    if (pMetrics) {
+        pMetrics->text.seconds += seconds;
+        pMetrics->text.QuadCount += QuadCount;
+        pMetrics->text.BytesUploaded += BytesUploaded;
+    }
+}
+
+void Metrics::TextGeometry(f64 &OutMs, u32 &OutQuadCount, u64 &OutBytesUploaded)
+{
+    OutMs = pMetrics->LastText.seconds * 1000.0;
+    OutQuadCount = pMetrics->LastText.QuadCount;
+    OutBytesUploaded = pMetrics->LastText.BytesUploaded;
+}
+
+void Metrics::SetUiBatch(f64 BuildSeconds, u32 DrawCount, u32 QuadCount)
+{
+    if (pMetrics) {
+        pMetrics->ui.BuildSeconds = BuildSeconds;
+        pMetrics->ui.DrawCount = DrawCount;
+        pMetrics->ui.QuadCount = QuadCount;
+    }
+}
+
+void Metrics::UiBatch(f64 &OutBuildMs, u32 &OutDrawCount, u32 &OutQuadCount)
+{
+    OutBuildMs = pMetrics->ui.BuildSeconds * 1000.0;
+    OutDrawCount = pMetrics->ui.DrawCount;
+    OutQuadCount = pMetrics->ui.QuadCount;
+}
+
+void Metrics::SetTerrain(f64 SelectSeconds, u32 TriangleCount, u32 ChunkCount, u32 ResidentChunkCount)
+{
+    if (pMetrics) {
+        pMetrics->terrain.SelectSeconds = SelectSeconds;
+        pMetrics->terrain.TriangleCount = TriangleCount;
+        pMetrics->terrain.ChunkCount = ChunkCount;
+        pMetrics->terrain.ResidentChunkCount = ResidentChunkCount;
+    }
+}
+
+void Metrics::Terrain(f64 &OutSelectMs, u32 &OutTriangleCount, u32 &OutChunkCount, u32 &OutResidentChunkCount)
+{
+    OutSelectMs = pMetrics->terrain.SelectSeconds * 1000.0;
+    OutTriangleCount = pMetrics->terrain.TriangleCount;
+    OutChunkCount = pMetrics->terrain.ChunkCount;
+    OutResidentChunkCount = pMetrics->terrain.ResidentChunkCount;
+}
+
 void Metrics::BeginFunction(const char *FunctionName)
 {
     if (pMetrics) {
@@ -22,6 +22,76 @@ namespace Metrics
     /// @param OutFrameMs Ссылка на переменную для хранения текущего среднего времени кадра в миллисекундах.
     MAPI void Frame(f64& OutFPS, f64& OutFrameMs);
 
+    /// @brief Сохраняет состояние потоковой загрузки текстур; вызывается системой текстур один раз за кадр.
+    /// @param ResidentBytes объем памяти, занятой потоковыми текстурами, в байтах.
+    /// @param BudgetBytes бюджет памяти потоковых текстур в байтах.
+    /// @param PendingRequests количество незавершенных запросов загрузки.
+    MAPI void SetTextureStreaming(u64 ResidentBytes, u64 BudgetBytes, u32 PendingRequests);
+
+    /// @brief Получает состояние потоковой загрузки текстур.
+    /// @param OutResidentBytes ссылка на переменную для хранения объема памяти, занятой потоковыми текстурами.
+    /// @param OutBudgetBytes ссылка на переменную для хранения бюджета памяти потоковых текстур.
+    /// @param OutPendingRequests ссылка на переменную для хранения количества незавершенных запросов загрузки.
+    MAPI void TextureStreaming(u64& OutResidentBytes, u64& OutBudgetBytes, u32& OutPendingRequests);
+
+    /// @brief Сохраняет время кадра на GPU как сумму времени проходов; вызывается системой рендеринга один раз за кадр.
+    /// @param LastMs время последнего прочитанного кадра в миллисекундах.
+    /// @param AverageMs скользящее среднее время кадра в миллисекундах.
+    MAPI void SetGpuFrameTime(f64 LastMs, f64 AverageMs);
+
+    /// @brief Получает время кадра на GPU. Нули, если рендерер не измеряет время на GPU или система метрик не запущена.
+    /// @param OutLastMs ссылка на переменную для хранения времени последнего прочитанного кадра.
+    /// @param OutAverageMs ссылка на переменную для хранения скользящего среднего времени кадра.
+    MAPI void GpuFrameTime(f64& OutLastMs, f64& OutAverageMs);
+
+    /// @brief Сохраняет объем униформ, загруженных за кадр, и количество записей дескрипторов; вызывается системой рендеринга один раз за кадр.
+    /// @param BytesUploaded объем данных в байтах.
+    /// @param DescriptorUpdates количество записей дескрипторов.
+    MAPI void SetUniformUploads(u64 BytesUploaded, u32 DescriptorUpdates);
+
+    /// @brief Получает объем униформ, загруженных за последний завершенный кадр, и количество записей дескрипторов.
+    /// @param OutBytesUploaded ссылка на переменную для хранения объема данных в байтах.
+    /// @param OutDescriptorUpdates ссылка на переменную для хранения количества записей дескрипторов.
+    MAPI void UniformUploads(u64& OutBytesUploaded, u32& OutDescriptorUpdates);
+
+    /// @brief Учитывает перестроение геометрии текста; вызывается текстом при каждом изменении. Итоги кадра доступны после Update.
+    /// @param seconds время перестроения в секундах.
+    /// @param QuadCount количество перестроенных четырехугольников глифов.
+    /// @param BytesUploaded объем загруженных вершин в байтах.
+    MAPI void AddTextGeometry(f64 seconds, u32 QuadCount, u64 BytesUploaded);
+
+    /// @brief Получает итоги перестроения геометрии текста за последний завершенный кадр.
+    /// @param OutMs ссылка на переменную для хранения суммарного времени перестроения в миллисекундах.
+    /// @param OutQuadCount ссылка на переменную для хранения количества перестроенных четырехугольников.
+    /// @param OutBytesUploaded ссылка на переменную для хранения объема загруженных вершин.
+    MAPI void TextGeometry(f64& OutMs, u32& OutQuadCount, u64& OutBytesUploaded);
+
+    /// @brief Сохраняет итоги сборки пакета пользовательского интерфейса; вызывается представлением интерфейса один раз за кадр.
+    /// @param BuildSeconds время обхода элементов и сборки вершин на CPU в секундах.
+    /// @param DrawCount количество вызовов отрисовки пакетов.
+    /// @param QuadCount количество четырехугольников в пакетах: индексы сеток и текста, деленные на 6.
+    MAPI void SetUiBatch(f64 BuildSeconds, u32 DrawCount, u32 QuadCount);
+
+    /// @brief Получает итоги сборки пакета пользовательского интерфейса за последний кадр.
+    /// @param OutBuildMs ссылка на переменную для хранения времени сборки в миллисекундах.
+    /// @param OutDrawCount ссылка на переменную для хранения количества вызовов отрисовки.
+    /// @param OutQuadCount ссылка на переменную для хранения количества четырехугольников.
+    MAPI void UiBatch(f64& OutBuildMs, u32& OutDrawCount, u32& OutQuadCount);
+
+    /// @brief Сохраняет итоги выбора чанков ландшафта; вызывается сценой один раз за кадр.
+    /// @param SelectSeconds время выбора чанков и отправки заданий их построения на CPU в секундах.
+    /// @param TriangleCount количество треугольников в выбранных чанках.
+    /// @param ChunkCount количество выбранных чанков.
+    /// @param ResidentChunkCount количество чанков, загруженных в графический процессор.
+    MAPI void SetTerrain(f64 SelectSeconds, u32 TriangleCount, u32 ChunkCount, u32 ResidentChunkCount);
+
+    /// @brief Получает итоги выбора чанков ландшафта за последний кадр.
+    /// @param OutSelectMs ссылка на переменную для хранения времени выбора в миллисекундах.
+    /// @param OutTriangleCount ссылка на переменную для хранения количества треугольников.
+    /// @param OutChunkCount ссылка на переменную для хранения количества выбранных чанков.
+    /// @param OutResidentChunkCount ссылка на переменную для хранения количества загруженных чанков.
+    MAPI void Terrain(f64& OutSelectMs, u32& OutTriangleCount, u32& OutChunkCount, u32& OutResidentChunkCount);
+
     MAPI void BeginFunction(const char* FunctionName);
     MAPI void EndFunction(const char* FunctionName);
     MAPI f64 GetFunctionExecutionTime(const char* FunctionName);
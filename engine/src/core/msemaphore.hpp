@@ -0,0 +1,34 @@
+#pragma once
+
+#include "defines.h"
+
+/// @brief Счетный семафор. Используется для пробуждения потоков без опроса.
+/// Это вызывает реализацию семафора, специфичную для платформы.
+class MSemaphore
+{
+private:
+    void* data;
+public:
+    /// @brief Создает семафор с нулевым начальным счетчиком.
+    MSemaphore() : data(Create()) {}
+    /// @brief Уничтожает семафор.
+    ~MSemaphore();
+
+    void* Create();
+
+    /// @brief Увеличивает счетчик семафора, пробуждая до count ожидающих потоков.
+    /// @param count величина, на которую увеличивается счетчик.
+    /// @return true в случае успеха; в противном случае false.
+    bool Signal(u32 count = 1);
+
+    /// @brief Ожидает, пока счетчик семафора не станет больше нуля, и уменьшает его.
+    /// @return true в случае успеха; в противном случае false.
+    bool Wait();
+
+    operator bool() {
+        if (!data) {
+            return false;
+        }
+        return true;
+    }
+};
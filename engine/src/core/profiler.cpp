@@ -0,0 +1,323 @@
+#include "profiler.h"
+#include "console.hpp"
+#include "memory_system.h"
+#include "mmutex.hpp"
+#include "platform/filesystem.hpp"
+#include "platform/platform.hpp"
+#include <new>
+
+/// @brief Событие зоны. Пустое имя означает конец последней открытой зоны.
+struct ProfilerEvent {
+    const char* name;
+    f64 time;
+};
+
+/// @brief Кольцевой буфер событий потока. Пишет только сам поток; head публикуется после записи события,
+/// поэтому выгрузка читает буфер без блокировок и отбрасывает события, перезаписанные во время чтения.
+struct ProfilerThread {
+    ProfilerEvent events[PROFILER_EVENTS_PER_THREAD];
+    u64 head;
+    char name[64];
+};
+
+struct sProfiler {
+    MMutex mutex;
+    ProfilerThread* threads[PROFILER_MAX_THREADS];
+    u32 ThreadCount;
+    f64 FrameStarts[PROFILER_MAX_CAPTURE_FRAMES + 1];
+    u64 FrameCount;
+
+    sProfiler() : mutex(), threads(), ThreadCount(), FrameStarts(), FrameCount() {}
+};
+
+static sProfiler* pState = nullptr;
+/// @brief Поколение профилировщика: после повторной инициализации потоки заново получают буферы.
+static u32 ProfilerGeneration = 0;
+
+static thread_local ProfilerThread* CurrentThread = nullptr;
+static thread_local u32 CurrentGeneration = 0;
+
+static void ProfilerCommandCapture(ConsoleCommandContext context);
+
+bool Profiler::Initialize(u64 &MemoryRequirement, void *memory, void *config)
+{
+    MemoryRequirement = sizeof(sProfiler);
+    if (!memory) {
+        return true;
+    }
+
+    pState = new(memory) sProfiler();
+    ProfilerGeneration++;
+
+    Console::RegisterCommand("profile_capture", 1, ProfilerCommandCapture);
+    return true;
+}
+
+void Profiler::Shutdown()
+{
+    if (!pState) {
+        return;
+    }
+
+    Console::UnregisterCommand("profile_capture");
+    auto state = pState;
+    pState = nullptr;
+    for (u32 i = 0; i < state->ThreadCount; ++i) {
+        MemorySystem::Free(state->threads[i], sizeof(ProfilerThread), Memory::Engine);
+    }
+    state->~sProfiler();
+}
+
+/// @brief Возвращает буфер текущего потока, при первом обращении выделяя и регистрируя его.
+static ProfilerThread* ProfilerGetThread()
+{
+    if (CurrentGeneration == ProfilerGeneration) {
+        return CurrentThread;
+    }
+
+    CurrentGeneration = ProfilerGeneration;
+    CurrentThread = nullptr;
+    pState->mutex.Lock();
+    if (pState->ThreadCount < PROFILER_MAX_THREADS) {
+        auto thread = reinterpret_cast<ProfilerThread*>(MemorySystem::Allocate(sizeof(ProfilerThread), Memory::Engine, true));
+        MString::Format(thread->name, "Поток %u", pState->ThreadCount);
+        pState->threads[pState->ThreadCount] = thread;
+        __atomic_store_n(&pState->ThreadCount, pState->ThreadCount + 1, __ATOMIC_RELEASE);
+        CurrentThread = thread;
+    } else {
+        MWARN("Profiler: превышено количество потоков %u, зоны потока не записываются.", PROFILER_MAX_THREADS);
+    }
+    pState->mutex.Unlock();
+    return CurrentThread;
+}
+
+static void ProfilerPush(const char* name)
+{
+    if (!pState) {
+        return;
+    }
+    auto thread = ProfilerGetThread();
+    if (!thread) {
+        return;
+    }
+
+    const u64 head = thread->head;
+    auto& event = thread->events[head & (PROFILER_EVENTS_PER_THREAD - 1)];
+    event.name = name;
+    event.time = WindowSystem::PlatformGetAbsoluteTime();
+    __atomic_store_n(&thread->head, head + 1, __ATOMIC_RELEASE);
+}
+
+void Profiler::BeginZone(const char *name)
+{
+    ProfilerPush(name);
+}
+
+void Profiler::EndZone()
+{
+    ProfilerPush(nullptr);
+}
+
+void Profiler::FrameMark()
+{
+    if (!pState) {
+        return;
+    }
+    pState->FrameStarts[pState->FrameCount % (PROFILER_MAX_CAPTURE_FRAMES + 1)] = WindowSystem::PlatformGetAbsoluteTime();
+    pState->FrameCount++;
+}
+
+void Profiler::SetThreadName(const char *name)
+{
+    if (!pState || !name) {
+        return;
+    }
+    auto thread = ProfilerGetThread();
+    if (!thread) {
+        return;
+    }
+
+    // Длинное имя обрезается по границе символа UTF-8, чтобы выгрузка оставалась допустимым JSON.
+    u32 length = MString::Length(name);
+    if (length >= sizeof(thread->name)) {
+        length = sizeof(thread->name) - 1;
+        while (length && (name[length] & 0xC0) == 0x80) {
+            length--;
+        }
+    }
+    MemorySystem::CopyMem(thread->name, name, length);
+    thread->name[length] = 0;
+}
+
+/// @brief Буферизованная запись текста в файл выгрузки.
+struct TraceWriter {
+    FileHandle& file;
+    u64 length;
+    bool ok;
+    char data[64 * 1024];
+
+    TraceWriter(FileHandle& file) : file(file), length(), ok(true) {}
+
+    void Append(const char* text) {
+        const u64 size = MString::Length(text);
+        if (length + size > sizeof(data)) {
+            Flush();
+        }
+        MemorySystem::CopyMem(data + length, text, size);
+        length += size;
+    }
+
+    void Flush() {
+        u64 written = 0;
+        ok = ok && Filesystem::Write(file, length, data, written) && written == length;
+        length = 0;
+    }
+};
+
+/// @brief Копирует имя в строку JSON, экранируя кавычки и обратную косую черту.
+static void ProfilerEscape(char* dest, const char* name, u32 capacity)
+{
+    u32 length = 0;
+    for (; *name && length + 2 < capacity; ++name) {
+        if (*name == '"' || *name == '\\') {
+            dest[length++] = '\\';
+        }
+        dest[length++] = *name;
+    }
+    dest[length] = 0;
+}
+
+bool Profiler::ExportChromeTrace(const char *path, u32 FrameCount)
+{
+    if (!pState) {
+        return false;
+    }
+
+    // Текущий кадр еще не завершен, поэтому окно заканчивается на его начале.
+    const u64 completed = pState->FrameCount ? pState->FrameCount - 1 : 0;
+    FrameCount = (u32)MMIN((u64)MMIN(FrameCount, PROFILER_MAX_CAPTURE_FRAMES), completed);
+    if (!FrameCount) {
+        MWARN("Profiler::ExportChromeTrace — нет завершенных кадров для выгрузки.");
+        return false;
+    }
+    constexpr u32 FrameSlots = PROFILER_MAX_CAPTURE_FRAMES + 1;
+    const u64 FirstFrame = completed - FrameCount;
+    const f64 WindowStart = pState->FrameStarts[FirstFrame % FrameSlots];
+    const f64 WindowEnd = pState->FrameStarts[completed % FrameSlots];
+
+    FileHandle file;
+    if (!Filesystem::Open(path, FileModes::Write, false, file)) {
+        MERROR("Profiler::ExportChromeTrace — не удалось открыть файл '%s'.", path);
+        return false;
+    }
+
+    auto writer = reinterpret_cast<TraceWriter*>(MemorySystem::Allocate(sizeof(TraceWriter), Memory::Array));
+    new(writer) TraceWriter(file);
+    auto events = reinterpret_cast<ProfilerEvent*>(MemorySystem::Allocate(sizeof(ProfilerEvent) * PROFILER_EVENTS_PER_THREAD, Memory::Array));
+    ProfilerEvent* stack[PROFILER_MAX_DEPTH];
+    char line[512];
+    char name[256];
+    bool first = true;
+
+    writer->Append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (u64 frame = FirstFrame; frame < completed; ++frame) {
+        MString::Format(line, "%s{\"name\":\"Кадр %llu\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.3f,\"pid\":1,\"tid\":0}",
+            first ? "" : ",\n", frame, (pState->FrameStarts[frame % FrameSlots] - WindowStart) * 1000000.0);
+        writer->Append(line);
+        first = false;
+    }
+
+    const u32 ThreadCount = __atomic_load_n(&pState->ThreadCount, __ATOMIC_ACQUIRE);
+    for (u32 t = 0; t < ThreadCount; ++t) {
+        auto thread = pState->threads[t];
+        ProfilerEscape(name, thread->name, sizeof(name));
+        MString::Format(line, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}", t, name);
+        writer->Append(line);
+
+        // Копия буфера; события, которые поток мог перезаписать во время копирования, отбрасываются.
+        const u64 head = __atomic_load_n(&thread->head, __ATOMIC_ACQUIRE);
+        const u64 begin = head > PROFILER_EVENTS_PER_THREAD ? head - PROFILER_EVENTS_PER_THREAD : 0;
+        for (u64 i = begin; i < head; ++i) {
+            events[i - begin] = thread->events[i & (PROFILER_EVENTS_PER_THREAD - 1)];
+        }
+        const u64 after = __atomic_load_n(&thread->head, __ATOMIC_ACQUIRE);
+        const u64 valid = after > PROFILER_EVENTS_PER_THREAD ? after - PROFILER_EVENTS_PER_THREAD : 0;
+        const u64 skip = valid > begin ? MMIN(valid - begin, head - begin) : 0;
+        if (begin + skip > 0 && begin + skip < head && events[skip].time > WindowStart) {
+            MWARN("Profiler: буфер потока '%s' не покрывает все окно выгрузки; ранние зоны потеряны.", thread->name);
+        }
+
+        // Зоны записываются завершенными событиями: начало, потерянное при переполнении буфера, не ломает вложенность.
+        u32 depth = 0, overflow = 0;
+        for (u64 i = skip; i < head - begin; ++i) {
+            auto& event = events[i];
+            if (event.name) {
+                if (depth < PROFILER_MAX_DEPTH) {
+                    stack[depth++] = &event;
+                } else {
+                    overflow++;
+                }
+                continue;
+            }
+            if (overflow) {
+                overflow--;
+                continue;
+            }
+            if (!depth) {
+                continue;   // Начало зоны перезаписано.
+            }
+            auto zone = stack[--depth];
+            if (zone->time < WindowEnd && event.time > WindowStart) {
+                const f64 start = MMAX(zone->time, WindowStart);
+                const f64 end = MMIN(event.time, WindowEnd);
+                ProfilerEscape(name, zone->name, sizeof(name));
+                MString::Format(line, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                    name, (start - WindowStart) * 1000000.0, (end - start) * 1000000.0, t);
+                writer->Append(line);
+            }
+        }
+        // Зоны, открытые на конец окна, обрезаются по нему.
+        while (depth) {
+            auto zone = stack[--depth];
+            if (zone->time < WindowEnd) {
+                const f64 start = MMAX(zone->time, WindowStart);
+                ProfilerEscape(name, zone->name, sizeof(name));
+                MString::Format(line, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                    name, (start - WindowStart) * 1000000.0, (WindowEnd - start) * 1000000.0, t);
+                writer->Append(line);
+            }
+        }
+    }
+    writer->Append("\n]}\n");
+    writer->Flush();
+    const bool result = writer->ok;
+
+    MemorySystem::Free(events, sizeof(ProfilerEvent) * PROFILER_EVENTS_PER_THREAD, Memory::Array);
+    MemorySystem::Free(writer, sizeof(TraceWriter), Memory::Array);
+    Filesystem::Close(file);
+
+    if (!result) {
+        MERROR("Profiler::ExportChromeTrace — ошибка записи в файл '%s'.", path);
+    }
+    return result;
+}
+
+/// @brief Выгружает последние кадры в файл profile_capture_<кадр>.json рабочего каталога.
+static void ProfilerCommandCapture(ConsoleCommandContext context)
+{
+    const u64 FrameCount = MString::ToUInt(context.arguments[0].value);
+    if (!FrameCount) {
+        Console::WriteLine(Log::Level::Error, "использование: profile_capture <количество кадров>");
+        return;
+    }
+
+    char path[64];
+    char line[256];
+    MString::Format(path, "profile_capture_%llu.json", pState->FrameCount);
+    if (Profiler::ExportChromeTrace(path, (u32)MMIN(FrameCount, (u64)PROFILER_MAX_CAPTURE_FRAMES))) {
+        MString::Format(line, "profile_capture: захват записан в %s.", path);
+        Console::WriteLine(Log::Level::Info, line);
+    } else {
+        Console::WriteLine(Log::Level::Error, "profile_capture: не удалось записать захват.");
+    }
+}
@@ -0,0 +1,58 @@
+/// @file profiler.h
+/// @brief Иерархический профилировщик CPU. Зоны отмечаются макросами MPROFILE_SCOPE и MPROFILE_FUNCTION; события начала
+/// и конца зон пишутся в кольцевой буфер потока без блокировок, а последние кадры выгружаются в формат Chrome trace,
+/// который открывают chrome://tracing и Perfetto.
+#pragma once
+
+#include "defines.h"
+
+// Отключите профилировщик, закомментировав строку ниже. Макросы зон тогда не порождают кода.
+#define MPROFILER_ENABLED
+
+constexpr u32 PROFILER_EVENTS_PER_THREAD = 16384;   // Событий в кольцевом буфере потока; степень двойки.
+constexpr u32 PROFILER_MAX_THREADS = 64;
+constexpr u32 PROFILER_MAX_CAPTURE_FRAMES = 128;    // Сколько последних кадров можно выгрузить.
+constexpr u32 PROFILER_MAX_DEPTH = 64;              // Наибольшая вложенность зон при выгрузке.
+
+namespace Profiler
+{
+    bool Initialize(u64& MemoryRequirement, void* memory, void* config);
+    void Shutdown();
+
+    /// @brief Открывает зону в текущем потоке. Имя должно жить до выгрузки, обычно это строковый литерал.
+    /// @param name имя зоны.
+    MAPI void BeginZone(const char* name);
+    /// @brief Закрывает последнюю открытую зону текущего потока.
+    MAPI void EndZone();
+
+    /// @brief Отмечает начало нового кадра; вызывается основным циклом один раз за кадр.
+    MAPI void FrameMark();
+
+    /// @brief Задает имя текущего потока в выгрузке.
+    /// @param name имя потока; копируется, имена длиннее 63 байт обрезаются.
+    MAPI void SetThreadName(const char* name);
+
+    /// @brief Записывает последние завершенные кадры в файл формата Chrome trace (JSON).
+    /// @param path путь к файлу.
+    /// @param FrameCount количество кадров, не больше PROFILER_MAX_CAPTURE_FRAMES.
+    /// @return true в случае успеха; в противном случае false.
+    MAPI bool ExportChromeTrace(const char* path, u32 FrameCount);
+
+    /// @brief Зона, закрывающаяся при выходе из области видимости.
+    struct Scope {
+        Scope(const char* name) { BeginZone(name); }
+        ~Scope() { EndZone(); }
+    };
+} // namespace Profiler
+
+#ifdef MPROFILER_ENABLED
+#define MPROFILE_CONCAT_INNER(a, b) a##b
+#define MPROFILE_CONCAT(a, b) MPROFILE_CONCAT_INNER(a, b)
+/// @brief Отмечает зону от этой строки до конца области видимости.
+#define MPROFILE_SCOPE(name) Profiler::Scope MPROFILE_CONCAT(ProfileScope, __LINE__)(name)
+/// @brief Отмечает зону на все тело функции.
+#define MPROFILE_FUNCTION() MPROFILE_SCOPE(__FUNCTION__)
+#else
+#define MPROFILE_SCOPE(name)
+#define MPROFILE_FUNCTION()
+#endif
@@ -3,9 +3,12 @@
 #include "core/console.hpp"
 #include "core/engine.h"
 #include "core/event.h"
+#include "core/frame_pacer.h"
 #include "core/memory_system.h"
 #include "core/mvar.h"
+#include "core/profiler.h"
 #include "core/input.h"
+#include "platform/async_io.hpp"
 #include "platform/platform.hpp"
 
 #include "renderer/rendering_system.h"
@@ -43,11 +46,22 @@ bool SystemsManager::PostBootInitialize(ApplicationConfig &AppConfig)
     return RegisterKnownSystemsPostBoot(AppConfig);
 }
 
+/// @brief Имена зон профилировщика для известных систем, в порядке MSystem::Type.
+static const char* SystemZoneNames[] = {
+    "Memory::Update", "Console::Update", "MVar::Update", "EventSystem::Update", "Log::Update", "InputSystem::Update",
+    "Platform::Update", "ResourceSystem::Update", "ShaderSystem::Update", "JobSystem::Update", "TextureSystem::Update",
+    "FontSystem::Update", "CameraSystem::Update", "RenderingSystem::Update", "RenderViewSystem::Update",
+    "MaterialSystem::Update", "GeometrySystem::Update", "LightSystem::Update", "AsyncIO::Update", "Profiler::Update",
+    "FramePacer::Update",
+};
+
 bool SystemsManager::Update(const FrameData& rFrameData)
 {
+    MPROFILE_SCOPE("SystemsManager::Update");
     for (u32 i = 0; i < M_SYSTEM_TYPE_MAX_COUNT; ++i) {
         auto& s = systems[i];
         if (s.update) {
+            MPROFILE_SCOPE(i < sizeof(SystemZoneNames) / sizeof(SystemZoneNames[0]) ? SystemZoneNames[i] : "UserSystem::Update");
             if (!s.update(s.state, rFrameData)) {
                 MERROR("Ошибка обновления системы для типа: %i", i);
             }
@@ -117,6 +131,18 @@ bool SystemsManager::RegisterKnownSystemsPreBoot(ApplicationConfig &AppConfig)
         return false;
     }
 
+    // Профилировщик. Регистрирует команду консоли, поэтому идет после нее; зоны других систем пишутся с их инициализации.
+    if (!state->Register(MSystem::Profiler, Profiler::Initialize, Profiler::Shutdown)) {
+        MERROR("Не удалось зарегистрировать профилировщик.");
+        return false;
+    }
+
+    // Темп кадров. Создает свои mvar и команду консоли.
+    if (!state->Register(MSystem::FramePacer, FramePacer::Initialize, FramePacer::Shutdown)) {
+        MERROR("Не удалось зарегистрировать систему темпа кадров.");
+        return false;
+    }
+
     // События
     if (!state->Register(MSystem::Event, EventSystem::Initialize, EventSystem::Shutdown)) {
         MERROR("Не удалось зарегистрировать систему событий.");
@@ -145,6 +171,12 @@ bool SystemsManager::RegisterKnownSystemsPreBoot(ApplicationConfig &AppConfig)
     ResourceSystemConfig ResourceSysConfig;
     ResourceSysConfig.AssetBasePath = "../assets";  // ЗАДАЧА: Вероятно, приложение должно это настроить.
     ResourceSysConfig.MaxLoaderCount = 32;
+    ResourceSysConfig.PackPath = "../assets.mpk";
+#ifdef _DEBUG
+    ResourceSysConfig.HotReload = true;
+#else
+    ResourceSysConfig.HotReload = false;
+#endif
     if (!state->Register(MSystem::Resource, ResourceSystem::Initialize, ResourceSystem::Shutdown, nullptr, &ResourceSysConfig)) {
         MERROR("Не удалось зарегистрировать систему ресурсов.");
         return false;
@@ -216,6 +248,15 @@ bool SystemsManager::RegisterKnownSystemsPreBoot(ApplicationConfig &AppConfig)
         return false;
     }
 
+    // Асинхронный ввод-вывод. Отправляет задания по завершении чтения, поэтому регистрируется после системы заданий.
+    AsyncIOConfig AsyncIOSysConfig;
+    AsyncIOSysConfig.WorkerCount = ThreadCount < 4 ? ThreadCount : 4;
+    AsyncIOSysConfig.QueueDepth = 64;
+    if (!state->Register(MSystem::AsyncIO, AsyncIO::Initialize, AsyncIO::Shutdown, nullptr, &AsyncIOSysConfig)) {
+        MERROR("Не удалось зарегистрировать систему асинхронного ввода-вывода.");
+        return false;
+    }
+
     return true;
 }
 
@@ -224,13 +265,18 @@ bool SystemsManager::RegisterKnownSystemsPostBoot(ApplicationConfig &AppConfig)
     // Система текстур.
     TextureSystemConfig TextureSysConfig;
     TextureSysConfig.MaxTextureCount = 65536;
-    if (!Register(MSystem::Texture, TextureSystem::Initialize, TextureSystem::Shutdown, nullptr, &TextureSysConfig)) {
+    TextureSysConfig.streaming = false;
+    TextureSysConfig.StreamingBudget = MEBIBYTES(256);
+    TextureSysConfig.StreamingBaseSize = 64;
+    TextureSysConfig.RetentionBudget = MEBIBYTES(128);
+    TextureSysConfig.RetentionEvictionsPerFrame = 4;
+    if (!Register(MSystem::Texture, TextureSystem::Initialize, TextureSystem::Shutdown, TextureSystem::Update, &TextureSysConfig)) {
         MERROR("Не удалось зарегистрировать систему текстур.");
         return false;
     }
 
     // Система шрифтов.
-    if (!Register(MSystem::Font, FontSystem::Initialize, FontSystem::Shutdown, nullptr, &AppConfig.FontConfig)) {
+    if (!Register(MSystem::Font, FontSystem::Initialize, FontSystem::Shutdown, FontSystem::Update, &AppConfig.FontConfig)) {
         MERROR("Не удалось зарегистрировать систему шрифтов.");
         return false;
     }
@@ -263,7 +309,9 @@ bool SystemsManager::RegisterKnownSystemsPostBoot(ApplicationConfig &AppConfig)
     // Система материалов.
     MaterialSystemConfig MaterialSysConfig;
     MaterialSysConfig.MaxMaterialCount = 4096;
-    if (!Register(MSystem::Material, MaterialSystem::Initialize, MaterialSystem::Shutdown, nullptr, &MaterialSysConfig)) {
+    MaterialSysConfig.RetentionBudget = MEBIBYTES(64);
+    MaterialSysConfig.RetentionEvictionsPerFrame = 4;
+    if (!Register(MSystem::Material, MaterialSystem::Initialize, MaterialSystem::Shutdown, MaterialSystem::Update, &MaterialSysConfig)) {
         MERROR("Не удалось зарегистрировать систему материалов.");
         return false;
     }
@@ -295,6 +343,7 @@ void SystemsManager::ShutdownKnownSystems()
     systems[MSystem::Type::Material].shutdown();
     systems[MSystem::Type::Texture].shutdown();
 
+    systems[MSystem::Type::AsyncIO].shutdown();
     systems[MSystem::Type::Job].shutdown();
     systems[MSystem::Type::Shader].shutdown();
     systems[MSystem::Type::Renderer].shutdown();
@@ -304,6 +353,8 @@ void SystemsManager::ShutdownKnownSystems()
     systems[MSystem::Input].shutdown();
     systems[MSystem::Logging].shutdown();
     systems[MSystem::Event].shutdown();
+    systems[MSystem::FramePacer].shutdown();
+    systems[MSystem::Profiler].shutdown();
     systems[MSystem::MVar].shutdown();
     systems[MSystem::Console].shutdown();
 }
@@ -37,6 +37,9 @@ struct MSystem {
         Material,
         Geometry,
         Light,
+        AsyncIO,
+        Profiler,
+        FramePacer,
     
         // ПРИМЕЧАНИЕ: Все, что находится за пределами этого, находится в пользовательском пространстве.
         KnownMax = 255,
@@ -1,4 +1,5 @@
 #include "frustrum.h"
+#include "matrix4d.h"
 
 void Frustum::Create(const FVec3 &position, const FVec3 &forward, const FVec3 &right, const FVec3 &up, f32 aspect, f32 fov, f32 near, f32 far)
 {
@@ -14,6 +15,36 @@ void Frustum::Create(const FVec3 &position, const FVec3 &forward, const FVec3 &r
     sides[Front].Create(position, Cross(ForwardFar + up * HalfV, right)); 
 }
 
+void Frustum::FromMatrix(const Matrix4D &ViewProjection)
+{
+    // Вектор-строка умножается на матрицу слева, поэтому компонента отсечения j — это столбец j матрицы.
+    const f32* m = ViewProjection.data;
+
+    // Коэффициенты столбцов x, y, z, w для каждой стороны: плоскость = w * cw + x * cx + y * cy + z * cz.
+    static constexpr f32 coefficients[6][4] = {
+        // w,    x,    y,    z
+        { 1.F,  0.F, -1.F,  0.F }, // Top:    y <= w
+        { 1.F,  0.F,  1.F,  0.F }, // Bottom: -w <= y
+        { 1.F, -1.F,  0.F,  0.F }, // Right:  x <= w
+        { 1.F,  1.F,  0.F,  0.F }, // Left:   -w <= x
+        { 1.F,  0.F,  0.F, -1.F }, // Back:   z <= w
+        { 0.F,  0.F,  0.F,  1.F }  // Front:  0 <= z
+    };
+
+    for (u8 i = 0; i < 6; ++i) {
+        const f32* c = coefficients[i];
+        f32 plane[4];
+        for (u8 r = 0; r < 4; ++r) {
+            plane[r] = c[0] * m[4 * r + 3] + c[1] * m[4 * r + 0] + c[2] * m[4 * r + 1] + c[3] * m[4 * r + 2];
+        }
+
+        const f32 length = Math::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        const f32 inv = length > 0.F ? 1.F / length : 0.F;
+        // Плоскость хранит расстояние со знаком минус: SignedDistance = Dot(n, p) - distance.
+        sides[i] = Plane(plane[0] * inv, plane[1] * inv, plane[2] * inv, -plane[3] * inv);
+    }
+}
+
 bool Frustum::IntersectsSphere(const FVec3 &center, f32 radius)
 {
     for (u8 i = 0; i < 6; ++i) {
@@ -2,6 +2,8 @@
 
 #include "plane.h"
 
+struct Matrix4D;
+
 struct MAPI Frustum
 {
 	enum Side {
@@ -24,6 +26,11 @@ struct MAPI Frustum
     /// @param far расстояние дальней плоскости отсечения.
     void Create(const FVec3& position, const FVec3& forward, const FVec3& right, const FVec3& up, f32 aspect, f32 fov, f32 near, f32 far);
 
+    /// @brief Извлекает плоскости усеченной пирамиды из матрицы вида-проекции (view * projection), как это делает
+    /// вычислительный шейдер отсечения на GPU. Глубина отсечения ожидается в диапазоне [0, 1], нормали плоскостей направлены внутрь.
+    /// @param ViewProjection константная ссылка на произведение матрицы вида на матрицу проекции.
+    void FromMatrix(const Matrix4D& ViewProjection);
+
     /// @brief Указывает, пересекает ли усеченная пирамида сферу, построенную через центр и радиус, (или содержит ее).
     /// @param center постоянная ссылка на позицию, представляющую центр сферы.
     /// @param radIus Радиус сферы.
@@ -5,6 +5,14 @@
 #include "resources/terrain.h"
 #include "plane.h"
 #include "vertex.h"
+#include "systems/job_systems.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define MGEOMETRY_SSE
+#include <xmmintrin.h>
+#endif
+
+constexpr u32 GEOMETRY_TRIANGLES_PER_RANGE = 16384; // Треугольников в одном диапазоне JobSystem::ParallelFor.
 
 namespace Math
 {
@@ -20,60 +28,227 @@ namespace Math
     }
     }
 
-    void Geometry::GenerateNormals(u32 VertexCount, Vertex3D *vertices, u32 IndexCount, u32 *indices)
+#if defined(MGEOMETRY_SSE)
+    /// @brief Четыре значения, по одному на треугольник; дорожки регистра SSE.
+    typedef __m128 Lanes;
+
+    MINLINE Lanes LanesSet(f32 a, f32 b, f32 c, f32 d) { return _mm_setr_ps(a, b, c, d); }
+    MINLINE Lanes LanesSplat(f32 a) { return _mm_set1_ps(a); }
+    MINLINE Lanes LanesAdd(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+    MINLINE Lanes LanesSub(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+    MINLINE Lanes LanesMul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+    MINLINE Lanes LanesDiv(Lanes a, Lanes b) { return _mm_div_ps(a, b); }
+    MINLINE Lanes LanesSqrt(Lanes a) { return _mm_sqrt_ps(a); }
+    MINLINE void LanesStore(f32* out, Lanes a) { _mm_storeu_ps(out, a); }
+#else
+    /// @brief Четыре значения, по одному на треугольник. Без SSE дорожки обрабатываются циклом.
+    struct Lanes { f32 v[4]; };
+
+    MINLINE Lanes LanesSet(f32 a, f32 b, f32 c, f32 d) { return { { a, b, c, d } }; }
+    MINLINE Lanes LanesSplat(f32 a) { return { { a, a, a, a } }; }
+    MINLINE Lanes LanesAdd(Lanes a, Lanes b) { for (u32 l = 0; l < 4; ++l) a.v[l] += b.v[l]; return a; }
+    MINLINE Lanes LanesSub(Lanes a, Lanes b) { for (u32 l = 0; l < 4; ++l) a.v[l] -= b.v[l]; return a; }
+    MINLINE Lanes LanesMul(Lanes a, Lanes b) { for (u32 l = 0; l < 4; ++l) a.v[l] *= b.v[l]; return a; }
+    MINLINE Lanes LanesDiv(Lanes a, Lanes b) { for (u32 l = 0; l < 4; ++l) a.v[l] /= b.v[l]; return a; }
+    MINLINE Lanes LanesSqrt(Lanes a) { for (u32 l = 0; l < 4; ++l) a.v[l] = Math::sqrt(a.v[l]); return a; }
+    MINLINE void LanesStore(f32* out, Lanes a) { for (u32 l = 0; l < 4; ++l) out[l] = a.v[l]; }
+#endif
+
+    /// @brief Векторы четырех треугольников в виде структуры массивов.
+    struct Vec3Lanes {
+        Lanes x, y, z;
+    };
+
+    MINLINE Vec3Lanes Cross(const Vec3Lanes& a, const Vec3Lanes& b)
     {
-        for (u32 i = 0; i < IndexCount; i += 3) {
-            u32 i0 = indices[i + 0];
-            u32 i1 = indices[i + 1];
-            u32 i2 = indices[i + 2];
+        return { LanesSub(LanesMul(a.y, b.z), LanesMul(a.z, b.y)),
+                 LanesSub(LanesMul(a.z, b.x), LanesMul(a.x, b.z)),
+                 LanesSub(LanesMul(a.x, b.y), LanesMul(a.y, b.x)) };
+    }
 
-            FVec3 edge1 = vertices[i1].position - vertices[i0].position;
-            FVec3 edge2 = vertices[i2].position - vertices[i0].position;
+    /// @brief Точные корень и деление, а не приближенный обратный корень, чтобы результат совпадал со скалярным Normalize.
+    MINLINE Vec3Lanes Normalize(const Vec3Lanes& v)
+    {
+        const Lanes length = LanesSqrt(LanesAdd(LanesAdd(LanesMul(v.x, v.x), LanesMul(v.y, v.y)), LanesMul(v.z, v.z)));
+        return { LanesDiv(v.x, length), LanesDiv(v.y, length), LanesDiv(v.z, length) };
+    }
 
-            FVec3 normal = Normalize(Cross(edge1, edge2));
+    /// @brief Раскладывает векторы четырех треугольников по отдельным массивам для записи в вершины.
+    struct Vec3Out {
+        f32 x[4], y[4], z[4];
+    };
 
-            // ПРИМЕЧАНИЕ: Это просто создает нормаль лица. При желании сглаживание следует выполнить отдельным проходом.
-            vertices[i0].normal = normal;
-            vertices[i1].normal = normal;
-            vertices[i2].normal = normal;
-        }
+    MINLINE void Store(Vec3Out& out, const Vec3Lanes& v)
+    {
+        LanesStore(out.x, v.x);
+        LanesStore(out.y, v.y);
+        LanesStore(out.z, v.z);
     }
 
-    void Geometry::CalculateTangents(u32 VertexCount, Vertex3D *vertices, u32 IndexCount, u32 *indices)
+    MINLINE void SetTangent(Vertex3D& vertex, const FVec3& tangent) { vertex.tangent = tangent; }
+    MINLINE void SetTangent(TerrainVertex& vertex, const FVec3& tangent) { vertex.tangent = FVec4(tangent, 0.F); }
+
+    /// @brief Общие для всех вершин данные прохода по треугольникам.
+    struct FaceOwners {
+        const u32* indices;
+        /// @brief Для каждой вершины — номер последнего ссылающегося на нее треугольника плюс один. 
+        /// nullptr, если все треугольники обходятся по порядку одним диапазоном.
+        u32* owner;
+    };
+
+    template <typename V>
+    struct FaceParams : FaceOwners {
+        V* vertices;
+    };
+
+    /// @brief Находит для каждой вершины последний ссылающийся на нее треугольник. Вершине достается значение 
+    /// последнего треугольника, как при последовательном обходе, а при параллельной записи его пишет только этот 
+    /// треугольник, поэтому результат не зависит от порядка потоков и гонок записи нет.
+    static void FindOwnersRange(void* UserData, u32 begin, u32 end)
     {
-        for (u32 i = 0; i < IndexCount; i += 3) {
-            u32 i0 = indices[i + 0];
-            u32 i1 = indices[i + 1];
-            u32 i2 = indices[i + 2];
+        const auto& params = *reinterpret_cast<FaceOwners*>(UserData);
+        // Обход с конца: вершина обычно получает владельца при первом же посещении, и дальше сравнение 
+        // с обменом не нужно.
+        for (u32 t = end; t-- > begin;) {
+            for (u32 k = 0; k < 3; ++k) {
+                u32* slot = &params.owner[params.indices[t * 3 + k]];
+                u32 current = __atomic_load_n(slot, __ATOMIC_RELAXED);
+                while (current < t + 1 && !__atomic_compare_exchange_n(slot, &current, t + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+            }
+        }
+    }
 
-            FVec3 edge1 = vertices[i1].position - vertices[i0].position;
-            FVec3 edge2 = vertices[i2].position - vertices[i0].position;
+    /// @brief Индексы четырех треугольников, начиная с first. Неполная четверка дополняется первым треугольником; 
+    /// результаты лишних дорожек отбрасываются.
+    MINLINE void GatherTriangles(const u32* indices, u32 first, u32 count, u32 (&OutTriangles)[12])
+    {
+        for (u32 l = 0; l < 4; ++l) {
+            const u32* triangle = indices + (first + (l < count ? l : 0)) * 3;
+            OutTriangles[l * 3 + 0] = triangle[0];
+            OutTriangles[l * 3 + 1] = triangle[1];
+            OutTriangles[l * 3 + 2] = triangle[2];
+        }
+    }
 
-            f32 deltaU1 = vertices[i1].texcoord.x - vertices[i0].texcoord.x;
-            f32 deltaV1 = vertices[i1].texcoord.y - vertices[i0].texcoord.y;
+    /// @brief Ребра p1 - p0 и p2 - p0 четырех треугольников.
+    template <typename V>
+    MINLINE void GatherEdges(const V* v, const u32 (&t)[12], Vec3Lanes& OutEdge1, Vec3Lanes& OutEdge2)
+    {
+        const Vec3Lanes p0 = {
+            LanesSet(v[t[0]].position.x, v[t[3]].position.x, v[t[6]].position.x, v[t[9]].position.x),
+            LanesSet(v[t[0]].position.y, v[t[3]].position.y, v[t[6]].position.y, v[t[9]].position.y),
+            LanesSet(v[t[0]].position.z, v[t[3]].position.z, v[t[6]].position.z, v[t[9]].position.z) };
+        OutEdge1 = {
+            LanesSub(LanesSet(v[t[1]].position.x, v[t[4]].position.x, v[t[7]].position.x, v[t[10]].position.x), p0.x),
+            LanesSub(LanesSet(v[t[1]].position.y, v[t[4]].position.y, v[t[7]].position.y, v[t[10]].position.y), p0.y),
+            LanesSub(LanesSet(v[t[1]].position.z, v[t[4]].position.z, v[t[7]].position.z, v[t[10]].position.z), p0.z) };
+        OutEdge2 = {
+            LanesSub(LanesSet(v[t[2]].position.x, v[t[5]].position.x, v[t[8]].position.x, v[t[11]].position.x), p0.x),
+            LanesSub(LanesSet(v[t[2]].position.y, v[t[5]].position.y, v[t[8]].position.y, v[t[11]].position.y), p0.y),
+            LanesSub(LanesSet(v[t[2]].position.z, v[t[5]].position.z, v[t[8]].position.z, v[t[11]].position.z), p0.z) };
+    }
 
-            f32 deltaU2 = vertices[i2].texcoord.x - vertices[i0].texcoord.x;
-            f32 deltaV2 = vertices[i2].texcoord.y - vertices[i0].texcoord.y;
+    /// @brief Записывает значение треугольника в его вершины; при параллельном обходе — только в те, которыми он владеет.
+    template <typename V, typename F>
+    MINLINE void ScatterToVertices(const FaceParams<V>& params, u32 first, u32 count, const u32 (&t)[12], F write)
+    {
+        for (u32 l = 0; l < count; ++l) {
+            for (u32 k = 0; k < 3; ++k) {
+                const u32 vertex = t[l * 3 + k];
+                if (!params.owner || params.owner[vertex] == first + l + 1) {
+                    write(params.vertices[vertex], l);
+                }
+            }
+        }
+    }
 
-            f32 dividend = (deltaU1 * deltaV2 - deltaU2 * deltaV1);
-            f32 fc = 1.f / dividend;
+    template <typename V>
+    static void GenerateNormalsRange(void* UserData, u32 begin, u32 end)
+    {
+        const auto& params = *reinterpret_cast<FaceParams<V>*>(UserData);
+        u32 t[12];
+        Vec3Lanes e1, e2;
+        Vec3Out normals;
+        for (u32 first = begin; first < end; first += 4) {
+            const u32 count = MMIN(4u, end - first);
+            GatherTriangles(params.indices, first, count, t);
+            GatherEdges(params.vertices, t, e1, e2);
+            Store(normals, Normalize(Cross(e1, e2)));
 
-            FVec3 tangent = FVec3(
-                (fc * (deltaV2 * edge1.x - deltaV1 * edge2.x)),
-                (fc * (deltaV2 * edge1.y - deltaV1 * edge2.y)),
-                (fc * (deltaV2 * edge1.z - deltaV1 * edge2.z)));
+            // ПРИМЕЧАНИЕ: Это просто создает нормаль лица. При желании сглаживание следует выполнить отдельным проходом.
+            ScatterToVertices(params, first, count, t, [&normals](V& vertex, u32 l) { 
+                vertex.normal = FVec3(normals.x[l], normals.y[l], normals.z[l]); 
+            });
+        }
+    }
 
-            tangent.Normalize();
+    template <typename V>
+    static void CalculateTangentsRange(void* UserData, u32 begin, u32 end)
+    {
+        const auto& params = *reinterpret_cast<FaceParams<V>*>(UserData);
+        const V* v = params.vertices;
+        u32 t[12];
+        Vec3Lanes e1, e2;
+        Vec3Out tangents;
+        f32 handedness[4];
+        for (u32 first = begin; first < end; first += 4) {
+            const u32 count = MMIN(4u, end - first);
+            GatherTriangles(params.indices, first, count, t);
+            GatherEdges(v, t, e1, e2);
+
+            const Lanes u0 = LanesSet(v[t[0]].texcoord.x, v[t[3]].texcoord.x, v[t[6]].texcoord.x, v[t[9]].texcoord.x);
+            const Lanes v0 = LanesSet(v[t[0]].texcoord.y, v[t[3]].texcoord.y, v[t[6]].texcoord.y, v[t[9]].texcoord.y);
+            const Lanes du1 = LanesSub(LanesSet(v[t[1]].texcoord.x, v[t[4]].texcoord.x, v[t[7]].texcoord.x, v[t[10]].texcoord.x), u0);
+            const Lanes dv1 = LanesSub(LanesSet(v[t[1]].texcoord.y, v[t[4]].texcoord.y, v[t[7]].texcoord.y, v[t[10]].texcoord.y), v0);
+            const Lanes du2 = LanesSub(LanesSet(v[t[2]].texcoord.x, v[t[5]].texcoord.x, v[t[8]].texcoord.x, v[t[11]].texcoord.x), u0);
+            const Lanes dv2 = LanesSub(LanesSet(v[t[2]].texcoord.y, v[t[5]].texcoord.y, v[t[8]].texcoord.y, v[t[11]].texcoord.y), v0);
+
+            // Касательная (dv2 * e1 - dv1 * e2) / (du1 * dv2 - du2 * dv1).
+            const Lanes fc = LanesDiv(LanesSplat(1.F), LanesSub(LanesMul(du1, dv2), LanesMul(du2, dv1)));
+            const Vec3Lanes tangent = {
+                LanesMul(fc, LanesSub(LanesMul(dv2, e1.x), LanesMul(dv1, e2.x))),
+                LanesMul(fc, LanesSub(LanesMul(dv2, e1.y), LanesMul(dv1, e2.y))),
+                LanesMul(fc, LanesSub(LanesMul(dv2, e1.z), LanesMul(dv1, e2.z))) };
+            Store(tangents, Normalize(tangent));
+            LanesStore(handedness, LanesSub(LanesMul(dv1, du2), LanesMul(dv2, du1)));
+
+            ScatterToVertices(params, first, count, t, [&tangents, &handedness](V& vertex, u32 l) {
+                const f32 sign = handedness[l] < 0.F ? -1.F : 1.F;
+                SetTangent(vertex, FVec3(tangents.x[l], tangents.y[l], tangents.z[l]) * sign);
+            });
+        }
+    }
 
-            f32 sx = deltaU1, sy = deltaU2;
-            f32 tx = deltaV1, ty = deltaV2;
-            f32 handedness = ((tx * sy - ty * sx) < 0.f) ? -1.f : 1.f;
-            FVec3 t4 = tangent * handedness;
-            vertices[i0].tangent = t4;
-            vertices[i1].tangent = t4;
-            vertices[i2].tangent = t4;
+    /// @brief Выполняет проход по треугольникам диапазонами через JobSystem::ParallelFor.
+    template <typename V>
+    static void RunFacePass(u32 VertexCount, V* vertices, u32 IndexCount, u32* indices, PFN_ParallelRange pass)
+    {
+        const u32 TriangleCount = IndexCount / 3;
+        FaceParams<V> params;
+        params.indices = indices;
+        params.owner = nullptr;
+        params.vertices = vertices;
+
+        // Без потоков заданий или с одним диапазоном треугольники обходятся по порядку, и владельцы вершин не нужны.
+        if (TriangleCount > GEOMETRY_TRIANGLES_PER_RANGE && JobSystem::GetThreadCount()) {
+            params.owner = reinterpret_cast<u32*>(MemorySystem::Allocate(sizeof(u32) * VertexCount, Memory::Array, true));
+            JobSystem::ParallelFor(TriangleCount, GEOMETRY_TRIANGLES_PER_RANGE, FindOwnersRange, static_cast<FaceOwners*>(&params));
+        }
+        JobSystem::ParallelFor(TriangleCount, GEOMETRY_TRIANGLES_PER_RANGE, pass, &params);
+        if (params.owner) {
+            MemorySystem::Free(params.owner, sizeof(u32) * VertexCount, Memory::Array);
         }
     }
+
+    void Geometry::GenerateNormals(u32 VertexCount, Vertex3D *vertices, u32 IndexCount, u32 *indices)
+    {
+        RunFacePass(VertexCount, vertices, IndexCount, indices, GenerateNormalsRange<Vertex3D>);
+    }
+
+    void Geometry::CalculateTangents(u32 VertexCount, Vertex3D *vertices, u32 IndexCount, u32 *indices)
+    {
+        RunFacePass(VertexCount, vertices, IndexCount, indices, CalculateTangentsRange<Vertex3D>);
+    }
 /*
     void Geometry::CalculateTangents(const DArray<Face>& triangles, DArray<Vertex3D> &vertices)
     {
@@ -183,57 +358,12 @@ namespace Math
 
     void Geometry::GenerateTerrainNormals(u32 VertexCount, TerrainVertex *vertices, u32 IndexCount, u32 *indices)
     {
-        for (u32 i = 0; i < IndexCount; i += 3) {
-            u32 i0 = indices[i + 0];
-            u32 i1 = indices[i + 1];
-            u32 i2 = indices[i + 2];
-    
-            FVec3 edge1 = vertices[i1].position - vertices[i0].position;
-            FVec3 edge2 = vertices[i2].position - vertices[i0].position;
-    
-            FVec3 normal = Normalize(Cross(edge1, edge2));
-    
-            // ПРИМЕЧАНИЕ: Это просто генерирует нормаль фейса. Сглаживание следует выполнять в отдельном проходе, если это необходимо.
-            vertices[i0].normal = normal;
-            vertices[i1].normal = normal;
-            vertices[i2].normal = normal;
-        }
+        RunFacePass(VertexCount, vertices, IndexCount, indices, GenerateNormalsRange<TerrainVertex>);
     }
 
     void Geometry::GenerateTerrainTangents(u32 VertexCount, TerrainVertex *vertices, u32 IndexCount, u32 *indices)
     {
-        for (u32 i = 0; i < IndexCount; i += 3) {
-            u32 i0 = indices[i + 0];
-            u32 i1 = indices[i + 1];
-            u32 i2 = indices[i + 2];
-    
-            FVec3 edge1 = vertices[i1].position - vertices[i0].position;
-            FVec3 edge2 = vertices[i2].position - vertices[i0].position;
-    
-            f32 deltaU1 = vertices[i1].texcoord.x - vertices[i0].texcoord.x;
-            f32 deltaV1 = vertices[i1].texcoord.y - vertices[i0].texcoord.y;
-    
-            f32 deltaU2 = vertices[i2].texcoord.x - vertices[i0].texcoord.x;
-            f32 deltaV2 = vertices[i2].texcoord.y - vertices[i0].texcoord.y;
-    
-            f32 dividend = (deltaU1 * deltaV2 - deltaU2 * deltaV1);
-            f32 fc = 1.0f / dividend;
-    
-            FVec3 tangent = FVec3((fc * (deltaV2 * edge1.x - deltaV1 * edge2.x)),
-                                  (fc * (deltaV2 * edge1.y - deltaV1 * edge2.y)),
-                                  (fc * (deltaV2 * edge1.z - deltaV1 * edge2.z)));
-    
-            tangent = Normalize(tangent);
-    
-            f32 sx = deltaU1, sy = deltaU2;
-            f32 tx = deltaV1, ty = deltaV2;
-            f32 handedness = ((tx * sy - ty * sx) < 0.F) ? -1.F : 1.F;
-    
-            FVec4 t4 = FVec4(tangent * handedness, 0.F);
-            vertices[i0].tangent = t4;
-            vertices[i1].tangent = t4;
-            vertices[i2].tangent = t4;
-        }
+        RunFacePass(VertexCount, vertices, IndexCount, indices, CalculateTangentsRange<TerrainVertex>);
     }
 
     bool RaycastAABB(Extents3D bbExtents, const Ray &ray, FVec3 &OutPoint)
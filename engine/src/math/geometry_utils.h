@@ -38,18 +38,21 @@ namespace Math
     namespace Geometry
     {
         /// @brief Вычисляет нормали для заданных данных вершин и индексов. Изменяет вершины на месте.
+        /// Треугольники обрабатываются по четыре и большими мешами делятся между потоками заданий; 
+        /// каждой вершине достается значение последнего ссылающегося на нее треугольника, как при последовательном обходе.
         /// @param VertexCount количество вершин.
         /// @param Vertices массив вершин.
         /// @param IndexCount количество индексов.
         /// @param Indices массив вершин.
-        void GenerateNormals(u32 VertexCount, Vertex3D* vertices, u32 IndexCount, u32* indices);
+        MAPI void GenerateNormals(u32 VertexCount, Vertex3D* vertices, u32 IndexCount, u32* indices);
 
         /// @brief Вычисляет касательные для заданных данных вершины и индекса. Изменяет вершины на месте.
+        /// Обработка та же, что у GenerateNormals.
         /// @param VertexCount количество вершин.
         /// @param Vertices массив вершин.
         /// @param IndexCount количество индексов.
         /// @param Indices массив вершин.
-        void CalculateTangents(u32 VertexCount, Vertex3D* vertices, u32 IndexCount, u32* indices);
+        MAPI void CalculateTangents(u32 VertexCount, Vertex3D* vertices, u32 IndexCount, u32* indices);
 
         //void CalculateTangents(const DArray<Face>& triangleArray, DArray<Vertex3D> &vertices);
 
@@ -59,9 +62,11 @@ namespace Math
         /// @param geometry конфигурация геометрии из которой нужно удаляить дубликаты вершин
         void DeduplicateVertices(GeometryConfig& geometry);
 
-        void GenerateTerrainNormals(u32 VertexCount, struct TerrainVertex *vertices, u32 IndexCount, u32 *indices);
+        /// @brief То же, что GenerateNormals, для вершин ландшафта.
+        MAPI void GenerateTerrainNormals(u32 VertexCount, struct TerrainVertex *vertices, u32 IndexCount, u32 *indices);
 
-        void GenerateTerrainTangents(u32 VertexCount, struct TerrainVertex *vertices, u32 IndexCount, u32 *indices);
+        /// @brief То же, что CalculateTangents, для вершин ландшафта; w касательной равна 0.
+        MAPI void GenerateTerrainTangents(u32 VertexCount, struct TerrainVertex *vertices, u32 IndexCount, u32 *indices);
     } // namespace Geometry
 
     MAPI Ray RaycastFromScreen(const FVec2& ScreenPosition, const Rect2D& ViewportRect, const FVec3& origin, const Matrix4D& view, const Matrix4D projection);
@@ -0,0 +1,332 @@
+#include "asset_pack.hpp"
+#include "filesystem.hpp"
+
+#include "core/logger.hpp"
+#include "core/memory_system.h"
+#include "utils/lz4.h"
+
+// Файлы меньшего размера не сжимаются: выигрыш не окупает распаковку.
+constexpr u64 MIN_COMPRESS_SIZE = 256;
+
+/// @brief Приводит символ пути к нормализованному виду: нижний регистр, '/' в качестве разделителя.
+MINLINE char NormalizeChar(char c)
+{
+    if (c == '\\') {
+        return '/';
+    }
+    if (c >= 'A' && c <= 'Z') {
+        return c + ('a' - 'A');
+    }
+    return c;
+}
+
+/// @brief Сравнивает путь с именем из таблицы имен без учета регистра и вида разделителей.
+static bool NamesEqual(const char* path, u64 PathLength, const char* name, u64 NameLength)
+{
+    if (PathLength != NameLength) {
+        return false;
+    }
+    for (u64 i = 0; i < PathLength; ++i) {
+        if (NormalizeChar(path[i]) != NormalizeChar(name[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Проверяет, что диапазон [offset, offset + size) лежит в пределах limit, без переполнения при сложении.
+MINLINE bool RangeInside(u64 offset, u64 size, u64 limit)
+{
+    return offset <= limit && size <= limit - offset;
+}
+
+/// @brief Просеивание для пирамидальной сортировки записей по хешу.
+static void SiftDown(AssetPackEntry* entries, u32 root, u32 count)
+{
+    while (true) {
+        u32 largest = root;
+        const u32 left = root * 2 + 1;
+        const u32 right = left + 1;
+        if (left < count && entries[left].hash > entries[largest].hash) {
+            largest = left;
+        }
+        if (right < count && entries[right].hash > entries[largest].hash) {
+            largest = right;
+        }
+        if (largest == root) {
+            return;
+        }
+        const AssetPackEntry temp = entries[root];
+        entries[root] = entries[largest];
+        entries[largest] = temp;
+        root = largest;
+    }
+}
+
+static void SortEntries(AssetPackEntry* entries, u32 count)
+{
+    for (u32 i = count / 2; i > 0; --i) {
+        SiftDown(entries, i - 1, count);
+    }
+    for (u32 end = count; end > 1; --end) {
+        const AssetPackEntry temp = entries[0];
+        entries[0] = entries[end - 1];
+        entries[end - 1] = temp;
+        SiftDown(entries, 0, end - 1);
+    }
+}
+
+bool AssetPack::Open(const char *PackPath, const char *RootPath)
+{
+    if (!PackPath || !RootPath) {
+        return false;
+    }
+
+    const u32 length = MString::Length(RootPath);
+    if (length >= sizeof(this->RootPath)) {
+        MERROR("AssetPack::Open: слишком длинный корневой путь '%s'.", RootPath);
+        return false;
+    }
+
+    if (!PlatformFileMap(PackPath, mapping)) {
+        return false;
+    }
+
+    const auto* data = reinterpret_cast<const u8*>(mapping.data);
+    const auto* hdr = reinterpret_cast<const AssetPackHeader*>(data);
+    if (mapping.size < sizeof(AssetPackHeader) || hdr->MagicNumber != ASSET_PACK_MAGIC || hdr->version != ASSET_PACK_VERSION) {
+        MERROR("AssetPack::Open: файл '%s' не является пакетом ресурсов или имеет неподдерживаемую версию.", PackPath);
+        PlatformFileUnmap(mapping);
+        return false;
+    }
+    if (!RangeInside(hdr->TocOffset, (u64)hdr->EntryCount * sizeof(AssetPackEntry), mapping.size) ||
+        !RangeInside(hdr->NamesOffset, hdr->NamesSize, mapping.size)) {
+        MERROR("AssetPack::Open: пакет ресурсов '%s' поврежден.", PackPath);
+        PlatformFileUnmap(mapping);
+        return false;
+    }
+
+    // Каждая запись проверяется сразу, чтобы поиск и распаковка не читали за пределами отображения.
+    const auto* toc = reinterpret_cast<const AssetPackEntry*>(data + hdr->TocOffset);
+    for (u32 i = 0; i < hdr->EntryCount; ++i) {
+        const auto& entry = toc[i];
+        const bool compressed = entry.flags & AssetPackEntry::Compressed;
+        if (!RangeInside(entry.offset, entry.size, mapping.size) ||
+            !RangeInside(entry.NameOffset, entry.NameLength, hdr->NamesSize) ||
+            (!compressed && entry.size != entry.UncompressedSize)) {
+            MERROR("AssetPack::Open: запись %u пакета ресурсов '%s' выходит за пределы файла или повреждена.", i, PackPath);
+            PlatformFileUnmap(mapping);
+            return false;
+        }
+    }
+
+    header = hdr;
+    entries = reinterpret_cast<const AssetPackEntry*>(data + hdr->TocOffset);
+    names = reinterpret_cast<const char*>(data + hdr->NamesOffset);
+
+    MemorySystem::CopyMem(this->RootPath, RootPath, length + 1);
+    RootLength = length;
+    // Завершающий разделитель не учитывается, он пропускается при поиске.
+    while (RootLength > 0 && (this->RootPath[RootLength - 1] == '/' || this->RootPath[RootLength - 1] == '\\')) {
+        this->RootPath[--RootLength] = 0;
+    }
+
+    MINFO("Подключен пакет ресурсов '%s': %u файлов.", PackPath, hdr->EntryCount);
+    return true;
+}
+
+void AssetPack::Close()
+{
+    if (header) {
+        PlatformFileUnmap(mapping);
+    }
+    header = nullptr;
+    entries = nullptr;
+    names = nullptr;
+    RootPath[0] = 0;
+    RootLength = 0;
+}
+
+const AssetPackEntry *AssetPack::Find(const char *path) const
+{
+    if (!header || !path) {
+        return nullptr;
+    }
+
+    // Отбрасывается корневой путь вместе с разделителем.
+    if (!NamesEqual(path, RootLength, RootPath, RootLength) || (path[RootLength] != '/' && path[RootLength] != '\\')) {
+        return nullptr;
+    }
+    const char* name = path + RootLength + 1;
+    const u64 length = MString::Length(name);
+    const u64 hash = Hash(name, length);
+
+    // Нижняя граница бинарным поиском, затем перебор записей с тем же хешем.
+    u32 lo = 0;
+    u32 hi = header->EntryCount;
+    while (lo < hi) {
+        const u32 mid = lo + (hi - lo) / 2;
+        if (entries[mid].hash < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    for (u32 i = lo; i < header->EntryCount && entries[i].hash == hash; ++i) {
+        if (NamesEqual(name, length, names + entries[i].NameOffset, entries[i].NameLength)) {
+            return &entries[i];
+        }
+    }
+    return nullptr;
+}
+
+u64 AssetPack::Hash(const char *name, u64 length)
+{
+    u64 hash = 14695981039346656037ULL;
+    for (u64 i = 0; i < length; ++i) {
+        hash ^= (u8)NormalizeChar(name[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool AssetPack::Write(const char *OutPath, const char *RootPath, const char *const *names, u32 NameCount, bool compress)
+{
+    if (!OutPath || !RootPath || !names || NameCount == 0) {
+        MERROR("AssetPack::Write: неверные параметры.");
+        return false;
+    }
+
+    FileHandle pack;
+    if (!Filesystem::Open(OutPath, FileModes::Write, true, pack)) {
+        return false;
+    }
+
+    // Заголовок записывается в конце, когда известны смещения оглавления и таблицы имен.
+    AssetPackHeader header{};
+    u64 written = 0;
+    CLOSE_IF_FAILED(Filesystem::Write(pack, sizeof(AssetPackHeader), &header, written), pack);
+    u64 offset = sizeof(AssetPackHeader);
+
+    auto entries = reinterpret_cast<AssetPackEntry*>(MemorySystem::Allocate(sizeof(AssetPackEntry) * NameCount, Memory::Resource));
+    u32 NamesSize = 0;
+    for (u32 i = 0; i < NameCount; ++i) {
+        NamesSize += MString::Length(names[i]) + 1;
+    }
+    auto NameTable = reinterpret_cast<char*>(MemorySystem::Allocate(NamesSize, Memory::String));
+
+    u64 TotalSize = 0;
+    u64 StoredSize = 0;
+    u32 NameOffset = 0;
+    bool success = true;
+    char path[512]{};
+    for (u32 i = 0; i < NameCount && success; ++i) {
+        const u32 NameLength = MString::Length(names[i]);
+        MString::Format(path, "%s/%s", RootPath, names[i]);
+
+        FileHandle f;
+        u64 size = 0;
+        if (!Filesystem::Open(path, FileModes::Read, true, f) || !Filesystem::Size(f, size)) {
+            MERROR("AssetPack::Write: не удалось прочитать файл '%s'.", path);
+            success = false;
+            break;
+        }
+
+        u8* data = nullptr;
+        u64 BytesRead = 0;
+        if (size > 0) {
+            data = reinterpret_cast<u8*>(MemorySystem::Allocate(size, Memory::Resource));
+            if (!Filesystem::ReadAllBytes(f, data, BytesRead)) {
+                MERROR("AssetPack::Write: не удалось прочитать файл '%s'.", path);
+                success = false;
+            }
+        }
+        Filesystem::Close(f);
+
+        AssetPackEntry& entry = entries[i];
+        entry.hash = Hash(names[i], NameLength);
+        entry.offset = offset;
+        entry.size = size;
+        entry.UncompressedSize = size;
+        entry.NameOffset = NameOffset;
+        entry.NameLength = (u16)NameLength;
+        entry.flags = AssetPackEntry::None;
+
+        const u8* stored = data;
+        u8* compressed = nullptr;
+        u64 CompressedCapacity = 0;
+        if (success && compress && size >= MIN_COMPRESS_SIZE) {
+            CompressedCapacity = LZ4::CompressBound(size);
+            compressed = reinterpret_cast<u8*>(MemorySystem::Allocate(CompressedCapacity, Memory::Resource));
+            const u64 CompressedSize = LZ4::Compress(data, size, compressed, CompressedCapacity);
+            // Уже сжатые форматы (png, jpg) почти не сжимаются, их выгоднее хранить как есть.
+            if (CompressedSize > 0 && CompressedSize < size - size / 10) {
+                stored = compressed;
+                entry.size = CompressedSize;
+                entry.flags |= AssetPackEntry::Compressed;
+            }
+        }
+
+        if (success && entry.size > 0 && (!Filesystem::Write(pack, entry.size, stored, written) || written != entry.size)) {
+            MERROR("AssetPack::Write: ошибка записи в '%s'.", OutPath);
+            success = false;
+        }
+
+        if (compressed) {
+            MemorySystem::Free(compressed, CompressedCapacity, Memory::Resource);
+        }
+        if (data) {
+            MemorySystem::Free(data, size, Memory::Resource);
+        }
+
+        MemorySystem::CopyMem(NameTable + NameOffset, names[i], NameLength + 1);
+        NameOffset += NameLength + 1;
+        offset += entry.size;
+        TotalSize += entry.UncompressedSize;
+        StoredSize += entry.size;
+    }
+
+    if (success) {
+        SortEntries(entries, NameCount);
+        for (u32 i = 1; i < NameCount; ++i) {
+            if (entries[i].hash == entries[i - 1].hash &&
+                NamesEqual(NameTable + entries[i].NameOffset, entries[i].NameLength, NameTable + entries[i - 1].NameOffset, entries[i - 1].NameLength)) {
+                MERROR("AssetPack::Write: файл '%s' указан дважды.", NameTable + entries[i].NameOffset);
+                success = false;
+                break;
+            }
+        }
+    }
+
+    if (success) {
+        // Оглавление выравнивается по 8 байтам, чтобы к нему можно было обращаться напрямую из отображения.
+        const u8 padding[8]{};
+        const u64 PaddingSize = Range::GetAligned(offset, 8) - offset;
+        if (PaddingSize > 0) {
+            success = Filesystem::Write(pack, PaddingSize, padding, written);
+        }
+        header.MagicNumber = ASSET_PACK_MAGIC;
+        header.version = ASSET_PACK_VERSION;
+        header.EntryCount = NameCount;
+        header.NamesSize = NamesSize;
+        header.TocOffset = offset + PaddingSize;
+        header.NamesOffset = header.TocOffset + sizeof(AssetPackEntry) * NameCount;
+        success = success &&
+            Filesystem::Write(pack, sizeof(AssetPackEntry) * NameCount, entries, written) &&
+            Filesystem::Write(pack, NamesSize, NameTable, written) &&
+            Filesystem::Seek(pack, 0) &&
+            Filesystem::Write(pack, sizeof(AssetPackHeader), &header, written);
+        if (!success) {
+            MERROR("AssetPack::Write: ошибка записи в '%s'.", OutPath);
+        }
+    }
+
+    MemorySystem::Free(NameTable, NamesSize, Memory::String);
+    MemorySystem::Free(entries, sizeof(AssetPackEntry) * NameCount, Memory::Resource);
+    Filesystem::Close(pack);
+
+    if (success) {
+        MINFO("Пакет ресурсов '%s' создан: %u файлов, %llu байт (исходный размер %llu байт).", OutPath, NameCount, StoredSize, TotalSize);
+    }
+    return success;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "platform/platform.hpp"
+
+/// @brief Магическое число, указывающее на файл пакета ресурсов ('MPAK').
+constexpr u32 ASSET_PACK_MAGIC = 0x4B41504D;
+/// @brief Текущая версия формата пакета ресурсов.
+constexpr u16 ASSET_PACK_VERSION = 1;
+
+/// @brief Заголовок пакета ресурсов. Располагается в начале файла.
+/// Раскладка файла: заголовок | данные записей | оглавление (отсортировано по хешу) | таблица имен.
+struct AssetPackHeader {
+    u32 MagicNumber;    // Магическое число ASSET_PACK_MAGIC.
+    u16 version;        // Версия формата.
+    u16 reserved;       // Зарезервировано для будущих данных заголовка.
+    u32 EntryCount;     // Количество записей в оглавлении.
+    u32 NamesSize;      // Размер таблицы имен в байтах.
+    u64 TocOffset;      // Смещение оглавления от начала файла.
+    u64 NamesOffset;    // Смещение таблицы имен от начала файла.
+};
+
+/// @brief Запись оглавления пакета ресурсов.
+struct AssetPackEntry {
+    /// @brief Флаги записи.
+    enum Flags : u16 {
+        None       = 0x0,
+        Compressed = 0x1,   // Данные сжаты в блочном формате LZ4.
+    };
+
+    u64 hash;               // Хеш нормализованного относительного пути.
+    u64 offset;             // Смещение данных от начала файла.
+    u64 size;               // Размер хранимых (возможно, сжатых) данных в байтах.
+    u64 UncompressedSize;   // Размер исходного файла в байтах.
+    u32 NameOffset;         // Смещение имени в таблице имен. Используется для разрешения коллизий хеша.
+    u16 NameLength;         // Длина имени без завершающего нуля.
+    u16 flags;              // Флаги записи.
+};
+
+/// @brief Пакет ресурсов, отображенный в память. Имена файлов разрешаются бинарным поиском по оглавлению,
+/// поэтому открытие ресурса из пакета не требует обращений к файловой системе.
+class AssetPack
+{
+    FileMapping mapping;
+    const AssetPackHeader* header;
+    const AssetPackEntry* entries;
+    const char* names;
+    char RootPath[256];     // Путь, относительно которого хранятся имена в пакете (например, "../assets").
+    u32 RootLength;
+public:
+    constexpr AssetPack() : mapping(), header(nullptr), entries(nullptr), names(nullptr), RootPath(), RootLength() {}
+
+    /// @brief Открывает пакет, отображая его в память, и проверяет заголовок.
+    /// @param PackPath путь к файлу пакета.
+    /// @param RootPath путь, с которого начинаются полные пути ресурсов, хранящихся в пакете.
+    /// @return true в случае успеха; в противном случае false.
+    bool Open(const char* PackPath, const char* RootPath);
+
+    /// @brief Закрывает пакет и снимает отображение.
+    void Close();
+
+    /// @brief Ищет запись по полному пути файла (например, "../assets/textures/Sand.png").
+    /// @param path полный путь файла.
+    /// @return указатель на запись или nullptr, если файла нет в пакете.
+    const AssetPackEntry* Find(const char* path) const;
+
+    /// @brief Возвращает указатель на хранимые данные записи внутри отображения.
+    MINLINE const u8* EntryData(const AssetPackEntry& entry) const { return reinterpret_cast<const u8*>(mapping.data) + entry.offset; }
+
+    constexpr bool IsOpen() const { return header != nullptr; }
+
+    /// @brief Вычисляет хеш относительного пути. Регистр и вид разделителей ('/' или '\\') не учитываются.
+    /// @param name относительный путь.
+    /// @param length длина пути в символах.
+    /// @return 64-битный хеш FNV-1a.
+    MAPI static u64 Hash(const char* name, u64 length);
+
+    /// @brief Создает файл пакета из набора файлов.
+    /// @param OutPath путь к создаваемому пакету.
+    /// @param RootPath каталог, относительно которого заданы имена.
+    /// @param names относительные пути включаемых файлов.
+    /// @param NameCount количество файлов.
+    /// @param compress сжимать ли данные LZ4. Данные хранятся несжатыми, если сжатие не дает выигрыша.
+    /// @return true в случае успеха; в противном случае false.
+    MAPI static bool Write(const char* OutPath, const char* RootPath, const char* const* names, u32 NameCount, bool compress);
+};
@@ -0,0 +1,569 @@
+#include "async_io.hpp"
+#include "filesystem.hpp"
+#include "platform.hpp"
+
+#include "containers/ring_queue.hpp"
+#include "core/logger.hpp"
+#include "core/mmutex.hpp"
+#include "core/mthread.hpp"
+#include <new>
+
+#if MPLATFORM_LINUX
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+constexpr u32 MAX_ASYNC_IO_WORKERS = 8;
+constexpr u32 MAX_QUEUED_READS = 4096;
+
+/// @brief Запрос чтения файла. Живет от вызова Read до отправки задания.
+struct ReadRequest {
+    char path[512];
+    Job::Info info;
+    u8* data;
+    u64 size;
+    u64 offset;
+    i32 fd;
+};
+
+#if MPLATFORM_LINUX
+// Максимальный размер одного чтения; файлы большего размера читаются несколькими запросами.
+constexpr u64 MAX_READ_CHUNK = 1ULL << 30;
+
+/// @brief Кольца отправки и завершения io_uring, отображенные в память процесса.
+struct IoUring {
+    i32 fd{-1};
+    u32 entries{};
+    u32* SqHead{};
+    u32* SqTail{};
+    u32* SqMask{};
+    u32* SqArray{};
+    io_uring_sqe* sqes{};
+    u32* CqHead{};
+    u32* CqTail{};
+    u32* CqMask{};
+    io_uring_cqe* cqes{};
+    void* SqRing{};
+    u64 SqRingSize{};
+    void* CqRing{};
+    u64 CqRingSize{};
+    u64 SqesSize{};
+};
+#endif
+
+struct sAsyncIO {
+    volatile bool running;
+    bool UseIoUring;
+    u8 WorkerCount;
+    u32 QueueDepth;
+    MThread threads[MAX_ASYNC_IO_WORKERS];
+
+    RingQueue requests;
+    MMutex QueueMutex;
+    // Защищены QueueMutex.
+    u32 pending;
+    u32 PeakPending;
+
+#if MPLATFORM_LINUX
+    IoUring ring;
+    u32 InFlight;       // Запросы, отправленные в io_uring. Используются только потоком io_uring.
+    u32 Unsubmitted;    // Подготовленные, но еще не отправленные записи очереди отправки.
+#endif
+
+    sAsyncIO(AsyncIOConfig* config)
+    :
+    running     (true),
+    UseIoUring  (false),
+    WorkerCount (config->WorkerCount),
+    QueueDepth  (config->QueueDepth),
+    threads     (),
+    requests    (sizeof(ReadRequest*), MAX_QUEUED_READS, nullptr),
+    QueueMutex  (),
+    pending     (),
+    PeakPending ()
+#if MPLATFORM_LINUX
+    , ring(), InFlight(), Unsubmitted()
+#endif
+    {}
+};
+
+static sAsyncIO* pState = nullptr;
+
+static bool DequeueRequest(ReadRequest*& OutRequest)
+{
+    OutRequest = nullptr;
+    if (!pState->QueueMutex.Lock()) {
+        MERROR("Не удалось получить блокировку мьютекса очереди чтения!");
+    }
+    bool result = pState->requests.Dequeue(&OutRequest);
+    if (!pState->QueueMutex.Unlock()) {
+        MERROR("Не удалось снять блокировку мьютекса очереди чтения!");
+    }
+    return result;
+}
+
+static void FreeRequest(ReadRequest* request, bool FreeJob)
+{
+    if (FreeJob) {
+        if (request->info.ParamData) {
+            MemorySystem::Free(request->info.ParamData, request->info.ParamDataSize, Memory::Job);
+        }
+        if (request->info.ResultData) {
+            MemorySystem::Free(request->info.ResultData, request->info.ResultDataSize, Memory::Job);
+        }
+    }
+    if (request->data) {
+        MemorySystem::Free(request->data, request->size, Memory::Resource);
+    }
+    MemorySystem::Free(request, sizeof(ReadRequest), Memory::Job);
+}
+
+/// @brief Передает результат чтения заданию и отправляет его в систему заданий.
+static void Complete(ReadRequest* request, bool success)
+{
+    auto result = reinterpret_cast<AsyncIO::ReadResult*>(request->info.ParamData);
+    result->success = success;
+    result->size = success ? request->size : 0;
+    result->data = success ? request->data : nullptr;
+    if (success) {
+        // Владение данными переходит к заданию.
+        request->data = nullptr;
+    }
+
+    // Декодирование начинается сразу на свободном потоке заданий, а не на следующем обновлении системы заданий.
+    JobSystem::SubmitNow(request->info);
+
+    if (!pState->QueueMutex.Lock()) {
+        MERROR("Не удалось получить блокировку мьютекса очереди чтения!");
+    }
+    pState->pending--;
+    if (!pState->QueueMutex.Unlock()) {
+        MERROR("Не удалось снять блокировку мьютекса очереди чтения!");
+    }
+
+    // Параметры задания теперь принадлежат системе заданий.
+    FreeRequest(request, false);
+}
+
+/// @brief Читает файл целиком блокирующим вызовом через файловую систему (поддерживает пакеты ресурсов).
+static bool ReadBlocking(ReadRequest* request)
+{
+    FileHandle f;
+    if (!Filesystem::Open(request->path, FileModes::Read, true, f)) {
+        return false;
+    }
+    u64 size = 0;
+    if (!Filesystem::Size(f, size)) {
+        Filesystem::Close(f);
+        return false;
+    }
+    if (request->data) {
+        MemorySystem::Free(request->data, request->size, Memory::Resource);
+        request->data = nullptr;
+    }
+    request->size = size;
+    bool result = true;
+    if (size > 0) {
+        request->data = reinterpret_cast<u8*>(MemorySystem::Allocate(size, Memory::Resource));
+        u64 BytesRead = 0;
+        result = Filesystem::ReadAllBytes(f, request->data, BytesRead) && BytesRead == size;
+    }
+    Filesystem::Close(f);
+    return result;
+}
+
+/// @brief Поток пула, выполняющий чтения, когда io_uring недоступен.
+static u32 WorkerRun(void* params)
+{
+    while (pState && pState->running) {
+        ReadRequest* request = nullptr;
+        if (DequeueRequest(request) && request) {
+            Complete(request, ReadBlocking(request));
+        } else {
+            PlatformSleep(1);
+        }
+    }
+    return 1;
+}
+
+#if MPLATFORM_LINUX
+
+static bool IoUringCreate(IoUring& ring, u32 entries)
+{
+    io_uring_params params{};
+    i32 fd = (i32)syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) {
+        return false;
+    }
+
+    ring.fd = fd;
+    ring.entries = params.sq_entries;
+    ring.SqRingSize = params.sq_off.array + params.sq_entries * sizeof(u32);
+    ring.CqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    ring.SqesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+    // Начиная с Linux 5.4 оба кольца отображаются одним вызовом.
+    const bool SingleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (SingleMap) {
+        if (ring.CqRingSize > ring.SqRingSize) {
+            ring.SqRingSize = ring.CqRingSize;
+        }
+        ring.CqRingSize = ring.SqRingSize;
+    }
+
+    ring.SqRing = mmap(0, ring.SqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (ring.SqRing == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    ring.CqRing = SingleMap ? ring.SqRing : mmap(0, ring.CqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    void* sqes = mmap(0, ring.SqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (ring.CqRing == MAP_FAILED || sqes == MAP_FAILED) {
+        if (ring.CqRing != MAP_FAILED && !SingleMap) {
+            munmap(ring.CqRing, ring.CqRingSize);
+        }
+        munmap(ring.SqRing, ring.SqRingSize);
+        close(fd);
+        return false;
+    }
+
+    auto sq = reinterpret_cast<u8*>(ring.SqRing);
+    auto cq = reinterpret_cast<u8*>(ring.CqRing);
+    ring.SqHead  = reinterpret_cast<u32*>(sq + params.sq_off.head);
+    ring.SqTail  = reinterpret_cast<u32*>(sq + params.sq_off.tail);
+    ring.SqMask  = reinterpret_cast<u32*>(sq + params.sq_off.ring_mask);
+    ring.SqArray = reinterpret_cast<u32*>(sq + params.sq_off.array);
+    ring.sqes    = reinterpret_cast<io_uring_sqe*>(sqes);
+    ring.CqHead  = reinterpret_cast<u32*>(cq + params.cq_off.head);
+    ring.CqTail  = reinterpret_cast<u32*>(cq + params.cq_off.tail);
+    ring.CqMask  = reinterpret_cast<u32*>(cq + params.cq_off.ring_mask);
+    ring.cqes    = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+}
+
+static void IoUringDestroy(IoUring& ring)
+{
+    if (ring.fd < 0) {
+        return;
+    }
+    munmap(ring.sqes, ring.SqesSize);
+    if (ring.CqRing != ring.SqRing) {
+        munmap(ring.CqRing, ring.CqRingSize);
+    }
+    munmap(ring.SqRing, ring.SqRingSize);
+    close(ring.fd);
+    ring = IoUring();
+}
+
+/// @brief Добавляет в очередь отправки чтение следующего фрагмента файла.
+static bool IoUringPushRead(IoUring& ring, ReadRequest* request)
+{
+    const u32 tail = *ring.SqTail;
+    if (tail - __atomic_load_n(ring.SqHead, __ATOMIC_ACQUIRE) >= ring.entries) {
+        return false;
+    }
+
+    const u32 index = tail & *ring.SqMask;
+    io_uring_sqe& sqe = ring.sqes[index];
+    MemorySystem::ZeroMem(&sqe, sizeof(io_uring_sqe));
+    const u64 remaining = request->size - request->offset;
+    sqe.opcode = IORING_OP_READ;
+    sqe.fd = request->fd;
+    sqe.addr = reinterpret_cast<u64>(request->data + request->offset);
+    sqe.len = (u32)(remaining < MAX_READ_CHUNK ? remaining : MAX_READ_CHUNK);
+    sqe.off = request->offset;
+    sqe.user_data = reinterpret_cast<u64>(request);
+    ring.SqArray[index] = index;
+
+    __atomic_store_n(ring.SqTail, tail + 1, __ATOMIC_RELEASE);
+    pState->Unsubmitted++;
+    return true;
+}
+
+/// @brief Открывает файл и ставит в очередь его чтение. Файлы из пакетов и пустые файлы завершаются сразу.
+static void IoUringBegin(ReadRequest* request)
+{
+    if (Filesystem::IsPacked(request->path)) {
+        Complete(request, ReadBlocking(request));
+        return;
+    }
+
+    request->fd = open(request->path, O_RDONLY | O_CLOEXEC);
+    struct stat info;
+    if (request->fd < 0 || fstat(request->fd, &info) != 0) {
+        if (request->fd >= 0) {
+            close(request->fd);
+        }
+        Complete(request, false);
+        return;
+    }
+
+    request->size = (u64)info.st_size;
+    request->offset = 0;
+    if (request->size == 0) {
+        close(request->fd);
+        Complete(request, true);
+        return;
+    }
+
+    request->data = reinterpret_cast<u8*>(MemorySystem::Allocate(request->size, Memory::Resource));
+    // Место в очереди отправки гарантировано: InFlight < entries.
+    IoUringPushRead(pState->ring, request);
+    pState->InFlight++;
+}
+
+/// @brief Дочитывает остаток файла с текущего смещения блокирующими вызовами pread.
+/// @return true, если файл прочитан до конца; в противном случае false.
+static bool ReadRemainder(ReadRequest* request)
+{
+    while (request->offset < request->size) {
+        const u64 length = MMIN(request->size - request->offset, MAX_READ_CHUNK);
+        const ssize_t count = pread(request->fd, request->data + request->offset, length, (off_t)request->offset);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        request->offset += (u64)count;
+    }
+    return true;
+}
+
+/// @brief Обрабатывает завершенные чтения. Возвращает количество обработанных записей.
+static u32 IoUringReap(IoUring& ring)
+{
+    u32 head = *ring.CqHead;
+    const u32 tail = __atomic_load_n(ring.CqTail, __ATOMIC_ACQUIRE);
+    u32 count = 0;
+    while (head != tail) {
+        const io_uring_cqe& cqe = ring.cqes[head & *ring.CqMask];
+        auto request = reinterpret_cast<ReadRequest*>(cqe.user_data);
+        const i32 res = cqe.res;
+        head++;
+        count++;
+
+        if (res > 0) {
+            request->offset += (u64)res;
+            if (request->offset < request->size && IoUringPushRead(ring, request)) {
+                // Короткое чтение: дочитываем остаток.
+                continue;
+            }
+        }
+
+        pState->InFlight--;
+        bool success = false;
+        if (res == -EINVAL || res == -EOPNOTSUPP) {
+            // Ядро не поддерживает IORING_OP_READ (до Linux 5.6).
+            close(request->fd);
+            success = ReadBlocking(request);
+        } else {
+            // Остаток, который не удалось дочитать через io_uring (очередь отправки заполнена или чтение прервано),
+            // дочитывается блокирующим вызовом, а не считается ошибкой всего файла.
+            success = request->offset == request->size || ReadRemainder(request);
+            close(request->fd);
+        }
+        Complete(request, success);
+    }
+    __atomic_store_n(ring.CqHead, head, __ATOMIC_RELEASE);
+    return count;
+}
+
+/// @brief Поток, отправляющий пакеты чтений в io_uring и обрабатывающий их завершение.
+static u32 IoUringRun(void* params)
+{
+    auto& ring = pState->ring;
+    while (pState->running || pState->InFlight > 0) {
+        // Заполняем очередь отправки, пока есть место.
+        bool dequeued = false;
+        while (pState->running && pState->InFlight < ring.entries) {
+            ReadRequest* request = nullptr;
+            if (!DequeueRequest(request) || !request) {
+                break;
+            }
+            dequeued = true;
+            IoUringBegin(request);
+        }
+
+        if (pState->Unsubmitted == 0 && pState->InFlight == 0) {
+            PlatformSleep(1);
+            continue;
+        }
+
+        // Новые запросы отправляются одним системным вызовом. Если отправлять нечего, ждем хотя бы одного завершения.
+        const u32 flags = IORING_ENTER_GETEVENTS;
+        const u32 MinComplete = (pState->Unsubmitted == 0 && !dequeued) ? 1 : 0;
+        i32 submitted = (i32)syscall(__NR_io_uring_enter, ring.fd, pState->Unsubmitted, MinComplete, flags, nullptr, 0);
+        if (submitted > 0) {
+            pState->Unsubmitted -= (u32)submitted;
+        } else if (submitted < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            MERROR("io_uring_enter завершился ошибкой %i.", errno);
+        }
+
+        IoUringReap(ring);
+    }
+    return 1;
+}
+
+#endif
+
+bool AsyncIO::Initialize(u64 &MemoryRequirement, void *memory, void *config)
+{
+    MemoryRequirement = sizeof(sAsyncIO);
+    if (!memory) {
+        return true;
+    }
+
+    auto pConfig = reinterpret_cast<AsyncIOConfig*>(config);
+    if (pConfig->WorkerCount == 0 || pConfig->WorkerCount > MAX_ASYNC_IO_WORKERS) {
+        pConfig->WorkerCount = pConfig->WorkerCount == 0 ? 1 : MAX_ASYNC_IO_WORKERS;
+    }
+    if (pConfig->QueueDepth == 0) {
+        pConfig->QueueDepth = 64;
+    }
+
+    pState = new(memory) sAsyncIO(pConfig);
+    if (!pState->QueueMutex) {
+        MERROR("Не удалось создать мьютекс очереди чтения.");
+        return false;
+    }
+
+#if MPLATFORM_LINUX
+    if (IoUringCreate(pState->ring, pState->QueueDepth)) {
+        pState->UseIoUring = true;
+        if (!pState->threads[0].Create(IoUringRun, nullptr, false)) {
+            MFATAL("Ошибка ОС при создании потока io_uring.");
+            return false;
+        }
+        MINFO("Асинхронный ввод-вывод использует io_uring (глубина очереди %u).", pState->ring.entries);
+        return true;
+    }
+    MWARN("io_uring недоступен (errno %i), используется пул потоков.", errno);
+#endif
+
+    for (u8 i = 0; i < pState->WorkerCount; ++i) {
+        if (!pState->threads[i].Create(WorkerRun, nullptr, false)) {
+            MFATAL("Ошибка ОС при создании потока асинхронного ввода-вывода.");
+            return false;
+        }
+    }
+    MINFO("Асинхронный ввод-вывод использует пул из %u потоков.", pState->WorkerCount);
+    return true;
+}
+
+void AsyncIO::Shutdown()
+{
+    if (!pState) {
+        return;
+    }
+
+    pState->running = false;
+    const u8 ThreadCount = pState->UseIoUring ? 1 : pState->WorkerCount;
+    for (u8 i = 0; i < ThreadCount; ++i) {
+        while (pState->threads[i].IsActive()) {
+            PlatformSleep(1);
+        }
+        pState->threads[i].~MThread();
+    }
+
+    // Запросы, которые так и не были прочитаны, отбрасываются вместе с заданиями.
+    ReadRequest* request = nullptr;
+    while (DequeueRequest(request) && request) {
+        FreeRequest(request, true);
+    }
+
+#if MPLATFORM_LINUX
+    IoUringDestroy(pState->ring);
+#endif
+
+    pState->requests.~RingQueue();
+    pState->QueueMutex.~MMutex();
+    pState = nullptr;
+}
+
+bool AsyncIO::Read(const char *path, Job::Info &info)
+{
+    if (!pState || !path || !info.EntryPoint) {
+        return false;
+    }
+    if (!info.ParamData || info.ParamDataSize < sizeof(ReadResult)) {
+        MERROR("AsyncIO::Read: данные параметров задания должны начинаться с AsyncIO::ReadResult.");
+        return false;
+    }
+    if (MString::Length(path) >= sizeof(ReadRequest::path)) {
+        MERROR("AsyncIO::Read: слишком длинный путь '%s'.", path);
+        return false;
+    }
+
+    auto request = reinterpret_cast<ReadRequest*>(MemorySystem::Allocate(sizeof(ReadRequest), Memory::Job, true));
+    MString::Copy(request->path, path);
+    request->info = info;
+    request->fd = -1;
+
+    if (!pState->QueueMutex.Lock()) {
+        MERROR("Не удалось получить блокировку мьютекса очереди чтения!");
+    }
+    const bool queued = pState->requests.Enqueue(&request);
+    if (queued) {
+        pState->pending++;
+        if (pState->pending > pState->PeakPending) {
+            pState->PeakPending = pState->pending;
+        }
+    }
+    if (!pState->QueueMutex.Unlock()) {
+        MERROR("Не удалось снять блокировку мьютекса очереди чтения!");
+    }
+
+    if (!queued) {
+        // Задание остается у вызывающей стороны.
+        MemorySystem::Free(request, sizeof(ReadRequest), Memory::Job);
+        MWARN("AsyncIO::Read: очередь чтения переполнена.");
+        return false;
+    }
+    return true;
+}
+
+void AsyncIO::FreeResult(ReadResult &result)
+{
+    if (result.data) {
+        MemorySystem::Free(result.data, result.size, Memory::Resource);
+    }
+    result.data = nullptr;
+    result.size = 0;
+}
+
+u32 AsyncIO::PendingCount()
+{
+    return pState ? pState->pending : 0;
+}
+
+u32 AsyncIO::ResetPeakPendingCount()
+{
+    if (!pState) {
+        return 0;
+    }
+    if (!pState->QueueMutex.Lock()) {
+        MERROR("Не удалось получить блокировку мьютекса очереди чтения!");
+    }
+    const u32 peak = pState->PeakPending;
+    pState->PeakPending = pState->pending;
+    if (!pState->QueueMutex.Unlock()) {
+        MERROR("Не удалось снять блокировку мьютекса очереди чтения!");
+    }
+    return peak;
+}
+
+bool AsyncIO::IsIoUring()
+{
+    return pState && pState->UseIoUring;
+}
+
+bool AsyncIO::IsInitialized()
+{
+    return pState != nullptr;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "systems/job_systems.hpp"
+
+/// @brief Конфигурация системы асинхронного ввода-вывода.
+struct AsyncIOConfig {
+    /// @brief Количество потоков чтения, если io_uring недоступен.
+    u8 WorkerCount;
+    /// @brief Максимальное количество одновременно выполняющихся запросов чтения (глубина очереди io_uring).
+    u32 QueueDepth;
+};
+
+/// @brief Асинхронное чтение файлов целиком. В Linux чтения отправляются пакетами через io_uring,
+/// на других платформах (или если io_uring недоступен) их выполняет пул потоков.
+/// По завершении чтения в систему заданий отправляется переданное задание, поэтому
+/// декодирование начинается сразу по прибытии данных, не дожидаясь потока загрузки ресурсов.
+namespace AsyncIO
+{
+    /// @brief Результат чтения. Данные параметров задания, передаваемого в Read, должны начинаться с этой структуры.
+    struct ReadResult {
+        u8* data;       // Содержимое файла. Освобождается вызовом FreeResult.
+        u64 size;       // Размер содержимого в байтах.
+        bool success;   // Указывает, удалось ли прочитать файл.
+    };
+
+    bool Initialize(u64& MemoryRequirement, void* memory, void* config);
+    void Shutdown();
+
+    /// @brief Ставит в очередь чтение файла целиком.
+    /// @param path путь к файлу. Файлы из подключенных пакетов ресурсов читаются из памяти.
+    /// @param info задание, отправляемое в систему заданий по завершении чтения. Его ParamData должны начинаться
+    /// с ReadResult, который заполняется перед отправкой. Задание отправляется и в случае ошибки чтения (success = false).
+    /// @return true, если запрос поставлен в очередь; в противном случае false (задание не будет отправлено).
+    MAPI bool Read(const char* path, Job::Info& info);
+
+    /// @brief Освобождает данные, прочитанные асинхронно.
+    /// @param result результат чтения.
+    MAPI void FreeResult(ReadResult& result);
+
+    /// @brief Возвращает текущее количество незавершенных запросов (в очереди и в процессе чтения).
+    MAPI u32 PendingCount();
+
+    /// @brief Возвращает наибольшее количество незавершенных запросов с момента последнего сброса и сбрасывает его.
+    MAPI u32 ResetPeakPendingCount();
+
+    /// @brief Указывает, используется ли io_uring.
+    MAPI bool IsIoUring();
+
+    /// @brief Указывает, инициализирована ли система асинхронного ввода-вывода.
+    MAPI bool IsInitialized();
+} // namespace AsyncIO
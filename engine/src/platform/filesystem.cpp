@@ -1,14 +1,65 @@
 #include "filesystem.hpp"
+#include "asset_pack.hpp"
 
 #include "core/logger.hpp"
 #include "core/memory_system.h"
+#include "utils/lz4.h"
 
 #include <iostream>
 #include <cstring>
 #include <sys/stat.h>
 
+// Максимальное количество одновременно подключенных пакетов ресурсов.
+constexpr u32 MAX_MOUNTED_PACKS = 4;
+
+// Пакеты изменяются только при инициализации и завершении работы системы ресурсов,
+// поэтому поиск из рабочих потоков не требует синхронизации.
+static AssetPack MountedPacks[MAX_MOUNTED_PACKS];
+static u32 MountedPackCount = 0;
+
+/// @brief Ищет файл во всех подключенных пакетах. Пакеты, подключенные позже, имеют приоритет.
+static const AssetPackEntry* FindInPacks(const char* path, const AssetPack** OutPack)
+{
+    for (u32 i = MountedPackCount; i > 0; --i) {
+        const AssetPackEntry* entry = MountedPacks[i - 1].Find(path);
+        if (entry) {
+            *OutPack = &MountedPacks[i - 1];
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+/// @brief Открывает файл из пакета, при необходимости распаковывая его.
+static bool OpenFromPack(const char* path, const AssetPack& pack, const AssetPackEntry& entry, bool binary, FileHandle& OutHandle)
+{
+    const u8* data = pack.EntryData(entry);
+    if (entry.flags & AssetPackEntry::Compressed) {
+        u8* decompressed = reinterpret_cast<u8*>(MemorySystem::Allocate(entry.UncompressedSize, Memory::Resource));
+        if (LZ4::Decompress(data, entry.size, decompressed, entry.UncompressedSize) != entry.UncompressedSize) {
+            MERROR("Не удалось распаковать файл '%s' из пакета ресурсов.", path);
+            MemorySystem::Free(decompressed, entry.UncompressedSize, Memory::Resource);
+            return false;
+        }
+        OutHandle.MemoryData = decompressed;
+        OutHandle.OwnsMemory = true;
+    } else {
+        OutHandle.MemoryData = data;
+        OutHandle.OwnsMemory = false;
+    }
+    OutHandle.MemorySize = entry.UncompressedSize;
+    OutHandle.MemoryOffset = 0;
+    OutHandle.binary = binary;
+    OutHandle.IsValid = true;
+    return true;
+}
+
 bool Filesystem::Exists(const char *path)
 {
+    const AssetPack* pack = nullptr;
+    if (FindInPacks(path, &pack)) {
+        return true;
+    }
 #ifdef _MSC_VER
     struct _stat buffer;
     return _stat(path, &buffer) == 0;
@@ -22,8 +73,22 @@ bool Filesystem::Open(const char *path, FileModes mode, bool binary, FileHandle
 {
     OutHandle.IsValid = false;
     OutHandle.handle = nullptr;
+    OutHandle.MemoryData = nullptr;
+    OutHandle.MemorySize = 0;
+    OutHandle.MemoryOffset = 0;
+    OutHandle.OwnsMemory = false;
+    OutHandle.binary = binary;
     const char * ModeStr;
 
+    // Файлы, открываемые только для чтения, сначала ищутся в подключенных пакетах.
+    if (mode == FileModes::Read) {
+        const AssetPack* pack = nullptr;
+        const AssetPackEntry* entry = FindInPacks(path, &pack);
+        if (entry) {
+            return OpenFromPack(path, *pack, *entry, binary, OutHandle);
+        }
+    }
+
     if ((mode & FileModes::Read) != 0 && (mode & FileModes::Write) != 0) {
         ModeStr = binary ? "w+b" : "w+";
     } else if ((mode & FileModes::Read) != 0 && (mode & FileModes::Write) == 0) {
@@ -50,6 +115,17 @@ bool Filesystem::Open(const char *path, FileModes mode, bool binary, FileHandle
 
 void Filesystem::Close(FileHandle &handle)
 {
+    if (handle.MemoryData) {
+        if (handle.OwnsMemory) {
+            MemorySystem::Free(const_cast<u8*>(handle.MemoryData), handle.MemorySize, Memory::Resource);
+        }
+        handle.MemoryData = nullptr;
+        handle.MemorySize = 0;
+        handle.MemoryOffset = 0;
+        handle.OwnsMemory = false;
+        handle.IsValid = false;
+        return;
+    }
     if (handle.handle) {
         fclose(reinterpret_cast<FILE*>(handle.handle));
         handle.handle = nullptr;
@@ -59,6 +135,12 @@ void Filesystem::Close(FileHandle &handle)
 
 bool Filesystem::Size(FileHandle &handle, u64 &OutSize)
 {
+    if (handle.MemoryData) {
+        // Как и для файлов на диске, позиция чтения возвращается в начало.
+        OutSize = handle.MemorySize;
+        handle.MemoryOffset = 0;
+        return true;
+    }
     if (handle.handle) {
         fseek(reinterpret_cast<FILE*>(handle.handle), 0, SEEK_END);
         OutSize = ftell(reinterpret_cast<FILE*>(handle.handle));
@@ -70,6 +152,27 @@ bool Filesystem::Size(FileHandle &handle, u64 &OutSize)
 
 bool Filesystem::ReadLine(FileHandle &handle, u64 MaxLength, char** LineBuf, u64& OutLineLength)
 {
+    if (handle.MemoryData && LineBuf && MaxLength > 0) {
+        // Повторяет поведение fgets: не более MaxLength - 1 символов, '\n' остается в строке.
+        if (handle.MemoryOffset >= handle.MemorySize) {
+            return false;
+        }
+        char* buf = *LineBuf;
+        u64 length = 0;
+        while (length < MaxLength - 1 && handle.MemoryOffset < handle.MemorySize) {
+            const char c = static_cast<char>(handle.MemoryData[handle.MemoryOffset++]);
+            if (c == '\r' && !handle.binary) {
+                continue;
+            }
+            buf[length++] = c;
+            if (c == '\n') {
+                break;
+            }
+        }
+        buf[length] = 0;
+        OutLineLength = length;
+        return true;
+    }
     if (handle.handle && LineBuf && MaxLength > 0) {
         char* buf = *LineBuf;
         if (fgets(buf, MaxLength, reinterpret_cast<FILE*>(handle.handle)) != 0) {
@@ -82,6 +185,10 @@ bool Filesystem::ReadLine(FileHandle &handle, u64 MaxLength, char** LineBuf, u64
 
 bool Filesystem::WriteLine(FileHandle &handle, const char *text)
 {
+    if (handle.MemoryData) {
+        MERROR("Filesystem::WriteLine: файлы из пакета ресурсов доступны только для чтения.");
+        return false;
+    }
      if (handle.handle) {
         i32 result = fputs(text, reinterpret_cast<FILE*>(handle.handle));
         if (result != EOF) {
@@ -98,6 +205,13 @@ bool Filesystem::WriteLine(FileHandle &handle, const char *text)
 
 bool Filesystem::Read(FileHandle &handle, u64 DataSize, void *OutData, u64 &OutBytesRead)
 {
+    if (handle.MemoryData && OutData) {
+        const u64 remaining = handle.MemorySize - handle.MemoryOffset;
+        OutBytesRead = DataSize < remaining ? DataSize : remaining;
+        MemorySystem::CopyMem(OutData, handle.MemoryData + handle.MemoryOffset, OutBytesRead);
+        handle.MemoryOffset += OutBytesRead;
+        return OutBytesRead == DataSize;
+    }
     if (handle.handle && OutData) {
         OutBytesRead = fread(OutData, 1, DataSize, reinterpret_cast<FILE*>(handle.handle));
         if (OutBytesRead != DataSize) {
@@ -110,6 +224,12 @@ bool Filesystem::Read(FileHandle &handle, u64 DataSize, void *OutData, u64 &OutB
 
 bool Filesystem::ReadAllBytes(FileHandle &handle, u8 *OutBytes, u64 &OutBytesRead)
 {
+    if (handle.MemoryData && OutBytes) {
+        MemorySystem::CopyMem(OutBytes, handle.MemoryData, handle.MemorySize);
+        OutBytesRead = handle.MemorySize;
+        handle.MemoryOffset = handle.MemorySize;
+        return true;
+    }
     if (handle.handle && OutBytes) {
         // Размер файла
         u64 size = 0;
@@ -125,6 +245,12 @@ bool Filesystem::ReadAllBytes(FileHandle &handle, u8 *OutBytes, u64 &OutBytesRea
 
 bool Filesystem::ReadAllText(FileHandle &handle, char *OutText, u64 &OutBytesRead)
 {
+    if (handle.MemoryData && OutText) {
+        MemorySystem::CopyMem(OutText, handle.MemoryData, handle.MemorySize);
+        OutBytesRead = handle.MemorySize;
+        handle.MemoryOffset = handle.MemorySize;
+        return true;
+    }
     if (handle.handle && OutText && OutBytesRead) {
         // Размер файла
         u64 size = 0;
@@ -139,6 +265,10 @@ bool Filesystem::ReadAllText(FileHandle &handle, char *OutText, u64 &OutBytesRea
 
 bool Filesystem::Write(FileHandle &handle, u64 DataSize, const void *data, u64 &OutBytesWritten)
 {
+    if (handle.MemoryData) {
+        MERROR("Filesystem::Write: файлы из пакета ресурсов доступны только для чтения.");
+        return false;
+    }
     if (handle.handle) {
         OutBytesWritten = fwrite(data, 1, DataSize, reinterpret_cast<FILE*>(handle.handle));
         if (OutBytesWritten != DataSize) {
@@ -149,3 +279,45 @@ bool Filesystem::Write(FileHandle &handle, u64 DataSize, const void *data, u64 &
     }
     return false;
 }
+
+bool Filesystem::Seek(FileHandle &handle, u64 offset)
+{
+    if (handle.MemoryData) {
+        if (offset > handle.MemorySize) {
+            return false;
+        }
+        handle.MemoryOffset = offset;
+        return true;
+    }
+    if (handle.handle) {
+        return fseek(reinterpret_cast<FILE*>(handle.handle), static_cast<long>(offset), SEEK_SET) == 0;
+    }
+    return false;
+}
+
+bool Filesystem::MountPack(const char *PackPath, const char *RootPath)
+{
+    if (MountedPackCount == MAX_MOUNTED_PACKS) {
+        MERROR("Filesystem::MountPack: достигнуто максимальное количество пакетов ресурсов (%u).", MAX_MOUNTED_PACKS);
+        return false;
+    }
+    if (!MountedPacks[MountedPackCount].Open(PackPath, RootPath)) {
+        return false;
+    }
+    MountedPackCount++;
+    return true;
+}
+
+bool Filesystem::IsPacked(const char *path)
+{
+    const AssetPack* pack = nullptr;
+    return FindInPacks(path, &pack) != nullptr;
+}
+
+void Filesystem::UnmountPacks()
+{
+    for (u32 i = 0; i < MountedPackCount; ++i) {
+        MountedPacks[i].Close();
+    }
+    MountedPackCount = 0;
+}
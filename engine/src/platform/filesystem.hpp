@@ -9,6 +9,14 @@ struct FileHandle {
     // Непрозрачный дескриптор для внутреннего дескриптора файла.
     void* handle;
     bool IsValid;
+    // Данные файла, открытого из пакета ресурсов. Если не nullptr, handle не используется.
+    const u8* MemoryData;
+    u64 MemorySize;
+    u64 MemoryOffset;
+    // Указывает, что MemoryData является распакованной копией и должна быть освобождена при закрытии.
+    bool OwnsMemory;
+    // Указывает, что файл открыт в двоичном режиме. Для текстового режима '\r' пропускается при чтении строк.
+    bool binary;
 };
 
 enum class FileModes {
@@ -96,4 +104,25 @@ namespace Filesystem
     /// @param OutBytesWritten указатель на число, которое будет заполнено количеством байт, фактически записанных в файл.
     /// @returns true в случае успеха; в противном случае false.
     MAPI bool Write(FileHandle& handle, u64 DataSize, const void* data, u64& OutBytesWritten);
+
+    /// @brief Устанавливает позицию чтения/записи от начала файла.
+    /// @param handle Дескриптор файла.
+    /// @param offset смещение в байтах от начала файла.
+    /// @returns true в случае успеха; в противном случае false.
+    MAPI bool Seek(FileHandle& handle, u64 offset);
+
+    /// @brief Подключает пакет ресурсов. Файлы, пути которых начинаются с RootPath, сначала ищутся в пакете,
+    /// а при отсутствии в нем — на диске. Открытые из пакета файлы доступны только для чтения.
+    /// @param PackPath путь к файлу пакета.
+    /// @param RootPath путь, относительно которого хранятся имена в пакете (например, "../assets").
+    /// @returns true в случае успеха; в противном случае false.
+    MAPI bool MountPack(const char* PackPath, const char* RootPath);
+
+    /// @brief Проверяет, находится ли файл в одном из подключенных пакетов ресурсов.
+    /// @param path путь к файлу.
+    /// @returns true, если файл будет открыт из пакета; в противном случае false.
+    MAPI bool IsPacked(const char* path);
+
+    /// @brief Отключает все подключенные пакеты ресурсов. Файлы, открытые из пакетов, должны быть закрыты заранее.
+    MAPI void UnmountPacks();
 } // namespace Filesystem
@@ -8,6 +8,7 @@
 #include "core/input.hpp"
 #include "core/mthread.hpp"
 #include "core/mmutex.hpp"
+#include "core/msemaphore.hpp"
 #include "core/mmemory.hpp"
 
 #include "containers/darray.hpp"
@@ -25,12 +26,18 @@
 #include <unistd.h>  // usleep
 #endif
 #include <pthread.h>
+#include <semaphore.h>
 #include <errno.h>        // Для сообщения об ошибках
 #include <sys/sysinfo.h>  // Информация о процессоре
 
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <fcntl.h>        // open
+#include <sys/mman.h>     // mmap
+#include <sys/stat.h>
+#include <sys/inotify.h>  // наблюдение за файлами
+#include <unistd.h>
 
 // Для создания поверхности
 struct linux_handle_info 
@@ -39,6 +46,29 @@ struct linux_handle_info
     xcb_window_t window;
 };
 
+// Время тишины (в секундах), после которого серия событий файла считается завершенной.
+// Редакторы и инструменты часто сохраняют файл в несколько записей или через переименование временного файла.
+constexpr f64 WATCH_COALESCE_TIME = 0.1;
+
+struct LinuxFileWatch {
+    u32 id;
+    MString FilePath;
+    i32 wd;             // Дескриптор наблюдения inotify за каталогом файла. Общий для файлов одного каталога.
+    u32 NameOffset;     // Смещение имени файла в FilePath.
+    f64 LastEventTime;  // Время последнего события серии.
+    bool dirty;         // Указывает, что серия событий еще не обработана.
+
+    LinuxFileWatch& operator=(LinuxFileWatch&& v) {
+        id = v.id;
+        FilePath = static_cast<MString&&>(v.FilePath);
+        wd = v.wd;
+        NameOffset = v.NameOffset;
+        LastEventTime = v.LastEventTime;
+        dirty = v.dirty;
+
+        return *this;
+    }
+};
 
 struct PlatformState {
     Display* display;
@@ -52,9 +82,21 @@ struct PlatformState {
 
 static PlatformState* pState = nullptr;
 
+// Наблюдение за файлами не зависит от окна: ресурсы отслеживаются и без него, например в тестах и инструментах.
+struct LinuxWatchState {
+    i32 InotifyFd;      // Экземпляр inotify; создается при первом наблюдении.
+    DArray<LinuxFileWatch> watches;
+
+    constexpr LinuxWatchState() : InotifyFd(-1), watches() {}
+};
+
+static LinuxWatchState WatchState;
+
 // Перевод ключа
 Keys TranslateKeycode(u32 x_keycode);
 
+static void ShutdownWatches();
+
 bool WindowSystem::Initialize(u64& MemoryRequirement, void* memory, void* config) {
     MemoryRequirement = sizeof(PlatformState);
 
@@ -190,6 +232,8 @@ void WindowSystem::Shutdown() {
         XAutoRepeatOn(pState->display);
 
         xcb_destroy_window(pState->handle.connection, pState->handle.window);
+
+        ShutdownWatches();
     }
 }
 
@@ -287,6 +331,8 @@ bool Messages() {
 
             free(event);
         }
+
+        PlatformUpdateWatches();
     }
     return !quit_flagged;
 }
@@ -338,6 +384,17 @@ void PlatformSleep(u64 ms) {
 #endif
 }
 
+void PlatformSleepPrecise(f64 seconds) {
+    if (seconds <= 0.0) {
+        return;
+    }
+    struct timespec ts;
+    ts.tv_sec = (time_t)seconds;
+    ts.tv_nsec = (long)((seconds - (f64)ts.tv_sec) * 1000000000.0);
+    // Относительный сон: CLOCK_MONOTONIC_RAW, на котором построено абсолютное время, clock_nanosleep не поддерживает.
+    while (clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, &ts) == EINTR) {}
+}
+
 i32 PlatformGetProcessorCount()
 {
     // Загрузить информацию о процессоре.
@@ -358,6 +415,218 @@ void PlatformGetHandleInfo(u64 &OutSize, void *memory)
     MemorySystem::CopyMem(memory, &pState->handle, OutSize);
 }
 
+bool PlatformFileMap(const char *path, FileMapping &OutMapping)
+{
+    OutMapping = {};
+    if (!path) {
+        return false;
+    }
+
+    i32 fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    // Отображение остается действительным после закрытия дескриптора файла.
+    void* data = mmap(0, (u64)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    OutMapping.data = data;
+    OutMapping.size = (u64)info.st_size;
+    OutMapping.InternalData = nullptr;
+    return true;
+}
+
+void PlatformFileUnmap(FileMapping &mapping)
+{
+    if (mapping.data) {
+        munmap((void*)mapping.data, mapping.size);
+    }
+    mapping = {};
+}
+
+static bool UnregisterWatch(u32 WatchID);
+
+static bool RegisterWatch(const char *FilePath, u32 &OutWatchID)
+{
+    OutWatchID = INVALID::ID;
+    if (!FilePath) {
+        return false;
+    }
+    if (WatchState.InotifyFd < 0) {
+        // Без inotify горячая перезагрузка недоступна, но это не ошибка.
+        WatchState.InotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (WatchState.InotifyFd < 0) {
+            MWARN("Не удалось инициализировать inotify (errno %i). Наблюдение за файлами недоступно.", errno);
+            return false;
+        }
+    }
+
+    struct stat info;
+    if (stat(FilePath, &info) != 0) {
+        return false;
+    }
+
+    // Наблюдение ведется за каталогом: при сохранении через переименование временного файла
+    // дескриптор наблюдения за самим файлом перестал бы получать события.
+    const char* slash = strrchr(FilePath, '/');
+    const u32 NameOffset = slash ? (u32)(slash - FilePath) + 1 : 0;
+    char directory[512]{};
+    if (NameOffset == 0) {
+        directory[0] = '.';
+    } else {
+        if (NameOffset >= sizeof(directory)) {
+            MERROR("RegisterWatch: слишком длинный путь '%s'.", FilePath);
+            return false;
+        }
+        MemorySystem::CopyMem(directory, FilePath, NameOffset - 1);
+        if (NameOffset == 1) {
+            directory[0] = '/';
+        }
+    }
+
+    // Повторный вызов для того же каталога возвращает существующий дескриптор.
+    const i32 wd = inotify_add_watch(WatchState.InotifyFd, directory, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_MOVED_FROM);
+    if (wd < 0) {
+        MERROR("RegisterWatch: не удалось начать наблюдение за '%s' (errno %i).", directory, errno);
+        return false;
+    }
+
+    LinuxFileWatch* slot = nullptr;
+    auto& count = WatchState.watches.Length();
+    for (u32 i = 0; i < count; ++i) {
+        if (WatchState.watches[i].id == INVALID::ID) {
+            // Найден свободный слот для использования.
+            slot = &WatchState.watches[i];
+            slot->id = i;
+            break;
+        }
+    }
+    if (!slot) {
+        // Если свободного места нет, создайте и отправьте новую запись.
+        LinuxFileWatch w{};
+        w.id = count;
+        WatchState.watches.PushBack(static_cast<LinuxFileWatch&&>(w));
+        slot = &WatchState.watches[count - 1];
+    }
+
+    slot->FilePath = FilePath;
+    slot->wd = wd;
+    slot->NameOffset = NameOffset;
+    slot->LastEventTime = 0;
+    slot->dirty = false;
+    OutWatchID = slot->id;
+    return true;
+}
+
+static bool UnregisterWatch(u32 WatchID)
+{
+    auto& count = WatchState.watches.Length();
+    if (count == 0 || WatchID > (count - 1) || WatchState.watches[WatchID].id == INVALID::ID) {
+        return false;
+    }
+
+    auto& w = WatchState.watches[WatchID];
+    const i32 wd = w.wd;
+    w.id = INVALID::ID;
+    w.FilePath.Clear();
+    w.wd = -1;
+    w.dirty = false;
+
+    // Наблюдение за каталогом снимается, только если в нем больше нет наблюдаемых файлов.
+    for (u32 i = 0; i < count; ++i) {
+        if (WatchState.watches[i].id != INVALID::ID && WatchState.watches[i].wd == wd) {
+            return true;
+        }
+    }
+    inotify_rm_watch(WatchState.InotifyFd, wd);
+    return true;
+}
+
+bool PlatformWatchFile(const char *FilePath, u32 &OutWatchID)
+{
+    return RegisterWatch(FilePath, OutWatchID);
+}
+
+bool PlatformUnwatchFile(u32 WatchID)
+{
+    return UnregisterWatch(WatchID);
+}
+
+void PlatformUpdateWatches()
+{
+    if (WatchState.InotifyFd < 0 || !WatchState.watches) {
+        return;
+    }
+
+    const f64 now = PlatformGetAbsoluteTime();
+    auto& count = WatchState.watches.Length();
+
+    // Чтение всех накопившихся событий без блокировки.
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        const ssize_t length = read(WatchState.InotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            // EAGAIN - событий больше нет.
+            break;
+        }
+        for (char* ptr = buffer; ptr < buffer + length; ptr += sizeof(inotify_event) + reinterpret_cast<inotify_event*>(ptr)->len) {
+            const auto* e = reinterpret_cast<inotify_event*>(ptr);
+            if (e->len == 0) {
+                continue;
+            }
+            for (u32 i = 0; i < count; ++i) {
+                auto& w = WatchState.watches[i];
+                if (w.id != INVALID::ID && w.wd == e->wd && strcmp(w.FilePath.c_str() + w.NameOffset, e->name) == 0) {
+                    // Серия событий объединяется: уведомление отправляется, когда файл перестанет меняться.
+                    w.dirty = true;
+                    w.LastEventTime = now;
+                }
+            }
+        }
+    }
+
+    for (u32 i = 0; i < count; ++i) {
+        auto& w = WatchState.watches[i];
+        if (w.id == INVALID::ID || !w.dirty || now - w.LastEventTime < WATCH_COALESCE_TIME) {
+            continue;
+        }
+        w.dirty = false;
+
+        EventContext context = {0};
+        context.data.u32[0] = w.id;
+        struct stat info;
+        if (stat(w.FilePath.c_str(), &info) != 0) {
+            // Это означает, что файл был удален, снимите с наблюдения.
+            EventSystem::Fire(EventSystem::Code::WatchedFileDeleted, nullptr, context);
+            MINFO("Файл с идентификатором наблюдения %d был удален.", w.id);
+            UnregisterWatch(w.id);
+            continue;
+        }
+        // Уведомите слушателей.
+        EventSystem::Fire(EventSystem::Code::WatchedFileWritten, nullptr, context);
+    }
+}
+
+static void ShutdownWatches()
+{
+    if (WatchState.InotifyFd >= 0) {
+        // Дескрипторы наблюдения освобождаются вместе с экземпляром inotify.
+        close(WatchState.InotifyFd);
+        WatchState.InotifyFd = -1;
+    }
+    WatchState.watches.Destroy();
+}
+
 // ПРИМЕЧАНИЕ: Начало потоков.
 
 constexpr MThread::MThread(PFN_ThreadStart StartFunctionPtr, void *params, bool AutoDetach)
@@ -566,6 +835,59 @@ bool MMutex::Unlock()
 }
 
 // ПРИМЕЧАНИЕ: Конец мьютекса
+// Начало семафоров
+
+void *MSemaphore::Create()
+{
+    sem_t* semaphore = (sem_t*)PlatformAllocate(sizeof(sem_t), false);
+    if (sem_init(semaphore, 0, 0) != 0) {
+        MERROR("Ошибка создания семафора: errno=%i", errno);
+        PlatformFree(semaphore, false);
+        return nullptr;
+    }
+    data = semaphore;
+    return data;
+}
+
+MSemaphore::~MSemaphore()
+{
+    if (data) {
+        sem_destroy((sem_t*)data);
+        PlatformFree(data, false);
+        data = nullptr;
+    }
+}
+
+bool MSemaphore::Signal(u32 count)
+{
+    if (!data) {
+        return false;
+    }
+    for (u32 i = 0; i < count; ++i) {
+        if (sem_post((sem_t*)data) != 0) {
+            MERROR("Не удалось увеличить счетчик семафора: errno=%i", errno);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MSemaphore::Wait()
+{
+    if (!data) {
+        return false;
+    }
+    // Повторить ожидание, если оно прервано сигналом.
+    while (sem_wait((sem_t*)data) != 0) {
+        if (errno != EINTR) {
+            MERROR("Ошибка ожидания семафора: errno=%i", errno);
+            return false;
+        }
+    }
+    return true;
+}
+
+// ПРИМЕЧАНИЕ: Конец семафоров
 
 // Key translation
 Keys translate_keycode(u32 x_keycode) {
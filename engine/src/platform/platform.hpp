@@ -31,6 +31,13 @@ struct DynamicLibrary {
 
 template class DArray<DynamicLibraryFunction>;
 
+/// @brief Файл, отображенный в память только для чтения.
+struct FileMapping {
+    const void* data;       // Указатель на начало отображения.
+    u64 size;               // Размер отображения в байтах.
+    void* InternalData;     // Платформенный дескриптор отображения.
+};
+
 namespace PlatformError
 {
     enum Code {
@@ -79,6 +86,11 @@ void PlatformConsoleWriteError(const char* message, u8 colour);
 // Поэтому его не экспортируем.
 MAPI void PlatformSleep(u64 ms);
 
+/// @brief Сон на потоке с разрешением таймера высокого разрешения ОС, а не миллисекунды. ОС может проспать дольше;
+/// точное ожидание строится поверх этой функции с досыпанием в цикле (см. FramePacer).
+/// @param seconds время сна в секундах.
+MAPI void PlatformSleepPrecise(f64 seconds);
+
 /// @brief Получает количество логических ядер процессора.
 /// @return Количество логических ядер процессора.
 i32 PlatformGetProcessorCount();
@@ -119,6 +131,16 @@ MAPI const char* PlatformDynamicLibraryPrefix();
 /// @return Код ошибки, указывающий на успех или неудачу.
 MAPI PlatformError::Code PlatformCopyFile(const char *source, const char *dest, bool OverwriteIfExists);
 
+/// @brief Отображает файл в память только для чтения.
+/// @param path путь к файлу. Обязательно.
+/// @param OutMapping ссылка для хранения отображения.
+/// @return True в случае успеха; в противном случае false.
+MAPI bool PlatformFileMap(const char* path, FileMapping& OutMapping);
+
+/// @brief Снимает отображение файла, созданное PlatformFileMap.
+/// @param mapping ссылка на отображение. После вызова обнуляется.
+MAPI void PlatformFileUnmap(FileMapping& mapping);
+
 /// @brief Наблюдать за файлом по указанному пути.
 /// @param FilePath Путь к файлу. Обязательно.
 /// @param OutWatchID Указатель для хранения идентификатора наблюдения.
@@ -130,4 +152,8 @@ MAPI bool PlatformWatchFile(const char* FilePath, u32& OutWatchID);
 /// @return True в случае успеха; в противном случае false.
 MAPI bool PlatformUnwatchFile(u32 WatchID);
 
+/// @brief Проверяет наблюдаемые файлы и отправляет события EventSystem::WatchedFileWritten и WatchedFileDeleted.
+/// Вызывается циклом сообщений окна; без окна его вызывает тот, кто наблюдает за файлами.
+MAPI void PlatformUpdateWatches();
+
 // MAPI const char* PlatformGetKeyboardLayout();
\ No newline at end of file
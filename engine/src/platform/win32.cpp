@@ -8,6 +8,7 @@
 #include "core/input.h"
 #include "core/mthread.hpp"
 #include "core/mmutex.hpp"
+#include "core/msemaphore.hpp"
 
 #define WIN32_LEAN_AND_MEAN
 #include <windowsx.h>  // извлечение входных параметров
@@ -36,14 +37,15 @@ struct Win32FileWatch {
 struct PlatformState
 {
     Win32HandleInfo handle;
-    DArray<Win32FileWatch> watches;
 };
 
 static PlatformState* state = nullptr;
 
+// Наблюдение за файлами не зависит от окна: ресурсы отслеживаются и без него, например в тестах и инструментах.
+static DArray<Win32FileWatch> FileWatches;
+
 // Прототип функции обратного вызова для обработки сообщений
 LRESULT CALLBACK Win32MessageProcessor(HWND, u32, WPARAM, LPARAM);
-void PlatformUpdateWatches();
 
 // Часы
 static f64 ClockFrequency;
@@ -147,7 +149,7 @@ void WindowSystem::Shutdown()
         DestroyWindow(state->handle.hwnd);
         state->handle.hwnd = 0;
     }
-
+    FileWatches.Destroy();
 }
 
 bool WindowSystem::Messages()
@@ -226,6 +228,27 @@ void PlatformSleep(u64 ms) {
     Sleep(ms);
 }
 
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+void PlatformSleepPrecise(f64 seconds) {
+    if (seconds <= 0.0) {
+        return;
+    }
+    // Таймер высокого разрешения (Windows 10 1803+) не зависит от шага системного таймера; без него — обычный Sleep.
+    static thread_local HANDLE timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (timer) {
+        LARGE_INTEGER due;
+        due.QuadPart = -(LONGLONG)(seconds * 10000000.0);   // Отрицательное значение — относительное время в интервалах по 100 нс.
+        if (SetWaitableTimer(timer, &due, 0, NULL, NULL, FALSE)) {
+            WaitForSingleObject(timer, INFINITE);
+            return;
+        }
+    }
+    Sleep((DWORD)(seconds * 1000.0));
+}
+
 i32 PlatformGetProcessorCount()
 {
     SYSTEM_INFO sysinfo;
@@ -343,15 +366,60 @@ PlatformError::Code PlatformCopyFile(const char *source, const char *dest, bool
     return PlatformError::Success;
 }
 
-static bool RegisterWatch(const char *FilePath, u32 &OutWatchID) 
+bool PlatformFileMap(const char *path, FileMapping &OutMapping)
 {
-    if (!state || !FilePath) {
-        if (OutWatchID) {
-            OutWatchID = INVALID::ID;
-        }
+    OutMapping = {};
+    if (!path) {
+        return false;
+    }
+
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, 0);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    // Отображение удерживает файл открытым, поэтому дескриптор файла можно закрыть сразу.
+    HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+    CloseHandle(file);
+    if (!mapping) {
         return false;
     }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    OutMapping.data = view;
+    OutMapping.size = (u64)size.QuadPart;
+    OutMapping.InternalData = mapping;
+    return true;
+}
+
+void PlatformFileUnmap(FileMapping &mapping)
+{
+    if (mapping.data) {
+        UnmapViewOfFile(mapping.data);
+    }
+    if (mapping.InternalData) {
+        CloseHandle((HANDLE)mapping.InternalData);
+    }
+    mapping = {};
+}
+
+static bool RegisterWatch(const char *FilePath, u32 &OutWatchID) 
+{
     OutWatchID = INVALID::ID;
+    if (!FilePath) {
+        return false;
+    }
 
     // if (!state->watches) {
     //     state->watches = darray_create(Win32File_watch);
@@ -367,9 +435,9 @@ static bool RegisterWatch(const char *FilePath, u32 &OutWatchID)
         return false;
     }
 
-    auto& count = state->watches.Length();
+    auto& count = FileWatches.Length();
     for (u32 i = 0; i < count; ++i) {
-        auto& w = state->watches[i];
+        auto& w = FileWatches[i];
         if (w.id == INVALID::ID) {
             // Найден свободный слот для использования.
             w.id = i;
@@ -386,23 +454,23 @@ static bool RegisterWatch(const char *FilePath, u32 &OutWatchID)
     w.FilePath = FilePath;
     w.LastWriteTime = data.ftLastWriteTime;
     OutWatchID = count;
-    state->watches.PushBack(static_cast<Win32FileWatch&&>(w));
+    FileWatches.PushBack(static_cast<Win32FileWatch&&>(w));
 
     return true;
 }
 
 static bool UnregisterWatch(u32 WatchID) 
 {
-    if (!state || !state->watches) {
+    if (!FileWatches) {
         return false;
     }
 
-    auto& count = state->watches.Length();
+    auto& count = FileWatches.Length();
     if (count == 0 || WatchID > (count - 1)) {
         return false;
     }
 
-    auto& w = state->watches[WatchID];
+    auto& w = FileWatches[WatchID];
     w.id = INVALID::ID;
     w.FilePath.Clear();
     MemorySystem::ZeroMem(&w.LastWriteTime, sizeof(FILETIME));
@@ -421,13 +489,13 @@ bool PlatformUnwatchFile(u32 WatchID)
 }
 
 void PlatformUpdateWatches() {
-    if (!state || !state->watches) {
+    if (!FileWatches) {
         return;
     }
 
-    auto& count = state->watches.Length();
+    auto& count = FileWatches.Length();
     for (u32 i = 0; i < count; ++i) {
-        auto& f = state->watches[i];
+        auto& f = FileWatches[i];
         if (f.id != INVALID::ID) {
             WIN32_FIND_DATAA data;
             HANDLE FileHandle = FindFirstFileA(f.FilePath.c_str(), &data);
@@ -594,6 +662,44 @@ bool MMutex::Unlock()
 }
 
 // ПРИМЕЧАНИЕ: конец мьютексов
+//------------------------------------------------------------------------------------------------------------------------
+// ПРИМЕЧАНИЕ: начало семафоров-------------------------------------------------------------------------------------------
+
+void *MSemaphore::Create()
+{
+    data = CreateSemaphore(0, 0, LONG_MAX, 0);
+    if (!data) {
+        MERROR("Создать семафор не удалось.");
+        return nullptr;
+    }
+    return data;
+}
+
+MSemaphore::~MSemaphore()
+{
+    if (data) {
+        CloseHandle(data);
+        data = nullptr;
+    }
+}
+
+bool MSemaphore::Signal(u32 count)
+{
+    if (!data) {
+        return false;
+    }
+    return ReleaseSemaphore(data, (LONG)count, 0) != 0;  // 0 — это неудача
+}
+
+bool MSemaphore::Wait()
+{
+    if (!data) {
+        return false;
+    }
+    return WaitForSingleObject(data, INFINITE) == WAIT_OBJECT_0;
+}
+
+// ПРИМЕЧАНИЕ: конец семафоров
 
 LRESULT CALLBACK Win32MessageProcessor(HWND hwnd, u32 msg, WPARAM w_param, LPARAM l_param) {
     switch (msg) {
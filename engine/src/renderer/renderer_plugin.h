@@ -114,6 +114,15 @@ public:
     /// @param pixels необработанные данные изображения, которые необходимо записать.
     virtual void TextureWriteData(Texture* texture, u32 offset, u32 size, const u8* pixels) = 0;
 
+    /// @brief Записывает прямоугольную область текстуры, сохраняя остальное содержимое. Текстура должна быть уже загружена.
+    /// @param texture указатель на текстуру, в которую нужно записать.
+    /// @param x левая граница области в пикселях.
+    /// @param y верхняя граница области в пикселях.
+    /// @param width ширина области в пикселях.
+    /// @param height высота области в пикселях.
+    /// @param pixels пиксели области построчно, без промежутков между строками.
+    virtual void TextureWriteRegion(Texture* texture, u32 x, u32 y, u32 width, u32 height, const u8* pixels) = 0;
+
     /// @brief Считывает указанные данные из предоставленной текстуры.
     /// @param texture Указатель на текстуру для чтения.
     /// @param offset Смещение в байтах от начала данных для чтения.
@@ -128,6 +137,28 @@ public:
     /// @param OutRgba Указатель на массив u8 для хранения данных пикселей (должен быть sizeof(u8) * 4)
     virtual void TextureReadPixel(Texture* texture, u32 x, u32 y, u8** OutRgba) = 0;
 
+    /// @brief Ставит в очередь асинхронное чтение данных текстуры. Копирование выполняется после всех проходов
+    /// текущего кадра, CPU не ждет GPU. Результат забирается через ReadbackPoll через один-два кадра.
+    /// @param texture Указатель на текстуру для чтения.
+    /// @param offset Смещение в байтах от начала данных для чтения.
+    /// @param size Количество байтов для чтения.
+    /// @return номер чтения; 0, если чтение не удалось поставить в очередь.
+    virtual u64 TextureReadDataAsync(Texture* texture, u32 offset, u32 size) = 0;
+
+    /// @brief Ставит в очередь асинхронное чтение пикселя текстуры с указанной координатой x/y.
+    /// @param texture Указатель на текстуру для чтения.
+    /// @param x Координата x пикселя.
+    /// @param y Координата y пикселя.
+    /// @return номер чтения; 0, если чтение не удалось поставить в очередь.
+    virtual u64 TextureReadPixelAsync(Texture* texture, u32 x, u32 y) = 0;
+
+    /// @brief Проверяет асинхронное чтение и, если оно завершено, копирует результат.
+    /// Готовый результат можно забрать только один раз.
+    /// @param ticket номер чтения.
+    /// @param OutMemory память для результата: не меньше запрошенного размера, для пикселя sizeof(u8) * 4.
+    /// @return состояние чтения.
+    virtual ReadbackStatus ReadbackPoll(u64 ticket, void* OutMemory) = 0;
+
     virtual void* TextureCopyData(const Texture* texture) = 0;
 
     //////////////////////////////////////////////////////////////////////
@@ -186,6 +217,12 @@ public:
     /// @return true в случае успеха, иначе false.
     virtual bool ShaderInitialize(Shader* shader) = 0;
 
+    /// @brief Перезагружает модули этапов шейдера с диска и пересоздает его конвейеры. 
+    /// Ресурсы экземпляров и униформы сохраняются. При ошибке шейдер остается в прежнем виде.
+    /// @param shader указатель на шейдер, который необходимо перезагрузить.
+    /// @return true в случае успеха, иначе false.
+    virtual bool ShaderReload(Shader* shader) = 0;
+
     /// @brief Использует заданный шейдер, активируя его для обновления атрибутов, униформы и т. д., а также для использования в вызовах отрисовки.---
     /// @param shader указатель на используемый шейдер.
     /// @return true в случае успеха, иначе false.
@@ -378,6 +415,62 @@ public:
     /// @brief Указывает, поддерживает ли рендерер многопоточность.
     virtual const bool& IsMultithreaded() = 0;
 
+    /// @brief Возвращает количество контекстов параллельной записи команд. 0, если параллельная запись не поддерживается.
+    virtual u8 RecordingContextCount() = 0;
+
+    /// @brief Направляет команды, которые вызывающий поток записывает до вызова RecordingEnd, в указанный контекст.
+    /// Каждый проход рендеринга, начатый в контексте, записывается в собственный вторичный буфер команд.
+    /// @note Один контекст одновременно может использовать только один поток.
+    /// @param context индекс контекста записи, меньший RecordingContextCount.
+    /// @return true в случае успеха; в противном случае false.
+    virtual bool RecordingBegin(u8 context) = 0;
+
+    /// @brief Завершает запись вызывающего потока в указанный контекст.
+    /// @param context индекс контекста записи.
+    /// @return true в случае успеха; в противном случае false.
+    virtual bool RecordingEnd(u8 context) = 0;
+
+    /// @brief Выполняет в основном буфере команд кадра все, что было записано в контексты [0, ContextCount),
+    /// в порядке индексов контекстов и, внутри контекста, в порядке записи. Вызывается в основном потоке после завершения записи.
+    /// @param ContextCount количество использованных контекстов.
+    /// @return true в случае успеха; в противном случае false.
+    virtual bool RecordingExecute(u8 ContextCount) = 0;
+
+    /// @brief Возвращает номер пакета загрузок, в который попадают текстуры и геометрия, загружаемые сейчас.
+    /// О завершении пакета сообщает событие EventSystem::RenderUploadsCompleted.
+    /// @return номер пакета; 0, если рендерер выполняет загрузки немедленно.
+    virtual u64 UploadTicket() = 0;
+
+    /// @brief Копирует время выполнения проходов рендеринга на GPU. Результаты кадра становятся доступны
+    /// без ожидания GPU, через столько кадров, сколько их в полете.
+    /// @param OutTimings массив для результатов.
+    /// @param MaxCount размер массива.
+    /// @return количество записанных проходов; 0, если рендерер не измеряет время на GPU.
+    virtual u32 GpuPassTimings(GpuPassTiming* OutTimings, u32 MaxCount) = 0;
+
+    /// @brief Получает статистику загрузки униформ последнего завершенного кадра.
+    /// @param OutStats ссылка на структуру для результатов. Нули, если рендерер не загружает униформы.
+    virtual void UniformStats(UniformUploadStats& OutStats) = 0;
+
+    /// @brief Загружает экземпляры для отсечения на GPU в постоянный буфер. Передаются только изменившиеся с прошлого вызова записи,
+    /// поэтому для статичной сцены данные копируются один раз. Копирование выполняется в начале следующего кадра.
+    /// @param instances массив экземпляров.
+    /// @param count количество экземпляров.
+    /// @return true в случае успеха; false, если рендерер не поддерживает отсечение на GPU или геометрию нельзя отрисовать косвенно.
+    virtual bool GpuCullingUpload(const GpuCullInstance* instances, u32 count) = 0;
+
+    /// @brief Задает камеру, по пирамиде которой вычислительный шейдер отсекает экземпляры в начале следующего кадра.
+    /// @param projection матрица проекции.
+    /// @param view матрица вида.
+    virtual void GpuCullingSetView(const Matrix4D& projection, const Matrix4D& view) = 0;
+
+    /// @brief Косвенно рисует диапазон загруженных экземпляров с привязанным шейдером и примененным экземпляром материала.
+    /// Число треугольников каждой отрисовки записано вычислительным шейдером: отсеченные экземпляры рисуются с нулем копий.
+    /// @param first индекс первого экземпляра.
+    /// @param count количество экземпляров.
+    /// @return true в случае успеха; false, если шейдер не имеет косвенного варианта или отсечение на GPU недоступно.
+    virtual bool GpuCullingDraw(u32 first, u32 count) = 0;
+
     /// @brief Указывает, включен ли предоставленный флаг рендерера. Если передано несколько флагов, все они должны быть установлены, чтобы вернуть значение true.
     /// @param flag проверяемый флаг.
     /// @return True, если флаг(и) установлены; в противном случае false.
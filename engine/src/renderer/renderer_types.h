@@ -102,4 +102,46 @@ enum class RendererProjectionMatrixType {
     Orthographic = 0x1,
     /// @brief Ортографическая матрица, центрированная на ширине/высоте, а не на нулевом уровне. Использует поле зрения (FOV) в качестве «масштаба».
     OrthographicCentered = 0x2
-};
\ No newline at end of file
+};
+
+/// @brief Состояние асинхронного чтения данных из GPU.
+enum class ReadbackStatus {
+    /// @brief Копирование еще не завершено на GPU.
+    Pending,
+    /// @brief Результат скопирован в память вызывающего.
+    Ready,
+    /// @brief Номер чтения неизвестен, результат уже забран или чтение не удалось.
+    Invalid
+};
+
+constexpr u32 GPU_PASS_TIMING_MAX = 32;  // Максимальное количество проходов, время которых измеряется на GPU.
+
+/// @brief Время выполнения прохода рендеринга на GPU, измеренное метками времени.
+struct GpuPassTiming {
+    /// @brief Имя прохода. Принадлежит рендереру.
+    const char* name;
+    /// @brief Время прохода в последнем прочитанном кадре, в миллисекундах.
+    f64 LastMs;
+    /// @brief Скользящее среднее время прохода, в миллисекундах.
+    f64 AverageMs;
+};
+
+/// @brief Экземпляр геометрии для отсечения и отрисовки на GPU.
+struct GpuCullInstance {
+    /// @brief Индексированная геометрия, загруженная в общие буферы вершин и индексов.
+    struct Geometry* geometry;
+    /// @brief Матрица модели экземпляра.
+    Matrix4D model;
+};
+
+/// @brief Статистика загрузки униформ шейдеров за кадр.
+struct UniformUploadStats {
+    /// @brief Объем глобальных данных и данных экземпляров, скопированных в кольцо униформ, в байтах.
+    u64 BytesUploaded;
+    /// @brief Количество записей дескрипторов, выполненных при применении глобальных переменных и экземпляров.
+    u32 DescriptorUpdates;
+    /// @brief Количество выделений в кольце униформ.
+    u32 Allocations;
+    /// @brief Количество применений, не поместившихся в раздел кольца.
+    u32 Overflows;
+};
@@ -50,6 +50,8 @@ void Rendergraph::Destroy()
     }
 
     GlobalSources.Destroy();
+    ExecutionOrder.Destroy();
+    AliasSlots.Destroy();
 }
 
 bool Rendergraph::AddGlobalSource(const char *name, RendergraphSourceType type, RendergraphSourceOrigin origin)
@@ -362,18 +364,20 @@ bool Rendergraph::Finalize()
         }
     }
 
-    return true;
+    // Цели рендеринга созданы, поэтому их размеры известны при распределении памяти.
+    return Compile();
 }
 
 bool Rendergraph::ExecuteFrame(FrameData &rFrameData)
 {
-    // Пропуска будут выполняться в порядке их добавления.
-    const u32 PassCount = passes.Length();
+    // Проходы выполняются в скомпилированном порядке; отсеченные проходы в него не входят.
+    const u32 PassCount = ExecutionOrder.Length();
     for (u32 i = 0; i < PassCount; ++i) {
-        if (!passes[i]->PassData.DoExecute) {
+        auto pass = ExecutionOrder[i];
+        if (!pass->PassData.DoExecute) {
             continue;
         }
-        if (!passes[i]->Render(rFrameData)) {
+        if (!pass->Render(rFrameData)) {
             MERROR("Ошибка выполнения прохода. Проверьте журналы для получения дополнительной информации.");
             return false;
         }
@@ -389,7 +393,8 @@ bool Rendergraph::OnResize(u16 width, u16 height)
         RegenerateRenderTargets(this, passes[i], width, height);
     }
 
-    return true;
+    // Размеры целей изменились, поэтому ячейки памяти распределяются заново.
+    return Compile();
 }
 
 bool RegenerateRenderTargets(Rendergraph *graph, RendergraphNode *pass, u16 width, u16 height)
@@ -22,6 +22,11 @@ struct RendergraphSource {
     RendergraphSourceOrigin origin;
     // Массив указателей текстур.
     Texture** textures;
+
+    // Заполняются при компиляции графа для источников, которые владеют своими текстурами.
+    u32 FirstUse{INVALID::ID};  // Индекс первого прохода в порядке выполнения, который пишет или читает ресурс.
+    u32 LastUse{INVALID::ID};   // Индекс последнего такого прохода.
+    u32 AliasSlot{INVALID::ID}; // Ячейка памяти, общая с другими временными целями. INVALID::ID, если цель не временная.
 };
 
 struct RendergraphSink {
@@ -50,6 +55,9 @@ struct RendergraphNode {
 
     bool PresentsAfter;
 
+    bool culled{};                       // Выходы прохода не доходят до заднего буфера. Заполняется при компиляции графа.
+    u32 ExecutionIndex{INVALID::ID};     // Место прохода в порядке выполнения. Заполняется при компиляции графа.
+
     virtual bool Initialize() = 0;
     virtual void Destroy() = 0;
     bool (*LoadResources)(RendergraphNode* self) = nullptr;
@@ -59,6 +67,17 @@ struct RendergraphNode {
     virtual bool Render(FrameData& rFrameData) = 0;
 };
 
+/// @brief Ячейка памяти, которую делят временные цели рендеринга с непересекающимися временами жизни.
+/// Цели в одной ячейке совпадают по типу и размеру, поэтому бэкэнд может разместить их в одной памяти.
+struct RendergraphAliasSlot {
+    RendergraphSourceType type;
+    u32 width;
+    u32 height;
+    u64 size;                            // Размер одной цели в байтах.
+    u32 LastUse;                         // Последний проход, использующий ячейку.
+    u32 SourceCount;                     // Количество целей в ячейке.
+};
+
 struct MAPI Rendergraph {
     MString name;
     Application* app;
@@ -69,8 +88,13 @@ struct MAPI Rendergraph {
 
     RendergraphSink BackbufferGlobalSink;
 
+    DArray<RendergraphNode*> ExecutionOrder;     // Проходы в порядке выполнения без отсеченных. Пуст, пока граф не скомпилирован.
+    DArray<RendergraphAliasSlot> AliasSlots;     // Ячейки памяти временных целей рендеринга.
+    u64 TransientMemory{};                       // Память временных целей, если бы каждая занимала свою.
+    u64 AliasedMemory{};                         // Память временных целей с учетом общих ячеек.
+
     constexpr Rendergraph() = default;
-    constexpr Rendergraph(const char* name, Application* app) : name(name), app(app), GlobalSources(), passes(), BackbufferGlobalSink() {}
+    constexpr Rendergraph(const char* name, Application* app) : name(name), app(app), GlobalSources(), passes(), BackbufferGlobalSink(), ExecutionOrder(), AliasSlots(), TransientMemory(), AliasedMemory() {}
 
     bool Create(const char* name, Application& app);
     void Destroy();
@@ -89,6 +113,13 @@ struct MAPI Rendergraph {
 
     bool Finalize();
 
+    /// @brief Компилирует граф: упорядочивает проходы топологически по связям приемников и источников,
+    /// отсекает проходы, выходы которых не доходят до BackbufferGlobalSink, вычисляет время жизни
+    /// целей рендеринга и распределяет временные цели с непересекающимися временами жизни по общим ячейкам памяти.
+    /// @note BackbufferGlobalSink должен быть связан. Вызывается из Finalize и OnResize.
+    /// @return true в случае успеха; false, если граф содержит цикл или задний буфер не связан.
+    bool Compile();
+
     bool ExecuteFrame(FrameData& rFrameData);
 
     bool OnResize(u16 width, u16 height);
@@ -0,0 +1,253 @@
+#include "rendergraph.h"
+#include "resources/texture.hpp"
+
+/// @brief Возвращает индекс прохода, которому принадлежит источник, или INVALID::ID для глобальных источников.
+static u32 SourceOwner(const DArray<RendergraphNode*>& passes, const RendergraphSource* source)
+{
+    const u32 PassCount = passes.Length();
+    for (u32 i = 0; i < PassCount; ++i) {
+        const auto& sources = passes[i]->sources;
+        const u32 SourceCount = sources.Length();
+        if (SourceCount && source >= &sources[0] && source < &sources[0] + SourceCount) {
+            return i;
+        }
+    }
+    return INVALID::ID;
+}
+
+/// @brief Находит источник, который владеет текстурами. Источник с происхождением Other рисует в текстуры,
+/// полученные приемником прохода: приемник ищется по имени источника, а если такого нет — по типу.
+static RendergraphSource* SourceRoot(const DArray<RendergraphNode*>& passes, RendergraphSource* source)
+{
+    // Связи без цикла не длиннее количества проходов.
+    for (u32 step = 0; source && source->origin == RendergraphSourceOrigin::Other && step <= passes.Length(); ++step) {
+        const u32 owner = SourceOwner(passes, source);
+        if (owner == INVALID::ID) {
+            break;
+        }
+
+        auto& sinks = passes[owner]->sinks;
+        const u32 SinkCount = sinks.Length();
+        RendergraphSource* upstream = nullptr;
+        for (u32 i = 0; i < SinkCount && !upstream; ++i) {
+            if (sinks[i].BoundSource && sinks[i].name == source->name) {
+                upstream = sinks[i].BoundSource;
+            }
+        }
+        for (u32 i = 0; i < SinkCount && !upstream; ++i) {
+            if (sinks[i].BoundSource && sinks[i].BoundSource->type == source->type) {
+                upstream = sinks[i].BoundSource;
+            }
+        }
+        if (!upstream) {
+            break;
+        }
+        source = upstream;
+    }
+    return source;
+}
+
+/// @brief Отмечает использование ресурса проходом с индексом выполнения index.
+MINLINE static void SourceUse(RendergraphSource* source, u32 index)
+{
+    if (source->FirstUse == INVALID::ID || index < source->FirstUse) {
+        source->FirstUse = index;
+    }
+    if (source->LastUse == INVALID::ID || index > source->LastUse) {
+        source->LastUse = index;
+    }
+}
+
+/// @brief Размер цели рендеринга в байтах по ее первой текстуре. 0, если текстуры еще не созданы.
+static u64 SourceSize(const RendergraphSource& source, u32& OutWidth, u32& OutHeight)
+{
+    OutWidth = OutHeight = 0;
+    if (!source.textures || !source.textures[0]) {
+        return 0;
+    }
+    const auto texture = source.textures[0];
+    OutWidth = texture->width;
+    OutHeight = texture->height;
+    const u32 BytesPerPixel = (source.type == RendergraphSourceType::RenderTargetDepthStencil || !texture->ChannelCount) ? 4 : texture->ChannelCount;
+    return (u64)OutWidth * OutHeight * BytesPerPixel;
+}
+
+bool Rendergraph::Compile()
+{
+    ExecutionOrder.Clear();
+    AliasSlots.Clear();
+    TransientMemory = 0;
+    AliasedMemory = 0;
+
+    if (!BackbufferGlobalSink.BoundSource) {
+        MERROR("Rendergraph::Compile: BackbufferGlobalSink не связан с источником.");
+        return false;
+    }
+
+    const u32 PassCount = passes.Length();
+
+    // Ребро i -> j означает, что приемник прохода j связан с источником прохода i.
+    DArray<u8> edges;
+    edges.Resize(PassCount * PassCount, 0);
+    DArray<u32> InDegree;
+    InDegree.Resize(PassCount, 0);
+    for (u32 j = 0; j < PassCount; ++j) {
+        auto& sinks = passes[j]->sinks;
+        const u32 SinkCount = sinks.Length();
+        for (u32 s = 0; s < SinkCount; ++s) {
+            const u32 i = SourceOwner(passes, sinks[s].BoundSource);
+            if (i != INVALID::ID && i != j && !edges[i * PassCount + j]) {
+                edges[i * PassCount + j] = 1;
+                InDegree[j]++;
+            }
+        }
+    }
+
+    // Топологическая сортировка. Из готовых проходов берется добавленный раньше, поэтому порядок
+    // независимых проходов совпадает с порядком добавления.
+    DArray<u32> order;
+    order.Reserve(PassCount);
+    DArray<bool> placed;
+    placed.Resize(PassCount, false);
+    for (u32 n = 0; n < PassCount; ++n) {
+        u32 next = INVALID::ID;
+        for (u32 i = 0; i < PassCount; ++i) {
+            if (!placed[i] && !InDegree[i]) {
+                next = i;
+                break;
+            }
+        }
+        if (next == INVALID::ID) {
+            MERROR("Rendergraph::Compile: граф '%s' содержит цикл между проходами.", name.c_str());
+            return false;
+        }
+        placed[next] = true;
+        order.PushBack(next);
+        for (u32 j = 0; j < PassCount; ++j) {
+            if (edges[next * PassCount + j]) {
+                InDegree[j]--;
+            }
+        }
+    }
+
+    // Отсечение. Живы проход, рисующий в задний буфер, проходы, которые его представляют,
+    // и все проходы, от которых они зависят. Обратный топологический порядок обходит зависимости за один проход.
+    DArray<bool> live;
+    live.Resize(PassCount, false);
+    auto BackbufferRoot = SourceRoot(passes, BackbufferGlobalSink.BoundSource);
+    const u32 BackbufferOwner = SourceOwner(passes, BackbufferGlobalSink.BoundSource);
+    if (BackbufferOwner != INVALID::ID) {
+        live[BackbufferOwner] = true;
+    }
+    for (u32 i = 0; i < PassCount; ++i) {
+        if (passes[i]->PresentsAfter) {
+            live[i] = true;
+        }
+    }
+    for (u32 k = PassCount; k-- > 0;) {
+        const u32 j = order[k];
+        if (!live[j]) {
+            continue;
+        }
+        for (u32 i = 0; i < PassCount; ++i) {
+            if (edges[i * PassCount + j]) {
+                live[i] = true;
+            }
+        }
+    }
+
+    // Порядок выполнения и время жизни ресурсов.
+    for (u32 i = 0; i < PassCount; ++i) {
+        auto pass = passes[i];
+        pass->culled = !live[i];
+        pass->ExecutionIndex = INVALID::ID;
+        const u32 SourceCount = pass->sources.Length();
+        for (u32 s = 0; s < SourceCount; ++s) {
+            auto& source = pass->sources[s];
+            source.FirstUse = source.LastUse = source.AliasSlot = INVALID::ID;
+        }
+    }
+    for (u32 k = 0; k < PassCount; ++k) {
+        auto pass = passes[order[k]];
+        if (pass->culled) {
+            continue;
+        }
+        const u32 index = ExecutionOrder.Length();
+        pass->ExecutionIndex = index;
+        ExecutionOrder.PushBack(pass);
+
+        const u32 SourceCount = pass->sources.Length();
+        for (u32 s = 0; s < SourceCount; ++s) {
+            auto root = SourceRoot(passes, &pass->sources[s]);
+            if (root->origin == RendergraphSourceOrigin::Self) {
+                SourceUse(root, index);
+            }
+        }
+        const u32 SinkCount = pass->sinks.Length();
+        for (u32 s = 0; s < SinkCount; ++s) {
+            auto root = SourceRoot(passes, pass->sinks[s].BoundSource);
+            if (root && root->origin == RendergraphSourceOrigin::Self) {
+                SourceUse(root, index);
+            }
+        }
+    }
+
+    // Временные цели: собственные цели живых проходов, кроме той, что представляется в задний буфер.
+    // Они распределяются по ячейкам жадно в порядке начала жизни: ячейка подходит, если совпадают
+    // тип и размер, а ее последний проход выполняется раньше первого прохода цели.
+    DArray<RendergraphSource*> transients;
+    for (u32 k = 0; k < ExecutionOrder.Length(); ++k) {
+        auto pass = ExecutionOrder[k];
+        const u32 SourceCount = pass->sources.Length();
+        for (u32 s = 0; s < SourceCount; ++s) {
+            auto& source = pass->sources[s];
+            if (source.origin == RendergraphSourceOrigin::Self && &source != BackbufferRoot && source.FirstUse != INVALID::ID) {
+                transients.PushBack(&source);
+            }
+        }
+    }
+    // Цели собираются в порядке выполнения их владельцев, а владелец первым пишет в цель, поэтому они уже упорядочены по FirstUse.
+
+    u32 SharedCount = 0;
+    for (u32 t = 0; t < transients.Length(); ++t) {
+        auto source = transients[t];
+        u32 width, height;
+        const u64 size = SourceSize(*source, width, height);
+        TransientMemory += size;
+
+        u32 slot = INVALID::ID;
+        if (size) {
+            for (u32 a = 0; a < AliasSlots.Length(); ++a) {
+                const auto& candidate = AliasSlots[a];
+                if (candidate.type == source->type && candidate.width == width && candidate.height == height &&
+                    candidate.size == size && candidate.LastUse < source->FirstUse) {
+                    slot = a;
+                    break;
+                }
+            }
+        }
+        if (slot == INVALID::ID) {
+            slot = AliasSlots.Length();
+            AliasSlots.PushBack(RendergraphAliasSlot{source->type, width, height, size, source->LastUse, 0});
+            AliasedMemory += size;
+        } else {
+            SharedCount++;
+        }
+        auto& AliasSlot = AliasSlots[slot];
+        AliasSlot.LastUse = source->LastUse;
+        AliasSlot.SourceCount++;
+        source->AliasSlot = slot;
+    }
+
+    const f64 MiB = 1024.0 * 1024.0;
+    MINFO("Рендерграф '%s' скомпилирован: выполняется %u из %u проходов, временных целей %u в %u ячейках (%u общих), память %.2f МиБ вместо %.2f МиБ, экономия %.2f МиБ.",
+          name.c_str(), ExecutionOrder.Length(), PassCount, transients.Length(), AliasSlots.Length(), SharedCount,
+          AliasedMemory / MiB, TransientMemory / MiB, (TransientMemory - AliasedMemory) / MiB);
+    for (u32 i = 0; i < PassCount; ++i) {
+        if (passes[i]->culled) {
+            MDEBUG("Рендерграф '%s': проход '%s' отсечен, его выходы не доходят до заднего буфера.", name.c_str(), passes[i]->name.c_str());
+        }
+    }
+
+    return true;
+}
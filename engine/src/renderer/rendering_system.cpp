@@ -11,10 +11,17 @@
 #include "viewport.h"
 #include "core/mvar.h"
 #include "core/systems_manager.hpp"
+#include "core/mthread.hpp"
+#include "core/msemaphore.hpp"
 
 #include <new>
 
 #include "core/metrics.h"
+#include "core/console.hpp"
+#include "core/profiler.h"
+
+constexpr u8 RECORDING_MAX_WORKERS = 7;  // Максимальное количество потоков записи команд, не считая основного.
+constexpr u8 RECORDING_MAX_GROUPS  = 8;  // Максимальное количество групп представлений, записываемых за кадр.
 
 struct sRenderingSystem
 {
@@ -26,11 +33,117 @@ struct sRenderingSystem
     u8 WindowRenderTargetCount;   // Количество целей рендеринга. Обычно совпадает с количеством изображений swapchain.
     bool resizing;                // Указывает, изменяется ли размер окна в данный момент.
     u8 FramesSinceResize;         // Текущее количество кадров с момента последней операции изменения размера. Устанавливается только если resizing = true. В противном случае 0.
-    Viewport* ActiveViewport;
 
-    constexpr sRenderingSystem(RendererPlugin* plugin) : ptrRenderer(plugin), FramebufferWidth(1280), FramebufferHeight(720), WindowRenderTargetCount(), resizing(false), FramesSinceResize(), ActiveViewport(nullptr) {}
+    bool MultithreadedRecording;  // Указывает, записываются ли группы представлений параллельно.
+    volatile bool running;        // Указывает, должны ли потоки записи продолжать работу.
+    u8 WorkerCount;               // Количество потоков записи (не считая основного).
+    MThread workers[RECORDING_MAX_WORKERS];
+    MSemaphore StartSemaphore;    // Пробуждает потоки записи в начале кадра.
+    MSemaphore DoneSemaphore;     // Сигнализируется каждым потоком записи по завершении своей части кадра.
+
+    // Текущее задание записи. Заполняется основным потоком перед пробуждением потоков записи.
+    RenderViewPacket* packets;
+    const u8* groups;
+    u16 PacketCount;
+    u16 GroupStarts[RECORDING_MAX_GROUPS + 1]; // Индекс первого пакета каждой группы; последний элемент равен PacketCount.
+    u8 GroupCount;
+    const FrameData* pFrameData;
+    u32 NextGroup;                // Следующая группа, которую возьмет свободный поток. Изменяется атомарно.
+    bool result;                  // Результат записи групп потоками записи. Изменяется атомарно.
+
+    sRenderingSystem(RendererPlugin* plugin) 
+    : ptrRenderer(plugin), FramebufferWidth(1280), FramebufferHeight(720), WindowRenderTargetCount(), resizing(false), FramesSinceResize(), 
+    MultithreadedRecording(false), running(false), WorkerCount(), workers(), StartSemaphore(), DoneSemaphore(), 
+    packets(nullptr), groups(nullptr), PacketCount(), GroupStarts(), GroupCount(), pFrameData(nullptr), NextGroup(), result(true) {}
 };
 
+/// @brief Выводит в консоль время проходов рендеринга на GPU.
+static void RenderingCommandGpuPassTimes(ConsoleCommandContext context)
+{
+    GpuPassTiming timings[GPU_PASS_TIMING_MAX];
+    const u32 count = RenderingSystem::GpuPassTimings(timings, GPU_PASS_TIMING_MAX);
+    if (!count) {
+        Console::WriteLine(Log::Level::Info, "gpu_pass_times: время проходов на GPU недоступно.");
+        return;
+    }
+
+    char line[256] = {0};
+    for (u32 i = 0; i < count; ++i) {
+        MString::Format(line, "%-24s %8.3f мс (среднее %8.3f мс)", timings[i].name, timings[i].LastMs, timings[i].AverageMs);
+        Console::WriteLine(Log::Level::Info, line);
+    }
+    f64 LastMs, AverageMs;
+    Metrics::GpuFrameTime(LastMs, AverageMs);
+    MString::Format(line, "%-24s %8.3f мс (среднее %8.3f мс)", "всего", LastMs, AverageMs);
+    Console::WriteLine(Log::Level::Info, line);
+}
+
+/// @brief Выводит в консоль статистику загрузки униформ последнего кадра.
+static void RenderingCommandUniformStats(ConsoleCommandContext context)
+{
+    UniformUploadStats stats{};
+    RenderingSystem::UniformStats(stats);
+
+    char line[256] = {0};
+    MString::Format(line, "uniform_stats: %llu байт, %u выделений, %u записей дескрипторов, %u переполнений.",
+                    stats.BytesUploaded, stats.Allocations, stats.DescriptorUpdates, stats.Overflows);
+    Console::WriteLine(Log::Level::Info, line);
+}
+
+// Активная область просмотра своя у каждого потока записи, поскольку каждый поток записывает в свой буфер команд.
+static thread_local Viewport* ActiveViewport = nullptr;
+
+static sRenderingSystem* pState = nullptr;
+
+/// @brief Берет свободные группы по одной и записывает их, пока группы не закончатся.
+static bool RecordGroups()
+{
+    MPROFILE_SCOPE("RenderingSystem::RecordGroups");
+    bool result = true;
+    while (true) {
+        const u32 group = __atomic_fetch_add(&pState->NextGroup, 1, __ATOMIC_ACQ_REL);
+        if (group >= pState->GroupCount) {
+            break;
+        }
+
+        auto plugin = pState->ptrRenderer;
+        // Каждая группа получает свой контекст, поэтому порядок выполнения на основном потоке не зависит от того, кто ее записал.
+        if (!plugin->RecordingBegin(group)) {
+            result = false;
+            continue;
+        }
+        for (u16 i = pState->GroupStarts[group]; i < pState->GroupStarts[group + 1]; ++i) {
+            auto& packet = pState->packets[i];
+            if (!packet.view->Render(packet.view, packet, *pState->pFrameData)) {
+                MERROR("Ошибка рендеринга представления индекса %i.", i);
+                result = false;
+            }
+        }
+        if (!plugin->RecordingEnd(group)) {
+            result = false;
+        }
+    }
+    return result;
+}
+
+/// @brief Поток записи. Спит на семафоре до начала кадра, записывает группы и сообщает о завершении.
+static u32 RecordingWorkerRun(void* params)
+{
+    Profiler::SetThreadName("Запись команд");
+    while (true) {
+        pState->StartSemaphore.Wait();
+        if (!pState->running) {
+            pState->DoneSemaphore.Signal();
+            break;
+        }
+        if (!RecordGroups()) {
+            __atomic_store_n(&pState->result, false, __ATOMIC_RELEASE);
+        }
+        pState->DoneSemaphore.Signal();
+    }
+    return 0;
+}
+
 bool RenderingSystem::Initialize(u64& MemoryRequirement, void* memory, void* config)
 {
     auto pConfig = reinterpret_cast<RenderingSystemConfig*>(config);
@@ -57,11 +170,58 @@ bool RenderingSystem::Initialize(u64& MemoryRequirement, void* memory, void* con
         MERROR("Систему рендеринга не удалось инициализировать. Выключение.");
         return false;
     }
+
+    pState = pRenderingSystem;
+
+    // Потоки записи создаются, только если рендерер умеет записывать команды из нескольких потоков.
+    // Основной поток тоже записывает, поэтому дополнительных потоков на один меньше, чем контекстов.
+    u8 ContextCount = pRenderingSystem->ptrRenderer->RecordingContextCount();
+    if (ContextCount > 1) {
+        const i32 ProcessorCount = PlatformGetProcessorCount();
+        if (ProcessorCount > 0 && ContextCount > ProcessorCount) {
+            ContextCount = ProcessorCount;
+        }
+        pRenderingSystem->WorkerCount = MMIN(ContextCount - 1, RECORDING_MAX_WORKERS);
+        pRenderingSystem->running = true;
+        for (u8 i = 0; i < pRenderingSystem->WorkerCount; ++i) {
+            if (!pRenderingSystem->workers[i].Create(RecordingWorkerRun, nullptr, false)) {
+                MERROR("Не удалось создать поток записи команд %u.", i);
+                pRenderingSystem->WorkerCount = i;
+                break;
+            }
+        }
+        MINFO("Многопоточная запись команд доступна: %u потоков записи.", pRenderingSystem->WorkerCount);
+    }
+
+    // Создайте mvar, управляющий многопоточной записью. По умолчанию выключено.
+    MVar::CreateInt("mt_recording", 0);
+    // Отсечение непрозрачных геометрий мира на GPU с косвенной отрисовкой. По умолчанию выключено.
+    MVar::CreateInt("gpu_culling", 0);
+
+    Console::RegisterCommand("gpu_pass_times", 0, RenderingCommandGpuPassTimes);
+    Console::RegisterCommand("uniform_stats", 0, RenderingCommandUniformStats);
+
     return true;
 }
 
 void RenderingSystem::Shutdown()
-{}
+{
+    if (!pState) {
+        return;
+    }
+
+    // Разбудить потоки записи, чтобы они увидели флаг остановки, и дождаться их выхода.
+    pState->running = false;
+    pState->StartSemaphore.Signal(pState->WorkerCount);
+    for (u8 i = 0; i < pState->WorkerCount; ++i) {
+        pState->DoneSemaphore.Wait();
+    }
+    for (u8 i = 0; i < pState->WorkerCount; ++i) {
+        pState->workers[i].~MThread();
+    }
+    pState->WorkerCount = 0;
+    pState = nullptr;
+}
 
 void RenderingSystem::OnResized(u16 width, u16 height)
 {
@@ -114,6 +274,21 @@ bool RenderingSystem::PrepareFrame(FrameData& rFrameData)
 
     bool result = plugin->PrepareFrame(rFrameData);
 
+    // Опубликовать время кадра на GPU. Рендерер читает метки времени без ожидания, поэтому это данные одного из прошлых кадров.
+    GpuPassTiming timings[GPU_PASS_TIMING_MAX];
+    const u32 TimingCount = plugin->GpuPassTimings(timings, GPU_PASS_TIMING_MAX);
+    f64 GpuLastMs = 0, GpuAverageMs = 0;
+    for (u32 i = 0; i < TimingCount; ++i) {
+        GpuLastMs += timings[i].LastMs;
+        GpuAverageMs += timings[i].AverageMs;
+    }
+    Metrics::SetGpuFrameTime(GpuLastMs, GpuAverageMs);
+
+    // Статистика униформ прошлого кадра: объем, скопированный в кольцо, и количество записей дескрипторов.
+    UniformUploadStats UniformStats{};
+    plugin->UniformStats(UniformStats);
+    Metrics::SetUniformUploads(UniformStats.BytesUploaded, UniformStats.DescriptorUpdates);
+
     // Обновляем данные кадра с учетом информации о рендерере.
     const u8& AttachmentIndex = plugin->WindowAttachmentIndexGet();
 
@@ -179,6 +354,12 @@ void RenderingSystem::TextureWriteData(Texture *texture, u32 offset, u32 size, c
     pRenderingSystem->ptrRenderer->TextureWriteData(texture, offset, size, pixels);
 }
 
+void RenderingSystem::TextureWriteRegion(Texture *texture, u32 x, u32 y, u32 width, u32 height, const u8 *pixels)
+{
+    auto pRenderingSystem = reinterpret_cast<sRenderingSystem*>(SystemsManager::GetState(MSystem::Type::Renderer));
+    pRenderingSystem->ptrRenderer->TextureWriteRegion(texture, x, y, width, height, pixels);
+}
+
 void RenderingSystem::TextureReadData(Texture *texture, u32 offset, u32 size, void **OutMemory)
 {
     auto pRenderingSystem = reinterpret_cast<sRenderingSystem*>(SystemsManager::GetState(MSystem::Type::Renderer));
@@ -191,6 +372,24 @@ void RenderingSystem::TextureReadPixel(Texture *texture, u32 x, u32 y, u8 **OutR
     pRenderingSystem->ptrRenderer->TextureReadPixel(texture, x, y, OutRgba);
 }
 
+u64 RenderingSystem::TextureReadDataAsync(Texture *texture, u32 offset, u32 size)
+{
+    auto pRenderingSystem = reinterpret_cast<sRenderingSystem*>(SystemsManager::GetState(MSystem::Type::Renderer));
+    return pRenderingSystem->ptrRenderer->TextureReadDataAsync(texture, offset, size);
+}
+
+u64 RenderingSystem::TextureReadPixelAsync(Texture *texture, u32 x, u32 y)
+{
+    auto pRenderingSystem = reinterpret_cast<sRenderingSystem*>(SystemsManager::GetState(MSystem::Type::Renderer));
+    return pRenderingSystem->ptrRenderer->TextureReadPixelAsync(texture, x, y);
+}
+
+ReadbackStatus RenderingSystem::ReadbackPoll(u64 ticket, void *OutMemory)
+{
+    auto pRenderingSystem = reinterpret_cast<sRenderingSystem*>(SystemsManager::GetState(MSystem::Type::Renderer));
+    return pRenderingSystem->ptrRenderer->ReadbackPoll(ticket, OutMemory);
+}
+
 void *RenderingSystem::TextureCopyData(const Texture *texture)
 {
     auto pRenderingSystem = reinterpret_cast<sRenderingSystem*>(SystemsManager::GetState(MSystem::Type::Renderer));
@@ -248,6 +447,15 @@ MAPI bool RenderingSystem::Load(Geometry *geometry)
 
 void RenderingSystem::GeometryVertexUpdate(Geometry *geometry, u32 offset, u32 VertexCount, void *vertices)
 {
+    // Копия вершин на CPU и поколение геометрии остаются актуальными: по ним пакет интерфейса узнает об изменении.
+    if (geometry->vertices && vertices != geometry->vertices && offset / geometry->VertexElementSize + VertexCount <= geometry->VertexCount) {
+        MemorySystem::CopyMem((u8*)geometry->vertices + offset, (u8*)vertices + offset, VertexCount * geometry->VertexElementSize);
+    }
+    // Недействительное поколение означает незагруженную геометрию, поэтому счетчик его пропускает.
+    if (geometry->generation != INVALID::U16ID) {
+        geometry->generation = (geometry->generation + 1) % INVALID::U16ID;
+    }
+
     auto pRenderingSystem = reinterpret_cast<sRenderingSystem*>(SystemsManager::GetState(MSystem::Type::Renderer));
     return pRenderingSystem->ptrRenderer->GeometryVertexUpdate(geometry, offset, VertexCount, vertices);
 }
@@ -324,6 +532,12 @@ bool RenderingSystem::ShaderInitialize(Shader *shader)
     return pRenderingSystem->ptrRenderer->ShaderInitialize(shader);
 }
 
+bool RenderingSystem::ShaderReload(Shader *shader)
+{
+    auto pRenderingSystem = reinterpret_cast<sRenderingSystem*>(SystemsManager::GetState(MSystem::Type::Renderer));
+    return pRenderingSystem->ptrRenderer->ShaderReload(shader);
+}
+
 bool RenderingSystem::ShaderUse(Shader *shader)
 {
     auto pRenderingSystem = reinterpret_cast<sRenderingSystem*>(SystemsManager::GetState(MSystem::Type::Renderer));
@@ -432,6 +646,118 @@ const bool& RenderingSystem::IsMultithreaded()
     return pRenderingSystem->ptrRenderer->IsMultithreaded();
 }
 
+u64 RenderingSystem::UploadTicket()
+{
+    auto pRenderingSystem = reinterpret_cast<sRenderingSystem*>(SystemsManager::GetState(MSystem::Type::Renderer));
+    return pRenderingSystem->ptrRenderer->UploadTicket();
+}
+
+u32 RenderingSystem::GpuPassTimings(GpuPassTiming *OutTimings, u32 MaxCount)
+{
+    auto pRenderingSystem = reinterpret_cast<sRenderingSystem*>(SystemsManager::GetState(MSystem::Type::Renderer));
+    return pRenderingSystem->ptrRenderer->GpuPassTimings(OutTimings, MaxCount);
+}
+
+void RenderingSystem::UniformStats(UniformUploadStats &OutStats)
+{
+    auto pRenderingSystem = reinterpret_cast<sRenderingSystem*>(SystemsManager::GetState(MSystem::Type::Renderer));
+    pRenderingSystem->ptrRenderer->UniformStats(OutStats);
+}
+
+bool RenderingSystem::GpuCullingUpload(const GpuCullInstance *instances, u32 count)
+{
+    auto pRenderingSystem = reinterpret_cast<sRenderingSystem*>(SystemsManager::GetState(MSystem::Type::Renderer));
+    return pRenderingSystem->ptrRenderer->GpuCullingUpload(instances, count);
+}
+
+void RenderingSystem::GpuCullingSetView(const Matrix4D &projection, const Matrix4D &view)
+{
+    auto pRenderingSystem = reinterpret_cast<sRenderingSystem*>(SystemsManager::GetState(MSystem::Type::Renderer));
+    pRenderingSystem->ptrRenderer->GpuCullingSetView(projection, view);
+}
+
+bool RenderingSystem::GpuCullingDraw(u32 first, u32 count)
+{
+    auto pRenderingSystem = reinterpret_cast<sRenderingSystem*>(SystemsManager::GetState(MSystem::Type::Renderer));
+    return pRenderingSystem->ptrRenderer->GpuCullingDraw(first, count);
+}
+
+void RenderingSystem::SetMultithreadedRecording(bool enabled)
+{
+    auto pRenderingSystem = reinterpret_cast<sRenderingSystem*>(SystemsManager::GetState(MSystem::Type::Renderer));
+    if (enabled && pRenderingSystem->WorkerCount == 0) {
+        MWARN("Рендерер не поддерживает многопоточную запись команд. Представления будут записываться последовательно.");
+    }
+    pRenderingSystem->MultithreadedRecording = enabled;
+}
+
+bool RenderingSystem::MultithreadedRecordingEnabled()
+{
+    auto pRenderingSystem = reinterpret_cast<sRenderingSystem*>(SystemsManager::GetState(MSystem::Type::Renderer));
+    return pRenderingSystem->MultithreadedRecording && pRenderingSystem->WorkerCount > 0;
+}
+
+bool RenderingSystem::RenderViews(RenderViewPacket* packets, const u8* groups, u16 count, const FrameData& rFrameData)
+{
+    auto pRenderingSystem = reinterpret_cast<sRenderingSystem*>(SystemsManager::GetState(MSystem::Type::Renderer));
+
+    if (!MultithreadedRecordingEnabled() || !groups || count < 2) {
+        bool result = true;
+        for (u16 i = 0; i < count; ++i) {
+            auto& packet = packets[i];
+            if (!packet.view->Render(packet.view, packet, rFrameData)) {
+                MERROR("Ошибка рендеринга представления индекса %i.", i);
+                result = false;
+            }
+        }
+        return result;
+    }
+
+    // Разбить пакеты на группы. Номера групп не убывают, поэтому каждая группа — непрерывный диапазон.
+    auto plugin = pRenderingSystem->ptrRenderer;
+    const u8 MaxGroups = MMIN(plugin->RecordingContextCount(), RECORDING_MAX_GROUPS);
+    u8 GroupCount = 0;
+    for (u16 i = 0; i < count; ++i) {
+        if (i == 0 || groups[i] != groups[i - 1]) {
+            if (i > 0 && groups[i] < groups[i - 1]) {
+                MERROR("RenderingSystem::RenderViews: номера групп должны не убывать.");
+                return false;
+            }
+            if (GroupCount == MaxGroups) {
+                // Контекстов не хватает — оставшиеся пакеты дописываются в последнюю группу.
+                break;
+            }
+            pRenderingSystem->GroupStarts[GroupCount++] = i;
+        }
+    }
+    pRenderingSystem->GroupStarts[GroupCount] = count;
+
+    pRenderingSystem->packets = packets;
+    pRenderingSystem->groups = groups;
+    pRenderingSystem->PacketCount = count;
+    pRenderingSystem->GroupCount = GroupCount;
+    pRenderingSystem->pFrameData = &rFrameData;
+    __atomic_store_n(&pRenderingSystem->result, true, __ATOMIC_RELEASE);
+    __atomic_store_n(&pRenderingSystem->NextGroup, 0, __ATOMIC_RELEASE);
+
+    // Основной поток записывает наравне с потоками записи.
+    const u8 WakeCount = MMIN(pRenderingSystem->WorkerCount, GroupCount - 1);
+    pRenderingSystem->StartSemaphore.Signal(WakeCount);
+    bool result = RecordGroups();
+    for (u8 i = 0; i < WakeCount; ++i) {
+        pRenderingSystem->DoneSemaphore.Wait();
+    }
+    result = result && __atomic_load_n(&pRenderingSystem->result, __ATOMIC_ACQUIRE);
+
+    // Выполнить вторичные буферы команд в порядке групп.
+    if (!plugin->RecordingExecute(GroupCount)) {
+        MERROR("RenderingSystem::RenderViews: не удалось выполнить записанные команды.");
+        return false;
+    }
+
+    return result;
+}
+
 bool RenderingSystem::FlagEnabled(RendererConfigFlags flag)
 {
     auto pRenderingSystem = reinterpret_cast<sRenderingSystem*>(SystemsManager::GetState(MSystem::Type::Renderer));
@@ -539,15 +865,14 @@ bool RenderingSystem::RenderBufferDraw(RenderBuffer &buffer, u64 offset, u32 Ele
 
 Viewport *RenderingSystem::GetActiveViewport()
 {
-    auto pRenderingSystem = reinterpret_cast<sRenderingSystem*>(SystemsManager::GetState(MSystem::Type::Renderer));
-    return pRenderingSystem->ActiveViewport;
+    return ActiveViewport;
 }
 
 void RenderingSystem::SetActiveViewport(Viewport *viewvport)
 {
     auto pRenderingSystem = reinterpret_cast<sRenderingSystem*>(SystemsManager::GetState(MSystem::Type::Renderer));
     auto Renderer = pRenderingSystem->ptrRenderer;
-    pRenderingSystem->ActiveViewport = viewvport;
+    ActiveViewport = viewvport;
 
     auto& rect = viewvport->rect;
     Rect2D ViewportRect {rect.x, rect.y + rect.height, rect.width, -rect.height};
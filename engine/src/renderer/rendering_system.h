@@ -17,6 +17,7 @@ class VulkanAPI;
 struct Shader;
 struct FrameData;
 struct Viewport;
+struct RenderViewPacket;
 
 struct RenderingSystemConfig
 {
@@ -92,6 +93,15 @@ namespace RenderingSystem
     /// @param pixels необработанные данные изображения, которые необходимо записать.
     MAPI void TextureWriteData(Texture* texture, u32 offset, u32 size, const u8* pixels);
 
+    /// @brief Записывает прямоугольную область текстуры, сохраняя остальное содержимое. Текстура должна быть уже загружена.
+    /// @param texture указатель на текстуру, в которую нужно записать.
+    /// @param x левая граница области в пикселях.
+    /// @param y верхняя граница области в пикселях.
+    /// @param width ширина области в пикселях.
+    /// @param height высота области в пикселях.
+    /// @param pixels пиксели области построчно, без промежутков между строками.
+    MAPI void TextureWriteRegion(Texture* texture, u32 x, u32 y, u32 width, u32 height, const u8* pixels);
+
     /// @brief Считывает указанные данные из предоставленной текстуры.
     /// @param texture Указатель на текстуру для чтения.
     /// @param offset Смещение в байтах от начала данных для чтения.
@@ -106,6 +116,27 @@ namespace RenderingSystem
     /// @param OutRgba Указатель на массив u8 для хранения данных пикселей (должен быть sizeof(u8) * 4)
     MAPI void TextureReadPixel(Texture* texture, u32 x, u32 y, u8** OutRgba);
 
+    /// @brief Ставит в очередь асинхронное чтение данных текстуры, например для снимков экрана.
+    /// Чтение видит результат всех проходов текущего кадра и не останавливает конвейер.
+    /// @param texture Указатель на текстуру для чтения.
+    /// @param offset Смещение в байтах от начала данных для чтения.
+    /// @param size Количество байтов для чтения.
+    /// @return номер чтения для ReadbackPoll; 0, если чтение не удалось поставить в очередь.
+    MAPI u64 TextureReadDataAsync(Texture* texture, u32 offset, u32 size);
+
+    /// @brief Ставит в очередь асинхронное чтение пикселя текстуры с указанной координатой x/y.
+    /// @param texture Указатель на текстуру для чтения.
+    /// @param x Координата x пикселя.
+    /// @param y Координата y пикселя.
+    /// @return номер чтения для ReadbackPoll; 0, если чтение не удалось поставить в очередь.
+    MAPI u64 TextureReadPixelAsync(Texture* texture, u32 x, u32 y);
+
+    /// @brief Проверяет асинхронное чтение и, если оно завершено, копирует результат.
+    /// @param ticket номер чтения.
+    /// @param OutMemory память для результата: не меньше запрошенного размера, для пикселя sizeof(u8) * 4.
+    /// @return ReadbackStatus::Ready, если результат скопирован; Pending, если его нужно запросить позже.
+    MAPI ReadbackStatus ReadbackPoll(u64 ticket, void* OutMemory);
+
     /// @brief Копирует данные структуры и возвращает указатель на них
     /// @param texture текстура данные которой нужно скопировать
     /// @return укахатель на данные
@@ -194,6 +225,12 @@ namespace RenderingSystem
     /// @return true в случае успеха, иначе false.
     MAPI bool ShaderInitialize(Shader* shader);
 
+    /// @brief Перезагружает модули этапов шейдера с диска и пересоздает его конвейеры. 
+    /// Ресурсы экземпляров и униформы сохраняются. При ошибке шейдер остается в прежнем виде.
+    /// @param shader указатель на шейдер, который необходимо перезагрузить.
+    /// @return true в случае успеха, иначе false.
+    MAPI bool ShaderReload(Shader* shader);
+
     /// @brief Использует заданный шейдер, активируя его для обновления атрибутов, униформы и т. д., а также для использования в вызовах отрисовки.---
     /// @param shader указатель на используемый шейдер.
     /// @return true в случае успеха, иначе false.
@@ -286,6 +323,57 @@ namespace RenderingSystem
     /// @brief Указывает, поддерживает ли рендерер многопоточность.
     const bool& IsMultithreaded();
 
+    /// @brief Включает или выключает многопоточную запись представлений. Действует, только если рендерер поддерживает контексты записи.
+    /// @param enabled указывает, следует ли записывать группы представлений в параллельных потоках.
+    MAPI void SetMultithreadedRecording(bool enabled);
+
+    /// @brief Указывает, записываются ли группы представлений в параллельных потоках.
+    MAPI bool MultithreadedRecordingEnabled();
+
+    /// @brief Отрисовывает пакеты представлений. Представления одной группы записываются последовательно одним потоком,
+    /// разные группы — параллельно, каждая в свой контекст записи. Результат выполняется в порядке групп, поэтому
+    /// номера групп не должны убывать по порядку представлений. Представления, использующие одни и те же шейдеры, должны
+    /// находиться в одной группе, так как состояние привязки хранится в шейдере.
+    /// Если многопоточная запись выключена или не поддерживается, все представления отрисовываются по порядку в вызывающем потоке.
+    /// @param packets массив пакетов представлений.
+    /// @param groups массив номеров групп, по одному на пакет. Может быть nullptr — тогда запись последовательная.
+    /// @param count количество пакетов.
+    /// @param rFrameData ссылка на данные текущего кадра.
+    /// @return true, если все представления отрисованы успешно; в противном случае false.
+    MAPI bool RenderViews(RenderViewPacket* packets, const u8* groups, u16 count, const FrameData& rFrameData);
+
+    /// @brief Возвращает номер пакета загрузок, в который попадают текстуры и геометрия, загружаемые сейчас.
+    /// Загрузка завершена на GPU, когда событие EventSystem::RenderUploadsCompleted сообщает номер не меньше этого.
+    /// @return номер пакета; 0, если рендерер выполняет загрузки немедленно.
+    MAPI u64 UploadTicket();
+
+    /// @brief Получает время выполнения проходов рендеринга на GPU со скользящим средним.
+    /// @param OutTimings массив для результатов, не меньше GPU_PASS_TIMING_MAX элементов, чтобы получить все проходы.
+    /// @param MaxCount размер массива.
+    /// @return количество записанных проходов; 0, если рендерер не измеряет время на GPU.
+    MAPI u32 GpuPassTimings(GpuPassTiming* OutTimings, u32 MaxCount);
+
+    /// @brief Получает статистику загрузки униформ последнего завершенного кадра: объем данных и количество записей дескрипторов.
+    /// @param OutStats ссылка на структуру для результатов.
+    MAPI void UniformStats(UniformUploadStats& OutStats);
+
+    /// @brief Загружает экземпляры для отсечения на GPU. Изменившиеся записи копируются в начале следующего кадра.
+    /// @param instances массив экземпляров.
+    /// @param count количество экземпляров.
+    /// @return true в случае успеха; false, если отсечение на GPU недоступно — тогда геометрия рисуется обычным путем.
+    MAPI bool GpuCullingUpload(const GpuCullInstance* instances, u32 count);
+
+    /// @brief Задает камеру, по которой отсекаются экземпляры следующего кадра.
+    /// @param projection матрица проекции.
+    /// @param view матрица вида.
+    MAPI void GpuCullingSetView(const Matrix4D& projection, const Matrix4D& view);
+
+    /// @brief Косвенно рисует диапазон загруженных экземпляров привязанным шейдером.
+    /// @param first индекс первого экземпляра.
+    /// @param count количество экземпляров.
+    /// @return true в случае успеха; в противном случае false.
+    MAPI bool GpuCullingDraw(u32 first, u32 count);
+
     /// @brief Указывает, включен ли предоставленный флаг рендерера. Если передано несколько флагов, все они должны быть установлены, чтобы вернуть значение true.
     /// @param flag проверяемый флаг.
     /// @return True, если флаг(и) установлены; в противном случае false.
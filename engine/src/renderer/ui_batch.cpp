@@ -0,0 +1,319 @@
+#include "ui_batch.h"
+#include "rendering_system.h"
+#include "resources/geometry.h"
+#include "resources/mesh.h"
+#include "resources/ui_text.h"
+#include "core/mvar.h"
+
+/// @brief Пересекаются ли границы на экране.
+MINLINE bool UiBoundsOverlap(const FVec4& a, const FVec4& b)
+{
+    return a.x < b.z && b.x < a.z && a.y < b.w && b.y < a.w;
+}
+
+bool UiBatch::Unchanged(const Span &span, const Item &item)
+{
+    // Преобразование с родителем может измениться через родителя, поэтому такие элементы всегда пересчитываются.
+    const auto& xform = *item.xform;
+    return span.source == item.source && span.UniqueID == item.UniqueID && span.revision == item.revision &&
+        span.VertexCount == item.VertexCount && span.IndexCount == item.IndexCount &&
+        !xform.parent && span.position == xform.position && span.scale == xform.scale &&
+        span.rotation.x == xform.rotation.x && span.rotation.y == xform.rotation.y && span.rotation.z == xform.rotation.z && span.rotation.w == xform.rotation.w;
+}
+
+void UiBatch::Build(Mesh **meshes, u32 MeshCount, Text **texts, u32 TextCount, bool msdf)
+{
+    i32 retained = 1;
+    MVar::GetInt("ui_retained", retained);
+
+    // Элементы кадра в порядке отрисовки: сетки рисовались до текста, так остается и в пакете.
+    items.Clear();
+    for (u32 m = 0; m < MeshCount; ++m) {
+        auto mesh = meshes[m];
+        for (u32 g = 0; g < mesh->GeometryCount; ++g) {
+            auto geometry = mesh->geometries[g];
+            if (!geometry || !geometry->VertexCount) {
+                continue;
+            }
+            // Атрибуты шейдера интерфейса — Vertex2D, индексы рендерера — u32; без копии на CPU геометрию не собрать.
+            if (!geometry->vertices || geometry->VertexElementSize != sizeof(Vertex2D) ||
+                (geometry->IndexCount && (!geometry->indices || geometry->IndexElementSize != sizeof(u32)))) {
+                MWARN("UiBatch::Build геометрия '%s' не подходит для пакета интерфейса и пропущена.", geometry->name);
+                continue;
+            }
+
+            Item item {};
+            item.source = geometry;
+            item.material = geometry->material ? geometry->material : MaterialSystem::GetDefaultUiMaterial();
+            item.key = item.material;
+            item.xform = &mesh->transform;
+            item.vertices = reinterpret_cast<const Vertex2D*>(geometry->vertices);
+            item.VertexCount = geometry->VertexCount;
+            item.indices = reinterpret_cast<const u32*>(geometry->indices);
+            item.IndexCount = geometry->IndexCount ? geometry->IndexCount : geometry->VertexCount;
+            item.UniqueID = geometry->id;
+            item.revision = geometry->generation;
+            items.PushBack(item);
+        }
+    }
+    for (u32 t = 0; t < TextCount; ++t) {
+        auto text = texts[t];
+        if ((text->type == TextType::Msdf) != msdf) {
+            continue;
+        }
+        text->Prepare();
+        if (!text->QuadCount) {
+            continue;
+        }
+
+        Item item {};
+        item.source = text;
+        item.key = text->data;
+        item.text = text;
+        item.xform = &text->transform;
+        item.vertices = text->vertices.Data();
+        item.VertexCount = text->QuadCount * 4;
+        item.IndexCount = text->QuadCount * 6;
+        item.UniqueID = text->UniqueID;
+        item.revision = text->revision;
+        items.PushBack(item);
+    }
+
+    // Если ни один элемент не изменился с прошлой сборки, она остается текущей вместе с уже загруженным потоком.
+    const u32 ItemCount = items.Length();
+    bool changed = !retained || !BuildStamp || ItemCount != spans.Length();
+    for (u32 i = 0; i < ItemCount && !changed; ++i) {
+        changed = !Unchanged(spans[i], items[i]);
+    }
+    if (!changed) {
+        ReusedVertexCount = vertices.Length();
+        return;
+    }
+
+    // Прошлая сборка становится источником копирования, ее массивы переходят к следующей сборке вместе с емкостью.
+    Swap(vertices, PreviousVertices);
+    Swap(PendingIndices, PreviousIndices);
+    Swap(spans, PreviousSpans);
+    vertices.Clear();
+    PendingIndices.Clear();
+    indices.Clear();
+    commands.Clear();
+    spans.Clear();
+    ReusedVertexCount = 0;
+    BuildStamp++;
+
+    for (u32 i = 0; i < ItemCount; ++i) {
+        const auto& item = items[i];
+
+        Span span;
+        span.source = item.source;
+        span.UniqueID = item.UniqueID;
+        span.revision = item.revision;
+        span.position = item.xform->position;
+        span.rotation = item.xform->rotation;
+        span.scale = item.xform->scale;
+        span.VertexCount = item.VertexCount;
+        span.IndexCount = item.IndexCount;
+        span.FirstVertex = vertices.Length();
+        span.FirstIndex = PendingIndices.Length();
+
+        vertices.Resize(span.FirstVertex + item.VertexCount);
+        PendingIndices.Resize(span.FirstIndex + item.IndexCount);
+        Vertex2D* dst = vertices.Data() + span.FirstVertex;
+        u32* DstIndices = PendingIndices.Data() + span.FirstIndex;
+
+        // Элемент на том же месте в порядке отрисовки, что и в прошлой сборке, копируется без пересчета.
+        if (retained && i < PreviousSpans.Length() && Unchanged(PreviousSpans[i], item)) {
+            const Span& previous = PreviousSpans[i];
+            MemorySystem::CopyMem(dst, PreviousVertices.Data() + previous.FirstVertex, sizeof(Vertex2D) * item.VertexCount);
+            MemorySystem::CopyMem(DstIndices, PreviousIndices.Data() + previous.FirstIndex, sizeof(u32) * item.IndexCount);
+            span.bounds = previous.bounds;
+            ReusedVertexCount += item.VertexCount;
+        } else {
+            // Интерфейс плоский: достаточно двумерной части мировой матрицы.
+            const Matrix4D model = item.xform->GetWorld();
+            const Vertex2D* src = item.vertices;
+            span.bounds = FVec4(3.4e38F, 3.4e38F, -3.4e38F, -3.4e38F);
+            for (u32 v = 0; v < item.VertexCount; ++v) {
+                dst[v].position.x = src[v].position.x * model.data[0] + src[v].position.y * model.data[4] + model.data[12];
+                dst[v].position.y = src[v].position.x * model.data[1] + src[v].position.y * model.data[5] + model.data[13];
+                dst[v].texcoord = src[v].texcoord;
+
+                span.bounds.x = MMIN(span.bounds.x, dst[v].position.x);
+                span.bounds.y = MMIN(span.bounds.y, dst[v].position.y);
+                span.bounds.z = MMAX(span.bounds.z, dst[v].position.x);
+                span.bounds.w = MMAX(span.bounds.w, dst[v].position.y);
+            }
+
+            if (item.indices) {
+                MemorySystem::CopyMem(DstIndices, item.indices, sizeof(u32) * item.IndexCount);
+            } else if (item.text) {
+                // Тот же порядок, что и в общем буфере индексов четырехугольников текста.
+                for (u32 q = 0; q < item.text->QuadCount; ++q) {
+                    const u32 v = q * 4;
+                    u32* quad = DstIndices + q * 6;
+                    quad[0] = v + 2; quad[1] = v + 1; quad[2] = v + 0;
+                    quad[3] = v + 3; quad[4] = v + 0; quad[5] = v + 1;
+                }
+            } else {
+                for (u32 v = 0; v < item.IndexCount; ++v) {
+                    DstIndices[v] = v;
+                }
+            }
+        }
+
+        // Элемент может перейти в более раннюю команду с тем же материалом или атласом, только если он не перекрывает ничего,
+        // что нарисовано после этой команды: иначе изменится порядок наложения.
+        span.command = commands.Length();
+        for (u32 c = commands.Length(); c > 0; --c) {
+            auto& prev = commands[c - 1];
+            const void* PrevKey = prev.material ? static_cast<const void*>(prev.material) : static_cast<const void*>(prev.text->data);
+            if (PrevKey == item.key) {
+                prev.bounds.x = MMIN(prev.bounds.x, span.bounds.x);
+                prev.bounds.y = MMIN(prev.bounds.y, span.bounds.y);
+                prev.bounds.z = MMAX(prev.bounds.z, span.bounds.z);
+                prev.bounds.w = MMAX(prev.bounds.w, span.bounds.w);
+                span.command = c - 1;
+                break;
+            }
+            if (UiBoundsOverlap(prev.bounds, span.bounds)) {
+                break;
+            }
+        }
+        if (span.command == commands.Length()) {
+            UiBatchCommand NewCommand {};
+            NewCommand.material = item.material;
+            NewCommand.text = item.text;
+            NewCommand.bounds = span.bounds;
+            commands.PushBack(NewCommand);
+        }
+
+        commands[span.command].IndexCount += item.IndexCount;
+        spans.PushBack(span);
+    }
+
+    // Индексы каждой команды занимают в потоке непрерывный диапазон; вершины остаются в порядке элементов,
+    // поэтому индексы элемента смещаются на его первую вершину.
+    const u32 CommandCount = commands.Length();
+    u32 first = 0;
+    for (u32 c = 0; c < CommandCount; ++c) {
+        commands[c].FirstIndex = first;
+        first += commands[c].IndexCount;
+        // Далее IndexCount служит курсором заполнения и восстанавливается ниже.
+        commands[c].IndexCount = 0;
+    }
+
+    indices.Resize(first);
+    const u32 SpanCount = spans.Length();
+    for (u32 s = 0; s < SpanCount; ++s) {
+        const auto& span = spans[s];
+        auto& command = commands[span.command];
+        u32* dst = indices.Data() + command.FirstIndex + command.IndexCount;
+        const u32* src = PendingIndices.Data() + span.FirstIndex;
+        for (u32 i = 0; i < span.IndexCount; ++i) {
+            dst[i] = src[i] + span.FirstVertex;
+        }
+        command.IndexCount += span.IndexCount;
+    }
+}
+
+bool UiBatch::Upload(u64 FrameNumber)
+{
+    const u32 VertexCount = vertices.Length();
+    const u32 IndexCount = indices.Length();
+    if (!IndexCount) {
+        return true;
+    }
+
+    // Рост емкости: буферы пересоздаются с запасом, прежнее содержимое не нужно — все разделы загружаются заново.
+    if (VertexCount > VertexCapacity || IndexCount > IndexCapacity) {
+        u32 NewVertexCapacity = VertexCapacity ? VertexCapacity : UI_BATCH_MIN_VERTEX_CAPACITY;
+        while (NewVertexCapacity < VertexCount) {
+            NewVertexCapacity *= 2;
+        }
+        // Четырехугольник — 4 вершины и 6 индексов.
+        u32 NewIndexCapacity = IndexCapacity ? IndexCapacity : UI_BATCH_MIN_VERTEX_CAPACITY / 2 * 3;
+        while (NewIndexCapacity < IndexCount) {
+            NewIndexCapacity *= 2;
+        }
+
+        if (VertexCapacity) {
+            RenderingSystem::RenderBufferDestroy(VertexBuffer);
+            RenderingSystem::RenderBufferDestroy(IndexBuffer);
+            VertexCapacity = IndexCapacity = 0;
+        }
+        if (!RenderingSystem::RenderBufferCreate("renderbuffer_vertexbuffer_ui_batch", RenderBufferType::Vertex, sizeof(Vertex2D) * NewVertexCapacity * UI_BATCH_FRAME_COUNT, false, VertexBuffer)) {
+            MERROR("UiBatch::Upload не удалось создать буфер вершин пакета интерфейса.");
+            return false;
+        }
+        if (!RenderingSystem::RenderBufferCreate("renderbuffer_indexbuffer_ui_batch", RenderBufferType::Index, sizeof(u32) * NewIndexCapacity * UI_BATCH_FRAME_COUNT, false, IndexBuffer)) {
+            MERROR("UiBatch::Upload не удалось создать буфер индексов пакета интерфейса.");
+            RenderingSystem::RenderBufferDestroy(VertexBuffer);
+            return false;
+        }
+        if (!RenderingSystem::RenderBufferBind(VertexBuffer, 0) || !RenderingSystem::RenderBufferBind(IndexBuffer, 0)) {
+            MERROR("UiBatch::Upload не удалось привязать буферы пакета интерфейса.");
+            RenderingSystem::RenderBufferDestroy(VertexBuffer);
+            RenderingSystem::RenderBufferDestroy(IndexBuffer);
+            return false;
+        }
+        VertexCapacity = NewVertexCapacity;
+        IndexCapacity = NewIndexCapacity;
+        for (u32 i = 0; i < UI_BATCH_FRAME_COUNT; ++i) {
+            UploadedStamp[i] = 0;
+        }
+    }
+
+    const u32 partition = FrameNumber % UI_BATCH_FRAME_COUNT;
+    VertexOffset = (u64)partition * VertexCapacity * sizeof(Vertex2D);
+    IndexOffset = (u64)partition * IndexCapacity * sizeof(u32);
+
+    // Неизменный интерфейс не пересобирается, и раздел уже содержит этот поток.
+    if (UploadedStamp[partition] == BuildStamp) {
+        return true;
+    }
+    if (!RenderingSystem::RenderBufferLoadRange(VertexBuffer, VertexOffset, sizeof(Vertex2D) * VertexCount, vertices.Data()) ||
+        !RenderingSystem::RenderBufferLoadRange(IndexBuffer, IndexOffset, sizeof(u32) * IndexCount, indices.Data())) {
+        MERROR("UiBatch::Upload не удалось загрузить поток пакета интерфейса.");
+        return false;
+    }
+    UploadedStamp[partition] = BuildStamp;
+
+    return true;
+}
+
+bool UiBatch::Draw(const UiBatchCommand &command)
+{
+    if (!RenderingSystem::RenderBufferDraw(VertexBuffer, VertexOffset, 0, true)) {
+        MERROR("Не удалось привязать буфер вершин пакета интерфейса.");
+        return false;
+    }
+    if (!RenderingSystem::RenderBufferDraw(IndexBuffer, IndexOffset + (u64)command.FirstIndex * sizeof(u32), command.IndexCount, false)) {
+        MERROR("Не удалось нарисовать пакет интерфейса.");
+        return false;
+    }
+    return true;
+}
+
+void UiBatch::Destroy()
+{
+    if (VertexCapacity) {
+        RenderingSystem::RenderBufferDestroy(VertexBuffer);
+        RenderingSystem::RenderBufferDestroy(IndexBuffer);
+        VertexCapacity = IndexCapacity = 0;
+    }
+    if (items.Capacity()) items.Destroy();
+    if (vertices.Capacity()) vertices.Destroy();
+    if (indices.Capacity()) indices.Destroy();
+    if (commands.Capacity()) commands.Destroy();
+    if (PendingIndices.Capacity()) PendingIndices.Destroy();
+    if (spans.Capacity()) spans.Destroy();
+    if (PreviousVertices.Capacity()) PreviousVertices.Destroy();
+    if (PreviousIndices.Capacity()) PreviousIndices.Destroy();
+    if (PreviousSpans.Capacity()) PreviousSpans.Destroy();
+    for (u32 i = 0; i < UI_BATCH_FRAME_COUNT; ++i) {
+        UploadedStamp[i] = 0;
+    }
+    BuildStamp = 0;
+    ReusedVertexCount = 0;
+}
@@ -0,0 +1,117 @@
+/// @file ui_batch.h
+/// @brief Пакет пользовательского интерфейса: геометрии сеток интерфейса (панели, девятисрезы) и четырехугольники глифов
+/// текстов собираются за кадр в один поток вершин и индексов и рисуются командами, сгруппированными по материалу
+/// или атласу шрифта, — один вызов отрисовки на экземпляр шейдера вместо вызова на элемент.
+/// Пакет хранит результат прошлой сборки: неизмененные элементы копируются из него без пересчета, а если не изменилось
+/// ничего, сборка и загрузка на GPU пропускаются. Переменная mvar ui_retained = 0 отключает это для сравнения.
+#pragma once
+
+#include "containers/darray.h"
+#include "math/quaternion.h"
+#include "math/vector4d.h"
+#include "math/vertex.h"
+#include "renderer/renderbuffer.h"
+
+struct Material;
+struct Mesh;
+struct Text;
+struct Transform;
+
+constexpr u32 UI_BATCH_FRAME_COUNT = 3;             // Разделов буферов на GPU: по одному на кадр в полете.
+constexpr u32 UI_BATCH_MIN_VERTEX_CAPACITY = 4096;  // Начальная емкость раздела в вершинах.
+
+/// @brief Вызов отрисовки пакета: непрерывный диапазон индексов с общим экземпляром шейдера.
+struct UiBatchCommand {
+    Material* material; // Материал геометрий сеток команды; nullptr для текста.
+    Text* text;         // Первый текст команды; его экземпляр шейдера привязывает атлас всей команды. nullptr для сеток.
+    u32 FirstIndex;
+    u32 IndexCount;
+    FVec4 bounds;       // Границы команды на экране: minx, miny, maxx, maxy.
+};
+
+class MAPI UiBatch {
+    /// @brief Элемент кадра: геометрия сетки или текст.
+    struct Item {
+        const void* source;     // Геометрия или текст.
+        const void* key;        // Материал геометрии или шрифт текста; элементы с общим ключом рисуются одной командой.
+        Material* material;
+        Text* text;
+        Transform* xform;
+        const Vertex2D* vertices;
+        const u32* indices;     // nullptr — четырехугольники по четыре вершины, как у текста.
+        u32 VertexCount;
+        u32 IndexCount;
+        u32 UniqueID;
+        u32 revision;           // Поколение геометрии или Text::revision.
+    };
+
+    /// @brief Вершины и индексы одного элемента до упорядочивания по командам и состояние элемента,
+    /// по которому следующая сборка узнает, что он не изменился.
+    struct Span {
+        u32 command;
+        u32 FirstVertex;
+        u32 VertexCount;
+        u32 FirstIndex;         // Первый индекс элемента в PendingIndices; индексы отсчитываются от первой вершины элемента.
+        u32 IndexCount;
+        FVec4 bounds;
+        const void* source;
+        u32 UniqueID;
+        u32 revision;
+        FVec3 position;         // Преобразование элемента на момент сборки.
+        Quaternion rotation;
+        FVec3 scale;
+    };
+
+    DArray<Item> items;
+    DArray<u32> PendingIndices;
+    DArray<Span> spans;
+    // Результат прошлой сборки, из которого копируются неизмененные элементы.
+    DArray<Vertex2D> PreviousVertices;
+    DArray<u32> PreviousIndices;
+    DArray<Span> PreviousSpans;
+    u64 UploadedStamp[UI_BATCH_FRAME_COUNT];   // Сборка, загруженная в каждый раздел буферов.
+public:
+    DArray<Vertex2D> vertices;
+    DArray<u32> indices;
+    DArray<UiBatchCommand> commands;
+
+    RenderBuffer VertexBuffer;
+    RenderBuffer IndexBuffer;
+    u32 VertexCapacity;     // Емкость одного раздела в вершинах.
+    u32 IndexCapacity;      // Емкость одного раздела в индексах.
+    u64 VertexOffset;       // Смещение раздела текущего кадра в буфере вершин; действительно после Upload.
+    u64 IndexOffset;        // Смещение раздела текущего кадра в буфере индексов; действительно после Upload.
+    u32 ReusedVertexCount;  // Вершины, скопированные из прошлой сборки без пересчета.
+    u64 BuildStamp;         // Номер последней сборки; 0 — пакет еще не собирался.
+
+    constexpr UiBatch()
+    : items(), PendingIndices(), spans(), PreviousVertices(), PreviousIndices(), PreviousSpans(), UploadedStamp(),
+    vertices(), indices(), commands(), VertexBuffer(), IndexBuffer(),
+    VertexCapacity(), IndexCapacity(), VertexOffset(), IndexOffset(), ReusedVertexCount(), BuildStamp() {}
+
+    /// @brief Собирает пакет кадра из элементов одного шейдера: сначала геометрии сеток, затем тексты. Вершины переводятся
+    /// в пространство экрана на CPU, поэтому команды рисуются с единичной матрицей модели. Массивы сохраняют емкость между кадрами.
+    /// Элемент считается неизмененным, если у него прежние геометрия, преобразование и место в порядке отрисовки.
+    /// @param meshes массив указателей на сетки интерфейса; вершины их геометрий — Vertex2D. Может быть nullptr.
+    /// @param MeshCount количество сеток.
+    /// @param texts массив указателей на тексты в порядке отрисовки.
+    /// @param TextCount количество текстов.
+    /// @param msdf true, чтобы собрать тексты MSDF; false — растровые и системные.
+    void Build(Mesh** meshes, u32 MeshCount, Text** texts, u32 TextCount, bool msdf);
+
+    /// @brief Загружает поток кадра в раздел буферов, который GPU уже не читает; при необходимости расширяет буферы.
+    /// Раздел, уже содержащий текущую сборку, повторно не загружается. Вызывается вне прохода рендеринга.
+    /// @param FrameNumber номер кадра рендерера.
+    /// @return true в случае успеха; в противном случае false.
+    bool Upload(u64 FrameNumber);
+
+    /// @brief Рисует команду пакета. Экземпляр шейдера и локальные униформы должны быть уже применены.
+    /// @param command команда из commands.
+    /// @return true в случае успеха; в противном случае false.
+    bool Draw(const UiBatchCommand& command);
+
+    void Destroy();
+private:
+    /// @brief Совпадает ли элемент с участком прошлой сборки.
+    static bool Unchanged(const Span& span, const Item& item);
+};
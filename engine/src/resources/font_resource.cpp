@@ -0,0 +1,196 @@
+#include "font_resource.hpp"
+
+/// @brief Количество ячеек таблицы с открытой адресацией: степень двойки, не меньше удвоенного количества записей.
+static u32 FontLookupSlotCount(u32 count)
+{
+    u32 SlotCount = 16;
+    while (SlotCount < count * 2) {
+        SlotCount <<= 1;
+    }
+    return SlotCount;
+}
+
+void FontData::BuildLookup()
+{
+    DestroyLookup();
+    generation++;
+
+    // Глифы ASCII, Latin-1 и неизвестной кодовой точки индексируются напрямую, остальные идут в таблицу.
+    u32 HashedCount = 0;
+    for (u32 i = 0; i < GlyphCount; ++i) {
+        const i32 codepoint = glyphs[i].codepoint;
+        if (static_cast<u32>(codepoint) < FONT_GLYPH_DIRECT_COUNT) {
+            if (!DirectGlyphs[codepoint]) {
+                DirectGlyphs[codepoint] = i + 1;
+            }
+        } else if (codepoint == -1) {
+            if (UnknownGlyph == INVALID::ID) {
+                UnknownGlyph = i;
+            }
+        } else if (codepoint != FONT_GLYPH_FREE) {
+            HashedCount++;
+        }
+    }
+
+    if (HashedCount) {
+        GlyphSlotCount = FontLookupSlotCount(HashedCount);
+        GlyphSlots = MemorySystem::TAllocate<FontGlyphSlot>(Memory::HashTable, GlyphSlotCount);
+        for (u32 i = 0; i < GlyphSlotCount; ++i) {
+            GlyphSlots[i].index = INVALID::ID;
+        }
+
+        const u32 mask = GlyphSlotCount - 1;
+        for (u32 i = 0; i < GlyphCount; ++i) {
+            const i32 codepoint = glyphs[i].codepoint;
+            if (static_cast<u32>(codepoint) < FONT_GLYPH_DIRECT_COUNT || codepoint == -1 || codepoint == FONT_GLYPH_FREE) {
+                continue;
+            }
+            u32 slot = FontLookupHash(static_cast<u32>(codepoint)) & mask;
+            while (GlyphSlots[slot].index != INVALID::ID && GlyphSlots[slot].codepoint != codepoint) {
+                slot = (slot + 1) & mask;
+            }
+            // Как и при линейном поиске, побеждает первый глиф с этой кодовой точкой.
+            if (GlyphSlots[slot].index == INVALID::ID) {
+                GlyphSlots[slot].codepoint = codepoint;
+                GlyphSlots[slot].index = i;
+                GlyphSlotUsed++;
+            }
+        }
+    }
+
+    if (KerningCount) {
+        KerningSlotCount = FontLookupSlotCount(KerningCount);
+        KerningSlots = MemorySystem::TAllocate<FontKerningSlot>(Memory::HashTable, KerningSlotCount);
+        for (u32 i = 0; i < KerningSlotCount; ++i) {
+            KerningSlots[i].key = FONT_KERNING_EMPTY_KEY;
+            KerningSlots[i].amount = 0;
+        }
+
+        const u32 mask = KerningSlotCount - 1;
+        for (u32 i = 0; i < KerningCount; ++i) {
+            const u64 key = FontKerningKey(kernings[i].Codepoint0, kernings[i].Codepoint1);
+            // Пара неизвестных глифов совпадает с ключом пустой ячейки и кернинга не имеет.
+            if (key == FONT_KERNING_EMPTY_KEY) {
+                continue;
+            }
+            u32 slot = FontLookupHash(key) & mask;
+            while (KerningSlots[slot].key != FONT_KERNING_EMPTY_KEY && KerningSlots[slot].key != key) {
+                slot = (slot + 1) & mask;
+            }
+            // Повторная пара перезаписывает прежнюю: линейный поиск тоже брал последнюю запись.
+            KerningSlots[slot].key = key;
+            KerningSlots[slot].amount = kernings[i].amount;
+        }
+    }
+}
+
+void FontData::DestroyLookup()
+{
+    if (GlyphSlots) {
+        MemorySystem::Free(GlyphSlots, sizeof(FontGlyphSlot) * GlyphSlotCount, Memory::HashTable);
+        GlyphSlots = nullptr;
+    }
+    if (KerningSlots) {
+        MemorySystem::Free(KerningSlots, sizeof(FontKerningSlot) * KerningSlotCount, Memory::HashTable);
+        KerningSlots = nullptr;
+    }
+    GlyphSlotCount = GlyphSlotUsed = KerningSlotCount = 0;
+    MemorySystem::ZeroMem(DirectGlyphs, sizeof(DirectGlyphs));
+    UnknownGlyph = INVALID::ID;
+}
+
+void FontData::InsertGlyph(u32 index)
+{
+    generation++;
+
+    const i32 codepoint = glyphs[index].codepoint;
+    if (static_cast<u32>(codepoint) < FONT_GLYPH_DIRECT_COUNT) {
+        DirectGlyphs[codepoint] = index + 1;
+        return;
+    }
+    if (codepoint == -1) {
+        UnknownGlyph = index;
+        return;
+    }
+    if (codepoint == FONT_GLYPH_FREE) {
+        return;
+    }
+
+    // Расширение таблицы: занятые ячейки переносятся в новую, вдвое большую.
+    if ((GlyphSlotUsed + 1) * 2 > GlyphSlotCount) {
+        const u32 OldCount = GlyphSlotCount;
+        FontGlyphSlot* OldSlots = GlyphSlots;
+        GlyphSlotCount = FontLookupSlotCount(GlyphSlotUsed + 1);
+        GlyphSlots = MemorySystem::TAllocate<FontGlyphSlot>(Memory::HashTable, GlyphSlotCount);
+        for (u32 i = 0; i < GlyphSlotCount; ++i) {
+            GlyphSlots[i].index = INVALID::ID;
+        }
+        const u32 mask = GlyphSlotCount - 1;
+        for (u32 i = 0; i < OldCount; ++i) {
+            if (OldSlots[i].index == INVALID::ID) {
+                continue;
+            }
+            u32 slot = FontLookupHash(static_cast<u32>(OldSlots[i].codepoint)) & mask;
+            while (GlyphSlots[slot].index != INVALID::ID) {
+                slot = (slot + 1) & mask;
+            }
+            GlyphSlots[slot] = OldSlots[i];
+        }
+        if (OldSlots) {
+            MemorySystem::Free(OldSlots, sizeof(FontGlyphSlot) * OldCount, Memory::HashTable);
+        }
+    }
+
+    const u32 mask = GlyphSlotCount - 1;
+    u32 slot = FontLookupHash(static_cast<u32>(codepoint)) & mask;
+    while (GlyphSlots[slot].index != INVALID::ID && GlyphSlots[slot].codepoint != codepoint) {
+        slot = (slot + 1) & mask;
+    }
+    if (GlyphSlots[slot].index == INVALID::ID) {
+        GlyphSlotUsed++;
+    }
+    GlyphSlots[slot].codepoint = codepoint;
+    GlyphSlots[slot].index = index;
+}
+
+void FontData::RemoveGlyph(i32 codepoint)
+{
+    generation++;
+
+    if (static_cast<u32>(codepoint) < FONT_GLYPH_DIRECT_COUNT) {
+        DirectGlyphs[codepoint] = 0;
+        return;
+    }
+    if (codepoint == -1) {
+        UnknownGlyph = INVALID::ID;
+        return;
+    }
+    if (!GlyphSlotCount || codepoint == FONT_GLYPH_FREE) {
+        return;
+    }
+
+    const u32 mask = GlyphSlotCount - 1;
+    u32 slot = FontLookupHash(static_cast<u32>(codepoint)) & mask;
+    while (GlyphSlots[slot].codepoint != codepoint) {
+        if (GlyphSlots[slot].index == INVALID::ID) {
+            return;
+        }
+        slot = (slot + 1) & mask;
+    }
+    if (GlyphSlots[slot].index == INVALID::ID) {
+        return;
+    }
+
+    // Удаление со сдвигом: следующие ячейки цепочки переносятся в освободившуюся, если их исходная ячейка
+    // не лежит между освободившейся и текущей, поэтому поиск не обрывается на дыре.
+    u32 hole = slot;
+    for (u32 next = (hole + 1) & mask; GlyphSlots[next].index != INVALID::ID; next = (next + 1) & mask) {
+        const u32 home = FontLookupHash(static_cast<u32>(GlyphSlots[next].codepoint)) & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            GlyphSlots[hole] = GlyphSlots[next];
+            hole = next;
+        }
+    }
+    GlyphSlots[hole].index = INVALID::ID;
+    GlyphSlotUsed--;
+}
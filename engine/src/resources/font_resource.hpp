@@ -20,9 +20,42 @@ struct FontKerning {
     i16 amount;
 };
 
+constexpr u32 FONT_GLYPH_DIRECT_COUNT = 256;  // Кодовые точки ASCII и Latin-1, глифы которых ищутся прямой индексацией.
+
+/// @brief Ячейка таблицы поиска глифов по кодовой точке. Пустая ячейка имеет индекс INVALID::ID.
+struct FontGlyphSlot {
+    i32 codepoint;
+    u32 index;
+};
+
+/// @brief Ячейка таблицы кернинга. Ключ — пара кодовых точек; пустая ячейка имеет ключ FONT_KERNING_EMPTY_KEY.
+struct FontKerningSlot {
+    u64 key;
+    i32 amount;
+};
+
+constexpr u64 FONT_KERNING_EMPTY_KEY = ~0ULL;
+constexpr i32 FONT_GLYPH_FREE = -0x7FFFFFFF - 1;  // Кодовая точка освобожденной записи массива глифов; в таблицы не попадает.
+
+/// @brief Хеш целочисленного ключа для таблиц поиска шрифта.
+MINLINE u32 FontLookupHash(u64 key)
+{
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDULL;
+    key ^= key >> 33;
+    return static_cast<u32>(key);
+}
+
+/// @brief Ключ пары кодовых точек в таблице кернинга.
+MINLINE u64 FontKerningKey(i32 Codepoint0, i32 Codepoint1)
+{
+    return (static_cast<u64>(static_cast<u32>(Codepoint0)) << 32) | static_cast<u32>(Codepoint1);
+}
+
 enum class FontType {
     Bitmap,
-    System
+    System,
+    Msdf    // Многоканальное поле расстояний системного шрифта: один атлас на все размеры.
 };
 
 struct FontData {
@@ -41,6 +74,14 @@ struct FontData {
     f32 TabXAdvance             {};
     u32 InternalDataSize        {};
     void* InternalData   {nullptr};
+    u32 DirectGlyphs[FONT_GLYPH_DIRECT_COUNT]{};  // Индексы глифов кодовых точек 0–255, увеличенные на 1. 0, если глифа нет.
+    u32 UnknownGlyph            {};               // Индекс глифа кодовой точки -1. INVALID::ID, если глифа нет.
+    u32 GlyphSlotCount          {};               // Количество ячеек таблицы глифов, степень двойки.
+    u32 GlyphSlotUsed           {};               // Количество занятых ячеек таблицы глифов.
+    FontGlyphSlot* GlyphSlots{nullptr};           // Таблица глифов остальных кодовых точек с открытой адресацией.
+    u32 KerningSlotCount        {};               // Количество ячеек таблицы кернинга, степень двойки.
+    FontKerningSlot* KerningSlots{nullptr};       // Таблица кернинга по парам кодовых точек с открытой адресацией.
+    u32 generation              {};               // Увеличивается при каждом изменении таблиц, то есть при каждом изменении глифов.
 
     constexpr FontData() 
     : 
@@ -58,7 +99,15 @@ struct FontData {
     kernings(), 
     TabXAdvance(), 
     InternalDataSize(), 
-    InternalData(nullptr) {}
+    InternalData(nullptr),
+    DirectGlyphs(),
+    UnknownGlyph(INVALID::ID),
+    GlyphSlotCount(),
+    GlyphSlotUsed(),
+    GlyphSlots(nullptr),
+    KerningSlotCount(),
+    KerningSlots(nullptr),
+    generation() {}
     constexpr FontData(FontData&& f)
     :
     type(f.type), 
@@ -75,8 +124,17 @@ struct FontData {
     kernings(f.kernings), 
     TabXAdvance(f.TabXAdvance), 
     InternalDataSize(f.InternalDataSize), 
-    InternalData(f.InternalData) {
+    InternalData(f.InternalData),
+    DirectGlyphs(),
+    UnknownGlyph(f.UnknownGlyph),
+    GlyphSlotCount(f.GlyphSlotCount),
+    GlyphSlotUsed(f.GlyphSlotUsed),
+    GlyphSlots(f.GlyphSlots),
+    KerningSlotCount(f.KerningSlotCount),
+    KerningSlots(f.KerningSlots),
+    generation(f.generation) {
         MString::Copy(face, f.face, 256);
+        MemorySystem::CopyMem(DirectGlyphs, f.DirectGlyphs, sizeof(DirectGlyphs));
         MString::Zero(f.face);
         f.size = 0;
         f.LineHeight = f.baseline = f.AtlasSizeX = f.AtlasSizeY = 0;
@@ -87,8 +145,16 @@ struct FontData {
         f.TabXAdvance = 0.F;
         f.InternalDataSize = 0;
         f.InternalData = nullptr;
+        f.GlyphSlotCount = f.GlyphSlotUsed = f.KerningSlotCount = 0;
+        f.GlyphSlots = nullptr;
+        f.KerningSlots = nullptr;
     }
     FontData& operator= (FontData&& f) {
+        if (this == &f) {
+            return *this;
+        }
+        // Прежние таблицы поиска принадлежат этому объекту и освобождаются до присваивания.
+        DestroyLookup();
         type = f.type;
         size = f.size;
         MString::Copy(face, f.face, 256);
@@ -104,6 +170,14 @@ struct FontData {
         TabXAdvance = f.TabXAdvance;
         InternalDataSize = f.InternalDataSize;
         InternalData = f.InternalData;
+        MemorySystem::CopyMem(DirectGlyphs, f.DirectGlyphs, sizeof(DirectGlyphs));
+        UnknownGlyph = f.UnknownGlyph;
+        GlyphSlotCount = f.GlyphSlotCount;
+        GlyphSlotUsed = f.GlyphSlotUsed;
+        GlyphSlots = f.GlyphSlots;
+        KerningSlotCount = f.KerningSlotCount;
+        KerningSlots = f.KerningSlots;
+        generation = f.generation;
 
         f.size = 0;
         f.LineHeight = f.baseline = f.AtlasSizeX = f.AtlasSizeY = 0;
@@ -114,9 +188,71 @@ struct FontData {
         f.TabXAdvance = 0.F;
         f.InternalDataSize = 0;
         f.InternalData = nullptr;
+        f.GlyphSlotCount = f.GlyphSlotUsed = f.KerningSlotCount = 0;
+        f.GlyphSlots = nullptr;
+        f.KerningSlots = nullptr;
 
         return *this;
     }
+
+    /// @brief Строит таблицы поиска глифов и кернинга по текущим массивам glyphs и kernings.
+    /// Вызывается после каждого изменения этих массивов; прежние таблицы освобождаются.
+    MAPI void BuildLookup();
+    /// @brief Освобождает таблицы поиска.
+    MAPI void DestroyLookup();
+    /// @brief Добавляет в таблицы поиска один глиф, не перестраивая их. Таблица глифов расширяется при заполнении наполовину.
+    /// @param index индекс глифа в массиве glyphs.
+    MAPI void InsertGlyph(u32 index);
+    /// @brief Удаляет глиф кодовой точки из таблиц поиска, не перестраивая их. Кернинг не меняется.
+    /// @param codepoint кодовая точка.
+    MAPI void RemoveGlyph(i32 codepoint);
+
+    /// @brief Находит глиф кодовой точки. Для ASCII и Latin-1 — прямая индексация, для остальных — таблица с открытой адресацией.
+    /// @param codepoint кодовая точка.
+    /// @return указатель на глиф; nullptr, если глифа нет.
+    MINLINE const FontGlyph* GetGlyph(i32 codepoint) const {
+        if (static_cast<u32>(codepoint) < FONT_GLYPH_DIRECT_COUNT) {
+            const u32 index = DirectGlyphs[codepoint];
+            return index ? &glyphs[index - 1] : nullptr;
+        }
+        if (codepoint == -1) {
+            return UnknownGlyph != INVALID::ID ? &glyphs[UnknownGlyph] : nullptr;
+        }
+        if (!GlyphSlotCount) {
+            return nullptr;
+        }
+        const u32 mask = GlyphSlotCount - 1;
+        for (u32 i = FontLookupHash(static_cast<u32>(codepoint)) & mask;; i = (i + 1) & mask) {
+            const auto& slot = GlyphSlots[i];
+            if (slot.index == INVALID::ID) {
+                return nullptr;
+            }
+            if (slot.codepoint == codepoint) {
+                return &glyphs[slot.index];
+            }
+        }
+    }
+
+    /// @brief Находит кернинг пары кодовых точек.
+    /// @param Codepoint0 первая кодовая точка.
+    /// @param Codepoint1 следующая за ней кодовая точка.
+    /// @return смещение в пикселях; 0, если кернинга для пары нет.
+    MINLINE i32 GetKerning(i32 Codepoint0, i32 Codepoint1) const {
+        if (!KerningSlotCount) {
+            return 0;
+        }
+        const u64 key = FontKerningKey(Codepoint0, Codepoint1);
+        const u32 mask = KerningSlotCount - 1;
+        for (u32 i = FontLookupHash(key) & mask;; i = (i + 1) & mask) {
+            const auto& slot = KerningSlots[i];
+            if (slot.key == key) {
+                return slot.amount;
+            }
+            if (slot.key == FONT_KERNING_EMPTY_KEY) {
+                return 0;
+            }
+        }
+    }
 };
 
 struct BitmapFontPage {
@@ -0,0 +1,193 @@
+#include "glyph_atlas.hpp"
+
+bool GlyphAtlas::Create(u32 width, u32 height, u32 MaxGlyphSize)
+{
+    // Страница должна вмещать самый крупный глиф и не делить атлас больше чем на GLYPH_ATLAS_MAX_PAGES страниц.
+    u32 size = GLYPH_ATLAS_PAGE_SIZE;
+    while ((size < MaxGlyphSize + GLYPH_ATLAS_PADDING || (width / size) * (height / size) > GLYPH_ATLAS_MAX_PAGES) && size < width && size < height) {
+        size <<= 1;
+    }
+    if (size > width || size > height) {
+        MERROR("GlyphAtlas::Create — атлас %ux%u меньше страницы %u.", width, height, size);
+        return false;
+    }
+
+    PageSize = size;
+    PagesPerRow = width / size;
+    PageCount = PagesPerRow * (height / size);
+    OpenPage = GLYPH_ATLAS_NO_PAGE;
+    EvictionCount = RecentEvictionCount = 0;
+    for (u32 i = 0; i < PageCount; ++i) {
+        pages[i].top = 0;
+        pages[i].LastUsed = pages[i].FilledSince = 0;
+        pages[i].pinned = false;
+    }
+    return true;
+}
+
+void GlyphAtlas::Destroy()
+{
+    for (u32 i = 0; i < GLYPH_ATLAS_MAX_PAGES; ++i) {
+        if (pages[i].shelves.Data()) {
+            pages[i].shelves.Destroy();
+        }
+        if (pages[i].glyphs.Data()) {
+            pages[i].glyphs.Destroy();
+        }
+    }
+    if (store.Data()) {
+        store.Destroy();
+    }
+    if (FreeGlyphs.Data()) {
+        FreeGlyphs.Destroy();
+    }
+    PageCount = PagesPerRow = 0;
+    OpenPage = GLYPH_ATLAS_NO_PAGE;
+}
+
+const FontGlyph *GlyphAtlas::Add(FontData &font, const FontGlyph &glyph, u64 stamp, u64 EvictBefore, bool pin)
+{
+    const u32 width = glyph.width + GLYPH_ATLAS_PADDING;
+    const u32 height = glyph.height + GLYPH_ATLAS_PADDING;
+    if (width > PageSize || height > PageSize) {
+        return nullptr;
+    }
+
+    // Сначала открытая страница, затем пустая, затем освобождается самая старая. Глифы, запрошенные вместе,
+    // так оказываются на одной странице и освобождаются вместе.
+    u16 x = 0, y = 0;
+    u32 page = GLYPH_ATLAS_NO_PAGE;
+    if (OpenPage != GLYPH_ATLAS_NO_PAGE && Place(OpenPage, width, height, x, y)) {
+        page = OpenPage;
+    }
+    for (u32 i = 0; i < PageCount && page == GLYPH_ATLAS_NO_PAGE; ++i) {
+        if (!pages[i].top && Place(i, width, height, x, y)) {
+            page = i;
+        }
+    }
+    if (page == GLYPH_ATLAS_NO_PAGE) {
+        const u32 oldest = FindOldestPage(EvictBefore);
+        if (oldest != GLYPH_ATLAS_NO_PAGE) {
+            Evict(font, oldest);
+            page = Place(oldest, width, height, x, y) ? oldest : GLYPH_ATLAS_NO_PAGE;
+        }
+    }
+    // Все страницы недавно рисовались: освобождается раньше всех заполненная страница, не использованная в текущем кадре.
+    // На ней обычно лишь редкие повторы старых символов; они запрашиваются заново и переезжают на открытую страницу,
+    // поэтому не удерживают весь атлас.
+    if (page == GLYPH_ATLAS_NO_PAGE) {
+        const u32 oldest = FindEarliestFilledPage(stamp);
+        if (oldest != GLYPH_ATLAS_NO_PAGE) {
+            Evict(font, oldest);
+            RecentEvictionCount++;
+            page = Place(oldest, width, height, x, y) ? oldest : GLYPH_ATLAS_NO_PAGE;
+        }
+    }
+    if (page == GLYPH_ATLAS_NO_PAGE) {
+        return nullptr;
+    }
+    OpenPage = page;
+
+    auto& p = pages[page];
+    if (!p.glyphs.Length()) {
+        p.FilledSince = stamp;
+    }
+    p.LastUsed = stamp;
+    p.pinned |= pin;
+
+    u32 index;
+    if (FreeGlyphs.Length()) {
+        index = FreeGlyphs[FreeGlyphs.Length() - 1];
+        FreeGlyphs.PopBack();
+    } else {
+        index = store.Length();
+        store.PushBack(glyph);
+    }
+    auto& g = store[index];
+    g = glyph;
+    g.x = (page % PagesPerRow) * PageSize + x;
+    g.y = (page / PagesPerRow) * PageSize + y;
+    g.PageID = page;
+    p.glyphs.PushBack(index);
+
+    // Хранилище могло переместиться.
+    font.glyphs = store.Data();
+    font.GlyphCount = store.Length();
+    font.InsertGlyph(index);
+    return &g;
+}
+
+void GlyphAtlas::Touch(u32 PageMask, u64 stamp)
+{
+    for (u32 page = 0; page < PageCount && PageMask; ++page, PageMask >>= 1) {
+        if (PageMask & 1) {
+            pages[page].LastUsed = stamp;
+        }
+    }
+}
+
+u32 GlyphAtlas::FindOldestPage(u64 before) const
+{
+    u32 oldest = GLYPH_ATLAS_NO_PAGE;
+    for (u32 i = 0; i < PageCount; ++i) {
+        if (!pages[i].pinned && pages[i].LastUsed < before && (oldest == GLYPH_ATLAS_NO_PAGE || pages[i].LastUsed < pages[oldest].LastUsed)) {
+            oldest = i;
+        }
+    }
+    return oldest;
+}
+
+u32 GlyphAtlas::FindEarliestFilledPage(u64 before) const
+{
+    u32 earliest = GLYPH_ATLAS_NO_PAGE;
+    for (u32 i = 0; i < PageCount; ++i) {
+        if (!pages[i].pinned && pages[i].LastUsed < before && (earliest == GLYPH_ATLAS_NO_PAGE || pages[i].FilledSince < pages[earliest].FilledSince)) {
+            earliest = i;
+        }
+    }
+    return earliest;
+}
+
+bool GlyphAtlas::Place(u32 page, u16 width, u16 height, u16 &OutX, u16 &OutY)
+{
+    auto& p = pages[page];
+
+    // Полка с наименьшей подходящей высотой, чтобы низкие глифы не занимали высокие полки.
+    Shelf* best = nullptr;
+    const u32 ShelfCount = p.shelves.Length();
+    for (u32 i = 0; i < ShelfCount; ++i) {
+        auto& shelf = p.shelves[i];
+        if (shelf.height >= height && shelf.x + width <= PageSize && (!best || shelf.height < best->height)) {
+            best = &shelf;
+        }
+    }
+    if (!best) {
+        if (p.top + height > PageSize) {
+            return false;
+        }
+        p.shelves.PushBack({ 0, p.top, height });
+        p.top += height;
+        best = &p.shelves[p.shelves.Length() - 1];
+    }
+
+    OutX = best->x;
+    OutY = best->y;
+    best->x += width;
+    return true;
+}
+
+void GlyphAtlas::Evict(FontData &font, u32 page)
+{
+    auto& p = pages[page];
+    const u32 count = p.glyphs.Length();
+    for (u32 i = 0; i < count; ++i) {
+        const u32 index = p.glyphs[i];
+        font.RemoveGlyph(store[index].codepoint);
+        store[index].codepoint = FONT_GLYPH_FREE;
+        FreeGlyphs.PushBack(index);
+    }
+    p.glyphs.Clear();
+    p.shelves.Clear();
+    p.top = 0;
+    EvictionCount++;
+}
@@ -0,0 +1,76 @@
+/// @file glyph_atlas.hpp
+/// @brief Динамический атлас глифов: текстура делится на квадратные страницы, глифы раскладываются по полкам внутри страниц.
+/// Когда свободного места нет, целиком освобождается страница, дольше всех не попадавшая в кадр.
+#pragma once
+
+#include "font_resource.hpp"
+
+constexpr u32 GLYPH_ATLAS_MAX_PAGES = 32;     // Страниц в атласе не больше, чем бит в маске страниц текста.
+constexpr u16 GLYPH_ATLAS_PAGE_SIZE = 256;    // Наименьшая сторона страницы в пикселях.
+constexpr u16 GLYPH_ATLAS_PADDING = 1;        // Пустая полоса справа и снизу от глифа, чтобы соседи не просвечивали при фильтрации.
+constexpr u8 GLYPH_ATLAS_NO_PAGE = 0xFF;
+
+class MAPI GlyphAtlas
+{
+    /// @brief Полка страницы: строка глифов одной высоты, заполняемая слева направо.
+    struct Shelf {
+        u16 x;
+        u16 y;
+        u16 height;
+    };
+
+    struct Page {
+        DArray<Shelf> shelves;
+        DArray<u32> glyphs;     // Индексы глифов шрифта, лежащих на странице.
+        u16 top;                // Верхняя граница свободного места под новые полки.
+        u64 LastUsed;           // Последний кадр, в котором страница рисовалась или получала глиф.
+        u64 FilledSince;        // Кадр, в котором пустая страница получила первый глиф.
+        bool pinned;            // Закрепленная страница не освобождается, например страница глифов ASCII.
+    };
+
+    Page pages[GLYPH_ATLAS_MAX_PAGES];
+    DArray<FontGlyph> store;    // Хранилище глифов шрифта; освобожденные записи переиспользуются.
+    DArray<u32> FreeGlyphs;     // Индексы освобожденных записей хранилища.
+    u32 PageCount;
+    u32 PagesPerRow;
+    u32 OpenPage;               // Страница, в которую сейчас добавляются глифы.
+public:
+    u16 PageSize;
+    u32 EvictionCount;          // Количество освобожденных страниц за все время.
+    u32 RecentEvictionCount;    // Из них страниц, рисовавшихся в прошлом кадре: все страницы были заняты недавними глифами.
+
+    constexpr GlyphAtlas() : pages(), store(), FreeGlyphs(), PageCount(), PagesPerRow(), OpenPage(GLYPH_ATLAS_NO_PAGE), PageSize(), EvictionCount(), RecentEvictionCount() {}
+
+    /// @brief Размечает атлас на страницы. Сторона страницы выбирается так, чтобы в нее помещался самый крупный глиф шрифта.
+    /// @param width ширина текстуры атласа в пикселях.
+    /// @param height высота текстуры атласа в пикселях.
+    /// @param MaxGlyphSize наибольшая сторона глифа шрифта в пикселях.
+    /// @return true в случае успеха; в противном случае false.
+    bool Create(u32 width, u32 height, u32 MaxGlyphSize);
+    void Destroy();
+
+    /// @brief Размещает глиф в атласе и добавляет его в таблицы поиска шрифта. Если места нет, освобождается
+    /// наименее используемая незакрепленная страница, и ее глифы удаляются из шрифта. Страницы текущего кадра не освобождаются.
+    /// @param font шрифт; его массив глифов указывает на хранилище атласа.
+    /// @param glyph кодовая точка, размеры и метрики глифа; положение в атласе назначается здесь.
+    /// @param stamp текущий кадр.
+    /// @param EvictBefore в первую очередь освобождаются страницы, не использованные начиная с этого кадра.
+    /// @param pin закрепить страницу глифа.
+    /// @return указатель на размещенный глиф; nullptr, если места нет.
+    const FontGlyph* Add(FontData& font, const FontGlyph& glyph, u64 stamp, u64 EvictBefore, bool pin = false);
+
+    /// @brief Отмечает страницы как использованные в кадре.
+    /// @param PageMask маска страниц, по биту на страницу.
+    /// @param stamp текущий кадр.
+    void Touch(u32 PageMask, u64 stamp);
+
+    u32 GetPageCount() const { return PageCount; }
+    u32 GetGlyphCount(u32 page) const { return pages[page].glyphs.Length(); }
+    const FontGlyph* GetGlyphs() const { return store.Data(); }
+    u32 GetStoreLength() const { return store.Length(); }
+private:
+    u32 FindOldestPage(u64 before) const;
+    u32 FindEarliestFilledPage(u64 before) const;
+    bool Place(u32 page, u16 width, u16 height, u16& OutX, u16& OutY);
+    void Evict(FontData& font, u32 page);
+};
@@ -8,94 +8,158 @@
 #define STBI_NO_STDIO
 #include "vendor/stb_image.h"
 
-bool ResourceLoader::Load(const char *name, void* params, ImageResource &OutResource)
+/// @brief Размер стороны уровня детализации.
+MINLINE u32 MipDimension(u32 size, u8 mip)
 {
-    if (!name) {
-        return false;
-    }
+    return size >> mip > 0 ? size >> mip : 1;
+}
 
-    auto TypeParams = reinterpret_cast<ImageResourceParams*>(params);
+/// @brief Наиболее подробный уровень детализации, стороны которого не превышают MaxSize.
+static u8 TargetMip(u32 width, u32 height, u32 MaxSize)
+{
+    u8 mip = 0;
+    while ((MipDimension(width, mip) > MaxSize || MipDimension(height, mip) > MaxSize) &&
+           (MipDimension(width, mip) > 1 || MipDimension(height, mip) > 1)) {
+        mip++;
+    }
+    return mip;
+}
 
-    const char* FormatStr = "%s/%s/%s%s";
-    const i32 RequiredChannelCount = 4;
-    stbi_set_flip_vertically_on_load_thread(TypeParams->FlipY);
-    char FullFilePath[512]{};
-
-    // попробуйте разные расширения
-    constexpr i32 IMAGE_EXTENSION_COUNT = 4;
-    bool found = false;
-    const char* extensions[IMAGE_EXTENSION_COUNT] = {".tga", ".png", ".jpg", ".bmp"};
-    for (u32 i = 0; i < IMAGE_EXTENSION_COUNT; ++i) {
-        MString::Format(FullFilePath, FormatStr, ResourceSystem::BasePath(), TypePath.c_str(), name, extensions[i]);
-        if (Filesystem::Exists(FullFilePath)) {
-            found = true;
-            break;
+/// @brief Уменьшает изображение вдвое по каждой стороне усреднением блоков 2x2. Выполняется на месте:
+/// строка результата не длиннее уже прочитанных строк источника.
+static void Downsample(ImageResourceData& data)
+{
+    const u32 width = data.width > 1 ? data.width / 2 : 1;
+    const u32 height = data.height > 1 ? data.height / 2 : 1;
+    const u32 channels = data.ChannelCount;
+    u8* pixels = data.pixels;
+    for (u32 y = 0; y < height; ++y) {
+        const u64 row0 = (u64)(y * 2 < data.height ? y * 2 : data.height - 1) * data.width;
+        const u64 row1 = (u64)(y * 2 + 1 < data.height ? y * 2 + 1 : data.height - 1) * data.width;
+        for (u32 x = 0; x < width; ++x) {
+            const u64 col0 = x * 2 < data.width ? x * 2 : data.width - 1;
+            const u64 col1 = x * 2 + 1 < data.width ? x * 2 + 1 : data.width - 1;
+            for (u32 c = 0; c < channels; ++c) {
+                const u32 sum = pixels[(row0 + col0) * channels + c] + pixels[(row0 + col1) * channels + c] +
+                                pixels[(row1 + col0) * channels + c] + pixels[(row1 + col1) * channels + c];
+                pixels[((u64)y * width + x) * channels + c] = (u8)((sum + 2) / 4);
+            }
         }
     }
+    data.width = width;
+    data.height = height;
+    data.mip++;
+}
 
-    // Сначала скопируйте полный путь и имя ресурса.
-    OutResource.FullPath = FullFilePath;
-    OutResource.name = name;
-
-    if (!found) {
-        MERROR("Загрузчику ресурсов изображения не удалось найти файл «%s».", FullFilePath);
-        return false;
+/// @brief Уменьшает декодированное изображение до наиболее подробного уровня детализации не больше MaxSize.
+/// Выполняется на потоке задания, которое декодирует изображение, а не на основном потоке.
+static void ReduceImage(ImageResourceData& image, u32 MaxSize)
+{
+    const u8 target = TargetMip(image.width, image.height, MaxSize);
+    while (image.mip < target) {
+        Downsample(image);
     }
+}
 
-    FileHandle f;
-    if (!Filesystem::Open(FullFilePath, FileModes::Read, true, f)) {
-        MERROR("Невозможно прочитать файл: %s.", FullFilePath);
-        Filesystem::Close(f);
+bool ResourceLoader::Load(const char *name, void* params, ImageResource &OutResource)
+{
+    if (!name) {
         return false;
     }
 
-    u64 FileSize = 0;
-    if (!Filesystem::Size(f, FileSize)) {
-        MERROR("Невозможно получить размер файла: %s.", FullFilePath);
-        Filesystem::Close(f);
-        return false;
-    }
+    auto TypeParams = reinterpret_cast<ImageResourceParams*>(params);
+
+    const i32 RequiredChannelCount = 4;
+    stbi_set_flip_vertically_on_load_thread(TypeParams->FlipY);
 
     i32 width;
     i32 height;
     i32 СhannelСount;
+    u8* data = nullptr;
 
-    u8* RawData = MemorySystem::TAllocate<u8>(Memory::Texture, FileSize);
-    if (!RawData) {
-        MERROR("Невозможно прочитать файл «%s».", FullFilePath);
+    if (TypeParams->data) {
+        // Файл уже прочитан (например, асинхронным вводом-выводом), остается только декодировать.
+        OutResource.name = name;
+        if (TypeParams->FullPath) {
+            OutResource.FullPath = TypeParams->FullPath;
+        }
+        data = stbi_load_from_memory(TypeParams->data, TypeParams->DataSize, &width, &height, &СhannelСount, RequiredChannelCount);
+        if (!data) {
+            MERROR("Загрузчику ресурсов изображения не удалось декодировать '%s'.", name);
+            return false;
+        }
+    } else {
+        char FullFilePath[512]{};
+        // попробуйте разные расширения
+        bool found = ResourceSystem::ResolvePath(eResource::Image, name, IMAGE_EXTENSIONS, IMAGE_EXTENSION_COUNT, FullFilePath);
+
+        // Сначала скопируйте полный путь и имя ресурса.
+        OutResource.FullPath = FullFilePath;
+        OutResource.name = name;
+
+        if (!found) {
+            MERROR("Загрузчику ресурсов изображения не удалось найти файл «%s».", FullFilePath);
+            return false;
+        }
+
+        FileHandle f;
+        if (!Filesystem::Open(FullFilePath, FileModes::Read, true, f)) {
+            MERROR("Невозможно прочитать файл: %s.", FullFilePath);
+            Filesystem::Close(f);
+            return false;
+        }
+
+        u64 FileSize = 0;
+        if (!Filesystem::Size(f, FileSize)) {
+            MERROR("Невозможно получить размер файла: %s.", FullFilePath);
+            Filesystem::Close(f);
+            return false;
+        }
+
+        u8* RawData = MemorySystem::TAllocate<u8>(Memory::Texture, FileSize);
+        if (!RawData) {
+            MERROR("Невозможно прочитать файл «%s».", FullFilePath);
+            Filesystem::Close(f);
+            return false;
+        }
+
+        u64 BytesRead = 0;
+        bool ReadResult = Filesystem::ReadAllBytes(f, RawData, BytesRead);
         Filesystem::Close(f);
-        return false;
-    }
 
-    u64 BytesRead = 0;
-    bool ReadResult = Filesystem::ReadAllBytes(f, RawData, BytesRead);
-    Filesystem::Close(f);
+        if (!ReadResult) {
+            MERROR("Невозможно прочитать файл: '%s'", FullFilePath);
+            return false;
+        }
 
-    if (!ReadResult) {
-        MERROR("Невозможно прочитать файл: '%s'", FullFilePath);
-        return false;
-    }
+        if (BytesRead != FileSize) {
+            MERROR("Размер файла, если %llu не соответствует ожидаемому: %llu", BytesRead, FileSize);
+            return false;
+        }
 
-    if (BytesRead != FileSize) {
-        MERROR("Размер файла, если %llu не соответствует ожидаемому: %llu", BytesRead, FileSize);
-        return false;
-    }
+        data = stbi_load_from_memory(RawData, FileSize, &width, &height, &СhannelСount, RequiredChannelCount);
 
-    u8* data = stbi_load_from_memory(RawData, FileSize, &width, &height, &СhannelСount, RequiredChannelCount);
+        MemorySystem::Free(RawData, FileSize, Memory::Texture);
 
-    if (!data) {
-        MERROR("Загрузчику ресурсов изображения не удалось загрузить файл '%s'.", FullFilePath);
-        return false;
+        if (!data) {
+            MERROR("Загрузчику ресурсов изображения не удалось загрузить файл '%s'.", FullFilePath);
+            return false;
+        }
     }
 
-    MemorySystem::Free(RawData, FileSize, Memory::Texture);
-
     // ЗАДАЧА: Здесь следует использовать распределитель.
     auto& image = OutResource.data;
     image.ChannelCount = RequiredChannelCount;
     image.width  = width;
     image.height = height;
     image.pixels = data;
+    image.mip = 0;
+    image.FullWidth = width;
+    image.FullHeight = height;
+
+    if (TypeParams->MaxSize > 0) {
+        ReduceImage(image, TypeParams->MaxSize);
+    }
 
     return true;
 }
@@ -99,6 +99,15 @@ bool ResourceLoader::Load(const char *name, void* params, ShaderResource &OutRes
             } else if (data.stages.Length() != count) {
                 MERROR("ShaderLoader::Load: Недопустимый макет файла. Подсчитайте несоответствие между именами этапов и именами файлов этапов.");
             }
+        } else if (TrimmedVarName.Comparei("bindless_stagefiles")) {
+            // Файлы этапов для режима без привязки. Используются, только если его поддерживает устройство.
+            TrimmedValue.Split(',', data.BindlessStageFilenames, true, true);
+        } else if (TrimmedVarName.Comparei("indirect_vertexfile")) {
+            // Вершинный этап косвенной отрисовки. Используется, только если рендерер поддерживает отсечение на GPU.
+            data.IndirectVertexFilename = TrimmedValue;
+        } else if (TrimmedVarName.Comparei("bindless_indirect_vertexfile")) {
+            // Вершинный этап косвенной отрисовки для режима без привязки: набор отсечения идет после таблицы текстур.
+            data.BindlessIndirectVertexFilename = TrimmedValue;
         } else if (TrimmedVarName.Comparei("cull_mode")) {
             if (TrimmedValue.Comparei("front")) {
                 data.CullMode = FaceCullMode::Front;
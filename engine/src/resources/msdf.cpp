@@ -0,0 +1,313 @@
+#include "msdf.hpp"
+#include "math/math.h"
+
+namespace MsdfColour
+{
+    constexpr u8 Red     = 1;
+    constexpr u8 Green   = 2;
+    constexpr u8 Blue    = 4;
+    constexpr u8 Yellow  = Red | Green;
+    constexpr u8 Magenta = Red | Blue;
+    constexpr u8 Cyan    = Green | Blue;
+    constexpr u8 White   = Red | Green | Blue;
+}
+
+namespace MsdfSegmentFlag
+{
+    constexpr u8 EdgeFirst = 1;
+    constexpr u8 EdgeLast  = 2;
+}
+
+constexpr u32 MSDF_QUAD_SEGMENTS = 8;      // Отрезков на квадратичную кривую.
+constexpr u32 MSDF_CUBIC_SEGMENTS = 12;    // Отрезков на кубическую кривую.
+
+/// @brief Нормализует касательную. Касательная кривой вырождается, если контрольная точка совпадает с концом;
+/// тогда берется запасное направление.
+static void MsdfTangent(f32 x, f32 y, f32 FallbackX, f32 FallbackY, f32& OutX, f32& OutY)
+{
+    if (x * x + y * y < 1e-12F) {
+        x = FallbackX;
+        y = FallbackY;
+    }
+    const f32 length = Math::sqrt(x * x + y * y);
+    OutX = length > 0.F ? x / length : 0.F;
+    OutY = length > 0.F ? y / length : 0.F;
+}
+
+void MsdfShape::MoveTo(f32 x, f32 y)
+{
+    Close();
+    contours.PushBack({ segments.Length(), 0 });
+    PenX = StartX = x;
+    PenY = StartY = y;
+    EdgeStart = true;
+}
+
+void MsdfShape::LineTo(f32 x, f32 y)
+{
+    f32 tx, ty;
+    MsdfTangent(x - PenX, y - PenY, 0.F, 0.F, tx, ty);
+    EdgeStart = true;
+    AddSegment(x, y, tx, ty);
+    EndEdge(tx, ty);
+}
+
+void MsdfShape::QuadTo(f32 cx, f32 cy, f32 x, f32 y)
+{
+    const f32 x0 = PenX, y0 = PenY;
+    f32 sx, sy, ex, ey;
+    MsdfTangent(cx - x0, cy - y0, x - x0, y - y0, sx, sy);
+    MsdfTangent(x - cx, y - cy, x - x0, y - y0, ex, ey);
+    EdgeStart = true;
+    for (u32 i = 1; i <= MSDF_QUAD_SEGMENTS; ++i) {
+        const f32 t = (f32)i / MSDF_QUAD_SEGMENTS;
+        const f32 u = 1.F - t;
+        AddSegment(u * u * x0 + 2.F * u * t * cx + t * t * x, u * u * y0 + 2.F * u * t * cy + t * t * y, sx, sy);
+    }
+    EndEdge(ex, ey);
+}
+
+void MsdfShape::CubicTo(f32 cx0, f32 cy0, f32 cx1, f32 cy1, f32 x, f32 y)
+{
+    const f32 x0 = PenX, y0 = PenY;
+    f32 sx, sy, ex, ey;
+    MsdfTangent(cx0 - x0, cy0 - y0, cx1 - x0, cy1 - y0, sx, sy);
+    MsdfTangent(x - cx1, y - cy1, x - cx0, y - cy0, ex, ey);
+    EdgeStart = true;
+    for (u32 i = 1; i <= MSDF_CUBIC_SEGMENTS; ++i) {
+        const f32 t = (f32)i / MSDF_CUBIC_SEGMENTS;
+        const f32 u = 1.F - t;
+        AddSegment(u * u * u * x0 + 3.F * u * u * t * cx0 + 3.F * u * t * t * cx1 + t * t * t * x,
+                   u * u * u * y0 + 3.F * u * u * t * cy0 + 3.F * u * t * t * cy1 + t * t * t * y, sx, sy);
+    }
+    EndEdge(ex, ey);
+}
+
+void MsdfShape::Close()
+{
+    if (!contours.Length()) {
+        return;
+    }
+    if (PenX != StartX || PenY != StartY) {
+        LineTo(StartX, StartY);
+    }
+    auto& contour = contours[contours.Length() - 1];
+    contour.count = segments.Length() - contour.first;
+    if (!contour.count) {
+        contours.PopBack();
+    }
+}
+
+void MsdfShape::AddSegment(f32 x, f32 y, f32 tx, f32 ty)
+{
+    // Отрезки нулевой длины не дают направления и только мешают поиску углов.
+    if (x == PenX && y == PenY) {
+        return;
+    }
+    segments.PushBack({ PenX, PenY, x, y, tx, ty, MsdfColour::White, EdgeStart ? MsdfSegmentFlag::EdgeFirst : (u8)0 });
+    EdgeStart = false;
+    PenX = x;
+    PenY = y;
+}
+
+void MsdfShape::EndEdge(f32 tx, f32 ty)
+{
+    // Ребро, все отрезки которого вырождены, не добавило ничего.
+    if (EdgeStart || !segments.Length()) {
+        return;
+    }
+    auto& last = segments[segments.Length() - 1];
+    last.flags |= MsdfSegmentFlag::EdgeLast;
+    if (!(last.flags & MsdfSegmentFlag::EdgeFirst)) {
+        last.tx = tx;
+        last.ty = ty;
+    }
+}
+
+void MsdfShape::ColourEdges(f32 AngleThreshold)
+{
+    Close();
+
+    const f32 CrossThreshold = Math::sin(AngleThreshold);
+    static const u8 cycle[3] = { MsdfColour::Cyan, MsdfColour::Magenta, MsdfColour::Yellow };
+    DArray<u32> corners;
+
+    const u32 ContourCount = contours.Length();
+    for (u32 c = 0; c < ContourCount; ++c) {
+        const auto& contour = contours[c];
+        Segment* s = segments.Data() + contour.first;
+        const u32 n = contour.count;
+
+        // Угол — начало ребра, где направление контура поворачивает сильнее порога или назад.
+        corners.Clear();
+        for (u32 k = 0; k < n; ++k) {
+            if (!(s[k].flags & MsdfSegmentFlag::EdgeFirst)) {
+                continue;
+            }
+            // Конец предыдущего ребра сравнивается с началом этого по касательным, а не по хордам кривых.
+            const auto& prev = s[(k + n - 1) % n];
+            const f32 dot = prev.tx * s[k].tx + prev.ty * s[k].ty;
+            const f32 cross = prev.tx * s[k].ty - prev.ty * s[k].tx;
+            if (dot <= 0.F || Math::abs(cross) > CrossThreshold) {
+                corners.PushBack(k);
+            }
+        }
+
+        const u32 CornerCount = corners.Length();
+        if (CornerCount == 0) {
+            // Гладкий контур: все каналы совпадают, поле не отличается от обычного.
+            for (u32 k = 0; k < n; ++k) {
+                s[k].colour = MsdfColour::White;
+            }
+        } else if (CornerCount == 1) {
+            // Капля: контур делится на три части, чтобы у единственного угла встретились разные цвета.
+            static const u8 parts[3] = { MsdfColour::Magenta, MsdfColour::White, MsdfColour::Yellow };
+            for (u32 k = 0; k < n; ++k) {
+                s[(corners[0] + k) % n].colour = parts[(k * 3) / n];
+            }
+        } else {
+            // Цвет сменяется в каждом углу; последний участок не должен совпасть с первым, с которым он тоже граничит.
+            u32 ci = 0;
+            u32 corner = 0;
+            for (u32 k = 0; k < n; ++k) {
+                const u32 index = (corners[0] + k) % n;
+                if (k > 0 && corner + 1 < CornerCount && index == corners[corner + 1]) {
+                    corner++;
+                    ci = (ci + 1) % 3;
+                    if (corner == CornerCount - 1 && ci == 0) {
+                        ci = 1;
+                    }
+                }
+                s[index].colour = cycle[ci];
+            }
+        }
+    }
+
+    if (corners.Data()) {
+        corners.Destroy();
+    }
+}
+
+void MsdfShape::Generate(u8 *OutPixels, u32 width, u32 height, u32 stride, f32 range, f32 left, f32 top) const
+{
+    const Segment* s = segments.Data();
+    const u32 count = segments.Length();
+
+    for (u32 j = 0; j < height; ++j) {
+        const f32 py = top - (f32)j - 0.5F;
+        u8* row = OutPixels + (u64)j * stride * 4;
+        for (u32 i = 0; i < width; ++i) {
+            const f32 px = left + (f32)i + 0.5F;
+
+            // Для каждого канала — ближайший отрезок его цвета; при равных расстояниях тот, к которому точка ближе к перпендикуляру.
+            f32 BestDistance[3] = {};
+            f32 BestOrthogonality[3] = {};
+            f32 BestT[3] = {};
+            u32 BestSegment[3] = { INVALID::ID, INVALID::ID, INVALID::ID };
+            i32 winding = 0;
+
+            for (u32 k = 0; k < count; ++k) {
+                const auto& seg = s[k];
+                const f32 abx = seg.bx - seg.ax, aby = seg.by - seg.ay;
+                const f32 apx = px - seg.ax, apy = py - seg.ay;
+                const f32 length2 = abx * abx + aby * aby;
+
+                // Знак определяется числом оборотов контура вокруг точки, поэтому направление обхода контуров шрифта не важно.
+                if ((seg.ay <= py) != (seg.by <= py)) {
+                    const f32 x = seg.ax + (py - seg.ay) * abx / aby;
+                    if (x > px) {
+                        winding += seg.by > seg.ay ? 1 : -1;
+                    }
+                }
+
+                const f32 t = (apx * abx + apy * aby) / length2;
+                const f32 tc = MCLAMP(t, 0.F, 1.F);
+                const f32 dx = apx - abx * tc, dy = apy - aby * tc;
+                const f32 distance = dx * dx + dy * dy;
+                const f32 orthogonality = (t > 0.F && t < 1.F) || distance <= 0.F
+                    ? 1.F : Math::abs(abx * dy - aby * dx) / Math::sqrt(length2 * distance);
+
+                for (u32 c = 0; c < 3; ++c) {
+                    if (!(seg.colour & (1 << c))) {
+                        continue;
+                    }
+                    const f32 epsilon = 1e-5F * (1.F + BestDistance[c]);
+                    if (BestSegment[c] == INVALID::ID || distance < BestDistance[c] - epsilon ||
+                        (distance <= BestDistance[c] + epsilon && orthogonality > BestOrthogonality[c])) {
+                        BestDistance[c] = distance;
+                        BestOrthogonality[c] = orthogonality;
+                        BestT[c] = t;
+                        BestSegment[c] = k;
+                    }
+                }
+            }
+
+            f32 value[3];
+            for (u32 c = 0; c < 3; ++c) {
+                if (BestSegment[c] == INVALID::ID) {
+                    value[c] = 0.F;
+                    continue;
+                }
+                const auto& seg = s[BestSegment[c]];
+                const f32 abx = seg.bx - seg.ax, aby = seg.by - seg.ay;
+                const f32 cross = abx * (py - seg.ay) - aby * (px - seg.ax);
+                f32 distance = (cross >= 0.F ? 1.F : -1.F) * Math::sqrt(BestDistance[c]);
+
+                // За концами ребра берется псевдорасстояние до продолжения его касательной: так два цвета угла
+                // пересекаются ровно в вершине и медиана сохраняет угол острым.
+                const f32 tx = seg.tx, ty = seg.ty;
+                if (BestT[c] < 0.F && (seg.flags & MsdfSegmentFlag::EdgeFirst)) {
+                    const f32 apx = px - seg.ax, apy = py - seg.ay;
+                    if (apx * tx + apy * ty < 0.F) {
+                        const f32 pseudo = tx * apy - ty * apx;
+                        if (Math::abs(pseudo) <= Math::abs(distance)) {
+                            distance = pseudo;
+                        }
+                    }
+                } else if (BestT[c] > 1.F && (seg.flags & MsdfSegmentFlag::EdgeLast)) {
+                    const f32 bpx = px - seg.bx, bpy = py - seg.by;
+                    if (bpx * tx + bpy * ty > 0.F) {
+                        const f32 pseudo = tx * bpy - ty * bpx;
+                        if (Math::abs(pseudo) <= Math::abs(distance)) {
+                            distance = pseudo;
+                        }
+                    }
+                }
+                value[c] = distance / range + 0.5F;
+            }
+
+            // Медиана должна давать ту же сторону, что и число оборотов; иначе знак поля обращается во всех каналах.
+            const f32 median = MMAX(MMIN(value[0], value[1]), MMIN(MMAX(value[0], value[1]), value[2]));
+            const bool inside = winding != 0;
+            if ((median > 0.5F) != inside && median != 0.5F) {
+                for (u32 c = 0; c < 3; ++c) {
+                    value[c] = 1.F - value[c];
+                }
+            }
+
+            u8* pixel = row + i * 4;
+            for (u32 c = 0; c < 3; ++c) {
+                pixel[c] = (u8)(MCLAMP(value[c], 0.F, 1.F) * 255.F + 0.5F);
+            }
+            pixel[3] = 255;
+        }
+    }
+}
+
+void MsdfShape::Clear()
+{
+    segments.Clear();
+    contours.Clear();
+    PenX = PenY = StartX = StartY = 0.F;
+    EdgeStart = true;
+}
+
+void MsdfShape::Destroy()
+{
+    if (segments.Data()) {
+        segments.Destroy();
+    }
+    if (contours.Data()) {
+        contours.Destroy();
+    }
+}
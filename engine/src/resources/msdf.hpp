@@ -0,0 +1,66 @@
+/// @file msdf.hpp
+/// @brief Многоканальное поле расстояний (MSDF) контура глифа. Ребра контура раскрашиваются так, чтобы в углах
+/// соседние ребра не делили ни одного канала; медиана трех каналов восстанавливает острые углы при любом масштабе.
+#pragma once
+
+#include "containers/darray.h"
+
+constexpr u16 FONT_MSDF_SIZE = 32;      // Кегль, в котором запекается атлас MSDF и заданы метрики его глифов.
+constexpr f32 FONT_MSDF_RANGE = 4.F;    // Ширина поля в пикселях атласа; совпадает с PX_RANGE шейдера Shader.Builtin.UI.Msdf.
+
+class MAPI MsdfShape
+{
+    /// @brief Отрезок ломаной, приближающей ребро контура. Кривые разбиваются на отрезки, цвет у них общий с ребром.
+    struct Segment {
+        f32 ax, ay;
+        f32 bx, by;
+        f32 tx, ty;     // Единичная касательная ребра в начале первого отрезка ребра или в конце последнего.
+        u8 colour;      // Каналы поля, в которых участвует отрезок: биты R, G, B.
+        u8 flags;       // Первый и последний отрезки ребра продолжают его касательную за концы.
+    };
+
+    /// @brief Контур: непрерывная замкнутая последовательность отрезков.
+    struct Contour {
+        u32 first;
+        u32 count;
+    };
+
+    DArray<Segment> segments;
+    DArray<Contour> contours;
+    f32 PenX, PenY;
+    f32 StartX, StartY;
+    bool EdgeStart;     // Следующий отрезок начинает новое ребро.
+public:
+    constexpr MsdfShape() : segments(), contours(), PenX(), PenY(), StartX(), StartY(), EdgeStart(true) {}
+
+    /// @brief Начинает новый контур; предыдущий замыкается.
+    void MoveTo(f32 x, f32 y);
+    void LineTo(f32 x, f32 y);
+    void QuadTo(f32 cx, f32 cy, f32 x, f32 y);
+    void CubicTo(f32 cx0, f32 cy0, f32 cx1, f32 cy1, f32 x, f32 y);
+    /// @brief Замыкает текущий контур.
+    void Close();
+
+    /// @brief Раскрашивает ребра: в углах, где направление меняется сильнее порога, цвет сменяется.
+    /// @param AngleThreshold угол в радианах, больше которого стык ребер считается углом.
+    void ColourEdges(f32 AngleThreshold = 3.F);
+
+    /// @brief Записывает поле в изображение RGBA. Ось y контура направлена вверх, строки изображения — сверху вниз.
+    /// @param OutPixels первый пиксель области изображения.
+    /// @param width ширина области в пикселях.
+    /// @param height высота области в пикселях.
+    /// @param stride ширина всего изображения в пикселях.
+    /// @param range ширина поля в пикселях: расстояние range/2 от края дает 0 или 255.
+    /// @param left координата x контура у левого края области.
+    /// @param top координата y контура у верхнего края области.
+    void Generate(u8* OutPixels, u32 width, u32 height, u32 stride, f32 range, f32 left, f32 top) const;
+
+    u32 GetSegmentCount() const { return segments.Length(); }
+    u32 GetContourCount() const { return contours.Length(); }
+
+    void Clear();
+    void Destroy();
+private:
+    void AddSegment(f32 x, f32 y, f32 tx, f32 ty);
+    void EndEdge(f32 tx, f32 ty);
+};
@@ -263,5 +263,8 @@ void ShaderConfig::Clear()
     stages.Clear();              
     StageNames.Clear();              
     StageFilenames.Clear();  
+    BindlessStageFilenames.Clear();
+    IndirectVertexFilename.Clear();
+    BindlessIndirectVertexFilename.Clear();
     flags = 0;
 }
@@ -239,9 +239,12 @@ public:
         DArray<Shader::Stage> stages;               // Сборник этапов.
         DArray<MString> StageNames;         // Коллекция сценических имен. Должно соответствовать массиву этапов.
         DArray<MString> StageFilenames;     // Коллекция имен файлов этапов, которые необходимо загрузить (по одному на этап). Должно соответствовать массиву этапов.
+        DArray<MString> BindlessStageFilenames; // Имена файлов этапов для режима без привязки (bindless), по одному на этап. Пусто, если шейдер его не поддерживает.
+        MString IndirectVertexFilename;     // Файл вершинного этапа для косвенной отрисовки с отсечением на GPU: матрицы моделей читаются из буфера экземпляров. Пусто, если шейдер ее не поддерживает.
+        MString BindlessIndirectVertexFilename; // Файл вершинного этапа косвенной отрисовки для режима без привязки. Пусто, если шейдер их не совмещает.
         Shader::FlagBits flags;             // Флаги, установленные для этого шейдера.
 
-        ShaderConfig() : name(), CullMode(FaceCullMode::Back), TopologyTypes(PrimitiveTopology::Type::TriangleList), /*AttributeCount(),*/ attributes(), /*UniformCount(),*/ uniforms(), /*StageCount(),*/ stages(), StageNames(), StageFilenames(), flags() {}
+        ShaderConfig() : name(), CullMode(FaceCullMode::Back), TopologyTypes(PrimitiveTopology::Type::TriangleList), /*AttributeCount(),*/ attributes(), /*UniformCount(),*/ uniforms(), /*StageCount(),*/ stages(), StageNames(), StageFilenames(), BindlessStageFilenames(), IndirectVertexFilename(), BindlessIndirectVertexFilename(), flags() {}
         void Clear();
         void* operator new(u64 size) { return MemorySystem::Allocate(size, Memory::Resource); }
         void operator delete(void* ptr, u64 size) { MemorySystem::Free(ptr, size, Memory::Resource); }
@@ -1,26 +1,53 @@
 #include "terrain.h"
 #include "core/identifier.h"
+#include "core/clock.h"
 #include "renderer/rendering_system.h"
 #include "systems/material_system.h"
-#include "math/geometry_utils.h"
+#include "systems/job_systems.hpp"
+
+/// @brief Задание построения чанка. Дерево передается указателем: оно переживает ландшафт, пока задания не завершатся.
+struct TerrainChunkJobParams {
+    TerrainChunkTree* tree;
+    u32 index;
+};
+
+struct TerrainChunkJobResult {
+    TerrainChunkTree* tree;
+    u32 index;
+    TerrainVertex* vertices;
+    u32* indices;
+};
+
+static u32 AddChunk(TerrainChunkTree& tree, u32& next, u8 level, u32 x, u32 z);
+static bool UploadChunk(TerrainChunkTree& tree, u32 index, const TerrainVertex* vertices, const u32* indices);
+static void DestroyTree(TerrainChunkTree* tree);
+static void ChunkWorldBounds(const TerrainChunk& chunk, const Matrix4D& model, FVec3& OutCenter, FVec3& OutHalfExtents);
+static bool ChunkJobStart(void* ParamData, void* ResultData);
+static void ChunkJobSuccess(void* ResultData);
+static void ChunkJobFail(void* ResultData);
 
 bool Terrain::Create(Config &config)
 {
     name = config.name;
 
-    if (!config.TileCountX) {
-        MERROR("Количество плиток x не может быть меньше единицы.");
+    if (config.TileCountX < 2) {
+        MERROR("Количество выборок карты высот по x не может быть меньше двух.");
         return false;
     }
 
-    if (!config.TileCountZ) {
-        MERROR("Количество плиток z не может быть меньше единицы.");
+    if (config.TileCountZ < 2) {
+        MERROR("Количество выборок карты высот по z не может быть меньше двух.");
+        return false;
+    }
+
+    if (config.VertexDatas.Length() < config.TileCountX * config.TileCountZ) {
+        MERROR("Карта высот ландшафта '%s' содержит %u выборок вместо %u.", name.c_str(), config.VertexDatas.Length(), config.TileCountX * config.TileCountZ);
         return false;
     }
 
     xform = config.xform;
 
-    // ЗАДАЧА: рассчитать на основе фактических размеров местности.
+    // Рассчитываются в Initialize по карте высот.
     extents = Extents3D();
     origin = FVec3();
 
@@ -31,16 +58,13 @@ bool Terrain::Create(Config &config)
 
     ScaleY = config.ScaleY;
 
-    VertexCount = TileCountX * TileCountZ;
-    vertices = reinterpret_cast<TerrainVertex*>(MemorySystem::Allocate(sizeof(TerrainVertex) * VertexCount, Memory::Array));
-
-    VertexDataLength = VertexCount;
-    // VertexDatas = reinterpret_cast<TerrainVertexData*>(MemorySystem::Allocate(sizeof(TerrainVertexData) * VertexDataLength, Memory::Array));
-    // MemorySystem::CopyMem(VertexDatas, config.VertexDatas, config.VertexDataLength * sizeof(TerrainVertexData));
-    VertexDatas = config.VertexDatas.MovePtr();
-
-    IndexCount = VertexCount * 6;
-    indices = reinterpret_cast<u32*>(MemorySystem::Allocate(sizeof(u32) * IndexCount, Memory::Array));
+    tree = reinterpret_cast<TerrainChunkTree*>(MemorySystem::Allocate(sizeof(TerrainChunkTree), Memory::Array, true));
+    tree->width = TileCountX;
+    tree->depth = TileCountZ;
+    tree->TileScaleX = TileScaleX;
+    tree->TileScaleZ = TileScaleZ;
+    tree->ScaleY = ScaleY;
+    tree->heights = config.VertexDatas.MovePtr();
 
     MaterialCount = config.MaterialCount;
     if (MaterialCount) {
@@ -50,142 +74,542 @@ bool Terrain::Create(Config &config)
         MaterialNames = nullptr;
     }
 
-    // Сделать геометрию недействительной.
-    geo.id = INVALID::ID;
-    geo.InternalID = INVALID::ID;
-    geo.generation = INVALID::U16ID;
-
     return true;
 }
 
 void Terrain::Destroy()
 {
-    // ЗАДАЧА: Заполните меня!
-
     // ЗАДАЧА: возможно нужно убрать
     if (name) {
         name.Clear();
     }
 
-    if (vertices) {
-        MemorySystem::Free(vertices, sizeof(TerrainVertex) * VertexCount, Memory::Array);
-        vertices = nullptr;
-    }
-
-    if (indices) {
-        MemorySystem::Free(indices, sizeof(u32) * IndexCount, Memory::Array);
-        indices = nullptr;
-    }
-
     if (MaterialNames) {
         MemorySystem::Free(MaterialNames, sizeof(char*) * MaterialCount, Memory::Array);
         MaterialNames = nullptr;
     }
 
-    if (VertexDatas) {
-        MemorySystem::Free(VertexDatas, sizeof(TerrainVertexData) * VertexDataLength, Memory::Array);
-        VertexDatas = nullptr;
+    if (tree) {
+        // Задания, которые еще строят чанки, освободят дерево сами.
+        tree->released = true;
+        if (!tree->PendingCount) {
+            DestroyTree(tree);
+        }
+        tree = nullptr;
+    }
+
+    if (SelectedChunks.Data()) {
+        SelectedChunks.Destroy();
+    }
+    if (MissingChunks.Data()) {
+        MissingChunks.Destroy();
     }
 
-    // ПРИМЕЧАНИЕ: Не просто обнуляйте память, потому что некоторые структуры, такие как геометрия, должны иметь недействительные идентификаторы.
-    IndexCount = VertexCount = 0;
     ScaleY = TileScaleX = TileScaleZ = 0;
-    TileCountX = TileCountZ = VertexDataLength = 0;
+    TileCountX = TileCountZ = 0;
     origin = FVec3();
     extents = Extents3D();
 }
 
 bool Terrain::Initialize()
 {
-    // Генерировать вершины.
-    for (u32 z = 0, i = 0; z < TileCountZ; z++) {
-        for (u32 x = 0; x < TileCountX; ++x, ++i) {
-            auto& v = vertices[i];
-            v.position.x = x * TileScaleX;
-            v.position.z = z * TileScaleZ;
-            v.position.y = VertexDatas[i].height * ScaleY;
-
-            v.colour = FVec4::One();    // белый;
-            v.normal = FVec3(0, 1, 0);  // ЗАДАЧА: рассчитать на основе геометрии.
-            v.texcoord.x = (f32)x;
-            v.texcoord.y = (f32)z;
-
-            // ПРИМЕЧАНИЕ: Назначение весов по умолчанию на основе общей высоты. Более низкие индексы ниже по высоте.
-            v.MaterialWeights[0] = Math::Smoothstep(0.00F, 0.25F, VertexDatas[i].height);
-            v.MaterialWeights[1] = Math::Smoothstep(0.25F, 0.50F, VertexDatas[i].height);
-            v.MaterialWeights[2] = Math::Smoothstep(0.50F, 0.75F, VertexDatas[i].height);
-            v.MaterialWeights[3] = Math::Smoothstep(0.75F, 1.00F, VertexDatas[i].height);
+    Clock clock;
+    clock.Start();
+
+    // Корень покрывает всю карту высот не более чем TERRAIN_CHUNK_SIZE плитками по стороне.
+    const u32 span = MMAX(tree->width, tree->depth) - 1;
+    u8 level = 0;
+    while ((TERRAIN_CHUNK_SIZE << level) < span) {
+        level++;
+    }
+    tree->LevelCount = level + 1;
+
+    // Первый проход только считает чанки, второй заполняет их.
+    u32 count = 0;
+    AddChunk(*tree, count, level, 0, 0);
+    tree->chunks = reinterpret_cast<TerrainChunk*>(MemorySystem::Allocate(sizeof(TerrainChunk) * count, Memory::Array, true));
+    tree->ChunkCount = count;
+    count = 0;
+    AddChunk(*tree, count, level, 0, 0);
+
+    extents = tree->chunks[0].extents;
+    origin = (extents.min + extents.max) * 0.5F;
+
+    // Юбка опускается на перепад высот чанка: щель между краями соседей разных уровней не глубже него.
+    for (u32 i = 0; i < tree->ChunkCount; ++i) {
+        auto& chunk = tree->chunks[i];
+        chunk.SkirtDepth = chunk.extents.max.y - chunk.extents.min.y + MMIN(TileScaleX, TileScaleZ);
+        chunk.extents.min.y -= chunk.SkirtDepth;
+    }
+
+    clock.Update();
+    MINFO("Ландшафт '%s': карта высот %ux%u, чанков %u, уровней %u; дерево построено за %.2f мс.",
+        name.c_str(), tree->width, tree->depth, tree->ChunkCount, tree->LevelCount, clock.elapsed * 1000.0);
+
+    return true;
+}
+
+bool Terrain::Load()
+{
+    UniqueID = Identifier::AquireNewID(this);
+
+    // Создайте материал ландшафта, скопировав свойства этих материалов в новый материал ландшафта.
+    char TerrainMaterialName[MATERIAL_NAME_MAX_LENGTH]{};
+    MString::Format(TerrainMaterialName, "terrain_mat_%s", name.c_str());
+    tree->material = MaterialSystem::Acquire(TerrainMaterialName, MaterialCount, (const char **)MaterialNames, true);
+    if (!tree->material) {
+        MWARN("Не удалось получить материал ландшафта. Вместо этого используется материал по умолчанию.");
+        tree->material = MaterialSystem::GetDefaultTerrainMaterial();
+    }
+
+    // Корень строится сразу и не выгружается: им рисуется ландшафт, пока подробные чанки строятся.
+    const auto& root = tree->chunks[0];
+    auto vertices = reinterpret_cast<TerrainVertex*>(MemorySystem::Allocate(sizeof(TerrainVertex) * ChunkVertexCount(root), Memory::Array));
+    auto indices = reinterpret_cast<u32*>(MemorySystem::Allocate(sizeof(u32) * ChunkIndexCount(root), Memory::Array));
+    BuildChunk(*tree, 0, vertices, indices);
+    const bool result = UploadChunk(*tree, 0, vertices, indices);
+    if (!result) {
+        MERROR("Не удалось загрузить корневой чанк ландшафта '%s'.", name.c_str());
+    }
+    MemorySystem::Free(vertices, sizeof(TerrainVertex) * ChunkVertexCount(root), Memory::Array);
+    MemorySystem::Free(indices, sizeof(u32) * ChunkIndexCount(root), Memory::Array);
+
+    return result;
+}
+
+bool Terrain::Unload()
+{
+    for (u32 i = 0; i < tree->ChunkCount; ++i) {
+        if (tree->chunks[i].state == TerrainChunkState::Resident) {
+            UnloadChunk(i);
+        }
+    }
+
+    // Чанки, которые еще строятся, будут отброшены по завершении.
+    if (tree->material) {
+        MaterialSystem::Release(tree->material->name);
+        tree->material = nullptr;
+    }
+
+    UniqueID = 0;
+
+    return true;
+}
+
+bool Terrain::Update()
+{
+    return true;
+}
+
+u32 Terrain::SelectChunks(Frustum &f, const FVec3 &CameraPosition, u64 frame, DArray<u32> &OutSelected, DArray<u32> &OutMissing)
+{
+    u32 triangles = 0;
+    if (!tree->chunks || tree->chunks[0].state != TerrainChunkState::Resident) {
+        return triangles;
+    }
+
+    const auto model = xform.GetWorld();
+    FVec3 center, HalfExtents;
+    ChunkWorldBounds(tree->chunks[0], model, center, HalfExtents);
+    if (f.IntersectsAABB(center, HalfExtents)) {
+        SelectChunk(0, f, CameraPosition, model, frame, OutSelected, OutMissing, triangles);
+    }
+    return triangles;
+}
+
+u32 Terrain::PopulateGeometries(Frustum &f, const FVec3 &CameraPosition, u64 frame, DArray<GeometryRenderData> &OutGeometries)
+{
+    SelectedChunks.Clear();
+    MissingChunks.Clear();
+    const u32 triangles = SelectChunks(f, CameraPosition, frame, SelectedChunks, MissingChunks);
+
+    // Недостающие чанки строятся в потоках заданий; при превышении бюджета место освобождают чанки,
+    // не пройденные выбором в этом кадре.
+    const u32 MissingCount = MMIN(MissingChunks.Length(), TERRAIN_MAX_CHUNK_JOBS_PER_FRAME);
+    for (u32 i = 0; i < MissingCount; ++i) {
+        while (tree->ResidentCount + tree->PendingCount >= TERRAIN_MAX_RESIDENT_CHUNKS) {
+            u32 oldest = INVALID::ID;
+            for (u32 j = 1; j < tree->ChunkCount; ++j) {
+                const auto& chunk = tree->chunks[j];
+                if (chunk.state == TerrainChunkState::Resident && chunk.LastUsed < frame &&
+                    (oldest == INVALID::ID || chunk.LastUsed < tree->chunks[oldest].LastUsed)) {
+                    oldest = j;
+                }
+            }
+            if (oldest == INVALID::ID) {
+                break;
+            }
+            UnloadChunk(oldest);
+        }
+        if (tree->ResidentCount + tree->PendingCount >= TERRAIN_MAX_RESIDENT_CHUNKS) {
+            break;
+        }
+
+        TerrainChunkJobParams params { tree, MissingChunks[i] };
+        tree->chunks[params.index].state = TerrainChunkState::Pending;
+        tree->PendingCount++;
+        Job::Info job { ChunkJobStart, ChunkJobSuccess, ChunkJobFail, &params, sizeof(params), sizeof(TerrainChunkJobResult) };
+        JobSystem::Submit(job);
+    }
+
+    const auto model = xform.GetWorld();
+    const u32 SelectedCount = SelectedChunks.Length();
+    for (u32 i = 0; i < SelectedCount; ++i) {
+        GeometryRenderData data = {};
+        data.model = model;
+        data.geometry = &tree->chunks[SelectedChunks[i]].geo;
+        data.UniqueID = UniqueID;
+        OutGeometries.PushBack(data);
+    }
+
+    return triangles;
+}
+
+/// @brief Высота выборки карты высот.
+static MINLINE f32 SampleHeight(const TerrainChunkTree& tree, u32 x, u32 z)
+{
+    return tree.heights[z * tree.width + x].height;
+}
+
+/// @brief Вершина сетки в выборке (x, z). Нормаль и касательная берутся из разностей высот соседних выборок с шагом уровня,
+/// поэтому совпадают на общих краях соседних чанков одного уровня.
+static void BuildVertex(const TerrainChunkTree& tree, u32 x, u32 z, u32 step, TerrainVertex& v)
+{
+    const f32 height = SampleHeight(tree, x, z);
+    v.position = FVec3(x * tree.TileScaleX, height * tree.ScaleY, z * tree.TileScaleZ);
+
+    const u32 x0 = x >= step ? x - step : 0;
+    const u32 x1 = MMIN(x + step, tree.width - 1);
+    const u32 z0 = z >= step ? z - step : 0;
+    const u32 z1 = MMIN(z + step, tree.depth - 1);
+    const f32 dx = (SampleHeight(tree, x1, z) - SampleHeight(tree, x0, z)) * tree.ScaleY / ((x1 - x0) * tree.TileScaleX);
+    const f32 dz = (SampleHeight(tree, x, z1) - SampleHeight(tree, x, z0)) * tree.ScaleY / ((z1 - z0) * tree.TileScaleZ);
+    v.normal = Normalize(FVec3(-dx, 1.F, -dz));
+    v.tangent = FVec4(Normalize(FVec3(1.F, dx, 0.F)), 0.F);
+
+    v.colour = FVec4::One();    // белый;
+    v.texcoord.x = (f32)x;
+    v.texcoord.y = (f32)z;
+
+    // ПРИМЕЧАНИЕ: Назначение весов по умолчанию на основе общей высоты. Более низкие индексы ниже по высоте.
+    v.MaterialWeights[0] = Math::Smoothstep(0.00F, 0.25F, height);
+    v.MaterialWeights[1] = Math::Smoothstep(0.25F, 0.50F, height);
+    v.MaterialWeights[2] = Math::Smoothstep(0.50F, 0.75F, height);
+    v.MaterialWeights[3] = Math::Smoothstep(0.75F, 1.00F, height);
+}
+
+/// @brief Два треугольника юбки между краем a-b и его опущенной копией sa-sb, лицевой стороной наружу.
+/// @param flip край обходится так, что наружная сторона оказывается слева.
+static MINLINE u32* AddSkirtQuad(u32* out, u32 a, u32 b, u32 sa, u32 sb, bool flip)
+{
+    if (flip) {
+        out[0] = b; out[1] = a;  out[2] = sa;
+        out[3] = b; out[4] = sa; out[5] = sb;
+    } else {
+        out[0] = a; out[1] = b;  out[2] = sa;
+        out[3] = b; out[4] = sb; out[5] = sa;
+    }
+    return out + 6;
+}
+
+void Terrain::BuildChunk(const TerrainChunkTree &tree, u32 index, TerrainVertex *OutVertices, u32 *OutIndices)
+{
+    const auto& chunk = tree.chunks[index];
+    const u32 step = 1u << chunk.level;
+    const u32 CountX = chunk.CountX;
+    const u32 CountZ = chunk.CountZ;
+
+    // Генерировать вершины. Последняя выборка прижимается к краю карты высот.
+    for (u32 j = 0, i = 0; j < CountZ; ++j) {
+        const u32 z = MMIN(chunk.z + j * step, tree.depth - 1);
+        for (u32 k = 0; k < CountX; ++k, ++i) {
+            BuildVertex(tree, MMIN(chunk.x + k * step, tree.width - 1), z, step, OutVertices[i]);
         }
     }
 
+    // Юбка: копии краевых вершин, опущенные на SkirtDepth. Порядок — нижний, верхний, левый, правый края.
+    const u32 bottom = CountX * CountZ;
+    const u32 top = bottom + CountX;
+    const u32 left = top + CountX;
+    const u32 right = left + CountZ;
+    for (u32 k = 0; k < CountX; ++k) {
+        OutVertices[bottom + k] = OutVertices[k];
+        OutVertices[top + k] = OutVertices[(CountZ - 1) * CountX + k];
+    }
+    for (u32 j = 0; j < CountZ; ++j) {
+        OutVertices[left + j] = OutVertices[j * CountX];
+        OutVertices[right + j] = OutVertices[j * CountX + CountX - 1];
+    }
+    for (u32 i = bottom; i < right + CountZ; ++i) {
+        OutVertices[i].position.y -= chunk.SkirtDepth;
+    }
+
     // Генерация индексов.
-    for (u32 z = 0, i = 0; z < TileCountZ - 1; z++) {
-        for (u32 x = 0; x < TileCountX - 1; ++x, i += 6) {
-            u32 v0 = (z * TileCountX) + x;
-            u32 v1 = (z * TileCountX) + x + 1;
-            u32 v2 = ((z + 1) * TileCountX) + x;
-            u32 v3 = ((z + 1) * TileCountX) + x + 1;
+    u32* out = OutIndices;
+    for (u32 j = 0; j < CountZ - 1; ++j) {
+        for (u32 k = 0; k < CountX - 1; ++k, out += 6) {
+            u32 v0 = (j * CountX) + k;
+            u32 v1 = (j * CountX) + k + 1;
+            u32 v2 = ((j + 1) * CountX) + k;
+            u32 v3 = ((j + 1) * CountX) + k + 1;
 
             // v0, v1, v2, v2, v1, v3
-            indices[i + 0] = v2;
-            indices[i + 1] = v1;
-            indices[i + 2] = v0;
-            indices[i + 3] = v3;
-            indices[i + 4] = v1;
-            indices[i + 5] = v2;
+            out[0] = v2;
+            out[1] = v1;
+            out[2] = v0;
+            out[3] = v3;
+            out[4] = v1;
+            out[5] = v2;
         }
     }
+    for (u32 k = 0; k < CountX - 1; ++k) {
+        out = AddSkirtQuad(out, k, k + 1, bottom + k, bottom + k + 1, false);
+        out = AddSkirtQuad(out, (CountZ - 1) * CountX + k, (CountZ - 1) * CountX + k + 1, top + k, top + k + 1, true);
+    }
+    for (u32 j = 0; j < CountZ - 1; ++j) {
+        out = AddSkirtQuad(out, j * CountX, (j + 1) * CountX, left + j, left + j + 1, true);
+        out = AddSkirtQuad(out, j * CountX + CountX - 1, (j + 1) * CountX + CountX - 1, right + j, right + j + 1, false);
+    }
+}
 
-    Math::Geometry::GenerateTerrainNormals(VertexCount, vertices, IndexCount, indices);
-    Math::Geometry::GenerateTerrainTangents(VertexCount, vertices, IndexCount, indices);
+/// @brief Центр и половина размеров AABB чанка в мировых координатах, как у сеток сцены.
+static void ChunkWorldBounds(const TerrainChunk& chunk, const Matrix4D& model, FVec3& OutCenter, FVec3& OutHalfExtents)
+{
+    const auto ExtentsMax = chunk.extents.max * model;
+    OutCenter = ((chunk.extents.min + chunk.extents.max) * 0.5F) * model;
+    OutHalfExtents = FVec3(
+        Math::abs(ExtentsMax.x - OutCenter.x),
+        Math::abs(ExtentsMax.y - OutCenter.y),
+        Math::abs(ExtentsMax.z - OutCenter.z)
+    );
+}
 
-    return true;
+void Terrain::SelectChunk(u32 index, Frustum &f, const FVec3 &CameraPosition, const Matrix4D &model, u64 frame, DArray<u32> &OutSelected, DArray<u32> &OutMissing, u32 &OutTriangles)
+{
+    auto& chunk = tree->chunks[index];
+    chunk.LastUsed = frame;
+
+    // Расстояние от камеры до AABB чанка.
+    FVec3 center, HalfExtents;
+    ChunkWorldBounds(chunk, model, center, HalfExtents);
+    const f32 dx = MMAX(Math::abs(CameraPosition.x - center.x) - HalfExtents.x, 0.F);
+    const f32 dy = MMAX(Math::abs(CameraPosition.y - center.y) - HalfExtents.y, 0.F);
+    const f32 dz = MMAX(Math::abs(CameraPosition.z - center.z) - HalfExtents.z, 0.F);
+    const f32 distance = Math::sqrt(dx * dx + dy * dy + dz * dz);
+    const f32 size = 2.F * MMAX(HalfExtents.x, HalfExtents.z);
+
+    bool refine = chunk.level > 0 && distance < TERRAIN_LOD_DISTANCE_FACTOR * size;
+
+    // Чанк делится, только если все его видимые дочерние чанки загружены; иначе он рисуется сам, а недостающие запрашиваются.
+    bool visible[4] {};
+    bool ready = true;
+    for (u32 c = 0; c < 4 && refine; ++c) {
+        const u32 child = chunk.children[c];
+        if (child == INVALID::ID) {
+            continue;
+        }
+        const auto& ChildChunk = tree->chunks[child];
+        FVec3 ChildCenter, ChildHalfExtents;
+        ChunkWorldBounds(ChildChunk, model, ChildCenter, ChildHalfExtents);
+        visible[c] = f.IntersectsAABB(ChildCenter, ChildHalfExtents);
+        if (visible[c] && ChildChunk.state != TerrainChunkState::Resident) {
+            if (ChildChunk.state == TerrainChunkState::Unloaded) {
+                OutMissing.PushBack(child);
+            }
+            ready = false;
+        }
+    }
+    refine = refine && ready;
+
+    if (!refine) {
+        OutSelected.PushBack(index);
+        OutTriangles += ChunkIndexCount(chunk) / 3;
+        return;
+    }
+
+    for (u32 c = 0; c < 4; ++c) {
+        if (visible[c]) {
+            SelectChunk(chunk.children[c], f, CameraPosition, model, frame, OutSelected, OutMissing, OutTriangles);
+        }
+    }
 }
 
-bool Terrain::Load()
+void Terrain::UnloadChunk(u32 index)
 {
-    UniqueID = Identifier::AquireNewID(this);
+    auto& chunk = tree->chunks[index];
+    // Рендерер освобождает буферы чанка после завершения кадров в полете, поэтому выгрузка посреди построения
+    // пакетов представлений не ждет простоя GPU.
+    RenderingSystem::Unload(&chunk.geo);
+    chunk.geo.InternalID = INVALID::ID;
+    chunk.geo.generation = INVALID::U16ID;
+    chunk.geo.material = nullptr;
+    chunk.state = TerrainChunkState::Unloaded;
+    tree->ResidentCount--;
+}
 
-    // Отправьте геометрию в рендерер для загрузки в графический процессор.
-    if (!RenderingSystem::CreateGeometry(&geo, sizeof(TerrainVertex), VertexCount, vertices, sizeof(u32), IndexCount, indices)) {
-        return false;
+/// @brief Добавляет чанк и его дочерние чанки. Без массива чанков только считает их.
+/// @return индекс добавленного чанка.
+static u32 AddChunk(TerrainChunkTree &tree, u32 &next, u8 level, u32 x, u32 z)
+{
+    const u32 index = next++;
+    const u32 step = 1u << level;
+
+    u32 children[4] { INVALID::ID, INVALID::ID, INVALID::ID, INVALID::ID };
+    if (level > 0) {
+        const u32 ChildSpan = TERRAIN_CHUNK_SIZE << (level - 1);
+        for (u32 c = 0; c < 4; ++c) {
+            const u32 cx = x + (c & 1) * ChildSpan;
+            const u32 cz = z + (c >> 1) * ChildSpan;
+            if (cx < tree.width - 1 && cz < tree.depth - 1) {
+                children[c] = AddChunk(tree, next, level - 1, cx, cz);
+            }
+        }
+    }
+
+    if (!tree.chunks) {
+        return index;
     }
 
-    // Отправляем геометрию в рендерер для загрузки в графический процессор.
-    if (!RenderingSystem::Load(&geo)) {
+    auto& chunk = tree.chunks[index];
+    chunk.x = x;
+    chunk.z = z;
+    chunk.level = level;
+    chunk.CountX = MMIN(TERRAIN_CHUNK_SIZE, (tree.width - 1 - x + step - 1) / step) + 1;
+    chunk.CountZ = MMIN(TERRAIN_CHUNK_SIZE, (tree.depth - 1 - z + step - 1) / step) + 1;
+    chunk.state = TerrainChunkState::Unloaded;
+    chunk.LastUsed = 0;
+    chunk.geo.id = index;
+    chunk.geo.InternalID = INVALID::ID;
+    chunk.geo.generation = INVALID::U16ID;
+
+    // Границы нижнего уровня берутся из всех выборок чанка, верхних — из дочерних чанков: грубая сетка не выходит за них.
+    if (level == 0) {
+        const u32 EndX = MMIN(x + TERRAIN_CHUNK_SIZE, tree.width - 1);
+        const u32 EndZ = MMIN(z + TERRAIN_CHUNK_SIZE, tree.depth - 1);
+        f32 MinHeight = M_INFINITY, MaxHeight = -M_INFINITY;
+        for (u32 sz = z; sz <= EndZ; ++sz) {
+            for (u32 sx = x; sx <= EndX; ++sx) {
+                const f32 height = SampleHeight(tree, sx, sz);
+                MinHeight = MMIN(MinHeight, height);
+                MaxHeight = MMAX(MaxHeight, height);
+            }
+        }
+        chunk.extents.min = FVec3(x * tree.TileScaleX, MinHeight * tree.ScaleY, z * tree.TileScaleZ);
+        chunk.extents.max = FVec3(EndX * tree.TileScaleX, MaxHeight * tree.ScaleY, EndZ * tree.TileScaleZ);
+    } else {
+        chunk.extents.min = FVec3(M_INFINITY, M_INFINITY, M_INFINITY);
+        chunk.extents.max = FVec3(-M_INFINITY, -M_INFINITY, -M_INFINITY);
+        for (u32 c = 0; c < 4; ++c) {
+            if (children[c] == INVALID::ID) {
+                continue;
+            }
+            const auto& ChildExtents = tree.chunks[children[c]].extents;
+            chunk.extents.min = FVec3(MMIN(chunk.extents.min.x, ChildExtents.min.x), MMIN(chunk.extents.min.y, ChildExtents.min.y), MMIN(chunk.extents.min.z, ChildExtents.min.z));
+            chunk.extents.max = FVec3(MMAX(chunk.extents.max.x, ChildExtents.max.x), MMAX(chunk.extents.max.y, ChildExtents.max.y), MMAX(chunk.extents.max.z, ChildExtents.max.z));
+        }
+    }
+    for (u32 c = 0; c < 4; ++c) {
+        chunk.children[c] = children[c];
+    }
+
+    return index;
+}
+
+/// @brief Загружает построенный чанк в графический процессор.
+/// @return true в случае успеха; в противном случае false.
+static bool UploadChunk(TerrainChunkTree &tree, u32 index, const TerrainVertex *vertices, const u32 *indices)
+{
+    auto& chunk = tree.chunks[index];
+    auto& geo = chunk.geo;
+
+    // Отправьте геометрию в рендерер для загрузки в графический процессор.
+    if (!RenderingSystem::CreateGeometry(&geo, sizeof(TerrainVertex), Terrain::ChunkVertexCount(chunk), vertices, sizeof(u32), Terrain::ChunkIndexCount(chunk), indices) ||
+        !RenderingSystem::Load(&geo)) {
+        chunk.state = TerrainChunkState::Unloaded;
         return false;
     }
 
+    // Копия данных на CPU после загрузки не нужна: чанк перестраивается из карты высот.
+    MemorySystem::Free(geo.vertices, geo.VertexElementSize * geo.VertexCount, Memory::Renderer);
+    MemorySystem::Free(geo.indices, geo.IndexElementSize * geo.IndexCount, Memory::Renderer);
+    geo.vertices = geo.indices = nullptr;
+
     // Скопируйте экстенты, центр и т. д.
-    geo.center = origin;
-    geo.extents.min = extents.min;
-    geo.extents.max = extents.max;
+    geo.center = (chunk.extents.min + chunk.extents.max) * 0.5F;
+    geo.extents = chunk.extents;
     // ЗАДАЧА: выгрузите приращения генерации на фронтенд. Также сделайте это в GeometrySystem::Create.
     geo.generation++;
+    geo.material = tree.material;
 
-    // Создайте материал ландшафта, скопировав свойства этих материалов в новый материал ландшафта.
-    char TerrainMaterialName[MATERIAL_NAME_MAX_LENGTH]{};
-    MString::Format(TerrainMaterialName, "terrain_mat_%s", name.c_str());
-    geo.material = MaterialSystem::Acquire(TerrainMaterialName, MaterialCount, (const char **)MaterialNames, true);
-    if (!geo.material) {
-        MWARN("Не удалось получить материал ландшафта. Вместо этого используется материал по умолчанию.");
-        geo.material = MaterialSystem::GetDefaultTerrainMaterial();
+    chunk.state = TerrainChunkState::Resident;
+    tree.ResidentCount++;
+    return true;
+}
+
+static void DestroyTree(TerrainChunkTree *tree)
+{
+    if (tree->heights) {
+        MemorySystem::Free(tree->heights, sizeof(TerrainVertexData) * tree->width * tree->depth, Memory::DArray);
+    }
+    if (tree->chunks) {
+        MemorySystem::Free(tree->chunks, sizeof(TerrainChunk) * tree->ChunkCount, Memory::Array);
     }
+    MemorySystem::Free(tree, sizeof(TerrainChunkTree), Memory::Array);
+}
 
+static bool ChunkJobStart(void *ParamData, void *ResultData)
+{
+    auto params = reinterpret_cast<TerrainChunkJobParams*>(ParamData);
+    auto result = reinterpret_cast<TerrainChunkJobResult*>(ResultData);
+    result->tree = params->tree;
+    result->index = params->index;
+
+    // Карта высот и дерево после Initialize только читаются, поэтому построение не мешает основному потоку.
+    const auto& chunk = params->tree->chunks[params->index];
+    result->vertices = reinterpret_cast<TerrainVertex*>(MemorySystem::Allocate(sizeof(TerrainVertex) * Terrain::ChunkVertexCount(chunk), Memory::Array));
+    result->indices = reinterpret_cast<u32*>(MemorySystem::Allocate(sizeof(u32) * Terrain::ChunkIndexCount(chunk), Memory::Array));
+    if (!result->vertices || !result->indices) {
+        return false;
+    }
+    Terrain::BuildChunk(*params->tree, params->index, result->vertices, result->indices);
     return true;
 }
 
-bool Terrain::Unload()
+/// @brief Освобождает данные построенного чанка и, если ландшафт уничтожен, дерево после последнего задания.
+static void ChunkJobFinish(TerrainChunkJobResult* result)
+{
+    auto tree = result->tree;
+    const auto& chunk = tree->chunks[result->index];
+    if (result->vertices) {
+        MemorySystem::Free(result->vertices, sizeof(TerrainVertex) * Terrain::ChunkVertexCount(chunk), Memory::Array);
+    }
+    if (result->indices) {
+        MemorySystem::Free(result->indices, sizeof(u32) * Terrain::ChunkIndexCount(chunk), Memory::Array);
+    }
+    tree->PendingCount--;
+    if (tree->released && !tree->PendingCount) {
+        DestroyTree(tree);
+    }
+}
+
+static void ChunkJobSuccess(void *ResultData)
 {
-    MaterialSystem::Release(geo.material->name);
-    RenderingSystem::Unload(&geo);
+    auto result = reinterpret_cast<TerrainChunkJobResult*>(ResultData);
+    auto tree = result->tree;
+    tree->chunks[result->index].state = TerrainChunkState::Unloaded;
 
-    UniqueID = 0;
+    // Ландшафт выгружен, пока чанк строился.
+    if (!tree->released && tree->material && !UploadChunk(*tree, result->index, result->vertices, result->indices)) {
+        MERROR("Не удалось загрузить чанк ландшафта %u.", result->index);
+    }
 
-    return true;
+    ChunkJobFinish(result);
 }
 
-bool Terrain::Update()
+static void ChunkJobFail(void *ResultData)
 {
-    return true;
+    auto result = reinterpret_cast<TerrainChunkJobResult*>(ResultData);
+    MERROR("Не удалось построить чанк ландшафта %u.", result->index);
+    result->tree->chunks[result->index].state = TerrainChunkState::Unloaded;
+    ChunkJobFinish(result);
 }
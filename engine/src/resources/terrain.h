@@ -6,6 +6,8 @@
 #include "math/vector4d_fwd.h"
 #include "math/transform.h"
 #include "geometry.h"
+#include "math/frustrum.h"
+#include "renderer/render_view.h"
 
 /*
  * Необходимо изменить структуру/функции геометрии, чтобы разрешить использование нескольких материалов.
@@ -37,6 +39,55 @@ struct TerrainVertexData {
     f32 height;
 };
 
+/// @brief Сторона чанка ландшафта в плитках. Чанк любого уровня детализации содержит не больше
+/// (TERRAIN_CHUNK_SIZE + 1)² вершин сетки: чанк уровня L берет каждую (1 << L)-ю выборку карты высот.
+constexpr u32 TERRAIN_CHUNK_SIZE = 64;
+/// @brief Чанков, одновременно загруженных в графический процессор или строящихся. Сверх этого освобождаются чанки,
+/// дольше всех не попадавшие в выбор.
+constexpr u32 TERRAIN_MAX_RESIDENT_CHUNKS = 256;
+/// @brief Заданий построения чанков, отправляемых за кадр.
+constexpr u32 TERRAIN_MAX_CHUNK_JOBS_PER_FRAME = 8;
+/// @brief Чанк делится на дочерние, пока расстояние от камеры до него меньше его стороны, умноженной на этот множитель.
+constexpr f32 TERRAIN_LOD_DISTANCE_FACTOR = 2.F;
+
+namespace TerrainChunkState {
+    enum : u8 { Unloaded, Pending, Resident };
+}
+
+/// @brief Узел дерева квадрантов ландшафта. Корень покрывает всю карту высот с самым крупным шагом,
+/// каждый уровень ниже делит узел на четыре с вдвое меньшим шагом.
+struct TerrainChunk {
+    Geometry geo;           // Геометрия чанка; загружена в графический процессор, когда state == Resident.
+    Extents3D extents;      // Границы чанка вместе с юбкой в локальных координатах ландшафта.
+    f32 SkirtDepth;         // Насколько юбка опускается под края чанка, закрывая щели между соседями разных уровней.
+    u32 x, z;               // Первая выборка карты высот.
+    u32 CountX, CountZ;     // Вершин сетки по сторонам, без юбки.
+    u32 children[4];        // Дочерние чанки; INVALID::ID, если чанк выходит за карту высот или это нижний уровень.
+    u64 LastUsed;           // Кадр, в котором выбор чанков последний раз проходил через этот чанк.
+    u8 level;               // Уровень детализации: шаг выборки 1 << level.
+    u8 state;               // TerrainChunkState.
+};
+
+/// @brief Карта высот и дерево чанков ландшафта. Задания построения чанков ссылаются на дерево, поэтому оно живет
+/// в отдельном блоке памяти и освобождается последним завершившимся заданием, если ландшафт выгружен раньше.
+struct TerrainChunkTree {
+    TerrainVertexData* heights;
+    u32 width;              // Выборок карты высот по оси x.
+    u32 depth;              // Выборок карты высот по оси z.
+    f32 TileScaleX;
+    f32 TileScaleZ;
+    f32 ScaleY;
+
+    TerrainChunk* chunks;   // Корень — первый элемент.
+    u32 ChunkCount;
+    u8 LevelCount;
+
+    u32 ResidentCount;
+    u32 PendingCount;
+    struct Material* material;
+    bool released;          // Ландшафт уничтожен; дерево освобождает последнее завершившееся задание.
+};
+
 struct Terrain {
     struct Config {
         MString name;
@@ -64,24 +115,18 @@ struct Terrain {
     f32 TileScaleZ; // Насколько велика каждая плитка по оси z.
     f32 ScaleY;     // Максимальная высота сгенерированной местности.
 
-    u32 VertexDataLength;
-    TerrainVertexData* VertexDatas;
-
     Extents3D extents;
     FVec3 origin;
 
-    u32 VertexCount;
-    TerrainVertex* vertices;
-
-    u32 IndexCount;
-    u32* indices;
-
-    Geometry geo;
+    TerrainChunkTree* tree;
 
     u32 MaterialCount;
     char** MaterialNames; // DArray<MString>?
 
-    Terrain() : name(), xform(), TileCountX(), TileCountZ(), TileScaleX(), TileScaleZ(), ScaleY(), VertexDatas(), extents(), origin(), VertexCount(), vertices(nullptr), IndexCount(), indices(nullptr), geo(), MaterialCount(), MaterialNames(nullptr) {}
+    DArray<u32> SelectedChunks;
+    DArray<u32> MissingChunks;
+
+    Terrain() : UniqueID(), name(), xform(), TileCountX(), TileCountZ(), TileScaleX(), TileScaleZ(), ScaleY(), extents(), origin(), tree(nullptr), MaterialCount(), MaterialNames(nullptr), SelectedChunks(), MissingChunks() {}
 
     MAPI bool Create(Config& config);
     MAPI void Destroy();
@@ -91,6 +136,38 @@ struct Terrain {
     MAPI bool Unload();
 
     MAPI bool Update();
+
+    /// @brief Выбирает чанки для отрисовки: отбрасывает чанки вне усеченной пирамиды и делит близкие к камере,
+    /// пока их дочерние чанки загружены. Дочерние чанки, которых не хватило, попадают в список недостающих.
+    /// @param f усеченная пирамида камеры в мировых координатах.
+    /// @param CameraPosition положение камеры в мировых координатах.
+    /// @param frame номер текущего кадра; им отмечаются пройденные чанки.
+    /// @param OutSelected индексы чанков для отрисовки; ни один из них не является предком другого.
+    /// @param OutMissing индексы незагруженных чанков, нужных для более подробного выбора.
+    /// @return количество треугольников в выбранных чанках.
+    MAPI u32 SelectChunks(Frustum& f, const FVec3& CameraPosition, u64 frame, DArray<u32>& OutSelected, DArray<u32>& OutMissing);
+
+    /// @brief Выбирает чанки, отправляет задания построения недостающих и добавляет данные отрисовки выбранных чанков.
+    /// Если загружено больше TERRAIN_MAX_RESIDENT_CHUNKS чанков, выгружает дольше всех не выбиравшиеся.
+    /// @param f усеченная пирамида камеры в мировых координатах.
+    /// @param CameraPosition положение камеры в мировых координатах.
+    /// @param frame номер текущего кадра.
+    /// @param OutGeometries массив, в который добавляются данные отрисовки.
+    /// @return количество треугольников в выбранных чанках.
+    MAPI u32 PopulateGeometries(Frustum& f, const FVec3& CameraPosition, u64 frame, DArray<GeometryRenderData>& OutGeometries);
+
+    /// @brief Строит вершины и индексы чанка вместе с юбкой. Читает только карту высот, поэтому выполняется в потоках заданий.
+    /// @param tree дерево чанков ландшафта.
+    /// @param index индекс чанка.
+    /// @param OutVertices массив не меньше ChunkVertexCount(chunk) вершин.
+    /// @param OutIndices массив не меньше ChunkIndexCount(chunk) индексов.
+    MAPI static void BuildChunk(const TerrainChunkTree& tree, u32 index, TerrainVertex* OutVertices, u32* OutIndices);
+
+    static constexpr u32 ChunkVertexCount(const TerrainChunk& chunk) { return chunk.CountX * chunk.CountZ + 2 * (chunk.CountX + chunk.CountZ); }
+    static constexpr u32 ChunkIndexCount(const TerrainChunk& chunk) { return ((chunk.CountX - 1) * (chunk.CountZ - 1) + 2 * (chunk.CountX - 1) + 2 * (chunk.CountZ - 1)) * 6; }
+private:
+    void SelectChunk(u32 index, Frustum& f, const FVec3& CameraPosition, const Matrix4D& model, u64 frame, DArray<u32>& OutSelected, DArray<u32>& OutMissing, u32& OutTriangles);
+    void UnloadChunk(u32 index);
 };
 
 
@@ -10,18 +10,30 @@ struct ImageResourceData {
     u32 width        {};
     u32 height       {};
     u8* pixels{nullptr};
+    u8 mip           {};    // Уровень детализации, которому соответствуют pixels.
+    u32 FullWidth    {};    // Ширина нулевого уровня детализации.
+    u32 FullHeight   {};    // Высота нулевого уровня детализации.
 
-    constexpr ImageResourceData() : ChannelCount(), width(), height(), pixels(nullptr) {}
+    constexpr ImageResourceData() : ChannelCount(), width(), height(), pixels(nullptr), mip(), FullWidth(), FullHeight() {}
     constexpr ImageResourceData(u8 ChannelCount, u32 width, u32 height, u8* pixels)
-    : ChannelCount(ChannelCount), width(width), height(height), pixels(pixels) {}
+    : ChannelCount(ChannelCount), width(width), height(height), pixels(pixels), mip(), FullWidth(width), FullHeight(height) {}
     void* operator new(u64 size) { return MemorySystem::Allocate(size, Memory::Texture); }
     void operator delete(void* ptr, u64 size) { MemorySystem::Free(ptr, size, Memory::Texture); }
 };
 
+/// @brief Поддерживаемые расширения файлов изображений в порядке приоритета поиска.
+constexpr u32 IMAGE_EXTENSION_COUNT = 4;
+constexpr const char* IMAGE_EXTENSIONS[IMAGE_EXTENSION_COUNT] = {".tga", ".png", ".jpg", ".bmp"};
+
 /// @brief Параметры, используемые при загрузке изображения.
 struct ImageResourceParams {
-    bool FlipY; // Указывает, следует ли переворачивать изображение по оси Y при загрузке.
-    constexpr ImageResourceParams(bool FlipY) : FlipY(FlipY) {}
+    bool FlipY;         // Указывает, следует ли переворачивать изображение по оси Y при загрузке.
+    const u8* data;     // Уже прочитанное содержимое файла изображения. Если задано, загрузчик не обращается к диску.
+    u64 DataSize;       // Размер data в байтах.
+    const char* FullPath; // Полный путь к файлу, из которого прочитаны data. Сохраняется в ресурсе для горячей перезагрузки.
+    u32 MaxSize;        // Наибольший размер стороны загружаемого уровня детализации. 0 - изображение загружается полностью.
+    constexpr ImageResourceParams(bool FlipY, const u8* data = nullptr, u64 DataSize = 0, const char* FullPath = nullptr, u32 MaxSize = 0) 
+    : FlipY(FlipY), data(data), DataSize(DataSize), FullPath(FullPath), MaxSize(MaxSize) {}
 };
 
 /// @brief Определяет режим отсечения граней во время рендеринга.
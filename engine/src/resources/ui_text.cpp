@@ -6,6 +6,28 @@
 #include "math/vertex.h"
 #include "resources/texture_map.hpp"
 #include "resources/font_resource.hpp"
+#include "core/clock.h"
+#include "core/metrics.h"
+#include "core/mvar.h"
+
+/// @brief Длина общего начала двух строк в байтах.
+static u32 TextCommonPrefix(const char* a, const char* b)
+{
+    if (!a || !b) {
+        return 0;
+    }
+    u32 i = 0;
+    while (a[i] && a[i] == b[i]) {
+        ++i;
+    }
+    return i;
+}
+
+/// @brief Имя шейдера, которым рисуется текст: поле расстояний MSDF восстанавливается отдельным шейдером.
+static const char* TextShaderName(TextType type)
+{
+    return type == TextType::Msdf ? "Shader.Builtin.UI.Msdf" : "Shader.Builtin.UI";
+}
 
 Text::~Text()
 {
@@ -45,7 +67,7 @@ bool Text::Create(const char* name, TextType type, const char *FontName, u16 Fon
     }
 
     // Получите ресурсы для карты текстуры шрифта.
-    auto UiShader = ShaderSystem::GetShader("Shader.Builtin.UI");  // ЗАДАЧА: Текстовый шейдер.
+    auto UiShader = ShaderSystem::GetShader(TextShaderName(type));
     TextureMap* FontMaps[1] = { &data->atlas };
     if (!RenderingSystem::ShaderAcquireInstanceResources(UiShader, 1, FontMaps, InstanceID)) {
         MFATAL("Не удалось получить ресурсы шейдера для карты текстуры шрифта.");
@@ -64,19 +86,6 @@ bool Text::Create(const char* name, TextType type, const char *FontName, u16 Fon
         return false;
     }
 
-    // Сгенерируйте буфер индексов.
-    MString::Zero(BufName);
-    MString::Format(BufName, "renderbuffer_indexbuffer_uitext_%s", name);
-    static const u8 QuadIndexSize = sizeof(u32) * 6;
-    if (!RenderingSystem::RenderBufferCreate(BufName, RenderBufferType::Index, TextLength * QuadIndexSize, false, IndexBuffer)) {
-        MERROR("Text::Create не удалось создать буфер рендеринга индекса.");
-        return false;
-    }
-    if (!RenderingSystem::RenderBufferBind(IndexBuffer, 0)) {
-        MERROR("Text::Create не удалось привязать буфер рендеринга индекса.");
-        return false;
-    }
-
     // Убедитесь, что в атласе есть необходимые глифы.
     if (!FontSystem::VerifyAtlas(data, TextContent)) {
         MERROR("Проверка атласа шрифта не удалась.");
@@ -84,7 +93,10 @@ bool Text::Create(const char* name, TextType type, const char *FontName, u16 Fon
     }
 
     // Сгенерируйте геометрию.
-    RegenerateGeometry();
+    QuadCount = 0;
+    FontGeneration = INVALID::ID;
+    GlyphPages = 0;
+    RegenerateGeometry(0);
 
     // Получите уникальный идентификатор для текстового объекта.
     UniqueID = Identifier::AquireNewID(this);
@@ -107,10 +119,15 @@ void Text::Destroy()
 
     // Уничтожить буферы.
     RenderingSystem::RenderBufferDestroy(VertexBuffer);
-    RenderingSystem::RenderBufferDestroy(IndexBuffer);
+    if (layout.Capacity()) {
+        layout.Destroy();
+    }
+    if (vertices.Capacity()) {
+        vertices.Destroy();
+    }
 
     // Освободить ресурсы для карты текстуры шрифта.
-    auto UiShader = ShaderSystem::GetShader("Shader.Builtin.UI");  // ЗАДАЧА: Текстовый шейдер.
+    auto UiShader = ShaderSystem::GetShader(TextShaderName(type));
     if (!RenderingSystem::ShaderReleaseInstanceResources(UiShader, InstanceID)) {
         MFATAL("Невозможно освободить ресурсы шейдера для текстурной карты шрифта.");
     }
@@ -130,6 +147,7 @@ void Text::SetText(const char *text)
             return;
         }
 
+        const u32 FirstChanged = TextCommonPrefix(this->text.c_str(), text);
         this->text = text;
 
         // Проверьте, есть ли в атласе необходимые глифы.
@@ -137,7 +155,7 @@ void Text::SetText(const char *text)
             MERROR("Проверка атласа шрифтов не удалась.");
         }
 
-        RegenerateGeometry();
+        RegenerateGeometry(FirstChanged);
     }
 }
 
@@ -149,6 +167,7 @@ void Text::SetText(const MString &text)
             return;
         }
 
+        const u32 FirstChanged = TextCommonPrefix(this->text.c_str(), text.c_str());
         this->text = text;
 
         // Проверьте, есть ли в атласе необходимые глифы.
@@ -156,7 +175,7 @@ void Text::SetText(const MString &text)
             MERROR("Проверка атласа шрифтов не удалась.");
         }
 
-        RegenerateGeometry();
+        RegenerateGeometry(FirstChanged);
     }
 }
 
@@ -168,6 +187,7 @@ void Text::SetText(MString &&text)
             return;
         }
 
+        const u32 FirstChanged = TextCommonPrefix(this->text.c_str(), text.c_str());
         this->text = static_cast<MString&&>(text);
 
         // Проверьте, есть ли в атласе необходимые глифы.
@@ -175,7 +195,7 @@ void Text::SetText(MString &&text)
             MERROR("Проверка атласа шрифтов не удалась.");
         }
 
-        RegenerateGeometry();
+        RegenerateGeometry(FirstChanged);
     }
 }
 
@@ -184,7 +204,7 @@ void Text::DeleteLastSymbol()
     if (text) {
         text.DeleteLastChar();
 
-        RegenerateGeometry();
+        RegenerateGeometry(text.Length());
     }
     
 }
@@ -198,15 +218,17 @@ void Text::Append(const char* text)
             return;
         }
 
+        const u32 FirstChanged = this->text.Length();
         this->text += text;
 
-        RegenerateGeometry();
+        RegenerateGeometry(FirstChanged);
     }
 }
 
 void Text::Append(char c)
 {
     if (c) {
+        const u32 FirstChanged = text.Length();
         this->text += c;
 
         // Проверьте, есть ли в атласе необходимые глифы.
@@ -215,20 +237,39 @@ void Text::Append(char c)
             return;
         }
 
-        RegenerateGeometry();
+        RegenerateGeometry(FirstChanged);
+    }
+}
+
+void Text::Prepare()
+{
+    // Атлас системного шрифта мог получить новые глифы или освободить страницы: запросить недостающие и перестроить геометрию.
+    if (FontGeneration != data->generation && text) {
+        FontSystem::VerifyAtlas(data, text.c_str());
+        RegenerateGeometry(0);
+    }
+
+    if (QuadCount) {
+        FontSystem::TouchGlyphPages(data, GlyphPages);
     }
 }
 
 void Text::Draw()
 {
-    // ЗАДАЧА: длина utf8
+    Prepare();
+    if (!QuadCount) {
+        return;
+    }
+
     static const u64 QuadVertCount = 4;
-    if (!RenderingSystem::RenderBufferDraw(VertexBuffer, 0, text.Length() * QuadVertCount, true)) {
+    if (!RenderingSystem::RenderBufferDraw(VertexBuffer, 0, QuadCount * QuadVertCount, true)) {
         MERROR("Не удалось нарисовать буфер вершин шрифта пользовательского интерфейса.");
     }
 
+    // Емкость общего буфера индексов уже обеспечена при перестроении геометрии.
     static const u8 QuadIndexCount = 6;
-    if (!RenderingSystem::RenderBufferDraw(IndexBuffer, 0, text.Length() * QuadIndexCount, false)) {
+    auto IndexBuffer = FontSystem::QuadIndexBuffer(QuadCount);
+    if (!IndexBuffer || !RenderingSystem::RenderBufferDraw(*IndexBuffer, 0, QuadCount * QuadIndexCount, false)) {
         MERROR("Не удалось нарисовать буфер индекса шрифта пользовательского интерфейса.");
     }
 }
@@ -238,25 +279,30 @@ Text::operator bool() const
     return bool(text);
 }
 
-void Text::RegenerateGeometry()
+void Text::RegenerateGeometry(u32 FirstChanged)
 {
+    Clock timer;
+    timer.Start();
+
     // Получить длину строки UTF-8
     const u32& TextLengthUTF8 = text.Length();
-    // Также получить длину в символах.
-    u32 CharLength = text.nChar();
 
     // Не пытайтесь воссоздать геометрию объекта, в котором нет текста.
     if (TextLengthUTF8 < 1) {
+        QuadCount = 0;
+        GlyphPages = 0;
+        layout.Clear();
+        vertices.Clear();
+        revision++;
         return;
     }
 
-    // Рассчитать размеры буфера.
+    // Рассчитать размер буфера. Кодовых точек не больше, чем байтов.
     static const u64 VertsPerQuad = 4;
-    static const u8 IndicesPerQuad = 6;
-    u64 VertexBufferSize = sizeof(Vertex2D) * VertsPerQuad * TextLengthUTF8;
-    u64 IndexBufferSize = sizeof(u32) * IndicesPerQuad * TextLengthUTF8;
+    static const u64 QuadSize = sizeof(Vertex2D) * VertsPerQuad;
+    u64 VertexBufferSize = QuadSize * TextLengthUTF8;
 
-    // Изменить размер буфера вершин, но только если он больше.
+    // Изменить размер буфера вершин, но только если он больше. Содержимое сохраняется.
     if (VertexBufferSize > VertexBuffer.TotalSize) {
         if (!RenderingSystem::RenderBufferResize(VertexBuffer, VertexBufferSize)) {
             MERROR("Text::RegenerateGeometry для текста пользовательского интерфейса не удалось изменить размер буфера визуализации вершин.");
@@ -264,38 +310,60 @@ void Text::RegenerateGeometry()
         }
     }
 
-    // Изменить размер буфера индексов, но только если он больше.
-    if (IndexBufferSize > IndexBuffer.TotalSize) {
-        if (!RenderingSystem::RenderBufferResize(IndexBuffer, IndexBufferSize)) {
-            MERROR("Text::RegenerateGeometry для текста пользовательского интерфейса не удалось изменить размер индексного буфера визуализации.");
-            return;
+    // Найти первую кодовую точку, раскладка которой могла измениться. Кернинг предыдущей кодовой точки зависит от следующей,
+    // поэтому раскладка начинается на одну кодовую точку раньше первой измененной. После перестроения атласа меняются все глифы.
+    i32 incremental = 1;
+    MVar::GetInt("text_incremental", incremental);
+    u32 first = 0;
+    if (incremental && FontGeneration == data->generation && FirstChanged > 0) {
+        u32 low = 0, high = layout.Length();
+        while (low < high) {
+            const u32 mid = (low + high) / 2;
+            if (layout[mid].offset < FirstChanged) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
         }
+        first = low ? low - 1 : 0;
+    }
+    FontGeneration = data->generation;
+    if (!first) {
+        GlyphPages = 0;
     }
 
-    // Сгенерировать новую геометрию для каждого символа.
-    f32 x = 0;
-    f32 y = 0;
-    // Временные массивы для хранения данных вершин/индексов.
-
-    auto VertexBufferData = reinterpret_cast<Vertex2D*>(MemorySystem::Allocate(VertexBufferSize, Memory::Array));
-    auto IndexBufferData = reinterpret_cast<u32*>(MemorySystem::Allocate(IndexBufferSize, Memory::Array));
+    f32 x = first < layout.Length() ? layout[first].x : 0.F;
+    f32 y = first < layout.Length() ? layout[first].y : 0.F;
+    u32 c = first < layout.Length() ? layout[first].offset : 0;
+    layout.Resize(first);
+
+    // Перестраиваемый диапазон пишется в копию вершин на CPU, начало которой остается прежним.
+    vertices.Resize((first + TextLengthUTF8 - c) * VertsPerQuad);
+    auto VertexBufferData = vertices.Data() + first * VertsPerQuad;
+
+    // Сгенерировать новую геометрию для каждой кодовой точки. Четырехугольник есть у каждой кодовой точки,
+    // у переводов строки, табуляций и отсутствующих глифов он вырожденный, поэтому индексы у всех текстов одинаковые.
+    u32 uc = first;
+    while (c < TextLengthUTF8) {
+        layout.PushBack({ c, x, y });
+        Vertex2D* quad = VertexBufferData + (uc - first) * VertsPerQuad;
+        uc++;
 
-    // Возьмите длину в символах и получите из нее правильный код.
-    for (u32 c = 0, uc = 0; c < CharLength; ++c) {
         i32 codepoint = text[c];
 
         // Продолжайте на следующей строке для новой строки.
         if (codepoint == '\n') {
             x = 0;
-            y += data->LineHeight;
-            // Увеличьте количество символов utf-8.
-            uc++;
+            y += data->LineHeight * FontScale;
+            MemorySystem::ZeroMem(quad, QuadSize);
+            c++;
             continue;
         }
 
         if (codepoint == '\t') {
-            x += data->TabXAdvance;
-            uc++;
+            x += data->TabXAdvance * FontScale;
+            MemorySystem::ZeroMem(quad, QuadSize);
+            c++;
             continue;
         }
 
@@ -304,112 +372,74 @@ void Text::RegenerateGeometry()
         if (!text.BytesToCodepoint(c, codepoint, advance)) {
             MWARN("В строке обнаружен недопустимый UTF-8, использующий неизвестный код -1");
             codepoint = -1;
+            advance = 1;
         }
 
-        FontGlyph* g = nullptr;
-        for (u32 i = 0; i < data->GlyphCount; ++i) {
-            if (data->glyphs[i].codepoint == codepoint) {
-                g = &data->glyphs[i];
-                break;
-            }
-        }
+        const FontGlyph* g = data->GetGlyph(codepoint);
 
         if (!g) {
             // Если не найдено, используйте кодовую точку -1
             codepoint = -1;
-            for (u32 i = 0; i < data->GlyphCount; ++i) {
-                if (data->glyphs[i].codepoint == codepoint) {
-                    g = &data->glyphs[i];
-                    break;
-                }
-            }
+            g = data->GetGlyph(codepoint);
         }
 
-        if (g) {
-            // Найден глиф. Сгенерировать точки.
-            f32 minx = x + g->xOffset;
-            f32 miny = y + g->yOffset;
-            f32 maxx = minx + g->width;
-            f32 maxy = miny + g->height;
-            f32 tminx = (f32)g->x / data->AtlasSizeX;
-            f32 tmaxx = (f32)(g->x + g->width) / data->AtlasSizeX;
-            f32 tminy = (f32)g->y / data->AtlasSizeY;
-            f32 tmaxy = (f32)(g->y + g->height) / data->AtlasSizeY;
-            // Перевернуть ось Y для системного текста
-            if (type == TextType::System) {
-                tminy = 1.0f - tminy;
-                tmaxy = 1.0f - tmaxy;
-            }
-
-            Vertex2D p0 { FVec2(minx, miny), FVec2(tminx, tminy) };
-            Vertex2D p1 { FVec2(maxx, miny), FVec2(tmaxx, tminy) };
-            Vertex2D p2 { FVec2(maxx, maxy), FVec2(tmaxx, tmaxy) };
-            Vertex2D p3 { FVec2(minx, maxy), FVec2(tminx, tmaxy) };
-
-            VertexBufferData[(uc * 4) + 0] = p0;  // 0    3
-            VertexBufferData[(uc * 4) + 1] = p2;  //
-            VertexBufferData[(uc * 4) + 2] = p3;  //
-            VertexBufferData[(uc * 4) + 3] = p1;  // 2    1
-
-            // Попробовать найти кернинг
-            i32 kerning = 0;
-
-            // Получить смещение следующего символа. Если нет продвижения, 
-            // перейти вперед на один, в противном случае использовать продвижение как есть.
-            u32 offset = c + advance;  //(advance < 1 ? 1 : advance);
-            if (offset < TextLengthUTF8 - 1) {
-                // Получить следующую кодовую точку.
-                i32 NextCodepoint = 0;
-                u8 AdvanceNext = 0;
-
-                if (!text.BytesToCodepoint(offset, NextCodepoint, AdvanceNext)) {
-                    MWARN("В строке обнаружен недопустимый UTF-8, использующий неизвестный код -1");
-                    codepoint = -1;
-                } else {
-                    for (u32 i = 0; i < data->KerningCount; ++i) {
-                        auto& k = data->kernings[i];
-                        if (k.Codepoint0 == codepoint && k.Codepoint1 == NextCodepoint) {
-                            kerning = k.amount;
-                        }
-                    }
-                }
-            }
-            x += g->xAdvance + kerning;
-
-        } else {
+        if (!g) {
             MERROR("Не удалось найти неизвестный код. Пропуск.");
-            // Увеличить количество символов utf-8.
-            uc++;
+            MemorySystem::ZeroMem(quad, QuadSize);
+            c += advance;
             continue;
         }
 
-        // Индекс данных 210301
-        IndexBufferData[(uc * 6) + 0] = (uc * 4) + 2;
-        IndexBufferData[(uc * 6) + 1] = (uc * 4) + 1;
-        IndexBufferData[(uc * 6) + 2] = (uc * 4) + 0;
-        IndexBufferData[(uc * 6) + 3] = (uc * 4) + 3;
-        IndexBufferData[(uc * 6) + 4] = (uc * 4) + 0;
-        IndexBufferData[(uc * 6) + 5] = (uc * 4) + 1;
-
-        // Теперь переходим к c
-        c += advance - 1;  // Вычитание 1, так как цикл всегда увеличивается один раз для однобайтовых символов.
-        // Увеличить количество символов utf-8.
-        uc++;
-    }
+        // Найден глиф. Сгенерировать точки.
+        GlyphPages |= 1u << (g->PageID & 31);
+        f32 minx = x + g->xOffset * FontScale;
+        f32 miny = y + g->yOffset * FontScale;
+        f32 maxx = minx + g->width * FontScale;
+        f32 maxy = miny + g->height * FontScale;
+        f32 tminx = (f32)g->x / data->AtlasSizeX;
+        f32 tmaxx = (f32)(g->x + g->width) / data->AtlasSizeX;
+        f32 tminy = (f32)g->y / data->AtlasSizeY;
+        f32 tmaxy = (f32)(g->y + g->height) / data->AtlasSizeY;
+        // Перевернуть ось Y для системного текста и MSDF
+        if (type != TextType::Bitmap) {
+            tminy = 1.0f - tminy;
+            tmaxy = 1.0f - tmaxy;
+        }
 
-    // Загрузить данные.
-    bool VertexLoadResult = RenderingSystem::RenderBufferLoadRange(VertexBuffer, 0, VertexBufferSize, VertexBufferData);
-    bool IndexLoadResult = RenderingSystem::RenderBufferLoadRange(IndexBuffer, 0, IndexBufferSize, IndexBufferData);
+        quad[0] = { FVec2(minx, miny), FVec2(tminx, tminy) };  // 0    3
+        quad[1] = { FVec2(maxx, maxy), FVec2(tmaxx, tmaxy) };  //
+        quad[2] = { FVec2(minx, maxy), FVec2(tminx, tmaxy) };  //
+        quad[3] = { FVec2(maxx, miny), FVec2(tmaxx, tminy) };  // 2    1
+
+        // Попробовать найти кернинг со следующей кодовой точкой.
+        i32 kerning = 0;
+        c += advance;
+        if (c < TextLengthUTF8) {
+            i32 NextCodepoint = 0;
+            u8 AdvanceNext = 0;
+            if (text.BytesToCodepoint(c, NextCodepoint, AdvanceNext)) {
+                kerning = data->GetKerning(codepoint, NextCodepoint);
+            }
+        }
+        x += (g->xAdvance + kerning) * FontScale;
+    }
 
-    // Очистить.
-    MemorySystem::Free(VertexBufferData, VertexBufferSize, Memory::Array);
-    MemorySystem::Free(IndexBufferData, IndexBufferSize, Memory::Array);
+    // Загрузить только перестроенный диапазон и убедиться, что общих индексов хватает на весь текст.
+    const u32 RebuiltCount = uc - first;
+    QuadCount = uc;
+    vertices.Resize(QuadCount * VertsPerQuad);
+    revision++;
+    bool VertexLoadResult = RenderingSystem::RenderBufferLoadRange(VertexBuffer, first * QuadSize, RebuiltCount * QuadSize, VertexBufferData);
+    bool IndexResult = FontSystem::QuadIndexBuffer(QuadCount) != nullptr;
 
     // Проверить результаты.
     if (!VertexLoadResult) {
         MERROR("Text::RegenerateGeometry не удалось загрузить данные в диапазон буфера вершин.");
     }
-    if (!IndexLoadResult) {
-        MERROR("Text::RegenerateGeometry не удалось загрузить данные в диапазон буфера индексов.");
+    if (!IndexResult) {
+        MERROR("Text::RegenerateGeometry не удалось получить общий буфер индексов.");
     }
+
+    timer.Update();
+    Metrics::AddTextGeometry(timer.elapsed, RebuiltCount, RebuiltCount * QuadSize);
 }
@@ -1,11 +1,21 @@
 #pragma once
 #include "renderer/renderbuffer.h"
+#include "containers/darray.h"
 #include "math/transform.h"
 #include "mesh.h"
+#include "math/vertex.h"
+
+    /// @brief Положение кодовой точки в раскладке текста.
+    struct TextGlyphLayout {
+        u32 offset;  // Смещение кодовой точки в строке в байтах.
+        f32 x;       // Положение пера перед кодовой точкой.
+        f32 y;
+    };
 
     enum class TextType {
         Bitmap,
-        System
+        System,
+        Msdf    // Системный шрифт из общего атласа MSDF; рисуется шейдером Shader.Builtin.UI.Msdf.
     };
     
     struct MAPI Text
@@ -14,15 +24,21 @@
         u32 UniqueID;
         TextType type;
         struct FontData* data;
+        f32 FontScale;                    // Масштаб метрик глифов шрифта: у MSDF атлас запечен в одном кегле для всех размеров.
         RenderBuffer VertexBuffer;
-        RenderBuffer IndexBuffer;
+        u32 QuadCount;                    // Количество четырехугольников в буфере вершин, по одному на кодовую точку. Индексы общие для всех текстов.
+        DArray<TextGlyphLayout> layout;   // Раскладка по кодовым точкам; по ней геометрия перестраивается с первого измененного символа.
+        DArray<Vertex2D> vertices;        // Копия буфера вершин на CPU, из которой представление интерфейса собирает пакет текста.
+        u32 FontGeneration;               // Поколение глифов шрифта, для которого построена геометрия.
+        u32 GlyphPages;                   // Маска страниц атласа, на которых лежат глифы текста.
+        u32 revision;                     // Увеличивается при каждом перестроении геометрии; по нему пакет текста узнает неизмененные тексты.
         MString text;
         Transform transform;
         u32 InstanceID;
         u64 RenderFrameNumber;
         u8 DrawIndex;
 
-        // constexpr Text() : UniqueID(), type(), data(), VertexBuffer(), IndexBuffer(), text(), transform(), InstanceID(INVALID::ID), RenderFrameNumber(INVALID::U64ID) {}
+        // constexpr Text() : UniqueID(), type(), data(), VertexBuffer(), QuadCount(), layout(), FontGeneration(), text(), transform(), InstanceID(INVALID::ID), RenderFrameNumber(INVALID::U64ID) {}
         ~Text();
     
         bool Create(const char* name, TextType type, const char* FontName, u16 FontSize, const char* TextContent);
@@ -39,9 +55,15 @@
         void Append(const char* text);
         void Append(char c);
     
+        /// @brief Готовит текст к отрисовке: перестраивает геометрию, если глифы шрифта изменились, и отмечает страницы атласа используемыми.
+        void Prepare();
+
         void Draw();
 
         explicit operator bool() const;
     private:
-        void RegenerateGeometry();
+        /// @brief Перестраивает геометрию, начиная с символа, предшествующего первому измененному байту, и загружает только
+        /// перестроенный диапазон вершин. Если глифы шрифта изменились, геометрия перестраивается целиком.
+        /// @param FirstChanged смещение первого измененного байта строки.
+        void RegenerateGeometry(u32 FirstChanged);
     };
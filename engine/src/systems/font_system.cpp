@@ -5,6 +5,11 @@
 #include "resources/ui_text.h"
 #include "memory/linear_allocator.h"
 #include "renderer/rendering_system.h"
+#include "core/mvar.h"
+#include "resources/glyph_atlas.hpp"
+#include "resources/msdf.hpp"
+#include "systems/job_systems.hpp"
+#include "core/clock.h"
 
 #include <new>
 
@@ -20,8 +25,34 @@ struct BitmapFontInternalData {
 };
 
 struct SystemFontVariantData {
-    DArray<i32> codepoints{};
+    GlyphAtlas atlas               {};
+    DArray<i32> PendingCodepoints  {};  // Кодовые точки, глифы которых растеризуются заданиями.
+    f32 scale                      {};
+    u16 FontID                     {};
+    u16 MaxGlyphWidth              {};  // Габариты наибольшего глифа шрифта в пикселях.
+    u16 MaxGlyphHeight             {};
+};
+
+constexpr u32 FONT_GLYPH_JOB_BATCH = 8;  // Кодовых точек в одном задании растеризации.
+
+struct SystemFontGlyphJobParams {
+    const stbtt_fontinfo* info;
     f32 scale;
+    u16 FontID;
+    u16 size;
+    u16 MaxGlyphWidth;
+    u16 MaxGlyphHeight;
+    u32 count;
+    i32 codepoints[FONT_GLYPH_JOB_BATCH];
+};
+
+/// @brief Результат задания растеризации. За ним следуют пиксели глифов, по GlyphPixelSize байт на глиф.
+struct SystemFontGlyphJobResult {
+    u16 FontID;
+    u16 size;
+    u32 count;
+    u32 GlyphPixelSize;
+    FontGlyph glyphs[FONT_GLYPH_JOB_BATCH];  // Положение в атласе назначается в основном потоке.
 };
 
 struct BitmapFontLookup {
@@ -42,14 +73,27 @@ struct SystemFontLookup {
     i32 offset                   {};
     i32 index                    {};
     stbtt_fontinfo info          {};
-    /*constexpr*/ SystemFontLookup() : id(INVALID::U16ID), ReferenceCount(), SizeVariants(), BinarySize(), face(), FontBinary(nullptr), offset(), index(), info() {}
+    FontData msdf                {};  // Атлас MSDF начертания, общий для всех размеров. Запекается один раз.
+    /*constexpr*/ SystemFontLookup() : id(INVALID::U16ID), ReferenceCount(), SizeVariants(), BinarySize(), face(), FontBinary(nullptr), offset(), index(), info(), msdf() {}
 };
 
+constexpr u32 FONT_QUAD_INDEX_MIN_CAPACITY = 1024;  // Начальная емкость общего буфера индексов в четырехугольниках.
+constexpr u32 FONT_MSDF_MAX_ATLAS_SIZE = 2048;     // Наибольшая сторона атласа MSDF.
+
+/// @brief Диапазоны кодовых точек, глифы которых запекаются в атлас MSDF: ASCII, Latin-1 и кириллица.
+static const i32 FontMsdfRanges[][2] = { { 32, 126 }, { 160, 255 }, { 0x400, 0x45F } };
+
 static bool SetupFontData(FontData& font);
 static void CleanupFontData(FontData& font);
-static bool CreateSystemFontVariant(SystemFontLookup& lookup, u16 size, const char* FontName, FontData& OutVariant);
-static bool RebuildSystemFontVariantAtlas(SystemFontLookup& lookup, FontData& variant);
-static bool VerifySystemFontSizeVariant(SystemFontLookup& lookup, FontData* variant, const char* text);
+static bool CreateSystemFontVariant(SystemFontLookup& lookup, u16 FontID, u16 size, const char* FontName, FontData& OutVariant);
+static bool CreateSystemFontMsdf(SystemFontLookup& lookup, u16 FontID, const char* FontName, FontData& OutFont);
+static bool AcquireSystemFontMsdf(SystemFontLookup& lookup, u16 FontID);
+static bool PackFontGlyphs(GlyphAtlas& atlas, FontData& font, const DArray<FontGlyph>& glyphs, u16 MaxGlyphSize);
+static void RasterizeSystemGlyph(const stbtt_fontinfo& info, f32 scale, i32 codepoint, u16 MaxWidth, u16 MaxHeight, FontGlyph& OutGlyph, u8* OutPixels);
+static void CopySystemGlyphPixels(const FontGlyph& glyph, const u8* pixels, u8* dest, u32 DestStride);
+static bool BuildSystemFontVariantKerning(SystemFontLookup& lookup, FontData& variant);
+static bool SystemFontGlyphJobStart(void* ParamData, void* ResultData);
+static void RemovePendingCodepoint(SystemFontVariantData& data, i32 codepoint);
 
 FontSystem* FontSystem::state;
 
@@ -85,6 +129,11 @@ bool FontSystem::Initialize(u64& MemoryRequirement, void* memory, void* config)
 
     state = new(MemBlock) FontSystem(*pConfig, BmpArrayBlock, SysArrayBlock, BmpHashtableBlock, SysHashtableBlock);
 
+    // Тексты перестраивают геометрию с первого измененного символа. 0 — всегда перестраивать целиком, для сравнения.
+    MVar::CreateInt("text_incremental", 1);
+    // Пакеты текста повторно используют неизмененные тексты прошлой сборки. 0 — пересобирать каждый кадр, для сравнения.
+    MVar::CreateInt("ui_retained", 1);
+
     // Загрузите все шрифты по умолчанию.
     // Растровые шрифты.
     for (u32 i = 0; i < state->config.DefaultBitmapFontCount; ++i) {
@@ -123,11 +172,19 @@ void FontSystem::Shutdown()
                     auto& data = state->SystemFonts[i].SizeVariants[j];
                     CleanupFontData(data);
                 }
+                if (state->SystemFonts[i].msdf.type == FontType::Msdf) {
+                    CleanupFontData(state->SystemFonts[i].msdf);
+                }
                 state->SystemFonts[i].id = INVALID::U16ID;
 
                 // state->SystemFonts[i].SizeVariants.Clear();
             }
         }
+
+        if (state->QuadIndexCapacity) {
+            RenderingSystem::RenderBufferDestroy(state->QuadIndices);
+            state->QuadIndexCapacity = 0;
+        }
     }
 }
 
@@ -191,7 +248,7 @@ bool FontSystem::LoadFont(SystemFontConfig &config)
 
         // Создать вариант размера по умолчанию.
         FontData variant;
-        if (!CreateSystemFontVariant(lookup, config.DefaultSize, face.name, variant)) {
+        if (!CreateSystemFontVariant(lookup, id, config.DefaultSize, face.name, variant)) {
             MERROR("Не удалось создать вариант: %s, индекс %i", face.name, i);
             continue;
         }
@@ -205,6 +262,11 @@ bool FontSystem::LoadFont(SystemFontConfig &config)
         // Добавить к вариантам размера поиска.
         lookup.SizeVariants.PushBack(static_cast<FontData&&>(variant));
 
+        // Атлас MSDF запекается сразу при загрузке, чтобы первый текст в этом режиме не ждал его построения.
+        if (config.msdf && !AcquireSystemFontMsdf(lookup, id)) {
+            MERROR("Не удалось запечь атлас MSDF шрифта '%s'.", face.name);
+        }
+
         // Установите идентификатор записи здесь в последнюю очередь перед обновлением хеш-таблицы.
         lookup.id = id;
         if (!state->systemFontLookup.Set(face.name, id)) {
@@ -289,8 +351,32 @@ bool FontSystem::Acquire(const char *FontName, u16 FontSize, Text &text)
 
         // Назначить данные, увеличить ссылку.
         text.data = &lookup.font.ResourceData->data;
+        text.FontScale = 1.F;
         lookup.ReferenceCount++;
 
+        return true;
+    } else if (text.type == TextType::Msdf) {
+        u16 id = INVALID::U16ID;
+        if (!state->systemFontLookup.Get(FontName, &id)) {
+            MERROR("Поиск системного шрифта не удался при получении.");
+            return false;
+        }
+
+        if (id == INVALID::U16ID) {
+            MERROR("Системный шрифт с именем '%s' не найден. Получение шрифта не удалось.", FontName);
+            return false;
+        }
+
+        // Один атлас MSDF обслуживает все размеры: текст масштабирует метрики глифов, а шейдер восстанавливает края.
+        auto& lookup = state->SystemFonts[id];
+        if (!AcquireSystemFontMsdf(lookup, id)) {
+            MERROR("Не удалось запечь атлас MSDF шрифта '%s'.", FontName);
+            return false;
+        }
+
+        text.data = &lookup.msdf;
+        text.FontScale = (f32)FontSize / FONT_MSDF_SIZE;
+        lookup.ReferenceCount++;
         return true;
     } else if (text.type == TextType::System) {
         u16 id = INVALID::U16ID;
@@ -313,6 +399,7 @@ bool FontSystem::Acquire(const char *FontName, u16 FontSize, Text &text)
             if (lookup.SizeVariants[i].size == FontSize) {
                 // Назначить данные, увеличить ссылку.
                 text.data = &lookup.SizeVariants[i];
+                text.FontScale = 1.F;
                 lookup.ReferenceCount++;
                 return true;
             }
@@ -320,7 +407,7 @@ bool FontSystem::Acquire(const char *FontName, u16 FontSize, Text &text)
 
         // Если мы достигли этой точки, вариант размера не существует. Создать его.
         FontData variant;
-        if (!CreateSystemFontVariant(lookup, FontSize, FontName, variant)) {
+        if (!CreateSystemFontVariant(lookup, id, FontSize, FontName, variant)) {
             MERROR("Не удалось создать вариант: %s, индекс %i, размер %i", lookup.face.c_str(), lookup.index, FontSize);
             return false;
         }
@@ -335,6 +422,7 @@ bool FontSystem::Acquire(const char *FontName, u16 FontSize, Text &text)
         const auto& length = lookup.SizeVariants.Length();
         // Назначить данные, увеличить ссылку.
         text.data = &lookup.SizeVariants[length - 1];
+        text.FontScale = 1.F;
         lookup.ReferenceCount++;
         return true;
     }
@@ -349,10 +437,26 @@ bool FontSystem::Release(Text &text)
     return true;
 }
 
+bool FontSystem::Update(void *, const FrameData &)
+{
+    if (state) {
+        state->FrameStamp++;
+    }
+    return true;
+}
+
+void FontSystem::TouchGlyphPages(FontData *font, u32 PageMask)
+{
+    if (font->type == FontType::System && font->InternalData) {
+        reinterpret_cast<SystemFontVariantData*>(font->InternalData)->atlas.Touch(PageMask, state->FrameStamp);
+    }
+}
+
 bool FontSystem::VerifyAtlas(FontData *font, const char *text)
 {
-    if (font->type == FontType::Bitmap) {
-        // Растровые изображения не нуждаются в проверке, так как они уже сгенерированы.
+    if (font->type == FontType::Bitmap || font->type == FontType::Msdf) {
+        // Растровые шрифты и атласы MSDF не нуждаются в проверке, так как они уже сгенерированы.
+        // Кодовые точки вне запеченных диапазонов MSDF показывают неизвестный глиф.
         return true;
 
     } else if (font->type == FontType::System) {
@@ -377,6 +481,57 @@ bool FontSystem::VerifyAtlas(FontData *font, const char *text)
     return false;
 }
 
+RenderBuffer *FontSystem::QuadIndexBuffer(u32 QuadCount)
+{
+    if (QuadCount <= state->QuadIndexCapacity) {
+        return &state->QuadIndices;
+    }
+
+    u32 capacity = state->QuadIndexCapacity ? state->QuadIndexCapacity : FONT_QUAD_INDEX_MIN_CAPACITY;
+    while (capacity < QuadCount) {
+        capacity *= 2;
+    }
+
+    static const u64 QuadIndexSize = sizeof(u32) * 6;
+    if (!state->QuadIndexCapacity) {
+        if (!RenderingSystem::RenderBufferCreate("renderbuffer_indexbuffer_text_quads", RenderBufferType::Index, capacity * QuadIndexSize, false, state->QuadIndices)) {
+            MERROR("FontSystem::QuadIndexBuffer не удалось создать общий буфер индексов текста.");
+            return nullptr;
+        }
+        if (!RenderingSystem::RenderBufferBind(state->QuadIndices, 0)) {
+            MERROR("FontSystem::QuadIndexBuffer не удалось привязать общий буфер индексов текста.");
+            return nullptr;
+        }
+    } else if (!RenderingSystem::RenderBufferResize(state->QuadIndices, capacity * QuadIndexSize)) {
+        MERROR("FontSystem::QuadIndexBuffer не удалось расширить общий буфер индексов текста.");
+        return nullptr;
+    }
+
+    // Индексы уже загруженных четырехугольников не меняются, поэтому загружается только новый диапазон.
+    const u32 first = state->QuadIndexCapacity;
+    const u32 count = capacity - first;
+    u32* indices = MemorySystem::TAllocate<u32>(Memory::Array, count * 6);
+    for (u32 q = 0; q < count; ++q) {
+        const u32 v = (first + q) * 4;
+        // Индекс данных 210301
+        indices[(q * 6) + 0] = v + 2;
+        indices[(q * 6) + 1] = v + 1;
+        indices[(q * 6) + 2] = v + 0;
+        indices[(q * 6) + 3] = v + 3;
+        indices[(q * 6) + 4] = v + 0;
+        indices[(q * 6) + 5] = v + 1;
+    }
+    bool result = RenderingSystem::RenderBufferLoadRange(state->QuadIndices, first * QuadIndexSize, count * QuadIndexSize, indices);
+    MemorySystem::Free(indices, count * QuadIndexSize, Memory::Array);
+    if (!result) {
+        MERROR("FontSystem::QuadIndexBuffer не удалось загрузить индексы текста.");
+        return nullptr;
+    }
+
+    state->QuadIndexCapacity = capacity;
+    return &state->QuadIndices;
+}
+
 static bool SetupFontData(FontData &font)
 {
     // Создать ресурсы карты
@@ -387,23 +542,21 @@ static bool SetupFontData(FontData &font)
         return false;
     }
 
+    // Таблицы поиска системных шрифтов пополняются по мере растеризации глифов, растровых — строятся один раз здесь.
+    if (font.type == FontType::Bitmap) {
+        font.BuildLookup();
+    }
+
     // Проверьте наличие символа табуляции, так как он не всегда может быть экспортирован. 
     // Если он есть, сохраните его xAdvance и просто используйте его. Если его нет, создайте его на основе пробела x4
     if (!font.TabXAdvance) {
-        for (u32 i = 0; i < font.GlyphCount; ++i) {
-            if (font.glyphs[i].codepoint == '\t') {
-                font.TabXAdvance = font.glyphs[i].xAdvance;
-                break;
-            }
+        if (auto tab = font.GetGlyph('\t')) {
+            font.TabXAdvance = tab->xAdvance;
         }
         // Если его все еще нет, используйте пробел x 4.
         if (!font.TabXAdvance) {
-            for (u32 i = 0; i < font.GlyphCount; ++i) {
-                // Поиск пробела
-                if (font.glyphs[i].codepoint == ' ') {
-                    font.TabXAdvance = font.glyphs[i].xAdvance * 4;
-                    break;
-                }
+            if (auto space = font.GetGlyph(' ')) {
+                font.TabXAdvance = space->xAdvance * 4;
             }
             if (!font.TabXAdvance) {
                 // Если его _все еще_ нет, значит, пробела тоже не было, поэтому просто закодируйте что-нибудь, в данном случае размер шрифта * 4.
@@ -425,9 +578,30 @@ static void CleanupFontData(FontData &font)
         TextureSystem::Release(font.atlas.texture->name);
     }
     font.atlas.texture = nullptr;
+
+    font.DestroyLookup();
+
+    // Массив глифов системного шрифта и атласа MSDF принадлежит его атласу.
+    if (font.type != FontType::Bitmap && font.InternalData) {
+        auto InternalData = reinterpret_cast<SystemFontVariantData*>(font.InternalData);
+        InternalData->atlas.Destroy();
+        if (InternalData->PendingCodepoints.Data()) {
+            InternalData->PendingCodepoints.Destroy();
+        }
+        InternalData->~SystemFontVariantData();
+        MemorySystem::Free(font.InternalData, font.InternalDataSize, Memory::SystemFont);
+        font.InternalData = nullptr;
+        font.glyphs = nullptr;
+        font.GlyphCount = 0;
+        if (font.kernings) {
+            MemorySystem::Free(font.kernings, sizeof(FontKerning) * font.KerningCount, Memory::Array);
+            font.kernings = nullptr;
+            font.KerningCount = 0;
+        }
+    }
 }
 
-static bool CreateSystemFontVariant(SystemFontLookup &lookup, u16 size, const char *FontName, FontData &OutVariant)
+static bool CreateSystemFontVariant(SystemFontLookup &lookup, u16 FontID, u16 size, const char *FontName, FontData &OutVariant)
 {
     OutVariant.AtlasSizeX = 1024;  // ЗАДАЧА: настраевыемый размер
     OutVariant.AtlasSizeY = 1024;
@@ -435,134 +609,399 @@ static bool CreateSystemFontVariant(SystemFontLookup &lookup, u16 size, const ch
     OutVariant.type = FontType::System;
     MString::Copy(OutVariant.face, FontName, 255);
     OutVariant.InternalDataSize = sizeof(SystemFontVariantData);
-    OutVariant.InternalData = MemorySystem::Allocate(OutVariant.InternalDataSize, Memory::SystemFont, true);
+    OutVariant.InternalData = new(MemorySystem::Allocate(OutVariant.InternalDataSize, Memory::SystemFont, true)) SystemFontVariantData();
 
     auto InternalData = reinterpret_cast<SystemFontVariantData*>(OutVariant.InternalData);
+    InternalData->FontID = FontID;
+
+    // Получить некоторые метрики
+    InternalData->scale = stbtt_ScaleForPixelHeight(&lookup.info, (f32)size);
+    i32 ascent, descent, line_gap;
+    stbtt_GetFontVMetrics(&lookup.info, &ascent, &descent, &line_gap);
+    OutVariant.LineHeight = (ascent - descent + line_gap) * InternalData->scale;
 
-    // Всегда указывайте кодовые точки по умолчанию (ascii 32–127), плюс -1 для неизвестного.
-    InternalData->codepoints.Reserve(96);
-    InternalData->codepoints.PushBack(-1);  // push invalid char
-    for (i32 i = 0; i < 95; ++i) {
-        InternalData->codepoints.PushBack(i + 32);
+    // Размер наибольшего глифа определяет размер буфера растеризации и сторону страницы атласа.
+    i32 x0, y0, x1, y1;
+    stbtt_GetFontBoundingBox(&lookup.info, &x0, &y0, &x1, &y1);
+    InternalData->MaxGlyphWidth = (u16)((x1 - x0) * InternalData->scale) + 2;
+    InternalData->MaxGlyphHeight = (u16)((y1 - y0) * InternalData->scale) + 2;
+    if (!InternalData->atlas.Create(OutVariant.AtlasSizeX, OutVariant.AtlasSizeY, MMAX(InternalData->MaxGlyphWidth, InternalData->MaxGlyphHeight))) {
+        MERROR("Не удалось разметить атлас шрифта '%s' размера %u.", FontName, size);
+        return false;
     }
-    //InternalData->codepoints.Resize(96);
 
     // Создать текстуру.
     char FontTexName[255];
     MString::Format(FontTexName, "__system_text_atlas_%s_i%i_sz%i__", FontName, lookup.index, size);
     OutVariant.atlas.texture = TextureSystem::AquireWriteable(FontTexName, OutVariant.AtlasSizeX, OutVariant.AtlasSizeY, 4, true);
 
-    // Получить некоторые метрики
-    InternalData->scale = stbtt_ScaleForPixelHeight(&lookup.info, (f32)size);
+    // Неизвестный глиф и ASCII 32–126 растеризуются сразу и закрепляются; остальные глифы растеризуются заданиями по мере появления в тексте.
+    // Текстура записывается целиком один раз: это же очищает ее, и дальше записываются только области новых глифов.
+    const u32 ImageSize = OutVariant.AtlasSizeX * OutVariant.AtlasSizeY * 4;
+    u8* RgbaPixels = reinterpret_cast<u8*>(MemorySystem::Allocate(ImageSize, Memory::Array, true));
+    const u32 GlyphPixelSize = InternalData->MaxGlyphWidth * InternalData->MaxGlyphHeight;
+    u8* GlyphPixels = MemorySystem::TAllocate<u8>(Memory::Array, GlyphPixelSize);
+    const auto AddPinnedGlyph = [&](i32 codepoint) {
+        FontGlyph glyph;
+        RasterizeSystemGlyph(lookup.info, InternalData->scale, codepoint, InternalData->MaxGlyphWidth, InternalData->MaxGlyphHeight, glyph, GlyphPixels);
+        const FontGlyph* placed = InternalData->atlas.Add(OutVariant, glyph, 0, 0, true);
+        if (!placed) {
+            MWARN("Глиф U+%04X шрифта '%s' размера %u не поместился в атлас.", codepoint, FontName, size);
+            return;
+        }
+        CopySystemGlyphPixels(*placed, GlyphPixels, RgbaPixels + ((u64)placed->y * OutVariant.AtlasSizeX + placed->x) * 4, OutVariant.AtlasSizeX);
+    };
+    AddPinnedGlyph(-1);
+    for (i32 codepoint = 32; codepoint < 127; ++codepoint) {
+        AddPinnedGlyph(codepoint);
+    }
+    TextureSystem::WriteData(OutVariant.atlas.texture, 0, ImageSize, RgbaPixels);
+    MemorySystem::Free(GlyphPixels, GlyphPixelSize, Memory::Array);
+    MemorySystem::Free(RgbaPixels, ImageSize, Memory::Array);
+
+    return BuildSystemFontVariantKerning(lookup, OutVariant);
+}
+
+static bool CreateSystemFontMsdf(SystemFontLookup &lookup, u16 FontID, const char *FontName, FontData &OutFont)
+{
+    OutFont.size = FONT_MSDF_SIZE;
+    OutFont.type = FontType::Msdf;
+    MString::Copy(OutFont.face, FontName, 255);
+    OutFont.InternalDataSize = sizeof(SystemFontVariantData);
+    OutFont.InternalData = new(MemorySystem::Allocate(OutFont.InternalDataSize, Memory::SystemFont, true)) SystemFontVariantData();
+
+    auto InternalData = reinterpret_cast<SystemFontVariantData*>(OutFont.InternalData);
+    InternalData->FontID = FontID;
+    InternalData->scale = stbtt_ScaleForPixelHeight(&lookup.info, (f32)FONT_MSDF_SIZE);
+    const f32 scale = InternalData->scale;
     i32 ascent, descent, line_gap;
     stbtt_GetFontVMetrics(&lookup.info, &ascent, &descent, &line_gap);
-    OutVariant.LineHeight = (ascent - descent + line_gap) * InternalData->scale;
+    OutFont.LineHeight = (ascent - descent + line_gap) * scale;
+
+    // Поле выходит за контур на половину своей ширины, еще пиксель оставляет медиану снаружи у края прямоугольника глифа.
+    const i32 padding = (i32)(FONT_MSDF_RANGE * 0.5F) + 1;
+    i32 x0, y0, x1, y1;
+    stbtt_GetFontBoundingBox(&lookup.info, &x0, &y0, &x1, &y1);
+    InternalData->MaxGlyphWidth = (u16)((x1 - x0) * scale) + 2 * padding + 2;
+    InternalData->MaxGlyphHeight = (u16)((y1 - y0) * scale) + 2 * padding + 2;
+
+    // Метрики глифов в кегле FONT_MSDF_SIZE. Прямоугольник глифа расширен на ширину поля.
+    DArray<FontGlyph> glyphs;
+    DArray<i32> GlyphIndices;
+    const auto AddGlyphMetrics = [&](i32 codepoint, i32 GlyphIndex) {
+        FontGlyph glyph{};
+        glyph.codepoint = codepoint;
+        i32 advance, LeftSideBearing;
+        stbtt_GetGlyphHMetrics(&lookup.info, GlyphIndex, &advance, &LeftSideBearing);
+        glyph.xAdvance = advance * scale;
+        if (!stbtt_IsGlyphEmpty(&lookup.info, GlyphIndex)) {
+            // Габариты в пикселях с осью y вниз, как у растровых глифов.
+            i32 gx0, gy0, gx1, gy1;
+            stbtt_GetGlyphBitmapBox(&lookup.info, GlyphIndex, scale, scale, &gx0, &gy0, &gx1, &gy1);
+            const i32 width = gx1 - gx0 + 2 * padding;
+            const i32 height = gy1 - gy0 + 2 * padding;
+            if (width <= InternalData->MaxGlyphWidth && height <= InternalData->MaxGlyphHeight) {
+                glyph.xOffset = gx0 - padding;
+                glyph.yOffset = gy0 - padding;
+                glyph.width = width;
+                glyph.height = height;
+            }
+        }
+        glyphs.PushBack(glyph);
+        GlyphIndices.PushBack(GlyphIndex);
+    };
+    AddGlyphMetrics(-1, 0);
+    for (const auto& range : FontMsdfRanges) {
+        for (i32 codepoint = range[0]; codepoint <= range[1]; ++codepoint) {
+            const i32 GlyphIndex = stbtt_FindGlyphIndex(&lookup.info, codepoint);
+            if (GlyphIndex > 0) {
+                AddGlyphMetrics(codepoint, GlyphIndex);
+            }
+        }
+    }
+
+    // Все страницы закреплены: набор глифов не меняется.
+    const u32 GlyphCount = glyphs.Length();
+    const bool packed = PackFontGlyphs(InternalData->atlas, OutFont, glyphs, MMAX(InternalData->MaxGlyphWidth, InternalData->MaxGlyphHeight));
+    glyphs.Destroy();
+    if (!packed) {
+        MERROR("Глифы шрифта '%s' не поместились в атлас MSDF %ux%u.", FontName, FONT_MSDF_MAX_ATLAS_SIZE, FONT_MSDF_MAX_ATLAS_SIZE);
+        GlyphIndices.Destroy();
+        return false;
+    }
+
+    // Контуры глифов в единицах кегля FONT_MSDF_SIZE, ось y направлена вверх. Кривые раскрашиваются как ребра целиком.
+    const u32 ImageSize = OutFont.AtlasSizeX * OutFont.AtlasSizeY * 4;
+    u8* RgbaPixels = reinterpret_cast<u8*>(MemorySystem::Allocate(ImageSize, Memory::Array, true));
+    const FontGlyph* placed = InternalData->atlas.GetGlyphs();
+    MsdfShape shape;
+    for (u32 i = 0; i < GlyphCount; ++i) {
+        const auto& g = placed[i];
+        if (!g.width || !g.height) {
+            continue;
+        }
+        stbtt_vertex* vertices = nullptr;
+        const i32 VertexCount = stbtt_GetGlyphShape(&lookup.info, GlyphIndices[i], &vertices);
+        shape.Clear();
+        for (i32 v = 0; v < VertexCount; ++v) {
+            const auto& vertex = vertices[v];
+            switch (vertex.type) {
+                case STBTT_vmove: shape.MoveTo(vertex.x * scale, vertex.y * scale); break;
+                case STBTT_vline: shape.LineTo(vertex.x * scale, vertex.y * scale); break;
+                case STBTT_vcurve: shape.QuadTo(vertex.cx * scale, vertex.cy * scale, vertex.x * scale, vertex.y * scale); break;
+                case STBTT_vcubic: shape.CubicTo(vertex.cx * scale, vertex.cy * scale, vertex.cx1 * scale, vertex.cy1 * scale, vertex.x * scale, vertex.y * scale); break;
+            }
+        }
+        shape.Close();
+        stbtt_FreeShape(&lookup.info, vertices);
 
-    return RebuildSystemFontVariantAtlas(lookup, OutVariant);
+        shape.ColourEdges();
+        shape.Generate(RgbaPixels + ((u64)g.y * OutFont.AtlasSizeX + g.x) * 4, g.width, g.height, OutFont.AtlasSizeX, FONT_MSDF_RANGE, g.xOffset, -g.yOffset);
+    }
+    shape.Destroy();
+    GlyphIndices.Destroy();
+
+    char FontTexName[255];
+    MString::Format(FontTexName, "__system_text_msdf_%s_i%i__", FontName, lookup.index);
+    OutFont.atlas.texture = TextureSystem::AquireWriteable(FontTexName, OutFont.AtlasSizeX, OutFont.AtlasSizeY, 4, true);
+    TextureSystem::WriteData(OutFont.atlas.texture, 0, ImageSize, RgbaPixels);
+    MemorySystem::Free(RgbaPixels, ImageSize, Memory::Array);
+
+    return BuildSystemFontVariantKerning(lookup, OutFont);
 }
 
-static bool RebuildSystemFontVariantAtlas(SystemFontLookup &lookup, FontData &variant)
+static bool PackFontGlyphs(GlyphAtlas &atlas, FontData &font, const DArray<FontGlyph> &glyphs, u16 MaxGlyphSize)
 {
-    auto InternalData = reinterpret_cast<SystemFontVariantData*>(variant.InternalData);
-
-    u32 PackImageSize = variant.AtlasSizeX * variant.AtlasSizeY * sizeof(u8);
-    u8* pixels = MemorySystem::TAllocate<u8>(Memory::Array, PackImageSize);
-    const auto& CodepointCount = InternalData->codepoints.Length();
-    auto PackedChars = MemorySystem::TAllocate<stbtt_packedchar>(Memory::Array, CodepointCount);
+    const u32 GlyphCount = glyphs.Length();
+    for (u32 size = GLYPH_ATLAS_PAGE_SIZE; size <= FONT_MSDF_MAX_ATLAS_SIZE; size <<= 1) {
+        if (!atlas.Create(size, size, MaxGlyphSize)) {
+            continue;
+        }
+        bool packed = true;
+        for (u32 i = 0; i < GlyphCount && packed; ++i) {
+            packed = atlas.Add(font, glyphs[i], 0, 0, true) != nullptr;
+        }
+        if (packed) {
+            font.AtlasSizeX = font.AtlasSizeY = size;
+            return true;
+        }
+        atlas.Destroy();
+        font.DestroyLookup();
+        font.glyphs = nullptr;
+        font.GlyphCount = 0;
+    }
+    return false;
+}
 
-    // Начните упаковывать все известные символы в атлас. 
-    // Это создаст одноканальное изображение с визуализированными глифами заданного размера.
-    stbtt_pack_context context;
-    if (!stbtt_PackBegin(&context, pixels, variant.AtlasSizeX, variant.AtlasSizeY, 0, 1, 0)) {
-        MERROR("stbtt_PackBegin failed");
-        return false;
+static bool AcquireSystemFontMsdf(SystemFontLookup &lookup, u16 FontID)
+{
+    if (lookup.msdf.type == FontType::Msdf) {
+        return true;
     }
 
-    // Поместите все кодовые точки в один диапазон для упаковки.
-    stbtt_pack_range range;
-    range.first_unicode_codepoint_in_range = 0;
-    range.font_size = variant.size;
-    range.num_chars = CodepointCount;
-    range.chardata_for_range = PackedChars;
-    range.array_of_unicode_codepoints = InternalData->codepoints.Data();
-    if (!stbtt_PackFontRanges(&context, reinterpret_cast<u8*>(lookup.FontBinary), lookup.index, &range, 1)) {
-        MERROR("stbtt_PackFontRanges failed");
+    Clock clock;
+    clock.Start();
+    if (!CreateSystemFontMsdf(lookup, FontID, lookup.face.c_str(), lookup.msdf) || !SetupFontData(lookup.msdf)) {
+        CleanupFontData(lookup.msdf);
+        lookup.msdf.type = FontType::Bitmap;
         return false;
     }
+    clock.Update();
 
-    stbtt_PackEnd(&context);
-    // Упаковка завершена.
+    MINFO("Атлас MSDF шрифта '%s': %u глифов, %ix%i, запечен за %.2f мс.",
+        lookup.face.c_str(), lookup.msdf.GlyphCount, lookup.msdf.AtlasSizeX, lookup.msdf.AtlasSizeY, clock.elapsed * 1000.0);
+    return true;
+}
 
-    // Конвертируйте из одноканального в RGBA или pack_image_size * 4.
-    u8* RgbaPixels = MemorySystem::TAllocate<u8>(Memory::Array, PackImageSize * 4);
-    for (u32 j = 0; j < PackImageSize; ++j) {
-        RgbaPixels[(j * 4) + 0] = pixels[j];
-        RgbaPixels[(j * 4) + 1] = pixels[j];
-        RgbaPixels[(j * 4) + 2] = pixels[j];
-        RgbaPixels[(j * 4) + 3] = pixels[j];
+static void RasterizeSystemGlyph(const stbtt_fontinfo &info, f32 scale, i32 codepoint, u16 MaxWidth, u16 MaxHeight, FontGlyph &OutGlyph, u8 *OutPixels)
+{
+    // Неизвестной кодовой точке соответствует глиф с индексом 0.
+    const i32 GlyphIndex = codepoint < 0 ? 0 : stbtt_FindGlyphIndex(&info, codepoint);
+
+    i32 advance, LeftSideBearing;
+    stbtt_GetGlyphHMetrics(&info, GlyphIndex, &advance, &LeftSideBearing);
+    i32 x0, y0, x1, y1;
+    stbtt_GetGlyphBitmapBox(&info, GlyphIndex, scale, scale, &x0, &y0, &x1, &y1);
+
+    MemorySystem::ZeroMem(&OutGlyph, sizeof(FontGlyph));
+    OutGlyph.codepoint = codepoint;
+    OutGlyph.xOffset = x0;
+    OutGlyph.yOffset = y0;
+    OutGlyph.xAdvance = advance * scale;
+
+    // Глиф, выходящий за габариты шрифта, остается пустым, сохраняя только продвижение.
+    const i32 width = x1 - x0;
+    const i32 height = y1 - y0;
+    if (width > 0 && height > 0 && width <= MaxWidth && height <= MaxHeight) {
+        OutGlyph.width = width;
+        OutGlyph.height = height;
+        stbtt_MakeGlyphBitmap(&info, OutPixels, width, height, width, scale, scale, GlyphIndex);
     }
+}
 
-    // Запишите данные текстуры в атлас.
-    TextureSystem::WriteData(variant.atlas.texture, 0, PackImageSize * 4, RgbaPixels);
+static void CopySystemGlyphPixels(const FontGlyph &glyph, const u8 *pixels, u8 *dest, u32 DestStride)
+{
+    for (u32 y = 0; y < glyph.height; ++y) {
+        const u8* src = pixels + y * glyph.width;
+        u8* row = dest + (u64)y * DestStride * 4;
+        for (u32 x = 0; x < glyph.width; ++x) {
+            row[(x * 4) + 0] = src[x];
+            row[(x * 4) + 1] = src[x];
+            row[(x * 4) + 2] = src[x];
+            row[(x * 4) + 3] = src[x];
+        }
+    }
+}
 
-    // Освободите данные пикселей/rgba_pixel.
-    MemorySystem::Free(pixels, PackImageSize, Memory::Array);
-    MemorySystem::Free(RgbaPixels, PackImageSize * 4, Memory::Array);
+static bool BuildSystemFontVariantKerning(SystemFontLookup &lookup, FontData &variant)
+{
+    auto InternalData = reinterpret_cast<SystemFontVariantData*>(variant.InternalData);
 
-    // Регенерируйте глифы
-    if (variant.glyphs && variant.GlyphCount) {
-        MemorySystem::Free(variant.glyphs, sizeof(FontGlyph) * variant.GlyphCount, Memory::Array);
+    variant.kernings = nullptr;
+    variant.KerningCount = 0;
+    u32 EntryCount = stbtt_GetKerningTableLength(&lookup.info);
+    if (!EntryCount) {
+        return true;
     }
-    variant.GlyphCount = CodepointCount;
-    variant.glyphs = MemorySystem::TAllocate<FontGlyph>(Memory::Array, CodepointCount);
-    for (u16 i = 0; i < variant.GlyphCount; ++i) {
-        stbtt_packedchar* pc = &PackedChars[i];
-        auto& g = variant.glyphs[i];
-        g.codepoint = InternalData->codepoints[i];
-        g.PageID = 0;
-        g.xOffset = pc->xoff;
-        g.yOffset = pc->yoff;
-        g.x = pc->x0;  // xmin;
-        g.y = pc->y0;
-        g.width = pc->x1 - pc->x0;
-        g.height = pc->y1 - pc->y0;
-        g.xAdvance = pc->xadvance;
+
+    // Получите таблицу кернинга для текущего шрифта.
+    stbtt_kerningentry* KerningTable = MemorySystem::TAllocate<stbtt_kerningentry>(Memory::Array, EntryCount);
+    if (stbtt_GetKerningTable(&lookup.info, KerningTable, EntryCount) != (i32)EntryCount) {
+        MERROR("Несоответствие количества записей кернинга: %i", EntryCount);
+        MemorySystem::Free(KerningTable, sizeof(stbtt_kerningentry) * EntryCount, Memory::Array);
+        return false;
     }
 
-    // Регенерируйте кернинги
-    if (variant.kernings && variant.KerningCount) {
-        MemorySystem::Free(variant.kernings, sizeof(FontKerning) * variant.KerningCount, Memory::Array);
+    // Записи таблицы содержат индексы глифов шрифта, а не кодовые точки. Глифы варианта появляются по мере
+    // растеризации, поэтому кернинг строится один раз для всей базовой плоскости Юникода.
+    const u32 FontGlyphCount = lookup.info.numGlyphs;
+    i32* GlyphCodepoints = MemorySystem::TAllocate<i32>(Memory::Array, FontGlyphCount);
+    for (u32 i = 0; i < FontGlyphCount; ++i) {
+        GlyphCodepoints[i] = -1;
     }
-    variant.KerningCount= stbtt_GetKerningTableLength(&lookup.info);
+    for (i32 codepoint = 32; codepoint < 0x10000; ++codepoint) {
+        const i32 GlyphIndex = stbtt_FindGlyphIndex(&lookup.info, codepoint);
+        if (GlyphIndex > 0 && (u32)GlyphIndex < FontGlyphCount && GlyphCodepoints[GlyphIndex] < 0) {
+            GlyphCodepoints[GlyphIndex] = codepoint;
+        }
+    }
+
+    const auto KerningCodepoint = [&](i32 GlyphIndex) { return (u32)GlyphIndex < FontGlyphCount ? GlyphCodepoints[GlyphIndex] : -1; };
+    for (u32 i = 0; i < EntryCount; ++i) {
+        if (KerningCodepoint(KerningTable[i].glyph1) >= 0 && KerningCodepoint(KerningTable[i].glyph2) >= 0) {
+            variant.KerningCount++;
+        }
+    }
+
     if (variant.KerningCount) {
         variant.kernings = MemorySystem::TAllocate<FontKerning>(Memory::Array, variant.KerningCount);
-        // Получите таблицу кернинга для текущего шрифта.
-        stbtt_kerningentry* KerningTable = MemorySystem::TAllocate<stbtt_kerningentry>(Memory::Array, variant.KerningCount);
-        u32 EntryCount = stbtt_GetKerningTable(&lookup.info, KerningTable, variant.KerningCount);
-        if (EntryCount != variant.KerningCount) {
-            MERROR("Несоответствие количества записей кернинга: %i->%i", EntryCount, variant.KerningCount);
-            return false;
+        u32 k = 0;
+        for (u32 i = 0; i < EntryCount; ++i) {
+            const i32 Codepoint0 = KerningCodepoint(KerningTable[i].glyph1);
+            const i32 Codepoint1 = KerningCodepoint(KerningTable[i].glyph2);
+            if (Codepoint0 < 0 || Codepoint1 < 0) {
+                continue;
+            }
+            auto& kerning = variant.kernings[k++];
+            kerning.Codepoint0 = Codepoint0;
+            kerning.Codepoint1 = Codepoint1;
+            // Смещение в таблице задано в единицах шрифта.
+            const f32 amount = KerningTable[i].advance * InternalData->scale;
+            kerning.amount = (i16)(amount + (amount < 0.F ? -0.5F : 0.5F));
         }
+    }
+
+    MemorySystem::Free(GlyphCodepoints, sizeof(i32) * FontGlyphCount, Memory::Array);
+    MemorySystem::Free(KerningTable, sizeof(stbtt_kerningentry) * EntryCount, Memory::Array);
+
+    // Глифы уже добавлены в таблицы по одному; полное построение нужно только для таблицы кернинга.
+    variant.BuildLookup();
+
+    return true;
+}
+
+bool FontSystem::ReportBakeModes(const char *FontName, const u16 *sizes, u32 count)
+{
+    u16 id = INVALID::U16ID;
+    if (!state->systemFontLookup.Get(FontName, &id) || id == INVALID::U16ID) {
+        MERROR("Системный шрифт с именем '%s' не найден. Сравнение режимов запекания не выполнено.", FontName);
+        return false;
+    }
+    auto& lookup = state->SystemFonts[id];
 
-        for (u32 i = 0; i < variant.KerningCount; ++i) {
-            auto k = variant.kernings[i];
-            k.Codepoint0 = KerningTable[i].glyph1;
-            k.Codepoint1 = KerningTable[i].glyph2;
-            k.amount = KerningTable[i].advance;
+    // MSDF: один атлас на все размеры.
+    Clock clock;
+    clock.Start();
+    if (!AcquireSystemFontMsdf(lookup, id)) {
+        return false;
+    }
+    clock.Update();
+    const f64 MsdfTime = clock.elapsed;
+    const u64 MsdfBytes = (u64)lookup.msdf.AtlasSizeX * lookup.msdf.AtlasSizeY * 4;
+    const u32 MsdfGlyphCount = lookup.msdf.GlyphCount;
+
+    // Растровые глифы того же набора для каждого размера, упакованные так же плотно, как MSDF.
+    MINFO("Запекание шрифта '%s', %u глифов:", FontName, MsdfGlyphCount);
+    u64 BitmapBytes = 0;
+    f64 BitmapTime = 0.0;
+    i32 x0, y0, x1, y1;
+    stbtt_GetFontBoundingBox(&lookup.info, &x0, &y0, &x1, &y1);
+    for (u32 s = 0; s < count; ++s) {
+        clock.Start();
+        const f32 scale = stbtt_ScaleForPixelHeight(&lookup.info, (f32)sizes[s]);
+        const u16 MaxWidth = (u16)((x1 - x0) * scale) + 2;
+        const u16 MaxHeight = (u16)((y1 - y0) * scale) + 2;
+        u8* GlyphPixels = MemorySystem::TAllocate<u8>(Memory::Array, MaxWidth * MaxHeight);
+        DArray<FontGlyph> glyphs;
+        FontGlyph glyph;
+        RasterizeSystemGlyph(lookup.info, scale, -1, MaxWidth, MaxHeight, glyph, GlyphPixels);
+        glyphs.PushBack(glyph);
+        for (const auto& range : FontMsdfRanges) {
+            for (i32 codepoint = range[0]; codepoint <= range[1]; ++codepoint) {
+                if (stbtt_FindGlyphIndex(&lookup.info, codepoint) > 0) {
+                    RasterizeSystemGlyph(lookup.info, scale, codepoint, MaxWidth, MaxHeight, glyph, GlyphPixels);
+                    glyphs.PushBack(glyph);
+                }
+            }
         }
-    } else {
-        variant.kernings = nullptr;
+        FontData font;
+        GlyphAtlas atlas;
+        const bool packed = PackFontGlyphs(atlas, font, glyphs, MMAX(MaxWidth, MaxHeight));
+        clock.Update();
+
+        const u64 bytes = (u64)font.AtlasSizeX * font.AtlasSizeY * 4;
+        MINFO("  растровый %3u px: атлас %ix%i, %llu КиБ, %.2f мс%s", sizes[s], font.AtlasSizeX, font.AtlasSizeY, bytes / 1024, clock.elapsed * 1000.0, packed ? "" : " (не поместился)");
+        BitmapBytes += bytes;
+        BitmapTime += clock.elapsed;
+
+        atlas.Destroy();
+        font.DestroyLookup();
+        font.glyphs = nullptr;
+        glyphs.Destroy();
+        MemorySystem::Free(GlyphPixels, MaxWidth * MaxHeight, Memory::Array);
     }
 
+    MINFO("  растровые, %u размеров: %llu КиБ, %.2f мс", count, BitmapBytes / 1024, BitmapTime * 1000.0);
+    MINFO("  MSDF, все размеры: атлас %ix%i, %llu КиБ, %.2f мс", lookup.msdf.AtlasSizeX, lookup.msdf.AtlasSizeY, MsdfBytes / 1024, MsdfTime * 1000.0);
     return true;
 }
 
-static bool VerifySystemFontSizeVariant(SystemFontLookup &lookup, FontData *variant, const char *text)
+bool FontSystem::VerifySystemFontSizeVariant(SystemFontLookup &lookup, FontData *variant, const char *text)
 {
     auto InternalData = reinterpret_cast<SystemFontVariantData*>(variant->InternalData);
 
+    SystemFontGlyphJobParams params;
+    params.info = &lookup.info;
+    params.FontID = InternalData->FontID;
+    params.size = variant->size;
+    params.scale = InternalData->scale;
+    params.MaxGlyphWidth = InternalData->MaxGlyphWidth;
+    params.MaxGlyphHeight = InternalData->MaxGlyphHeight;
+    params.count = 0;
+
+    const u32 ResultDataSize = sizeof(SystemFontGlyphJobResult) + FONT_GLYPH_JOB_BATCH * InternalData->MaxGlyphWidth * InternalData->MaxGlyphHeight;
+
     u32 CharLength = MString::Length(text);
-    u32 AddedCodepointCount = 0;
     for (u32 i = 0; i < CharLength;) {
         i32 codepoint;
         u8 advance;
@@ -570,33 +1009,128 @@ static bool VerifySystemFontSizeVariant(SystemFontLookup &lookup, FontData *vari
             MERROR("MString::BytesToCodepoint не удалось получить кодовую точку.");
             ++i;
             continue;
-        } else {
-            // Проверьте, содержится ли уже кодовая точка. 
-            // Обратите внимание, что кодовые точки ascii всегда включены, поэтому их проверку можно пропустить.
-            i += advance;
-            if (codepoint < 128) {
-                continue;
-            }
-            const auto& CodepointCount = InternalData->codepoints.Length();
-            bool found = false;
-            for (u32 j = 95; j < CodepointCount; ++j) {
-                if (InternalData->codepoints[j] == codepoint) {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) {
-                InternalData->codepoints.PushBack(codepoint);
-                AddedCodepointCount++;
-            }
+        }
+        i += advance;
+
+        // Глиф уже в атласе, уже растеризуется или отсутствует в шрифте — тогда текст покажет неизвестный глиф.
+        if (variant->GetGlyph(codepoint)) {
+            continue;
+        }
+        bool pending = false;
+        const u32 PendingCount = InternalData->PendingCodepoints.Length();
+        for (u32 j = 0; j < PendingCount && !pending; ++j) {
+            pending = InternalData->PendingCodepoints[j] == codepoint;
+        }
+        if (pending || stbtt_FindGlyphIndex(&lookup.info, codepoint) == 0) {
+            continue;
+        }
+
+        InternalData->PendingCodepoints.PushBack(codepoint);
+        params.codepoints[params.count++] = codepoint;
+        if (params.count == FONT_GLYPH_JOB_BATCH) {
+            Job::Info job { SystemFontGlyphJobStart, GlyphJobSuccess, GlyphJobFail, &params, sizeof(params), ResultDataSize };
+            JobSystem::Submit(job);
+            params.count = 0;
         }
     }
 
-    // Если были добавлены кодовые точки, перестройте атлас. 
-    if (AddedCodepointCount > 0) {
-        return RebuildSystemFontVariantAtlas(lookup, *variant);
+    if (params.count) {
+        Job::Info job { SystemFontGlyphJobStart, GlyphJobSuccess, GlyphJobFail, &params, sizeof(params), ResultDataSize };
+        JobSystem::Submit(job);
     }
 
-    // В противном случае продолжайте как обычно.
     return true;
 }
+
+static bool SystemFontGlyphJobStart(void *ParamData, void *ResultData)
+{
+    auto params = reinterpret_cast<SystemFontGlyphJobParams*>(ParamData);
+    auto result = reinterpret_cast<SystemFontGlyphJobResult*>(ResultData);
+    result->FontID = params->FontID;
+    result->size = params->size;
+    result->count = params->count;
+    result->GlyphPixelSize = params->MaxGlyphWidth * params->MaxGlyphHeight;
+
+    // Данные шрифта только читаются, поэтому растеризация не мешает основному потоку.
+    u8* pixels = reinterpret_cast<u8*>(result + 1);
+    for (u32 i = 0; i < params->count; ++i) {
+        RasterizeSystemGlyph(*params->info, params->scale, params->codepoints[i], params->MaxGlyphWidth, params->MaxGlyphHeight, result->glyphs[i], pixels + i * result->GlyphPixelSize);
+    }
+    return true;
+}
+
+FontData *FontSystem::FindSystemFontVariant(u16 FontID, u16 size)
+{
+    if (FontID >= state->config.MaxSystemFontCount || state->SystemFonts[FontID].id == INVALID::U16ID) {
+        return nullptr;
+    }
+    auto& lookup = state->SystemFonts[FontID];
+    const u32 count = lookup.SizeVariants.Length();
+    for (u32 i = 0; i < count; ++i) {
+        if (lookup.SizeVariants[i].size == size) {
+            return &lookup.SizeVariants[i];
+        }
+    }
+    return nullptr;
+}
+
+void FontSystem::GlyphJobSuccess(void *ResultData)
+{
+    auto result = reinterpret_cast<SystemFontGlyphJobResult*>(ResultData);
+    auto variant = FindSystemFontVariant(result->FontID, result->size);
+    if (!variant) {
+        return;
+    }
+    auto InternalData = reinterpret_cast<SystemFontVariantData*>(variant->InternalData);
+
+    // Освобождать можно только страницы, не рисовавшиеся ни в этом, ни в прошлом кадре.
+    const u64 EvictBefore = state->FrameStamp > 1 ? state->FrameStamp - 1 : 0;
+    const u8* pixels = reinterpret_cast<const u8*>(result + 1);
+    for (u32 i = 0; i < result->count; ++i) {
+        const auto& glyph = result->glyphs[i];
+        RemovePendingCodepoint(*InternalData, glyph.codepoint);
+        if (variant->GetGlyph(glyph.codepoint)) {
+            continue;
+        }
+
+        const FontGlyph* placed = InternalData->atlas.Add(*variant, glyph, state->FrameStamp, EvictBefore);
+        if (!placed) {
+            MWARN("Атлас шрифта '%s' размера %u занят глифами последних кадров; глиф U+%04X не размещен.", variant->face, variant->size, glyph.codepoint);
+            continue;
+        }
+
+        // Записывается и пустая полоса справа и снизу: на месте освобожденной страницы могли остаться чужие пиксели.
+        const u32 width = placed->width + GLYPH_ATLAS_PADDING;
+        const u32 height = placed->height + GLYPH_ATLAS_PADDING;
+        const u32 RegionSize = width * height * 4;
+        u8* RgbaPixels = reinterpret_cast<u8*>(MemorySystem::Allocate(RegionSize, Memory::Array, true));
+        CopySystemGlyphPixels(*placed, pixels + i * result->GlyphPixelSize, RgbaPixels, width);
+        TextureSystem::WriteRegion(variant->atlas.texture, placed->x, placed->y, width, height, RgbaPixels);
+        MemorySystem::Free(RgbaPixels, RegionSize, Memory::Array);
+    }
+}
+
+void FontSystem::GlyphJobFail(void *ResultData)
+{
+    auto result = reinterpret_cast<SystemFontGlyphJobResult*>(ResultData);
+    auto variant = FindSystemFontVariant(result->FontID, result->size);
+    if (!variant) {
+        return;
+    }
+    auto InternalData = reinterpret_cast<SystemFontVariantData*>(variant->InternalData);
+    for (u32 i = 0; i < result->count; ++i) {
+        RemovePendingCodepoint(*InternalData, result->glyphs[i].codepoint);
+    }
+}
+
+static void RemovePendingCodepoint(SystemFontVariantData &data, i32 codepoint)
+{
+    const u32 count = data.PendingCodepoints.Length();
+    for (u32 i = 0; i < count; ++i) {
+        if (data.PendingCodepoints[i] == codepoint) {
+            data.PendingCodepoints[i] = data.PendingCodepoints[count - 1];
+            data.PendingCodepoints.PopBack();
+            return;
+        }
+    }
+}
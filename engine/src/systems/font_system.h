@@ -1,14 +1,18 @@
 #pragma once
 #include "containers/mstring.hpp"
 #include "containers/hashtable.hpp"
+#include "renderer/renderbuffer.h"
 
 struct Text;
+struct FontData;
+struct FrameData;
 
 struct SystemFontConfig {
     MString name        {};
     u16 DefaultSize     {};
     MString ResourceName{};
-    constexpr SystemFontConfig(MString&& name, u16 DefaultSize, MString&& ResourceName) : name(static_cast<MString&&>(name)), DefaultSize(DefaultSize), ResourceName(static_cast<MString&&>(ResourceName)) {}
+    bool msdf           {};  // Запечь атлас MSDF при загрузке, а не при первом получении текста в этом режиме.
+    constexpr SystemFontConfig(MString&& name, u16 DefaultSize, MString&& ResourceName, bool msdf = false) : name(static_cast<MString&&>(name)), DefaultSize(DefaultSize), ResourceName(static_cast<MString&&>(ResourceName)), msdf(msdf) {}
     void* operator new(u64 size)              { return MemorySystem::Allocate(size, Memory::SystemFont); }
     void operator delete(void* ptr, u64 size) { MemorySystem::Free(ptr, size, Memory::SystemFont); }
 };
@@ -46,6 +50,9 @@ private:
     SystemFontLookup* SystemFonts{nullptr};
     [[maybe_unused]]void* BitmapHashTableBlock   {nullptr};
     [[maybe_unused]]void* SystemHashtableBlock   {nullptr};
+    RenderBuffer QuadIndices            {};  // Общий буфер индексов четырехугольников глифов для всех текстов.
+    u32 QuadIndexCapacity               {};  // Количество четырехугольников, индексы которых загружены в общий буфер.
+    u64 FrameStamp                      {};  // Номер кадра для отметок использования страниц атласов глифов.
 
     static FontSystem* state;
 
@@ -55,19 +62,23 @@ private:
     systemFontLookup(config.MaxBitmapFontCount, false, SystemHashtableBlock, true, INVALID::U16ID),
     BitmapFonts(BitmapFonts), SystemFonts(SystemFonts),
     BitmapHashTableBlock(BitmapHashTableBlock),
-    SystemHashtableBlock(SystemHashtableBlock) {}
+    SystemHashtableBlock(SystemHashtableBlock),
+    QuadIndices(),
+    QuadIndexCapacity(),
+    FrameStamp() {}
 public:
     ~FontSystem() = default;
 
     static bool Initialize(u64& MemoryRequirement, void* memory, void* config);
     static void Shutdown();
+    static bool Update(void* state, const FrameData& rFrameData);
 
-    static bool LoadFont(SystemFontConfig& config);
+    MAPI static bool LoadFont(SystemFontConfig& config);
     static bool LoadFont(BitmapFontConfig& config);
 
     /// @brief Пытается получить шрифт с указанным именем и назначить его указанному Text.
     /// @param FontName Имя шрифта для получения. Должен быть уже загруженным шрифтом.
-    /// @param FontSize Размер шрифта. Игнорируется для растровых шрифтов.
+    /// @param FontSize Размер шрифта. Игнорируется для растровых шрифтов; для MSDF задает масштаб общего атласа.
     /// @param text Указатель на текстовый объект, для которого необходимо получить шрифт.
     /// @return True в случае успеха; в противном случае false.
     static bool Acquire(const char* FontName, u16 FontSize, Text& text);
@@ -76,5 +87,35 @@ public:
     /// @return True в случае успеха; в противном случае false.
     static bool Release(Text& text);
 
-    static bool VerifyAtlas(struct FontData* font, const char* text);
+    /// @brief Проверяет, что в атласе шрифта есть глифы всех кодовых точек текста. Недостающие глифы системного шрифта
+    /// растеризуются заданиями и появляются в атласе в следующих кадрах; до тех пор текст показывает неизвестный глиф.
+    /// @param font шрифт.
+    /// @param text строка UTF-8.
+    /// @return true в случае успеха; в противном случае false.
+    static bool VerifyAtlas(FontData* font, const char* text);
+
+    /// @brief Отмечает страницы атласа глифов, которые текст рисует в текущем кадре, чтобы их не освободили.
+    /// @param font шрифт.
+    /// @param PageMask маска страниц, по биту на страницу.
+    static void TouchGlyphPages(FontData* font, u32 PageMask);
+
+    /// @brief Возвращает общий буфер индексов четырехугольников глифов, вмещающий не меньше заданного количества.
+    /// Вершины всех текстов раскладываются по одному шаблону, поэтому индексы создаются один раз и буфер только растет.
+    /// @param QuadCount количество четырехугольников.
+    /// @return указатель на буфер индексов; nullptr, если буфер не удалось создать или расширить.
+    static RenderBuffer* QuadIndexBuffer(u32 QuadCount);
+
+    /// @brief Сравнивает запекание системного шрифта растровыми атласами по размерам и одним атласом MSDF:
+    /// память атласов и время запекания одного набора глифов выводятся в журнал.
+    /// @param FontName имя загруженного системного шрифта.
+    /// @param sizes размеры растровых атласов.
+    /// @param count количество размеров.
+    /// @return true в случае успеха; в противном случае false.
+    MAPI static bool ReportBakeModes(const char* FontName, const u16* sizes, u32 count);
+private:
+    static bool VerifySystemFontSizeVariant(SystemFontLookup& lookup, FontData* variant, const char* text);
+    static FontData* FindSystemFontVariant(u16 FontID, u16 size);
+    /// @brief Размещает в атласе глифы, растеризованные заданием, и записывает их области текстуры. Вызывается в основном потоке.
+    static void GlyphJobSuccess(void* ResultData);
+    static void GlyphJobFail(void* ResultData);
 };
@@ -3,6 +3,7 @@
 #include "renderer/rendering_system.h"
 #include "math/geometry_utils.h"
 #include "memory/linear_allocator.h"
+#include "core/event.h"
 #include <new>
 #include "resources/geometry.h"
 
@@ -53,6 +54,8 @@ bool GeometrySystem::Initialize(u64& MemoryRequirement, void* memory, void* conf
         state = new(PtrGeometrySystem) GeometrySystem(pConfig->MaxGeometryCount, ArrayBlock);
     }
 
+    EventSystem::Register(EventSystem::RenderUploadsCompleted, nullptr, OnUploadsCompleted);
+
     if (!state->CreateDefaultGeometries()) {
         MFATAL("Не удалось создать геометрию по умолчанию. Приложение не может быть продолжено.");
         return false;
@@ -63,9 +66,21 @@ bool GeometrySystem::Initialize(u64& MemoryRequirement, void* memory, void* conf
 
 void GeometrySystem::Shutdown()
 {
+    EventSystem::Unregister(EventSystem::RenderUploadsCompleted, nullptr, OnUploadsCompleted);
     state = nullptr;
 }
 
+bool GeometrySystem::OnUploadsCompleted(u16 code, void *sender, void *ListenerInst, EventContext context)
+{
+    if (state && state->UploadBurstCount && context.data.u64[0] >= state->UploadTicket) {
+        state->UploadBurstClock.Update();
+        MDEBUG("Геометрия загружена в GPU: %u за %.2f мс.", state->UploadBurstCount, state->UploadBurstClock.elapsed * 1000.0);
+        state->UploadBurstCount = 0;
+    }
+    // Событие также нужно системе текстур.
+    return false;
+}
+
 GeometryConfig GeometrySystem::GeneratePlaneConfig(f32 width, f32 height, u32 xSegmentCount, u32 ySegmentCount, f32 TileX, f32 TileY, const char *name, const char *MaterialName)
 {
     if (width == 0) {
@@ -335,6 +350,16 @@ bool GeometrySystem::CreateGeometry(GeometryConfig &config, Geometry *geometry)
         return false;
     }
 
+    // Учесть загрузку в текущей серии загрузок GPU.
+    const u64 ticket = RenderingSystem::UploadTicket();
+    if (ticket) {
+        if (!state->UploadBurstCount) {
+            state->UploadBurstClock.Start();
+        }
+        state->UploadBurstCount++;
+        state->UploadTicket = ticket;
+    }
+
     // Копирование экстентов, центра и т.д.
     geometry->center = config.center;
     geometry->extents.min = config.MinExtents;
@@ -2,9 +2,12 @@
 
 #include "resources/geometry.h"
 #include "resources/material.h"
+#include "core/clock.h"
 
 #define DEFAULT_GEOMETRY_NAME "default"
 
+struct EventContext;
+
 /// @brief Конфигурация геометрической системы.
 struct GeometrySystemConfig {
     /// @brief ПРИМЕЧАНИЕ: Должна быть значительно больше, чем количество статических сеток, 
@@ -26,10 +29,19 @@ private:
     // Массив зарегистрированных сеток.
     struct GeometryReference* RegisteredGeometries{nullptr};
 
+    // Номер пакета загрузок GPU с последней загруженной геометрией, см. RenderingSystem::UploadTicket.
+    u64 UploadTicket{};
+    // Количество геометрий в текущей серии загрузок. 0, если все загрузки завершены на GPU.
+    u32 UploadBurstCount{};
+    // Время от первой загрузки серии до ее завершения на GPU.
+    Clock UploadBurstClock{};
+
     MAPI static GeometrySystem* state;
 
     GeometrySystem(u32 MaxGeometryCount, GeometryReference* RegisteredGeometries);
     ~GeometrySystem() {}
+
+    static bool OnUploadsCompleted(u16 code, void* sender, void* ListenerInst, EventContext context);
 public:
     GeometrySystem(const GeometrySystem&) = delete;
     GeometrySystem& operator= (const GeometrySystem&) = delete;
@@ -3,6 +3,8 @@
 #include "core/memory_system.h"
 #include "core/mthread.hpp"
 #include "core/mmutex.hpp"
+#include "core/msemaphore.hpp"
+#include "core/profiler.h"
 #include <new>
 
 struct JobThread {
@@ -11,6 +13,8 @@ struct JobThread {
         Job::Info info;
         // Мьютекс для защиты доступа к информации этого потока.
         MMutex InfoMutex;
+        // Сигнализируется при назначении потоку задания, чтобы он не опрашивал info.
+        MSemaphore wake;
 
         // Типы задач, которые может выполнять этот поток.
         u32 TypeMask;
@@ -100,6 +104,9 @@ u32 JobThreadRun(void *params)
     auto& thread = pJobSystem->JobThreads[index];
     const u64& ThreadID = thread.thread.ThreadID;
     MTRACE("Запуск потока заданий #%i (id=%#x, type=%#x).", thread.index, ThreadID, thread.TypeMask);
+    char ThreadName[32];
+    MString::Format(ThreadName, "Задания #%u", thread.index);
+    Profiler::SetThreadName(ThreadName);
 
     // Мьютекс для блокировки информации для этого потока.
     if (!thread.InfoMutex) {
@@ -123,7 +130,11 @@ u32 JobThreadRun(void *params)
         }
 
         if (info.EntryPoint) {
-            bool result = info.EntryPoint(info.ParamData, info.ResultData);
+            bool result;
+            {
+                MPROFILE_SCOPE("JobSystem::Job");
+                result = info.EntryPoint(info.ParamData, info.ResultData);
+            }
 
             // Сохраните результат для выполнения в основном потоке позже.
             // Обратите внимание, что StoreResult принимает копию ResultData, 
@@ -150,12 +161,13 @@ u32 JobThreadRun(void *params)
             if (!thread.InfoMutex.Unlock()) {
                 MERROR("Не удалось снять блокировку мьютекса потока задания!");
             }
+            // Новое задание могло быть назначено, пока выполнялось это.
+            continue;
         }
 
         if (pJobSystem->running) {
-            // ЗАДАЧА: Вероятно, следует найти лучший способ сделать это, например, 
-            // заснуть, пока не поступит запрос на новое задание.
-            thread.thread.Sleep(10);
+            // Спать, пока не поступит новое задание.
+            thread.wake.Wait();
         } else {
             break;
         }
@@ -231,6 +243,7 @@ void JobSystem::Shutdown()
 
         // Сначала проверьте наличие свободного потока.
         for (u8 i = 0; i < ThreadCount; ++i) {
+            pJobSystem->JobThreads[i].wake.Signal();
             pJobSystem->JobThreads[i].thread.~MThread();
         }
         pJobSystem->LowPriorityQueue.~RingQueue();
@@ -285,6 +298,7 @@ void ProcessQueue(RingQueue& queue, MMutex& QueueMutex) {
 
             // Остановитесь после разблокировки, если был найден доступный поток.
             if (ThreadFound) {
+                thread.wake.Signal();
                 break;
             }
         }
@@ -340,6 +354,34 @@ bool JobSystem::Update(void* state, const FrameData& rFrameData)
     return true;
 }
 
+/// @brief Передает задание свободному потоку, поддерживающему его тип, минуя очередь.
+/// @return true, если свободный поток найден и разбужен; в противном случае false.
+static bool AssignToFreeThread(Job::Info& info)
+{
+    for (u8 i = 0; i < pJobSystem->ThreadCount; ++i) {
+        auto& thread = pJobSystem->JobThreads[i];
+        if (thread.TypeMask & info.type) {
+            bool found = false;
+            if (!thread.InfoMutex.Lock()) {
+                MERROR("Не удалось получить блокировку мьютекса потока задания!");
+            }
+            if (!thread.info.EntryPoint) {
+                MTRACE("Задание немедленно отправлено в поток %i", thread.index);
+                thread.info = info;
+                found = true;
+            }
+            if (!thread.InfoMutex.Unlock()) {
+                MERROR("Не удалось снять блокировку мьютекса потока задания!");
+            }
+            if (found) {
+                thread.wake.Signal();
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 MAPI void JobSystem::Submit(Job::Info &info)
 {
     auto* queue = &pJobSystem->NormalPriorityQueue;
@@ -351,25 +393,8 @@ MAPI void JobSystem::Submit(Job::Info &info)
         QueueMutex = &pJobSystem->HighPriQueueMutex;
 
         // Сначала проверьте наличие свободного потока, который поддерживает тип задания.
-        for (u8 i = 0; i < pJobSystem->ThreadCount; ++i) {
-            auto& thread = pJobSystem->JobThreads[i];
-            if (thread.TypeMask & info.type) {
-                bool found = false;
-                if (!thread.InfoMutex.Lock()) {
-                    MERROR("Не удалось получить блокировку мьютекса потока задания!");
-                }
-                if (!pJobSystem->JobThreads[i].info.EntryPoint) {
-                    MTRACE("Задание немедленно отправлено в поток %i", pJobSystem->JobThreads[i].index);
-                    pJobSystem->JobThreads[i].info = info;
-                    found = true;
-                }
-                if (!thread.InfoMutex.Unlock()) {
-                    MERROR("Не удалось снять блокировку мьютекса потока задания!");
-                }
-                if (found) {
-                    return;
-                }
-            }
+        if (AssignToFreeThread(info)) {
+            return;
         }
     }
 
@@ -390,3 +415,99 @@ MAPI void JobSystem::Submit(Job::Info &info)
     }
     MTRACE("Задание поставлено в очередь.");
 }
+
+MAPI void JobSystem::SubmitNow(Job::Info &info)
+{
+    if (info.priority != Job::High && AssignToFreeThread(info)) {
+        return;
+    }
+    Submit(info);
+}
+
+/// @brief Общее состояние одного вызова ParallelFor. Живет на стеке вызывающего потока, который дожидается всех помощников.
+struct ParallelForContext {
+    PFN_ParallelRange function;
+    void* UserData;
+    u32 count;
+    u32 grain;
+    u32 RangeCount;
+    u32 NextRange;      // Следующий диапазон, который возьмет свободный поток. Изменяется атомарно.
+    MSemaphore done;    // Сигнализируется каждым потоком-помощником по завершении.
+};
+
+/// @brief Берет свободные диапазоны по одному и обрабатывает их, пока диапазоны не закончатся.
+static void ParallelForRun(ParallelForContext& context)
+{
+    while (true) {
+        const u32 range = __atomic_fetch_add(&context.NextRange, 1, __ATOMIC_ACQ_REL);
+        if (range >= context.RangeCount) {
+            break;
+        }
+        MPROFILE_SCOPE("JobSystem::ParallelFor");
+        const u32 begin = range * context.grain;
+        context.function(context.UserData, begin, MMIN(begin + context.grain, context.count));
+    }
+}
+
+static bool ParallelForJob(void* params, void* ResultData)
+{
+    auto context = *reinterpret_cast<ParallelForContext**>(params);
+    ParallelForRun(*context);
+    context->done.Signal();
+    return true;
+}
+
+MAPI void JobSystem::ParallelFor(u32 count, u32 grain, PFN_ParallelRange function, void *UserData)
+{
+    if (!count) {
+        return;
+    }
+    grain = MMAX(grain, 1u);
+
+    ParallelForContext context;
+    context.function = function;
+    context.UserData = UserData;
+    context.count = count;
+    context.grain = grain;
+    context.RangeCount = (count - 1) / grain + 1;
+    context.NextRange = 0;
+
+    // Помощники назначаются только свободным потокам, минуя очереди: задание из очереди запустилось бы 
+    // лишь в следующем JobSystem::Update, а вызывающий поток ждет их здесь.
+    u32 HelperCount = 0;
+    if (pJobSystem && pJobSystem->running && context.RangeCount > 1) {
+        auto pContext = &context;
+        for (u8 i = 0; i < pJobSystem->ThreadCount && HelperCount < context.RangeCount - 1; ++i) {
+            auto& thread = pJobSystem->JobThreads[i];
+            if ((thread.TypeMask & Job::General) == 0) {
+                continue;
+            }
+            bool found = false;
+            if (!thread.InfoMutex.Lock()) {
+                MERROR("Не удалось получить блокировку мьютекса потока задания!");
+            }
+            if (!thread.info.EntryPoint) {
+                thread.info = Job::Info(ParallelForJob, nullptr, nullptr, &pContext, sizeof(pContext), 0, Job::General, Job::High);
+                found = true;
+            }
+            if (!thread.InfoMutex.Unlock()) {
+                MERROR("Не удалось снять блокировку мьютекса потока задания!");
+            }
+            if (found) {
+                thread.wake.Signal();
+                HelperCount++;
+            }
+        }
+    }
+
+    // Вызывающий поток обрабатывает диапазоны наравне с помощниками.
+    ParallelForRun(context);
+    for (u32 i = 0; i < HelperCount; ++i) {
+        context.done.Wait();
+    }
+}
+
+MAPI u8 JobSystem::GetThreadCount()
+{
+    return pJobSystem && pJobSystem->running ? pJobSystem->ThreadCount : 0;
+}
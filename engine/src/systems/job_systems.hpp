@@ -13,6 +13,9 @@ typedef bool (*PFN_JobStart)(void*, void*);
 /// @brief Определение указателя функции для завершения задания.
 typedef void (*PFN_JobOnComplete)(void*);
 
+/// @brief Определение указателя функции, обрабатывающей диапазон [begin, end) в JobSystem::ParallelFor.
+typedef void (*PFN_ParallelRange)(void* UserData, u32 begin, u32 end);
+
 struct FrameData;
 
 namespace Job {
@@ -88,4 +91,18 @@ namespace JobSystem
     /// @brief Отправляет предоставленное задание в очередь на выполнение.
     /// @param info Описание задания, которое должно быть выполнено.
     MAPI void Submit(Job::Info& info);
+    /// @brief Отправляет задание свободному потоку сразу, не дожидаясь следующего обновления, независимо от приоритета.
+    /// Если свободных потоков нет, задание ставится в очередь, как в Submit. Может вызываться из любого потока.
+    /// @param info Описание задания, которое должно быть выполнено.
+    MAPI void SubmitNow(Job::Info& info);
+    /// @brief Разбивает [0, count) на диапазоны по grain элементов и обрабатывает их на вызывающем потоке 
+    /// и на свободных потоках заданий общего типа. Возвращает управление, когда обработаны все диапазоны.
+    /// Занятые потоки не ждутся: без свободных потоков (или без системы заданий) все выполняется на вызывающем потоке.
+    /// @param count количество элементов.
+    /// @param grain количество элементов в одном диапазоне.
+    /// @param function функция, вызываемая для каждого диапазона; может выполняться на нескольких потоках одновременно.
+    /// @param UserData данные, передаваемые в function.
+    MAPI void ParallelFor(u32 count, u32 grain, PFN_ParallelRange function, void* UserData);
+    /// @brief Возвращает количество потоков заданий; 0, если система заданий не запущена.
+    MAPI u8 GetThreadCount();
 };
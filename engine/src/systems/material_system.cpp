@@ -5,6 +5,9 @@
 #include "systems/shader_system.h"
 #include "systems/light_system.h"
 #include "renderer/rendering_system.h"
+#include "core/event.h"
+#include "core/frame_data.h"
+#include "containers/retention_list.hpp"
 
 #include "memory/linear_allocator.h"
 #include <new>
@@ -80,9 +83,14 @@ struct sMaterialSystem
     TerrainShaderLocations TerrainLocations;
     u32 TerrainShaderID;
 
+    u32* WatchIDs;                                          // Идентификаторы наблюдения за файлами зарегистрированных материалов.
+
+    RetentionList retention;                                // Материалы без ссылок, удерживаемые до вытеснения.
+    u32 RetentionEvictionsPerFrame;
+
     /// @brief Инициализирует систему материалов при создании объекта.
-    constexpr sMaterialSystem() : MaxMaterialCount(), DefaultMaterial(), RegisteredMaterials(nullptr), RegisteredMaterialTable(), MaterialLocations(), MaterialShaderID(), UiLocations(), UiShaderID() {}
-    sMaterialSystem(u32 MaxMaterialCount, Material* RegisteredMaterials, MaterialReference* HashTableBlock);
+    constexpr sMaterialSystem() : MaxMaterialCount(), DefaultMaterial(), RegisteredMaterials(nullptr), RegisteredMaterialTable(), MaterialLocations(), MaterialShaderID(), UiLocations(), UiShaderID(), WatchIDs(nullptr), retention(), RetentionEvictionsPerFrame() {}
+    sMaterialSystem(u32 MaxMaterialCount, Material* RegisteredMaterials, MaterialReference* HashTableBlock, u32* WatchIDs);
     ~sMaterialSystem();
 };
 
@@ -93,9 +101,11 @@ static bool CreateDefaultUiMaterial();
 static bool CreateDefaultTerrainMaterial();
 static bool LoadMaterial(const Material::Config& config, Material* m);
 static void DestroyMaterial(Material* material);
-static bool AssignMap(TextureMap& map, const Material::Map& config, const char* MaterialName, Texture* DefaultTex);
+static bool AssignMap(TextureMap& map, const Material::Map& config, const char* MaterialName, Texture* DefaultTex, bool streamed = false);
+static void AssignProperties(const Material::Config& config, Material* material);
+static bool OnWatchedFileWritten(u16 code, void* sender, void* ListenerInst, EventContext context);
 
-sMaterialSystem::sMaterialSystem(u32 MaxMaterialCount, Material* RegisteredMaterials, MaterialReference* HashTableBlock) 
+sMaterialSystem::sMaterialSystem(u32 MaxMaterialCount, Material* RegisteredMaterials, MaterialReference* HashTableBlock, u32* WatchIDs) 
 : 
 MaxMaterialCount(MaxMaterialCount),
 // DefaultMaterial(), 
@@ -104,13 +114,21 @@ RegisteredMaterialTable(MaxMaterialCount, false, HashTableBlock, true, MaterialR
 MaterialLocations(),
 MaterialShaderID(INVALID::ID), 
 UiLocations(),
-UiShaderID(INVALID::ID)
-{}
+UiShaderID(INVALID::ID),
+WatchIDs(WatchIDs),
+retention(),
+RetentionEvictionsPerFrame()
+{
+    for (u32 i = 0; i < MaxMaterialCount; ++i) {
+        WatchIDs[i] = INVALID::ID;
+    }
+}
 
 sMaterialSystem::~sMaterialSystem()
 {
     // Сделать недействительными все материалы в массиве.
     for (u32 i = 0; i < MaxMaterialCount; ++i) { 
+        ResourceSystem::UnwatchFile(WatchIDs[i]);
         if (state->RegisteredMaterials[i].id != INVALID::ID) {
             MTRACE("id%u, generation%u, InternalId%u, %u", RegisteredMaterials[i].id, RegisteredMaterials[i].generation, RegisteredMaterials[i].InternalId, i);
             DestroyMaterial(&state->RegisteredMaterials[i]);
@@ -135,7 +153,9 @@ bool MaterialSystem::Initialize(u64& MemoryRequirement, void* memory, void* conf
     u64 StructRequirement = sizeof(sMaterialSystem);
     u64 ArrayRequirement = sizeof(Material) * pConfig->MaxMaterialCount;
     u64 HashtableRequirement = sizeof(MaterialReference) * pConfig->MaxMaterialCount;
-    MemoryRequirement = StructRequirement + ArrayRequirement + HashtableRequirement;
+    u64 RetentionRequirement = RetentionList::GetMemoryRequirement(pConfig->MaxMaterialCount);
+    u64 WatchRequirement = sizeof(u32) * pConfig->MaxMaterialCount;
+    MemoryRequirement = StructRequirement + ArrayRequirement + HashtableRequirement + RetentionRequirement + WatchRequirement;
 
     if (!memory) {
         return true;
@@ -145,7 +165,11 @@ bool MaterialSystem::Initialize(u64& MemoryRequirement, void* memory, void* conf
         u8* ptrMatSys = reinterpret_cast<u8*>(memory);
         Material* RegisteredMaterials = reinterpret_cast<Material*>(ptrMatSys + StructRequirement);
         MaterialReference* HashTableBlock = reinterpret_cast<MaterialReference*>(RegisteredMaterials + pConfig->MaxMaterialCount);
-        state = new(ptrMatSys) sMaterialSystem(pConfig->MaxMaterialCount, RegisteredMaterials, HashTableBlock);
+        u8* RetentionBlock = reinterpret_cast<u8*>(HashTableBlock + pConfig->MaxMaterialCount);
+        u32* WatchBlock = reinterpret_cast<u32*>(RetentionBlock + RetentionRequirement);
+        state = new(ptrMatSys) sMaterialSystem(pConfig->MaxMaterialCount, RegisteredMaterials, HashTableBlock, WatchBlock);
+        state->retention.Create(pConfig->MaxMaterialCount, pConfig->RetentionBudget, RetentionBlock);
+        state->RetentionEvictionsPerFrame = pConfig->RetentionEvictionsPerFrame > 0 ? pConfig->RetentionEvictionsPerFrame : 1;
     }
 
     if (!CreateDefaultMaterial()) {
@@ -220,17 +244,79 @@ bool MaterialSystem::Initialize(u64& MemoryRequirement, void* memory, void* conf
     state->TerrainLocations.samplers[10]    = ShaderSystem::UniformIndex(shader, "specular_texture_3");
     state->TerrainLocations.samplers[11]    = ShaderSystem::UniformIndex(shader,   "normal_texture_3");
 
+    // Горячая перезагрузка материалов при изменении их файлов.
+    EventSystem::Register(EventSystem::WatchedFileWritten, nullptr, OnWatchedFileWritten);
+
     return true;
 }
 
 void MaterialSystem::Shutdown()
 {
     if (state) {
+        EventSystem::Unregister(EventSystem::WatchedFileWritten, nullptr, OnWatchedFileWritten);
         state->~sMaterialSystem(); // delete state;
         state = nullptr;
     }
 }
 
+/// @brief Оценка объема памяти, занятой материалом, включая текстуры его карт, на которые он удерживает ссылки.
+static u64 MaterialBytes(const Material& material)
+{
+    u64 bytes = sizeof(Material) + material.PropertyStructSize;
+    for (u32 i = 0; i < material.maps.Length(); ++i) {
+        const Texture* texture = material.maps[i].texture;
+        if (texture && texture->generation != INVALID::ID) {
+            bytes += (u64)texture->width * texture->height * texture->ChannelCount;
+        }
+    }
+    return bytes;
+}
+
+/// @brief Вытесняет материал из списка удержания и уничтожает его, освобождая слот массива.
+/// @param slot индекс удерживаемого материала.
+static void EvictRetained(u32 slot)
+{
+    state->retention.Evict(slot);
+
+    // Имя копируется, поскольку уничтожение материала стирает его.
+    char NameCopy[MATERIAL_NAME_MAX_LENGTH];
+    MString::Copy(NameCopy, state->RegisteredMaterials[slot].name, MATERIAL_NAME_MAX_LENGTH);
+
+    ResourceSystem::UnwatchFile(state->WatchIDs[slot]);
+    DestroyMaterial(&state->RegisteredMaterials[slot]);
+
+    MaterialReference ref;
+    if (state->RegisteredMaterialTable.Get(NameCopy, &ref)) {
+        ref.handle = INVALID::ID;
+        ref.AutoRelease = false;
+        state->RegisteredMaterialTable.Set(NameCopy, ref);
+    }
+}
+
+bool MaterialSystem::Update(void*, const FrameData& rFrameData)
+{
+    if (!state) {
+        return true;
+    }
+
+    // Удерживаемые материалы сверх бюджета вытесняются понемногу, чтобы не задерживать кадр. 
+    // Их текстуры освобождаются и сами попадают в список удержания системы текстур.
+    for (u32 i = 0; i < state->RetentionEvictionsPerFrame; ++i) {
+        const u32 slot = state->retention.EvictionCandidate();
+        if (slot == INVALID::ID) {
+            break;
+        }
+        EvictRetained(slot);
+    }
+    return true;
+}
+
+const RetentionList::Stats &MaterialSystem::RetentionStats()
+{
+    static const RetentionList::Stats empty{};
+    return state ? state->retention.GetStats() : empty;
+}
+
 static Material* AcquireReference(const char* name, bool AutoRelease, bool& NeedsCreation)
 {
     MaterialReference ref;
@@ -243,6 +329,7 @@ static Material* AcquireReference(const char* name, bool AutoRelease, bool& Need
         if (ref.handle == INVALID::ID) {
             // Это означает, что здесь нет материала. Сначала найдите свободный индекс.
             u32 count = state->MaxMaterialCount;
+            state->retention.Miss();
             Material* m = nullptr;
             for (u32 i = 0; i < count; ++i) {
                 if (state->RegisteredMaterials[i].id == INVALID::ID) {
@@ -253,6 +340,16 @@ static Material* AcquireReference(const char* name, bool AutoRelease, bool& Need
                 }
             }
 
+            // Свободных слотов нет: слот занимает дольше всех не использованный материал из списка удержания.
+            if (!m) {
+                const u32 slot = state->retention.Oldest();
+                if (slot != INVALID::ID) {
+                    EvictRetained(slot);
+                    ref.handle = slot;
+                    m = &state->RegisteredMaterials[slot];
+                }
+            }
+
             // Убедитесь, что действительно найден пустой слот.
             if (!m || ref.handle == INVALID::ID) {
                 MFATAL("MaterialSystem::Acquire — Система материалов не может больше содержать материалы. Измените конфигурацию, чтобы разрешить больше.");
@@ -266,6 +363,8 @@ static Material* AcquireReference(const char* name, bool AutoRelease, bool& Need
             // KTRACE("Материал '%s' еще не существует. Создан, и ref_count теперь равен %i.", config.name, ref.reference_count);
         } else {
             // KTRACE("Материал '%s' уже существует, ref_count увеличен до %i.", config.name, ref.reference_count);
+            // Материал без ссылок возвращается из списка удержания без загрузки.
+            state->retention.Revive(ref.handle);
             NeedsCreation = false;
         }
 
@@ -291,6 +390,11 @@ Material *MaterialSystem::Acquire(const char* name)
     // Теперь получите из загруженной конфигурации.
     auto material = Acquire(materialResource.data);
 
+    // Наблюдение за файлом материала для горячей перезагрузки.
+    if (material && material->id != INVALID::ID && state->WatchIDs[material->id] == INVALID::ID) {
+        ResourceSystem::WatchFile(materialResource.FullPath.c_str(), state->WatchIDs[material->id]);
+    }
+
     // Очистить
     // ResourceSystem::Unload(materialResource);
 
@@ -415,7 +519,7 @@ Material* MaterialSystem::Acquire(const char* MaterialName, u32 MaterialCount, c
                 MapConfig.FilterMin = RefMat->maps[MapIdx].FilterMinify;
                 MapConfig.FilterMag = RefMat->maps[MapIdx].FilterMagnify;
                 MapConfig.TextureName = RefMat->maps[MapIdx].texture->name;
-                if (!AssignMap(material->maps[(MaterialIdx * 3) + MapIdx], MapConfig, material->name, DefaultTextures[MapIdx])) {
+                if (!AssignMap(material->maps[(MaterialIdx * 3) + MapIdx], MapConfig, material->name, DefaultTextures[MapIdx], true)) {
                     MERROR("Не удалось назначить текстурную карту '%s' для индекса материала ландшафта %u", MapNames[MapIdx], MaterialIdx);
                     return nullptr;
                 }
@@ -479,15 +583,21 @@ void MaterialSystem::Release(const char *name)
 
         ref.ReferenceCount--;
         if (ref.ReferenceCount == 0 && ref.AutoRelease) {
-            auto m = &state->RegisteredMaterials[ref.handle];
-
-            // Уничтожить/сбросить материал.
-            DestroyMaterial(m);
-
-            // Сбросьте ссылку.
-            ref.handle = INVALID::ID;
-            ref.AutoRelease = false;
-            // MTRACE("Выпущенный материал '%s'., Материал выгружен, поскольку количество ссылок = 0 и AutoRelease = true.", NameCopy);
+            // Материал остается загруженным в списке удержания, пока его не вытеснят; 
+            // если удержание выключено или материал больше бюджета, он уничтожается сразу.
+            const bool retained = state->retention.Retain(ref.handle, MaterialBytes(state->RegisteredMaterials[ref.handle]));
+            if (!retained) {
+                auto m = &state->RegisteredMaterials[ref.handle];
+
+                // Уничтожить/сбросить материал.
+                ResourceSystem::UnwatchFile(state->WatchIDs[ref.handle]);
+                DestroyMaterial(m);
+
+                // Сбросьте ссылку.
+                ref.handle = INVALID::ID;
+                ref.AutoRelease = false;
+                // MTRACE("Выпущенный материал '%s'., Материал выгружен, поскольку количество ссылок = 0 и AutoRelease = true.", NameCopy);
+            }
         } else {
             // MTRACE("Выпущенный материал '%s', теперь имеет счетчик ссылок '%i' (AutoRelease=%s).", NameCopy, ref.ReferenceCount, ref.AutoRelease ? "true" : "false");
         }
@@ -683,15 +793,16 @@ void MaterialSystem::Dump()
     }
 }
 
-static bool AssignMap(TextureMap& map, const Material::Map& config, const char* MaterialName, Texture* DefaultTex) {
+static bool AssignMap(TextureMap& map, const Material::Map& config, const char* MaterialName, Texture* DefaultTex, bool streamed) {
     map.FilterMinify = config.FilterMin;
     map.FilterMagnify = config.FilterMag;
     map.RepeatU = config.RepeatU;
-    map.RepeatV = config.RepeatU;
+    map.RepeatV = config.RepeatV;
     map.RepeatW = config.RepeatW;
 
     if (config.TextureName.Length() > 0) {
-        map.texture = TextureSystem::Acquire(config.TextureName.c_str(), true);
+        // Текстуры материалов мира загружаются потоково: их размер на экране сообщает вид мира.
+        map.texture = streamed ? TextureSystem::AcquireStreamed(config.TextureName.c_str(), true) : TextureSystem::Acquire(config.TextureName.c_str(), true);
         if (!map.texture) {
             // Настроено, но не найдено.
             MWARN("Невозможно загрузить текстуру «%s» для материала «%s», используются значения по умолчанию.", config.TextureName.c_str(), MaterialName);
@@ -708,6 +819,164 @@ static bool AssignMap(TextureMap& map, const Material::Map& config, const char*
     return true;
 }
 
+/// @brief Заполняет структуру свойств материала Фонга или пользовательского интерфейса значениями из конфигурации.
+static void AssignProperties(const Material::Config& config, Material* material)
+{
+    switch (material->type) {
+        case Material::Type::Phong: {
+            auto properties = reinterpret_cast<Material::PhongProperties*>(material->properties);
+            // Значения по умолчанию
+            properties->DiffuseColour = FVec4::One();
+            properties->specular = 32.F;
+
+            const u32& PropCount = config.properties.Length();
+            for (u32 i = 0; i < PropCount; ++i) {
+                if (config.properties[i].name.Comparei("diffuse_colour")) {
+                    // Рассеянный цвет
+                    properties->DiffuseColour = config.properties[i].ValueV4;
+                } else if (config.properties[i].name.Comparei("specular")) {
+                    // Блеск
+                    properties->specular = config.properties[i].ValueF32;
+                }
+            }
+        } break;
+        case Material::Type::UI: {
+            // ПРИМЕЧАНИЕ: только одно свойство, поэтому просто используйте первое.
+            auto properties = reinterpret_cast<Material::UiProperties*>(material->properties);
+            properties->DiffuseColour = config.properties.Length() > 0 ? config.properties[0].ValueV4 : FVec4::One();
+        } break;
+        default: break;
+    }
+}
+
+/// @brief Проверяет, что карта текстуры материала совпадает с той, которую создала бы конфигурация.
+/// @param map карта текстуры материала.
+/// @param config конфигурация карты или nullptr, если карта в конфигурации отсутствует.
+/// @param DefaultKind вид текстуры по умолчанию, используемой, если текстура в конфигурации не задана.
+static bool MapMatches(const TextureMap& map, const Material::Map* config, u8 DefaultKind)
+{
+    if (!config) {
+        return map.texture == TextureSystem::GetDefaultTexture(DefaultKind) &&
+            map.FilterMinify == TextureFilter::ModeLinear && map.FilterMagnify == TextureFilter::ModeLinear &&
+            map.RepeatU == TextureRepeat::Repeat && map.RepeatV == TextureRepeat::Repeat && map.RepeatW == TextureRepeat::Repeat;
+    }
+    if (map.FilterMinify != config->FilterMin || map.FilterMagnify != config->FilterMag ||
+        map.RepeatU != config->RepeatU || map.RepeatV != config->RepeatV || map.RepeatW != config->RepeatW) {
+        return false;
+    }
+    if (config->TextureName.Length() == 0) {
+        return map.texture == TextureSystem::GetDefaultTexture(DefaultKind);
+    }
+    return map.texture && MString::Equali(map.texture->name, config->TextureName.c_str());
+}
+
+/// @brief Ищет в конфигурации карту с заданным именем.
+static const Material::Map* FindMapConfig(const Material::Config& config, const char* name)
+{
+    for (u32 i = 0; i < config.maps.Length(); ++i) {
+        if (config.maps[i].name.Comparei(name)) {
+            return &config.maps[i];
+        }
+    }
+    return nullptr;
+}
+
+/// @brief Определяет, отличается ли новая конфигурация от материала только значениями свойств.
+static bool CanReloadInPlace(const Material* material, const Material::Config& config)
+{
+    if (material->type != config.type || !material->properties || ShaderSystem::GetID(config.ShaderName) != material->ShaderID) {
+        return false;
+    }
+
+    switch (config.type) {
+        case Material::Type::Phong:
+            return material->maps.Length() == 3 &&
+                MapMatches(material->maps[0], FindMapConfig(config, "diffuse"), Texture::Diffuse) &&
+                MapMatches(material->maps[1], FindMapConfig(config, "specular"), Texture::Specular) &&
+                MapMatches(material->maps[2], FindMapConfig(config, "normal"), Texture::Normal);
+        case Material::Type::UI:
+            return material->maps.Length() == 1 && config.maps.Length() > 0 &&
+                MapMatches(material->maps[0], &config.maps[0], Texture::Diffuse);
+        default:
+            // Структура свойств пользовательских материалов зависит от конфигурации.
+            return false;
+    }
+}
+
+bool MaterialSystem::Reload(Material *material, const Material::Config &config)
+{
+    if (!material || material->id == INVALID::ID) {
+        MERROR("MaterialSystem::Reload требуется действительный зарегистрированный материал.");
+        return false;
+    }
+
+    // Изменились только свойства: структура обновляется на месте, ресурсы рендерера и текстуры не затрагиваются.
+    if (CanReloadInPlace(material, config)) {
+        AssignProperties(config, material);
+        material->generation++;
+        MTRACE("Свойства материала '%s' обновлены на месте.", material->name);
+        return true;
+    }
+
+    // Иначе материал собирается заново во временный объект. Новые текстуры получаются до освобождения старых,
+    // поэтому неизмененные текстуры не перезагружаются. При ошибке материал остается прежним.
+    Material temp;
+    if (!LoadMaterial(config, &temp)) {
+        MERROR("MaterialSystem::Reload: не удалось перезагрузить материал '%s'. Материал не изменен.", material->name);
+        temp.InternalId = INVALID::ID;
+        DestroyMaterial(&temp);
+        return false;
+    }
+
+    // Материал остается в том же слоте, поэтому указатели на него, хранимые геометриями, остаются действительными.
+    const u32 id = material->id;
+    const u32 generation = material->generation;
+    DestroyMaterial(material);
+    MemorySystem::CopyMem(material, &temp, sizeof(Material));
+    MemorySystem::ZeroMem(&temp, sizeof(Material));
+    material->id = id;
+    material->generation = generation == INVALID::ID ? 0 : generation + 1;
+
+    MTRACE("Материал '%s' перезагружен.", material->name);
+    return true;
+}
+
+bool MaterialSystem::ReloadFromFile(Material *material)
+{
+    if (!material) {
+        return false;
+    }
+
+    MaterialResource materialResource;
+    if (!ResourceSystem::Load(material->name, eResource::Material, nullptr, materialResource)) {
+        MERROR("MaterialSystem::ReloadFromFile: не удалось прочитать файл материала '%s'. Материал не изменен.", material->name);
+        return false;
+    }
+    const bool result = Reload(material, materialResource.data);
+    ResourceSystem::Unload(materialResource);
+    return result;
+}
+
+static bool OnWatchedFileWritten(u16 code, void* sender, void* ListenerInst, EventContext context)
+{
+    const u32 WatchID = context.data.u32[0];
+    if (!state || WatchID == INVALID::ID) {
+        return false;
+    }
+
+    for (u32 i = 0; i < state->MaxMaterialCount; ++i) {
+        if (state->WatchIDs[i] != WatchID) {
+            continue;
+        }
+
+        auto material = &state->RegisteredMaterials[i];
+        MINFO("Файл материала '%s' изменен, материал будет перезагружен.", material->name);
+        MaterialSystem::ReloadFromFile(material);
+        return true;
+    }
+    return false;
+}
+
 bool CreateDefaultMaterial()
 {
     MString::Copy(state->DefaultMaterial.name, DEFAULT_MATERIAL_NAME, MATERIAL_NAME_MAX_LENGTH);
@@ -821,24 +1090,9 @@ static bool LoadMaterial(const Material::Config &config, Material *material)
     switch (config.type) {
         case Material::Type::Phong: {
             // Специфические свойства Фонга.
-            const u32& PropCount = config.properties.Length();
-
-            // Значения по умолчанию
             material->PropertyStructSize = sizeof(Material::PhongProperties);
-            auto properties = (Material::PhongProperties*)MemorySystem::Allocate(material->PropertyStructSize, Memory::MaterialInstance, true);
-            material->properties = properties;
-            properties->DiffuseColour = FVec4::One();
-            properties->specular = 32.F;
-
-            for (u32 i = 0; i < PropCount; ++i) {
-                if (config.properties[i].name.Comparei("diffuse_colour")) {
-                    // Рассеянный цвет
-                    properties->DiffuseColour = config.properties[i].ValueV4;
-                } else if (config.properties[i].name.Comparei("specular")) {
-                    // Блеск
-                    properties->specular = config.properties[i].ValueF32;
-                }
-            }
+            material->properties = MemorySystem::Allocate(material->PropertyStructSize, Memory::MaterialInstance, true);
+            AssignProperties(config, material);
 
             // Карты. Фонг ожидает диффузный, зеркальный и нормальный.
             material->maps.Resize(3);
@@ -848,17 +1102,17 @@ static bool LoadMaterial(const Material::Config &config, Material *material)
             bool NormAssigned = false;
             for (u32 i = 0; i < MapCount; ++i) {
                 if (config.maps[i].name.Comparei("diffuse")) {
-                    if (!AssignMap(material->maps[0], config.maps[i], material->name, TextureSystem::GetDefaultTexture(Texture::Diffuse))) {
+                    if (!AssignMap(material->maps[0], config.maps[i], material->name, TextureSystem::GetDefaultTexture(Texture::Diffuse), true)) {
                         return false;
                     }
                     DiffuseAssigned = true;
                 } else if (config.maps[i].name.Comparei("specular")) {
-                    if (!AssignMap(material->maps[1], config.maps[i], material->name, TextureSystem::GetDefaultTexture(Texture::Specular))) {
+                    if (!AssignMap(material->maps[1], config.maps[i], material->name, TextureSystem::GetDefaultTexture(Texture::Specular), true)) {
                         return false;
                     }
                     SpecAssigned = true;
                 } else if (config.maps[i].name.Comparei("normal")) {
-                    if (!AssignMap(material->maps[2], config.maps[i], material->name, TextureSystem::GetDefaultTexture(Texture::Normal))) {
+                    if (!AssignMap(material->maps[2], config.maps[i], material->name, TextureSystem::GetDefaultTexture(Texture::Normal), true)) {
                         return false;
                     }
                     NormAssigned = true;
@@ -907,8 +1161,7 @@ static bool LoadMaterial(const Material::Config &config, Material *material)
             material->maps.Resize(1);
             material->PropertyStructSize = sizeof(Material::UiProperties);
             material->properties = MemorySystem::Allocate(material->PropertyStructSize, Memory::MaterialInstance);
-            auto properties = reinterpret_cast<Material::UiProperties*>(material->properties);
-            properties->DiffuseColour = config.properties[0].ValueV4;
+            AssignProperties(config, material);
             if (!AssignMap(material->maps[0], config.maps[0], material->name, TextureSystem::GetDefaultTexture(Texture::Diffuse))) {
                 return false;
             }
@@ -8,6 +8,7 @@
 #pragma once
 #include "resources/material.h"
 #include "containers/hashtable.hpp"
+#include "containers/retention_list.hpp"
 
 struct Matrix4D;
 struct FrameData;
@@ -26,6 +27,11 @@ struct MaterialSystemConfig
 {
     /// @brief Максимальное количество загруженных материалов.
     u32 MaxMaterialCount;
+    /// @brief Бюджет памяти в байтах для материалов с AutoRelease, на которые не осталось ссылок (с учетом их текстур). 
+    /// Такие материалы не уничтожаются сразу, а удерживаются, пока бюджет не будет превышен. 0 - уничтожаются сразу.
+    u64 RetentionBudget;
+    /// @brief Наибольшее количество удерживаемых материалов, вытесняемых за один кадр.
+    u32 RetentionEvictionsPerFrame;
 };
 
 namespace MaterialSystem
@@ -46,6 +52,15 @@ namespace MaterialSystem
 
     void Shutdown();
 
+    /// @brief Вытесняет удерживаемые материалы без ссылок, если превышен бюджет удержания.
+    /// @param state указатель на состояние системы.
+    /// @param rFrameData данные текущего кадра.
+    /// @return true в случае успеха; в противном случае false.
+    bool Update(void* state, const FrameData& rFrameData);
+
+    /// @brief Возвращает счетчики удержания материалов без ссылок: попадания, промахи, вытеснения и удерживаемый объем.
+    MAPI const RetentionList::Stats& RetentionStats();
+
     /// @brief Пытается получить материал с заданным именем. Если он еще не загружен, это запускает его загрузку. 
     /// Если материал не найден, возвращается указатель на материал по умолчанию. Если материал найден и загружен, его счетчик ссылок увеличивается.
     /// @param name имя искомого материала.
@@ -71,6 +86,19 @@ namespace MaterialSystem
 
     MAPI void Release(const char* name);
 
+    /// @brief Перезагружает материал из новой конфигурации, сохраняя его слот, идентификатор и указатель на него. 
+    /// Если изменились только значения свойств, структура свойств обновляется на месте без обращений к рендереру. 
+    /// Иначе материал пересобирается; при ошибке он остается прежним. В обоих случаях генерация увеличивается.
+    /// @param material указатель на зарегистрированный материал.
+    /// @param config новая конфигурация материала.
+    /// @return true в случае успеха; в противном случае false.
+    MAPI bool Reload(Material* material, const Material::Config& config);
+
+    /// @brief Перечитывает файл материала и перезагружает материал из него. Вызывается при изменении наблюдаемого файла .mmt.
+    /// @param material указатель на зарегистрированный материал; файл ищется по его имени.
+    /// @return true в случае успеха; в противном случае false.
+    MAPI bool ReloadFromFile(Material* material);
+
     /// @brief Применяет данные глобального уровня для идентификатора шейдера материала.
     /// @param ShaderID идентификатор шейдера, к которому применяются глобальные переменные.
     /// @param RenderFrameNumber текущий номер кадра рендерера.
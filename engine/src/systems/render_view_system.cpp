@@ -3,6 +3,7 @@
 #include "containers/hashtable.hpp"
 #include "renderer/rendering_system.h"
 #include "renderer/renderpass.h"
+#include "core/profiler.h"
 
 //#include <new>
 
@@ -147,6 +148,7 @@ RenderView *RenderViewSystem::Get(const char *name)
 
 bool RenderViewSystem::BuildPacket(RenderView* view, FrameData& rFrameData, Viewport& viewport, Camera* camera, void* data,  RenderViewPacket& OutPacket)
 {
+    MPROFILE_SCOPE("RenderViewSystem::BuildPacket");
     if (view) {
         return view->BuildPacket(view, rFrameData, viewport, camera, data, OutPacket);
     }
@@ -1,6 +1,8 @@
 #include "resource_system.h"
 #include "core/logger.hpp"
 #include "memory/linear_allocator.h"
+#include "platform/filesystem.hpp"
+#include "platform/platform.hpp"
 
 #include "core/memory_system.h"
 #include <new>
@@ -11,11 +13,12 @@ struct sResourceSystem
 {
     u32 MaxLoaderCount;
     const char* AssetBasePath;              // Относительный базовый путь для активов.
+    bool HotReload;                         // Указывает, ведется ли наблюдение за файлами ресурсов.
 
     ResourceLoader* RegisteredLoaders;
 
     constexpr sResourceSystem(ResourceSystemConfig* config, ResourceLoader* RegisteredLoaders) 
-    : MaxLoaderCount(config->MaxLoaderCount), AssetBasePath(config->AssetBasePath), RegisteredLoaders(RegisteredLoaders) {
+    : MaxLoaderCount(config->MaxLoaderCount), AssetBasePath(config->AssetBasePath), HotReload(config->HotReload), RegisteredLoaders(RegisteredLoaders) {
         for (u64 i = 0; i < config->MaxLoaderCount; i++) {
             this->RegisteredLoaders[i].id = INVALID::ID;
         }
@@ -42,6 +45,13 @@ bool ResourceSystem::Initialize(u64& MemoryRequirement, void* memory, void* conf
         ResourceLoader* ResourceLoaderPtr = reinterpret_cast<ResourceLoader*> (reinterpret_cast<u8*>(memory) + sizeof(sResourceSystem));
         state = new(memory) sResourceSystem(pConfig, ResourceLoaderPtr);
         RegisterLoaders();
+
+        // Пакет необязателен: без него ресурсы загружаются из отдельных файлов.
+        if (pConfig->PackPath && Filesystem::Exists(pConfig->PackPath)) {
+            if (!Filesystem::MountPack(pConfig->PackPath, state->AssetBasePath)) {
+                MWARN("Не удалось подключить пакет ресурсов '%s'. Ресурсы будут загружаться из '%s'.", pConfig->PackPath, state->AssetBasePath);
+            }
+        }
     }
 
     MINFO("Система ресурсов инициализируется с использованием базового пути '%s'.", state->AssetBasePath);
@@ -52,6 +62,7 @@ bool ResourceSystem::Initialize(u64& MemoryRequirement, void* memory, void* conf
 void ResourceSystem::Shutdown()
 {
     if (state) {
+        Filesystem::UnmountPacks();
         // state->~ResourceSystem(); // delete state;
         state = nullptr;
     }
@@ -144,6 +155,59 @@ const char *ResourceSystem::BasePath()
     return "";
 }
 
+bool ResourceSystem::ResolvePath(eResource::Type type, const char *name, const char *const *extensions, u32 ExtensionCount, char *OutPath)
+{
+    if (!state || !name || !OutPath || type >= eResource::Custom) {
+        return false;
+    }
+
+    auto& l = state->RegisteredLoaders[type];
+    if (l.id == INVALID::ID) {
+        MERROR("ResourceSystem::ResolvePath — загрузчик для типа %d не найден.", type);
+        return false;
+    }
+
+    for (u32 i = 0; i < ExtensionCount; ++i) {
+        MString::Format(OutPath, "%s/%s/%s%s", state->AssetBasePath, l.TypePath.c_str(), name, extensions[i]);
+        if (Filesystem::Exists(OutPath)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ResourceSystem::WatchFile(const char *FullPath, u32 &OutWatchID)
+{
+    OutWatchID = INVALID::ID;
+    if (!state || !state->HotReload || !FullPath) {
+        return false;
+    }
+    // Ресурсы из пакета не меняются во время работы.
+    if (Filesystem::IsPacked(FullPath)) {
+        return false;
+    }
+    if (!PlatformWatchFile(FullPath, OutWatchID)) {
+        OutWatchID = INVALID::ID;
+        return false;
+    }
+    return true;
+}
+
+void ResourceSystem::UnwatchFile(u32 &WatchID)
+{
+    if (WatchID != INVALID::ID) {
+        PlatformUnwatchFile(WatchID);
+        WatchID = INVALID::ID;
+    }
+}
+
+void ResourceSystem::PollWatches()
+{
+    if (state && state->HotReload) {
+        PlatformUpdateWatches();
+    }
+}
+
 void RegisterLoaders()
 {
     // ЗАДАЧА: возможно все эти "загрузчики" не нужны в таком случае их нужно будет удалить
@@ -9,6 +9,11 @@ struct ResourceSystemConfig {
     u32 MaxLoaderCount;
     /// @brief Относительный базовый путь для активов.
     const char* AssetBasePath;
+    /// @brief Путь к пакету ресурсов или nullptr. Если пакет существует, ресурсы сначала ищутся в нем,
+    /// а при отсутствии — в каталоге AssetBasePath.
+    const char* PackPath;
+    /// @brief Включает наблюдение за файлами загруженных ресурсов и их перезагрузку при изменении.
+    bool HotReload;
 };
 
 // ЗАДАЧА: переделать
@@ -48,4 +53,28 @@ namespace ResourceSystem
 
     MAPI const char* BasePath();
 
+    /// @brief Находит файл ресурса, перебирая возможные расширения в каталоге загрузчика указанного типа.
+    /// @param type тип ресурса; определяет каталог (TypePath) зарегистрированного загрузчика.
+    /// @param name имя ресурса без расширения.
+    /// @param extensions массив возможных расширений (с точкой) в порядке приоритета.
+    /// @param ExtensionCount количество расширений.
+    /// @param OutPath буфер для полного пути. Должен вмещать не менее 512 символов.
+    /// @return true, если файл найден; в противном случае false. OutPath содержит последний проверенный путь.
+    MAPI bool ResolvePath(eResource::Type type, const char* name, const char* const* extensions, u32 ExtensionCount, char* OutPath);
+
+    /// @brief Начинает наблюдение за файлом ресурса для горячей перезагрузки. 
+    /// При изменении файла срабатывает событие EventSystem::WatchedFileWritten с полученным идентификатором.
+    /// @param FullPath полный путь к файлу ресурса.
+    /// @param OutWatchID ссылка для хранения идентификатора наблюдения. INVALID::ID, если наблюдение не установлено.
+    /// @return true, если наблюдение установлено; false, если горячая перезагрузка выключена, файл находится в пакете ресурсов или не найден.
+    MAPI bool WatchFile(const char* FullPath, u32& OutWatchID);
+
+    /// @brief Прекращает наблюдение за файлом ресурса.
+    /// @param WatchID ссылка на идентификатор наблюдения. Сбрасывается в INVALID::ID.
+    MAPI void UnwatchFile(u32& WatchID);
+
+    /// @brief Проверяет наблюдаемые файлы и отправляет события об их изменении. В приложении это делает цикл сообщений окна,
+    /// поэтому вызывать функцию нужно только без окна, например в тестах и инструментах.
+    MAPI void PollWatches();
+
 };
@@ -1,10 +1,18 @@
 #include "shader_system.h"
 #include "memory/linear_allocator.h"
 #include "systems/texture_system.h"
+#include "systems/resource_system.h"
 #include "renderer/rendering_system.h"
+#include "core/event.h"
 #include "resources/texture_map.hpp"
 #include <new>
 
+/// @brief Наблюдение за файлом этапа шейдера для горячей перезагрузки.
+struct ShaderFileWatch {
+    u32 WatchID;
+    u32 ShaderID;
+};
+
 struct sShaderSystem
 {
     // Конфигурация шейдерной системы.--------------------------------------------------------------------------------------------------
@@ -15,8 +23,8 @@ struct sShaderSystem
     // ---------------------------------------------------------------------------------------------------------------------------------
     void* LookupMemory;                 // Память, используемая для таблицы поиска.
     HashTable<u32> lookup;              // Таблица поиска имени шейдера->идентификатор.
-    u32 CurrentShaderID;                // Идентификатор текущего привязанного шейдера.
     Shader* shaders;                    // Коллекция созданных шейдеров.
+    DArray<ShaderFileWatch> watches;    // Наблюдения за файлами этапов шейдеров.
     // ---------------------------------------------------------------------------------------------------------------------------------
     sShaderSystem(ShaderSystem::Config* config, void* LookupMemory, Shader* shaders)
     :
@@ -26,8 +34,8 @@ struct sShaderSystem
     MaxInstanceTextures(config->MaxInstanceTextures),
     LookupMemory(LookupMemory),
     lookup(MaxShaderCount, false, reinterpret_cast<u32*>(LookupMemory), true, INVALID::ID),
-    CurrentShaderID(INVALID::ID),
-    shaders(shaders) 
+    shaders(shaders),
+    watches()
     {
         // Делаем недействительными все идентификаторы шейдеров.
         for (u32 i = 0; i < MaxShaderCount; ++i) {
@@ -37,8 +45,25 @@ struct sShaderSystem
     }
 };
 
+// Идентификатор текущего привязанного шейдера. Свой у каждого потока, так как представления могут записываться параллельно.
+static thread_local u32 CurrentShaderID = INVALID::ID;
+
 static sShaderSystem* pShaderSystem = nullptr;
 
+static bool OnWatchedFileWritten(u16 code, void* sender, void* ListenerInst, EventContext context);
+
+/// @brief Начинает наблюдение за файлом этапа, чтобы перезагрузить шейдер при его изменении.
+static void ShaderWatchFile(Shader* shader, const char* filename)
+{
+    char path[512]{};
+    const char* extension = "";
+    ShaderFileWatch watch { INVALID::ID, shader->id };
+    if (ResourceSystem::ResolvePath(eResource::Binary, filename, &extension, 1, path) &&
+        ResourceSystem::WatchFile(path, watch.WatchID)) {
+        pShaderSystem->watches.PushBack(watch);
+    }
+}
+
 /// @brief Добавляет образец текстуры в шейдер. Должно быть сделано после инициализации шейдера.
 /// @param config конфигурация униформы.
 /// @return True в случае успеха; в противном случае ложь.
@@ -85,6 +110,9 @@ bool ShaderSystem::Initialize(u64& MemoryRequirement, void* memory, void* config
         // MERROR("ShaderSystem::Initialize — Неудалось инициализировать систему шейдеров.");
         return false;
     }
+
+    // Горячая перезагрузка шейдеров при изменении файлов их этапов.
+    EventSystem::Register(EventSystem::WatchedFileWritten, nullptr, OnWatchedFileWritten);
     
     return true;
 }
@@ -92,6 +120,12 @@ bool ShaderSystem::Initialize(u64& MemoryRequirement, void* memory, void* config
 void ShaderSystem::Shutdown()
 {
     if (pShaderSystem) {
+        EventSystem::Unregister(EventSystem::WatchedFileWritten, nullptr, OnWatchedFileWritten);
+        for (u32 i = 0; i < pShaderSystem->watches.Length(); ++i) {
+            ResourceSystem::UnwatchFile(pShaderSystem->watches[i].WatchID);
+        }
+        pShaderSystem->watches.Destroy();
+
         // Уничтожьте все существующие шейдеры.
         for (u32 i = 0; i < pShaderSystem->MaxShaderCount; ++i) {
             auto& shader = pShaderSystem->shaders[i];
@@ -155,9 +189,46 @@ bool ShaderSystem::CreateShader(Renderpass& pass, ShaderConfig &config)
         return false;
     }
 
+    // Наблюдение за файлами этапов. Перезагружаются только модули и конвейеры, ресурсы экземпляров сохраняются.
+    const DArray<MString>* StageFileLists[2] = { &config.StageFilenames, &config.BindlessStageFilenames };
+    for (auto list : StageFileLists) {
+        for (u32 i = 0; i < list->Length(); ++i) {
+            ShaderWatchFile(NewShader, (*list)[i].c_str());
+        }
+    }
+    const MString* IndirectFiles[2] = { &config.IndirectVertexFilename, &config.BindlessIndirectVertexFilename };
+    for (auto file : IndirectFiles) {
+        if (file->Length() > 0) {
+            ShaderWatchFile(NewShader, file->c_str());
+        }
+    }
+
     return true;
 }
 
+static bool OnWatchedFileWritten(u16 code, void* sender, void* ListenerInst, EventContext context)
+{
+    const u32 WatchID = context.data.u32[0];
+    if (!pShaderSystem || WatchID == INVALID::ID) {
+        return false;
+    }
+
+    for (u32 i = 0; i < pShaderSystem->watches.Length(); ++i) {
+        if (pShaderSystem->watches[i].WatchID != WatchID) {
+            continue;
+        }
+        auto shader = ShaderSystem::GetShader(pShaderSystem->watches[i].ShaderID);
+        if (shader) {
+            MINFO("Файл этапа шейдера '%s' изменен, шейдер будет перезагружен.", shader->name.c_str());
+            if (!RenderingSystem::ShaderReload(shader)) {
+                MERROR("Не удалось перезагрузить шейдер '%s'.", shader->name.c_str());
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
 u32 ShaderSystem::GetID(const MString& ShaderName)
 {
     return GetShaderID(ShaderName);
@@ -193,9 +264,9 @@ bool ShaderSystem::Use(const char *ShaderName)
 bool ShaderSystem::Use(u32 ShaderID)
 {
     // Выполняйте использование только в том случае, если идентификатор шейдера отличается.
-    // if (pShaderSystem->CurrentShaderID != ShaderID) {
+    // if (CurrentShaderID != ShaderID) {
         auto NextShader = GetShader(ShaderID);
-        pShaderSystem->CurrentShaderID = ShaderID;
+        CurrentShaderID = ShaderID;
 
         if (!RenderingSystem::ShaderUse(NextShader)) {
             MERROR("Не удалось использовать шейдер '%s'.", NextShader->name.c_str());
@@ -217,18 +288,18 @@ u16 ShaderSystem::UniformIndex(Shader *shader, const char *UniformName)
 
 bool ShaderSystem::UniformSet(const char *UniformName, const void *value)
 {
-    if (pShaderSystem->CurrentShaderID == INVALID::ID) {
+    if (CurrentShaderID == INVALID::ID) {
         MERROR("ShaderSystem::UniformSet вызывается без использования шейдера.");
         return false;
     }
-    Shader* shader = &pShaderSystem->shaders[pShaderSystem->CurrentShaderID];
+    Shader* shader = &pShaderSystem->shaders[CurrentShaderID];
     u16 index = UniformIndex(shader, UniformName);
     return UniformSet(index, value);
 }
 
 bool ShaderSystem::UniformSet(u16 index, const void *value)
 {
-    auto& shader = pShaderSystem->shaders[pShaderSystem->CurrentShaderID];
+    auto& shader = pShaderSystem->shaders[CurrentShaderID];
     auto& uniform = shader.uniforms[index];
     if (shader.BoundScope != uniform.scope) {
         if (uniform.scope == Shader::Scope::Global) {
@@ -255,17 +326,17 @@ bool ShaderSystem::SamplerSet(u16 index, const Texture *texture)
 
 bool ShaderSystem::ApplyGlobal(bool NeedsUpdate)
 {
-    return RenderingSystem::ShaderApplyGlobals(&pShaderSystem->shaders[pShaderSystem->CurrentShaderID], NeedsUpdate);
+    return RenderingSystem::ShaderApplyGlobals(&pShaderSystem->shaders[CurrentShaderID], NeedsUpdate);
 }
 
 bool ShaderSystem::ApplyInstance(bool NeedsUpdate)
 {
-    return RenderingSystem::ShaderApplyInstance(&pShaderSystem->shaders[pShaderSystem->CurrentShaderID], NeedsUpdate);
+    return RenderingSystem::ShaderApplyInstance(&pShaderSystem->shaders[CurrentShaderID], NeedsUpdate);
 }
 
 bool ShaderSystem::BindInstance(u32 InstanceID)
 {
-    auto& s = pShaderSystem->shaders[pShaderSystem->CurrentShaderID];
+    auto& s = pShaderSystem->shaders[CurrentShaderID];
     s.BoundInstanceID = InstanceID;
     return RenderingSystem::ShaderBindInstance(&s, InstanceID);
 }
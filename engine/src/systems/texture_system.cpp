@@ -3,6 +3,12 @@
 #include "renderer/rendering_system.h"
 #include "systems/resource_system.h"
 #include "systems/job_systems.hpp"
+#include "platform/async_io.hpp"
+#include "core/frame_data.h"
+#include "core/metrics.h"
+#include "core/event.h"
+#include "core/clock.h"
+#include "containers/retention_list.hpp"
 
 #include "memory/linear_allocator.h"
 #include <new>
@@ -17,19 +23,60 @@ struct TextureReference {
 
 // Также используется как ResultData из задания.
 struct TextureLoadParams {
+    // Содержимое файла при асинхронном чтении. Должно быть первым полем (см. AsyncIO::Read).
+    AsyncIO::ReadResult file{};
     MString ResourceName;
+    // Полный путь к файлу текстуры; пустой, если файл не найден.
+    char FullPath[512]{};
     Texture* OutTexture;
     Texture TempTexture{};
     u32 CurrentGeneration;
     ImageResource ImgRes{};
+    // Наибольший размер стороны загружаемого уровня детализации. 0 - текстура загружается полностью.
+    u32 MaxSize;
+    // Порядковый номер потоковой текстуры на момент запроса (см. TextureStreamState::serial).
+    u32 serial;
+    // Размеры нулевого уровня детализации и номер загруженного уровня. Заполняются заданием.
+    u32 FullWidth;
+    u32 FullHeight;
+    u8 mip;
+    // Указывает, что текстура уже загружена и заменяется другим уровнем детализации.
+    bool reload;
+    // Указывает, что это запрос потоковой загрузки, учтенный в PendingRequests.
+    bool streamed;
+};
+
+/// @brief Недействительный уровень детализации.
+constexpr u8 INVALID_MIP = 0xFF;
+/// @brief Наибольшее количество одновременно выполняющихся запросов потоковой загрузки.
+constexpr u32 MAX_STREAM_REQUESTS = 4;
+
+/// @brief Состояние потоковой загрузки текстуры. Хранится параллельно массиву зарегистрированных текстур.
+struct TextureStreamState {
+    u32 FullWidth;          // Ширина нулевого уровня детализации.
+    u32 FullHeight;         // Высота нулевого уровня детализации.
+    u64 ResidentBytes;      // Объем памяти загруженного уровня детализации.
+    u64 LastUsedFrame;      // Кадр, в котором размер текстуры на экране был сообщен последний раз.
+    u32 serial;             // Увеличивается при уничтожении текстуры, чтобы отбросить результаты устаревших заданий.
+    u8 ChannelCount;        // Количество каналов.
+    u8 MipCount;            // Количество уровней детализации полной цепочки.
+    u8 ResidentMip;         // Загруженный уровень детализации.
+    u8 RequestedMip;        // Наиболее подробный уровень, запрошенный с последнего обновления.
+    u8 PendingMip;          // Уровень, загружаемый в данный момент.
+    bool streamed;          // Текстура получена через AcquireStreamed.
+    bool pinned;            // Текстура также получена через Acquire и должна оставаться полностью загруженной.
+
+    constexpr TextureStreamState() 
+    : FullWidth(), FullHeight(), ResidentBytes(), LastUsedFrame(), serial(), ChannelCount(), MipCount(), 
+    ResidentMip(INVALID_MIP), RequestedMip(INVALID_MIP), PendingMip(INVALID_MIP), streamed(false), pinned(false) {}
 };
 
 bool LoadCubeTextures(const char* name, const char TextureNames[6][TEXTURE_NAME_MAX_LENGTH], Texture& t);
 
 bool CreateDefaultTexture();
 void DestroyDefaultTexture();
-bool LoadTexture(const char* TextureName, Texture& t);
-bool ProcessTextureReference(const char *name, TextureType type, i8 ReferenceDiff, bool AutoRelease, bool SkipLoad, u32 &OutTextureId);
+bool LoadTexture(const char* TextureName, Texture& t, u32 MaxSize = 0, bool reload = false);
+bool ProcessTextureReference(const char *name, TextureType type, i8 ReferenceDiff, bool AutoRelease, bool SkipLoad, u32 &OutTextureId, bool streamed = false);
 
 struct sTextureSystem
 {
@@ -42,18 +89,72 @@ struct sTextureSystem
     /// @brief Хэш-таблица для поиска текстур.
     HashTable<TextureReference> RegisteredTextureTable;
 
-    sTextureSystem(u32 MaxTextureCount, Texture* RegisteredTextures, TextureReference* HashtableBlock)
+    /// @brief Состояния потоковой загрузки зарегистрированных текстур. nullptr, если потоковая загрузка выключена.
+    TextureStreamState* StreamStates;
+    u64 StreamingBudget;
+    u32 StreamingBaseSize;
+    /// @brief Объем памяти, занятой потоковыми текстурами.
+    u64 ResidentBytes;
+    /// @brief Количество незавершенных запросов потоковой загрузки.
+    u32 PendingRequests;
+    /// @brief Верхняя граница индексов слотов, когда-либо занятых потоковыми текстурами.
+    u32 StreamSlotCount;
+    u64 FrameNumber;
+
+    /// @brief Текстуры без ссылок, удерживаемые до вытеснения, чтобы повторное получение не загружало их заново.
+    RetentionList retention;
+    u32 RetentionEvictionsPerFrame;
+
+    /// @brief Идентификаторы наблюдения за файлами зарегистрированных текстур для горячей перезагрузки.
+    u32* WatchIDs;
+
+    /// @brief Свободные слоты массива текстур режима без привязки. Слоты выдаются сначала из стека, затем по порядку.
+    u32* FreeSlots;
+    u32 FreeSlotCount;
+    u32 NextSlot;
+    u32 SlotCapacity;
+
+    /// @brief Номер пакета загрузок GPU с последней загруженной текстурой, см. RenderingSystem::UploadTicket.
+    u64 UploadTicket;
+    /// @brief Количество текстур в текущей серии загрузок. 0, если все загрузки завершены на GPU.
+    u32 UploadBurstCount;
+    /// @brief Время от первой загрузки серии до ее завершения на GPU.
+    Clock UploadBurstClock;
+
+    sTextureSystem(u32 MaxTextureCount, Texture* RegisteredTextures, TextureReference* HashtableBlock, TextureStreamState* StreamStates, u64 StreamingBudget, u32 StreamingBaseSize, u32* WatchIDs, u32* FreeSlots, u32 SlotCapacity)
     : 
     MaxTextureCount(MaxTextureCount),
     DefaultTexture(), 
     RegisteredTextures(new(RegisteredTextures) Texture[MaxTextureCount]()), 
-    RegisteredTextureTable(MaxTextureCount, false, HashtableBlock, true, TextureReference(0, INVALID::ID, false)) {}
+    RegisteredTextureTable(MaxTextureCount, false, HashtableBlock, true, TextureReference(0, INVALID::ID, false)),
+    StreamStates(StreamStates ? new(StreamStates) TextureStreamState[MaxTextureCount]() : nullptr),
+    StreamingBudget(StreamingBudget),
+    StreamingBaseSize(StreamingBaseSize),
+    ResidentBytes(),
+    PendingRequests(),
+    StreamSlotCount(),
+    FrameNumber(),
+    retention(),
+    RetentionEvictionsPerFrame(),
+    WatchIDs(WatchIDs),
+    FreeSlots(FreeSlots),
+    FreeSlotCount(),
+    NextSlot(),
+    SlotCapacity(SlotCapacity),
+    UploadTicket(),
+    UploadBurstCount(),
+    UploadBurstClock() {
+        for (u32 i = 0; i < MaxTextureCount; ++i) {
+            WatchIDs[i] = INVALID::ID;
+        }
+    }
 
     ~sTextureSystem()
     {
         if (this->RegisteredTextures) {
             // Уничтожить все загруженные текстуры.
             for (u32 i = 0; i < this->MaxTextureCount; ++i) {
+                ResourceSystem::UnwatchFile(this->WatchIDs[i]);
                 Texture* t = &this->RegisteredTextures[i];
                 if (t->generation != INVALID::ID) {
                     RenderingSystem::Unload(t);
@@ -66,6 +167,9 @@ struct sTextureSystem
 
 static sTextureSystem* state = nullptr;
 
+static bool OnWatchedFileWritten(u16 code, void* sender, void* ListenerInst, EventContext context);
+static bool OnUploadsCompleted(u16 code, void* sender, void* ListenerInst, EventContext context);
+
 bool TextureSystem::Initialize(u64& MemoryRequirement, void* memory, void* config)
 {
     auto pConfig = reinterpret_cast<TextureSystemConfig*>(config);
@@ -79,7 +183,12 @@ bool TextureSystem::Initialize(u64& MemoryRequirement, void* memory, void* confi
     u64 StructRequirement = sizeof(sTextureSystem);
     u64 ArrayRequirement = sizeof(Texture) * pConfig->MaxTextureCount;
     u64 HashtableRequirement = sizeof(TextureReference) * pConfig->MaxTextureCount;
-    MemoryRequirement = StructRequirement + ArrayRequirement + HashtableRequirement;
+    u64 StreamRequirement = pConfig->streaming ? sizeof(TextureStreamState) * pConfig->MaxTextureCount : 0;
+    u64 RetentionRequirement = RetentionList::GetMemoryRequirement(pConfig->MaxTextureCount);
+    u64 WatchRequirement = sizeof(u32) * pConfig->MaxTextureCount;
+    const u32 SlotCapacity = MMIN(pConfig->MaxTextureCount + TEXTURE_BINDLESS_RESERVED_SLOTS, TEXTURE_BINDLESS_MAX_SLOTS);
+    u64 SlotRequirement = sizeof(u32) * SlotCapacity;
+    MemoryRequirement = StructRequirement + ArrayRequirement + HashtableRequirement + StreamRequirement + RetentionRequirement + WatchRequirement + SlotRequirement;
 
     if (!memory) {
         return true;
@@ -88,10 +197,22 @@ bool TextureSystem::Initialize(u64& MemoryRequirement, void* memory, void* confi
     u8* ptrTextureSystem = reinterpret_cast<u8*> (memory);
     Texture* ArrayBlock = reinterpret_cast<Texture*> (ptrTextureSystem + StructRequirement);
     TextureReference* HashTableBlock = reinterpret_cast<TextureReference*> (ptrTextureSystem + StructRequirement + ArrayRequirement);
+    TextureStreamState* StreamBlock = pConfig->streaming ? reinterpret_cast<TextureStreamState*> (ptrTextureSystem + StructRequirement + ArrayRequirement + HashtableRequirement) : nullptr;
+    void* RetentionBlock = ptrTextureSystem + StructRequirement + ArrayRequirement + HashtableRequirement + StreamRequirement;
+    u32* WatchBlock = reinterpret_cast<u32*> (ptrTextureSystem + StructRequirement + ArrayRequirement + HashtableRequirement + StreamRequirement + RetentionRequirement);
+    u32* SlotBlock = WatchBlock + pConfig->MaxTextureCount;
     if (!state) {
-        state = new(ptrTextureSystem) sTextureSystem(pConfig->MaxTextureCount, ArrayBlock, HashTableBlock);
+        // Базовый уровень не может быть меньше одного пикселя.
+        const u32 BaseSize = pConfig->StreamingBaseSize > 0 ? pConfig->StreamingBaseSize : 1;
+        state = new(ptrTextureSystem) sTextureSystem(pConfig->MaxTextureCount, ArrayBlock, HashTableBlock, StreamBlock, pConfig->StreamingBudget, BaseSize, WatchBlock, SlotBlock, SlotCapacity);
+        state->retention.Create(pConfig->MaxTextureCount, pConfig->RetentionBudget, RetentionBlock);
+        state->RetentionEvictionsPerFrame = pConfig->RetentionEvictionsPerFrame > 0 ? pConfig->RetentionEvictionsPerFrame : 1;
     }
 
+    // Горячая перезагрузка текстур при изменении их файлов.
+    EventSystem::Register(EventSystem::WatchedFileWritten, nullptr, OnWatchedFileWritten);
+    EventSystem::Register(EventSystem::RenderUploadsCompleted, nullptr, OnUploadsCompleted);
+
     // Создайте текстуры по умолчанию для использования в системе.
     CreateDefaultTexture();
 
@@ -100,42 +221,339 @@ bool TextureSystem::Initialize(u64& MemoryRequirement, void* memory, void* confi
 
 void TextureSystem::Shutdown()
 {
+    EventSystem::Unregister(EventSystem::WatchedFileWritten, nullptr, OnWatchedFileWritten);
+    EventSystem::Unregister(EventSystem::RenderUploadsCompleted, nullptr, OnUploadsCompleted);
     state = nullptr;
 }
 
-Texture *TextureSystem::Acquire(const char* name, bool AutoRelease)
+/// @brief Возвращает состояние потоковой загрузки зарегистрированной текстуры или nullptr.
+static TextureStreamState* GetStreamState(const Texture* texture)
+{
+    if (!state || !state->StreamStates || !texture) {
+        return nullptr;
+    }
+    if (texture < state->RegisteredTextures || texture >= state->RegisteredTextures + state->MaxTextureCount) {
+        return nullptr;
+    }
+    return &state->StreamStates[texture - state->RegisteredTextures];
+}
+
+/// @brief Размер в байтах заданного уровня детализации.
+static u64 MipBytes(const TextureStreamState& ss, u8 mip)
+{
+    const u64 width = ss.FullWidth >> mip;
+    const u64 height = ss.FullHeight >> mip;
+    return (width > 0 ? width : 1) * (height > 0 ? height : 1) * ss.ChannelCount;
+}
+
+/// @brief Наибольший размер стороны заданного уровня детализации.
+static u32 MipSize(const TextureStreamState& ss, u8 mip)
+{
+    const u32 size = (ss.FullWidth > ss.FullHeight ? ss.FullWidth : ss.FullHeight) >> mip;
+    return size > 0 ? size : 1;
+}
+
+/// @brief Уровень детализации, с которого начинается загрузка текстуры и до которого она вытесняется.
+static u8 BaseMip(const TextureStreamState& ss)
+{
+    u8 mip = 0;
+    while (mip + 1 < ss.MipCount && MipSize(ss, mip) > state->StreamingBaseSize) {
+        mip++;
+    }
+    return mip;
+}
+
+/// @brief Объем памяти, который займет текстура после завершения запроса, если он есть.
+static u64 CommittedBytes(const TextureStreamState& ss)
+{
+    return ss.PendingMip != INVALID_MIP ? MipBytes(ss, ss.PendingMip) : ss.ResidentBytes;
+}
+
+/// @brief Запускает загрузку другого уровня детализации уже загруженной текстуры.
+static bool RequestMip(u32 index, u8 mip)
+{
+    auto& ss = state->StreamStates[index];
+    auto& texture = state->RegisteredTextures[index];
+    ss.PendingMip = mip;
+    if (!LoadTexture(texture.name, texture, MipSize(ss, mip), true)) {
+        ss.PendingMip = INVALID_MIP;
+        return false;
+    }
+    state->PendingRequests++;
+    return true;
+}
+
+static bool OnWatchedFileWritten(u16 code, void* sender, void* ListenerInst, EventContext context)
+{
+    const u32 WatchID = context.data.u32[0];
+    if (!state || WatchID == INVALID::ID) {
+        return false;
+    }
+
+    for (u32 i = 0; i < state->MaxTextureCount; ++i) {
+        if (state->WatchIDs[i] != WatchID) {
+            continue;
+        }
+
+        auto& texture = state->RegisteredTextures[i];
+        if (texture.generation == INVALID::ID) {
+            // Первая загрузка еще не завершена, она прочитает новые данные.
+            return true;
+        }
+
+        MINFO("Файл текстуры «%s» изменен, текстура будет перезагружена.", texture.name);
+        // Заменяется только эта текстура. Указатели на нее, хранимые материалами, остаются действительными.
+        auto ss = GetStreamState(&texture);
+        if (ss && ss->streamed) {
+            // Потоковая текстура перезагружается на том же уровне детализации.
+            if (ss->ResidentMip != INVALID_MIP && ss->PendingMip == INVALID_MIP) {
+                RequestMip(i, ss->ResidentMip);
+            }
+        } else {
+            // Обычная текстура не занимает места в очереди потоковой загрузки.
+            LoadTexture(texture.name, texture, 0, true);
+        }
+        return true;
+    }
+    return false;
+}
+
+/// @brief Учитывает только что загруженную текстуру в текущей серии загрузок GPU.
+static void TrackUpload()
+{
+    const u64 ticket = RenderingSystem::UploadTicket();
+    if (!ticket) {
+        // Рендерер загружает данные немедленно.
+        return;
+    }
+    if (!state->UploadBurstCount) {
+        state->UploadBurstClock.Start();
+    }
+    state->UploadBurstCount++;
+    state->UploadTicket = ticket;
+}
+
+static bool OnUploadsCompleted(u16 code, void* sender, void* ListenerInst, EventContext context)
+{
+    if (state && state->UploadBurstCount && context.data.u64[0] >= state->UploadTicket) {
+        state->UploadBurstClock.Update();
+        MDEBUG("Текстуры загружены в GPU: %u за %.2f мс.", state->UploadBurstCount, state->UploadBurstClock.elapsed * 1000.0);
+        state->UploadBurstCount = 0;
+    }
+    // Событие также нужно системе геометрии.
+    return false;
+}
+
+/// @brief Уничтожает зарегистрированную текстуру и сбрасывает ее состояние. Запись в хеш-таблице не изменяется.
+static void DestroyTexture(u32 handle)
+{
+    Texture* texture = &state->RegisteredTextures[handle];
+
+    // Уничтожить/сбросить текстуру.
+    texture->Destroy();
+    ResourceSystem::UnwatchFile(state->WatchIDs[handle]);
+
+    if (auto ss = GetStreamState(texture)) {
+        // Результаты незавершенных заданий для этой текстуры будут отброшены.
+        state->ResidentBytes -= ss->ResidentBytes;
+        const u32 serial = ss->serial + 1;
+        *ss = TextureStreamState();
+        ss->serial = serial;
+    }
+}
+
+/// @brief Оценка объема памяти ГП, занятой текстурой.
+static u64 TextureBytes(const Texture& texture)
+{
+    const u64 bytes = (u64)texture.width * texture.height * texture.ChannelCount;
+    return texture.type == TextureType::Cube ? bytes * 6 : bytes;
+}
+
+/// @brief Уничтожает удерживаемую текстуру, вытесненную из списка удержания, и сбрасывает ее ссылку.
+static void EvictTexture(u32 handle)
+{
+    // Имя копируется, поскольку уничтожение текстуры стирает его.
+    char NameCopy[TEXTURE_NAME_MAX_LENGTH]{};
+    MString::Copy(NameCopy, state->RegisteredTextures[handle].name, TEXTURE_NAME_MAX_LENGTH);
+
+    DestroyTexture(handle);
+
+    TextureReference ref;
+    if (state->RegisteredTextureTable.Get(NameCopy, &ref)) {
+        ref.handle = INVALID::ID;
+        ref.AutoRelease = false;
+        state->RegisteredTextureTable.Set(NameCopy, ref);
+    }
+}
+
+/// @brief Возвращает к базовому уровню детализации текстуру, которая дольше всех не была видна.
+/// @param frame номер текущего кадра.
+/// @param committed объем памяти с учетом незавершенных запросов; уменьшается на освобождаемый объем.
+/// @return true, если текстура для вытеснения найдена; в противном случае false.
+static bool EvictLeastRecentlyUsed(u64 frame, u64& committed)
+{
+    if (state->PendingRequests >= MAX_STREAM_REQUESTS) {
+        return false;
+    }
+
+    u32 victim = INVALID::ID;
+    u64 OldestFrame = frame;
+    for (u32 i = 0; i < state->StreamSlotCount; ++i) {
+        const auto& ss = state->StreamStates[i];
+        // Текстуры, видимые в последнем кадре, не вытесняются.
+        if (!ss.streamed || ss.pinned || ss.ResidentMip == INVALID_MIP || ss.PendingMip != INVALID_MIP || ss.LastUsedFrame + 1 >= frame) {
+            continue;
+        }
+        if (ss.ResidentMip < BaseMip(ss) && ss.LastUsedFrame < OldestFrame) {
+            OldestFrame = ss.LastUsedFrame;
+            victim = i;
+        }
+    }
+
+    if (victim == INVALID::ID) {
+        return false;
+    }
+
+    auto& ss = state->StreamStates[victim];
+    const u64 freed = ss.ResidentBytes - MipBytes(ss, BaseMip(ss));
+    if (!RequestMip(victim, BaseMip(ss))) {
+        return false;
+    }
+    committed -= freed;
+    return true;
+}
+
+bool TextureSystem::Update(void*, const FrameData& rFrameData)
+{
+    if (!state) {
+        return true;
+    }
+
+    // Удерживаемые текстуры сверх бюджета вытесняются понемногу, чтобы не задерживать кадр.
+    for (u32 i = 0; i < state->RetentionEvictionsPerFrame; ++i) {
+        const u32 slot = state->retention.EvictionCandidate();
+        if (slot == INVALID::ID) {
+            break;
+        }
+        state->retention.Evict(slot);
+        EvictTexture(slot);
+    }
+
+    if (!state->StreamStates) {
+        return true;
+    }
+
+    const u64 frame = ++state->FrameNumber;
+
+    u64 committed = 0;
+    for (u32 i = 0; i < state->StreamSlotCount; ++i) {
+        if (state->StreamStates[i].streamed) {
+            committed += CommittedBytes(state->StreamStates[i]);
+        }
+    }
+
+    for (u32 i = 0; i < state->StreamSlotCount && state->PendingRequests < MAX_STREAM_REQUESTS; ++i) {
+        auto& ss = state->StreamStates[i];
+        if (!ss.streamed || ss.ResidentMip == INVALID_MIP || ss.PendingMip != INVALID_MIP) {
+            continue;
+        }
+
+        u8 target = ss.pinned ? 0 : ss.RequestedMip;
+        ss.RequestedMip = INVALID_MIP;
+        if (target >= ss.ResidentMip) {
+            continue;
+        }
+
+        // Закрепленные текстуры загружаются полностью независимо от бюджета.
+        if (!ss.pinned) {
+            while (committed - ss.ResidentBytes + MipBytes(ss, target) > state->StreamingBudget && EvictLeastRecentlyUsed(frame, committed)) {}
+            // Если места все еще не хватает, загружается наиболее подробный уровень, который помещается в бюджет.
+            while (target < ss.ResidentMip && committed - ss.ResidentBytes + MipBytes(ss, target) > state->StreamingBudget) {
+                target++;
+            }
+            if (target >= ss.ResidentMip || state->PendingRequests >= MAX_STREAM_REQUESTS) {
+                continue;
+            }
+        }
+
+        const u64 bytes = MipBytes(ss, target);
+        if (RequestMip(i, target)) {
+            committed = committed - ss.ResidentBytes + bytes;
+        }
+    }
+
+    // Бюджет мог быть превышен базовыми уровнями новых текстур.
+    while (committed > state->StreamingBudget && EvictLeastRecentlyUsed(frame, committed)) {}
+
+    Metrics::SetTextureStreaming(state->ResidentBytes, state->StreamingBudget, state->PendingRequests);
+    return true;
+}
+
+void TextureSystem::ReportScreenSize(Texture *texture, u32 ScreenSize)
+{
+    auto ss = GetStreamState(texture);
+    if (!ss || !ss->streamed) {
+        return;
+    }
+
+    ss->LastUsedFrame = state->FrameNumber;
+    if (ss->ResidentMip == INVALID_MIP) {
+        return;
+    }
+
+    // Самый грубый уровень, у которого на один пиксель экрана приходится хотя бы один тексель.
+    u8 mip = 0;
+    while (mip + 1 < ss->MipCount && MipSize(*ss, mip + 1) >= ScreenSize) {
+        mip++;
+    }
+    if (mip < ss->RequestedMip) {
+        ss->RequestedMip = mip;
+    }
+}
+
+static Texture* AcquireTexture(const char* name, bool AutoRelease, bool streamed)
 {
     // Вернуть текстуру по умолчанию, но предупредить об этом, поскольку она должна быть возвращена через GetDefaultTexture();
     // ЗАДАЧА: Проверить наличие других названий текстур по умолчанию?
     if (MString::Equali(name, DEFAULT_TEXTURE_NAME)) {
         MWARN("TextureSystem::Acquire: вызывает текстуру по умолчанию. Используйте TextureSystem::GetDefaultTexture для текстуры «по умолчанию».");
-        return GetDefaultTexture(Texture::Default);
+        return TextureSystem::GetDefaultTexture(Texture::Default);
     }
 
     if (MString::Equali(name, DEFAULT_DIFFUSE_TEXTURE_NAME)) {
         MWARN("TextureSystem::Acquire вызывается для диффузной текстуры по умолчанию. Используйте TextureSystem::GetDefaultTexture для текстуры 'default_diffuse'.");
-        return GetDefaultTexture(Texture::Diffuse);
+        return TextureSystem::GetDefaultTexture(Texture::Diffuse);
     }
 
     if (MString::Equali(name, DEFAULT_SPECULAR_TEXTURE_NAME)) {
         MWARN("TextureSystem::Acquire вызывается для текстуры по умолчанию. Используйте TextureSystem::GetDefaultTexture для текстуры 'default_specular'.");
-        return GetDefaultTexture(Texture::Specular);
+        return TextureSystem::GetDefaultTexture(Texture::Specular);
     }
 
     if (MString::Equali(name, DEFAULT_NORMAL_TEXTURE_NAME)) {
         MWARN("TextureSystem::Acquire вызывается для текстуры по умолчанию. Используйте TextureSystem::GetDefaultTexture для текстуры 'default_normal'.");
-        return GetDefaultTexture(Texture::Normal);
+        return TextureSystem::GetDefaultTexture(Texture::Normal);
     }
 
     u32 id = INVALID::ID;
     // ПРИМЕЧАНИЕ: Увеличивает счетчик ссылок или создает новую запись.
-    if (!ProcessTextureReference(name, TextureType::_2D, 1, AutoRelease, false, id)) {
+    if (!ProcessTextureReference(name, TextureType::_2D, 1, AutoRelease, false, id, streamed)) {
         MERROR("TextSystem::Acquire не удалось получить новый идентификатор текстуры.");
         return nullptr;
     }
     return &state->RegisteredTextures[id];
 }
 
+Texture *TextureSystem::Acquire(const char* name, bool AutoRelease)
+{
+    return AcquireTexture(name, AutoRelease, false);
+}
+
+Texture *TextureSystem::AcquireStreamed(const char *name, bool AutoRelease)
+{
+    return AcquireTexture(name, AutoRelease, state && state->StreamStates);
+}
+
 Texture *TextureSystem::AcquireCube(const char *name, bool AutoRelease)
 {
     // Возвращать текстуру по умолчанию, но предупреждать об этом, так как она должна быть возвращена через GetDefaultTexture();
@@ -257,6 +675,48 @@ bool TextureSystem::WriteData(Texture *texture, u32 offset, u32 size, u8* pixels
     return false;
 }
 
+bool TextureSystem::WriteRegion(Texture *texture, u32 x, u32 y, u32 width, u32 height, const u8 *pixels)
+{
+    if (!texture || !pixels || x + width > texture->width || y + height > texture->height) {
+        MERROR("TextureSystem::WriteRegion — область %ux%u в (%u, %u) вне текстуры.", width, height, x, y);
+        return false;
+    }
+    if (width && height) {
+        RenderingSystem::TextureWriteRegion(texture, x, y, width, height, pixels);
+    }
+    return true;
+}
+
+const RetentionList::Stats &TextureSystem::RetentionStats()
+{
+    static const RetentionList::Stats empty{};
+    return state ? state->retention.GetStats() : empty;
+}
+
+u32 TextureSystem::AcquireBindlessSlot()
+{
+    if (!state) {
+        return INVALID::ID;
+    }
+    if (state->FreeSlotCount > 0) {
+        return state->FreeSlots[--state->FreeSlotCount];
+    }
+    if (state->NextSlot < state->SlotCapacity) {
+        return state->NextSlot++;
+    }
+    MWARN("TextureSystem::AcquireBindlessSlot — все %u слотов заняты.", state->SlotCapacity);
+    return INVALID::ID;
+}
+
+void TextureSystem::ReleaseBindlessSlot(u32 slot)
+{
+    // Система может быть уже остановлена, когда рендерер выгружает последние текстуры.
+    if (!state || slot == INVALID::ID) {
+        return;
+    }
+    state->FreeSlots[state->FreeSlotCount++] = slot;
+}
+
 Texture *TextureSystem::GetDefaultTexture(u8 texture)
 {
     if (state) {
@@ -362,11 +822,23 @@ void LoadJobSuccess(void* params)
 {
     auto TextureParams = reinterpret_cast<TextureLoadParams*>(params);
 
+    auto ss = GetStreamState(TextureParams->OutTexture);
+    if (TextureParams->streamed) {
+        state->PendingRequests--;
+    }
+    if (ss && ss->serial != TextureParams->serial) {
+        // Текстура была уничтожена, пока выполнялось задание.
+        ResourceSystem::Unload(TextureParams->ImgRes);
+        TextureParams->ResourceName.Clear();
+        return;
+    }
+
     // Это также управляет загрузкой графического процессора. Невозможно выполнить задание, пока средство визуализации не станет многопоточным.
     auto& ResourceData = TextureParams->ImgRes.data;
 
     // Получить внутренние ресурсы текстуры и загрузить в GPU. Не может быть определено, пока рендерер не станет многопоточным.
     RenderingSystem::Load(ResourceData.pixels, &TextureParams->TempTexture);
+    TrackUpload();
 
     // Сделать копию старой текстуры.
     auto old = static_cast<Texture&&>(*TextureParams->OutTexture);
@@ -385,6 +857,22 @@ void LoadJobSuccess(void* params)
         TextureParams->OutTexture->generation = TextureParams->CurrentGeneration + 1;
     }
 
+    if (ss && ss->streamed) {
+        // Учесть новый уровень детализации потоковой текстуры.
+        ss->FullWidth = TextureParams->FullWidth;
+        ss->FullHeight = TextureParams->FullHeight;
+        ss->ChannelCount = TextureParams->OutTexture->ChannelCount;
+        ss->MipCount = 1;
+        while (MipSize(*ss, ss->MipCount - 1) > 1) {
+            ss->MipCount++;
+        }
+        state->ResidentBytes -= ss->ResidentBytes;
+        ss->ResidentMip = TextureParams->mip;
+        ss->ResidentBytes = MipBytes(*ss, ss->ResidentMip);
+        ss->PendingMip = INVALID_MIP;
+        state->ResidentBytes += ss->ResidentBytes;
+    }
+
     MTRACE("Текстура «%s» успешно загружена.", TextureParams->ResourceName.c_str());
 
     // Очистите данные.
@@ -400,6 +888,17 @@ void LoadJobFail(void *params)
 
     MERROR("Не удалось загрузить текстуру «%s».", TextureParams->ResourceName.c_str());
 
+    if (TextureParams->streamed) {
+        state->PendingRequests--;
+    }
+    if (TextureParams->reload) {
+        // Текстура остается на прежнем уровне детализации.
+        auto ss = GetStreamState(TextureParams->OutTexture);
+        if (ss && ss->serial == TextureParams->serial) {
+            ss->PendingMip = INVALID_MIP;
+        }
+    }
+
     ResourceSystem::Unload(TextureParams->ImgRes);
 }
 
@@ -408,19 +907,34 @@ bool LoadJobStart(void *params, void *ResultData)
     auto LoadParams = reinterpret_cast<TextureLoadParams*>(params);
     auto& TempTexture = LoadParams->TempTexture;
 
-    ImageResourceParams ResourceParams{ true };
-
-    bool result = ResourceSystem::Load(LoadParams->ResourceName.c_str(), eResource::Type::Image, &ResourceParams, LoadParams->ImgRes);
+    // Если файл прочитан асинхронно, загрузчику остается только декодировать его.
+    // Потоковая текстура загружается с уровнем детализации, не превышающим запрошенный размер: загрузчик
+    // декодирует исходный файл и уменьшает его в памяти здесь, на потоке задания.
+    ImageResourceParams ResourceParams{ true, LoadParams->file.data, LoadParams->file.size, LoadParams->FullPath, LoadParams->MaxSize };
+    bool result = false;
+    if (LoadParams->file.data || !LoadParams->file.success) {
+        result = LoadParams->file.success && ResourceSystem::Load(LoadParams->ResourceName.c_str(), eResource::Type::Image, &ResourceParams, LoadParams->ImgRes);
+        AsyncIO::FreeResult(LoadParams->file);
+    } else {
+        result = ResourceSystem::Load(LoadParams->ResourceName.c_str(), eResource::Type::Image, &ResourceParams, LoadParams->ImgRes);
+    }
 
     auto& ResourceData = LoadParams->ImgRes.data;
 
+    LoadParams->FullWidth = ResourceData.FullWidth;
+    LoadParams->FullHeight = ResourceData.FullHeight;
+    LoadParams->mip = ResourceData.mip;
+
     // Используйте временную текстуру для загрузки.
     TempTexture.width = ResourceData.width;
     TempTexture.height = ResourceData.height;
     TempTexture.ChannelCount = ResourceData.ChannelCount;
 
     LoadParams->CurrentGeneration = LoadParams->OutTexture->generation;
-    LoadParams->OutTexture->generation = INVALID::ID;
+    // При смене уровня детализации текстура продолжает использоваться со старыми данными до их замены.
+    if (!LoadParams->reload) {
+        LoadParams->OutTexture->generation = INVALID::ID;
+    }
 
     u64 TotalSize = TempTexture.width * TempTexture.height * TempTexture.ChannelCount;
     // Проверка прозрачности
@@ -442,7 +956,7 @@ bool LoadJobStart(void *params, void *ResultData)
     return result;
 }
 
-bool LoadTexture(const char *TextureName, Texture &t)
+bool LoadTexture(const char *TextureName, Texture &t, u32 MaxSize, bool reload)
 {
     // Запустить задание по загрузке текстур. Обрабатывает только загрузку с диска в ЦП. 
     // Загрузка в ГП выполняется после завершения этого задания.
@@ -450,14 +964,37 @@ bool LoadTexture(const char *TextureName, Texture &t)
     params.ResourceName = TextureName;
     params.OutTexture = &t;
     params.CurrentGeneration = t.generation;
+    params.MaxSize = MaxSize;
+    params.reload = reload;
+    auto ss = GetStreamState(&t);
+    params.serial = ss ? ss->serial : 0;
+    params.streamed = reload && ss && ss->streamed;
+
+    const char* FullPath = params.FullPath;
+    const bool resolved = ResourceSystem::ResolvePath(eResource::Image, TextureName, IMAGE_EXTENSIONS, IMAGE_EXTENSION_COUNT, params.FullPath);
 
     Job::Info job { LoadJobStart, LoadJobSuccess, LoadJobFail, &params, sizeof(TextureLoadParams), sizeof(TextureLoadParams) };
-    JobSystem::Submit(job);
+
+    // При первой загрузке зарегистрированной текстуры начинается наблюдение за ее файлом.
+    if (resolved && !reload && state && &t >= state->RegisteredTextures && &t < state->RegisteredTextures + state->MaxTextureCount) {
+        auto& WatchID = state->WatchIDs[&t - state->RegisteredTextures];
+        if (WatchID == INVALID::ID) {
+            ResourceSystem::WatchFile(FullPath, WatchID);
+        }
+    }
+
+    // Чтение с диска выполняется асинхронно, а декодирование начинается в задании сразу по прибытии данных.
+    // Если файл не найден или очередь переполнена, задание загружает файл само.
+    if (!AsyncIO::IsInitialized() || !resolved || !AsyncIO::Read(FullPath, job)) {
+        // Отметить, что данные не были прочитаны заранее.
+        reinterpret_cast<TextureLoadParams*>(job.ParamData)->file.success = true;
+        JobSystem::Submit(job);
+    }
     params.ResourceName.SetNullString(); // ЗАДАЧА: переделать
     return true;
 }
 
-bool ProcessTextureReference(const char *name, TextureType type, i8 ReferenceDiff, bool AutoRelease, bool SkipLoad, u32 &OutTextureId)
+bool ProcessTextureReference(const char *name, TextureType type, i8 ReferenceDiff, bool AutoRelease, bool SkipLoad, u32 &OutTextureId, bool streamed)
 {
     OutTextureId = INVALID::ID;
     if (state) {
@@ -492,10 +1029,13 @@ bool ProcessTextureReference(const char *name, TextureType type, i8 ReferenceDif
             if (ReferenceDiff < 0) {
                 // Проверьте, достиг ли счетчик ссылок 0. Если да, и ссылка настроена на автоматическое освобождение, уничтожьте текстуру.
                 if (ref.ReferenceCount == 0 && ref.AutoRelease) {
-                    Texture* texture = &state->RegisteredTextures[ref.handle];
+                    // Текстура остается загруженной в списке удержания, пока ее не вытеснят.
+                    if (state->retention.Retain(ref.handle, TextureBytes(state->RegisteredTextures[ref.handle]))) {
+                        state->RegisteredTextureTable.Set(NameCopy, ref);
+                        return true;
+                    }
 
-                    // Уничтожить/сбросить текстуру.
-                    texture->Destroy();
+                    DestroyTexture(ref.handle);
 
                     // Сбросьте ссылку.
                     ref.handle = INVALID::ID;
@@ -510,6 +1050,7 @@ bool ProcessTextureReference(const char *name, TextureType type, i8 ReferenceDif
                 if (ref.handle == INVALID::ID) {
                     // Это означает, что здесь нет текстуры. Сначала найдите свободный индекс.
                     const u32& count = state->MaxTextureCount;
+                    state->retention.Miss();
 
                     for (u32 i = 0; i < count; ++i) {
                         if (state->RegisteredTextures[i].id == INVALID::ID) {
@@ -520,6 +1061,17 @@ bool ProcessTextureReference(const char *name, TextureType type, i8 ReferenceDif
                         }
                     }
 
+                    // Свободных слотов нет: слот занимает дольше всех не использованная текстура из списка удержания.
+                    if (OutTextureId == INVALID::ID) {
+                        const u32 slot = state->retention.Oldest();
+                        if (slot != INVALID::ID) {
+                            state->retention.Evict(slot);
+                            EvictTexture(slot);
+                            ref.handle = slot;
+                            OutTextureId = slot;
+                        }
+                    }
+
                     // Пустой слот не найден, блейте об этом и загружайтесь.
                     if (OutTextureId == INVALID::ID) {
                         MFATAL("TextureSystem::ProcessTextureReference — система текстур больше не может содержать текстуры. Настройте конфигурацию, чтобы разрешить больше.");
@@ -546,7 +1098,15 @@ bool ProcessTextureReference(const char *name, TextureType type, i8 ReferenceDif
                                     return false;
                                 }
                             } else {
-                                if (!LoadTexture(name, texture)) {
+                                auto ss = GetStreamState(&texture);
+                                if (ss && streamed) {
+                                    ss->streamed = true;
+                                    ss->LastUsedFrame = state->FrameNumber;
+                                    if (ref.handle >= state->StreamSlotCount) {
+                                        state->StreamSlotCount = ref.handle + 1;
+                                    }
+                                }
+                                if (!LoadTexture(name, texture, ss && streamed ? state->StreamingBaseSize : 0)) {
                                     OutTextureId = INVALID::ID;
                                     MERROR("Не удалось загрузить текстуру «%s».", name);
                                     return false;
@@ -560,6 +1120,13 @@ bool ProcessTextureReference(const char *name, TextureType type, i8 ReferenceDif
                     }
                 } else {
                     OutTextureId = ref.handle;
+                    // Текстура без ссылок возвращается из списка удержания без загрузки.
+                    state->retention.Revive(ref.handle);
+                    auto ss = GetStreamState(&state->RegisteredTextures[ref.handle]);
+                    if (ss && ss->streamed && !streamed) {
+                        // Текстура используется там, где размер на экране не сообщается, поэтому она загружается полностью.
+                        ss->pinned = true;
+                    }
                     // MTRACE("Текстура «%s» уже существует, ref_count увеличен до %i.", name, ref.ReferenceCount);
                 }
             }
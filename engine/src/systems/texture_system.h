@@ -2,6 +2,9 @@
 
 #include "resources/texture.hpp"
 #include "containers/hashtable.hpp"
+#include "containers/retention_list.hpp"
+
+struct FrameData;
 
 #define DEFAULT_TEXTURE_NAME          "default"             // Имя текстуры по умолчанию.
 #define DEFAULT_DIFFUSE_TEXTURE_NAME  "default_diffuse"     // Имя диффизной текстуры по умолчанию.
@@ -9,6 +12,11 @@
 #define DEFAULT_NORMAL_TEXTURE_NAME   "default_normal"      // Имя текстуры нормалей по умолчанию.
 struct TextureReference;
 
+/// @brief Наибольшее количество слотов текстур в режиме без привязки (bindless). Рендерер создает массив дескрипторов такого размера.
+constexpr u32 TEXTURE_BINDLESS_MAX_SLOTS = 4096;
+/// @brief Слоты сверх MaxTextureCount для текстур вне реестра: текстур по умолчанию и временных текстур при перезагрузке.
+constexpr u32 TEXTURE_BINDLESS_RESERVED_SLOTS = 64;
+
 using ETextureFlag = u8;
 
 /// @brief Конфигурация системы текстур.
@@ -16,6 +24,17 @@ struct TextureSystemConfig
 {
     /// @brief Максимальное количество текстур, которые можно загрузить одновременно.
     u32 MaxTextureCount;
+    /// @brief Включает потоковую загрузку текстур, полученных через AcquireStreamed.
+    bool streaming;
+    /// @brief Бюджет памяти для потоковых текстур в байтах.
+    u64 StreamingBudget;
+    /// @brief Наибольший размер стороны уровня детализации, с которого начинается загрузка потоковой текстуры.
+    u32 StreamingBaseSize;
+    /// @brief Бюджет памяти в байтах для текстур с AutoRelease, на которые не осталось ссылок. 
+    /// Такие текстуры не выгружаются сразу, а удерживаются, пока бюджет не будет превышен. 0 - выгружаются сразу.
+    u64 RetentionBudget;
+    /// @brief Наибольшее количество удерживаемых текстур, вытесняемых за один кадр.
+    u32 RetentionEvictionsPerFrame;
 };
 
 namespace TextureSystem
@@ -24,6 +43,12 @@ namespace TextureSystem
     bool Initialize(u64& MemoryRequirement, void* memory, void* config);
     void Shutdown();
 
+    /// @brief Обрабатывает запросы потоковой загрузки текстур и вытесняет давно не использованные уровни детализации, если превышен бюджет.
+    /// @param state указатель на состояние системы.
+    /// @param rFrameData данные текущего кадра.
+    /// @return true в случае успеха; в противном случае false.
+    bool Update(void* state, const FrameData& rFrameData);
+
     /// @brief Пытается получить текстуру с заданным именем. Если она еще не загружена, это запускает её загрузку. 
     /// Если текстура не найдена, возвращается указатель на текстуру по умолчанию. Если текстура найдена и загружена, ее счетчик ссылок увеличивается.
     /// @param name Имя текстуры, которую нужно найти.
@@ -31,6 +56,24 @@ namespace TextureSystem
     /// @return Указатель на загруженную текстуру. Может быть указателем на текстуру по умолчанию, если она не найдена.
     MAPI Texture* Acquire(const char* name, bool AutoRelease);
 
+    /// @brief Получает текстуру так же, как Acquire, но при включенной потоковой загрузке текстура сначала загружается
+    /// с низким уровнем детализации, а более подробные уровни загружаются по мере необходимости (см. ReportScreenSize).
+    /// Указатель на текстуру остается действительным при смене уровня детализации, меняются только ее внутренние данные.
+    /// ПРИМЕЧАНИЕ: Если та же текстура получена через Acquire, она загружается полностью и больше не вытесняется.
+    /// @param name имя текстуры, которую нужно найти.
+    /// @param AutoRelease указывает, должна ли текстура автоматически освобождаться, когда ее счетчик ссылок равен 0.
+    /// @return Указатель на загруженную текстуру.
+    MAPI Texture* AcquireStreamed(const char* name, bool AutoRelease);
+
+    /// @brief Сообщает размер, который текстура занимает на экране в текущем кадре. Используется для выбора уровня детализации
+    /// потоковых текстур; для остальных текстур вызов игнорируется.
+    /// @param texture указатель на текстуру.
+    /// @param ScreenSize приблизительный размер в пикселях, который текстура занимает на экране.
+    MAPI void ReportScreenSize(Texture* texture, u32 ScreenSize);
+
+    /// @brief Возвращает счетчики удержания текстур без ссылок: попадания, промахи, вытеснения и удерживаемый объем.
+    MAPI const RetentionList::Stats& RetentionStats();
+
     /// @brief Пытается получить текстуру кубической карты с указанным именем. 
     /// Если она еще не загружена, это запускает ее загрузку. 
     /// Если текстура не найдена, возвращается указатель на текстуру по умолчанию. 
@@ -104,6 +147,25 @@ namespace TextureSystem
     /// @return true в случае успеха, иначе false.
     MAPI bool WriteData(Texture* texture, u32 offset, u32 size, u8* pixels);
 
+    /// @brief Записывает прямоугольную область записываемой текстуры. Остальное содержимое текстуры сохраняется.
+    /// @param texture указатель на текстуру, в которую нужно записать.
+    /// @param x левая граница области в пикселях.
+    /// @param y верхняя граница области в пикселях.
+    /// @param width ширина области в пикселях.
+    /// @param height высота области в пикселях.
+    /// @param pixels пиксели области построчно, без промежутков между строками.
+    /// @return true в случае успеха, иначе false.
+    MAPI bool WriteRegion(Texture* texture, u32 x, u32 y, u32 width, u32 height, const u8* pixels);
+
+    /// @brief Выделяет индекс в массиве текстур режима без привязки (bindless). Вызывается рендерером при создании
+    /// внутренних данных текстуры; слот принадлежит этим данным и освобождается вместе с ними.
+    /// @return индекс слота или INVALID::ID, если свободных слотов нет или система не инициализирована.
+    MAPI u32 AcquireBindlessSlot();
+
+    /// @brief Освобождает индекс, выделенный AcquireBindlessSlot.
+    /// @param slot индекс слота. INVALID::ID игнорируется.
+    MAPI void ReleaseBindlessSlot(u32 slot);
+
     /// @brief Функция для получения стандартной текстуры.
     /// @return указатель на стандартную текстуру.
     MAPI Texture* GetDefaultTexture(u8 texture);
@@ -0,0 +1,175 @@
+#include "lz4.h"
+#include "core/memory_system.h"
+
+// Параметры формата LZ4.
+constexpr u32 MIN_MATCH     = 4;        // Минимальная длина совпадения.
+constexpr u32 LAST_LITERALS = 5;        // Последние 5 байт блока всегда являются литералами.
+constexpr u32 MF_LIMIT      = 12;       // Совпадение не может начинаться ближе 12 байт к концу блока.
+constexpr u32 MAX_DISTANCE  = 65535;    // Максимальное смещение совпадения.
+constexpr u32 HASH_LOG      = 12;       // Размер хеш-таблицы компрессора (2^12 записей).
+
+MINLINE u32 Read32(const u8* p)
+{
+    return (u32)p[0] | ((u32)p[1] << 8) | ((u32)p[2] << 16) | ((u32)p[3] << 24);
+}
+
+MINLINE u32 Hash32(u32 sequence)
+{
+    return (sequence * 2654435761U) >> (32 - HASH_LOG);
+}
+
+/// @brief Записывает длину, превышающую 15, в виде последовательности байт 255 и остатка.
+MINLINE u8* WriteLength(u8* op, u64 length)
+{
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = (u8)length;
+    return op;
+}
+
+/// @brief Записывает одну последовательность: литералы и (если MatchLength > 0) ссылку на совпадение.
+static u8* WriteSequence(u8* op, const u8* literals, u64 LiteralLength, u32 offset, u64 MatchLength)
+{
+    u8* token = op++;
+    *token = (u8)((LiteralLength >= 15 ? 15 : LiteralLength) << 4);
+    if (LiteralLength >= 15) {
+        op = WriteLength(op, LiteralLength - 15);
+    }
+    MemorySystem::CopyMem(op, literals, LiteralLength);
+    op += LiteralLength;
+
+    if (MatchLength == 0) {
+        return op;
+    }
+
+    *op++ = (u8)(offset & 0xFF);
+    *op++ = (u8)(offset >> 8);
+
+    u64 ml = MatchLength - MIN_MATCH;
+    *token |= (u8)(ml >= 15 ? 15 : ml);
+    if (ml >= 15) {
+        op = WriteLength(op, ml - 15);
+    }
+    return op;
+}
+
+u64 LZ4::Compress(const u8 *source, u64 SourceSize, u8 *dest, u64 DestCapacity)
+{
+    if (!source || !dest || DestCapacity < CompressBound(SourceSize)) {
+        return 0;
+    }
+
+    u8* op = dest;
+    u64 anchor = 0;
+
+    if (SourceSize > MF_LIMIT) {
+        // Позиции хранятся со смещением +1, чтобы 0 означал пустую запись.
+        u32 table[1 << HASH_LOG]{};
+        const u64 MatchLimit = SourceSize - MF_LIMIT;
+        const u64 MatchEnd = SourceSize - LAST_LITERALS;
+
+        u64 ip = 0;
+        while (ip < MatchLimit) {
+            const u32 sequence = Read32(source + ip);
+            const u32 h = Hash32(sequence);
+            const u64 ref = table[h];
+            table[h] = (u32)(ip + 1);
+
+            if (ref == 0 || ip - (ref - 1) > MAX_DISTANCE || Read32(source + ref - 1) != sequence) {
+                ip++;
+                continue;
+            }
+
+            const u64 MatchPos = ref - 1;
+            u64 MatchLength = MIN_MATCH;
+            while (ip + MatchLength < MatchEnd && source[MatchPos + MatchLength] == source[ip + MatchLength]) {
+                MatchLength++;
+            }
+
+            op = WriteSequence(op, source + anchor, ip - anchor, (u32)(ip - MatchPos), MatchLength);
+            ip += MatchLength;
+            anchor = ip;
+        }
+    }
+
+    // Оставшиеся байты записываются последней последовательностью без совпадения.
+    op = WriteSequence(op, source + anchor, SourceSize - anchor, 0, 0);
+    return (u64)(op - dest);
+}
+
+u64 LZ4::Decompress(const u8 *source, u64 SourceSize, u8 *dest, u64 DestCapacity)
+{
+    if (!source || !dest || SourceSize == 0) {
+        return 0;
+    }
+
+    const u8* ip = source;
+    const u8* const iend = source + SourceSize;
+    u8* op = dest;
+    u8* const oend = dest + DestCapacity;
+
+    while (ip < iend) {
+        const u8 token = *ip++;
+
+        // Литералы.
+        u64 length = token >> 4;
+        if (length == 15) {
+            u8 b = 0;
+            do {
+                if (ip >= iend) {
+                    return 0;
+                }
+                b = *ip++;
+                length += b;
+            } while (b == 255);
+        }
+        if (length > (u64)(iend - ip) || length > (u64)(oend - op)) {
+            return 0;
+        }
+        MemorySystem::CopyMem(op, ip, length);
+        ip += length;
+        op += length;
+
+        // Последняя последовательность содержит только литералы.
+        if (ip >= iend) {
+            break;
+        }
+
+        // Совпадение.
+        if (iend - ip < 2) {
+            return 0;
+        }
+        const u64 offset = (u64)ip[0] | ((u64)ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (u64)(op - dest)) {
+            return 0;
+        }
+
+        length = token & 15;
+        if (length == 15) {
+            u8 b = 0;
+            do {
+                if (ip >= iend) {
+                    return 0;
+                }
+                b = *ip++;
+                length += b;
+            } while (b == 255);
+        }
+        length += MIN_MATCH;
+        if (length > (u64)(oend - op)) {
+            return 0;
+        }
+
+        // Совпадение может перекрывать записываемые данные, поэтому копируем побайтно.
+        const u8* match = op - offset;
+        for (u64 i = 0; i < length; ++i) {
+            op[i] = match[i];
+        }
+        op += length;
+    }
+
+    return (u64)(op - dest);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "defines.h"
+
+/// @brief Минимальная реализация блочного формата LZ4 (без кадров и контрольных сумм).
+/// Используется пакетами ресурсов; сжатые данные совместимы с эталонным LZ4_decompress_safe.
+namespace LZ4 {
+    /// @brief Возвращает размер буфера, достаточный для сжатия SourceSize байт в худшем случае.
+    /// @param SourceSize размер исходных данных в байтах.
+    constexpr u64 CompressBound(u64 SourceSize) { return SourceSize + (SourceSize / 255) + 16; }
+
+    /// @brief Сжимает блок данных жадным поиском совпадений по хеш-таблице.
+    /// @param source исходные данные.
+    /// @param SourceSize размер исходных данных в байтах.
+    /// @param dest буфер назначения, размером не меньше CompressBound(SourceSize).
+    /// @param DestCapacity размер буфера назначения в байтах.
+    /// @return Размер сжатых данных в байтах; 0 в случае ошибки.
+    MAPI u64 Compress(const u8* source, u64 SourceSize, u8* dest, u64 DestCapacity);
+
+    /// @brief Распаковывает блок данных с проверкой всех границ.
+    /// @param source сжатые данные.
+    /// @param SourceSize размер сжатых данных в байтах.
+    /// @param dest буфер назначения.
+    /// @param DestCapacity размер буфера назначения в байтах.
+    /// @return Размер распакованных данных в байтах; 0 если данные повреждены или не помещаются в буфер.
+    MAPI u64 Decompress(const u8* source, u64 SourceSize, u8* dest, u64 DestCapacity);
+} // namespace LZ4
@@ -0,0 +1,12 @@
+#include "headless_render_plugin_main.h"
+#include "renderer/headless/headless_api.h"
+
+RendererPlugin *PluginCreate()
+{
+    return new HeadlessAPI();
+}
+
+void PluginDestroy(RendererPlugin* plugin)
+{
+    delete plugin;
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include "defines.h"
+
+class RendererPlugin;
+
+/// @brief Создает новый плагин рендеринга без графического процессора.
+/// @return указатель на плагин рендеринга.
+extern "C" MAPI RendererPlugin* PluginCreate();
+
+/// @brief Уничтожает плагин рендеринга, созданный PluginCreate.
+/// @param plugin указатель на плагин рендеринга.
+extern "C" MAPI void PluginDestroy(RendererPlugin* plugin);
@@ -0,0 +1,1035 @@
+#include "headless_api.h"
+#include "renderer/renderpass.h"
+#include "renderer/render_view.h"
+#include "resources/geometry.h"
+#include <systems/texture_system.h>
+#include <core/event.h>
+#include <core/frame_data.h>
+#include <math/vertex.h>
+#include <new>
+
+/// @brief Внутренние данные прохода рендеринга: значения очистки, которые использовал бы графический API.
+struct HeadlessRenderpass {
+    f32 depth;
+    u32 stencil;
+};
+
+// Контекст записи, в который пишет текущий поток. nullptr — запись идет в журнал кадра.
+static thread_local HeadlessRecordingContext* CurrentRecordingContext = nullptr;
+
+/// @brief Размер образа текстуры в байтах.
+MINLINE u64 ImageSize(const Texture* texture, u32 width, u32 height)
+{
+    const u64 channels = texture->ChannelCount > 0 ? texture->ChannelCount : 4;
+    return (u64)width * height * channels * (texture->type == TextureType::Cube ? 6 : 1);
+}
+
+static HeadlessImage* CreateImage(const Texture* texture, u32 width, u32 height)
+{
+    auto image = MemorySystem::TAllocate<HeadlessImage>(Memory::Renderer);
+    image->size = ImageSize(texture, width, height);
+    image->pixels = image->size > 0 ? reinterpret_cast<u8*>(MemorySystem::Allocate(image->size, Memory::Texture, true)) : nullptr;
+    return image;
+}
+
+static void DestroyImage(HeadlessImage* image)
+{
+    if (image) {
+        if (image->pixels) {
+            MemorySystem::Free(image->pixels, image->size, Memory::Texture);
+        }
+        MemorySystem::Free(image, sizeof(HeadlessImage), Memory::Renderer);
+    }
+}
+
+HeadlessAPI::HeadlessAPI() :
+// Как и в Vulkan, это лишь значения по умолчанию до первого изменения размера.
+FramebufferWidth(800), FramebufferHeight(600),
+FramebufferSizeGeneration(),
+FramebufferSizeLastGeneration(),
+flags(),
+// Журналы не зависят от графического API, поэтому параллельная запись поддерживается всегда.
+MultithreadingEnabled(true),
+ImageIndex(),
+ViewportRect(),
+ScissorRect(),
+RenderTextures(),
+DepthTextures(),
+// Буферы меньше, чем у Vulkan: они занимают память хоста, а сцены тестового стенда невелики. При необходимости их размер увеличивается.
+ObjectVertexBuffer("renderbuffer_vertexbuffer_globalgeometry", RenderBufferType::Vertex, sizeof(Vertex3D) * 1024 * 1024, true),
+ObjectIndexBuffer("renderbuffer_indexbuffer_globalgeometry", RenderBufferType::Index, sizeof(u32) * 1024 * 1024 * 4, true),
+geometries(),
+BoundShader(nullptr),
+CommandLog(),
+RecordingContexts(),
+FrameStats(),
+readbacks(),
+NextReadbackTicket()
+{}
+
+HeadlessAPI::~HeadlessAPI()
+{
+}
+
+bool HeadlessAPI::Initialize(const RenderingConfig &config, u8 &OutWindowRenderTargetCount)
+{
+    flags = config.flags;
+
+    // Журнал команд растет до размера самого большого кадра и затем не перераспределяется.
+    CommandLog.Reserve(4096);
+    for (auto& context : RecordingContexts) {
+        context.CommandLog.Reserve(1024);
+    }
+
+    CreateWindowAttachments();
+    FramebufferSizeLastGeneration = FramebufferSizeGeneration;
+    OutWindowRenderTargetCount = HEADLESS_IMAGE_COUNT;
+
+    if (!RenderBufferCreateInternal(ObjectVertexBuffer)) {
+        MERROR("Ошибка создания буфера вершин.");
+        return false;
+    }
+    if (!RenderBufferCreateInternal(ObjectIndexBuffer)) {
+        MERROR("Ошибка создания буфера индексов.");
+        return false;
+    }
+
+    MINFO("Средство визуализации без графического процессора успешно инициализировано.");
+    return true;
+}
+
+void HeadlessAPI::ShutDown()
+{
+    RenderBufferDestroyInternal(ObjectVertexBuffer);
+    RenderBufferDestroyInternal(ObjectIndexBuffer);
+
+    for (u8 i = 0; i < HEADLESS_IMAGE_COUNT; ++i) {
+        DestroyImage(reinterpret_cast<HeadlessImage*>(RenderTextures[i].data));
+        RenderTextures[i].data = nullptr;
+        DestroyImage(reinterpret_cast<HeadlessImage*>(DepthTextures[i].data));
+        DepthTextures[i].data = nullptr;
+    }
+
+    CommandLog.Destroy();
+    for (auto& context : RecordingContexts) {
+        context.CommandLog.Destroy();
+    }
+}
+
+void HeadlessAPI::Resized(u16 width, u16 height)
+{
+    FramebufferWidth = width;
+    FramebufferHeight = height;
+    FramebufferSizeGeneration++;
+
+    MINFO("API рендеринга без ГП-> изменен размер: w/h/gen: %i/%i/%llu", width, height, FramebufferSizeGeneration);
+}
+
+bool HeadlessAPI::PrepareFrame(const FrameData &rFrameData)
+{
+    // Изменение размера обрабатывается так же, как пересоздание цепочки обмена в Vulkan: кадр пропускается.
+    if (FramebufferSizeGeneration != FramebufferSizeLastGeneration) {
+        CreateWindowAttachments();
+        FramebufferSizeLastGeneration = FramebufferSizeGeneration;
+
+        EventContext context = {};
+        EventSystem::Fire(EventSystem::DefaultRendertargetRefreshRequired, nullptr, context);
+        return false;
+    }
+
+    ImageIndex = (ImageIndex + 1) % HEADLESS_IMAGE_COUNT;
+    return true;
+}
+
+bool HeadlessAPI::Begin(const FrameData &rFrameData)
+{
+    CommandLog.Clear();
+    SetWinding(RendererWinding::CounterClockwise);
+    return true;
+}
+
+bool HeadlessAPI::End(const FrameData &rFrameData)
+{
+    // Сводка составляется по журналу, чтобы запись каждой команды оставалась одной вставкой.
+    FrameStats = HeadlessFrameStats();
+    const u32 count = CommandLog.Length();
+    FrameStats.commands = count;
+    for (u32 i = 0; i < count; ++i) {
+        const auto& command = CommandLog[i];
+        FrameStats.counts[command.type]++;
+        switch (command.type) {
+            case HeadlessCommand::Draw:
+            case HeadlessCommand::DrawIndexed:
+                FrameStats.draws++;
+                FrameStats.primitives += command.a;
+                break;
+            case HeadlessCommand::BufferUpload:
+            case HeadlessCommand::TextureUpload:
+                FrameStats.UploadBytes += command.b;
+                break;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+bool HeadlessAPI::Present(const FrameData &rFrameData)
+{
+    return true;
+}
+
+void HeadlessAPI::SetViewport(const Rect2D &rect)
+{
+    ViewportRect = rect;
+    Record(HeadlessCommand::SetViewport);
+}
+
+void HeadlessAPI::ViewportReset()
+{
+    SetViewport(ViewportRect);
+}
+
+void HeadlessAPI::SetScissor(const Rect2D &rect)
+{
+    ScissorRect = rect;
+    Record(HeadlessCommand::SetScissor);
+}
+
+void HeadlessAPI::ScissorReset()
+{
+    SetScissor(ScissorRect);
+}
+
+void HeadlessAPI::SetWinding(RendererWinding winding)
+{
+    Record(HeadlessCommand::SetWinding, static_cast<u32>(winding));
+}
+
+bool HeadlessAPI::RenderpassBegin(Renderpass *pass, RenderTarget &target)
+{
+    Record(HeadlessCommand::RenderpassBegin, pass->id);
+    return true;
+}
+
+bool HeadlessAPI::RenderpassEnd(Renderpass *pass)
+{
+    Record(HeadlessCommand::RenderpassEnd, pass->id);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+//                                  Texture                                       //
+////////////////////////////////////////////////////////////////////////////////////
+
+void HeadlessAPI::Load(const u8 *pixels, Texture *texture)
+{
+    auto image = CreateImage(texture, texture->width, texture->height);
+    texture->data = image;
+
+    TextureWriteData(texture, 0, image->size, pixels);
+    texture->generation++;
+}
+
+void HeadlessAPI::LoadTextureWriteable(Texture *texture)
+{
+    texture->data = CreateImage(texture, texture->width, texture->height);
+    texture->generation++;
+}
+
+void HeadlessAPI::TextureResize(Texture *texture, u32 NewWidth, u32 NewHeight)
+{
+    if (texture && texture->data) {
+        DestroyImage(reinterpret_cast<HeadlessImage*>(texture->data));
+        texture->data = CreateImage(texture, NewWidth, NewHeight);
+        texture->generation++;
+    }
+}
+
+void HeadlessAPI::TextureWriteData(Texture *texture, u32 offset, u32 size, const u8 *pixels)
+{
+    auto image = reinterpret_cast<HeadlessImage*>(texture->data);
+    if (image && pixels && offset < image->size) {
+        const u64 bytes = offset + size > image->size ? image->size - offset : size;
+        MemorySystem::CopyMem(image->pixels + offset, pixels, bytes);
+        Record(HeadlessCommand::TextureUpload, 0, bytes);
+    }
+    texture->generation++;
+}
+
+void HeadlessAPI::TextureWriteRegion(Texture *texture, u32 x, u32 y, u32 width, u32 height, const u8 *pixels)
+{
+    auto image = reinterpret_cast<HeadlessImage*>(texture->data);
+    if (image && pixels) {
+        const u8 channels = texture->ChannelCount > 0 ? texture->ChannelCount : 4;
+        const u64 RowSize = (u64)width * channels;
+        for (u32 row = 0; row < height; ++row) {
+            const u64 offset = ((u64)(y + row) * texture->width + x) * channels;
+            if (offset + RowSize > image->size) {
+                break;
+            }
+            MemorySystem::CopyMem(image->pixels + offset, pixels + row * RowSize, RowSize);
+        }
+        Record(HeadlessCommand::TextureUpload, 0, RowSize * height);
+    }
+    texture->generation++;
+}
+
+void HeadlessAPI::TextureReadData(Texture *texture, u32 offset, u32 size, void **OutMemory)
+{
+    auto image = reinterpret_cast<HeadlessImage*>(texture->data);
+    if (!image || !OutMemory || offset + size > image->size) {
+        MERROR("HeadlessAPI::TextureReadData: неверный диапазон чтения текстуры '%s'.", texture->name);
+        return;
+    }
+    MemorySystem::CopyMem(*OutMemory, image->pixels + offset, size);
+}
+
+void HeadlessAPI::TextureReadPixel(Texture *texture, u32 x, u32 y, u8 **OutRgba)
+{
+    auto image = reinterpret_cast<HeadlessImage*>(texture->data);
+    if (!image || !OutRgba || x >= texture->width || y >= texture->height) {
+        MERROR("HeadlessAPI::TextureReadPixel: пиксель (%u, %u) вне текстуры '%s'.", x, y, texture->name);
+        return;
+    }
+
+    const u8 channels = texture->ChannelCount > 0 ? texture->ChannelCount : 4;
+    const u8* pixel = image->pixels + ((u64)y * texture->width + x) * channels;
+    for (u8 i = 0; i < 4; ++i) {
+        (*OutRgba)[i] = i < channels ? pixel[i] : 0;
+    }
+}
+
+u64 HeadlessAPI::TextureReadDataAsync(Texture *texture, u32 offset, u32 size)
+{
+    return ReadbackRequest(texture, 0, 0, offset, size, false);
+}
+
+u64 HeadlessAPI::TextureReadPixelAsync(Texture *texture, u32 x, u32 y)
+{
+    return ReadbackRequest(texture, x, y, 0, 0, true);
+}
+
+ReadbackStatus HeadlessAPI::ReadbackPoll(u64 ticket, void *OutMemory)
+{
+    if (!ticket) {
+        return ReadbackStatus::Invalid;
+    }
+
+    for (auto& readback : readbacks) {
+        if (__atomic_load_n(&readback.ticket, __ATOMIC_ACQUIRE) != ticket) {
+            continue;
+        }
+        u32 expected = HeadlessReadback::Requested;
+        if (!__atomic_compare_exchange_n(&readback.state, &expected, HeadlessReadback::Claimed, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            return ReadbackStatus::Invalid;
+        }
+
+        // GPU нет, поэтому чтение «завершается» к первому опросу.
+        if (readback.pixel) {
+            u8* rgba = reinterpret_cast<u8*>(OutMemory);
+            TextureReadPixel(readback.texture, readback.x, readback.y, &rgba);
+        } else {
+            TextureReadData(readback.texture, readback.offset, readback.size, &OutMemory);
+        }
+
+        __atomic_store_n(&readback.ticket, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&readback.state, HeadlessReadback::Free, __ATOMIC_RELEASE);
+        return ReadbackStatus::Ready;
+    }
+    return ReadbackStatus::Invalid;
+}
+
+void *HeadlessAPI::TextureCopyData(const Texture *texture)
+{
+    auto source = reinterpret_cast<HeadlessImage*>(texture->data);
+    auto image = MemorySystem::TAllocate<HeadlessImage>(Memory::Renderer);
+    image->size = source->size;
+    image->pixels = reinterpret_cast<u8*>(MemorySystem::Allocate(image->size, Memory::Texture));
+    MemorySystem::CopyMem(image->pixels, source->pixels, image->size);
+    return image;
+}
+
+void HeadlessAPI::Unload(Texture *texture)
+{
+    if (texture->data) {
+        DestroyImage(reinterpret_cast<HeadlessImage*>(texture->data));
+        texture->data = nullptr;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+//                                  Geometry                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+bool HeadlessAPI::CreateGeometry(Geometry *geometry)
+{
+    return true;
+}
+
+bool HeadlessAPI::Load(Geometry *geometry, u32 VertexOffset, u32 VertexSize, u32 IndexOffset, u32 IndexSize)
+{
+    const bool IsReupload = geometry->InternalID != INVALID::ID;
+
+    HeadlessGeometry* internal = nullptr;
+    if (IsReupload) {
+        internal = &geometries[geometry->InternalID];
+    } else {
+        for (u32 i = 0; i < HEADLESS_MAX_GEOMETRY_COUNT; ++i) {
+            if (geometries[i].id == INVALID::ID) {
+                geometry->InternalID = i;
+                geometries[i].id = i;
+                internal = &geometries[i];
+                break;
+            }
+        }
+    }
+
+    if (!internal) {
+        MFATAL("HeadlessAPI::Load не удалось найти свободный индекс для загрузки новой геометрии.");
+        return false;
+    }
+
+    if (!IsReupload && !ObjectVertexBuffer.Allocate(geometry->VertexElementSize * geometry->VertexCount, internal->VertexBufferOffset)) {
+        MERROR("HeadlessAPI::Load не удалось выделить память из буфера вершин!");
+        return false;
+    }
+    if (!RenderBufferLoadRange(ObjectVertexBuffer, internal->VertexBufferOffset + VertexOffset, VertexSize, (u8*)geometry->vertices + VertexOffset)) {
+        MERROR("HeadlessAPI::Load не удалось загрузить данные в буфер вершин!");
+        return false;
+    }
+
+    if (geometry->IndexCount && geometry->indices && IndexSize) {
+        if (!IsReupload && !ObjectIndexBuffer.Allocate(geometry->IndexElementSize * geometry->IndexCount, internal->IndexBufferOffset)) {
+            MERROR("HeadlessAPI::Load не удалось выделить данные из буфера индекса!");
+            return false;
+        }
+        if (!RenderBufferLoadRange(ObjectIndexBuffer, internal->IndexBufferOffset + IndexOffset, IndexSize, (u8*)geometry->indices + IndexOffset)) {
+            MERROR("HeadlessAPI::Load не удалось загрузить данные в буфер индекса!");
+            return false;
+        }
+    }
+
+    internal->generation = internal->generation == INVALID::ID ? 0 : internal->generation + 1;
+    return true;
+}
+
+void HeadlessAPI::Unload(Geometry *geometry)
+{
+    if (geometry && geometry->InternalID != INVALID::ID) {
+        auto& internal = geometries[geometry->InternalID];
+
+        if (!ObjectVertexBuffer.Free(geometry->VertexElementSize * geometry->VertexCount, internal.VertexBufferOffset)) {
+            MERROR("HeadlessAPI::Unload не удалось освободить диапазон буфера вершин.");
+        }
+        if (geometry->IndexCount && !ObjectIndexBuffer.Free(geometry->IndexElementSize * geometry->IndexCount, internal.IndexBufferOffset)) {
+            MERROR("HeadlessAPI::Unload не удалось освободить диапазон буфера индексов.");
+        }
+
+        internal = HeadlessGeometry();
+    }
+}
+
+void HeadlessAPI::GeometryVertexUpdate(Geometry *geometry, u32 offset, u32 VertexCount, void *vertices)
+{
+    auto& internal = geometries[geometry->InternalID];
+    if (VertexCount > geometry->VertexCount) {
+        MFATAL("HeadlessAPI::GeometryVertexUpdate realloc не поддерживается.");
+        return;
+    }
+
+    if (!RenderBufferLoadRange(ObjectVertexBuffer, internal.VertexBufferOffset + offset, VertexCount * geometry->VertexElementSize, (u8*)vertices + offset)) {
+        MERROR("HeadlessAPI::GeometryVertexUpdate не удалось загрузить в буфер вершин!");
+    }
+}
+
+void HeadlessAPI::DrawGeometry(const GeometryRenderData &data)
+{
+    // Игнорировать незагруженные геометрии.
+    if (data.geometry && data.geometry->InternalID == INVALID::ID) {
+        return;
+    }
+
+    const auto& internal = geometries[data.geometry->InternalID];
+    const bool IncludesIndexData = data.geometry->IndexCount > 0;
+    RenderBufferDraw(ObjectVertexBuffer, internal.VertexBufferOffset, data.geometry->VertexCount, IncludesIndexData);
+    if (IncludesIndexData) {
+        RenderBufferDraw(ObjectIndexBuffer, internal.IndexBufferOffset, data.geometry->IndexCount, false);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+//                                  Shader                                        //
+////////////////////////////////////////////////////////////////////////////////////
+
+// ЗАДАЧА: Shader::ShaderData пока типизирован под Vulkan, поэтому данные хранятся через приведение указателя.
+MINLINE HeadlessShader* GetShaderData(Shader* shader) { return reinterpret_cast<HeadlessShader*>(shader->ShaderData); }
+
+bool HeadlessAPI::Load(Shader *shader, const ShaderConfig &config, Renderpass *renderpass, const DArray<Shader::Stage> &stages, const DArray<MString> &StageFilenames)
+{
+    // Модули этапов не компилируются: стоимость компиляции шейдеров не относится к затратам кадра.
+    auto data = new(MemorySystem::Allocate(sizeof(HeadlessShader), Memory::Renderer)) HeadlessShader();
+    shader->ShaderData = reinterpret_cast<struct VulkanShader*>(data);
+    shader->TopologyTypes = config.TopologyTypes;
+    return true;
+}
+
+void HeadlessAPI::Unload(Shader *shader)
+{
+    if (shader && shader->ShaderData) {
+        auto data = GetShaderData(shader);
+        for (u32 i = 0; i < HEADLESS_MAX_INSTANCE_COUNT; ++i) {
+            if (data->InstanceStates[i].id != INVALID::ID) {
+                ShaderReleaseInstanceResources(shader, i);
+            }
+        }
+        RenderBufferDestroyInternal(data->UniformBuffer);
+        data->~HeadlessShader();
+        MemorySystem::Free(data, sizeof(HeadlessShader), Memory::Renderer);
+        shader->ShaderData = nullptr;
+    }
+}
+
+bool HeadlessAPI::ShaderInitialize(Shader *shader)
+{
+    auto data = GetShaderData(shader);
+
+    shader->RequiredUboAlignment = HEADLESS_UBO_ALIGNMENT;
+    shader->GlobalUboStride = Range::GetAligned(shader->GlobalUboSize, shader->RequiredUboAlignment);
+    shader->UboStride = Range::GetAligned(shader->UboSize, shader->RequiredUboAlignment);
+
+    const u64 TotalBufferSize = shader->GlobalUboStride + (shader->UboStride * HEADLESS_MAX_INSTANCE_COUNT);
+    if (!RenderBufferCreate("renderbuffer_global_uniform", RenderBufferType::Uniform, TotalBufferSize, true, data->UniformBuffer)) {
+        MERROR("HeadlessAPI::ShaderInitialize — не удалось создать униформный буфер шейдера.");
+        return false;
+    }
+
+    if (!data->UniformBuffer.Allocate(shader->GlobalUboStride, shader->GlobalUboOffset)) {
+        MERROR("Не удалось выделить место для универсального буфера!");
+        return false;
+    }
+
+    data->MappedUniformBufferBlock = reinterpret_cast<u8*>(RenderBufferMapMemory(data->UniformBuffer, 0, TotalBufferSize));
+    return true;
+}
+
+bool HeadlessAPI::ShaderReload(Shader *shader)
+{
+    // Перезагружать нечего: модули этапов не создаются.
+    return shader && shader->ShaderData;
+}
+
+bool HeadlessAPI::ShaderUse(Shader *shader)
+{
+    if (CurrentRecordingContext) {
+        CurrentRecordingContext->BoundShader = shader;
+    } else {
+        BoundShader = shader;
+    }
+    Record(HeadlessCommand::ShaderUse, shader->id);
+    return true;
+}
+
+bool HeadlessAPI::ShaderApplyGlobals(Shader *shader, bool NeedsUpdate)
+{
+    Record(HeadlessCommand::ApplyGlobals, shader->id, NeedsUpdate);
+    return true;
+}
+
+bool HeadlessAPI::ShaderApplyInstance(Shader *shader, bool NeedsUpdate)
+{
+    Record(HeadlessCommand::ApplyInstance, shader->BoundInstanceID, NeedsUpdate);
+    return true;
+}
+
+bool HeadlessAPI::ShaderBindInstance(Shader *shader, u32 InstanceID)
+{
+    shader->BoundInstanceID = InstanceID;
+    shader->BoundUboOffset = GetShaderData(shader)->InstanceStates[InstanceID].offset;
+    Record(HeadlessCommand::BindInstance, InstanceID);
+    return true;
+}
+
+bool HeadlessAPI::ShaderAcquireInstanceResources(Shader *shader, u32 TextureMapCount, TextureMap **maps, u32 &OutInstanceID)
+{
+    auto data = GetShaderData(shader);
+    OutInstanceID = INVALID::ID;
+    for (u32 i = 0; i < HEADLESS_MAX_INSTANCE_COUNT; ++i) {
+        if (data->InstanceStates[i].id == INVALID::ID) {
+            data->InstanceStates[i].id = i;
+            OutInstanceID = i;
+            break;
+        }
+    }
+    if (OutInstanceID == INVALID::ID) {
+        MERROR("HeadlessAPI::ShaderAcquireInstanceResources — не удалось получить новый идентификатор");
+        return false;
+    }
+
+    auto& InstanceState = data->InstanceStates[OutInstanceID];
+    if (shader->InstanceTextureCount > 0) {
+        InstanceState.InstanceTextureMaps = reinterpret_cast<TextureMap**>(MemorySystem::Allocate(shader->InstanceTextureCount * sizeof(TextureMap*), Memory::Array, true));
+        auto DefaultTexture = TextureSystem::GetDefaultTexture(Texture::Default);
+        MemorySystem::CopyMem(InstanceState.InstanceTextureMaps, maps, sizeof(TextureMap*) * TextureMapCount);
+        for (u32 i = 0; i < TextureMapCount; ++i) {
+            if (!maps[i]->texture) {
+                InstanceState.InstanceTextureMaps[i]->texture = DefaultTexture;
+            }
+        }
+    }
+
+    if (shader->UboStride > 0 && !data->UniformBuffer.Allocate(shader->UboStride, InstanceState.offset)) {
+        MERROR("HeadlessAPI::ShaderAcquireInstanceResources — не удалось получить пространство UBO");
+        return false;
+    }
+
+    return true;
+}
+
+bool HeadlessAPI::ShaderReleaseInstanceResources(Shader *shader, u32 InstanceID)
+{
+    auto data = GetShaderData(shader);
+    auto& InstanceState = data->InstanceStates[InstanceID];
+
+    if (InstanceState.InstanceTextureMaps) {
+        MemorySystem::Free(InstanceState.InstanceTextureMaps, sizeof(TextureMap*) * shader->InstanceTextureCount, Memory::Array);
+        InstanceState.InstanceTextureMaps = nullptr;
+    }
+
+    if (shader->UboStride != 0 && !data->UniformBuffer.Free(shader->UboStride, InstanceState.offset)) {
+        MERROR("HeadlessAPI::ShaderReleaseInstanceResources не удалось освободить диапазон из буфера рендеринга.");
+    }
+
+    InstanceState.offset = INVALID::ID;
+    InstanceState.id = INVALID::ID;
+    return true;
+}
+
+bool HeadlessAPI::SetUniform(Shader *shader, Shader::Uniform *uniform, const void *value)
+{
+    auto data = GetShaderData(shader);
+    if (uniform->type == Shader::UniformType::Sampler) {
+        if (uniform->scope == Shader::Scope::Global) {
+            shader->GlobalTextureMaps[uniform->location] = (TextureMap*)value;
+        } else {
+            data->InstanceStates[shader->BoundInstanceID].InstanceTextureMaps[uniform->location] = (TextureMap*)value;
+        }
+        Record(HeadlessCommand::SamplerWrite, uniform->location);
+    } else if (uniform->scope == Shader::Scope::Local) {
+        // Push-константы копируются так же, как их скопировал бы драйвер при записи команды.
+        if (uniform->offset + uniform->size <= HEADLESS_PUSH_CONSTANT_SIZE) {
+            MemorySystem::CopyMem(data->PushConstants + uniform->offset, value, uniform->size);
+        }
+        Record(HeadlessCommand::PushConstant, uniform->offset, uniform->size);
+    } else {
+        MemorySystem::CopyMem(data->MappedUniformBufferBlock + shader->BoundUboOffset + uniform->offset, value, uniform->size);
+        Record(HeadlessCommand::UniformWrite, uniform->index, uniform->size);
+    }
+    return true;
+}
+
+bool HeadlessAPI::TextureMapAcquireResources(TextureMap *map)
+{
+    // Сэмплер не нужен, но указатель должен быть ненулевым, как у настоящего бэкенда.
+    map->sampler = map;
+    return true;
+}
+
+void HeadlessAPI::TextureMapReleaseResources(TextureMap *map)
+{
+    if (map) {
+        map->sampler = nullptr;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+//                          Renderpass / RenderTarget                             //
+////////////////////////////////////////////////////////////////////////////////////
+
+void HeadlessAPI::RenderTargetCreate(u8 AttachmentCount, RenderTargetAttachment *attachments, Renderpass *pass, u32 width, u32 height, RenderTarget &OutTarget)
+{
+    MemorySystem::CopyMem(OutTarget.attachments, attachments, sizeof(RenderTargetAttachment) * AttachmentCount);
+    // Фреймбуфера нет; цель считается созданной, пока указатель не нулевой.
+    OutTarget.InternalFramebuffer = pass->InternalData;
+}
+
+void HeadlessAPI::RenderTargetDestroy(RenderTarget &target, bool FreeInternalMemory)
+{
+    if (target.InternalFramebuffer) {
+        target.InternalFramebuffer = nullptr;
+        if (FreeInternalMemory) {
+            MemorySystem::Free(target.attachments, sizeof(RenderTargetAttachment) * target.AttachmentCount, Memory::Array);
+            target.attachments = nullptr;
+            target.AttachmentCount = 0;
+        }
+    }
+}
+
+bool HeadlessAPI::RenderpassCreate(RenderpassConfig &config, Renderpass &OutRenderpass, bool copy)
+{
+    if (copy) {
+        OutRenderpass.RenderArea = config.RenderArea;
+        OutRenderpass.ClearColour = config.ClearColour;
+        OutRenderpass.ClearFlags = config.ClearFlags;
+        OutRenderpass.RenderTargetCount = config.RenderTargetCount;
+        OutRenderpass.targets = (RenderTarget*)MemorySystem::Allocate(sizeof(RenderTarget) * OutRenderpass.RenderTargetCount, Memory::Array, true);
+        OutRenderpass.name = config.name;
+    }
+
+    for (u32 t = 0; t < OutRenderpass.RenderTargetCount; ++t) {
+        auto& target = OutRenderpass.targets[t];
+        target.AttachmentCount = config.target.AttachmentCount;
+        target.attachments = (RenderTargetAttachment*)MemorySystem::Allocate(sizeof(RenderTargetAttachment) * target.AttachmentCount, Memory::Array);
+
+        for (u32 a = 0; a < target.AttachmentCount; ++a) {
+            auto& attachment = target.attachments[a];
+            auto& AttachmentConfig = config.target.attachments[a];
+
+            attachment.source = AttachmentConfig.source;
+            attachment.type = AttachmentConfig.type;
+            attachment.LoadOperation = AttachmentConfig.LoadOperation;
+            attachment.StoreOperation = AttachmentConfig.StoreOperation;
+            attachment.PresentAfter = AttachmentConfig.PresentAfter;
+            attachment.texture = nullptr;
+        }
+    }
+
+    auto internal = MemorySystem::TAllocate<HeadlessRenderpass>(Memory::Renderer);
+    internal->depth = config.depth;
+    internal->stencil = config.stencil;
+    OutRenderpass.InternalData = internal;
+    return true;
+}
+
+void HeadlessAPI::RenderpassDestroy(Renderpass *renderpass)
+{
+    for (u32 i = 0; i < renderpass->RenderTargetCount; i++) {
+        RenderTargetDestroy(renderpass->targets[i], true);
+    }
+
+    if (renderpass->InternalData) {
+        MemorySystem::Free(renderpass->InternalData, sizeof(HeadlessRenderpass), Memory::Renderer);
+        renderpass->InternalData = nullptr;
+    }
+}
+
+Texture *HeadlessAPI::WindowAttachmentGet(u8 index)
+{
+    if (index >= HEADLESS_IMAGE_COUNT) {
+        MFATAL("Попытка получить индекс цветового вложения вне диапазона: %d. Количество вложений: %d", index, HEADLESS_IMAGE_COUNT);
+        return nullptr;
+    }
+    return &RenderTextures[index];
+}
+
+Texture *HeadlessAPI::DepthAttachmentGet(u8 index)
+{
+    if (index >= HEADLESS_IMAGE_COUNT) {
+        MFATAL("Попытка получить индекс вложения глубины вне диапазона: %d. Количество вложений: %d", index, HEADLESS_IMAGE_COUNT);
+        return nullptr;
+    }
+    return &DepthTextures[index];
+}
+
+u8 HeadlessAPI::WindowAttachmentIndexGet()
+{
+    return ImageIndex;
+}
+
+u8 HeadlessAPI::WindowAttachmentCountGet()
+{
+    return HEADLESS_IMAGE_COUNT;
+}
+
+u64 HeadlessAPI::ReadbackRequest(Texture *texture, u32 x, u32 y, u32 offset, u32 size, bool pixel)
+{
+    if (!texture || !texture->data) {
+        MERROR("HeadlessAPI::ReadbackRequest требует загруженную текстуру.");
+        return 0;
+    }
+
+    for (auto& readback : readbacks) {
+        u32 expected = HeadlessReadback::Free;
+        if (!__atomic_compare_exchange_n(&readback.state, &expected, HeadlessReadback::Claimed, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            continue;
+        }
+        readback.texture = texture;
+        readback.x = x;
+        readback.y = y;
+        readback.offset = offset;
+        readback.size = size;
+        readback.pixel = pixel;
+        const u64 ticket = __atomic_add_fetch(&NextReadbackTicket, 1, __ATOMIC_ACQ_REL);
+        __atomic_store_n(&readback.ticket, ticket, __ATOMIC_RELEASE);
+        __atomic_store_n(&readback.state, HeadlessReadback::Requested, __ATOMIC_RELEASE);
+        return ticket;
+    }
+
+    MWARN("HeadlessAPI::ReadbackRequest: все %u ячеек чтения заняты.", HEADLESS_READBACK_SLOTS);
+    return 0;
+}
+
+void HeadlessAPI::CreateWindowAttachments()
+{
+    for (u8 i = 0; i < HEADLESS_IMAGE_COUNT; ++i) {
+        auto& colour = RenderTextures[i];
+        auto& depth = DepthTextures[i];
+        if (!colour.data) {
+            char TexName[TEXTURE_NAME_MAX_LENGTH]{};
+            MString::Format(TexName, "__internal_headless_image_%u__", i);
+            colour.SetName(TexName);
+            colour.width = FramebufferWidth;
+            colour.height = FramebufferHeight;
+            colour.ChannelCount = 4;
+            colour.flags |= Texture::Flag::IsWriteable;
+            colour.data = CreateImage(&colour, FramebufferWidth, FramebufferHeight);
+            TextureSystem::WrapInternal(nullptr, &colour);
+
+            depth.SetName("__moon_default_depth_texture__");
+            depth.width = FramebufferWidth;
+            depth.height = FramebufferHeight;
+            depth.ChannelCount = 4;
+            depth.flags |= Texture::Flag::IsWriteable;
+            depth.flags |= Texture::Flag::Depth;
+            depth.data = CreateImage(&depth, FramebufferWidth, FramebufferHeight);
+            TextureSystem::WrapInternal(nullptr, &depth);
+        } else {
+            // Просто обновите размеры и образы.
+            DestroyImage(reinterpret_cast<HeadlessImage*>(colour.data));
+            colour.data = CreateImage(&colour, FramebufferWidth, FramebufferHeight);
+            TextureSystem::Resize(&colour, FramebufferWidth, FramebufferHeight, false);
+
+            DestroyImage(reinterpret_cast<HeadlessImage*>(depth.data));
+            depth.data = CreateImage(&depth, FramebufferWidth, FramebufferHeight);
+            TextureSystem::Resize(&depth, FramebufferWidth, FramebufferHeight, false);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+//                                RenderBuffer                                    //
+////////////////////////////////////////////////////////////////////////////////////
+
+bool HeadlessAPI::RenderBufferCreate(const char *name, RenderBufferType type, u64 TotalSize, bool UseFreelist, RenderBuffer &buffer)
+{
+    buffer.type = type;
+    buffer.TotalSize = TotalSize;
+    buffer.name = name ? name : "renderbuffer_unnamed";
+    if (UseFreelist) {
+        buffer.FreelistMemoryRequirement = FreeList::GetMemoryRequirement(TotalSize);
+        buffer.FreelistBlock = MemorySystem::Allocate(buffer.FreelistMemoryRequirement, Memory::Renderer);
+        buffer.BufferFreelist.Create(TotalSize, buffer.FreelistBlock);
+    }
+    if (!RenderBufferCreateInternal(buffer)) {
+        MERROR("HeadlessAPI::RenderBufferCreate не удалось создать RenderBuffer.");
+        return false;
+    }
+    return true;
+}
+
+bool HeadlessAPI::RenderBufferCreateInternal(RenderBuffer &buffer)
+{
+    if (!buffer.TotalSize) {
+        MERROR("HeadlessAPI::RenderBufferCreateInternal требуется ненулевой размер буфера.");
+        return false;
+    }
+    buffer.data = MemorySystem::Allocate(buffer.TotalSize, Memory::Renderer);
+    return buffer.data != nullptr;
+}
+
+void HeadlessAPI::RenderBufferDestroyInternal(RenderBuffer &buffer)
+{
+    if (buffer.data) {
+        MemorySystem::Free(buffer.data, buffer.TotalSize, Memory::Renderer);
+        buffer.data = nullptr;
+    }
+}
+
+bool HeadlessAPI::RenderBufferBind(RenderBuffer &buffer, u64 offset)
+{
+    return buffer.data != nullptr;
+}
+
+bool HeadlessAPI::RenderBufferUnbind(RenderBuffer &buffer)
+{
+    return buffer.data != nullptr;
+}
+
+void *HeadlessAPI::RenderBufferMapMemory(RenderBuffer &buffer, u64 offset, u64 size)
+{
+    if (!buffer.data) {
+        MERROR("HeadlessAPI::RenderBufferMapMemory требует действительный указатель на буфер.");
+        return nullptr;
+    }
+    return reinterpret_cast<u8*>(buffer.data) + offset;
+}
+
+void HeadlessAPI::RenderBufferUnmapMemory(RenderBuffer &buffer, u64 offset, u64 size)
+{
+}
+
+bool HeadlessAPI::RenderBufferFlush(RenderBuffer &buffer, u64 offset, u64 size)
+{
+    return buffer.data != nullptr;
+}
+
+bool HeadlessAPI::RenderBufferRead(RenderBuffer &buffer, u64 offset, u64 size, void **OutMemory)
+{
+    if (!buffer.data || !OutMemory || offset + size > buffer.TotalSize) {
+        MERROR("HeadlessAPI::RenderBufferRead требует действительный буфер, указатель OutMemory и диапазон в пределах буфера.");
+        return false;
+    }
+    MemorySystem::CopyMem(*OutMemory, reinterpret_cast<u8*>(buffer.data) + offset, size);
+    return true;
+}
+
+bool HeadlessAPI::RenderBufferResize(RenderBuffer &buffer, u64 NewTotalSize)
+{
+    if (!buffer.data || !buffer.Resize(NewTotalSize)) {
+        MERROR("HeadlessAPI::RenderBufferResize не удалось изменить размер буфера '%s'.", buffer.name.c_str());
+        return false;
+    }
+
+    void* NewData = MemorySystem::Allocate(NewTotalSize, Memory::Renderer);
+    MemorySystem::CopyMem(NewData, buffer.data, buffer.TotalSize);
+    MemorySystem::Free(buffer.data, buffer.TotalSize, Memory::Renderer);
+    buffer.data = NewData;
+    buffer.TotalSize = NewTotalSize;
+    return true;
+}
+
+bool HeadlessAPI::RenderBufferLoadRange(RenderBuffer &buffer, u64 offset, u64 size, const void *data)
+{
+    if (!buffer.data || !size || !data || offset + size > buffer.TotalSize) {
+        MERROR("HeadlessAPI::RenderBufferLoadRange требует действительный буфер, ненулевой размер и данные в пределах буфера.");
+        return false;
+    }
+    MemorySystem::CopyMem(reinterpret_cast<u8*>(buffer.data) + offset, data, size);
+    Record(HeadlessCommand::BufferUpload, 0, size);
+    return true;
+}
+
+bool HeadlessAPI::RenderBufferCopyRange(RenderBuffer &source, u64 SourceOffset, RenderBuffer &dest, u64 DestOffset, u64 size)
+{
+    if (!source.data || !dest.data || !size || SourceOffset + size > source.TotalSize || DestOffset + size > dest.TotalSize) {
+        MERROR("HeadlessAPI::RenderBufferCopyRange требует действительные буферы и ненулевой размер в их пределах.");
+        return false;
+    }
+    MemorySystem::CopyMem(reinterpret_cast<u8*>(dest.data) + DestOffset, reinterpret_cast<u8*>(source.data) + SourceOffset, size);
+    return true;
+}
+
+bool HeadlessAPI::RenderBufferDraw(RenderBuffer &buffer, u64 offset, u32 ElementCount, bool BindOnly)
+{
+    if (buffer.type == RenderBufferType::Vertex) {
+        Record(HeadlessCommand::BindVertexBuffer, 0, offset);
+        if (!BindOnly) {
+            Record(HeadlessCommand::Draw, ElementCount);
+        }
+        return true;
+    } else if (buffer.type == RenderBufferType::Index) {
+        Record(HeadlessCommand::BindIndexBuffer, 0, offset);
+        if (!BindOnly) {
+            Record(HeadlessCommand::DrawIndexed, ElementCount);
+        }
+        return true;
+    }
+
+    MERROR("Невозможно нарисовать буфер типа: %i", buffer.type);
+    return false;
+}
+
+const bool &HeadlessAPI::IsMultithreaded()
+{
+    return MultithreadingEnabled;
+}
+
+u8 HeadlessAPI::RecordingContextCount()
+{
+    return HEADLESS_RECORDING_CONTEXTS;
+}
+
+bool HeadlessAPI::RecordingBegin(u8 context)
+{
+    if (context >= HEADLESS_RECORDING_CONTEXTS) {
+        MERROR("HeadlessAPI::RecordingBegin: недопустимый контекст записи %u.", context);
+        return false;
+    }
+    auto& rc = RecordingContexts[context];
+    rc.CommandLog.Clear();
+    rc.BoundShader = nullptr;
+    CurrentRecordingContext = &rc;
+    return true;
+}
+
+bool HeadlessAPI::RecordingEnd(u8 context)
+{
+    if (CurrentRecordingContext != &RecordingContexts[context]) {
+        MERROR("HeadlessAPI::RecordingEnd: контекст записи %u не принадлежит этому потоку.", context);
+        return false;
+    }
+    CurrentRecordingContext = nullptr;
+    return true;
+}
+
+bool HeadlessAPI::RecordingExecute(u8 ContextCount)
+{
+    // Журналы контекстов дописываются в порядке индексов, как вторичные буферы в Vulkan.
+    for (u8 c = 0; c < ContextCount && c < HEADLESS_RECORDING_CONTEXTS; ++c) {
+        auto& log = RecordingContexts[c].CommandLog;
+        for (u32 i = 0; i < log.Length(); ++i) {
+            CommandLog.PushBack(log[i]);
+        }
+        log.Clear();
+    }
+    return true;
+}
+
+u64 HeadlessAPI::UploadTicket()
+{
+    // Загрузки не выполняются, поэтому ожидать нечего.
+    return 0;
+}
+
+u32 HeadlessAPI::GpuPassTimings(GpuPassTiming *OutTimings, u32 MaxCount)
+{
+    // GPU нет, измерять нечего.
+    return 0;
+}
+
+void HeadlessAPI::UniformStats(UniformUploadStats &OutStats)
+{
+    // Униформы не копируются в память GPU.
+    OutStats = {};
+}
+
+bool HeadlessAPI::GpuCullingUpload(const GpuCullInstance *instances, u32 count)
+{
+    // Отсечение на GPU не поддерживается: представления рисуют геометрию обычными вызовами.
+    return false;
+}
+
+void HeadlessAPI::GpuCullingSetView(const Matrix4D &projection, const Matrix4D &view)
+{
+}
+
+bool HeadlessAPI::GpuCullingDraw(u32 first, u32 count)
+{
+    return false;
+}
+
+void HeadlessAPI::Record(HeadlessCommand::Type type, u32 a, u64 b)
+{
+    auto& log = CurrentRecordingContext ? CurrentRecordingContext->CommandLog : CommandLog;
+    log.PushBack(HeadlessCommand{ type, 0, 0, a, b });
+}
+
+bool HeadlessAPI::FlagEnabled(RendererConfigFlags flag)
+{
+    return (flags & flag) == flag;
+}
+
+void HeadlessAPI::FlagSetEnabled(RendererConfigFlags flag, bool enabled)
+{
+    flags = enabled ? (flags | flag) : (flags & ~flag);
+}
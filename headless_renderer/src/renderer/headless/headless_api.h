@@ -0,0 +1,140 @@
+#pragma once
+
+#include "renderer/renderer_plugin.h"
+#include "renderer/renderer_types.h"
+#include "resources/texture.hpp"
+#include "headless_types.h"
+
+/// @brief Плагин рендеринга без графического процессора. Буферы и текстуры хранятся в памяти хоста,
+/// а привязки, отрисовки и записи униформ записываются в компактный журнал команд.
+/// Предназначен для измерения затрат ЦП на кадр (подготовка пакетов, сортировка, применение материалов, интерфейс)
+/// на машинах без видеокарты.
+class HeadlessAPI : public RendererPlugin
+{
+public:
+    u32 FramebufferWidth;                                   // Текущая ширина фреймбуфера.
+    u32 FramebufferHeight;                                  // Текущая высота фреймбуфера.
+    u64 FramebufferSizeGeneration;                          // Текущее поколение размера фреймбуфера.
+    u64 FramebufferSizeLastGeneration;                      // Поколение размера, для которого созданы вложения окна.
+    RendererConfigFlags flags;                              // Флаги конфигурации рендерера.
+    bool MultithreadingEnabled;                             // Указывает, поддерживает ли рендерер многопоточность.
+    u8 ImageIndex;                                          // Индекс текущего изображения «цепочки обмена».
+    Rect2D ViewportRect;                                    // Прямоугольник области просмотра.
+    Rect2D ScissorRect;                                     // Прямоугольник ножниц.
+    Texture RenderTextures[HEADLESS_IMAGE_COUNT];           // Цветовые вложения окна.
+    Texture DepthTextures[HEADLESS_IMAGE_COUNT];            // Вложения глубины окна.
+    RenderBuffer ObjectVertexBuffer;                        // Буфер вершин геометрии.
+    RenderBuffer ObjectIndexBuffer;                         // Буфер индексов геометрии.
+    HeadlessGeometry geometries[HEADLESS_MAX_GEOMETRY_COUNT];
+    struct Shader* BoundShader;                             // Указатель на текущий привязанный шейдер.
+    DArray<HeadlessCommand> CommandLog;                     // Журнал команд текущего кадра.
+    HeadlessRecordingContext RecordingContexts[HEADLESS_RECORDING_CONTEXTS];
+    HeadlessFrameStats FrameStats;                          // Сводка журнала последнего завершенного кадра.
+    HeadlessReadback readbacks[HEADLESS_READBACK_SLOTS];    // Ожидающие асинхронные чтения.
+    u64 NextReadbackTicket;                                 // Номер последнего выданного чтения. Изменяется атомарно.
+
+public:
+    HeadlessAPI();
+    ~HeadlessAPI();
+
+    bool Initialize(const RenderingConfig& config, u8& OutWindowRenderTargetCount)        override;
+    void ShutDown()                                                                       override;
+    void Resized(u16 width, u16 height)                                                   override;
+    bool PrepareFrame(const FrameData& rFrameData)                                        override;
+    bool Begin(const FrameData& rFrameData)                                               override;
+    bool End(const FrameData& rFrameData)                                                 override;
+    bool Present(const FrameData& rFrameData)                                             override;
+    void SetViewport(const Rect2D& rect)                                                  override;
+    void ViewportReset()                                                                  override;
+    void SetScissor(const Rect2D& rect)                                                   override;
+    void ScissorReset()                                                                   override;
+    void SetWinding(RendererWinding winding)                                              override;
+    bool RenderpassBegin(Renderpass* pass, RenderTarget& target)                          override;
+    bool RenderpassEnd(Renderpass* pass)                                                  override;
+
+    void Load(const u8* pixels, Texture* texture)                                         override;
+    void LoadTextureWriteable  (Texture* texture)                                         override;
+    void TextureResize         (Texture* texture, u32 NewWidth, u32 NewHeight)            override;
+    void TextureWriteData      (Texture* texture, u32 offset, u32 size, const u8* pixels) override;
+    void TextureWriteRegion    (Texture* texture, u32 x, u32 y, u32 width, u32 height, const u8* pixels) override;
+    void TextureReadData       (Texture* texture, u32 offset, u32 size, void** OutMemory) override;
+    void TextureReadPixel      (Texture* texture, u32 x, u32 y, u8** OutRgba)             override;
+    u64  TextureReadDataAsync  (Texture* texture, u32 offset, u32 size)                   override;
+    u64  TextureReadPixelAsync (Texture* texture, u32 x, u32 y)                           override;
+    ReadbackStatus ReadbackPoll(u64 ticket, void* OutMemory)                              override;
+    void* TextureCopyData(const Texture* texture)                                         override;
+    void Unload                (Texture* texture)                                         override;
+
+    bool CreateGeometry      (Geometry* geometry)                                                                   override;
+    bool Load                (Geometry* geometry, u32 VertexOffset, u32 VertexSize, u32 IndexOffset, u32 IndexSize) override;
+    void Unload              (Geometry* geometry)                                                                   override;
+    void GeometryVertexUpdate(Geometry* geometry, u32 offset, u32 VertexCount, void* vertices)                      override;
+    void DrawGeometry(const GeometryRenderData& data)                                                               override;
+
+    bool Load                          (Shader *shader, const ShaderConfig& config, Renderpass* renderpass, const DArray<Shader::Stage>& stages, const DArray<MString>& StageFilenames) override;
+    void Unload                        (Shader* shader)                                                                                                                                   override;
+    bool ShaderInitialize              (Shader* shader)                                                                                                                                   override;
+    bool ShaderReload                  (Shader* shader)                                                                                                                                   override;
+    bool ShaderUse                     (Shader* shader)                                                                                                                                   override;
+    bool ShaderApplyGlobals            (Shader* shader, bool NeedsUpdate)                                                                                                                 override;
+    bool ShaderApplyInstance           (Shader* shader, bool NeedsUpdate)                                                                                                                 override;
+    bool ShaderBindInstance            (Shader* shader, u32 InstanceID)                                                                                                                   override;
+    bool ShaderAcquireInstanceResources(Shader* shader, u32 TextureMapCount, TextureMap** maps, u32& OutInstanceID)                                                                       override;
+    bool ShaderReleaseInstanceResources(Shader* shader, u32 InstanceID)                                                                                                                   override;
+    bool SetUniform                    (Shader* shader, struct Shader::Uniform* uniform, const void* value)                                                                               override;
+
+    bool TextureMapAcquireResources(TextureMap* map) override;
+    void TextureMapReleaseResources(TextureMap* map) override;
+    void RenderTargetCreate(u8 AttachmentCount, RenderTargetAttachment* attachments, Renderpass* pass, u32 width, u32 height, RenderTarget& OutTarget) override;
+    void RenderTargetDestroy(RenderTarget& target, bool FreeInternalMemory = false) override;
+    bool RenderpassCreate(RenderpassConfig& config, Renderpass& OutRenderpass, bool copy) override;
+    void RenderpassDestroy(Renderpass* renderpass) override;
+
+    Texture* WindowAttachmentGet(u8 index)  override;
+    Texture* DepthAttachmentGet(u8 index)   override;
+    u8 WindowAttachmentIndexGet()           override;
+    u8 WindowAttachmentCountGet()           override;
+
+    bool  RenderBufferCreate         (const char* name, RenderBufferType type, u64 TotalSize, bool UseFreelist, RenderBuffer& buffer) override;
+    bool  RenderBufferCreateInternal (RenderBuffer& buffer)                                                                           override;
+    void  RenderBufferDestroyInternal(RenderBuffer& buffer)                                                                           override;
+    bool  RenderBufferBind           (RenderBuffer& buffer, u64 offset)                                                               override;
+    bool  RenderBufferUnbind         (RenderBuffer& buffer)                                                                           override;
+    void* RenderBufferMapMemory      (RenderBuffer& buffer, u64 offset, u64 size)                                                     override;
+    void  RenderBufferUnmapMemory    (RenderBuffer& buffer, u64 offset, u64 size)                                                     override;
+    bool  RenderBufferFlush          (RenderBuffer& buffer, u64 offset, u64 size)                                                     override;
+    bool  RenderBufferRead           (RenderBuffer& buffer, u64 offset, u64 size, void** OutMemory)                                   override;
+    bool  RenderBufferResize         (RenderBuffer& buffer, u64 NewTotalSize)                                                         override;
+    bool  RenderBufferLoadRange      (RenderBuffer& buffer, u64 offset, u64 size, const void* data)                                   override;
+    bool  RenderBufferCopyRange      (RenderBuffer& source, u64 SourceOffset, RenderBuffer& dest, u64 DestOffset, u64 size)           override;
+    bool  RenderBufferDraw           (RenderBuffer& buffer, u64 offset, u32 ElementCount, bool BindOnly)                              override;
+
+    const bool& IsMultithreaded() override;
+    bool FlagEnabled   (RendererConfigFlags flag)               override;
+    void FlagSetEnabled(RendererConfigFlags flag, bool enabled) override;
+
+    u8 RecordingContextCount()             override;
+    bool RecordingBegin(u8 context)        override;
+    bool RecordingEnd(u8 context)          override;
+    bool RecordingExecute(u8 ContextCount) override;
+    u64 UploadTicket()                     override;
+    u32 GpuPassTimings(GpuPassTiming* OutTimings, u32 MaxCount) override;
+    void UniformStats(UniformUploadStats& OutStats) override;
+    bool GpuCullingUpload(const GpuCullInstance* instances, u32 count) override;
+    void GpuCullingSetView(const Matrix4D& projection, const Matrix4D& view) override;
+    bool GpuCullingDraw(u32 first, u32 count) override;
+
+    /// @brief Возвращает сводку журнала команд последнего завершенного кадра.
+    MINLINE const HeadlessFrameStats& LastFrameStats() const { return FrameStats; }
+
+private:
+    /// @brief Добавляет команду в журнал контекста записи вызывающего потока или, если его нет, в журнал текущего кадра.
+    void Record(HeadlessCommand::Type type, u32 a = 0, u64 b = 0);
+
+    /// @brief Занимает свободную ячейку чтения. Может вызываться из любого потока записи.
+    /// @return номер чтения; 0, если свободных ячеек нет.
+    u64 ReadbackRequest(Texture* texture, u32 x, u32 y, u32 offset, u32 size, bool pixel);
+
+    /// @brief Создает (или пересоздает под новый размер) вложения окна.
+    void CreateWindowAttachments();
+};
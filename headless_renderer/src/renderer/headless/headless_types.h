@@ -0,0 +1,114 @@
+#pragma once
+
+#include <defines.h>
+#include <containers/darray.h>
+#include <renderer/renderbuffer.h>
+
+struct TextureMap;
+struct Texture;
+
+constexpr u32 HEADLESS_MAX_GEOMETRY_COUNT = 4096;   // Максимальное количество загруженных геометрий.
+constexpr u32 HEADLESS_MAX_INSTANCE_COUNT = 1024;   // Максимальное количество экземпляров шейдера.
+constexpr u32 HEADLESS_UBO_ALIGNMENT      = 256;    // Выравнивание UBO, как у большинства дискретных видеокарт.
+constexpr u32 HEADLESS_PUSH_CONSTANT_SIZE = 128;    // Гарантированный Vulkan размер push-констант.
+constexpr u8  HEADLESS_IMAGE_COUNT        = 3;      // Количество изображений «цепочки обмена».
+constexpr u8  HEADLESS_RECORDING_CONTEXTS = 4;      // Количество контекстов параллельной записи, как у Vulkan.
+constexpr u8  HEADLESS_READBACK_SLOTS     = 32;     // Количество одновременно ожидающих асинхронных чтений, как у Vulkan.
+
+/// @brief Команда, записанная вместо обращения к графическому API. Записи имеют фиксированный размер (16 байт),
+/// чтобы запись журнала стоила как можно меньше и не искажала измеряемое время кадра.
+struct HeadlessCommand {
+    enum Type : u8 {
+        RenderpassBegin,    // a - идентификатор прохода.
+        RenderpassEnd,      // a - идентификатор прохода.
+        SetViewport,
+        SetScissor,
+        SetWinding,         // a - направление обхода.
+        ShaderUse,          // a - идентификатор шейдера.
+        ApplyGlobals,       // a - идентификатор шейдера, b - 1, если требуется обновление.
+        ApplyInstance,      // a - идентификатор экземпляра, b - 1, если требуется обновление.
+        BindInstance,       // a - идентификатор экземпляра.
+        UniformWrite,       // a - индекс униформы, b - размер в байтах.
+        PushConstant,       // a - смещение, b - размер в байтах.
+        SamplerWrite,       // a - расположение сэмплера.
+        BindVertexBuffer,   // b - смещение в байтах.
+        BindIndexBuffer,    // b - смещение в байтах.
+        Draw,               // a - количество вершин.
+        DrawIndexed,        // a - количество индексов.
+        BufferUpload,       // b - размер в байтах.
+        TextureUpload,      // b - размер в байтах.
+        Count
+    };
+
+    u8 type;
+    u8 reserved;
+    u16 reserved2;
+    u32 a;
+    u64 b;
+};
+
+/// @brief Контекст параллельной записи: собственный журнал команд потока, который дописывается
+/// в журнал кадра при выполнении — так же, как вторичные буферы команд выполняются в основном.
+struct HeadlessRecordingContext {
+    DArray<HeadlessCommand> CommandLog;
+    struct Shader* BoundShader;
+};
+
+/// @brief Сводка журнала команд одного кадра.
+struct HeadlessFrameStats {
+    u32 commands;                       // Общее количество записанных команд.
+    u32 draws;                          // Количество вызовов отрисовки.
+    u64 primitives;                     // Сумма вершин (для неиндексированных) и индексов (для индексированных) отрисовок.
+    u64 UploadBytes;                    // Объем данных, загруженных в буферы и текстуры.
+    u32 counts[HeadlessCommand::Count]; // Количество команд каждого типа.
+};
+
+/// @brief Асинхронное чтение текстуры. Без GPU копировать нечего, поэтому данные читаются при опросе.
+struct HeadlessReadback {
+    enum State : u32 { Free, Claimed, Requested };
+
+    u64 ticket;                         // Номер чтения. Изменяется атомарно.
+    Texture* texture;
+    u32 x, y;                           // Координаты пикселя, если читается пиксель.
+    u32 offset, size;                   // Диапазон данных, если читаются данные.
+    bool pixel;                         // Читается пиксель, а не диапазон данных.
+    u32 state;                          // Изменяется атомарно.
+};
+
+/// @brief Образ текстуры в памяти хоста.
+struct HeadlessImage {
+    u8* pixels;
+    u64 size;
+};
+
+/// @brief Диапазоны геометрии в общих буферах вершин и индексов.
+struct HeadlessGeometry {
+    u32 id;
+    u32 generation;
+    u64 VertexBufferOffset;
+    u64 IndexBufferOffset;
+
+    constexpr HeadlessGeometry() : id(INVALID::ID), generation(INVALID::ID), VertexBufferOffset(), IndexBufferOffset() {}
+};
+
+/// @brief Данные шейдера. Униформы хранятся в буфере в памяти хоста с той же раскладкой, что и у Vulkan,
+/// поэтому стоимость записи униформ на стороне ЦП совпадает.
+struct HeadlessShader {
+    struct InstanceState {
+        u32 id;
+        u64 offset;                     // Смещение UBO экземпляра.
+        TextureMap** InstanceTextureMaps;
+    };
+
+    RenderBuffer UniformBuffer;
+    u8* MappedUniformBufferBlock;
+    InstanceState InstanceStates[HEADLESS_MAX_INSTANCE_COUNT];
+    u8 PushConstants[HEADLESS_PUSH_CONSTANT_SIZE];
+
+    HeadlessShader() : UniformBuffer(), MappedUniformBufferBlock(nullptr), InstanceStates(), PushConstants() {
+        for (u32 i = 0; i < HEADLESS_MAX_INSTANCE_COUNT; ++i) {
+            InstanceStates[i].id = INVALID::ID;
+            InstanceStates[i].offset = INVALID::ID;
+        }
+    }
+};
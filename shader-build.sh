@@ -7,8 +7,15 @@ pushd bin
 ./tools buildshaders \
 ../assets/shaders/Builtin.MaterialShader.vert.glsl \
 ../assets/shaders/Builtin.MaterialShader.frag.glsl \
+../assets/shaders/Builtin.MaterialShader.Bindless.frag.glsl \
+../assets/shaders/Builtin.MaterialShader.Indirect.vert.glsl \
+../assets/shaders/Builtin.MaterialShader.Indirect.Bindless.vert.glsl \
+../assets/shaders/Builtin.CullCompute.comp.glsl \
 ../assets/shaders/Builtin.UIShader.vert.glsl \
 ../assets/shaders/Builtin.UIShader.frag.glsl \
+../assets/shaders/Builtin.UIShader.Bindless.frag.glsl \
+../assets/shaders/Builtin.UIShader.Msdf.frag.glsl \
+../assets/shaders/Builtin.UIShader.Msdf.Bindless.frag.glsl \
 ../assets/shaders/Builtin.SkyboxShader.vert.glsl \
 ../assets/shaders/Builtin.SkyboxShader.frag.glsl \
 ../assets/shaders/Builtin.UIPickShader.vert.glsl \
@@ -3,6 +3,7 @@
 #include <core/logger.hpp>
 #include <core/input.h>
 #include <core/metrics.h>
+#include <core/mvar.h>
 
 #include <systems/camera_system.hpp>
 #include <renderer/renderpass.h>
@@ -103,7 +104,7 @@ static bool GameOnDebugEvent(u16 code, void *sender, void *ListenerInst, EventCo
         }
         return true;
     } else if (code == EventSystem::DEBUG1) {
-        if (state->MainScene.state < SimpleScene::State::Loading) {
+        if (state->MainScene.state < SimpleScene::State::Loading || state->MainScene.state == SimpleScene::State::Unloaded) {
             MDEBUG("Загрузка основной сцены...");
             
             if (!LoadMainScene(GameInst)) {
@@ -536,6 +537,12 @@ bool ApplicationUpdate(Application& app, const FrameData& rFrameData)
 
     f64 fps, FrameTime;
     Metrics::Frame(fps, FrameTime);
+    u64 TextureResident, TextureBudget;
+    u32 TexturePending;
+    Metrics::TextureStreaming(TextureResident, TextureBudget, TexturePending);
+    f64 TerrainMs;
+    u32 TerrainTriangles, TerrainChunks, TerrainResident;
+    Metrics::Terrain(TerrainMs, TerrainTriangles, TerrainChunks, TerrainResident);
 
     const char* VsyncText = RenderingSystem::FlagEnabled(RenderingConfigFlagBits::VsyncEnabledBit) ? "Вкл" : "Выкл";
     char TextBuffer[2048]{};
@@ -545,6 +552,8 @@ bool ApplicationUpdate(Application& app, const FrameData& rFrameData)
         FPS: %5.1f(%4.1fмс) Позиция=[%7.3F, %7.3F, %7.3F] Вращение=[%7.3F, %7.3F, %7.3F]\n\
         Upd: %8.3fмкс, Rend: %8.3fмкс Мышь: X=%-5d Y=%-5d   L=%s R=%s   NDC: X=%.6f, Y=%.6f\n\
         Vsync: %s Draw: %-5u Hovered: %s%u\n\
+        Текстуры: %.1f/%.1f МиБ, запросов: %u\n\
+        Ландшафт: %u треуг., чанков %u (загружено %u), выбор %.3f мс\n\
         Время выполнения функции RenderingSystem::PrepareFrame: %f мс",
         fps,
         FrameTime,
@@ -561,6 +570,10 @@ bool ApplicationUpdate(Application& app, const FrameData& rFrameData)
         rFrameData.DrawnMeshCount,
         state->HoveredObjectID == INVALID::ID ? "none" : "",
         state->HoveredObjectID == INVALID::ID ? 0 : state->HoveredObjectID,
+        (f64)TextureResident / MEBIBYTES(1),
+        (f64)TextureBudget / MEBIBYTES(1),
+        TexturePending,
+        TerrainTriangles, TerrainChunks, TerrainResident, TerrainMs,
         Metrics::GetFunctionExecutionTime("RenderingSystem::PrepareFrame")/1000
     );
 
@@ -569,6 +582,7 @@ bool ApplicationUpdate(Application& app, const FrameData& rFrameData)
     }
     
     state->console.Update();
+    GameUpdateBenchmarks(*state);
 
     state->UpdateClock.Update();
     state->LastUpdateElapsed = state->UpdateClock.elapsed;
@@ -746,21 +760,15 @@ bool ApplicationRender(Application& app, RenderPacket& packet, FrameData& rFrame
 
     state->RenderClock.Start();
 
-    // Мир
-    auto ViewPacket = &packet.views[Testbed::World];
-    ViewPacket->view->Render(ViewPacket->view, *ViewPacket, rFrameData);
-
-    // Редактор мира
-    ViewPacket = &packet.views[Testbed::EditorWorld];
-    ViewPacket->view->Render(ViewPacket->view, *ViewPacket, rFrameData);
-
-    // Снова визуализирует мир, но с новой областью просмотра и камерой.
-    ViewPacket = &packet.views[Testbed::Wireframe];
-    ViewPacket->view->Render(ViewPacket->view, *ViewPacket, rFrameData);
-
-    // UI
-    ViewPacket = &packet.views[Testbed::UI];
-    ViewPacket->view->Render(ViewPacket->view, *ViewPacket, rFrameData);
+    // Представления с общими шейдерами записываются в одной группе: мир и редактор мира используют один шейдер цвета 3D.
+    // Каркасный режим снова визуализирует мир, но с новой областью просмотра и камерой.
+    static const u8 groups[] = {
+        0, // Мир
+        0, // Редактор мира
+        1, // Каркас
+        2  // UI
+    };
+    RenderingSystem::RenderViews(packet.views, groups, Testbed::UI + 1, rFrameData);
 
     state->RenderClock.Update();
 
@@ -1145,6 +1153,10 @@ static void ToggleVsync() {
 static bool GameOnMVarChanged(u16 code, void* sender, void* ListenerInst, EventContext data) {
     if (code == EventSystem::MVarChanged && MString::Equali(data.data.c, "vsync")) {
         ToggleVsync();
+    } else if (code == EventSystem::MVarChanged && MString::Equali(data.data.c, "mt_recording")) {
+        i32 enabled = 0;
+        MVar::GetInt("mt_recording", enabled);
+        RenderingSystem::SetMultithreadedRecording(enabled != 0);
     }
     return false;
 }
@@ -126,6 +126,8 @@ extern "C" MAPI void ApplicationLibOnUnload(Application& app);
 
 void GameSetupCommands();
 void GameRemoveCommands();
+/// @brief Продвигает запущенные из консоли нагрузочные тесты, которым требуется несколько кадров.
+void GameUpdateBenchmarks(Game& game);
 void GameSetupKeymaps(Application* app);
 void GameRemoveKeymaps(Application* app);
 
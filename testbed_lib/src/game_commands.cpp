@@ -1,6 +1,296 @@
 #include "game.h"
 
 #include <core/console.hpp>
+#include <core/clock.h>
+#include <core/metrics.h>
+#include <core/mvar.h>
+#include <platform/async_io.hpp>
+#include <systems/resource_system.h>
+#include <systems/texture_system.h>
+#include <systems/material_system.h>
+
+#include <filesystem>
+
+/// @brief Состояние нагрузочного теста загрузки текстур.
+struct TextureBenchmark {
+    Clock timer;
+    u32 total;
+    u32 completed;
+    u32 failed;
+    u64 bytes;
+    u64 pixels;
+};
+
+static TextureBenchmark benchmark{};
+
+// Данные параметров задания декодирования. Первым полем должен быть результат чтения.
+struct TextureBenchmarkParams {
+    AsyncIO::ReadResult file;
+};
+
+struct TextureBenchmarkResult {
+    u64 bytes;
+    u64 pixels;
+};
+
+static bool TextureBenchmarkDecode(void* params, void* ResultData)
+{
+    auto p = reinterpret_cast<TextureBenchmarkParams*>(params);
+    auto result = reinterpret_cast<TextureBenchmarkResult*>(ResultData);
+    result->bytes = p->file.size;
+    result->pixels = 0;
+    if (!p->file.success) {
+        return false;
+    }
+
+    ImageResourceParams ImageParams { false, p->file.data, p->file.size };
+    ImageResource image;
+    bool success = ResourceSystem::Load("benchmark", eResource::Type::Image, &ImageParams, image);
+    if (success) {
+        result->pixels = (u64)image.data.width * image.data.height;
+        ResourceSystem::Unload(image);
+    }
+    AsyncIO::FreeResult(p->file);
+    return success;
+}
+
+static void TextureBenchmarkReport()
+{
+    benchmark.timer.Update();
+    const f64 seconds = benchmark.timer.elapsed;
+    const f64 MiB = (f64)benchmark.bytes / (1024.0 * 1024.0);
+    MINFO("bench_textures: %u файлов (%u ошибок), %.2f МиБ, %.3f с — %.2f МиБ/с, %.1f файлов/с, %.2f Мпикс/с; макс. глубина очереди %u (%s).",
+        benchmark.completed, benchmark.failed, MiB, seconds, MiB / seconds, benchmark.completed / seconds,
+        (f64)benchmark.pixels / 1000000.0 / seconds, AsyncIO::ResetPeakPendingCount(), AsyncIO::IsIoUring() ? "io_uring" : "пул потоков");
+    benchmark.timer.Stop();
+}
+
+static void TextureBenchmarkComplete(void* ResultData, bool success)
+{
+    auto result = reinterpret_cast<TextureBenchmarkResult*>(ResultData);
+    benchmark.completed++;
+    benchmark.failed += success ? 0 : 1;
+    benchmark.bytes += result->bytes;
+    benchmark.pixels += result->pixels;
+    if (benchmark.completed == benchmark.total) {
+        TextureBenchmarkReport();
+    }
+}
+
+static void TextureBenchmarkSuccess(void* ResultData) { TextureBenchmarkComplete(ResultData, true); }
+static void TextureBenchmarkFail(void* ResultData) { TextureBenchmarkComplete(ResultData, false); }
+
+/// @brief Одновременно загружает и декодирует все изображения из каталога текстур и сообщает пропускную способность.
+void GameCommandBenchTextures(ConsoleCommandContext context) {
+    if (benchmark.completed != benchmark.total) {
+        MWARN("bench_textures: предыдущий запуск еще не завершен (%u из %u).", benchmark.completed, benchmark.total);
+        return;
+    }
+
+    char directory[512]{};
+    MString::Format(directory, "%s/textures", ResourceSystem::BasePath());
+
+    benchmark = TextureBenchmark();
+    AsyncIO::ResetPeakPendingCount();
+    benchmark.timer.Start();
+
+    std::error_code error;
+    for (auto it = std::filesystem::recursive_directory_iterator(directory, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+        if (!it->is_regular_file()) {
+            continue;
+        }
+        const std::string path = it->path().generic_string();
+        bool image = false;
+        for (u32 i = 0; i < IMAGE_EXTENSION_COUNT; ++i) {
+            image |= MString::Equali(it->path().extension().generic_string().c_str(), IMAGE_EXTENSIONS[i]);
+        }
+        if (!image) {
+            continue;
+        }
+
+        TextureBenchmarkParams params{};
+        Job::Info job { TextureBenchmarkDecode, TextureBenchmarkSuccess, TextureBenchmarkFail, &params, sizeof(TextureBenchmarkParams), sizeof(TextureBenchmarkResult) };
+        if (AsyncIO::Read(path.c_str(), job)) {
+            benchmark.total++;
+        } else {
+            MemorySystem::Free(job.ParamData, job.ParamDataSize, Memory::Job);
+            MemorySystem::Free(job.ResultData, job.ResultDataSize, Memory::Job);
+        }
+    }
+
+    if (benchmark.total == 0) {
+        MWARN("bench_textures: в '%s' не найдено изображений.", directory);
+        benchmark.timer.Stop();
+        return;
+    }
+    MINFO("bench_textures: запущена загрузка %u изображений.", benchmark.total);
+}
+
+// Количество циклов выгрузки/загрузки сцены в нагрузочном тесте.
+constexpr u32 SCENE_BENCHMARK_CYCLES = 10;
+
+/// @brief Состояние нагрузочного теста переключения сцен.
+struct SceneBenchmark {
+    Clock timer;
+    u32 remaining;
+    u32 loads;
+    f64 FirstLoad;
+    f64 TotalLoad;
+    RetentionList::Stats textures;
+    RetentionList::Stats materials;
+};
+
+static SceneBenchmark SceneBench{};
+
+static void ReportRetention(const char* name, const RetentionList::Stats& start, const RetentionList::Stats& end)
+{
+    MINFO("bench_scene_switch: %s — попаданий %llu, промахов %llu, вытеснений %llu, удерживается %u (%.2f из %.2f МиБ).",
+        name, end.hits - start.hits, end.misses - start.misses, end.evictions - start.evictions, end.RetainedCount,
+        (f64)end.RetainedBytes / (1024.0 * 1024.0), (f64)end.budget / (1024.0 * 1024.0));
+}
+
+/// @brief Многократно выгружает и загружает основную сцену и сообщает время загрузки и счетчики удержания ресурсов.
+void GameCommandBenchSceneSwitch(ConsoleCommandContext context) {
+    if (SceneBench.remaining > 0) {
+        MWARN("bench_scene_switch: предыдущий запуск еще не завершен (осталось %u циклов).", SceneBench.remaining);
+        return;
+    }
+
+    SceneBench = SceneBenchmark();
+    SceneBench.remaining = SCENE_BENCHMARK_CYCLES;
+    SceneBench.textures = TextureSystem::RetentionStats();
+    SceneBench.materials = MaterialSystem::RetentionStats();
+    MINFO("bench_scene_switch: запущено %u циклов выгрузки/загрузки сцены.", SCENE_BENCHMARK_CYCLES);
+}
+
+// Количество кадров на каждый режим перестроения текста в нагрузочном тесте консоли.
+constexpr u32 CONSOLE_BENCHMARK_FRAMES = 300;
+
+/// @brief Состояние нагрузочного теста вывода в консоль. Каждый кадр в консоль выводится строка,
+/// затраты на перестроение текста сравниваются при полном и инкрементальном перестроении.
+struct ConsoleBenchmark {
+    bool running;
+    u32 frame;                    // Кадр текущего режима.
+    i32 mode;                     // Текущее значение text_incremental.
+    i32 PreviousMode;             // Значение text_incremental до запуска.
+    f64 ms[2];                    // Суммарное время перестроения текста в каждом режиме.
+    u64 quads[2];                 // Количество перестроенных четырехугольников в каждом режиме.
+    u64 bytes[2];                 // Объем загруженных вершин в каждом режиме.
+};
+
+static ConsoleBenchmark ConsoleBench{};
+
+static const char* ConsoleBenchmarkModeNames[2] = { "полное", "инкрементальное" };
+
+/// @brief Выводит строки в консоль сначала с полным, затем с инкрементальным перестроением текста и сравнивает затраты.
+void GameCommandBenchConsoleSpam(ConsoleCommandContext context) {
+    if (ConsoleBench.running) {
+        MWARN("bench_console_spam: предыдущий запуск еще не завершен.");
+        return;
+    }
+
+    ConsoleBench = ConsoleBenchmark();
+    ConsoleBench.PreviousMode = 1;
+    MVar::GetInt("text_incremental", ConsoleBench.PreviousMode);
+    MVar::SetInt("text_incremental", 0);
+    ConsoleBench.running = true;
+    MINFO("bench_console_spam: запущен вывод %u строк в каждом режиме перестроения текста.", CONSOLE_BENCHMARK_FRAMES);
+}
+
+static void ConsoleBenchmarkUpdate()
+{
+    if (!ConsoleBench.running) {
+        return;
+    }
+
+    // Итоги прошлого кадра включают перестроение консоли после строки, выведенной кадром раньше.
+    const i32 mode = ConsoleBench.mode;
+    if (ConsoleBench.frame > 0) {
+        f64 ms;
+        u32 quads;
+        u64 bytes;
+        Metrics::TextGeometry(ms, quads, bytes);
+        ConsoleBench.ms[mode] += ms;
+        ConsoleBench.quads[mode] += quads;
+        ConsoleBench.bytes[mode] += bytes;
+    }
+
+    if (ConsoleBench.frame == CONSOLE_BENCHMARK_FRAMES) {
+        if (mode == 0) {
+            ConsoleBench.mode = 1;
+            ConsoleBench.frame = 0;
+            MVar::SetInt("text_incremental", 1);
+            return;
+        }
+
+        for (u32 i = 0; i < 2; ++i) {
+            const u32 frames = CONSOLE_BENCHMARK_FRAMES - 1;
+            MINFO("bench_console_spam: %s перестроение — %.3f мс/кадр, %llu четырехугольников/кадр, %.1f КиБ/кадр.",
+                ConsoleBenchmarkModeNames[i], ConsoleBench.ms[i] / frames, ConsoleBench.quads[i] / frames, (f64)ConsoleBench.bytes[i] / 1024.0 / frames);
+        }
+        MVar::SetInt("text_incremental", ConsoleBench.PreviousMode);
+        ConsoleBench.running = false;
+        return;
+    }
+
+    MINFO("bench_console_spam: %s перестроение, строка %u.", ConsoleBenchmarkModeNames[mode], ConsoleBench.frame);
+    ConsoleBench.frame++;
+}
+
+void GameUpdateBenchmarks(Game& game)
+{
+    ConsoleBenchmarkUpdate();
+
+    if (SceneBench.remaining == 0) {
+        return;
+    }
+
+    // Выгрузка завершается при следующем обновлении сцены, поэтому за кадр выполняется не больше одного шага.
+    if (game.MainScene.state == SimpleScene::State::Loaded) {
+        EventSystem::Fire(EventSystem::DEBUG2, nullptr, (EventContext){});
+        return;
+    }
+    if (game.MainScene.state != SimpleScene::State::Unloaded && game.MainScene.state >= SimpleScene::State::Loading) {
+        return;
+    }
+
+    SceneBench.timer.Start();
+    EventSystem::Fire(EventSystem::DEBUG1, nullptr, (EventContext){});
+    SceneBench.timer.Update();
+    const f64 seconds = SceneBench.timer.elapsed;
+    SceneBench.timer.Stop();
+
+    if (game.MainScene.state != SimpleScene::State::Loaded) {
+        MERROR("bench_scene_switch: не удалось загрузить сцену, тест прерван.");
+        SceneBench.remaining = 0;
+        return;
+    }
+
+    // Первая загрузка обычно холодная, остальные должны обслуживаться из списков удержания.
+    if (SceneBench.loads == 0) {
+        SceneBench.FirstLoad = seconds;
+    } else {
+        SceneBench.TotalLoad += seconds;
+    }
+    SceneBench.loads++;
+
+    if (--SceneBench.remaining == 0) {
+        const f64 average = SceneBench.loads > 1 ? SceneBench.TotalLoad / (SceneBench.loads - 1) : 0.0;
+        MINFO("bench_scene_switch: %u загрузок, первая %.3f мс, в среднем %.3f мс для остальных.",
+            SceneBench.loads, SceneBench.FirstLoad * 1000.0, average * 1000.0);
+        ReportRetention("текстуры", SceneBench.textures, TextureSystem::RetentionStats());
+        ReportRetention("материалы", SceneBench.materials, MaterialSystem::RetentionStats());
+    }
+}
+
+/// @brief Выводит итоги сборки пакетов интерфейса за последний кадр.
+static void GameCommandUiStats(ConsoleCommandContext context)
+{
+    f64 ms;
+    u32 draws, quads;
+    Metrics::UiBatch(ms, draws, quads);
+    MINFO("ui_stats: %u вызовов отрисовки, %u четырехугольников, сборка %.3f мс.", draws, quads, ms);
+}
 
 void GameCommandExit(ConsoleCommandContext context) {
     MDEBUG("Команда выход из игры вызвана!");
@@ -10,10 +300,18 @@ void GameCommandExit(ConsoleCommandContext context) {
 void GameSetupCommands() {
     Console::RegisterCommand("exit", 0, GameCommandExit);
     Console::RegisterCommand("quit", 0, GameCommandExit);
+    Console::RegisterCommand("bench_textures", 0, GameCommandBenchTextures);
+    Console::RegisterCommand("bench_scene_switch", 0, GameCommandBenchSceneSwitch);
+    Console::RegisterCommand("bench_console_spam", 0, GameCommandBenchConsoleSpam);
+    Console::RegisterCommand("ui_stats", 0, GameCommandUiStats);
 }
 
 void GameRemoveCommands()
 {
     Console::UnregisterCommand("exit");
     Console::UnregisterCommand("quit");
+    Console::UnregisterCommand("bench_textures");
+    Console::UnregisterCommand("bench_scene_switch");
+    Console::UnregisterCommand("bench_console_spam");
+    Console::UnregisterCommand("ui_stats");
 }
\ No newline at end of file
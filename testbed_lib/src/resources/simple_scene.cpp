@@ -8,6 +8,9 @@
 #include "systems/light_system.h"
 #include "systems/resource_system.h"
 #include "core/frame_data.h"
+#include "core/mvar.h"
+#include "core/clock.h"
+#include "core/metrics.h"
 #include "math/frustrum.h"
 #include "math/geometry_utils.h"
 #include "game.h"
@@ -452,6 +455,10 @@ bool SimpleScene::PopulateRenderPacket(Camera *CurrentCamera, Viewport& viewport
         f.Create(CurrentCamera->GetPosition(), forward, right, up, (f32)rect.width / rect.height, viewport.FOV, viewport.NearClip, viewport.FarClip);
 
         rFrameData.DrawnMeshCount = 0;
+
+        // При отсечении на GPU геометрии, которые вид мира рисует косвенно, передаются без проверки на CPU.
+        i32 GpuCulling = 0;
+        MVar::GetInt("gpu_culling", GpuCulling);
         
         const u64& MeshCount = meshes.Length();
         for (u32 i = 0; i < MeshCount; ++i) {
@@ -503,7 +510,7 @@ bool SimpleScene::PopulateRenderPacket(Camera *CurrentCamera, Viewport& viewport
                             Math::abs(ExtentsMax.z - center.z),
                         };
 
-                        if (f.IntersectsAABB(center, HalfExtents)) {
+                        if ((GpuCulling && !WindingInverted && g->IndexCount > 0) || f.IntersectsAABB(center, HalfExtents)) {
                             // Добавьте его в список для рендеринга.
                             GeometryRenderData data = {};
                             data.model = model;
@@ -519,22 +526,20 @@ bool SimpleScene::PopulateRenderPacket(Camera *CurrentCamera, Viewport& viewport
             }
         }
 
-        // ЗАДАЧА: добавить ландшафт(ы)
+        // Ландшафт: чанки выбираются по расстоянию до камеры и отсекаются усеченной пирамидой.
+        Clock TerrainClock;
+        TerrainClock.Start();
+        u32 TerrainTriangles = 0, TerrainChunks = 0, TerrainResident = 0;
         const u32& TerrainCount = terrains.Length();
         for (u32 i = 0; i < TerrainCount; ++i) {
-            // ЗАДАЧА: Проверить генерацию ландшафта
-            // ЗАДАЧА: Отбраковка усеченных пирамид
-            //
-            GeometryRenderData data = {};
-            data.model = terrains[i].xform.GetWorld();
-            data.geometry = &terrains[i].geo;
-            data.UniqueID = terrains[i].UniqueID;
-
-            WorldData.TerrainGeometries.PushBack(data);
-
-            // ЗАДАЧА: Счетчик для геометрии ландшафта.
-            rFrameData.DrawnMeshCount++;
+            const u32 FirstChunk = WorldData.TerrainGeometries.Length();
+            TerrainTriangles += terrains[i].PopulateGeometries(f, CurrentCamera->GetPosition(), rFrameData.RendererFrameNumber, WorldData.TerrainGeometries);
+            TerrainChunks += WorldData.TerrainGeometries.Length() - FirstChunk;
+            TerrainResident += terrains[i].tree->ResidentCount;
         }
+        rFrameData.DrawnMeshCount += TerrainChunks;
+        TerrainClock.Update();
+        Metrics::SetTerrain(TerrainClock.elapsed, TerrainTriangles, TerrainChunks, TerrainResident);
 
         // Геометрия отладки
 
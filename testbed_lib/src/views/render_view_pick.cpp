@@ -449,26 +449,35 @@ bool RenderViewPick::Render(const RenderView* self, RenderViewPacket &packet, co
         }
     }
 
-    // Прочитать пиксель в координатах мыши.
-    u8 PixelRGBA[4]{};
-    u8* pixel = &PixelRGBA[0];
+    // Пиксель под курсором читается асинхронно: копирование выполняется после проходов этого кадра,
+    // а результат забирается через один-два кадра, поэтому CPU не ждет GPU.
+    if (PickData->ReadbackTicket) {
+        u8 PixelRGBA[4]{};
+        const auto status = RenderingSystem::ReadbackPoll(PickData->ReadbackTicket, PixelRGBA);
+        if (status == ReadbackStatus::Pending) {
+            return true;
+        }
+        PickData->ReadbackTicket = 0;
+
+        if (status == ReadbackStatus::Ready) {
+            // Извлечь идентификатор из выбранного цвета.
+            u32 id = INVALID::ID;
+            Math::RgbuToU32(PixelRGBA[0], PixelRGBA[1], PixelRGBA[2], id);
+            if (id == 0x00FFFFFF) {
+                // Это чистый белый.
+                id = INVALID::ID;
+            }
+
+            EventContext context;
+            context.data.u32[0] = id;
+            EventSystem::Fire(EventSystem::OojectHoverIdChanged, nullptr, context);
+        }
+    }
 
     // Прижать к размеру изображения
     // u16 xCoord = MCLAMP(MouseX, 0, width - 1);
     // u16 yCoord = MCLAMP(MouseY, 0, height - 1);
-    RenderingSystem::TextureReadPixel(&PickData->ColoureTargetAttachmentTexture, PickData->MouseX, PickData->MouseY, &pixel);
-
-    // Извлечь идентификатор из выбранного цвета.
-    u32 id = INVALID::ID;
-    Math::RgbuToU32(pixel[0], pixel[1], pixel[2], id);
-    if (id == 0x00FFFFFF) {
-        // Это чистый белый.
-        id = INVALID::ID;
-    }
-
-    EventContext context;
-    context.data.u32[0] = id;
-    EventSystem::Fire(EventSystem::OojectHoverIdChanged, nullptr, context);
+    PickData->ReadbackTicket = RenderingSystem::TextureReadPixelAsync(&PickData->ColoureTargetAttachmentTexture, PickData->MouseX, PickData->MouseY);
 
     return true;
 }
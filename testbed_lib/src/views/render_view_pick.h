@@ -34,10 +34,11 @@ private:
     u32 InstanceCount;
     DArray<bool> InstanceUpdate;
     u16 MouseX, MouseY;
+    u64 ReadbackTicket;                     // Номер ожидающего чтения пикселя под курсором. 0, если чтение не запрошено.
     // u32 RenderMode;
 
 public:
-    constexpr RenderViewPick() : ColoureTargetAttachmentTexture(), DepthTargetAttachmentTexture(), InstanceCount(), MouseX(), MouseY() {}
+    constexpr RenderViewPick() : ColoureTargetAttachmentTexture(), DepthTargetAttachmentTexture(), InstanceCount(), MouseX(), MouseY(), ReadbackTicket() {}
 
     static bool OnRegistered(RenderView* self);
     static void Destroy(RenderView* self);
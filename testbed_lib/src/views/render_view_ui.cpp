@@ -8,6 +8,8 @@
 #include "systems/material_system.h"
 #include "systems/resource_system.h"
 #include "resources/geometry.h"
+#include "core/clock.h"
+#include "core/metrics.h"
 
 bool RenderViewUI::OnRegistered(RenderView* self) 
 {
@@ -36,6 +38,25 @@ bool RenderViewUI::OnRegistered(RenderView* self)
         data->PropertiesLocation  = ShaderSystem::UniformIndex(data->shader, "properties");
         data->ModelLocation       = ShaderSystem::UniformIndex(data->shader, "model");
 
+        // Шейдер текста MSDF: те же атрибуты и униформы, другой фрагментный этап.
+        const char* MsdfShaderName = "Shader.Builtin.UI.Msdf";
+        ShaderResource MsdfConfigResource;
+        if (!ResourceSystem::Load(MsdfShaderName, eResource::Shader, nullptr, MsdfConfigResource)) {
+            MERROR("Не удалось загрузить встроенный шейдер текста MSDF.");
+            return false;
+        }
+        if (!ShaderSystem::CreateShader(self->passes[0], MsdfConfigResource.data)) {
+            MERROR("Не удалось загрузить встроенный шейдер текста MSDF.");
+            return false;
+        }
+        data->MsdfShader = ShaderSystem::GetShader(MsdfShaderName);
+
+        data->MsdfProjectionLocation = ShaderSystem::UniformIndex(data->MsdfShader, "projection");
+        data->MsdfViewLocation       = ShaderSystem::UniformIndex(data->MsdfShader, "view");
+        data->MsdfDiffuseMapLocation = ShaderSystem::UniformIndex(data->MsdfShader, "diffuse_texture");
+        data->MsdfPropertiesLocation = ShaderSystem::UniformIndex(data->MsdfShader, "properties");
+        data->MsdfModelLocation      = ShaderSystem::UniformIndex(data->MsdfShader, "model");
+
         if(!EventSystem::Register(EventSystem::DefaultRendertargetRefreshRequired, self, EditorWorldOnEvent)) {
             MERROR("Не удалось прослушать событие, требующее обновления, создание не удалось.");
             return false;
@@ -51,6 +72,9 @@ void RenderViewUI::Destroy(RenderView *self)
 {
     // Отменить регистрацию на мероприятии.
     EventSystem::Unregister(EventSystem::DefaultRendertargetRefreshRequired, self->data, EditorWorldOnEvent);
+    auto data = reinterpret_cast<RenderViewUI*>(self->data);
+    data->batch.Destroy();
+    data->MsdfTexts.Destroy();
     MemorySystem::Free(self->data, sizeof(RenderViewUI), Memory::Renderer);
     self->data = nullptr;
 }
@@ -88,18 +112,21 @@ bool RenderViewUI::BuildPacket(RenderView* self, FrameData& rFrameData, Viewport
         OutPacket.ExtendedData = rFrameData.FrameAllocator->Allocate(sizeof(UiPacketData));
         MemorySystem::CopyMem(OutPacket.ExtendedData, PacketData, sizeof(UiPacketData));
 
-        // Получить все геометрии из текущей сцены.
-        // Итерировать все сетки и добавить их в коллекцию геометрий пакета
-        for (u32 i = 0; i < PacketData->MeshData.MeshCount; ++i) {
-            auto* m = PacketData->MeshData.meshes[i];
-            for (u32 j = 0; j < m->GeometryCount; ++j) {
-                GeometryRenderData RenderData;
-                RenderData.geometry = m->geometries[j];
-                RenderData.model = m->transform.GetWorld();
-                OutPacket.geometries.PushBack(RenderData);
-                // OutPacket.GeometryCount++;
-            }
+        // Геометрии всех сеток и тексты собираются в пакеты здесь, вне прохода рендеринга,
+        // чтобы загрузка вершин не попадала внутрь прохода. Сетки рисуются шейдером интерфейса, поэтому идут в его пакет.
+        auto& batch = RenderViewUiData->batch;
+        auto& MsdfTexts = RenderViewUiData->MsdfTexts;
+        Clock timer;
+        timer.Start();
+        batch.Build(PacketData->MeshData.meshes, PacketData->MeshData.MeshCount, PacketData->texts, PacketData->TextCount, false);
+        MsdfTexts.Build(nullptr, 0, PacketData->texts, PacketData->TextCount, true);
+        if (!batch.Upload(rFrameData.RendererFrameNumber) || !MsdfTexts.Upload(rFrameData.RendererFrameNumber)) {
+            MERROR("RenderViewUI::BuildPacket не удалось загрузить пакеты интерфейса.");
+            return false;
         }
+        timer.Update();
+        Metrics::SetUiBatch(timer.elapsed, batch.commands.Length() + MsdfTexts.commands.Length(),
+            (batch.indices.Length() + MsdfTexts.indices.Length()) / 6);
         return true;
     }
 
@@ -132,67 +159,30 @@ bool RenderViewUI::Render(const RenderView* self, RenderViewPacket &packet, cons
                 return false;
             }
 
-            // Нарисовать геометрию.
-            const u64& count = packet.geometries.Length();
-            for (u32 i = 0; i < count; ++i) {
-                Material* material = nullptr;
-                if (packet.geometries[i].geometry->material) {
-                    material = packet.geometries[i].geometry->material;
-                } else {
-                    material = MaterialSystem::GetDefaultUiMaterial();
-                }
-
-                // Обновить материал, если он еще не был в этом кадре. 
-                // Это предотвращает многократное обновление одного и того же материала. 
-                // Его все равно нужно привязать в любом случае, 
-                // поэтому результат этой проверки передается на бэкэнд, 
-                // который либо обновляет внутренние привязки шейдера и привязывает их, либо только привязывает их.
-                bool NeedsUpdate = material->RenderFrameNumber != rFrameData.RendererFrameNumber;
-                if (!MaterialSystem::ApplyInstance(material, rFrameData, NeedsUpdate)) {
-                    MWARN("Не удалось применить материал '%s'. Пропуск рисования.", material->name);
-                    continue;
-                } else {
-                    // Синхронизируйте номер кадра.
-                    material->RenderFrameNumber = rFrameData.RendererFrameNumber;
-                }
-
-                // Примените локальные
-                MaterialSystem::ApplyLocal(material, packet.geometries[i].model);
-
-                // Нарисуйте его.
-                RenderingSystem::DrawGeometry(packet.geometries[i]);
+            // Нарисовать сетки, растровый и системный текст
+            if (!DrawBatch(data->batch, data->DiffuseMapLocation, data->PropertiesLocation, data->ModelLocation, rFrameData)) {
+                return false;
             }
 
-            // Нарисовать растровый текст
-            auto PacketData = reinterpret_cast<UiPacketData*>(packet.ExtendedData);  // массив текстов
-            for (u32 i = 0; i < PacketData->TextCount; ++i) {
-                auto text = PacketData->texts[i];
-                ShaderSystem::BindInstance(text->InstanceID);
-
-                if (!ShaderSystem::UniformSet(data->DiffuseMapLocation, &text->data->atlas)) {
-                    MERROR("Не удалось применить диффузную карту растрового шрифта.");
+            // Нарисовать текст MSDF своим шейдером.
+            if (data->MsdfTexts.commands.Length()) {
+                const auto& MsdfShaderID = data->MsdfShader->id;
+                if (!ShaderSystem::Use(MsdfShaderID)) {
+                    MERROR("Не удалось использовать шейдер текста MSDF. Не удалось отрисовать кадр.");
                     return false;
                 }
-
-                // ЗАДАЧА: цвет текста.
-                static FVec4 WhiteColour {1.F, 1.F, 1.F, 1.F};  // белый
-                if (!ShaderSystem::UniformSet(data->PropertiesLocation, &WhiteColour)) {
-                    MERROR("Не удалось применить диффузную цветовую форму растрового шрифта.");
-                    return false;
+                if (data->MsdfShader->RenderFrameNumber != rFrameData.RendererFrameNumber || data->MsdfShader->DrawIndex != rFrameData.DrawIndex) {
+                    if (!ShaderSystem::UniformSet(data->MsdfProjectionLocation, &packet.ProjectionMatrix) ||
+                        !ShaderSystem::UniformSet(data->MsdfViewLocation, &packet.ViewMatrix) ||
+                        !ShaderSystem::ApplyGlobal(true)) {
+                        MERROR("Не удалось применить глобальные переменные шейдера текста MSDF. Не удалось отрисовать кадр.");
+                        return false;
+                    }
+                    data->MsdfShader->RenderFrameNumber = rFrameData.RendererFrameNumber;
                 }
-                bool NeedsUpdate = text->RenderFrameNumber != rFrameData.RendererFrameNumber;
-                ShaderSystem::ApplyInstance(NeedsUpdate);
-
-                // Синхронизируйте номер кадра.
-                text->RenderFrameNumber = rFrameData.RendererFrameNumber;
-
-                // Применить локальные переменные
-                Matrix4D model = text->transform.GetWorld();
-                if(!ShaderSystem::UniformSet(data->ModelLocation, &model)) {
-                    MERROR("Не удалось применить матрицу модели для текста");
+                if (!DrawBatch(data->MsdfTexts, data->MsdfDiffuseMapLocation, data->MsdfPropertiesLocation, data->MsdfModelLocation, rFrameData)) {
+                    return false;
                 }
-
-                text->Draw();
             }
 
             if (!RenderingSystem::RenderpassEnd(pass)) {
@@ -207,6 +197,68 @@ bool RenderViewUI::Render(const RenderView* self, RenderViewPacket &packet, cons
     return false;
 }
 
+bool RenderViewUI::DrawBatch(UiBatch& batch, u16 DiffuseMapLocation, u16 PropertiesLocation, u16 ModelLocation, const FrameData& rFrameData)
+{
+    // Вершины пакета уже в пространстве экрана.
+    static Matrix4D identity = Matrix4D::MakeIdentity();
+    const u32 count = batch.commands.Length();
+    for (u32 i = 0; i < count; ++i) {
+        const auto& command = batch.commands[i];
+        if (auto material = command.material) {
+            // Обновить материал, если он еще не был в этом кадре.
+            // Это предотвращает многократное обновление одного и того же материала.
+            // Его все равно нужно привязать в любом случае,
+            // поэтому результат этой проверки передается на бэкэнд,
+            // который либо обновляет внутренние привязки шейдера и привязывает их, либо только привязывает их.
+            bool NeedsUpdate = material->RenderFrameNumber != rFrameData.RendererFrameNumber;
+            if (!MaterialSystem::ApplyInstance(material, rFrameData, NeedsUpdate)) {
+                MWARN("Не удалось применить материал '%s'. Пропуск рисования.", material->name);
+                continue;
+            }
+            // Синхронизируйте номер кадра.
+            material->RenderFrameNumber = rFrameData.RendererFrameNumber;
+
+            // Примените локальные
+            MaterialSystem::ApplyLocal(material, identity);
+
+            if (!batch.Draw(command)) {
+                return false;
+            }
+            continue;
+        }
+
+        auto text = command.text;
+        ShaderSystem::BindInstance(text->InstanceID);
+
+        if (!ShaderSystem::UniformSet(DiffuseMapLocation, &text->data->atlas)) {
+            MERROR("Не удалось применить диффузную карту растрового шрифта.");
+            return false;
+        }
+
+        // ЗАДАЧА: цвет текста.
+        static FVec4 WhiteColour {1.F, 1.F, 1.F, 1.F};  // белый
+        if (!ShaderSystem::UniformSet(PropertiesLocation, &WhiteColour)) {
+            MERROR("Не удалось применить диффузную цветовую форму растрового шрифта.");
+            return false;
+        }
+        bool NeedsUpdate = text->RenderFrameNumber != rFrameData.RendererFrameNumber;
+        ShaderSystem::ApplyInstance(NeedsUpdate);
+
+        // Синхронизируйте номер кадра.
+        text->RenderFrameNumber = rFrameData.RendererFrameNumber;
+
+        // Применить локальные переменные
+        if(!ShaderSystem::UniformSet(ModelLocation, &identity)) {
+            MERROR("Не удалось применить матрицу модели для текста");
+        }
+
+        if (!batch.Draw(command)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void *RenderViewUI::operator new(u64 size)
 {
     return MemorySystem::Allocate(size, Memory::Renderer);
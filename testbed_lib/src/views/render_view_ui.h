@@ -1,5 +1,6 @@
 #pragma once 
 #include "renderer/render_view.h"
+#include "renderer/ui_batch.h"
 
 class RenderViewUI
 {
@@ -9,9 +10,20 @@ private:
     u16 DiffuseMapLocation;
     u16 PropertiesLocation;
     u16 ModelLocation;
+    // Шейдер текста из атласа MSDF. Глобальные униформы у него свои, поэтому их индексы хранятся здесь.
+    struct Shader* MsdfShader;
+    u16 MsdfProjectionLocation;
+    u16 MsdfViewLocation;
+    u16 MsdfDiffuseMapLocation;
+    u16 MsdfPropertiesLocation;
+    u16 MsdfModelLocation;
+    // Пакеты кадра: сетки с общим материалом и тексты с общим атласом рисуются одним вызовом.
+    UiBatch batch;
+    UiBatch MsdfTexts;
     // u32 RenderMode;
 public:
-    constexpr RenderViewUI() : shader(), ViewMatrix(Matrix4D::MakeIdentity()), DiffuseMapLocation(), PropertiesLocation(), ModelLocation() /*RenderMode(),*/ {}
+    constexpr RenderViewUI() : shader(), ViewMatrix(Matrix4D::MakeIdentity()), DiffuseMapLocation(), PropertiesLocation(), ModelLocation(), 
+    MsdfShader(), MsdfProjectionLocation(), MsdfViewLocation(), MsdfDiffuseMapLocation(), MsdfPropertiesLocation(), MsdfModelLocation(), batch(), MsdfTexts() /*RenderMode(),*/ {}
     ~RenderViewUI();
 
     static bool OnRegistered(RenderView* self);
@@ -19,6 +31,11 @@ public:
     static void Resize(RenderView* self, u32 width, u32 height);
     static bool BuildPacket(RenderView* self, FrameData& rFrameData, Viewport& viewport, Camera* camera, void* data, RenderViewPacket& OutPacket);
     static bool Render(const RenderView* self, RenderViewPacket& packet, const FrameData& rFrameData);
+private:
+    /// @brief Рисует команды пакета интерфейса. Шейдер пакета должен быть уже использован.
+    /// @return true в случае успеха; в противном случае false.
+    static bool DrawBatch(UiBatch& batch, u16 DiffuseMapLocation, u16 PropertiesLocation, u16 ModelLocation, const FrameData& rFrameData);
+public:
 
     void* operator new(u64 size);
     void operator delete(void* ptr, u64 size);
@@ -1,4 +1,5 @@
 #include "render_view_world.h"
+#include "core/mvar.h"
 #include "renderer/renderpass.h"
 #include "renderer/viewport.h"
 #include "resources/geometry.h"
@@ -9,6 +10,7 @@
 #include "systems/render_view_system.h"
 #include "systems/resource_system.h"
 #include "systems/shader_system.h"
+#include "systems/texture_system.h"
 
 /// @brief Частная структура, используемая для сортировки геометрии по расстоянию от камеры.
 struct GeometryDistance {
@@ -171,6 +173,10 @@ void RenderViewWorld::Destroy(RenderView *self)
     EventSystem::Unregister(EventSystem::DefaultRendertargetRefreshRequired, self->data, OnEvent);
     EventSystem::Unregister(EventSystem::SetRenderMode, self->data, OnEvent);
 
+    auto data = reinterpret_cast<RenderViewWorld*>(self->data);
+    data->CullInstances.Destroy();
+    data->CullBatches.Destroy();
+
     MemorySystem::Free(self->data, sizeof(RenderViewWorld), Memory::Renderer);
     self->data = nullptr;
 }
@@ -183,6 +189,33 @@ void RenderViewWorld::Resize(RenderView* self, u32 width, u32 height)
     }
 }
 
+/// @brief Сообщает системе текстур приблизительный размер, который текстуры геометрии занимают на экране.
+/// Размер оценивается по проекции ограничивающей сферы геометрии.
+static void ReportTextureScreenSize(const GeometryRenderData& gData, const FVec3& CameraPosition, const Viewport& viewport)
+{
+    auto material = gData.geometry->material;
+    if (!material) {
+        return;
+    }
+
+    auto min = VectorTransform(gData.geometry->extents.min, 1.F, gData.model);
+    auto max = VectorTransform(gData.geometry->extents.max, 1.F, gData.model);
+    auto center = VectorTransform(gData.geometry->center, 1.F, gData.model);
+    const f32 radius = Distance(min, max) * 0.5F;
+    const f32 distance = Math::abs(Distance(center, CameraPosition));
+
+    // projection.data[5] = ctg(FOV / 2); камера внутри сферы видит текстуру во весь экран.
+    f32 ScreenSize = (f32)viewport.rect.height;
+    if (distance > radius) {
+        ScreenSize = radius * viewport.projection.data[5] * viewport.rect.height / distance;
+    }
+
+    const u32& MapCount = material->maps.Length();
+    for (u32 i = 0; i < MapCount; ++i) {
+        TextureSystem::ReportScreenSize(material->maps[i].texture, (u32)ScreenSize);
+    }
+}
+
 bool RenderViewWorld::BuildPacket(RenderView* self, FrameData& rFrameData, Viewport& viewport, Camera* camera, void *data, RenderViewPacket &OutPacket)
 {
     if (!data) {
@@ -206,6 +239,12 @@ bool RenderViewWorld::BuildPacket(RenderView* self, FrameData& rFrameData, Viewp
         // Данные скайбокса
         OutPacket.SkyboxData = WorldData.SkyboxData;
 
+        // При отсечении на GPU непрозрачные геометрии сначала собираются отдельно, чтобы сгруппировать их по материалам.
+        i32 GpuCulling = 0;
+        MVar::GetInt("gpu_culling", GpuCulling);
+        DArray<GeometryRenderData> opaque;
+        rwwData->GpuGeometryCount = 0;
+
         // ЗАДАЧА: перенести сортировку в динамический массив.
         // Получить все геометрии из текущей сцены.
         DArray<GeometryDistance> GeometryDistances;
@@ -215,6 +254,7 @@ bool RenderViewWorld::BuildPacket(RenderView* self, FrameData& rFrameData, Viewp
             if (!gData.geometry) {
                 continue;
             }
+            ReportTextureScreenSize(gData, camera->GetPosition(), viewport);
 
             // ЗАДАЧА: Добавить что-то к материалу для проверки прозрачности.
             bool HasTransparancy = false;
@@ -222,7 +262,11 @@ bool RenderViewWorld::BuildPacket(RenderView* self, FrameData& rFrameData, Viewp
                 HasTransparancy = (gData.geometry->material->maps[0].texture->flags & Texture::Flag::HasTransparency) == 0;
             }
             if (HasTransparancy) {
-                OutPacket.geometries.PushBack(gData);
+                if (GpuCulling) {
+                    opaque.PushBack(gData);
+                } else {
+                    OutPacket.geometries.PushBack(gData);
+                }
             } else {
                 // Для сеток _с_ прозрачностью добавьте их в отдельный список, чтобы позже отсортировать по расстоянию.
                 // Получите центр, извлеките глобальную позицию из матрицы модели и добавьте ее в центр, 
@@ -237,6 +281,11 @@ bool RenderViewWorld::BuildPacket(RenderView* self, FrameData& rFrameData, Viewp
             }
         }
 
+        if (GpuCulling) {
+            RenderingSystem::GpuCullingSetView(OutPacket.ProjectionMatrix, OutPacket.ViewMatrix);
+            rwwData->GpuGeometryCount = rwwData->GpuCullingBuild(opaque, OutPacket);
+        }
+
         // Сортировать расстояния
         u32 GeometryCount = GeometryDistances.Length();
         QuickSort(GeometryDistances.Data(), 0, GeometryCount - 1, false);
@@ -249,6 +298,7 @@ bool RenderViewWorld::BuildPacket(RenderView* self, FrameData& rFrameData, Viewp
 
         const u32& TerrainCount = WorldData.TerrainGeometries.Length();
         for (u32 i = 0; i < TerrainCount; ++i) {
+            ReportTextureScreenSize(WorldData.TerrainGeometries[i], camera->GetPosition(), viewport);
             OutPacket.TerrainGeometries.PushBack(WorldData.TerrainGeometries[i]);
             // OutPacket.TerrainGeometryCount++;
         }
@@ -264,6 +314,118 @@ bool RenderViewWorld::BuildPacket(RenderView* self, FrameData& rFrameData, Viewp
     return false;
 }
 
+u32 RenderViewWorld::GpuCullingBuild(const DArray<GeometryRenderData> &opaque, RenderViewPacket &OutPacket)
+{
+    CullBatches.Clear();
+    const u32 count = opaque.Length();
+
+    // Косвенно рисуются только индексированные геометрии без инверсии намотки: у партии одно состояние конвейера.
+    // Сначала считаются размеры партий по материалам, затем геометрии раскладываются по ним.
+    u32 total = 0;
+    for (u32 i = 0; i < count; ++i) {
+        const auto& gData = opaque[i];
+        if (gData.WindingInverted || !gData.geometry->IndexCount) {
+            continue;
+        }
+        auto material = gData.geometry->material ? gData.geometry->material : MaterialSystem::GetDefaultMaterial();
+        u32 b = 0;
+        while (b < CullBatches.Length() && CullBatches[b].material != material) {
+            b++;
+        }
+        if (b == CullBatches.Length()) {
+            CullBatches.PushBack(GpuCullBatch{material, 0, 0});
+        }
+        CullBatches[b].count++;
+        total++;
+    }
+
+    u32 first = 0;
+    for (u32 b = 0; b < CullBatches.Length(); ++b) {
+        CullBatches[b].first = first;
+        first += CullBatches[b].count;
+        CullBatches[b].count = 0;
+    }
+
+    DArray<GeometryRenderData> ordered;
+    ordered.Resize(total);
+    CullInstances.Resize(total);
+    for (u32 i = 0; i < count; ++i) {
+        const auto& gData = opaque[i];
+        if (gData.WindingInverted || !gData.geometry->IndexCount) {
+            continue;
+        }
+        auto material = gData.geometry->material ? gData.geometry->material : MaterialSystem::GetDefaultMaterial();
+        u32 b = 0;
+        while (CullBatches[b].material != material) {
+            b++;
+        }
+        const u32 index = CullBatches[b].first + CullBatches[b].count++;
+        ordered[index] = gData;
+        CullInstances[index].geometry = gData.geometry;
+        CullInstances[index].model = gData.model;
+    }
+
+    if (!total || !RenderingSystem::GpuCullingUpload(CullInstances.Data(), total)) {
+        // GPU не принял геометрии: все рисуется и отсекается как обычно.
+        CullBatches.Clear();
+        for (u32 i = 0; i < count; ++i) {
+            OutPacket.geometries.PushBack(opaque[i]);
+        }
+        return 0;
+    }
+
+    for (u32 i = 0; i < total; ++i) {
+        OutPacket.geometries.PushBack(ordered[i]);
+    }
+    for (u32 i = 0; i < count; ++i) {
+        if (opaque[i].WindingInverted || !opaque[i].geometry->IndexCount) {
+            OutPacket.geometries.PushBack(opaque[i]);
+        }
+    }
+    return total;
+}
+
+/// @brief Применяет материал геометрии и рисует ее шейдером материала, который уже используется.
+static void DrawMaterialGeometry(GeometryRenderData& geometry, const FrameData& rFrameData)
+{
+    Material* material = nullptr;
+    if (geometry.geometry->material) {
+        material = geometry.geometry->material;
+    } else {
+        material = MaterialSystem::GetDefaultMaterial();
+    }
+
+    // Обновите материал, если он еще не был в этом кадре. 
+    // Это предотвращает многократное обновление одного и того же материала. 
+    // Его все равно нужно привязать в любом случае, поэтому этот результат проверки передается на бэкэнд, 
+    // который либо обновляет внутренние привязки шейдера и привязывает их, либо только привязывает их.
+    bool NeedsUpdate = material->RenderFrameNumber != rFrameData.RendererFrameNumber || material->RenderDrawIndex != rFrameData.DrawIndex;
+    if (!MaterialSystem::ApplyInstance(material, rFrameData, NeedsUpdate)) {
+        MWARN("Не удалось применить материал '%s'. Пропуск отрисовки.", material->name);
+        return;
+    } else {
+        // Синхронизируйте номер кадра и индекс отрисовки.
+        material->RenderFrameNumber = rFrameData.RendererFrameNumber;
+        material->RenderDrawIndex = rFrameData.DrawIndex;
+    }
+
+    // Примените локальные переменные
+    MaterialSystem::ApplyLocal(material, geometry.model);
+
+    // При необходимости инвертируйте.
+    if (geometry.WindingInverted) {
+        RenderingSystem::SetWinding(RendererWinding::Clockwise);
+    }
+
+    // Нарисуйте его.
+    RenderingSystem::DrawGeometry(geometry);
+
+    // При необходимости верните обратно.
+    if (geometry.WindingInverted) {
+        RenderingSystem::SetWinding(RendererWinding::CounterClockwise);
+    }
+}
+
 bool RenderViewWorld::Render(const RenderView* self, RenderViewPacket &packet, const FrameData& rFrameData)
 {
     if (self) {
@@ -396,46 +558,30 @@ bool RenderViewWorld::Render(const RenderView* self, RenderViewPacket &packet, c
                     return false;
                 }
 
-                // Нарисовать геометрию.
-                const auto& count = packet.geometries.Length();
-                for (u32 i = 0; i < count; ++i) {
-                    Material* material = nullptr;
-                    auto& geometry = packet.geometries[i];
-                    if (geometry.geometry->material) {
-                        material = geometry.geometry->material;
-                    } else {
-                        material = MaterialSystem::GetDefaultMaterial();
-                    }
-
-                    // Обновите материал, если он еще не был в этом кадре. 
-                    // Это предотвращает многократное обновление одного и того же материала. 
-                    // Его все равно нужно привязать в любом случае, поэтому этот результат проверки передается на бэкэнд, 
-                    // который либо обновляет внутренние привязки шейдера и привязывает их, либо только привязывает их.
+                // Геометрии, отсеченные на GPU: одна косвенная отрисовка на материал. Если шейдер не поддерживает
+                // косвенную отрисовку, партия рисуется по одной геометрии, уже без отсечения.
+                const u32 GpuCount = MMIN(data->GpuGeometryCount, GeometryCount);
+                for (u32 b = 0; GpuCount && b < data->CullBatches.Length(); ++b) {
+                    const auto& batch = data->CullBatches[b];
+                    auto material = batch.material;
                     bool NeedsUpdate = material->RenderFrameNumber != rFrameData.RendererFrameNumber || material->RenderDrawIndex != rFrameData.DrawIndex;
                     if (!MaterialSystem::ApplyInstance(material, rFrameData, NeedsUpdate)) {
                         MWARN("Не удалось применить материал '%s'. Пропуск отрисовки.", material->name);
                         continue;
-                    } else {
-                        // Синхронизируйте номер кадра и индекс отрисовки.
-                        material->RenderFrameNumber = rFrameData.RendererFrameNumber;
-                        material->RenderDrawIndex = rFrameData.DrawIndex;
                     }
+                    material->RenderFrameNumber = rFrameData.RendererFrameNumber;
+                    material->RenderDrawIndex = rFrameData.DrawIndex;
 
-                    // Примените локальные переменные
-                    MaterialSystem::ApplyLocal(material, geometry.model);
-
-                    // При необходимости инвертируйте.
-                    if (geometry.WindingInverted) {
-                        RenderingSystem::SetWinding(RendererWinding::Clockwise);
+                    if (!RenderingSystem::GpuCullingDraw(batch.first, batch.count)) {
+                        for (u32 i = batch.first; i < batch.first + batch.count; ++i) {
+                            DrawMaterialGeometry(packet.geometries[i], rFrameData);
+                        }
                     }
+                }
 
-                    // Нарисуйте его.
-                    RenderingSystem::DrawGeometry(geometry);
-
-                    // При необходимости верните обратно.
-                    if (geometry.WindingInverted) {
-                        RenderingSystem::SetWinding(RendererWinding::CounterClockwise);
-                    }
+                // Нарисовать остальную геометрию.
+                for (u32 i = GpuCount; i < GeometryCount; ++i) {
+                    DrawMaterialGeometry(packet.geometries[i], rFrameData);
                 }
             }
 
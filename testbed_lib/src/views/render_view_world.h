@@ -1,7 +1,9 @@
 #pragma once
 #include "renderer/render_view.h"
+#include "renderer/renderer_types.h"
 
 struct Shader;
+struct Material;
 
 struct RenderViewWorldData {
     DArray<GeometryRenderData> WorldGeometries;
@@ -18,6 +20,13 @@ struct SkyboxShaderLocation
 };
 
 
+/// @brief Геометрии одного материала, отсекаемые и рисуемые на GPU одной косвенной отрисовкой.
+struct GpuCullBatch {
+    Material* material;
+    u32 first;  // Первый экземпляр партии в пакете и в записях отсечения.
+    u32 count;
+};
+
 class RenderViewWorld
 {
 private:
@@ -34,9 +43,12 @@ private:
         u16 model;
     } DebugLocations;
     SkyboxShaderLocation SkyboxLocation;
+    DArray<GpuCullInstance> CullInstances;  // Экземпляры, переданные на отсечение на GPU в последнем пакете.
+    DArray<GpuCullBatch> CullBatches;       // Партии по материалам. Их геометрии идут первыми в пакете.
+    u32 GpuGeometryCount;                   // Количество геометрий пакета, которые рисуются косвенно. 0, если отсечение на GPU выключено.
 
 public:
-    constexpr RenderViewWorld() : MaterialShader(nullptr), SkyboxShader(nullptr), TerrainShader(nullptr), ColourShader(nullptr),  AmbientColour(0.25F, 0.25F, 0.25F, 1.F), RenderMode(), DebugLocations(), SkyboxLocation() {}
+    constexpr RenderViewWorld() : MaterialShader(nullptr), SkyboxShader(nullptr), TerrainShader(nullptr), ColourShader(nullptr),  AmbientColour(0.25F, 0.25F, 0.25F, 1.F), RenderMode(), DebugLocations(), SkyboxLocation(), CullInstances(), CullBatches(), GpuGeometryCount() {}
 
     static bool OnRegistered(RenderView* self);
     static void Destroy(RenderView* self);
@@ -48,4 +60,7 @@ public:
     void operator delete(void* ptr, u64 size);
 private:
     static bool OnEvent(u16 code, void* sender, void* ListenerInst, EventContext context);
+    /// @brief Передает непрозрачные геометрии на отсечение на GPU, сгруппировав их по материалам, и добавляет их в начало пакета.
+    /// @return количество геометрий, которые будут нарисованы косвенно; 0, если GPU их не принял.
+    u32 GpuCullingBuild(const DArray<GeometryRenderData>& candidates, RenderViewPacket& OutPacket);
 };
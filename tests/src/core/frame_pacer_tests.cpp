@@ -0,0 +1,194 @@
+#include "frame_pacer_tests.hpp"
+#include "../test_manager.hpp"
+#include "../expect.hpp"
+
+#include <core/console.hpp>
+#include <core/frame_pacer.h>
+#include <core/memory_system.h>
+#include <core/mvar.h>
+
+constexpr i32 TEST_FRAME_RATE = 200;
+constexpr u32 TEST_FRAME_COUNT = FRAME_PACER_HISTORY;  // Вся статистика относится к одному прогону.
+constexpr f64 TEST_FRAME_WORK = 0.001;
+constexpr f64 TEST_CLOCK_TICK = 0.000001;   // Каждое чтение часов сдвигает время, иначе цикл досыпания не закончится.
+constexpr f64 TEST_OVERSLEEP = 0.0003;      // Опоздание сна ОС на управляемых часах.
+constexpr f64 TEST_TOLERANCE_MS = 0.05;
+
+// Управляемые часы: время идет только при чтении, сне и работе кадра, поэтому результаты не зависят от нагрузки машины.
+static f64 TestTime = 1.0;
+
+static f64 TestGetTime()
+{
+    TestTime += TEST_CLOCK_TICK;
+    return TestTime;
+}
+
+static void TestSleep(f64 seconds)
+{
+    TestTime += seconds + TEST_OVERSLEEP;
+}
+
+/// @brief Кадры с постоянной работой; возвращает среднее время от опроса ввода до конца кадра в миллисекундах.
+static f64 TestRunFrames(u32 count, f64 work, FramePacerStats& OutStats)
+{
+    f64 latency = 0.0;
+    for (u32 i = 0; i < count; ++i) {
+        FramePacer::BeginFrame();
+        const f64 input = TestTime;
+        TestTime += work;
+        FramePacer::EndFrame();
+        latency += TestTime - input;
+    }
+    FramePacer::GetStats(OutStats);
+    return latency / count * 1000.0;
+}
+
+/// @brief Системы, нужные темпу кадров: консоль для команды статистики и mvar для настроек.
+struct TestSystems {
+    u64 ConsoleMemoryRequirement, MVarMemoryRequirement, PacerMemoryRequirement;
+    void* ConsoleMemory;
+    void* MVarMemory;
+    void* PacerMemory;
+};
+
+static void TestShutdown(TestSystems& systems)
+{
+    if (systems.PacerMemory) {
+        FramePacer::Shutdown();
+        MemorySystem::Free(systems.PacerMemory, systems.PacerMemoryRequirement, Memory::Engine);
+    }
+    if (systems.MVarMemory) {
+        MVar::Shutdown();
+        MemorySystem::Free(systems.MVarMemory, systems.MVarMemoryRequirement, Memory::Engine);
+    }
+    if (systems.ConsoleMemory) {
+        Console::Shutdown();
+        MemorySystem::Free(systems.ConsoleMemory, systems.ConsoleMemoryRequirement, Memory::Engine);
+    }
+    systems = {};
+}
+
+/// @brief Запускает системы; при ошибке останавливает уже запущенные.
+static bool TestInitialize(TestSystems& systems)
+{
+    systems = {};
+    Console::Initialize(systems.ConsoleMemoryRequirement, nullptr, nullptr);
+    systems.ConsoleMemory = MemorySystem::Allocate(systems.ConsoleMemoryRequirement, Memory::Engine);
+    bool result = Console::Initialize(systems.ConsoleMemoryRequirement, systems.ConsoleMemory, nullptr);
+
+    if (result) {
+        MVar::Initialize(systems.MVarMemoryRequirement, nullptr, nullptr);
+        systems.MVarMemory = MemorySystem::Allocate(systems.MVarMemoryRequirement, Memory::Engine);
+        result = MVar::Initialize(systems.MVarMemoryRequirement, systems.MVarMemory, nullptr);
+    }
+
+    if (result) {
+        FramePacerConfig config { TestGetTime, TestSleep };
+        FramePacer::Initialize(systems.PacerMemoryRequirement, nullptr, &config);
+        systems.PacerMemory = MemorySystem::Allocate(systems.PacerMemoryRequirement, Memory::Engine);
+        result = FramePacer::Initialize(systems.PacerMemoryRequirement, systems.PacerMemory, &config);
+    }
+
+    if (!result) {
+        TestShutdown(systems);
+    }
+    return result;
+}
+
+static u8 TestHoldTargetRateAndCutLatency()
+{
+    const f64 TargetMs = 1000.0 / TEST_FRAME_RATE;
+    ExpectToBeTrue(MVar::SetInt("frame_rate_limit", TEST_FRAME_RATE));
+
+    FramePacerStats throughput;
+    const f64 ThroughputLatencyMs = TestRunFrames(TEST_FRAME_COUNT, TEST_FRAME_WORK, throughput);
+
+    ExpectToBeTrue(MVar::SetInt("frame_pacing_mode", FramePacer::LowLatency));
+    FramePacerStats LowLatency;
+    const f64 LowLatencyMs = TestRunFrames(TEST_FRAME_COUNT, TEST_FRAME_WORK, LowLatency);
+
+    // Среднее держится у цели в обоих режимах, сроки не пропускаются.
+    ExpectToBeTrue(throughput.mode == FramePacer::Throughput);
+    ExpectToBeTrue(Math::abs((f32)(throughput.MeanMs - TargetMs)) < TEST_TOLERANCE_MS);
+    ExpectShouldBe((i64)0, (i64)throughput.MissedRecent);
+    ExpectToBeTrue(LowLatency.mode == FramePacer::LowLatency);
+    ExpectToBeTrue(Math::abs((f32)(LowLatency.MeanMs - TargetMs)) < TEST_TOLERANCE_MS);
+    ExpectShouldBe((i64)0, (i64)LowLatency.MissedRecent);
+
+    // В режиме пропускной способности ввод ждет весь интервал, в режиме малой задержки — лишь работу кадра и запас.
+    ExpectToBeTrue(ThroughputLatencyMs > TargetMs - TEST_TOLERANCE_MS);
+    ExpectToBeTrue(LowLatencyMs > TEST_FRAME_WORK * 1000.0);
+    ExpectToBeTrue(LowLatencyMs < LowLatency.PredictedWorkMs + TEST_TOLERANCE_MS);
+    return true;
+}
+
+static u8 TestResyncAfterMissedDeadline()
+{
+    const f64 period = 1.0 / TEST_FRAME_RATE;
+    ExpectToBeTrue(MVar::SetInt("frame_rate_limit", TEST_FRAME_RATE));
+
+    FramePacerStats stats;
+    TestRunFrames(TEST_FRAME_COUNT, TEST_FRAME_WORK, stats);
+    const u64 missed = stats.MissedTotal;
+
+    // Кадр длиной в три интервала пропускает срок один раз.
+    TestRunFrames(1, period * 3.0, stats);
+    ExpectShouldBe((i64)missed + 1, (i64)stats.MissedTotal);
+
+    // Следующие кадры не догоняют пропущенные без ожидания: каждый занимает полный интервал от конца долгого кадра.
+    for (u32 i = 0; i < 3; ++i) {
+        const f64 start = TestTime;
+        TestRunFrames(1, TEST_FRAME_WORK, stats);
+        ExpectToBeTrue(Math::abs((f32)((TestTime - start - period) * 1000.0)) < TEST_TOLERANCE_MS);
+    }
+    ExpectShouldBe((i64)missed + 1, (i64)stats.MissedTotal);
+    return true;
+}
+
+static u8 TestUnlimitedDoesNotWait()
+{
+    ExpectToBeTrue(MVar::SetInt("frame_rate_limit", TEST_FRAME_RATE));
+    FramePacerStats stats;
+    TestRunFrames(TEST_FRAME_COUNT, TEST_FRAME_WORK, stats);
+
+    // Снятие ограничения сбрасывает срок: кадр заканчивается сразу после работы в любом режиме.
+    ExpectToBeTrue(MVar::SetInt("frame_rate_limit", 0));
+    for (i32 mode = FramePacer::Throughput; mode <= FramePacer::LowLatency; ++mode) {
+        ExpectToBeTrue(MVar::SetInt("frame_pacing_mode", mode));
+        const f64 start = TestTime;
+        TestRunFrames(1, TEST_FRAME_WORK, stats);
+        ExpectToBeTrue((TestTime - start - TEST_FRAME_WORK) * 1000.0 < TEST_TOLERANCE_MS);
+    }
+    FramePacer::GetStats(stats);
+    ExpectToBeTrue(stats.TargetMs == 0.0);
+    return true;
+}
+
+/// @brief Выполняет проверку на только что запущенных системах и останавливает их при любом исходе.
+static u8 TestRun(u8 (*test)())
+{
+    TestSystems systems;
+    ExpectToBeTrue(TestInitialize(systems));
+    const u8 result = test();
+    TestShutdown(systems);
+    return result;
+}
+
+u8 FramePacerShouldHoldTargetRateAndCutLatency() {
+    return TestRun(TestHoldTargetRateAndCutLatency);
+}
+
+u8 FramePacerShouldResyncAfterMissedDeadline() {
+    return TestRun(TestResyncAfterMissedDeadline);
+}
+
+u8 FramePacerShouldNotWaitWhenUnlimited() {
+    return TestRun(TestUnlimitedDoesNotWait);
+}
+
+void FramePacerRegisterTests()
+{
+    TestManagerRegisterTest(FramePacerShouldHoldTargetRateAndCutLatency, "Темп кадров должен держать заданную частоту и в режиме малой задержки опрашивать ввод ближе к концу кадра");
+    TestManagerRegisterTest(FramePacerShouldResyncAfterMissedDeadline, "После пропущенного срока темп кадров должен отсчитывать интервал заново, а не догонять пропущенные кадры");
+    TestManagerRegisterTest(FramePacerShouldNotWaitWhenUnlimited, "Без ограничения частоты темп кадров не должен ждать ни в одном режиме");
+}
@@ -0,0 +1,109 @@
+#include "profiler_tests.hpp"
+#include "../test_manager.hpp"
+#include "../expect.hpp"
+
+#include <core/console.hpp>
+#include <core/memory_system.h>
+#include <core/msemaphore.hpp>
+#include <core/mthread.hpp>
+#include <core/profiler.h>
+#include <platform/filesystem.hpp>
+
+#include <cstring>
+#include <cstdio>
+
+#define TEST_TRACE_PATH "profiler_test_trace.json"
+
+static MSemaphore* WorkerDone = nullptr;
+
+static u32 TestProfilerWorker(void* params)
+{
+    Profiler::SetThreadName("Тестовый рабочий");
+    {
+        MPROFILE_SCOPE("Test::Worker");
+    }
+    WorkerDone->Signal();
+    return 0;
+}
+
+/// @brief Количество вхождений подстроки в текст.
+static u32 TestCount(const char* text, const char* pattern)
+{
+    u32 count = 0;
+    for (const char* p = strstr(text, pattern); p; p = strstr(p + 1, pattern)) {
+        count++;
+    }
+    return count;
+}
+
+u8 ProfilerCaptureShouldExportNestedZones() {
+    u64 ConsoleMemoryRequirement = 0, ProfilerMemoryRequirement = 0;
+    Console::Initialize(ConsoleMemoryRequirement, nullptr, nullptr);
+    void* ConsoleMemory = MemorySystem::Allocate(ConsoleMemoryRequirement, Memory::Engine);
+    ExpectToBeTrue(Console::Initialize(ConsoleMemoryRequirement, ConsoleMemory, nullptr));
+    Profiler::Initialize(ProfilerMemoryRequirement, nullptr, nullptr);
+    void* ProfilerMemory = MemorySystem::Allocate(ProfilerMemoryRequirement, Memory::Engine);
+    ExpectToBeTrue(Profiler::Initialize(ProfilerMemoryRequirement, ProfilerMemory, nullptr));
+
+    Profiler::SetThreadName("Тестовый основной");
+
+    // Кадр 0 переполняет кольцевой буфер; его зоны в захват не попадают.
+    Profiler::FrameMark();
+    for (u32 i = 0; i < PROFILER_EVENTS_PER_THREAD; ++i) {
+        MPROFILE_SCOPE("Test::Flood");
+    }
+
+    MSemaphore done;
+    WorkerDone = &done;
+    for (u32 frame = 1; frame <= 3; ++frame) {
+        Profiler::FrameMark();
+        MPROFILE_SCOPE("Test::Outer");
+        {
+            MPROFILE_SCOPE("Test::Inner");
+        }
+        if (frame == 1) {
+            MThread worker(TestProfilerWorker, nullptr, true);
+            ExpectToBeTrue(done.Wait());
+        }
+    }
+    // Начало кадра 4 завершает кадр 3.
+    Profiler::FrameMark();
+    {
+        MPROFILE_SCOPE("Test::Open");
+        ExpectToBeTrue(Profiler::ExportChromeTrace(TEST_TRACE_PATH, 3));
+    }
+
+    FileHandle f;
+    u64 size = 0, read = 0;
+    ExpectToBeTrue(Filesystem::Open(TEST_TRACE_PATH, FileModes::Read, false, f));
+    ExpectToBeTrue(Filesystem::Size(f, size));
+    char* text = reinterpret_cast<char*>(MemorySystem::Allocate(size + 1, Memory::String, true));
+    ExpectToBeTrue(Filesystem::ReadAllText(f, text, read));
+    Filesystem::Close(f);
+
+    ExpectToBeTrue((strstr(text, "\"traceEvents\"") != nullptr));
+    ExpectToBeTrue((strstr(text, "Тестовый основной") != nullptr));
+    ExpectToBeTrue((strstr(text, "Тестовый рабочий") != nullptr));
+    // По две зоны на кадр окна и одна зона рабочего потока; зоны кадра 0 и текущего кадра вне окна.
+    ExpectShouldBe((u64)7, (u64)TestCount(text, "\"ph\":\"X\""));
+    ExpectShouldBe((u64)3, (u64)TestCount(text, "Test::Outer"));
+    ExpectShouldBe((u64)3, (u64)TestCount(text, "Test::Inner"));
+    ExpectShouldBe((u64)1, (u64)TestCount(text, "Test::Worker"));
+    ExpectShouldBe((u64)0, (u64)TestCount(text, "Test::Flood"));
+    ExpectShouldBe((u64)0, (u64)TestCount(text, "Test::Open"));
+    ExpectShouldBe((u64)3, (u64)TestCount(text, "\"ph\":\"i\""));
+
+    MemorySystem::Free(text, size + 1, Memory::String);
+    remove(TEST_TRACE_PATH);
+    WorkerDone = nullptr;
+    Profiler::Shutdown();
+    Console::Shutdown();
+    MemorySystem::Free(ProfilerMemory, ProfilerMemoryRequirement, Memory::Engine);
+    MemorySystem::Free(ConsoleMemory, ConsoleMemoryRequirement, Memory::Engine);
+    return true;
+}
+
+void ProfilerRegisterTests()
+{
+    TestManagerRegisterTest(ProfilerCaptureShouldExportNestedZones, "Захват профилировщика должен выгружать вложенные зоны всех потоков только за запрошенные кадры");
+}
@@ -4,6 +4,16 @@
 #include "containers/hashtable_tests.hpp"
 #include "containers/freelist_test.hpp"
 #include "memory/dynamic_allocator_tests.hpp"
+#include "systems/material_reload_tests.hpp"
+#include "renderer/rendergraph_tests.hpp"
+#include "math/frustum_tests.hpp"
+#include "math/geometry_utils_tests.hpp"
+#include "resources/font_lookup_tests.hpp"
+#include "resources/glyph_atlas_tests.hpp"
+#include "resources/msdf_tests.hpp"
+#include "resources/terrain_tests.hpp"
+#include "core/profiler_tests.hpp"
+#include "core/frame_pacer_tests.hpp"
 
 #include <core/logger.hpp>
 #include <stdlib.h>
@@ -22,6 +32,27 @@ int main() {
 
     DynamicAllocatorRegisterTests();
 
+    RendergraphRegisterTests();
+
+    FrustumRegisterTests();
+
+    FontLookupRegisterTests();
+
+    GlyphAtlasRegisterTests();
+
+    MsdfRegisterTests();
+
+    TerrainRegisterTests();
+
+    GeometryUtilsRegisterTests();
+
+    ProfilerRegisterTests();
+
+    FramePacerRegisterTests();
+
+    // Запускает и останавливает движок целиком, поэтому идет последним.
+    MaterialReloadRegisterTests();
+
     MDEBUG("Запуск тестов...");
 
     // Выполнение тестов
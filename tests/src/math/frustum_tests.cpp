@@ -0,0 +1,50 @@
+#include "frustum_tests.hpp"
+#include "../test_manager.hpp"
+#include "../expect.hpp"
+
+#include <math/frustrum.h>
+#include <math/matrix4d.h>
+
+/// @brief Пирамида камеры с полем зрения 90°, квадратным аспектом и плоскостями 0.1 и 100, смотрящей вдоль -Z.
+static Frustum TestFrustum(const FVec3& CameraPosition)
+{
+    auto view = Matrix4D::MakeTranslation(FVec3(-CameraPosition.x, -CameraPosition.y, -CameraPosition.z));
+    auto projection = Matrix4D::MakeFrustumProjection(Math::DegToRad(90.F), 1.F, 0.1F, 100.F);
+    Frustum f;
+    f.FromMatrix(view * projection);
+    return f;
+}
+
+u8 FrustumFromMatrixShouldClassifyPoints() {
+    auto f = TestFrustum(FVec3());
+
+    ExpectToBeTrue(f.IntersectsSphere(FVec3(0.F, 0.F, -10.F), 0.F));
+    ExpectToBeTrue(f.IntersectsSphere(FVec3(9.F, 9.F, -10.F), 0.F));
+    // За камерой, за дальней плоскостью, перед ближней плоскостью и сбоку от пирамиды.
+    ExpectToBeFalse(f.IntersectsSphere(FVec3(0.F, 0.F, 10.F), 0.F));
+    ExpectToBeFalse(f.IntersectsSphere(FVec3(0.F, 0.F, -200.F), 0.F));
+    ExpectToBeFalse(f.IntersectsSphere(FVec3(0.F, 0.F, -0.05F), 0.F));
+    ExpectToBeFalse(f.IntersectsSphere(FVec3(20.F, 0.F, -10.F), 0.F));
+
+    // Плоскости нормализованы, поэтому радиус сферы сравнивается с настоящим расстоянием.
+    ExpectToBeTrue(f.IntersectsSphere(FVec3(11.F, 0.F, -10.F), 2.F));
+    ExpectToBeFalse(f.IntersectsSphere(FVec3(11.F, 0.F, -10.F), 0.5F));
+    ExpectFloatToBe(1.F, Math::sqrt(f.sides[Frustum::Left].x * f.sides[Frustum::Left].x + f.sides[Frustum::Left].z * f.sides[Frustum::Left].z));
+
+    return true;
+}
+
+u8 FrustumFromMatrixShouldFollowView() {
+    auto f = TestFrustum(FVec3(5.F, 0.F, 0.F));
+
+    ExpectToBeTrue(f.IntersectsSphere(FVec3(5.F, 0.F, -10.F), 0.F));
+    ExpectToBeFalse(f.IntersectsSphere(FVec3(-6.F, 0.F, -10.F), 0.F));
+    ExpectToBeTrue(f.IntersectsAABB(FVec3(-6.F, 0.F, -10.F), FVec3(2.F, 2.F, 2.F)));
+
+    return true;
+}
+
+void FrustumRegisterTests() {
+    TestManagerRegisterTest(FrustumFromMatrixShouldClassifyPoints, "Пирамида из матрицы вида-проекции должна отсекать точки вне всех шести плоскостей");
+    TestManagerRegisterTest(FrustumFromMatrixShouldFollowView, "Пирамида из матрицы вида-проекции должна учитывать положение камеры");
+}
@@ -0,0 +1,116 @@
+#include "geometry_utils_tests.hpp"
+#include "../test_manager.hpp"
+#include "../expect.hpp"
+
+#include <core/clock.h>
+#include <math/geometry_utils.h>
+#include <math/vertex.h>
+
+constexpr u32 TEST_GRID_SIZE = 709;     // Вершин по каждой оси: 708 * 708 * 2 = 1 002 528 треугольников.
+constexpr f32 TEST_GEOMETRY_TOLERANCE = 0.0001F;
+
+/// @brief Холмистая сетка с общими вершинами, чтобы каждая вершина принадлежала нескольким треугольникам.
+static void TestGrid(Vertex3D*& OutVertices, u32& OutVertexCount, u32*& OutIndices, u32& OutIndexCount)
+{
+    OutVertexCount = TEST_GRID_SIZE * TEST_GRID_SIZE;
+    OutIndexCount = (TEST_GRID_SIZE - 1) * (TEST_GRID_SIZE - 1) * 6;
+    OutVertices = reinterpret_cast<Vertex3D*>(MemorySystem::Allocate(sizeof(Vertex3D) * OutVertexCount, Memory::Array, true));
+    OutIndices = reinterpret_cast<u32*>(MemorySystem::Allocate(sizeof(u32) * OutIndexCount, Memory::Array));
+    for (u32 z = 0; z < TEST_GRID_SIZE; ++z) {
+        for (u32 x = 0; x < TEST_GRID_SIZE; ++x) {
+            auto& v = OutVertices[z * TEST_GRID_SIZE + x];
+            v.position = FVec3(x * 1.F, 4.F * Math::sin(x * 0.05F) * Math::cos(z * 0.03F), z * 1.F);
+            v.texcoord = FVec2(x * 0.25F, z * 0.25F);
+        }
+    }
+    u32 i = 0;
+    for (u32 z = 0; z < TEST_GRID_SIZE - 1; ++z) {
+        for (u32 x = 0; x < TEST_GRID_SIZE - 1; ++x) {
+            const u32 v0 = z * TEST_GRID_SIZE + x;
+            const u32 v1 = v0 + 1;
+            const u32 v2 = v0 + TEST_GRID_SIZE;
+            const u32 v3 = v2 + 1;
+            OutIndices[i++] = v2; OutIndices[i++] = v1; OutIndices[i++] = v0;
+            OutIndices[i++] = v3; OutIndices[i++] = v1; OutIndices[i++] = v2;
+        }
+    }
+}
+
+/// @brief Последовательный обход треугольников, как до пакетных ядер: сначала нормали, затем касательные.
+static void TestReferenceNormalsAndTangents(Vertex3D* vertices, u32 IndexCount, const u32* indices)
+{
+    for (u32 i = 0; i < IndexCount; i += 3) {
+        auto& v0 = vertices[indices[i + 0]];
+        auto& v1 = vertices[indices[i + 1]];
+        auto& v2 = vertices[indices[i + 2]];
+        v0.normal = v1.normal = v2.normal = Normalize(Cross(v1.position - v0.position, v2.position - v0.position));
+    }
+    for (u32 i = 0; i < IndexCount; i += 3) {
+        auto& v0 = vertices[indices[i + 0]];
+        auto& v1 = vertices[indices[i + 1]];
+        auto& v2 = vertices[indices[i + 2]];
+        const FVec3 edge1 = v1.position - v0.position;
+        const FVec3 edge2 = v2.position - v0.position;
+        const f32 deltaU1 = v1.texcoord.x - v0.texcoord.x;
+        const f32 deltaV1 = v1.texcoord.y - v0.texcoord.y;
+        const f32 deltaU2 = v2.texcoord.x - v0.texcoord.x;
+        const f32 deltaV2 = v2.texcoord.y - v0.texcoord.y;
+        const f32 fc = 1.F / (deltaU1 * deltaV2 - deltaU2 * deltaV1);
+        const FVec3 tangent = Normalize(FVec3(fc * (deltaV2 * edge1.x - deltaV1 * edge2.x), 
+                                              fc * (deltaV2 * edge1.y - deltaV1 * edge2.y), 
+                                              fc * (deltaV2 * edge1.z - deltaV1 * edge2.z)));
+        const f32 handedness = ((deltaV1 * deltaU2 - deltaV2 * deltaU1) < 0.F) ? -1.F : 1.F;
+        v0.tangent = v1.tangent = v2.tangent = tangent * handedness;
+    }
+}
+
+static f32 TestMaxDifference(const FVec3& a, const FVec3& b)
+{
+    return MMAX(Math::abs(a.x - b.x), MMAX(Math::abs(a.y - b.y), Math::abs(a.z - b.z)));
+}
+
+u8 GeometryBatchedNormalsShouldMatchScalar() {
+    Vertex3D* vertices = nullptr;
+    u32* indices = nullptr;
+    u32 VertexCount = 0, IndexCount = 0;
+    TestGrid(vertices, VertexCount, indices, IndexCount);
+    auto reference = reinterpret_cast<Vertex3D*>(MemorySystem::Allocate(sizeof(Vertex3D) * VertexCount, Memory::Array));
+    MemorySystem::CopyMem(reference, vertices, sizeof(Vertex3D) * VertexCount);
+
+    Clock clock;
+    clock.Start();
+    TestReferenceNormalsAndTangents(reference, IndexCount, indices);
+    clock.Update();
+    const f64 ScalarMs = clock.elapsed * 1000.0;
+
+    clock.Start();
+    Math::Geometry::GenerateNormals(VertexCount, vertices, IndexCount, indices);
+    Math::Geometry::CalculateTangents(VertexCount, vertices, IndexCount, indices);
+    clock.Update();
+    const f64 BatchedMs = clock.elapsed * 1000.0;
+
+    f32 MaxNormalError = 0.F, MaxTangentError = 0.F;
+    for (u32 i = 0; i < VertexCount; ++i) {
+        MaxNormalError = MMAX(MaxNormalError, TestMaxDifference(reference[i].normal, vertices[i].normal));
+        MaxTangentError = MMAX(MaxTangentError, TestMaxDifference(reference[i].tangent, vertices[i].tangent));
+    }
+    MINFO("Нормали и касательные для %u треугольников: последовательно %.2f мс, пакетно %.2f мс; расхождение %g / %g.", 
+        IndexCount / 3, ScalarMs, BatchedMs, MaxNormalError, MaxTangentError);
+
+    // Сетка обращена вверх, касательная идет вдоль u = x.
+    const auto& center = vertices[(TEST_GRID_SIZE / 2) * TEST_GRID_SIZE + TEST_GRID_SIZE / 2];
+    ExpectToBeTrue((center.normal.y > 0.F));
+    ExpectToBeTrue((center.tangent.x > 0.F));
+    ExpectToBeTrue((MaxNormalError < TEST_GEOMETRY_TOLERANCE));
+    ExpectToBeTrue((MaxTangentError < TEST_GEOMETRY_TOLERANCE));
+
+    MemorySystem::Free(reference, sizeof(Vertex3D) * VertexCount, Memory::Array);
+    MemorySystem::Free(vertices, sizeof(Vertex3D) * VertexCount, Memory::Array);
+    MemorySystem::Free(indices, sizeof(u32) * IndexCount, Memory::Array);
+    return true;
+}
+
+void GeometryUtilsRegisterTests()
+{
+    TestManagerRegisterTest(GeometryBatchedNormalsShouldMatchScalar, "Пакетные нормали и касательные меша из миллиона треугольников должны совпадать с последовательным обходом");
+}
@@ -0,0 +1,148 @@
+#include "rendergraph_tests.hpp"
+#include "../test_manager.hpp"
+#include "../expect.hpp"
+
+#include <renderer/rendergraph.h>
+#include <resources/texture.hpp>
+
+/// @brief Проход синтетического графа. Компиляция не обращается к рендереру, поэтому проходу нечего рисовать.
+struct TestPass : RendergraphNode {
+    TestPass(const char* PassName) { name = PassName; }
+
+    bool Initialize() override { return true; }
+    void Destroy() override {}
+    bool Render(FrameData& rFrameData) override { return true; }
+};
+
+/// @brief Задает текстуру, по которой компиляция оценивает размер цели.
+static void SetTarget(RendergraphSource& source, Texture*& slot, Texture& texture, u32 width, u32 height, u8 ChannelCount)
+{
+    texture.width = width;
+    texture.height = height;
+    texture.ChannelCount = ChannelCount;
+    slot = &texture;
+    source.textures = &slot;
+}
+
+u8 RendergraphShouldSortAndCullPasses() {
+    Rendergraph graph("rendergraph_sort_test", nullptr);
+    // Проходы добавляются не в порядке зависимостей.
+    TestPass ui("ui"), world("world"), skybox("skybox"), debug("debug");
+    ExpectToBeTrue(graph.AddPass(ui));
+    ExpectToBeTrue(graph.AddPass(world));
+    ExpectToBeTrue(graph.AddPass(skybox));
+    ExpectToBeTrue(graph.AddPass(debug));
+
+    ExpectToBeTrue(graph.AddPassSource("skybox", "colourbuffer", RendergraphSourceType::RenderTargetColour, RendergraphSourceOrigin::Self));
+    ExpectToBeTrue(graph.AddPassSink("world", "colourbuffer"));
+    ExpectToBeTrue(graph.AddPassSource("world", "colourbuffer", RendergraphSourceType::RenderTargetColour, RendergraphSourceOrigin::Other));
+    ExpectToBeTrue(graph.AddPassSink("ui", "colourbuffer"));
+    ExpectToBeTrue(graph.AddPassSource("ui", "colourbuffer", RendergraphSourceType::RenderTargetColour, RendergraphSourceOrigin::Other));
+    // Выход отладочного прохода никто не читает.
+    ExpectToBeTrue(graph.AddPassSource("debug", "colourbuffer", RendergraphSourceType::RenderTargetColour, RendergraphSourceOrigin::Self));
+
+    ExpectToBeTrue(graph.PassSetSinkLinkage("world", "colourbuffer", "skybox", "colourbuffer"));
+    ExpectToBeTrue(graph.PassSetSinkLinkage("ui", "colourbuffer", "world", "colourbuffer"));
+    graph.BackbufferGlobalSink.BoundSource = &ui.sources[0];
+
+    ExpectToBeTrue(graph.Compile());
+
+    ExpectShouldBe(3, (u64)graph.ExecutionOrder.Length());
+    ExpectToBeTrue(graph.ExecutionOrder[0] == &skybox);
+    ExpectToBeTrue(graph.ExecutionOrder[1] == &world);
+    ExpectToBeTrue(graph.ExecutionOrder[2] == &ui);
+    ExpectToBeTrue(debug.culled);
+    ExpectToBeFalse(ui.culled);
+    ExpectShouldBe(2, (u64)ui.ExecutionIndex);
+
+    // Цель неба рисуется всеми тремя проходами и уходит в задний буфер, поэтому она не временная.
+    ExpectShouldBe(0, (u64)skybox.sources[0].FirstUse);
+    ExpectShouldBe(2, (u64)skybox.sources[0].LastUse);
+    ExpectShouldBe(0, (u64)graph.AliasSlots.Length());
+
+    graph.passes.Destroy();
+    return true;
+}
+
+u8 RendergraphShouldAliasNonOverlappingTargets() {
+    Rendergraph graph("rendergraph_alias_test", nullptr);
+    TestPass shadow("shadow"), gbuffer("gbuffer"), bright("bright"), blur("blur"), composite("composite");
+    ExpectToBeTrue(graph.AddPass(shadow));
+    ExpectToBeTrue(graph.AddPass(gbuffer));
+    ExpectToBeTrue(graph.AddPass(bright));
+    ExpectToBeTrue(graph.AddPass(blur));
+    ExpectToBeTrue(graph.AddPass(composite));
+
+    ExpectToBeTrue(graph.AddPassSource("shadow", "shadowmap", RendergraphSourceType::RenderTargetDepthStencil, RendergraphSourceOrigin::Self));
+    ExpectToBeTrue(graph.AddPassSource("gbuffer", "albedo", RendergraphSourceType::RenderTargetColour, RendergraphSourceOrigin::Self));
+    ExpectToBeTrue(graph.AddPassSink("gbuffer", "shadowmap"));
+    ExpectToBeTrue(graph.AddPassSource("bright", "bright", RendergraphSourceType::RenderTargetColour, RendergraphSourceOrigin::Self));
+    ExpectToBeTrue(graph.AddPassSink("bright", "albedo"));
+    ExpectToBeTrue(graph.AddPassSource("blur", "blurred", RendergraphSourceType::RenderTargetColour, RendergraphSourceOrigin::Self));
+    ExpectToBeTrue(graph.AddPassSink("blur", "bright"));
+    ExpectToBeTrue(graph.AddPassSource("composite", "final", RendergraphSourceType::RenderTargetColour, RendergraphSourceOrigin::Self));
+    ExpectToBeTrue(graph.AddPassSink("composite", "blurred"));
+
+    ExpectToBeTrue(graph.PassSetSinkLinkage("gbuffer", "shadowmap", "shadow", "shadowmap"));
+    ExpectToBeTrue(graph.PassSetSinkLinkage("bright", "albedo", "gbuffer", "albedo"));
+    ExpectToBeTrue(graph.PassSetSinkLinkage("blur", "bright", "bright", "bright"));
+    ExpectToBeTrue(graph.PassSetSinkLinkage("composite", "blurred", "blur", "blurred"));
+    graph.BackbufferGlobalSink.BoundSource = &composite.sources[0];
+
+    Texture textures[5];
+    Texture* slots[5]{};
+    SetTarget(shadow.sources[0], slots[0], textures[0], 2048, 2048, 1);
+    SetTarget(gbuffer.sources[0], slots[1], textures[1], 1280, 720, 4);
+    SetTarget(bright.sources[0], slots[2], textures[2], 1280, 720, 4);
+    SetTarget(blur.sources[0], slots[3], textures[3], 1280, 720, 4);
+    SetTarget(composite.sources[0], slots[4], textures[4], 1280, 720, 4);
+
+    ExpectToBeTrue(graph.Compile());
+    ExpectShouldBe(5, (u64)graph.ExecutionOrder.Length());
+
+    // albedo живет в проходах 1-2, а blurred — в 3-4, поэтому они делят память.
+    // bright (2-3) пересекается с обоими и получает свою ячейку, как и карта теней другого типа.
+    ExpectShouldBe(3, (u64)graph.AliasSlots.Length());
+    ExpectShouldBe(gbuffer.sources[0].AliasSlot, blur.sources[0].AliasSlot);
+    ExpectShouldNotBe(gbuffer.sources[0].AliasSlot, bright.sources[0].AliasSlot);
+    ExpectShouldNotBe(shadow.sources[0].AliasSlot, gbuffer.sources[0].AliasSlot);
+    // Цель, которая уходит в задний буфер, не временная.
+    ExpectShouldBe(INVALID::ID, composite.sources[0].AliasSlot);
+
+    const u64 ColourSize = 1280 * 720 * 4;
+    ExpectShouldBe((u64)2048 * 2048 * 4 + ColourSize * 3, graph.TransientMemory);
+    ExpectShouldBe(ColourSize, graph.TransientMemory - graph.AliasedMemory);
+
+    for (auto& source : {&shadow.sources[0], &gbuffer.sources[0], &bright.sources[0], &blur.sources[0], &composite.sources[0]}) {
+        source->textures = nullptr;
+    }
+    graph.passes.Destroy();
+    return true;
+}
+
+u8 RendergraphShouldRejectCycles() {
+    Rendergraph graph("rendergraph_cycle_test", nullptr);
+    TestPass a("a"), b("b");
+    ExpectToBeTrue(graph.AddPass(a));
+    ExpectToBeTrue(graph.AddPass(b));
+
+    ExpectToBeTrue(graph.AddPassSource("a", "colourbuffer", RendergraphSourceType::RenderTargetColour, RendergraphSourceOrigin::Self));
+    ExpectToBeTrue(graph.AddPassSink("a", "colourbuffer"));
+    ExpectToBeTrue(graph.AddPassSource("b", "colourbuffer", RendergraphSourceType::RenderTargetColour, RendergraphSourceOrigin::Self));
+    ExpectToBeTrue(graph.AddPassSink("b", "colourbuffer"));
+    ExpectToBeTrue(graph.PassSetSinkLinkage("a", "colourbuffer", "b", "colourbuffer"));
+    ExpectToBeTrue(graph.PassSetSinkLinkage("b", "colourbuffer", "a", "colourbuffer"));
+    graph.BackbufferGlobalSink.BoundSource = &a.sources[0];
+
+    ExpectToBeFalse(graph.Compile());
+    ExpectShouldBe(0, (u64)graph.ExecutionOrder.Length());
+
+    graph.passes.Destroy();
+    return true;
+}
+
+void RendergraphRegisterTests() {
+    TestManagerRegisterTest(RendergraphShouldSortAndCullPasses, "Компиляция рендерграфа должна упорядочивать проходы по связям и отсекать проходы без потребителей");
+    TestManagerRegisterTest(RendergraphShouldAliasNonOverlappingTargets, "Временные цели с непересекающимися временами жизни должны делить память");
+    TestManagerRegisterTest(RendergraphShouldRejectCycles, "Компиляция рендерграфа с циклом должна завершаться ошибкой");
+}
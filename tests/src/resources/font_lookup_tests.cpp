@@ -0,0 +1,91 @@
+#include "font_lookup_tests.hpp"
+#include "../test_manager.hpp"
+#include "../expect.hpp"
+
+#include <resources/font_resource.hpp>
+
+constexpr u32 TEST_FONT_CJK_COUNT = 3000;                                  // Иероглифы CJK начиная с U+4E00.
+constexpr u32 TEST_FONT_GLYPH_COUNT = 95 + 96 + 64 + TEST_FONT_CJK_COUNT + 1; // ASCII, Latin-1, кириллица, CJK и неизвестный глиф.
+constexpr u32 TEST_FONT_KERNING_COUNT = 52 * 52 + 64 * 64;                 // Пары латинских и кириллических букв.
+
+static FontGlyph TestGlyphs[TEST_FONT_GLYPH_COUNT];
+static FontKerning TestKernings[TEST_FONT_KERNING_COUNT];
+
+static void TestAddGlyph(u32& count, i32 codepoint)
+{
+    auto& g = TestGlyphs[count++];
+    g.codepoint = codepoint;
+    g.xAdvance = 4 + codepoint % 13;
+}
+
+static i32 TestLatinLetter(u32 i) { return i < 26 ? 'A' + i : 'a' + i - 26; }
+
+/// @brief Синтетический шрифт со смешанным набором символов: глифы и пары кернинга без атласа.
+static void TestFontCreate(FontData& font)
+{
+    u32 count = 0;
+    // Неизвестный глиф идет в середине, как и у системных шрифтов, где он добавляется первым.
+    for (i32 c = 32; c < 127; ++c) TestAddGlyph(count, c);
+    TestAddGlyph(count, -1);
+    for (i32 c = 160; c < 256; ++c) TestAddGlyph(count, c);
+    for (i32 c = 0x410; c < 0x450; ++c) TestAddGlyph(count, c);
+    for (u32 i = 0; i < TEST_FONT_CJK_COUNT; ++i) TestAddGlyph(count, 0x4E00 + i);
+
+    u32 k = 0;
+    for (u32 i = 0; i < 52; ++i) {
+        for (u32 j = 0; j < 52; ++j) {
+            TestKernings[k++] = { TestLatinLetter(i), TestLatinLetter(j), (i16)((i * 7 + j) % 5 - 2) };
+        }
+    }
+    for (i32 i = 0; i < 64; ++i) {
+        for (i32 j = 0; j < 64; ++j) {
+            TestKernings[k++] = { 0x410 + i, 0x410 + j, (i16)((i + j * 3) % 7 - 3) };
+        }
+    }
+
+    font.GlyphCount = count;
+    font.glyphs = TestGlyphs;
+    font.KerningCount = k;
+    font.kernings = TestKernings;
+    font.BuildLookup();
+}
+
+u8 FontLookupShouldMatchLinearSearch() {
+    FontData font;
+    TestFontCreate(font);
+
+    // Каждый глиф находится по своей кодовой точке, включая неизвестный.
+    for (u32 i = 0; i < font.GlyphCount; ++i) {
+        const FontGlyph* g = font.GetGlyph(TestGlyphs[i].codepoint);
+        ExpectToBeTrue(g == &TestGlyphs[i]);
+    }
+    ExpectToBeTrue(font.GetGlyph(0) == nullptr);
+    ExpectToBeTrue(font.GetGlyph(200) != nullptr);
+    ExpectToBeTrue(font.GetGlyph(0x4E00 + TEST_FONT_CJK_COUNT) == nullptr);
+    ExpectToBeTrue(font.GetGlyph(0x1F600) == nullptr);
+
+    for (u32 i = 0; i < font.KerningCount; ++i) {
+        const auto& k = TestKernings[i];
+        const i32 amount = font.GetKerning(k.Codepoint0, k.Codepoint1);
+        const i32 expected = k.amount;
+        ExpectShouldBe(expected, amount);
+    }
+    // Пары из разных письменностей и пары в обратном порядке кернинга не имеют.
+    ExpectShouldBe(0, font.GetKerning('A', 0x410));
+    ExpectShouldBe(0, font.GetKerning(0x4E00, 0x4E01));
+    ExpectShouldBe(0, font.GetKerning(-1, 'A'));
+
+    font.DestroyLookup();
+    ExpectToBeTrue(font.GetGlyph('A') == nullptr);
+    ExpectToBeTrue(font.GetGlyph(0x4E00) == nullptr);
+    ExpectShouldBe(0, font.GetKerning('A', 'V'));
+
+    font.glyphs = nullptr;
+    font.kernings = nullptr;
+    return true;
+}
+
+void FontLookupRegisterTests()
+{
+    TestManagerRegisterTest(FontLookupShouldMatchLinearSearch, "Таблицы поиска шрифта должны находить те же глифы и кернинг, что и линейный поиск");
+}
@@ -0,0 +1,190 @@
+#include "glyph_atlas_tests.hpp"
+#include "../test_manager.hpp"
+#include "../expect.hpp"
+
+#include <core/clock.h>
+#include <resources/glyph_atlas.hpp>
+
+constexpr u32 TEST_ATLAS_SIZE = 1024;           // Сторона текстуры атласа, как у системных шрифтов.
+constexpr u32 TEST_VISIBLE_COUNT = 400;         // Видимых символов: последние набранные, как в окне чата.
+constexpr u32 TEST_FRAME_COUNT = 4000;          // Кадров набора текста.
+constexpr u32 TEST_CJK_RANGE = 20000;           // Иероглифы CJK начиная с U+4E00.
+
+static i32 TestVisible[TEST_VISIBLE_COUNT];
+static i32 TestRequests[TEST_VISIBLE_COUNT];
+static u8 TestOccupancy[TEST_ATLAS_SIZE * TEST_ATLAS_SIZE];
+
+static u32 TestRandom(u32& seed)
+{
+    seed = seed * 1664525 + 1013904223;
+    return seed >> 8;
+}
+
+/// @brief Глиф без растеризации: размеры и метрики как у иероглифов кегля 20–24.
+static FontGlyph TestGlyph(i32 codepoint, u32& seed)
+{
+    FontGlyph g{};
+    g.codepoint = codepoint;
+    g.width = 10 + TestRandom(seed) % 15;
+    g.height = 10 + TestRandom(seed) % 15;
+    g.xAdvance = g.width + 1;
+    return g;
+}
+
+/// @brief Глифы не перекрываются с учетом пустой полосы, лежат внутри своей страницы и находятся по своей кодовой точке.
+static bool TestAtlasConsistent(const GlyphAtlas& atlas, const FontData& font)
+{
+    MemorySystem::ZeroMem(TestOccupancy, sizeof(TestOccupancy));
+    const u32 PagesPerRow = TEST_ATLAS_SIZE / atlas.PageSize;
+    const FontGlyph* glyphs = atlas.GetGlyphs();
+    for (u32 i = 0; i < atlas.GetStoreLength(); ++i) {
+        const auto& g = glyphs[i];
+        if (g.codepoint == FONT_GLYPH_FREE) {
+            continue;
+        }
+        if (font.GetGlyph(g.codepoint) != &g) {
+            MERROR("--> Глиф U+%04X не находится в таблицах шрифта.", g.codepoint);
+            return false;
+        }
+        const u32 PageX = (g.PageID % PagesPerRow) * atlas.PageSize;
+        const u32 PageY = (g.PageID / PagesPerRow) * atlas.PageSize;
+        const u32 width = g.width + GLYPH_ATLAS_PADDING;
+        const u32 height = g.height + GLYPH_ATLAS_PADDING;
+        if (g.x < PageX || g.y < PageY || g.x + width > PageX + atlas.PageSize || g.y + height > PageY + atlas.PageSize) {
+            MERROR("--> Глиф U+%04X выходит за страницу %u.", g.codepoint, g.PageID);
+            return false;
+        }
+        for (u32 y = g.y; y < g.y + height; ++y) {
+            for (u32 x = g.x; x < g.x + width; ++x) {
+                if (TestOccupancy[y * TEST_ATLAS_SIZE + x]++) {
+                    MERROR("--> Глиф U+%04X перекрывает другой глиф в (%u, %u).", g.codepoint, x, y);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+u8 GlyphAtlasRandomCjkTypingStress() {
+    FontData font;
+    GlyphAtlas atlas;
+    ExpectToBeTrue(atlas.Create(TEST_ATLAS_SIZE, TEST_ATLAS_SIZE, 26));
+
+    // Неизвестный глиф и ASCII закрепляются, как при создании варианта системного шрифта.
+    u32 seed = 4242;
+    atlas.Add(font, TestGlyph(-1, seed), 0, 0, true);
+    for (i32 c = 32; c < 127; ++c) {
+        atlas.Add(font, TestGlyph(c, seed), 0, 0, true);
+    }
+
+    u32 VisibleCount = 0, VisibleNext = 0, RequestCount = 0;
+    u32 FailedCount = 0, AddedCount = 0, RefetchCount = 0;
+    const u32 GenerationStart = font.generation;
+    f64 TotalTime = 0.0, MaxTime = 0.0;
+    Clock clock;
+    for (u64 frame = 1; frame <= TEST_FRAME_COUNT; ++frame) {
+        // Обработчики заданий: глифы, запрошенные в прошлом кадре, размещаются в атласе.
+        clock.Start();
+        for (u32 i = 0; i < RequestCount; ++i) {
+            if (font.GetGlyph(TestRequests[i])) {
+                continue;
+            }
+            AddedCount++;
+            if (!atlas.Add(font, TestGlyph(TestRequests[i], seed), frame, frame - 1)) {
+                FailedCount++;
+            }
+        }
+        clock.Update();
+        TotalTime += clock.elapsed;
+        MaxTime = clock.elapsed > MaxTime ? clock.elapsed : MaxTime;
+
+        // Глифы текущего кадра только что размещены и не освобождаются, пока их страницы не устареют.
+        for (u32 i = 0; i < RequestCount; ++i) {
+            ExpectToBeTrue((font.GetGlyph(TestRequests[i]) != nullptr));
+        }
+
+        // Набирается от одного до трех иероглифов за кадр; старые уходят за край окна.
+        const u32 typed = 1 + TestRandom(seed) % 3;
+        for (u32 i = 0; i < typed; ++i) {
+            TestVisible[VisibleNext] = 0x4E00 + TestRandom(seed) % TEST_CJK_RANGE;
+            VisibleNext = (VisibleNext + 1) % TEST_VISIBLE_COUNT;
+            VisibleCount = VisibleCount < TEST_VISIBLE_COUNT ? VisibleCount + 1 : VisibleCount;
+        }
+
+        // Отрисовка: видимые глифы отмечают свои страницы, недостающие запрашиваются, как в FontSystem::VerifyAtlas.
+        u32 PageMask = 0;
+        RequestCount = 0;
+        for (u32 i = 0; i < VisibleCount; ++i) {
+            if (const FontGlyph* g = font.GetGlyph(TestVisible[i])) {
+                PageMask |= 1u << g->PageID;
+                continue;
+            }
+            const u32 age = (VisibleNext + TEST_VISIBLE_COUNT - 1 - i) % TEST_VISIBLE_COUNT;
+            RefetchCount += age >= typed ? 1 : 0;
+            TestRequests[RequestCount++] = TestVisible[i];
+        }
+        atlas.Touch(PageMask, frame);
+
+        if (frame % 500 == 0) {
+            ExpectToBeTrue(TestAtlasConsistent(atlas, font));
+        }
+    }
+
+    MINFO("Набор %u кадров CJK: размещено %u глифов, освобождено страниц %u (из них недавних %u), повторных запросов %u, записей глифов %u; "
+          "размещение за кадр в среднем %.4f мс, максимум %.4f мс.",
+        TEST_FRAME_COUNT, AddedCount, atlas.EvictionCount, atlas.RecentEvictionCount, RefetchCount, atlas.GetStoreLength(),
+        TotalTime * 1000.0 / TEST_FRAME_COUNT, MaxTime * 1000.0);
+
+    ExpectShouldBe((u64)0, (u64)FailedCount);
+    ExpectToBeTrue((atlas.EvictionCount > 0));
+    // Таблицы только пополнялись и очищались по одному глифу, ни разу не перестраиваясь целиком.
+    ExpectToBeTrue((font.generation - GenerationStart >= AddedCount));
+    // Повторно запрашивается не больше процента видимых символов: освобождаются в основном невидимые страницы.
+    ExpectToBeTrue((RefetchCount * 100 < TEST_VISIBLE_COUNT * TEST_FRAME_COUNT / 100));
+    // Закрепленные глифы не освобождаются, а записи освобожденных глифов переиспользуются.
+    ExpectToBeTrue((font.GetGlyph(-1) != nullptr));
+    for (i32 c = 32; c < 127; ++c) {
+        ExpectToBeTrue((font.GetGlyph(c) != nullptr));
+    }
+    ExpectToBeTrue((atlas.GetStoreLength() < AddedCount));
+
+    atlas.Destroy();
+    font.DestroyLookup();
+    font.glyphs = nullptr;
+    return true;
+}
+
+u8 GlyphAtlasRemoveShouldKeepLookupChains() {
+    // Кодовые точки подобраны без учета хеша, поэтому цепочки пробирования перемежаются; после удаления каждой второй
+    // остальные должны находиться, а удаленные — нет.
+    FontData font;
+    GlyphAtlas atlas;
+    ExpectToBeTrue(atlas.Create(TEST_ATLAS_SIZE, TEST_ATLAS_SIZE, 26));
+    u32 seed = 7;
+    for (i32 c = 0; c < 1000; ++c) {
+        ExpectToBeTrue((atlas.Add(font, TestGlyph(0x4E00 + c, seed), 1, 0) != nullptr));
+    }
+    for (i32 c = 0; c < 1000; c += 2) {
+        font.RemoveGlyph(0x4E00 + c);
+    }
+    for (i32 c = 0; c < 1000; ++c) {
+        const FontGlyph* g = font.GetGlyph(0x4E00 + c);
+        ExpectToBeTrue(((g != nullptr) == (c % 2 == 1)));
+        if (g) {
+            ExpectShouldBe((i64)(0x4E00 + c), (i64)g->codepoint);
+        }
+    }
+    ExpectShouldBe((u64)500, (u64)font.GlyphSlotUsed);
+
+    atlas.Destroy();
+    font.DestroyLookup();
+    font.glyphs = nullptr;
+    return true;
+}
+
+void GlyphAtlasRegisterTests()
+{
+    TestManagerRegisterTest(GlyphAtlasRandomCjkTypingStress, "Набор случайных иероглифов должен размещать глифы в атласе без перекрытий и полной перестройки, освобождая старые страницы");
+    TestManagerRegisterTest(GlyphAtlasRemoveShouldKeepLookupChains, "Удаление глифов из таблицы поиска не должно обрывать цепочки пробирования");
+}
@@ -0,0 +1,126 @@
+#include "msdf_tests.hpp"
+#include "../test_manager.hpp"
+#include "../expect.hpp"
+
+#include <resources/msdf.hpp>
+
+constexpr u32 TEST_MSDF_SIZE = 24;              // Сторона поля в пикселях.
+constexpr f32 TEST_MSDF_LEFT = -4.F;            // Поле охватывает квадрат 0..16 с полосой 4 пикселя.
+constexpr f32 TEST_MSDF_TOP = 20.F;
+
+static u8 TestField[TEST_MSDF_SIZE * TEST_MSDF_SIZE * 4];
+
+/// @brief Медиана каналов поля с билинейной фильтрацией, как при выборке из текстуры в шейдере.
+/// @return значение от 0 до 1; больше 0.5 — внутри контура.
+static f32 TestSample(f32 x, f32 y)
+{
+    const f32 u = x - TEST_MSDF_LEFT - 0.5F;
+    const f32 v = TEST_MSDF_TOP - y - 0.5F;
+    const u32 i = (u32)u, j = (u32)v;
+    const f32 fu = u - i, fv = v - j;
+    f32 channel[3];
+    for (u32 c = 0; c < 3; ++c) {
+        const auto texel = [&](u32 x, u32 y) { return TestField[(y * TEST_MSDF_SIZE + x) * 4 + c] / 255.F; };
+        const f32 top = texel(i, j) * (1.F - fu) + texel(i + 1, j) * fu;
+        const f32 bottom = texel(i, j + 1) * (1.F - fu) + texel(i + 1, j + 1) * fu;
+        channel[c] = top * (1.F - fv) + bottom * fv;
+    }
+    return MMAX(MMIN(channel[0], channel[1]), MMIN(MMAX(channel[0], channel[1]), channel[2]));
+}
+
+static void TestSquare(MsdfShape& shape, f32 x0, f32 y0, f32 x1, f32 y1, bool clockwise)
+{
+    shape.MoveTo(x0, y0);
+    if (clockwise) {
+        shape.LineTo(x0, y1);
+        shape.LineTo(x1, y1);
+        shape.LineTo(x1, y0);
+    } else {
+        shape.LineTo(x1, y0);
+        shape.LineTo(x1, y1);
+        shape.LineTo(x0, y1);
+    }
+    shape.Close();
+}
+
+u8 MsdfSquareShouldKeepSharpCorners() {
+    MsdfShape shape;
+    TestSquare(shape, 0.F, 0.F, 16.F, 16.F, false);
+    shape.ColourEdges();
+    shape.Generate(TestField, TEST_MSDF_SIZE, TEST_MSDF_SIZE, TEST_MSDF_SIZE, FONT_MSDF_RANGE, TEST_MSDF_LEFT, TEST_MSDF_TOP);
+
+    // Глубоко внутри и далеко снаружи поле насыщается.
+    ExpectToBeTrue((TestSample(8.F, 8.F) > 0.99F));
+    ExpectToBeTrue((TestSample(-3.F, 8.F) < 0.01F));
+    // Край проходит через 0.5: на расстоянии d от него значение 0.5 ± d / range.
+    ExpectToBeTrue((Math::abs(TestSample(15.F, 8.F) - 0.75F) < 0.02F));
+    ExpectToBeTrue((Math::abs(TestSample(17.F, 8.F) - 0.25F) < 0.02F));
+
+    // Угол остается острым и после фильтрации: точки у вершины по обе стороны диагонали разделяются.
+    // Однокомпонентное поле скругляет угол с радиусом порядка пикселя, и точка (15.8, 15.8) оказалась бы снаружи.
+    ExpectToBeTrue((TestSample(15.8F, 15.8F) > 0.5F));
+    ExpectToBeTrue((TestSample(16.2F, 16.2F) < 0.5F));
+    ExpectToBeTrue((TestSample(16.2F, 15.5F) < 0.5F));
+    ExpectToBeTrue((TestSample(15.5F, 16.2F) < 0.5F));
+
+    // У вершины каналы различаются, иначе углы терялись бы.
+    const u8* corner = TestField + ((4 * TEST_MSDF_SIZE) + 20) * 4;
+    ExpectToBeTrue((corner[0] != corner[1] || corner[1] != corner[2]));
+
+    shape.Destroy();
+    return true;
+}
+
+u8 MsdfShouldIgnoreContourOrientation() {
+    static u8 CounterClockwise[sizeof(TestField)];
+    MsdfShape shape;
+    TestSquare(shape, 0.F, 0.F, 16.F, 16.F, false);
+    shape.ColourEdges();
+    shape.Generate(CounterClockwise, TEST_MSDF_SIZE, TEST_MSDF_SIZE, TEST_MSDF_SIZE, FONT_MSDF_RANGE, TEST_MSDF_LEFT, TEST_MSDF_TOP);
+
+    // Контуры TrueType и CFF обходятся в разные стороны; поле от этого не зависит.
+    shape.Clear();
+    TestSquare(shape, 0.F, 0.F, 16.F, 16.F, true);
+    shape.ColourEdges();
+    shape.Generate(TestField, TEST_MSDF_SIZE, TEST_MSDF_SIZE, TEST_MSDF_SIZE, FONT_MSDF_RANGE, TEST_MSDF_LEFT, TEST_MSDF_TOP);
+    u32 differences = 0;
+    for (u32 i = 0; i < TEST_MSDF_SIZE * TEST_MSDF_SIZE; ++i) {
+        const i32 a = MMAX(MMIN(CounterClockwise[i * 4], CounterClockwise[i * 4 + 1]), MMIN(MMAX(CounterClockwise[i * 4], CounterClockwise[i * 4 + 1]), CounterClockwise[i * 4 + 2]));
+        const i32 b = MMAX(MMIN(TestField[i * 4], TestField[i * 4 + 1]), MMIN(MMAX(TestField[i * 4], TestField[i * 4 + 1]), TestField[i * 4 + 2]));
+        differences += (a - b > 1 || b - a > 1) ? 1 : 0;
+    }
+    ExpectShouldBe((u64)0, (u64)differences);
+
+    // Отверстие, обойденное в обратную сторону, остается снаружи.
+    shape.Clear();
+    TestSquare(shape, 0.F, 0.F, 16.F, 16.F, false);
+    TestSquare(shape, 5.F, 5.F, 11.F, 11.F, true);
+    shape.ColourEdges();
+    shape.Generate(TestField, TEST_MSDF_SIZE, TEST_MSDF_SIZE, TEST_MSDF_SIZE, FONT_MSDF_RANGE, TEST_MSDF_LEFT, TEST_MSDF_TOP);
+    ExpectShouldBe((u64)2, (u64)shape.GetContourCount());
+    ExpectToBeTrue((TestSample(8.F, 8.F) < 0.5F));
+    ExpectToBeTrue((TestSample(2.5F, 8.F) > 0.5F));
+
+    // Гладкий контур без углов: все каналы совпадают.
+    shape.Clear();
+    shape.MoveTo(16.F, 8.F);
+    shape.QuadTo(16.F, 16.F, 8.F, 16.F);
+    shape.QuadTo(0.F, 16.F, 0.F, 8.F);
+    shape.QuadTo(0.F, 0.F, 8.F, 0.F);
+    shape.QuadTo(16.F, 0.F, 16.F, 8.F);
+    shape.ColourEdges();
+    shape.Generate(TestField, TEST_MSDF_SIZE, TEST_MSDF_SIZE, TEST_MSDF_SIZE, FONT_MSDF_RANGE, TEST_MSDF_LEFT, TEST_MSDF_TOP);
+    for (u32 i = 0; i < TEST_MSDF_SIZE * TEST_MSDF_SIZE; ++i) {
+        ExpectToBeTrue((TestField[i * 4] == TestField[i * 4 + 1] && TestField[i * 4 + 1] == TestField[i * 4 + 2]));
+    }
+    ExpectToBeTrue((TestSample(8.F, 8.F) > 0.99F));
+
+    shape.Destroy();
+    return true;
+}
+
+void MsdfRegisterTests()
+{
+    TestManagerRegisterTest(MsdfSquareShouldKeepSharpCorners, "Поле MSDF квадрата должно сохранять острые углы после билинейной фильтрации");
+    TestManagerRegisterTest(MsdfShouldIgnoreContourOrientation, "Поле MSDF не должно зависеть от направления обхода контуров и должно учитывать отверстия");
+}
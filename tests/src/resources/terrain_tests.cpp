@@ -0,0 +1,165 @@
+#include "terrain_tests.hpp"
+#include "../test_manager.hpp"
+#include "../expect.hpp"
+
+#include <core/clock.h>
+#include <math/matrix4d.h>
+#include <resources/terrain.h>
+
+constexpr u32 TEST_TERRAIN_SIZE = 4096;     // Выборок карты высот по каждой оси.
+constexpr f32 TEST_TERRAIN_HEIGHT = 200.F;
+
+/// @brief Холмистая карта высот в диапазоне [0, 1].
+static void TestHeightmap(Terrain::Config& config, u32 size)
+{
+    config.name = "test_terrain";
+    config.TileCountX = config.TileCountZ = size;
+    config.TileScaleX = config.TileScaleZ = 1.F;
+    config.ScaleY = TEST_TERRAIN_HEIGHT;
+    config.xform = Transform();
+    config.MaterialCount = 0;
+    config.MaterialNames = nullptr;
+    config.VertexDatas.Resize(size * size);
+    for (u32 z = 0; z < size; ++z) {
+        for (u32 x = 0; x < size; ++x) {
+            config.VertexDatas[z * size + x].height = 0.5F + 0.3F * Math::sin(x * 0.011F) * Math::cos(z * 0.007F) + 0.1F * Math::sin((x + z) * 0.05F);
+        }
+    }
+}
+
+/// @brief Пирамида камеры с полем зрения 90°, смотрящей вдоль -Z, как в тестах усеченной пирамиды.
+static Frustum TestFrustum(const FVec3& CameraPosition, f32 far)
+{
+    auto view = Matrix4D::MakeTranslation(FVec3(-CameraPosition.x, -CameraPosition.y, -CameraPosition.z));
+    auto projection = Matrix4D::MakeFrustumProjection(Math::DegToRad(90.F), 1.F, 0.1F, far);
+    Frustum f;
+    f.FromMatrix(view * projection);
+    return f;
+}
+
+/// @brief Выбирает чанки, пока все недостающие не будут "загружены"; загрузка в графический процессор не нужна для выбора.
+static u32 TestSelectUntilStable(Terrain& terrain, Frustum& f, const FVec3& CameraPosition, DArray<u32>& selected, u32& OutPasses)
+{
+    DArray<u32> missing;
+    u32 triangles = 0;
+    for (OutPasses = 1; OutPasses <= 32; ++OutPasses) {
+        selected.Clear();
+        missing.Clear();
+        triangles = terrain.SelectChunks(f, CameraPosition, OutPasses, selected, missing);
+        if (!missing.Length()) {
+            break;
+        }
+        for (u32 i = 0; i < missing.Length(); ++i) {
+            terrain.tree->chunks[missing[i]].state = TerrainChunkState::Resident;
+            terrain.tree->ResidentCount++;
+        }
+    }
+    return triangles;
+}
+
+/// @brief Выбранный чанк не должен быть потомком другого выбранного чанка.
+static bool TestHasSelectedDescendant(const TerrainChunkTree& tree, u32 index, const bool* selected)
+{
+    for (u32 c = 0; c < 4; ++c) {
+        const u32 child = tree.chunks[index].children[c];
+        if (child != INVALID::ID && (selected[child] || TestHasSelectedDescendant(tree, child, selected))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+u8 TerrainChunkedLodShouldDrawFewerTriangles() {
+    Terrain::Config config{};
+    TestHeightmap(config, TEST_TERRAIN_SIZE);
+
+    Clock clock;
+    clock.Start();
+    Terrain terrain;
+    ExpectToBeTrue(terrain.Create(config));
+    ExpectToBeTrue(terrain.Initialize());
+    clock.Update();
+    const f64 InitializeMs = clock.elapsed * 1000.0;
+
+    auto& tree = *terrain.tree;
+    ExpectShouldBe((u64)7, (u64)tree.LevelCount);
+    ExpectFloatToBe((TEST_TERRAIN_SIZE - 1) * 1.F, terrain.extents.max.x);
+
+    // Корень загружается в Terrain::Load; здесь он отмечается вручную.
+    tree.chunks[0].state = TerrainChunkState::Resident;
+    tree.ResidentCount = 1;
+
+    const FVec3 CameraPosition(2048.F, 250.F, 4000.F);
+    auto f = TestFrustum(CameraPosition, 6000.F);
+    DArray<u32> selected;
+    u32 passes = 0;
+    const u32 triangles = TestSelectUntilStable(terrain, f, CameraPosition, selected, passes);
+
+    bool* IsSelected = reinterpret_cast<bool*>(MemorySystem::Allocate(tree.ChunkCount, Memory::Array, true));
+    for (u32 i = 0; i < selected.Length(); ++i) {
+        IsSelected[selected[i]] = true;
+    }
+    for (u32 i = 0; i < selected.Length(); ++i) {
+        ExpectToBeFalse(TestHasSelectedDescendant(tree, selected[i], IsSelected));
+    }
+    MemorySystem::Free(IsSelected, tree.ChunkCount, Memory::Array);
+
+    // Построение выбранных чанков, как в потоках заданий.
+    u32 MaxVertexCount = 0, MaxIndexCount = 0;
+    for (u32 i = 0; i < tree.ChunkCount; ++i) {
+        MaxVertexCount = MMAX(MaxVertexCount, Terrain::ChunkVertexCount(tree.chunks[i]));
+        MaxIndexCount = MMAX(MaxIndexCount, Terrain::ChunkIndexCount(tree.chunks[i]));
+    }
+    auto vertices = reinterpret_cast<TerrainVertex*>(MemorySystem::Allocate(sizeof(TerrainVertex) * MaxVertexCount, Memory::Array));
+    auto indices = reinterpret_cast<u32*>(MemorySystem::Allocate(sizeof(u32) * MaxIndexCount, Memory::Array));
+    f64 BuildMs = 0.0;
+    for (u32 i = 0; i < selected.Length(); ++i) {
+        const auto& chunk = tree.chunks[selected[i]];
+        clock.Start();
+        Terrain::BuildChunk(tree, selected[i], vertices, indices);
+        clock.Update();
+        BuildMs += clock.elapsed * 1000.0;
+
+        // Угловые вершины лежат точно на выборках карты высот, поэтому совпадают у соседних чанков.
+        const u32 step = 1u << chunk.level;
+        const u32 LastX = MMIN(chunk.x + (chunk.CountX - 1) * step, TEST_TERRAIN_SIZE - 1);
+        const auto& corner = vertices[chunk.CountX - 1];
+        ExpectFloatToBe(LastX * 1.F, corner.position.x);
+        ExpectFloatToBe(tree.heights[chunk.z * TEST_TERRAIN_SIZE + LastX].height * TEST_TERRAIN_HEIGHT, corner.position.y);
+        ExpectFloatToBe(1.F, Math::sqrt(corner.normal.x * corner.normal.x + corner.normal.y * corner.normal.y + corner.normal.z * corner.normal.z));
+
+        // Поверхность обращена вверх, юбка — наружу от центра чанка.
+        const FVec3 center = (chunk.extents.min + chunk.extents.max) * 0.5F;
+        const u32 GridIndexCount = (chunk.CountX - 1) * (chunk.CountZ - 1) * 6;
+        for (u32 j = 0; j < Terrain::ChunkIndexCount(chunk); j += 3) {
+            const auto& a = vertices[indices[j]].position;
+            const auto& b = vertices[indices[j + 1]].position;
+            const auto& c = vertices[indices[j + 2]].position;
+            const FVec3 normal = Cross(b - a, c - a);
+            if (j < GridIndexCount) {
+                ExpectToBeTrue((normal.y > 0.F));
+            } else {
+                const FVec3 outward = (a + b + c) * (1.F / 3.F) - center;
+                ExpectToBeTrue((normal.x * outward.x + normal.z * outward.z > 0.F));
+            }
+        }
+    }
+    MemorySystem::Free(vertices, sizeof(TerrainVertex) * MaxVertexCount, Memory::Array);
+    MemorySystem::Free(indices, sizeof(u32) * MaxIndexCount, Memory::Array);
+
+    const u64 MonolithicTriangles = (u64)(TEST_TERRAIN_SIZE - 1) * (TEST_TERRAIN_SIZE - 1) * 2;
+    MINFO("Ландшафт %ux%u: создание и дерево %.2f мс; выбрано %u чанков из %u за %u проходов, треугольников %u вместо %llu; "
+          "построение выбранных чанков %.2f мс.",
+        TEST_TERRAIN_SIZE, TEST_TERRAIN_SIZE, InitializeMs, selected.Length(), tree.ChunkCount, passes, triangles, MonolithicTriangles, BuildMs);
+
+    ExpectToBeTrue((passes <= tree.LevelCount));
+    ExpectToBeTrue(((u64)triangles * 20 < MonolithicTriangles));
+
+    terrain.Destroy();
+    return true;
+}
+
+void TerrainRegisterTests()
+{
+    TestManagerRegisterTest(TerrainChunkedLodShouldDrawFewerTriangles, "Ландшафт из чанков с уровнями детализации должен рисовать в разы меньше треугольников без перекрытия уровней");
+}
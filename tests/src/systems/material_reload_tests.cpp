@@ -0,0 +1,199 @@
+#include "material_reload_tests.hpp"
+#include "../test_manager.hpp"
+#include "../expect.hpp"
+
+#include <application_types.h>
+#include <core/event.h>
+#include <platform/filesystem.hpp>
+#include <platform/platform.hpp>
+#include <systems/resource_system.h>
+#include <systems/material_system.h>
+
+#include <filesystem>
+
+using PFN_PluginCreate = RendererPlugin*(*)();
+using PFN_PluginDestroy = void(*)(RendererPlugin*);
+
+constexpr f64 MATERIAL_RELOAD_TIMEOUT = 5.0;   // Время ожидания перезагрузки после записи файла в секундах.
+
+/// @brief Состояние теста. Функция обновления игры оборачивается, поэтому исходный указатель хранится здесь.
+static struct MaterialReloadTest {
+    bool (*GameUpdate)(Application& app, const FrameData& rFrameData);
+
+    char path[512];         // Файл материала в каталоге ресурсов движка.
+    f64 WriteTime;          // Время перезаписи файла.
+    Material* material;
+    bool written;
+    bool reloaded;
+
+    // Состояние материала до перезагрузки.
+    u32 id;
+    u32 generation;
+    void* properties;
+    Texture* texture;
+
+    // Состояние материала после перезагрузки; снимается до завершения работы движка.
+    u32 ReloadedId;
+    u32 ReloadedGeneration;
+    void* ReloadedProperties;
+    Texture* ReloadedTexture;
+    Material::PhongProperties phong;
+} test;
+
+/// @brief Записывает файл материала с заданными свойствами.
+static bool WriteMaterialFile(const char* DiffuseColour, const char* specular)
+{
+    char contents[512]{};
+    MString::Format(contents,
+        "version=1\n"
+        "name=reload_test\n"
+        "diffuse_colour=%s\n"
+        "specular=%s\n"
+        "shader=Shader.Builtin.Material\n",
+        DiffuseColour, specular);
+
+    FileHandle f;
+    if (!Filesystem::Open(test.path, FileModes::Write, false, f)) {
+        return false;
+    }
+    u64 written = 0;
+    const bool result = Filesystem::Write(f, MString::Length(contents), contents, written);
+    Filesystem::Close(f);
+    return result;
+}
+
+static void Quit()
+{
+    EventContext context = {};
+    EventSystem::Fire(EventSystem::ApplicationQuit, nullptr, context);
+}
+
+/// @brief Получает материал через систему материалов, перезаписывает его файл и ждет, пока система материалов
+/// сама перезагрузит материал по уведомлению о записи файла.
+static bool MaterialReloadUpdate(Application& app, const FrameData& rFrameData)
+{
+    if (!test.GameUpdate(app, rFrameData)) {
+        return false;
+    }
+
+    if (!test.material) {
+        MString::Format(test.path, "%s/materials/reload_test.mmt", ResourceSystem::BasePath());
+        if (!WriteMaterialFile("0.5 0.5 0.5 1.0", "16.0")) {
+            Quit();
+            return true;
+        }
+        test.written = true;
+
+        test.material = MaterialSystem::Acquire("reload_test");
+        if (!test.material) {
+            Quit();
+            return true;
+        }
+        test.id = test.material->id;
+        test.generation = test.material->generation;
+        test.properties = test.material->properties;
+        test.texture = test.material->maps[0].texture;
+
+        // Файл материала перезаписывается с другими свойствами; изменение доходит до материала через наблюдение за файлом.
+        if (!WriteMaterialFile("1.0 0.25 0.0 1.0", "64.0")) {
+            Quit();
+        }
+        test.WriteTime = rFrameData.TotalTime;
+        return true;
+    }
+
+    test.reloaded = test.material->generation != test.generation;
+    if (!test.reloaded && rFrameData.TotalTime - test.WriteTime < MATERIAL_RELOAD_TIMEOUT) {
+        return true;
+    }
+
+    test.ReloadedId = test.material->id;
+    test.ReloadedGeneration = test.material->generation;
+    test.ReloadedProperties = test.material->properties;
+    test.ReloadedTexture = test.material->maps[0].texture;
+    test.phong = *reinterpret_cast<Material::PhongProperties*>(test.material->properties);
+
+    MaterialSystem::Release(test.material->name);
+    Quit();
+    return true;
+}
+
+/// @brief Загружает библиотеку тестового стенда и заменяет ее функцию обновления шагами теста.
+static bool LoadGameLib(Application& app)
+{
+    if (!PlatformDynamicLibraryLoad("testbed_lib", app.GameLibrary)) {
+        return false;
+    }
+
+    const char* names[] = {
+        "ApplicationBoot", "ApplicationInitialize", "ApplicationUpdate", "ApplicationPrepareRenderPacket", "ApplicationRender",
+        "ApplicationOnResize", "ApplicationShutdown"
+    };
+    for (auto name : names) {
+        if (!PlatformDynamicLibraryLoadFunction(name, app.GameLibrary)) {
+            return false;
+        }
+    }
+
+    app.Boot = (bool(*)(Application&))app.GameLibrary.functions[0].pfn;
+    app.Initialize = (bool(*)(Application&))app.GameLibrary.functions[1].pfn;
+    test.GameUpdate = (bool(*)(Application&, const FrameData&))app.GameLibrary.functions[2].pfn;
+    app.PrepareRenderPacket = (bool(*)(Application*, RenderPacket&, FrameData&))app.GameLibrary.functions[3].pfn;
+    app.Render = (bool(*)(Application&, RenderPacket&, FrameData&))app.GameLibrary.functions[4].pfn;
+    app.OnResize = (void(*)(Application&, u32, u32))app.GameLibrary.functions[5].pfn;
+    app.Shutdown = (void(*)(Application&))app.GameLibrary.functions[6].pfn;
+    app.Update = MaterialReloadUpdate;
+
+    return true;
+}
+
+u8 MaterialReloadShouldUpdatePropertiesInPlace() {
+#ifndef _DEBUG
+    // Наблюдение за файлами ресурсов включено только в отладочной сборке.
+    return BYPASS;
+#endif
+
+    // Движок запускается целиком с рендерером без окна, чтобы материал прошел через систему материалов и ее обработчик
+    // изменения файла.
+    Application app;
+    app.AppConfig.StartWidth = 1280;
+    app.AppConfig.StartHeight = 720;
+    app.AppConfig.name = "Moon Engine Material Reload Test";
+    app.AppConfig.FrameAllocatorSize = MEBIBYTES(64);
+
+    ExpectToBeTrue(LoadGameLib(app));
+    ExpectToBeTrue(PlatformDynamicLibraryLoad("headless_renderer", app.RendererLibrary));
+    ExpectToBeTrue(PlatformDynamicLibraryLoadFunction("PluginCreate", app.RendererLibrary));
+    ExpectToBeTrue(PlatformDynamicLibraryLoadFunction("PluginDestroy", app.RendererLibrary));
+    app.AppConfig.plugin = reinterpret_cast<PFN_PluginCreate>(app.RendererLibrary.functions[0].pfn)();
+
+    ExpectToBeTrue(Engine::Create(app));
+    const bool ran = app.engine->Run();
+
+    // Движок остановлен, поэтому ресурсы теста освобождаются до проверок.
+    reinterpret_cast<PFN_PluginDestroy>(app.RendererLibrary.functions[1].pfn)(app.AppConfig.plugin);
+    PlatformDynamicLibraryUnload(app.RendererLibrary);
+    PlatformDynamicLibraryUnload(app.GameLibrary);
+    if (test.written) {
+        std::filesystem::remove(test.path);
+    }
+
+    ExpectToBeTrue(ran);
+    ExpectToBeTrue(test.material != nullptr);
+    ExpectToBeTrue(test.reloaded);
+
+    // Материал обновлен на месте: тот же слот, та же структура свойств и те же текстуры.
+    ExpectShouldBe((i64)test.id, (i64)test.ReloadedId);
+    ExpectShouldNotBe(INVALID::ID, test.ReloadedGeneration);
+    ExpectToBeTrue(test.ReloadedProperties == test.properties);
+    ExpectToBeTrue(test.ReloadedTexture == test.texture);
+    ExpectFloatToBe(1.F, test.phong.DiffuseColour.r);
+    ExpectFloatToBe(0.25F, test.phong.DiffuseColour.g);
+    ExpectFloatToBe(0.F, test.phong.DiffuseColour.b);
+    ExpectFloatToBe(64.F, test.phong.specular);
+    return true;
+}
+
+void MaterialReloadRegisterTests() {
+    TestManagerRegisterTest(MaterialReloadShouldUpdatePropertiesInPlace, "Изменение наблюдаемого файла .mmt должно перезагружать материал системы материалов и обновлять свойства на месте");
+}
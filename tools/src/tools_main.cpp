@@ -1,12 +1,17 @@
 // #define _CRT_SECURE_NO_WARNINGS
 #include <core/logger.hpp>
 #include <containers/mstring.hpp>
+#include <containers/darray.h>
+#include <platform/asset_pack.hpp>
 
 // Для выполнения команд оболочки.
 #include <stdlib.h>
+// Для обхода каталога ресурсов.
+#include <filesystem>
 
 void PrintHelp();
 i32 ProcessShaders(i32 argc, char const *argv[]);
+i32 ProcessPack(i32 argc, char const *argv[]);
 
 i32 main(i32 argc, char const *argv[])
 {
@@ -20,6 +25,8 @@ i32 main(i32 argc, char const *argv[])
     // Второй аргумент сообщает нам, в какой режим перейти.
     if (MString::Equali(argv[1], "buildshaders") || MString::Equali(argv[1], "bshaders")) {
         return ProcessShaders(argc, argv);
+    } else if (MString::Equali(argv[1], "buildpack") || MString::Equali(argv[1], "bpack")) {
+        return ProcessPack(argc, argv);
     } else {
         MERROR("Нераспознанный аргумент '%s'.", argv[1]);
         PrintHelp();
@@ -85,6 +92,52 @@ i32 ProcessShaders(i32 argc, char const *argv[])
     return 0;
 }
 
+i32 ProcessPack(i32 argc, char const *argv[])
+{
+    if (argc < 4) {
+        MERROR("Для режима сборки пакета требуются путь к каталогу ресурсов и путь к выходному файлу.");
+        return -3;
+    }
+
+    const char* RootPath = argv[2];
+    const char* OutPath = argv[3];
+    const bool compress = argc > 4 && MString::Equali(argv[4], "-lz4");
+
+    std::error_code error;
+    const std::filesystem::path root(RootPath);
+    DArray<MString> names;
+    for (auto it = std::filesystem::recursive_directory_iterator(root, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+        if (!it->is_regular_file()) {
+            continue;
+        }
+        // Имена хранятся относительно корня, с '/' в качестве разделителя.
+        const std::string name = std::filesystem::relative(it->path(), root).generic_string();
+        names.PushBack(MString(name.c_str()));
+    }
+    if (error) {
+        MERROR("Не удалось обойти каталог '%s': %s", RootPath, error.message().c_str());
+        return -4;
+    }
+    if (names.Length() == 0) {
+        MERROR("Каталог '%s' не содержит файлов.", RootPath);
+        return -4;
+    }
+
+    DArray<const char*> NamePtrs;
+    for (u32 i = 0; i < names.Length(); ++i) {
+        NamePtrs.PushBack(names[i].c_str());
+    }
+
+    MINFO("Сборка пакета %s -> %s (%u файлов, сжатие %s)...", RootPath, OutPath, names.Length(), compress ? "LZ4" : "нет");
+    if (!AssetPack::Write(OutPath, RootPath, NamePtrs.Data(), NamePtrs.Length(), compress)) {
+        MERROR("Ошибка сборки пакета ресурсов. Смотрите журналы.");
+        return -5;
+    }
+
+    MINFO("Пакет ресурсов успешно собран.");
+    return 0;
+}
+
 void PrintHelp()
 {
 #ifdef MPLATFORM_WINDOWS
@@ -101,6 +154,10 @@ void PrintHelp()
                     которые все заканчиваются на <stage>.glsl, где <stage>\n\
                     заменяется одним из следующих поддерживаемых этапов:\n\
                         vert, frag, geom, comp\n\
-                    Скомпилированный файл .spv выводится по тому же пути, что и входной файл.\n",
+                    Скомпилированный файл .spv выводится по тому же пути, что и входной файл.\n\
+    buildpack -     Собирает пакет ресурсов из всех файлов каталога. Аргументы:\n\
+                        <каталог ресурсов> <выходной файл> [-lz4]\n\
+                    Например: buildpack ../assets ../assets.mpk -lz4\n\
+                    С флагом -lz4 файлы сжимаются, если это уменьшает их размер.\n",
         extension);
 }  
\ No newline at end of file
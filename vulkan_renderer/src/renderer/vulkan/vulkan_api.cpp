@@ -17,6 +17,15 @@
 #include <math/vertex.h>
 
 #include "vulkan_utils.h"
+#include "vulkan_pipeline_cache.hpp"
+
+#include <core/clock.h>
+#include <systems/job_systems.hpp>
+#include <platform/platform.hpp>
+
+// Файл кеша конвейеров относительно каталога ресурсов, рядом с модулями шейдеров. 
+// Заголовок файла привязывает его к устройству и версии драйвера.
+constexpr const char* VULKAN_PIPELINE_CACHE_FILE = "shaders/pipeline_cache.bin";
 
 // ПРИМЕЧАНИЕ: Если вы хотите отслеживать выделения, раскомментируйте это.
 // #ifndef MVULKAN_ALLOCATOR_TRACE
@@ -35,6 +44,9 @@ VKAPI_ATTR VkBool32 VKAPI_CALL VkDebugCallback(
     void* UserData
 );
 
+// Контекст записи, в который пишет текущий поток. nullptr — запись идет в основной буфер команд кадра.
+static thread_local VulkanRecordingContext* CurrentRecordingContext = nullptr;
+
 #if MVULKAN_USE_CUSTOM_ALLOCATOR == 1
 /// @brief Реализация PFN_vkAllocationFunction.
 /// @link https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/PFN_vkAllocationFunction.html
@@ -224,7 +236,24 @@ RecreatingSwapchain(false),
 RenderFlagChanged(false),
 geometries(),
 WorldRenderTargets(),
-MultithreadingEnabled(false)
+MultithreadingEnabled(false),
+RecordingContextsAvailable(false),
+BoundShader(nullptr),
+RecordingContexts(),
+PipelineCache(),
+PipelineCacheWarm(false),
+PipelineCachePath(),
+DeferPipelineCreation(false),
+PipelineBuildCount(),
+PipelineBuildMicroseconds(),
+BindlessTable(),
+StagingRing(),
+ReadbackQueue(),
+Timestamps(),
+ActiveTimestampQuery(INVALID::ID),
+Culling(),
+UniformRing(),
+DeferredQueue()
 {
 
 }
@@ -235,6 +264,13 @@ VulkanAPI::~VulkanAPI()
 
     // Уничтожать в порядке, обратном порядку создания.
 
+    VulkanDeferredDestroy(this, DeferredQueue);
+    VulkanCullingDestroy(this, Culling);
+    VulkanTimestampsDestroy(this, Timestamps);
+    VulkanReadbackDestroy(this, ReadbackQueue);
+    VulkanStagingDestroy(this, StagingRing);
+    VulkanUniformRingDestroy(this, UniformRing);
+
     RenderBufferDestroyInternal(ObjectVertexBuffer);
     RenderBufferDestroyInternal(ObjectIndexBuffer);
 
@@ -257,6 +293,15 @@ VulkanAPI::~VulkanAPI()
         vkDestroyFence(Device.LogicalDevice, InFlightFences[i], allocator);
     }
 
+    // Контексты записи
+    DestroyRecordingContexts();
+
+    // Кеш конвейеров сохраняется для следующего запуска.
+    VulkanPipelineCacheDestroy(this, PipelineCachePath, PipelineCache);
+
+    // Таблица текстур режима без привязки.
+    VulkanBindlessDestroy(this, BindlessTable);
+
     // Буферы команд
     for (u32 i = 0; i < swapchain.ImageCount; ++i) {
         if (GraphicsCommandBuffers[i].handle) {
@@ -469,6 +514,23 @@ bool VulkanAPI::Initialize(const RenderingConfig &config, u8 &OutWindowRenderTar
         return false;
     }
 
+    // Кеш конвейеров. Без него конвейеры все равно создаются, только медленнее.
+    MString::Format(PipelineCachePath, "%s/%s", ResourceSystem::BasePath(), VULKAN_PIPELINE_CACHE_FILE);
+    if (!VulkanPipelineCacheCreate(this, PipelineCachePath, PipelineCache, PipelineCacheWarm)) {
+        MWARN("Конвейеры будут создаваться без кеша.");
+    }
+    // Конвейеры шейдеров, созданных до первого кадра, собираются на потоках заданий.
+    DeferPipelineCreation = true;
+
+    // Таблица текстур режима без привязки. Без нее шейдеры используют наборы дескрипторов экземпляров.
+    if (Device.supportFlags & VulkanDevice::DescriptorIndexingBit) {
+        if (!VulkanBindlessCreate(this, TEXTURE_BINDLESS_MAX_SLOTS, BindlessTable)) {
+            MWARN("Режим без привязки отключен.");
+        }
+    } else {
+        MINFO("Устройство не поддерживает индексирование дескрипторов. Режим без привязки отключен.");
+    }
+
     // Swapchain
     swapchain.Create(this, FramebufferWidth, FramebufferHeight, config.flags);
 
@@ -478,6 +540,9 @@ bool VulkanAPI::Initialize(const RenderingConfig &config, u8 &OutWindowRenderTar
     // Создайте буферы команд.
     CreateCommandBuffers();
 
+    // Создайте контексты параллельной записи команд.
+    RecordingContextsAvailable = CreateRecordingContexts();
+
     // Создайте объекты синхронизации.
     ImageAvailableSemaphores.Resize(swapchain.MaxFramesInFlight);
     QueueCompleteSemaphores.Resize(swapchain.MaxFramesInFlight);
@@ -516,6 +581,28 @@ bool VulkanAPI::Initialize(const RenderingConfig &config, u8 &OutWindowRenderTar
         return false;
     }
     RenderBufferBind(ObjectIndexBuffer, 0);
+
+    // Кольцо униформ. Наборы дескрипторов всех шейдеров указывают на него, поэтому без него шейдеры не работают.
+    if (!VulkanUniformRingCreate(this, VULKAN_UNIFORM_RING_PARTITION_SIZE, UniformRing)) {
+        MERROR("Не удалось создать кольцо униформ.");
+        return false;
+    }
+
+    // Промежуточное кольцо для пакетных загрузок. Без него каждая загрузка ожидает собственное копирование.
+    if (!VulkanStagingCreate(this, VULKAN_STAGING_PARTITION_SIZE, StagingRing)) {
+        MWARN("Не удалось создать промежуточное кольцо, загрузки будут выполняться по одной.");
+    }
+
+    // Кольцо чтений. Без него каждое асинхронное чтение получает собственный буфер.
+    if (!VulkanReadbackCreate(this, VULKAN_READBACK_RING_SIZE, ReadbackQueue)) {
+        MWARN("Не удалось создать кольцо чтений, чтения будут использовать отдельные буферы.");
+    }
+
+    // Метки времени проходов. Без них рендерер работает, но время проходов на GPU не измеряется.
+    VulkanTimestampsCreate(this, Timestamps);
+
+    // Отсечение на GPU. Без него представления отсекают и рисуют геометрии на CPU.
+    VulkanCullingCreate(this, Culling);
    
     // Отметить все геометрии как недействительные
     for (u32 i = 0; i < VULKAN_MAX_GEOMETRY_COUNT; ++i) {
@@ -565,6 +652,10 @@ bool VulkanAPI::PrepareFrame(const FrameData& rFrameData)
             MERROR("Ошибка VulkanBeginFrame vkDeviceWaitIdle (2): '%shader'", VulkanResultString(result, true));
             return false;
         }
+        // Устройство свободно, а индекс кадра будет сброшен вместе с цепочкой подкачки.
+        VulkanReadbackCollect(this, ReadbackQueue, true);
+        VulkanTimestampsCollect(this, Timestamps, true);
+        VulkanDeferredCollect(this, DeferredQueue, true);
 
         if (RenderFlagChanged) {
             RenderFlagChanged = false;
@@ -586,6 +677,15 @@ bool VulkanAPI::PrepareFrame(const FrameData& rFrameData)
         MERROR("Ошибка ожидания в полете! ошибка: %shader", VulkanResultString(result, true));
     }
 
+    // Сообщить о пакетах загрузок, завершенных к этому моменту.
+    VulkanStagingCollect(this, StagingRing);
+    // Чтения, записанные в этот кадр в полете, завершены.
+    VulkanReadbackCollect(this, ReadbackQueue, false);
+    // Метки времени этого кадра в полете тоже готовы, читать их можно без ожидания.
+    VulkanTimestampsCollect(this, Timestamps, false);
+    // Ресурсы, освобожденные кадрами, которые уже завершены, уничтожаются без ожидания простоя устройства.
+    VulkanDeferredCollect(this, DeferredQueue, false);
+
     // Получаем следующее изображение из цепочки обмена. Передайте семафор, который должен сигнализировать, когда это завершится.
     // Этот же семафор позже будет ожидаться при отправке в очередь, чтобы убедиться, что это изображение доступно.
     if (!swapchain.AcquireNextImageIndex(
@@ -614,8 +714,20 @@ bool VulkanAPI::Begin(const FrameData &rFrameData)
         return false;
     }
 
+    if (DeferPipelineCreation) {
+        // Запуск завершен: дальше конвейеры (например, при перезагрузке шейдеров) создаются сразу.
+        DeferPipelineCreation = false;
+        MINFO("Конвейеры при запуске: %u шейдеров, %.2f мс суммарно по потокам, кеш %s.",
+              PipelineBuildCount, PipelineBuildMicroseconds / 1000.0, PipelineCacheWarm ? "теплый" : "холодный");
+    }
+
     VulkanCommandBufferReset(CommandBuffer);
     VulkanCommandBufferBegin(CommandBuffer, false, false, false);
+    VulkanTimestampsReset(this, Timestamps, *CommandBuffer);
+    // Ограждение кадра пройдено: GPU больше не читает униформы этого кадра в полете.
+    VulkanUniformRingBegin(UniformRing, CurrentFrame);
+    // Команды косвенной отрисовки вычисляются до всех проходов кадра.
+    VulkanCullingRecord(this, Culling, *CommandBuffer);
 
     SetWinding(RendererWinding::CounterClockwise);
 
@@ -626,6 +738,10 @@ bool VulkanAPI::End(const FrameData& rFrameData)
 {
     auto* CommandBuffer = &GraphicsCommandBuffers[ImageIndex];
 
+    // Копирования чтений идут после всех проходов кадра.
+    VulkanReadbackRecord(this, ReadbackQueue, *CommandBuffer);
+    VulkanUniformRingEnd(UniformRing);
+
     VulkanCommandBufferEnd(CommandBuffer);
 
     // Убедитесь, что предыдущий кадр не использует это изображение (т.е. его ограждение находится в режиме ожидания).
@@ -670,6 +786,11 @@ bool VulkanAPI::End(const FrameData& rFrameData)
     VkPipelineStageFlags flags[1] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
     SubmitInfo.pWaitDstStageMask = flags;
 
+    // Загрузки кадра отправляются одним пакетом раньше буфера кадра, поэтому его команды видят новые данные.
+    if (!VulkanStagingFlush(this, StagingRing, false)) {
+        MERROR("VulkanAPI::End не удалось отправить пакет загрузок.");
+    }
+
     VkResult result = vkQueueSubmit(
         Device.GraphicsQueue,
         1,
@@ -679,6 +800,7 @@ bool VulkanAPI::End(const FrameData& rFrameData)
         MERROR("vkQueueSubmit не дал результата: %shader", VulkanResultString(result, true));
         return false;
     }
+    DeferredQueue.SubmittedFrames++;
 
     VulkanCommandBufferUpdateSubmitted(CommandBuffer);
     // Отправка в конечную очередь
@@ -709,7 +831,15 @@ void VulkanAPI::SetViewport(const Rect2D &rect)
     viewport.minDepth = 0.F;
     viewport.maxDepth = 1.F;
 
-    auto& CommandBuffer = GraphicsCommandBuffers[ImageIndex];
+    if (CurrentRecordingContext) {
+        // Запомнить для вторичных буферов, которые начнутся позже.
+        CurrentRecordingContext->viewport = viewport;
+        if (!CurrentRecordingContext->current) {
+            return;
+        }
+    }
+
+    auto& CommandBuffer = CommandBufferGet();
 
     vkCmdSetViewport(CommandBuffer.handle, 0, 1, &viewport);
 }
@@ -728,7 +858,14 @@ void VulkanAPI::SetScissor(const Rect2D &rect)
     scissor.extent.width = rect.z;
     scissor.extent.height = rect.w;
 
-    auto CommandBuffer = GraphicsCommandBuffers[ImageIndex];
+    if (CurrentRecordingContext) {
+        CurrentRecordingContext->scissor = scissor;
+        if (!CurrentRecordingContext->current) {
+            return;
+        }
+    }
+
+    auto& CommandBuffer = CommandBufferGet();
 
     vkCmdSetScissor(CommandBuffer.handle, 0, 1, &scissor);
 }
@@ -741,9 +878,17 @@ void VulkanAPI::ScissorReset()
 
 void VulkanAPI::SetWinding(RendererWinding winding)
 {
-    auto& CommandBuffer = GraphicsCommandBuffers[ImageIndex];
-
     VkFrontFace vkWinding = winding == RendererWinding::CounterClockwise ? VK_FRONT_FACE_COUNTER_CLOCKWISE : VK_FRONT_FACE_CLOCKWISE;
+    if (CurrentRecordingContext) {
+        CurrentRecordingContext->winding = vkWinding;
+        if (!CurrentRecordingContext->current) {
+            return;
+        }
+    }
+
+    auto& CommandBuffer = CommandBufferGet();
+    auto BoundShader = CurrentRecordingContext ? CurrentRecordingContext->BoundShader : this->BoundShader;
+
     if (Device.supportFlags & VulkanDevice::NativeDynamicFrontFaceBit) {
         vkCmdSetFrontFace(CommandBuffer.handle, vkWinding);
     } else if (Device.supportFlags * VulkanDevice::DynamicFrontFaceBit) {
@@ -765,8 +910,6 @@ void VulkanAPI::SetWinding(RendererWinding winding)
 
 bool VulkanAPI::RenderpassBegin(Renderpass* pass, RenderTarget& target)
 {
-    auto& CommandBuffer = GraphicsCommandBuffers[ImageIndex];
-
     // Начало этапа рендеринга.
     auto VkRenderpass = reinterpret_cast<VulkanRenderpass*>(pass->InternalData);
 
@@ -812,6 +955,40 @@ bool VulkanAPI::RenderpassBegin(Renderpass* pass, RenderTarget& target)
 
     BeginInfo.pClearValues = BeginInfo.clearValueCount > 0 ? ClearValues : 0;
 
+    if (auto context = CurrentRecordingContext) {
+        // Проход записывается во вторичный буфер, а начнет его основной поток в RecordingExecute.
+        if (context->PassCount == VULKAN_MAX_RECORDED_PASSES) {
+            MERROR("VulkanAPI::RenderpassBegin: превышено количество проходов в контексте записи (%u).", VULKAN_MAX_RECORDED_PASSES);
+            return false;
+        }
+        auto& recorded = context->passes[context->PassCount++];
+        recorded.renderpass = BeginInfo.renderPass;
+        recorded.framebuffer = BeginInfo.framebuffer;
+        recorded.RenderArea = BeginInfo.renderArea;
+        recorded.ClearValueCount = BeginInfo.clearValueCount;
+        recorded.name = pass->name.c_str();
+        MemorySystem::CopyMem(recorded.ClearValues, ClearValues, sizeof(ClearValues));
+
+        auto& buffers = context->buffers[CurrentFrame];
+        if (context->UsedCount == buffers.Length()) {
+            VulkanCommandBuffer secondary{};
+            VulkanCommandBufferAllocate(this, context->pools[CurrentFrame], false, &secondary);
+            buffers.PushBack(secondary);
+        }
+        context->current = &buffers[context->UsedCount++];
+        recorded.secondary = context->current->handle;
+        VulkanCommandBufferBeginSecondary(context->current, BeginInfo.renderPass, BeginInfo.framebuffer);
+
+        // Вторичный буфер не наследует динамическое состояние — восстановить его.
+        auto& CommandBuffer = *context->current;
+        vkCmdSetViewport(CommandBuffer.handle, 0, 1, &context->viewport);
+        vkCmdSetScissor(CommandBuffer.handle, 0, 1, &context->scissor);
+        SetWinding(context->winding == VK_FRONT_FACE_COUNTER_CLOCKWISE ? RendererWinding::CounterClockwise : RendererWinding::Clockwise);
+        return true;
+    }
+
+    auto& CommandBuffer = GraphicsCommandBuffers[ImageIndex];
+    ActiveTimestampQuery = VulkanTimestampsBegin(this, Timestamps, CommandBuffer, pass->name.c_str());
     vkCmdBeginRenderPass(CommandBuffer.handle, &BeginInfo, VK_SUBPASS_CONTENTS_INLINE);
     CommandBuffer.state = COMMAND_BUFFER_STATE_IN_RENDER_PASS;
 
@@ -826,10 +1003,22 @@ bool VulkanAPI::RenderpassBegin(Renderpass* pass, RenderTarget& target)
 
 bool VulkanAPI::RenderpassEnd(Renderpass* pass)
 {
+    if (auto context = CurrentRecordingContext) {
+        if (!context->current) {
+            MERROR("VulkanAPI::RenderpassEnd: проход не был начат в этом контексте записи.");
+            return false;
+        }
+        VulkanCommandBufferEnd(context->current);
+        context->current = nullptr;
+        return true;
+    }
+
     auto& CommandBuffer = GraphicsCommandBuffers[ImageIndex];
 
     // Завершение рендеринга.
     vkCmdEndRenderPass(CommandBuffer.handle);
+    VulkanTimestampsEnd(this, Timestamps, CommandBuffer, ActiveTimestampQuery);
+    ActiveTimestampQuery = INVALID::ID;
     VK_END_DEBUG_LABEL(this, CommandBuffer.handle);
     CommandBuffer.state = COMMAND_BUFFER_STATE_RECORDING;
     return true;
@@ -859,7 +1048,8 @@ void VulkanAPI::Load(const u8* pixels, Texture *texture)
 
     texture->data = new VulkanImage(config);
 
-    TextureWriteData(texture, 0, ImageSize, pixels);
+    TextureUpload(texture, ImageSize, pixels, true);
+    BindlessTextureRegister(texture);
     texture->generation++;
 }
 
@@ -906,6 +1096,9 @@ void VulkanAPI::LoadTextureWriteable(Texture *texture)
     config.name                = texture->name;
 
     texture->data = new VulkanImage(config);
+    if (!(texture->flags & Texture::Flag::Depth)) {
+        BindlessTextureRegister(texture);
+    }
     texture->generation++;
 }
 
@@ -913,6 +1106,8 @@ void VulkanAPI::TextureResize(Texture *texture, u32 NewWidth, u32 NewHeight)
 {
     if (texture && texture->data) {
         auto image = reinterpret_cast<VulkanImage*>(texture->data);
+        // Старое изображение может использоваться пакетом загрузок.
+        VulkanStagingFlush(this, StagingRing, true);
         // Изменение размера на самом деле просто разрушает старое изображение и создает новое. 
         // Данные не сохраняются, поскольку не существует надежного способа сопоставить старые 
         // данные с новыми, поскольку объем данных различается.
@@ -934,6 +1129,8 @@ void VulkanAPI::TextureResize(Texture *texture, u32 NewWidth, u32 NewHeight)
         config.name                = texture->name;
 
         image->Create(config);
+        // Слот сохраняется, меняется только представление.
+        BindlessTextureRegister(texture);
 
         texture->generation++;
     }
@@ -941,6 +1138,34 @@ void VulkanAPI::TextureResize(Texture *texture, u32 NewWidth, u32 NewHeight)
 
 void VulkanAPI::TextureWriteData(Texture *texture, u32 offset, u32 size, const u8 *pixels)
 {
+    TextureUpload(texture, size, pixels, false);
+    texture->generation++;
+}
+
+void VulkanAPI::TextureWriteRegion(Texture *texture, u32 x, u32 y, u32 width, u32 height, const u8 *pixels)
+{
+    auto image = reinterpret_cast<VulkanImage*>(texture->data);
+    if (!VulkanStagingUploadImageRegion(this, StagingRing, image, texture->ChannelCount, x, y, width, height, pixels)) {
+        // Раздел кольца заполнен: отправить пакет и записать область в следующий.
+        VulkanStagingFlush(this, StagingRing, false);
+        if (!VulkanStagingUploadImageRegion(this, StagingRing, image, texture->ChannelCount, x, y, width, height, pixels)) {
+            MERROR("VulkanAPI::TextureWriteRegion — область %ux%u не помещается в раздел промежуточного кольца.", width, height);
+            return;
+        }
+    }
+    texture->generation++;
+}
+
+void VulkanAPI::TextureUpload(Texture *texture, u32 size, const u8 *pixels, bool IsNew)
+{
+    auto image = reinterpret_cast<VulkanImage*>(texture->data);
+    if (VulkanStagingUploadImage(this, StagingRing, image, texture->type, texture->ChannelCount, size, pixels, IsNew)) {
+        return;
+    }
+
+    // Данные не помещаются в раздел кольца. Уже записанные загрузки отправляются первыми, чтобы сохранить порядок.
+    VulkanStagingFlush(this, StagingRing, false);
+
     VkFormat ImageFormat = ChannelCountToFormat(texture->ChannelCount, VK_FORMAT_R8G8B8A8_UNORM);
 
     // Создайте промежуточный буфер и загрузите в него данные.
@@ -957,7 +1182,6 @@ void VulkanAPI::TextureWriteData(Texture *texture, u32 offset, u32 size, const u
     const auto& queue = Device.GraphicsQueue;
     VulkanCommandBufferAllocateAndBeginSingleUse(this, pool, TempBuffer);
 
-    auto image = reinterpret_cast<VulkanImage*>(texture->data);
     // Переведите макет от текущего к оптимальному для получения данных.
     image->TransitionLayout(this, texture->type, TempBuffer, ImageFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
@@ -978,12 +1202,13 @@ void VulkanAPI::TextureWriteData(Texture *texture, u32 offset, u32 size, const u
     
     RenderBufferUnbind(staging);
     RenderBufferDestroyInternal(staging);
-
-    texture->generation++;
 }
 
 void VulkanAPI::TextureReadData(Texture *texture, u32 offset, u32 size, void **OutMemory)
 {
+    // Чтение должно видеть загрузки, еще не отправленные пакетом.
+    VulkanStagingFlush(this, StagingRing, false);
+
     auto image = reinterpret_cast<VulkanImage*>(texture->data);
 
     VkFormat ImageFormat = ChannelCountToFormat(texture->ChannelCount, VK_FORMAT_R8G8B8A8_UNORM);
@@ -1036,6 +1261,9 @@ void VulkanAPI::TextureReadData(Texture *texture, u32 offset, u32 size, void **O
 
 void VulkanAPI::TextureReadPixel(Texture *texture, u32 x, u32 y, u8 **OutRgba)
 {
+    // Чтение должно видеть загрузки, еще не отправленные пакетом.
+    VulkanStagingFlush(this, StagingRing, false);
+
     auto image = reinterpret_cast<VulkanImage*>(texture->data);
 
     auto ImageFormat = ChannelCountToFormat(texture->ChannelCount, VK_FORMAT_R8G8B8A8_UNORM);
@@ -1091,6 +1319,22 @@ void VulkanAPI::TextureReadPixel(Texture *texture, u32 x, u32 y, u8 **OutRgba)
     RenderBufferDestroyInternal(staging);
 }
 
+u64 VulkanAPI::TextureReadDataAsync(Texture *texture, u32 offset, u32 size)
+{
+    return VulkanReadbackRequest(ReadbackQueue, texture, 0, 0, 0, 0, offset, size);
+}
+
+u64 VulkanAPI::TextureReadPixelAsync(Texture *texture, u32 x, u32 y)
+{
+    const u8 channels = texture->ChannelCount > 0 ? texture->ChannelCount : 4;
+    return VulkanReadbackRequest(ReadbackQueue, texture, x, y, 1, 1, 0, MMIN(channels, 4));
+}
+
+ReadbackStatus VulkanAPI::ReadbackPoll(u64 ticket, void *OutMemory)
+{
+    return VulkanReadbackPoll(ReadbackQueue, ticket, OutMemory);
+}
+
 void *VulkanAPI::TextureCopyData(const Texture* texture)
 {
     auto data = reinterpret_cast<VulkanImage*>(texture->data);
@@ -1099,14 +1343,15 @@ void *VulkanAPI::TextureCopyData(const Texture* texture)
 
 void VulkanAPI::Unload(Texture *texture)
 {
-    vkDeviceWaitIdle(Device.LogicalDevice);
-
     if (texture->data) {
-        auto data = reinterpret_cast<VulkanImage*>(texture->data);
-        data->Destroy(this);
+        // Изображение может быть в еще не отправленном пакете загрузок: пакет отправляется раньше ограждения
+        // следующего кадра, поэтому уничтожение после этого ограждения безопасно и для загрузки.
+        VulkanStagingFlush(this, StagingRing, false);
 
-        delete data;
-        data = nullptr;
+        // Кадры в полете еще могут читать изображение, поэтому оно уничтожается после их завершения,
+        // а не после ожидания простоя всего устройства.
+        VulkanDeferredReleaseImage(DeferredQueue, reinterpret_cast<VulkanImage*>(texture->data));
+        texture->data = nullptr;
     }
     //kzero_memory(texture, sizeof(struct texture));
 }
@@ -1191,21 +1436,14 @@ bool VulkanAPI::Load(Geometry *geometry, u32 VertexOffset, u32 VertexSize, u32 I
 void VulkanAPI::Unload(Geometry *geometry)
 {
     if (geometry && geometry->InternalID != INVALID::ID) {
-        vkDeviceWaitIdle(this->Device.LogicalDevice);
         auto& vkGeometry = this->geometries[geometry->InternalID];
 
-        // Освобождение данных вершин
-        if (!ObjectVertexBuffer.Free(geometry->VertexElementSize * geometry->VertexCount, vkGeometry.VertexBufferOffset)) {
-            MERROR("VulkanAPI::UnloadGeometry не удалось освободить диапазон буфера вершин.");
-        }
-
-        // Освобождение данных индексов, если это применимо
-        if (geometry->IndexCount) {
-            if (!ObjectIndexBuffer.Free(geometry->IndexElementSize * geometry->IndexCount, vkGeometry.IndexBufferOffset)) {
-                MERROR("VulkanAPI::UnloadGeometry не удалось освободить диапазон буфера индексов.");
-            }
-            
-        }
+        // Диапазоны вершин и индексов освобождаются после завершения кадров, которые могли их читать, 
+        // поэтому геометрию можно выгрузить посреди кадра без ожидания простоя устройства.
+        VulkanDeferredReleaseGeometry(
+            DeferredQueue,
+            geometry->VertexElementSize * geometry->VertexCount, vkGeometry.VertexBufferOffset,
+            geometry->IndexCount ? geometry->IndexElementSize * geometry->IndexCount : 0, vkGeometry.IndexBufferOffset);
 
         // Очистка данных.
         vkGeometry.Destroy();
@@ -1297,6 +1535,38 @@ bool VulkanAPI::Load(Shader *shader, const ShaderConfig& config, Renderpass* ren
     // Создайте конфигурацию.
     VulkShader->config.MaxDescriptorSetCount = MaxDescriptorAllocateCount;
 
+    const u32& TotalCount = config.uniforms.Length();
+    for (u32 i = 0; i < TotalCount; ++i) {
+        switch (config.uniforms[i].scope) {
+            case Shader::Scope::Global:
+                if (config.uniforms[i].type == Shader::UniformType::Sampler) {
+                    VulkShader->GlobalUniformSamplerCount++;
+                } else {
+                    VulkShader->GlobalUniformCount++;
+                }
+                break;
+            case Shader::Scope::Instance:
+                if (config.uniforms[i].type == Shader::UniformType::Sampler){
+                    VulkShader->InstanceUniformSamplerCount++;
+                } else {
+                    VulkShader->InstanceUniformCount++;
+                }
+                break;
+            case Shader::Scope::Local:
+                VulkShader->LocalUniformCount++;
+                break;
+        }
+    }
+
+    // Режим без привязки: нужны поддержка устройства, отдельные файлы этапов и оба набора дескрипторов,
+    // так как таблица текстур занимает набор с индексом VULKAN_BINDLESS_SET_INDEX.
+    VulkShader->bindless =
+        BindlessTable.set &&
+        config.BindlessStageFilenames.Length() == StageFilenames.Length() &&
+        (VulkShader->GlobalUniformCount > 0 || VulkShader->GlobalUniformSamplerCount > 0) &&
+        (VulkShader->InstanceUniformCount > 0 || VulkShader->InstanceUniformSamplerCount > 0);
+    const auto& filenames = VulkShader->bindless ? config.BindlessStageFilenames : StageFilenames;
+
     // Этапы шейдера. Разбираем флаги.
     // MMemory::ZeroMem(VulkShader->config.stages, sizeof(VulkanShaderStageConfig) * VulkanShaderConstants::MaxStages);
     VulkShader->config.StageCount = 0;
@@ -1325,39 +1595,31 @@ bool VulkanAPI::Load(Shader *shader, const ShaderConfig& config, Renderpass* ren
 
         // Подготовьте сцену и ударьте по счетчику.
         VulkShader->config.stages[VulkShader->config.StageCount].stage = StageFlag;
-        MString::Copy(VulkShader->config.stages[VulkShader->config.StageCount].FileName, StageFilenames[i].c_str(), 255);
+        MString::Copy(VulkShader->config.stages[VulkShader->config.StageCount].FileName, filenames[i].c_str(), 255);
         VulkShader->config.StageCount++;
     }
 
-    VulkShader->config.DescriptorSets[0].SamplerBindingIndex = INVALID::U8ID;
-    VulkShader->config.DescriptorSets[1].SamplerBindingIndex = INVALID::U8ID;
-
-    const u32& TotalCount = config.uniforms.Length();
-    for (u32 i = 0; i < TotalCount; ++i) {
-        switch (config.uniforms[i].scope) {
-            case Shader::Scope::Global:
-                if (config.uniforms[i].type == Shader::UniformType::Sampler) {
-                    VulkShader->GlobalUniformSamplerCount++;
-                } else {
-                    VulkShader->GlobalUniformCount++;
-                }
-                break;
-            case Shader::Scope::Instance:
-                if (config.uniforms[i].type == Shader::UniformType::Sampler){
-                    VulkShader->InstanceUniformSamplerCount++;
-                } else {
-                    VulkShader->InstanceUniformCount++;
-                }
-                break;
-            case Shader::Scope::Local:
-                VulkShader->LocalUniformCount++;
+    // Косвенная отрисовка: вершинный этап берет матрицу модели из записей отсечения на GPU, а не из push-константы.
+    // В режиме без привязки набор отсечения идет после таблицы текстур, поэтому нужен свой вершинный этап.
+    const auto& IndirectFilename = VulkShader->bindless ? config.BindlessIndirectVertexFilename : config.IndirectVertexFilename;
+    if (Culling.supported && IndirectFilename.Length() > 0) {
+        for (u8 i = 0; i < VulkShader->config.StageCount; ++i) {
+            if (VulkShader->config.stages[i].stage == VK_SHADER_STAGE_VERTEX_BIT) {
+                VulkShader->IndirectStageIndex = i;
+                VulkShader->IndirectStageConfig.stage = VK_SHADER_STAGE_VERTEX_BIT;
+                MString::Copy(VulkShader->IndirectStageConfig.FileName, IndirectFilename.c_str(), 255);
                 break;
+            }
         }
     }
 
-    // На данный момент шейдеры будут иметь только эти два типа пулов дескрипторов.
-    VulkShader->config.PoolSizes[0] = VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1024};          // HACK: максимальное количество наборов дескрипторов ubo.
+    VulkShader->config.DescriptorSets[0].SamplerBindingIndex = INVALID::U8ID;
+    VulkShader->config.DescriptorSets[1].SamplerBindingIndex = INVALID::U8ID;
+
+    // На данный момент шейдеры будут иметь только эти три типа пулов дескрипторов.
+    VulkShader->config.PoolSizes[0] = VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1024};  // HACK: максимальное количество наборов дескрипторов ubo. Данные берутся из кольца униформ по динамическому смещению.
     VulkShader->config.PoolSizes[1] = VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4096};  // HACK: максимальное количество наборов дескрипторов сэмплера изображений.
+    VulkShader->config.PoolSizes[2] = VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1};             // Буфер записей материалов режима без привязки.
 
     // Конфигурация глобального набора дескрипторов.
     if (VulkShader->GlobalUniformCount > 0 || VulkShader->GlobalUniformSamplerCount > 0) {
@@ -1369,7 +1631,7 @@ bool VulkanAPI::Load(Shader *shader, const ShaderConfig& config, Renderpass* ren
             const u8& BindingIndex = SetConfig.BindingCount;
             SetConfig.bindings[BindingIndex].binding = BindingIndex;
             SetConfig.bindings[BindingIndex].descriptorCount = 1;
-            SetConfig.bindings[BindingIndex].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            SetConfig.bindings[BindingIndex].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
             SetConfig.bindings[BindingIndex].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
             SetConfig.BindingCount++;
         }
@@ -1389,8 +1651,17 @@ bool VulkanAPI::Load(Shader *shader, const ShaderConfig& config, Renderpass* ren
         VulkShader->config.DescriptorSetCount++;
     }
 
-    // Если используются униформы экземпляров, добавьте набор дескрипторов UBO.
-    if (VulkShader->InstanceUniformCount > 0 || VulkShader->InstanceUniformSamplerCount > 0) {
+    if (VulkShader->bindless) {
+        // Записи экземпляров кадра лежат в кольце униформ, привязанном как буфер хранения; запись выбирается push-константой.
+        auto& SetConfig = VulkShader->config.DescriptorSets[VulkShader->config.DescriptorSetCount];
+        SetConfig.bindings[0].binding = 0;
+        SetConfig.bindings[0].descriptorCount = 1;
+        SetConfig.bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        SetConfig.bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+        SetConfig.BindingCount = 1;
+        VulkShader->config.DescriptorSetCount++;
+    } else if (VulkShader->InstanceUniformCount > 0 || VulkShader->InstanceUniformSamplerCount > 0) {
+        // Если используются униформы экземпляров, добавьте набор дескрипторов UBO.
         // В этом наборе добавьте привязку для UBO, если она используется.
         auto& SetConfig = VulkShader->config.DescriptorSets[VulkShader->config.DescriptorSetCount];
 
@@ -1398,7 +1669,7 @@ bool VulkanAPI::Load(Shader *shader, const ShaderConfig& config, Renderpass* ren
             const u8& BindingIndex = SetConfig.BindingCount;
             SetConfig.bindings[BindingIndex].binding = BindingIndex;
             SetConfig.bindings[BindingIndex].descriptorCount = 1;
-            SetConfig.bindings[BindingIndex].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            SetConfig.bindings[BindingIndex].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
             SetConfig.bindings[BindingIndex].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
             SetConfig.BindingCount++;
         }
@@ -1436,6 +1707,10 @@ void VulkanAPI::Unload(Shader *shader)
             return;
         }
 
+        // Незавершенная сборка конвейеров отменяется или дожидается завершения:
+        // она использует макеты наборов дескрипторов, которые удаляются ниже.
+        PipelinesWait(shader, true);
+
         VkDevice& LogicalDevice = Device.LogicalDevice;
         //VkAllocationCallbacks* VkAllocator = allocator;
 
@@ -1464,10 +1739,19 @@ void VulkanAPI::Unload(Shader *shader)
             }
         }
 
+        if (VkShader->IndirectPipeline) {
+            VkShader->IndirectPipeline->Destroy(this);
+            MemorySystem::Free(VkShader->IndirectPipeline, sizeof(VulkanPipeline), Memory::Vulkan);
+            VkShader->IndirectPipeline = nullptr;
+        }
+
         // Шейдерные модули
         for (u32 i = 0; i < VkShader->config.StageCount; ++i) {
             vkDestroyShaderModule(Device.LogicalDevice, VkShader->stages[i].handle, allocator);
         }
+        if (VkShader->IndirectStage.handle) {
+            vkDestroyShaderModule(Device.LogicalDevice, VkShader->IndirectStage.handle, allocator);
+        }
 
         // Уничтожьте конфигурацию.
         MemorySystem::ZeroMem(&VkShader->config, sizeof(VulkanShaderConfig));
@@ -1492,6 +1776,17 @@ bool VulkanAPI::ShaderInitialize(Shader *shader)
         }
     }
 
+    // Без вершинного этапа косвенной отрисовки шейдер работает как обычно, а представления рисуют геометрии сами.
+    if (VkShader->IndirectStageConfig.FileName[0]) {
+        if (VkShader->config.DescriptorSetCount != VULKAN_CULLING_SET_INDEX || !(shader->TopologyTypes & PrimitiveTopology::TriangleList)) {
+            MWARN("Шейдер «%s» не совместим с косвенной отрисовкой: нужны наборы глобальных данных и экземпляров и список треугольников.", shader->name.c_str());
+            VkShader->IndirectStageConfig.FileName[0] = 0;
+        } else if (!CreateModule(VkShader, VkShader->IndirectStageConfig, &VkShader->IndirectStage)) {
+            MWARN("Невозможно создать модуль косвенной отрисовки %s для «%s». Косвенная отрисовка отключена.", VkShader->IndirectStageConfig.FileName, shader->name.c_str());
+            VkShader->IndirectStageConfig.FileName[0] = 0;
+        }
+    }
+
     // Статическая таблица поиска для наших типов -> Vulkan.
     static VkFormat* types = nullptr;
     static VkFormat t[11];
@@ -1528,7 +1823,7 @@ bool VulkanAPI::ShaderInitialize(Shader *shader)
 
     // Пул дескрипторов.
     VkDescriptorPoolCreateInfo PoolInfo = {VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
-    PoolInfo.poolSizeCount = 2;
+    PoolInfo.poolSizeCount = 3;
     PoolInfo.pPoolSizes = VkShader->config.PoolSizes;
     PoolInfo.maxSets = VkShader->config.MaxDescriptorSetCount;
     PoolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
@@ -1552,25 +1847,9 @@ bool VulkanAPI::ShaderInitialize(Shader *shader)
         }
     }
 
-    // ЗАДАЧА: Кажется неправильным иметь их здесь, по крайней мере, в таком виде. 
-    // Вероятно, следует настроить получение из какого-либо места вместо области просмотра.
-    VkViewport viewport;
-    viewport.x = 0.F;
-    viewport.y = (f32)FramebufferHeight;
-    viewport.width = (f32)FramebufferWidth;
-    viewport.height = -(f32)FramebufferHeight;
-    viewport.minDepth = 0.F;
-    viewport.maxDepth = 1.F;
-
-    // Scissor
-    VkRect2D scissor;
-    scissor.offset.x = scissor.offset.y = 0;
-    scissor.extent.width = FramebufferWidth;
-    scissor.extent.height = FramebufferHeight;
-
-    VkPipelineShaderStageCreateInfo StageCreateIfos[VulkanShaderConstants::MaxStages]{};
-    for (u32 i = 0; i < VkShader->config.StageCount; ++i) {
-        StageCreateIfos[i] = VkShader->stages[i].ShaderStageCreateInfo;
+    if (VkShader->bindless && shader->PushConstantSize > VULKAN_BINDLESS_PUSH_CONSTANT_OFFSET) {
+        MERROR("VulkanAPI::ShaderInitialize — push-константы шейдера «%s» пересекаются с индексом материала режима без привязки.", shader->name.c_str());
+        return false;
     }
 
     u32 PipelineCount = 0;
@@ -1648,39 +1927,14 @@ bool VulkanAPI::ShaderInitialize(Shader *shader)
             VkShader->pipelines[5]->SupportedTopologyTypes = PrimitiveTopology::TriangleFan;
         }
     }
-    
-
-    // Пройти по циклу и настроить/создать один конвейер на класс. Нулевые записи пропускаются.
-    for (u32 i = 0; i < PipelineCount; ++i) {
-        if (!VkShader->pipelines[i]) {
-            continue;
-        }
-
-        VulkanPipeline::Config PipelineConfig {
-            shader->name,
-            VkShader->renderpass,
-            shader->AttributeStride,
-            (u32)shader->attributes.Length(),
-            VkShader->config.attributes,  // shader->attributes,
-            VkShader->config.DescriptorSetCount,
-            VkShader->DescriptorSetLayouts,
-            VkShader->config.StageCount,
-            StageCreateIfos,
-            viewport,
-            scissor,
-            VkShader->config.CullMode,
-            shader->flags,
-            shader->PushConstantRangeCount,
-            shader->PushConstantRanges,
-            shader->TopologyTypes
-        };
 
-        bool PipelineResult = VkShader->pipelines[i]->Create(this, PipelineConfig);
+    if (VkShader->IndirectStageConfig.FileName[0]) {
+        VkShader->IndirectPipeline = reinterpret_cast<VulkanPipeline*>(MemorySystem::Allocate(sizeof(VulkanPipeline), Memory::Vulkan, true));
+        VkShader->IndirectPipeline->SupportedTopologyTypes = PrimitiveTopology::TriangleList;
+    }
 
-        if (!PipelineResult) {
-            MERROR("Не удалось загрузить графический конвейер для шейдера: '%s'.", shader->name.c_str());
-            return false;
-        }
+    if (DeferPipelineCreation ? !CreatePipelinesDeferred(shader, PipelineCount) : !CreatePipelines(shader, PipelineCount)) {
+        return false;
     }
 
     // ЗАДАЧА: Выяснить, что должно быть по умолчанию здесь.
@@ -1738,7 +1992,9 @@ bool VulkanAPI::ShaderInitialize(Shader *shader)
 
     // Убедитесь, что UBO выровнен в соответствии с требованиями устройства.
     shader->GlobalUboStride = Range::GetAligned(shader->GlobalUboSize, shader->RequiredUboAlignment);
-    shader->UboStride = Range::GetAligned(shader->UboSize, shader->RequiredUboAlignment);
+    // В режиме без привязки за униформами экземпляра следуют индексы его текстур, по одному u32 на текстуру.
+    const u64 InstanceSize = shader->UboSize + (VkShader->bindless ? sizeof(u32) * shader->InstanceTextureCount : 0);
+    shader->UboStride = Range::GetAligned(InstanceSize, shader->RequiredUboAlignment);
 
     // Однородный буфер.
     // ЗАДАЧА: Максимальное количество должно быть настраиваемым или, возможно, иметь долгосрочную поддержку изменения размера буфера.
@@ -1771,162 +2027,278 @@ bool VulkanAPI::ShaderInitialize(Shader *shader)
     AllocInfo.pSetLayouts = GlobalLayouts;
     VK_CHECK(vkAllocateDescriptorSets(Device.LogicalDevice, &AllocInfo, VkShader->GlobalDescriptorSets));
 
-    return true;
-}
-
-bool VulkanAPI::ShaderUse(Shader *shader)
-{
-    auto VkShader = reinterpret_cast<VulkanShader*>(shader->ShaderData);
-    auto& CommandBuffer = GraphicsCommandBuffers[ImageIndex];
-    VkShader->pipelines[VkShader->BoundPipelineIndex]->Bind(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS);
-    BoundShader = shader;
-
-    // Обязательно используйте текущий тип привязки.
-    if (Device.supportFlags & VulkanDevice::NativeDynamicTopologyBit) {
-        vkCmdSetPrimitiveTopology(CommandBuffer.handle, VkShader->CurrentTopology);
-    } else if (Device.supportFlags & VulkanDevice::DynamicTopologyBit) {
-        vkCmdSetPrimitiveTopologyEXT(CommandBuffer.handle, VkShader->CurrentTopology);
-    }
-    return true;
-}
-
-bool VulkanAPI::ShaderApplyGlobals(Shader *shader, bool NeedsUpdate)
-{
-    auto VkShader = shader->ShaderData;
-    auto& CommandBuffer = GraphicsCommandBuffers[ImageIndex].handle;
-    auto& GlobalDescriptor = VkShader->GlobalDescriptorSets[ImageIndex];
-
-    if (NeedsUpdate) {
-        // Сначала примените UBO
-        VkDescriptorBufferInfo BufferInfo;
-        BufferInfo.buffer = reinterpret_cast<VulkanBuffer*>(VkShader->UniformBuffer.data)->handle;
-        BufferInfo.offset = shader->GlobalUboOffset;
-        BufferInfo.range = shader->GlobalUboStride;
-
-        // Обновить наборы дескрипторов.
-        VkWriteDescriptorSet UboWrite = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-        UboWrite.dstSet = VkShader->GlobalDescriptorSets[ImageIndex];
-        UboWrite.dstBinding = 0;
-        UboWrite.dstArrayElement = 0;
-        UboWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        UboWrite.descriptorCount = 1;
-        UboWrite.pBufferInfo = &BufferInfo;
-
-        VkWriteDescriptorSet DescriptorWrites[2];
-        DescriptorWrites[0] = UboWrite;
-
+    if (VkShader->GlobalUniformCount > 0) {
+        // Глобальный UBO указывает на кольцо униформ один раз: кадр выбирает свои данные динамическим смещением.
         u8& GlobalSetBindingCount = VkShader->config.DescriptorSets[DESC_SET_INDEX_GLOBAL].BindingCount;
         if (GlobalSetBindingCount > 1) {
             // ЗАДАЧА: Есть семплеры, которые нужно написать. Поддержите это.
             GlobalSetBindingCount = 1;
             MERROR("Глобальные образцы изображений пока не поддерживаются.");
+        }
+
+        VkDescriptorBufferInfo BufferInfo;
+        BufferInfo.buffer = reinterpret_cast<VulkanBuffer*>(UniformRing.buffer.data)->handle;
+        BufferInfo.offset = 0;
+        BufferInfo.range = shader->GlobalUboStride;
 
-            // VkWriteDescriptorSet sampler_write = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-            // descriptor_writes[1] = ...
+        VkWriteDescriptorSet UboWrites[3];
+        for (u32 i = 0; i < 3; ++i) {
+            UboWrites[i] = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+            UboWrites[i].dstSet = VkShader->GlobalDescriptorSets[i];
+            UboWrites[i].dstBinding = 0;
+            UboWrites[i].dstArrayElement = 0;
+            UboWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+            UboWrites[i].descriptorCount = 1;
+            UboWrites[i].pBufferInfo = &BufferInfo;
         }
+        vkUpdateDescriptorSets(Device.LogicalDevice, 3, UboWrites, 0, nullptr);
+        VulkanUniformRingCountDescriptorUpdates(UniformRing, 3);
+    }
+
+    if (VkShader->bindless) {
+        // Один набор на все кадры: он охватывает все разделы кольца униформ. Буфер униформ шейдера остается
+        // промежуточной копией на CPU, поэтому запись, которую еще читают прошлые кадры, не перезаписывается.
+        AllocInfo.descriptorSetCount = 1;
+        AllocInfo.pSetLayouts = &VkShader->DescriptorSetLayouts[DESC_SET_INDEX_INSTANCE];
+        VK_CHECK(vkAllocateDescriptorSets(Device.LogicalDevice, &AllocInfo, &VkShader->MaterialDescriptorSet));
+
+        VkDescriptorBufferInfo BufferInfo;
+        BufferInfo.buffer = reinterpret_cast<VulkanBuffer*>(UniformRing.buffer.data)->handle;
+        BufferInfo.offset = 0;
+        BufferInfo.range = VK_WHOLE_SIZE;
 
-        vkUpdateDescriptorSets(Device.LogicalDevice, GlobalSetBindingCount, DescriptorWrites, 0, nullptr);
+        VkWriteDescriptorSet write = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+        write.dstSet = VkShader->MaterialDescriptorSet;
+        write.dstBinding = 0;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.descriptorCount = 1;
+        write.pBufferInfo = &BufferInfo;
+        vkUpdateDescriptorSets(Device.LogicalDevice, 1, &write, 0, nullptr);
     }
 
-    // Привяжите набор глобальных дескрипторов для обновления.
-    vkCmdBindDescriptorSets(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, VkShader->pipelines[VkShader->BoundPipelineIndex]->PipelineLayout, 0, 1, &GlobalDescriptor, 0, nullptr);
     return true;
 }
 
-bool VulkanAPI::ShaderApplyInstance(Shader *shader, bool NeedsUpdate)
+bool VulkanAPI::ShaderReload(Shader *shader)
 {
-    auto VkShader = shader->ShaderData;
-    if (VkShader->InstanceUniformCount < 1 && VkShader->InstanceUniformSamplerCount < 1) {
-        MERROR("Этот шейдер не использует экземпляры.");
+    if (!shader || !shader->ShaderData) {
+        MERROR("VulkanAPI::ShaderReload требуется действительный указатель на шейдер.");
         return false;
     }
-    
-    const auto& CommandBuffer = GraphicsCommandBuffers[ImageIndex].handle;
-
-    // Получите данные экземпляра.
-    auto& ObjectState = VkShader->InstanceStates[shader->BoundInstanceID];
-    const auto& ObjectDescriptorSet = ObjectState.DescriptorSetState.DescriptorSets[ImageIndex];
+    auto VkShader = shader->ShaderData;
 
-    if(NeedsUpdate) {
-        VkWriteDescriptorSet DescriptorWrites[2] {};  // Всегда максимум два набора дескрипторов.
-        u32 DescriptorCount = 0;
-        u32 DescriptorIndex = 0;
-        VkDescriptorBufferInfo BufferInfo;
-    
-        // Дескриптор 0 — универсальный буфер
-        if (VkShader->InstanceUniformCount > 0) {
-            // Делайте это только в том случае, если дескриптор еще не был обновлен.
-            u8& InstanceUboGeneration = ObjectState.DescriptorSetState.DescriptorStates[DescriptorIndex].generations[ImageIndex];
-            // ЗАДАЧА: определить, требуется ли обновление.
-            if (InstanceUboGeneration == INVALID::U8ID /*|| *global_ubo_generation != material->generation*/) {
-                BufferInfo.buffer = reinterpret_cast<VulkanBuffer*>(VkShader->UniformBuffer.data)->handle;
-                BufferInfo.offset = ObjectState.offset;
-                BufferInfo.range = shader->UboStride;
-        
-                VkWriteDescriptorSet UboDescriptor = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-                UboDescriptor.dstSet = ObjectDescriptorSet;
-                UboDescriptor.dstBinding = DescriptorIndex;
-                UboDescriptor.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-                UboDescriptor.descriptorCount = 1;
-                UboDescriptor.pBufferInfo = &BufferInfo;
-        
-                DescriptorWrites[DescriptorCount] = UboDescriptor;
-                DescriptorCount++;
-        
-                // Обновите генерацию кадра. В данном случае он нужен только один раз, поскольку это буфер.
-                InstanceUboGeneration = 1;  // material->generation; ЗАДАЧА: какое-то поколение откуда-то...
+    // Новые модули создаются до уничтожения старых, чтобы при ошибке шейдер продолжал работать в прежнем виде.
+    VulkanShaderStage NewStages[VulkanShaderConstants::MaxStages]{};
+    for (u32 i = 0; i < VkShader->config.StageCount; ++i) {
+        if (!CreateModule(VkShader, VkShader->config.stages[i], &NewStages[i])) {
+            MERROR("VulkanAPI::ShaderReload — не удалось создать модуль %s для «%s». Шейдер не изменен.", VkShader->config.stages[i].FileName, shader->name.c_str());
+            for (u32 j = 0; j < i; ++j) {
+                vkDestroyShaderModule(Device.LogicalDevice, NewStages[j].handle, allocator);
             }
-            DescriptorIndex++;
-        }
-
-        // Итерация сэмплеров.
-        if (VkShader->InstanceUniformSamplerCount > 0) {
-            const u8& SamplerBindingIndex = VkShader->config.DescriptorSets[DESC_SET_INDEX_INSTANCE].SamplerBindingIndex;
-            const u32& TotalSamplerCount = VkShader->config.DescriptorSets[DESC_SET_INDEX_INSTANCE].bindings[SamplerBindingIndex].descriptorCount;
-            u32 UpdateSamplerCount = 0;
-            VkDescriptorImageInfo ImageInfos[VulkanShaderConstants::MaxGlobalTextures]{};
-            for (u32 i = 0; i < TotalSamplerCount; ++i) {
-                // ЗАДАЧА: обновляйте список только в том случае, если оно действительно необходимо.
-                auto map = VkShader->InstanceStates[shader->BoundInstanceID].InstanceTextureMaps[i];
-                auto texture = map->texture;
-
-                // Убедитесь, что текстура верна.
-                if (texture->generation == INVALID::ID) {
-                    texture = TextureSystem::GetDefaultTexture(Texture::Default);
-                }
-
-                ImageInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                ImageInfos[i].imageView = reinterpret_cast<VulkanImage*>(texture->data)->view;
-                ImageInfos[i].sampler = reinterpret_cast<VkSampler>(map->sampler);
-    
-                // ЗАДАЧА: измените состояние дескриптора, чтобы справиться с этим должным образом.
-                // Синхронизировать генерацию кадров, если не используется текстура по умолчанию.
-                // if (t->generation != INVALID_ID) {
-                //     *descriptor_generation = t->generation;
-                //     *descriptor_id = t->id;
-                // }
-    
-                UpdateSamplerCount++;
+            return false;
+        }
+    }
+    VulkanShaderStage NewIndirectStage{};
+    if (VkShader->IndirectPipeline && !CreateModule(VkShader, VkShader->IndirectStageConfig, &NewIndirectStage)) {
+        MERROR("VulkanAPI::ShaderReload — не удалось создать модуль %s для «%s». Шейдер не изменен.", VkShader->IndirectStageConfig.FileName, shader->name.c_str());
+        for (u32 j = 0; j < VkShader->config.StageCount; ++j) {
+            vkDestroyShaderModule(Device.LogicalDevice, NewStages[j].handle, allocator);
+        }
+        return false;
+    }
+
+    // Старые конвейеры и модули могут использоваться кадрами, которые еще выполняются.
+    PipelinesWait(shader);
+    vkDeviceWaitIdle(Device.LogicalDevice);
+
+    const u32 PipelineCount = (Device.supportFlags & VulkanDevice::NativeDynamicTopologyBit) || (Device.supportFlags & VulkanDevice::DynamicTopologyBit) ? 3 : 6;
+    for (u32 i = 0; i < PipelineCount; ++i) {
+        if (VkShader->pipelines[i]) {
+            VkShader->pipelines[i]->Destroy(this);
+        }
+    }
+    for (u32 i = 0; i < VkShader->config.StageCount; ++i) {
+        vkDestroyShaderModule(Device.LogicalDevice, VkShader->stages[i].handle, allocator);
+        VkShader->stages[i] = NewStages[i];
+    }
+    if (VkShader->IndirectPipeline) {
+        VkShader->IndirectPipeline->Destroy(this);
+        vkDestroyShaderModule(Device.LogicalDevice, VkShader->IndirectStage.handle, allocator);
+        VkShader->IndirectStage = NewIndirectStage;
+    }
+
+    // Макеты наборов дескрипторов, пул и униформный буфер сохраняются, поэтому экземпляры материалов остаются действительными.
+    if (!CreatePipelines(shader, PipelineCount)) {
+        MERROR("VulkanAPI::ShaderReload — не удалось пересоздать конвейеры шейдера «%s».", shader->name.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool VulkanAPI::ShaderUse(Shader *shader)
+{
+    auto VkShader = reinterpret_cast<VulkanShader*>(shader->ShaderData);
+    if (VkShader->PendingBuild && !PipelinesWait(shader)) {
+        return false;
+    }
+    auto& CommandBuffer = CommandBufferGet();
+    VkShader->pipelines[VkShader->BoundPipelineIndex]->Bind(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS);
+    if (VkShader->bindless) {
+        // Наборы материалов и текстур привязываются один раз на шейдер, а не на каждый экземпляр.
+        const VkDescriptorSet sets[2] = { VkShader->MaterialDescriptorSet, BindlessTable.set };
+        vkCmdBindDescriptorSets(CommandBuffer.handle, VK_PIPELINE_BIND_POINT_GRAPHICS, VkShader->pipelines[VkShader->BoundPipelineIndex]->PipelineLayout, DESC_SET_INDEX_INSTANCE, 2, sets, 0, nullptr);
+    }
+    if (CurrentRecordingContext) {
+        CurrentRecordingContext->BoundShader = shader;
+    } else {
+        BoundShader = shader;
+    }
+
+    // Обязательно используйте текущий тип привязки.
+    if (Device.supportFlags & VulkanDevice::NativeDynamicTopologyBit) {
+        vkCmdSetPrimitiveTopology(CommandBuffer.handle, VkShader->CurrentTopology);
+    } else if (Device.supportFlags & VulkanDevice::DynamicTopologyBit) {
+        vkCmdSetPrimitiveTopologyEXT(CommandBuffer.handle, VkShader->CurrentTopology);
+    }
+    return true;
+}
+
+bool VulkanAPI::ShaderApplyGlobals(Shader *shader, bool NeedsUpdate)
+{
+    auto VkShader = shader->ShaderData;
+    if (VkShader->PendingBuild && !PipelinesWait(shader)) {
+        return false;
+    }
+    auto& CommandBuffer = CommandBufferGet().handle;
+    auto& GlobalDescriptor = VkShader->GlobalDescriptorSets[ImageIndex];
+
+    u32 DynamicOffsetCount = 0;
+    if (VkShader->GlobalUniformCount > 0) {
+        // Каждое обновление получает новый срез кольца: отрисовки, уже записанные в этом кадре, читают прежние значения.
+        if (NeedsUpdate || VkShader->GlobalRingFrame != UniformRing.FrameNumber) {
+            const u8* data = reinterpret_cast<u8*>(VkShader->MappedUniformBufferBlock) + shader->GlobalUboOffset;
+            if (!VulkanUniformRingPush(UniformRing, data, shader->GlobalUboSize, VkShader->GlobalRingOffset)) {
+                MERROR("VulkanAPI::ShaderApplyGlobals — кольцо униформ заполнено, глобальные переменные шейдера «%s» не применены.", shader->name.c_str());
+                return false;
             }
+            VkShader->GlobalRingFrame = UniformRing.FrameNumber;
+        }
+        DynamicOffsetCount = 1;
+    }
+
+    // Привяжите набор глобальных дескрипторов со смещением данных этого кадра.
+    vkCmdBindDescriptorSets(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, VkShader->pipelines[VkShader->BoundPipelineIndex]->PipelineLayout, 0, 1, &GlobalDescriptor, DynamicOffsetCount, &VkShader->GlobalRingOffset);
+    return true;
+}
+
+bool VulkanAPI::ShaderApplyInstance(Shader *shader, bool NeedsUpdate)
+{
+    auto VkShader = shader->ShaderData;
+    if (VkShader->InstanceUniformCount < 1 && VkShader->InstanceUniformSamplerCount < 1) {
+        MERROR("Этот шейдер не использует экземпляры.");
+        return false;
+    }
     
+    if (VkShader->PendingBuild && !PipelinesWait(shader)) {
+        return false;
+    }
+    const auto& CommandBuffer = CommandBufferGet().handle;
+
+    if (VkShader->bindless) {
+        auto& InstanceState = VkShader->InstanceStates[shader->BoundInstanceID];
+        if (NeedsUpdate && shader->InstanceTextureCount > 0) {
+            // Индексы текстур записываются за униформами экземпляра: слот изображения в младших 16 битах, сэмплер — в старших.
+            auto words = reinterpret_cast<u32*>(reinterpret_cast<u8*>(VkShader->MappedUniformBufferBlock) + InstanceState.offset + shader->UboSize);
+            const u32 DefaultSlot = reinterpret_cast<VulkanImage*>(TextureSystem::GetDefaultTexture(Texture::Default)->data)->BindlessIndex;
+            for (u32 i = 0; i < shader->InstanceTextureCount; ++i) {
+                auto map = InstanceState.InstanceTextureMaps[i];
+                u32 slot = map->texture->generation != INVALID::ID ? reinterpret_cast<VulkanImage*>(map->texture->data)->BindlessIndex : INVALID::ID;
+                if (slot >= BindlessTable.TextureCapacity) {
+                    slot = DefaultSlot;
+                }
+                words[i] = (slot & 0xFFFF) | (BindlessSamplerIndex(map) << 16);
+            }
+        }
+
+        // Запись копируется в раздел кольца текущего кадра, как униформы экземпляра без привязки:
+        // в пределах кадра срез переиспользуется, пока данные экземпляра не обновляются.
+        if (NeedsUpdate || InstanceState.RingFrame != UniformRing.FrameNumber) {
+            const u8* data = reinterpret_cast<u8*>(VkShader->MappedUniformBufferBlock) + InstanceState.offset;
+            if (!VulkanUniformRingPush(UniformRing, data, shader->UboSize + sizeof(u32) * shader->InstanceTextureCount, InstanceState.RingOffset)) {
+                MERROR("VulkanAPI::ShaderApplyInstance — кольцо униформ заполнено, запись материала шейдера «%s» не применена.", shader->name.c_str());
+                return false;
+            }
+            InstanceState.RingFrame = UniformRing.FrameNumber;
+        }
+
+        // Смена материала стоит одной push-константы вместо привязки набора дескрипторов.
+        const u32 MaterialWord = InstanceState.RingOffset / sizeof(u32);
+        vkCmdPushConstants(CommandBuffer, VkShader->pipelines[VkShader->BoundPipelineIndex]->PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, VULKAN_BINDLESS_PUSH_CONSTANT_OFFSET, sizeof(u32), &MaterialWord);
+        return true;
+    }
+
+    // Получите данные экземпляра.
+    auto& ObjectState = VkShader->InstanceStates[shader->BoundInstanceID];
+    const auto& ObjectDescriptorSet = ObjectState.DescriptorSetState.DescriptorSets[ImageIndex];
+
+    // Дескриптор 0 — универсальный буфер. Он указывает на кольцо униформ с момента получения экземпляра, здесь копируются только данные.
+    u32 DynamicOffsetCount = 0;
+    if (VkShader->InstanceUniformCount > 0) {
+        // В пределах кадра срез переиспользуется, пока данные экземпляра не обновляются.
+        if (NeedsUpdate || ObjectState.RingFrame != UniformRing.FrameNumber) {
+            const u8* data = reinterpret_cast<u8*>(VkShader->MappedUniformBufferBlock) + ObjectState.offset;
+            if (!VulkanUniformRingPush(UniformRing, data, shader->UboSize, ObjectState.RingOffset)) {
+                MERROR("VulkanAPI::ShaderApplyInstance — кольцо униформ заполнено, экземпляр шейдера «%s» не применен.", shader->name.c_str());
+                return false;
+            }
+            ObjectState.RingFrame = UniformRing.FrameNumber;
+        }
+        DynamicOffsetCount = 1;
+    }
+
+    // Итерация сэмплеров. Набор кадра перезаписывается, только если его текстуры или сэмплеры изменились.
+    if (NeedsUpdate && VkShader->InstanceUniformSamplerCount > 0) {
+        const u8& SamplerBindingIndex = VkShader->config.DescriptorSets[DESC_SET_INDEX_INSTANCE].SamplerBindingIndex;
+        const u32& TotalSamplerCount = VkShader->config.DescriptorSets[DESC_SET_INDEX_INSTANCE].bindings[SamplerBindingIndex].descriptorCount;
+        VkDescriptorImageInfo ImageInfos[VulkanShaderConstants::MaxInstanceTextures]{};
+        u64 SamplerKey = 14695981039346656037ULL;  // FNV-1a по представлениям, генерациям и сэмплерам.
+        for (u32 i = 0; i < TotalSamplerCount; ++i) {
+            auto map = ObjectState.InstanceTextureMaps[i];
+            auto texture = map->texture;
+
+            // Убедитесь, что текстура верна.
+            if (texture->generation == INVALID::ID) {
+                texture = TextureSystem::GetDefaultTexture(Texture::Default);
+            }
+
+            ImageInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            ImageInfos[i].imageView = reinterpret_cast<VulkanImage*>(texture->data)->view;
+            ImageInfos[i].sampler = reinterpret_cast<VkSampler>(map->sampler);
+
+            const u64 parts[3] = { reinterpret_cast<u64>(ImageInfos[i].imageView), texture->generation, reinterpret_cast<u64>(ImageInfos[i].sampler) };
+            for (u32 j = 0; j < 3; ++j) {
+                SamplerKey = (SamplerKey ^ parts[j]) * 1099511628211ULL;
+            }
+        }
+
+        u64& WrittenKey = ObjectState.SamplerKeys[ImageIndex];
+        if (SamplerKey != WrittenKey) {
             VkWriteDescriptorSet SamplerDescriptor = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
             SamplerDescriptor.dstSet = ObjectDescriptorSet;
-            SamplerDescriptor.dstBinding = DescriptorIndex;
+            SamplerDescriptor.dstBinding = SamplerBindingIndex;
             SamplerDescriptor.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            SamplerDescriptor.descriptorCount = UpdateSamplerCount;
+            SamplerDescriptor.descriptorCount = TotalSamplerCount;
             SamplerDescriptor.pImageInfo = ImageInfos;
-    
-            DescriptorWrites[DescriptorCount] = SamplerDescriptor;
-            DescriptorCount++;
-        }
-    
-        if (DescriptorCount > 0) {
-            vkUpdateDescriptorSets(Device.LogicalDevice, DescriptorCount, DescriptorWrites, 0, nullptr);
+
+            vkUpdateDescriptorSets(Device.LogicalDevice, 1, &SamplerDescriptor, 0, nullptr);
+            VulkanUniformRingCountDescriptorUpdates(UniformRing, 1);
+            WrittenKey = SamplerKey;
         }
     }
 
-    // Привяжите набор дескрипторов для обновления или на случай изменения шейдера.
-    vkCmdBindDescriptorSets(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, VkShader->pipelines[VkShader->BoundPipelineIndex]->PipelineLayout, 1, 1, &ObjectDescriptorSet, 0, 0/*nullptr*/);
+    // Привяжите набор дескрипторов со смещением данных экземпляра в этом кадре.
+    vkCmdBindDescriptorSets(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, VkShader->pipelines[VkShader->BoundPipelineIndex]->PipelineLayout, 1, 1, &ObjectDescriptorSet, DynamicOffsetCount, &ObjectState.RingOffset);
     return true;
 }
 
@@ -2008,6 +2380,11 @@ bool VulkanAPI::ShaderAcquireInstanceResources(Shader *shader, u32 TextureMapCou
         }
     }
 
+    // В режиме без привязки у экземпляра нет собственных наборов дескрипторов.
+    if (VkShader->bindless) {
+        return true;
+    }
+
     auto& SetState = InstanceState.DescriptorSetState;
 
     // Привязка каждого дескриптора в наборе
@@ -2039,6 +2416,29 @@ bool VulkanAPI::ShaderAcquireInstanceResources(Shader *shader, u32 TextureMapCou
         return false;
     }
 
+    InstanceState.RingFrame = 0;
+    MemorySystem::ZeroMem(InstanceState.SamplerKeys, sizeof(InstanceState.SamplerKeys));
+
+    if (VkShader->InstanceUniformCount > 0) {
+        // UBO экземпляра указывает на кольцо униформ один раз на все время жизни экземпляра.
+        VkDescriptorBufferInfo BufferInfo;
+        BufferInfo.buffer = reinterpret_cast<VulkanBuffer*>(UniformRing.buffer.data)->handle;
+        BufferInfo.offset = 0;
+        BufferInfo.range = shader->UboStride;
+
+        VkWriteDescriptorSet UboWrites[3];
+        for (u32 i = 0; i < 3; ++i) {
+            UboWrites[i] = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+            UboWrites[i].dstSet = InstanceState.DescriptorSetState.DescriptorSets[i];
+            UboWrites[i].dstBinding = 0;
+            UboWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+            UboWrites[i].descriptorCount = 1;
+            UboWrites[i].pBufferInfo = &BufferInfo;
+        }
+        vkUpdateDescriptorSets(Device.LogicalDevice, 3, UboWrites, 0, nullptr);
+        VulkanUniformRingCountDescriptorUpdates(UniformRing, 3);
+    }
+
     return true;
 }
 
@@ -2051,13 +2451,15 @@ bool VulkanAPI::ShaderReleaseInstanceResources(Shader *shader, u32 InstanceID)
     vkDeviceWaitIdle(Device.LogicalDevice);
 
     // 3 свободных набора дескрипторов (по одному на кадр)
-    VkResult result = vkFreeDescriptorSets(
-        Device.LogicalDevice,
-        VkShader->DescriptorPool,
-        3,
-        InstanceState.DescriptorSetState.DescriptorSets);
-    if (result != VK_SUCCESS) {
-        MERROR("Ошибка при освобождении наборов дескрипторов объекта шейдера!");
+    if (!VkShader->bindless) {
+        VkResult result = vkFreeDescriptorSets(
+            Device.LogicalDevice,
+            VkShader->DescriptorPool,
+            3,
+            InstanceState.DescriptorSetState.DescriptorSets);
+        if (result != VK_SUCCESS) {
+            MERROR("Ошибка при освобождении наборов дескрипторов объекта шейдера!");
+        }
     }
 
     // Уничтожить состояния дескриптора.
@@ -2136,6 +2538,199 @@ void VulkanAPI::FlagSetEnabled(RendererConfigFlags flag, bool enabled)
     RenderFlagChanged = true;
 }
 
+u8 VulkanAPI::RecordingContextCount()
+{
+    return RecordingContextsAvailable ? VULKAN_MAX_RECORDING_CONTEXTS : 0;
+}
+
+bool VulkanAPI::RecordingBegin(u8 context)
+{
+    if (!RecordingContextsAvailable || context >= VULKAN_MAX_RECORDING_CONTEXTS) {
+        MERROR("VulkanAPI::RecordingBegin: недопустимый контекст записи %u.", context);
+        return false;
+    }
+
+    auto& rc = RecordingContexts[context];
+    // Пул текущего кадра в полете свободен: Begin уже дождался его ограждения.
+    if (rc.FrameNumber != FrameNumber) {
+        VK_CHECK(vkResetCommandPool(Device.LogicalDevice, rc.pools[CurrentFrame], 0));
+        rc.FrameNumber = FrameNumber;
+        rc.UsedCount = 0;
+        rc.PassCount = 0;
+    }
+    rc.current = nullptr;
+    rc.BoundShader = nullptr;
+    rc.winding = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+    CurrentRecordingContext = &rc;
+    return true;
+}
+
+bool VulkanAPI::RecordingEnd(u8 context)
+{
+    auto& rc = RecordingContexts[context];
+    if (CurrentRecordingContext != &rc) {
+        MERROR("VulkanAPI::RecordingEnd: контекст записи %u не принадлежит этому потоку.", context);
+        return false;
+    }
+    if (rc.current) {
+        MWARN("VulkanAPI::RecordingEnd: проход рендеринга не был завершен, вторичный буфер закрывается принудительно.");
+        VulkanCommandBufferEnd(rc.current);
+        rc.current = nullptr;
+    }
+    CurrentRecordingContext = nullptr;
+    return true;
+}
+
+bool VulkanAPI::RecordingExecute(u8 ContextCount)
+{
+    auto& CommandBuffer = GraphicsCommandBuffers[ImageIndex];
+
+    for (u8 c = 0; c < ContextCount && c < VULKAN_MAX_RECORDING_CONTEXTS; ++c) {
+        auto& rc = RecordingContexts[c];
+        if (rc.FrameNumber != FrameNumber) {
+            continue;
+        }
+        for (u8 i = 0; i < rc.PassCount; ++i) {
+            auto& recorded = rc.passes[i];
+            VkRenderPassBeginInfo BeginInfo = {VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
+            BeginInfo.renderPass = recorded.renderpass;
+            BeginInfo.framebuffer = recorded.framebuffer;
+            BeginInfo.renderArea = recorded.RenderArea;
+            BeginInfo.clearValueCount = recorded.ClearValueCount;
+            BeginInfo.pClearValues = recorded.ClearValueCount > 0 ? recorded.ClearValues : nullptr;
+
+            // Метки времени пишутся в основной буфер: проход на GPU выполняется здесь, а не в потоке записи.
+            const u32 query = VulkanTimestampsBegin(this, Timestamps, CommandBuffer, recorded.name);
+            vkCmdBeginRenderPass(CommandBuffer.handle, &BeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+            vkCmdExecuteCommands(CommandBuffer.handle, 1, &recorded.secondary);
+            vkCmdEndRenderPass(CommandBuffer.handle);
+            VulkanTimestampsEnd(this, Timestamps, CommandBuffer, query);
+        }
+        rc.PassCount = 0;
+    }
+    return true;
+}
+
+u64 VulkanAPI::UploadTicket()
+{
+    return StagingRing.mapped ? VulkanStagingTicket(StagingRing) : 0;
+}
+
+u32 VulkanAPI::GpuPassTimings(GpuPassTiming *OutTimings, u32 MaxCount)
+{
+    return VulkanTimestampsQuery(Timestamps, OutTimings, MaxCount);
+}
+
+void VulkanAPI::UniformStats(UniformUploadStats &OutStats)
+{
+    OutStats = UniformRing.last;
+}
+
+bool VulkanAPI::GpuCullingUpload(const GpuCullInstance *instances, u32 count)
+{
+    return VulkanCullingUpload(this, Culling, instances, count);
+}
+
+void VulkanAPI::GpuCullingSetView(const Matrix4D &projection, const Matrix4D &view)
+{
+    VulkanCullingSetView(Culling, projection, view);
+}
+
+/// @brief Номер набора отсечения в конвейере косвенной отрисовки шейдера: после наборов шейдера и таблицы текстур, если она есть.
+static u32 CullingSetIndex(const VulkanShader* VkShader)
+{
+    return VkShader->bindless ? VULKAN_BINDLESS_SET_INDEX + 1 : VULKAN_CULLING_SET_INDEX;
+}
+
+bool VulkanAPI::GpuCullingDraw(u32 first, u32 count)
+{
+    auto shader = CurrentRecordingContext ? CurrentRecordingContext->BoundShader : BoundShader;
+    if (!Culling.supported || !shader) {
+        return false;
+    }
+    auto VkShader = shader->ShaderData;
+    if (VkShader->PendingBuild && !PipelinesWait(shader)) {
+        return false;
+    }
+    if (!VkShader->IndirectPipeline || !VkShader->IndirectPipeline->handle) {
+        return false;
+    }
+
+    auto& CommandBuffer = CommandBufferGet();
+    VkShader->IndirectPipeline->Bind(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS);
+    if (Device.supportFlags & VulkanDevice::NativeDynamicTopologyBit) {
+        vkCmdSetPrimitiveTopology(CommandBuffer.handle, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+    } else if (Device.supportFlags & VulkanDevice::DynamicTopologyBit) {
+        vkCmdSetPrimitiveTopologyEXT(CommandBuffer.handle, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+    }
+
+    // Наборы шейдера совместимы с обычным конвейером, поэтому остаются привязанными.
+    VulkanCullingDraw(this, Culling, CommandBuffer, VkShader->IndirectPipeline->PipelineLayout, CullingSetIndex(VkShader), first, count);
+
+    // Последующие обычные отрисовки продолжают с конвейером шейдера.
+    VkShader->pipelines[VkShader->BoundPipelineIndex]->Bind(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS);
+    if (Device.supportFlags & VulkanDevice::NativeDynamicTopologyBit) {
+        vkCmdSetPrimitiveTopology(CommandBuffer.handle, VkShader->CurrentTopology);
+    } else if (Device.supportFlags & VulkanDevice::DynamicTopologyBit) {
+        vkCmdSetPrimitiveTopologyEXT(CommandBuffer.handle, VkShader->CurrentTopology);
+    }
+    return true;
+}
+
+VulkanCommandBuffer &VulkanAPI::CommandBufferGet()
+{
+    if (CurrentRecordingContext && CurrentRecordingContext->current) {
+        return *CurrentRecordingContext->current;
+    }
+    return GraphicsCommandBuffers[ImageIndex];
+}
+
+bool VulkanAPI::CreateRecordingContexts()
+{
+    if (swapchain.MaxFramesInFlight > VULKAN_MAX_FRAMES_IN_FLIGHT) {
+        MWARN("Многопоточная запись команд отключена: слишком много кадров в полете (%u).", swapchain.MaxFramesInFlight);
+        return false;
+    }
+
+    // Пулы команд не потокобезопасны, поэтому у каждого контекста свои пулы, по одному на кадр в полете.
+    VkCommandPoolCreateInfo PoolCreateInfo = {VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+    PoolCreateInfo.queueFamilyIndex = Device.GraphicsQueueIndex;
+    PoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+    for (u8 c = 0; c < VULKAN_MAX_RECORDING_CONTEXTS; ++c) {
+        for (u8 f = 0; f < swapchain.MaxFramesInFlight; ++f) {
+            VkResult result = vkCreateCommandPool(Device.LogicalDevice, &PoolCreateInfo, allocator, &RecordingContexts[c].pools[f]);
+            if (!VulkanResultIsSuccess(result)) {
+                MERROR("Не удалось создать пул команд контекста записи: %s", VulkanResultString(result, true));
+                DestroyRecordingContexts();
+                return false;
+            }
+        }
+    }
+
+    MDEBUG("Созданы контексты записи команд Vulkan: %u.", VULKAN_MAX_RECORDING_CONTEXTS);
+    return true;
+}
+
+void VulkanAPI::DestroyRecordingContexts()
+{
+    for (u8 c = 0; c < VULKAN_MAX_RECORDING_CONTEXTS; ++c) {
+        auto& rc = RecordingContexts[c];
+        for (u8 f = 0; f < VULKAN_MAX_FRAMES_IN_FLIGHT; ++f) {
+            if (rc.pools[f]) {
+                // Уничтожение пула освобождает все выделенные из него буферы команд.
+                vkDestroyCommandPool(Device.LogicalDevice, rc.pools[f], allocator);
+                rc.pools[f] = 0;
+            }
+            rc.buffers[f].Clear();
+        }
+        rc.UsedCount = 0;
+        rc.PassCount = 0;
+        rc.FrameNumber = INVALID::U64ID;
+    }
+}
+
 void VulkanAPI::CreateCommandBuffers()
 {
     if (GraphicsCommandBuffers.Capacity() == 0) {
@@ -2160,6 +2755,190 @@ void VulkanAPI::CreateCommandBuffers()
     MDEBUG("Созданы командные буферы Vulkan.");
 }
 
+bool VulkanAPI::CreatePipelines(Shader *shader, u32 PipelineCount)
+{
+    auto VkShader = shader->ShaderData;
+
+    Clock timer;
+    timer.Start();
+
+    // ЗАДАЧА: Кажется неправильным иметь их здесь, по крайней мере, в таком виде. 
+    // Вероятно, следует настроить получение из какого-либо места вместо области просмотра.
+    VkViewport viewport;
+    viewport.x = 0.F;
+    viewport.y = (f32)FramebufferHeight;
+    viewport.width = (f32)FramebufferWidth;
+    viewport.height = -(f32)FramebufferHeight;
+    viewport.minDepth = 0.F;
+    viewport.maxDepth = 1.F;
+
+    // Scissor
+    VkRect2D scissor;
+    scissor.offset.x = scissor.offset.y = 0;
+    scissor.extent.width = FramebufferWidth;
+    scissor.extent.height = FramebufferHeight;
+
+    VkPipelineShaderStageCreateInfo StageCreateIfos[VulkanShaderConstants::MaxStages]{};
+    for (u32 i = 0; i < VkShader->config.StageCount; ++i) {
+        StageCreateIfos[i] = VkShader->stages[i].ShaderStageCreateInfo;
+    }
+
+    // В режиме без привязки к наборам шейдера добавляется таблица текстур, а к push-константам — индекс материала.
+    VkDescriptorSetLayout SetLayouts[4] = { VkShader->DescriptorSetLayouts[0], VkShader->DescriptorSetLayouts[1], BindlessTable.layout, VK_NULL_HANDLE };
+    const u32 SetLayoutCount = VkShader->config.DescriptorSetCount + (VkShader->bindless ? 1 : 0);
+    Range PushConstantRanges[33];
+    u32 PushConstantRangeCount = shader->PushConstantRangeCount;
+    for (u32 i = 0; i < PushConstantRangeCount; ++i) {
+        PushConstantRanges[i] = shader->PushConstantRanges[i];
+    }
+    if (VkShader->bindless) {
+        PushConstantRanges[PushConstantRangeCount++] = Range(VULKAN_BINDLESS_PUSH_CONSTANT_OFFSET, sizeof(u32));
+    }
+
+    // Пройти по циклу и настроить/создать один конвейер на класс. Нулевые записи пропускаются.
+    for (u32 i = 0; i < PipelineCount; ++i) {
+        if (!VkShader->pipelines[i]) {
+            continue;
+        }
+
+        VulkanPipeline::Config PipelineConfig {
+            shader->name,
+            VkShader->renderpass,
+            shader->AttributeStride,
+            (u32)shader->attributes.Length(),
+            VkShader->config.attributes,  // shader->attributes,
+            SetLayoutCount,
+            SetLayouts,
+            VkShader->config.StageCount,
+            StageCreateIfos,
+            viewport,
+            scissor,
+            VkShader->config.CullMode,
+            shader->flags,
+            PushConstantRangeCount,
+            PushConstantRanges,
+            shader->TopologyTypes
+        };
+
+        bool PipelineResult = VkShader->pipelines[i]->Create(this, PipelineConfig);
+
+        if (!PipelineResult) {
+            MERROR("Не удалось загрузить графический конвейер для шейдера: '%s'.", shader->name.c_str());
+            return false;
+        }
+    }
+
+    // Конвейер косвенной отрисовки: другой вершинный этап и набор отсечения после наборов шейдера.
+    // Наборы и push-константы шейдера совпадают, поэтому привязки обычного конвейера остаются действительными.
+    if (VkShader->IndirectPipeline) {
+        StageCreateIfos[VkShader->IndirectStageIndex] = VkShader->IndirectStage.ShaderStageCreateInfo;
+        const u32 CullingSet = CullingSetIndex(VkShader);
+        SetLayouts[CullingSet] = Culling.layout;
+        VulkanPipeline::Config IndirectConfig {
+            shader->name,
+            VkShader->renderpass,
+            shader->AttributeStride,
+            (u32)shader->attributes.Length(),
+            VkShader->config.attributes,
+            CullingSet + 1,
+            SetLayouts,
+            VkShader->config.StageCount,
+            StageCreateIfos,
+            viewport,
+            scissor,
+            VkShader->config.CullMode,
+            shader->flags,
+            PushConstantRangeCount,
+            PushConstantRanges,
+            PrimitiveTopology::TriangleList
+        };
+        if (!VkShader->IndirectPipeline->Create(this, IndirectConfig)) {
+            MWARN("Не удалось создать конвейер косвенной отрисовки для шейдера: '%s'. Геометрии будут рисоваться по одной.", shader->name.c_str());
+        }
+    }
+
+    // Может выполняться на потоках заданий, поэтому счетчики изменяются атомарно.
+    timer.Update();
+    __atomic_fetch_add(&PipelineBuildCount, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&PipelineBuildMicroseconds, (u64)(timer.elapsed * 1000000.0), __ATOMIC_RELAXED);
+    MDEBUG("Конвейеры шейдера «%s» созданы за %.2f мс.", shader->name.c_str(), timer.elapsed * 1000.0);
+
+    return true;
+}
+
+bool VulkanAPI::CreatePipelinesDeferred(Shader *shader, u32 PipelineCount)
+{
+    auto build = MemorySystem::TAllocate<VulkanPipelineBuild>(Memory::Renderer);
+    build->VkAPI = this;
+    build->shader = shader;
+    build->PipelineCount = PipelineCount;
+    build->state = VulkanPipelineBuild::Pending;
+    build->RefCount = 2; // Задание и шейдер.
+    shader->ShaderData->PendingBuild = build;
+
+    // Высокий приоритет: задание сразу уходит свободному потоку, если такой есть.
+    // Иначе оно ждет в очереди, а конвейеры при необходимости создаст основной поток.
+    Job::Info job { PipelineBuildJob, nullptr, nullptr, &build, sizeof(VulkanPipelineBuild*), 0, Job::General, Job::High };
+    JobSystem::Submit(job);
+    return true;
+}
+
+bool VulkanAPI::PipelineBuildJob(void *params, void *ResultData)
+{
+    auto build = *reinterpret_cast<VulkanPipelineBuild**>(params);
+    PipelineBuildRun(build);
+    PipelineBuildRelease(build);
+    return true;
+}
+
+void VulkanAPI::PipelineBuildRun(VulkanPipelineBuild *build)
+{
+    u32 expected = VulkanPipelineBuild::Pending;
+    if (!__atomic_compare_exchange_n(&build->state, &expected, (u32)VulkanPipelineBuild::Building, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    const bool result = build->VkAPI->CreatePipelines(build->shader, build->PipelineCount);
+    __atomic_store_n(&build->state, result ? (u32)VulkanPipelineBuild::Ready : (u32)VulkanPipelineBuild::Failed, __ATOMIC_RELEASE);
+}
+
+void VulkanAPI::PipelineBuildRelease(VulkanPipelineBuild *build)
+{
+    if (__atomic_sub_fetch(&build->RefCount, 1, __ATOMIC_ACQ_REL) == 0) {
+        MemorySystem::Free(build, sizeof(VulkanPipelineBuild), Memory::Renderer);
+    }
+}
+
+bool VulkanAPI::PipelinesWait(Shader *shader, bool cancel)
+{
+    auto VkShader = shader->ShaderData;
+    auto build = VkShader->PendingBuild;
+    if (!build) {
+        return true;
+    }
+
+    u32 expected = VulkanPipelineBuild::Pending;
+    if (cancel) {
+        __atomic_compare_exchange_n(&build->state, &expected, (u32)VulkanPipelineBuild::Cancelled, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    } else {
+        // Задание еще не начало сборку — выполнить ее здесь, а не ждать очереди.
+        PipelineBuildRun(build);
+    }
+
+    u32 state;
+    while ((state = __atomic_load_n(&build->state, __ATOMIC_ACQUIRE)) == VulkanPipelineBuild::Building) {
+        PlatformSleep(0);
+    }
+
+    VkShader->PendingBuild = nullptr;
+    PipelineBuildRelease(build);
+
+    if (state == VulkanPipelineBuild::Failed) {
+        MERROR("VulkanAPI::PipelinesWait — не удалось создать конвейеры шейдера «%s».", shader->name.c_str());
+        return false;
+    }
+    return true;
+}
+
 bool VulkanAPI::CreateModule(VulkanShader *shader, const VulkanShaderStageConfig& config, VulkanShaderStage *ShaderStage)
 {
     // Прочтите ресурс.
@@ -2257,23 +3036,24 @@ bool VulkanAPI::SetUniform(Shader *shader, Shader::Uniform *uniform, const void
     } else {
         if (uniform->scope == Shader::Scope::Local) {
             // Является локальным, использует push-константы. Сделайте это немедленно.
-            VkCommandBuffer CommandBuffer = GraphicsCommandBuffers[ImageIndex].handle;
+            if (VkShader->PendingBuild && !PipelinesWait(shader)) {
+                return false;
+            }
+            VkCommandBuffer CommandBuffer = CommandBufferGet().handle;
             vkCmdPushConstants(CommandBuffer, VkShader->pipelines[VkShader->BoundPipelineIndex]->PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, uniform->offset, uniform->size, value);
         } else {
-            // Сопоставьте подходящую ячейку памяти и скопируйте данные.
+            // Скопируйте данные в униформы шейдера. В кольцо униформ кадра они попадут при применении глобальных переменных или экземпляра.
             u64 addr = (u64)VkShader->MappedUniformBufferBlock;
             addr += shader->BoundUboOffset + uniform->offset;
             MemorySystem::CopyMem((void*)addr, value, uniform->size);
-            if (addr) {
-            }
         }
     }
     return true;
 }
 
-bool VulkanAPI::TextureMapAcquireResources(TextureMap *map)
+/// @brief Заполняет параметры сэмплера по фильтрам и режимам повтора карты текстуры.
+static VkSamplerCreateInfo SamplerCreateInfo(const TextureMap* map)
 {
-    // Создайте сэмплер для текстуры
     VkSamplerCreateInfo SamplerInfo = {VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
 
     SamplerInfo.minFilter = ConvertFilterType("min", map->FilterMinify);
@@ -2294,6 +3074,13 @@ bool VulkanAPI::TextureMapAcquireResources(TextureMap *map)
     SamplerInfo.mipLodBias = 0.F;
     SamplerInfo.minLod = 0.F;
     SamplerInfo.maxLod = 0.F;
+    return SamplerInfo;
+}
+
+bool VulkanAPI::TextureMapAcquireResources(TextureMap *map)
+{
+    // Создайте сэмплер для текстуры
+    const VkSamplerCreateInfo SamplerInfo = SamplerCreateInfo(map);
 
     VkResult result = vkCreateSampler(Device.LogicalDevice, &SamplerInfo, allocator, reinterpret_cast<VkSampler*>(&map->sampler));
     if (!VulkanResultIsSuccess(VK_SUCCESS)) {
@@ -2308,6 +3095,45 @@ bool VulkanAPI::TextureMapAcquireResources(TextureMap *map)
     return true;
 }
 
+void VulkanAPI::BindlessTextureRegister(Texture *texture)
+{
+    // Массив таблицы объявлен в шейдерах как texture2D, кубические карты в него не попадают.
+    if (!BindlessTable.set || !texture->data || texture->type != TextureType::_2D) {
+        return;
+    }
+    auto image = reinterpret_cast<VulkanImage*>(texture->data);
+    if (image->BindlessIndex == INVALID::ID) {
+        image->BindlessIndex = TextureSystem::AcquireBindlessSlot();
+        if (image->BindlessIndex == INVALID::ID) {
+            return;
+        }
+    }
+    VulkanBindlessWriteTexture(this, BindlessTable, image->BindlessIndex, image->view);
+}
+
+u32 VulkanAPI::BindlessSamplerIndex(const TextureMap *map)
+{
+    // 1 бит на каждый фильтр и 2 бита на каждую ось повтора: 256 сочетаний.
+    const u32 index =
+        (static_cast<u32>(map->FilterMinify) & 1) |
+        ((static_cast<u32>(map->FilterMagnify) & 1) << 1) |
+        (((static_cast<u32>(map->RepeatU) - 1) & 3) << 2) |
+        (((static_cast<u32>(map->RepeatV) - 1) & 3) << 4) |
+        (((static_cast<u32>(map->RepeatW) - 1) & 3) << 6);
+
+    if (!BindlessTable.samplers[index]) {
+        const VkSamplerCreateInfo SamplerInfo = SamplerCreateInfo(map);
+        VkSampler sampler;
+        VkResult result = vkCreateSampler(Device.LogicalDevice, &SamplerInfo, allocator, &sampler);
+        if (!VulkanResultIsSuccess(result)) {
+            MERROR("Ошибка создания сэмплера таблицы текстур: %s.", VulkanResultString(result, true));
+            return index;
+        }
+        VulkanBindlessWriteSampler(this, BindlessTable, index, sampler);
+    }
+    return index;
+}
+
 void VulkanAPI::TextureMapReleaseResources(TextureMap *map)
 {
     if (map) {
@@ -2486,7 +3312,8 @@ bool VulkanAPI::RenderBufferCreateInternal(RenderBuffer &buffer)
             break;
         case RenderBufferType::Uniform: {
             u32 DeviceLocalBits = Device.SupportsDeviceLocalHostVisible ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : 0;
-            InternalBuffer.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+            // Буфер хранения — для записей материалов шейдеров в режиме без привязки.
+            InternalBuffer.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
             InternalBuffer.MemoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | DeviceLocalBits;
         } break;
         case RenderBufferType::Staging:
@@ -2498,8 +3325,10 @@ bool VulkanAPI::RenderBufferCreateInternal(RenderBuffer &buffer)
             InternalBuffer.MemoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
             break;
         case RenderBufferType::Storage:
-            MERROR("Буфер хранения пока не поддерживается.");
-            return false;
+            // Буфер хранения в памяти устройства. Может служить источником команд косвенной отрисовки.
+            InternalBuffer.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+            InternalBuffer.MemoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+            break;
         default:
             MERROR("Неподдерживаемый тип буфера: %i", buffer.type);
             return false;
@@ -2761,6 +3590,11 @@ bool VulkanAPI::RenderBufferLoadRange(RenderBuffer &buffer, u64 offset, u64 size
 
     auto VkBuf = reinterpret_cast<VulkanBuffer*>(buffer.data);
     if (VulkanBufferIsDeviceLocal(VkBuf) && !VulkanBufferIsHostVisible(VkBuf)) {
+        // Копирование записывается в пакет загрузок кадра.
+        if (VulkanStagingUploadBuffer(this, StagingRing, VkBuf->handle, offset, size, data)) {
+            return true;
+        }
+
         // ПРИМЕЧАНИЕ: Если необходим промежуточный буфер (т.е. память целевого буфера не видна хосту, но является локальной для устройства), 
         // сначала создайте промежуточный буфер для загрузки данных. Затем скопируйте из него в целевой буфер.
 
@@ -2811,7 +3645,7 @@ bool VulkanAPI::RenderBufferCopyRange(RenderBuffer &source, u64 SourceOffset, Re
 
 bool VulkanAPI::RenderBufferDraw(RenderBuffer &buffer, u64 offset, u32 ElementCount, bool BindOnly)
 {
-    auto& CommandBuffer = GraphicsCommandBuffers[ImageIndex];
+    auto& CommandBuffer = CommandBufferGet();
 
     if (buffer.type == RenderBufferType::Vertex) {
         // Привязать буфер вершин по смещению.
@@ -2836,6 +3670,9 @@ bool VulkanAPI::RenderBufferDraw(RenderBuffer &buffer, u64 offset, u32 ElementCo
 
 bool VulkanAPI::VulkanBufferCopyRangeInternal(VkBuffer source, u64 SourceOffset, VkBuffer dest, u64 DestOffset, u64 size)
 {
+    // Записанные ранее загрузки в эти буферы должны выполниться раньше копирования.
+    VulkanStagingFlush(this, StagingRing, false);
+
     // ЗАДАЧА: Предполагая использование очереди и пула здесь. Возможно, понадобится выделенная очередь.
     auto queue = Device.GraphicsQueue;
     vkQueueWaitIdle(queue);
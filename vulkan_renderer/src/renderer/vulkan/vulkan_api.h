@@ -9,6 +9,14 @@
 #include "vulkan_command_buffer.hpp"
 #include "vulkan_shader.h"
 #include "vulkan_structs.h"
+#include "vulkan_recording.hpp"
+#include "vulkan_bindless.hpp"
+#include "vulkan_staging.hpp"
+#include "vulkan_readback.hpp"
+#include "vulkan_timestamps.hpp"
+#include "vulkan_culling.hpp"
+#include "vulkan_uniform_ring.hpp"
+#include "vulkan_deferred.hpp"
 #include "resources/geometry.h"
 #include "math/vertex.h"
 
@@ -65,7 +73,23 @@ public:
     VulkanGeometry geometries[VULKAN_MAX_GEOMETRY_COUNT]{};   // ЗАДАЧА: динамическим, копии геометрий хранятся в системе геометрий, возможно стоит хранить здесь указатели на геометрии
     RenderTarget WorldRenderTargets[3]{};               // Цели рендера, используемые для рендеринга мира, по одному на кадр.
     bool MultithreadingEnabled;                         // Указывает, поддерживает ли данное устройство многопоточность.
+    bool RecordingContextsAvailable;                    // Указывает, созданы ли контексты параллельной записи команд.
     struct Shader* BoundShader;                         // Указатель на текущий привязанный шейдер.
+    VulkanRecordingContext RecordingContexts[VULKAN_MAX_RECORDING_CONTEXTS]; // Контексты параллельной записи команд.
+    VkPipelineCache PipelineCache;                      // Кеш конвейеров, сохраняемый между запусками.
+    bool PipelineCacheWarm;                             // Указывает, был ли кеш конвейеров загружен из файла.
+    char PipelineCachePath[512];                        // Полный путь к файлу кеша конвейеров в каталоге ресурсов.
+    bool DeferPipelineCreation;                         // Указывает, создаются ли конвейеры на потоках заданий. Действует до первого кадра.
+    u32 PipelineBuildCount;                             // Количество созданных наборов конвейеров шейдеров.
+    u64 PipelineBuildMicroseconds;                      // Суммарное время создания конвейеров по всем потокам, в микросекундах.
+    VulkanBindlessTable BindlessTable;                  // Таблица текстур режима без привязки. Пуста, если устройство не поддерживает индексирование дескрипторов.
+    VulkanStagingRing StagingRing;                      // Промежуточное кольцо, через которое загрузки кадра отправляются одним пакетом.
+    VulkanReadbackQueue ReadbackQueue;                  // Очередь асинхронных чтений из GPU.
+    VulkanTimestamps Timestamps;                        // Метки времени проходов рендеринга.
+    u32 ActiveTimestampQuery;                           // Пара запросов прохода, записываемого в основной буфер. INVALID::ID вне прохода.
+    VulkanCulling Culling;                              // Отсечение по усеченной пирамиде на GPU и буферы косвенной отрисовки.
+    VulkanUniformRing UniformRing;                      // Кольцо униформ кадра: глобальные данные и данные экземпляров шейдеров.
+    VulkanDeferredQueue DeferredQueue;                  // Ресурсы, уничтожение которых ждет завершения кадров, использовавших их.
 
 public:
     /// @brief Инициализирует рендер.
@@ -94,8 +118,12 @@ public:
     void LoadTextureWriteable  (Texture* texture)                                         override;
     void TextureResize         (Texture* texture, u32 NewWidth, u32 NewHeight)            override;
     void TextureWriteData      (Texture* texture, u32 offset, u32 size, const u8* pixels) override;
+    void TextureWriteRegion    (Texture* texture, u32 x, u32 y, u32 width, u32 height, const u8* pixels) override;
     void TextureReadData       (Texture* texture, u32 offset, u32 size, void** OutMemory) override;
     void TextureReadPixel      (Texture* texture, u32 x, u32 y, u8** OutRgba)             override;
+    u64  TextureReadDataAsync  (Texture* texture, u32 offset, u32 size)                   override;
+    u64  TextureReadPixelAsync (Texture* texture, u32 x, u32 y)                           override;
+    ReadbackStatus ReadbackPoll(u64 ticket, void* OutMemory)                              override;
     void* TextureCopyData(const Texture* texture)                                         override;
     void Unload                (Texture* texture)                                         override;
 
@@ -114,6 +142,7 @@ public:
     bool Load                          (Shader *shader, const ShaderConfig& config, Renderpass* renderpass, const DArray<Shader::Stage>& stages, const DArray<MString>& StageFilenames) override;
     void Unload                        (Shader* shader)                                                                                                                                   override;
     bool ShaderInitialize              (Shader* shader)                                                                                                                                   override;
+    bool ShaderReload                  (Shader* shader)                                                                                                                                   override;
     bool ShaderUse                     (Shader* shader)                                                                                                                                   override;
     bool ShaderApplyGlobals            (Shader* shader, bool NeedsUpdate)                                                                                                                 override;
     bool ShaderApplyInstance           (Shader* shader, bool NeedsUpdate)                                                                                                                 override;
@@ -162,15 +191,55 @@ public:
     bool FlagEnabled   (RendererConfigFlags flag)               override;
     void FlagSetEnabled(RendererConfigFlags flag, bool enabled) override;
 
+    u8 RecordingContextCount()           override;
+    bool RecordingBegin(u8 context)      override;
+    bool RecordingEnd(u8 context)        override;
+    bool RecordingExecute(u8 ContextCount) override;
+    u64 UploadTicket()                   override;
+    u32 GpuPassTimings(GpuPassTiming* OutTimings, u32 MaxCount) override;
+    void UniformStats(UniformUploadStats& OutStats) override;
+    bool GpuCullingUpload(const GpuCullInstance* instances, u32 count) override;
+    void GpuCullingSetView(const Matrix4D& projection, const Matrix4D& view) override;
+    bool GpuCullingDraw(u32 first, u32 count) override;
+
     PFN_vkCmdSetPrimitiveTopologyEXT vkCmdSetPrimitiveTopologyEXT;
     PFN_vkCmdSetFrontFaceEXT vkCmdSetFrontFaceEXT;
 
 private:
     void CreateCommandBuffers();
+    /// @brief Возвращает буфер команд, в который записывает вызывающий поток: вторичный буфер
+    /// текущего контекста записи, если он есть, иначе основной буфер команд кадра.
+    VulkanCommandBuffer& CommandBufferGet();
+    bool CreateRecordingContexts();
+    void DestroyRecordingContexts();
     bool RecreateSwapchain();
     bool CreateModule(VulkanShader* shader, const VulkanShaderStageConfig& config, VulkanShaderStage* ShaderStage);
+    /// @brief Создает конвейеры шейдера для всех поддерживаемых классов топологии из текущих модулей этапов.
+    bool CreatePipelines(Shader* shader, u32 PipelineCount);
+    /// @brief Создает конвейеры шейдера на потоке заданий. Пока они не готовы, шейдер помечен незавершенной сборкой.
+    bool CreatePipelinesDeferred(Shader* shader, u32 PipelineCount);
+    /// @brief Дожидается конвейеров шейдера или создает их сам, если задание еще не взялось за них.
+    /// @param cancel если true, еще не начатая сборка отменяется вместо выполнения.
+    /// @return true, если конвейеры готовы (или сборка отменена); в противном случае false.
+    bool PipelinesWait(Shader* shader, bool cancel = false);
+    /// @brief Точка входа задания, создающего конвейеры шейдера.
+    static bool PipelineBuildJob(void* params, void* ResultData);
+    /// @brief Выполняет сборку, если ее состояние удалось перевести из Pending в Building.
+    static void PipelineBuildRun(VulkanPipelineBuild* build);
+    /// @brief Освобождает запись сборки, если вызывающий — ее последний владелец.
+    static void PipelineBuildRelease(VulkanPipelineBuild* build);
+
+    /// @brief Выделяет изображению текстуры слот в таблице режима без привязки (если его еще нет) и записывает в него представление.
+    void BindlessTextureRegister(Texture* texture);
+    /// @brief Возвращает индекс сэмплера карты текстуры в таблице режима без привязки, создавая сэмплер при первом обращении.
+    /// Индекс составлен из фильтров и режимов повтора, поэтому карты с одинаковыми параметрами разделяют сэмплер.
+    u32 BindlessSamplerIndex(const TextureMap* map);
 
     bool CreateVulkanAllocator(VkAllocationCallbacks* callbacks);
 
+    /// @brief Загружает пиксели во все изображение текстуры через промежуточное кольцо. Если данные не помещаются
+    /// в раздел кольца, использует отдельный промежуточный буфер и ожидает завершения копирования.
+    /// @param IsNew изображение только что создано и еще не использовалось.
+    void TextureUpload(Texture* texture, u32 size, const u8* pixels, bool IsNew);
     bool VulkanBufferCopyRangeInternal(VkBuffer source, u64 SourceOffset, VkBuffer dest, u64 DestOffset, u64 size);
 };
@@ -0,0 +1,141 @@
+#include "vulkan_bindless.hpp"
+#include "vulkan_api.h"
+#include "vulkan_utils.h"
+
+bool VulkanBindlessCreate(VulkanAPI *VkAPI, u32 TextureCapacity, VulkanBindlessTable &OutTable)
+{
+    auto& LogicalDevice = VkAPI->Device.LogicalDevice;
+
+    // Ограничения для дескрипторов, обновляемых после привязки, отличаются от обычных.
+    VkPhysicalDeviceDescriptorIndexingProperties IndexingProperties = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES};
+    VkPhysicalDeviceProperties2 properties2 = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2};
+    properties2.pNext = &IndexingProperties;
+    vkGetPhysicalDeviceProperties2(VkAPI->Device.PhysicalDevice, &properties2);
+
+    TextureCapacity = MMIN(TextureCapacity, IndexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages);
+    TextureCapacity = MMIN(TextureCapacity, IndexingProperties.maxDescriptorSetUpdateAfterBindSampledImages);
+    if (TextureCapacity == 0 || IndexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers < VULKAN_BINDLESS_MAX_SAMPLERS) {
+        MWARN("VulkanBindlessCreate — ограничения устройства недостаточны для режима без привязки.");
+        return false;
+    }
+    OutTable.TextureCapacity = TextureCapacity;
+
+    VkDescriptorSetLayoutBinding bindings[2]{};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    bindings[0].descriptorCount = TextureCapacity;
+    bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+    bindings[1].descriptorCount = VULKAN_BINDLESS_MAX_SAMPLERS;
+    bindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    // Незаписанные слоты допустимы, пока шейдер к ним не обращается.
+    const VkDescriptorBindingFlags BindingFlags[2] = {
+        VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT,
+        VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+    };
+    VkDescriptorSetLayoutBindingFlagsCreateInfo BindingFlagsInfo = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO};
+    BindingFlagsInfo.bindingCount = 2;
+    BindingFlagsInfo.pBindingFlags = BindingFlags;
+
+    VkDescriptorSetLayoutCreateInfo LayoutInfo = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+    LayoutInfo.pNext = &BindingFlagsInfo;
+    LayoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    LayoutInfo.bindingCount = 2;
+    LayoutInfo.pBindings = bindings;
+    VkResult result = vkCreateDescriptorSetLayout(LogicalDevice, &LayoutInfo, VkAPI->allocator, &OutTable.layout);
+    if (!VulkanResultIsSuccess(result)) {
+        MERROR("VulkanBindlessCreate — не удалось создать макет набора дескрипторов: '%s'", VulkanResultString(result, true));
+        return false;
+    }
+
+    const VkDescriptorPoolSize PoolSizes[2] = {
+        {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, TextureCapacity},
+        {VK_DESCRIPTOR_TYPE_SAMPLER, VULKAN_BINDLESS_MAX_SAMPLERS}
+    };
+    VkDescriptorPoolCreateInfo PoolInfo = {VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+    PoolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    PoolInfo.maxSets = 1;
+    PoolInfo.poolSizeCount = 2;
+    PoolInfo.pPoolSizes = PoolSizes;
+    result = vkCreateDescriptorPool(LogicalDevice, &PoolInfo, VkAPI->allocator, &OutTable.pool);
+    if (!VulkanResultIsSuccess(result)) {
+        MERROR("VulkanBindlessCreate — не удалось создать пул дескрипторов: '%s'", VulkanResultString(result, true));
+        VulkanBindlessDestroy(VkAPI, OutTable);
+        return false;
+    }
+
+    VkDescriptorSetAllocateInfo AllocInfo = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+    AllocInfo.descriptorPool = OutTable.pool;
+    AllocInfo.descriptorSetCount = 1;
+    AllocInfo.pSetLayouts = &OutTable.layout;
+    result = vkAllocateDescriptorSets(LogicalDevice, &AllocInfo, &OutTable.set);
+    if (!VulkanResultIsSuccess(result)) {
+        MERROR("VulkanBindlessCreate — не удалось выделить набор дескрипторов: '%s'", VulkanResultString(result, true));
+        VulkanBindlessDestroy(VkAPI, OutTable);
+        return false;
+    }
+
+    MINFO("Режим без привязки: %u слотов текстур, %u сэмплеров.", TextureCapacity, VULKAN_BINDLESS_MAX_SAMPLERS);
+    return true;
+}
+
+void VulkanBindlessDestroy(VulkanAPI *VkAPI, VulkanBindlessTable &table)
+{
+    auto& LogicalDevice = VkAPI->Device.LogicalDevice;
+    for (u32 i = 0; i < VULKAN_BINDLESS_MAX_SAMPLERS; ++i) {
+        if (table.samplers[i]) {
+            vkDestroySampler(LogicalDevice, table.samplers[i], VkAPI->allocator);
+            table.samplers[i] = VK_NULL_HANDLE;
+        }
+    }
+    // Набор освобождается вместе с пулом.
+    if (table.pool) {
+        vkDestroyDescriptorPool(LogicalDevice, table.pool, VkAPI->allocator);
+        table.pool = VK_NULL_HANDLE;
+        table.set = VK_NULL_HANDLE;
+    }
+    if (table.layout) {
+        vkDestroyDescriptorSetLayout(LogicalDevice, table.layout, VkAPI->allocator);
+        table.layout = VK_NULL_HANDLE;
+    }
+    table.TextureCapacity = 0;
+}
+
+void VulkanBindlessWriteTexture(VulkanAPI *VkAPI, VulkanBindlessTable &table, u32 slot, VkImageView view)
+{
+    if (!table.set || slot >= table.TextureCapacity) {
+        return;
+    }
+
+    VkDescriptorImageInfo ImageInfo{};
+    ImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    ImageInfo.imageView = view;
+
+    VkWriteDescriptorSet write = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+    write.dstSet = table.set;
+    write.dstBinding = 0;
+    write.dstArrayElement = slot;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    write.descriptorCount = 1;
+    write.pImageInfo = &ImageInfo;
+    vkUpdateDescriptorSets(VkAPI->Device.LogicalDevice, 1, &write, 0, nullptr);
+}
+
+void VulkanBindlessWriteSampler(VulkanAPI *VkAPI, VulkanBindlessTable &table, u32 index, VkSampler sampler)
+{
+    table.samplers[index] = sampler;
+
+    VkDescriptorImageInfo ImageInfo{};
+    ImageInfo.sampler = sampler;
+
+    VkWriteDescriptorSet write = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+    write.dstSet = table.set;
+    write.dstBinding = 1;
+    write.dstArrayElement = index;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+    write.descriptorCount = 1;
+    write.pImageInfo = &ImageInfo;
+    vkUpdateDescriptorSets(VkAPI->Device.LogicalDevice, 1, &write, 0, nullptr);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <defines.h>
+
+class VulkanAPI;
+
+constexpr u32 VULKAN_BINDLESS_MAX_SAMPLERS = 256;           // Количество сочетаний фильтров и режимов повтора карты текстуры, см. VulkanAPI::BindlessSamplerIndex.
+constexpr u32 VULKAN_BINDLESS_SET_INDEX = 2;                // Индекс набора таблицы текстур в макете конвейера. 0 — глобальный набор, 1 — набор материалов шейдера.
+constexpr u32 VULKAN_BINDLESS_PUSH_CONSTANT_OFFSET = 124;   // Смещение push-константы с индексом записи материала: последние 4 из гарантированных 128 байт.
+
+/// @brief Таблица текстур режима без привязки (bindless). Один набор дескрипторов на все шейдеры:
+/// привязка 0 — массив изображений, индексируемый слотами TextureSystem, привязка 1 — массив сэмплеров.
+/// Дескрипторы можно обновлять после привязки набора, поэтому загрузка текстуры не требует его пересоздания.
+struct VulkanBindlessTable {
+    VkDescriptorSetLayout layout;
+    VkDescriptorPool pool;
+    VkDescriptorSet set;
+    u32 TextureCapacity;                                    // Размер массива изображений. Слоты за его пределами не используются.
+    VkSampler samplers[VULKAN_BINDLESS_MAX_SAMPLERS];       // Сэмплеры, созданные по требованию. VK_NULL_HANDLE, если еще не создан.
+
+    constexpr VulkanBindlessTable() : layout(), pool(), set(), TextureCapacity(), samplers() {}
+};
+
+/// @brief Создает таблицу текстур. Вызывается, только если устройство поддерживает индексирование дескрипторов.
+/// @param VkAPI указатель на Vulkan.
+/// @param TextureCapacity желаемый размер массива изображений; уменьшается до ограничений устройства.
+/// @param OutTable таблица текстур.
+/// @return true в случае успеха; в противном случае false.
+bool VulkanBindlessCreate(VulkanAPI* VkAPI, u32 TextureCapacity, VulkanBindlessTable& OutTable);
+
+/// @brief Уничтожает таблицу текстур и созданные ею сэмплеры.
+/// @param VkAPI указатель на Vulkan.
+/// @param table таблица текстур.
+void VulkanBindlessDestroy(VulkanAPI* VkAPI, VulkanBindlessTable& table);
+
+/// @brief Записывает представление изображения в слот таблицы.
+/// @param VkAPI указатель на Vulkan.
+/// @param table таблица текстур.
+/// @param slot слот, выделенный TextureSystem::AcquireBindlessSlot.
+/// @param view представление изображения.
+void VulkanBindlessWriteTexture(VulkanAPI* VkAPI, VulkanBindlessTable& table, u32 slot, VkImageView view);
+
+/// @brief Записывает сэмплер в таблицу. Таблица становится его владельцем.
+/// @param VkAPI указатель на Vulkan.
+/// @param table таблица текстур.
+/// @param index индекс сэмплера.
+/// @param sampler сэмплер.
+void VulkanBindlessWriteSampler(VulkanAPI* VkAPI, VulkanBindlessTable& table, u32 index, VkSampler sampler);
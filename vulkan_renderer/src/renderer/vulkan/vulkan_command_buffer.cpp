@@ -51,6 +51,22 @@ void VulkanCommandBufferBegin(VulkanCommandBuffer *CommandBuffer, bool IsSingleU
     CommandBuffer->state = COMMAND_BUFFER_STATE_RECORDING;
 }
 
+void VulkanCommandBufferBeginSecondary(VulkanCommandBuffer *CommandBuffer, VkRenderPass renderpass, VkFramebuffer framebuffer)
+{
+    // Вторичный буфер наследует проход рендеринга, в котором его выполнит основной буфер.
+    VkCommandBufferInheritanceInfo InheritanceInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO};
+    InheritanceInfo.renderPass = renderpass;
+    InheritanceInfo.subpass = 0;
+    InheritanceInfo.framebuffer = framebuffer;
+
+    VkCommandBufferBeginInfo BeginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    BeginInfo.pInheritanceInfo = &InheritanceInfo;
+
+    VK_CHECK(vkBeginCommandBuffer(CommandBuffer->handle, &BeginInfo));
+    CommandBuffer->state = COMMAND_BUFFER_STATE_IN_RENDER_PASS;
+}
+
 void VulkanCommandBufferEnd(VulkanCommandBuffer *CommandBuffer)
 {
     VK_CHECK(vkEndCommandBuffer(CommandBuffer->handle));
@@ -48,6 +48,16 @@ void VulkanCommandBufferBegin(
     bool IsSimultaneousUse
 );
 
+/// @brief Начинает запись вторичного буфера команд, целиком находящегося внутри прохода рендеринга.
+/// @param CommandBuffer вторичный буфер команд.
+/// @param renderpass проход рендеринга, в котором будет выполнен буфер.
+/// @param framebuffer кадровый буфер прохода. Может быть VK_NULL_HANDLE, если неизвестен.
+void VulkanCommandBufferBeginSecondary(
+    VulkanCommandBuffer* CommandBuffer,
+    VkRenderPass renderpass,
+    VkFramebuffer framebuffer
+);
+
 void VulkanCommandBufferEnd(VulkanCommandBuffer* CommandBuffer);
 
 void VulkanCommandBufferUpdateSubmitted(VulkanCommandBuffer* CommandBuffer);
@@ -0,0 +1,381 @@
+#include "vulkan_culling.hpp"
+#include "vulkan_api.h"
+#include "vulkan_utils.h"
+#include "math/frustrum.h"
+#include "resources/geometry.h"
+#include "systems/resource_system.h"
+
+/// @brief Указывает, совпадают ли записи экземпляров.
+static bool CullInstanceEqual(const VulkanCullInstance& a, const VulkanCullInstance& b)
+{
+    for (u32 i = 0; i < 16; ++i) {
+        if (a.model.data[i] != b.model.data[i]) {
+            return false;
+        }
+    }
+    return a.bounds.x == b.bounds.x && a.bounds.y == b.bounds.y && a.bounds.z == b.bounds.z && a.bounds.w == b.bounds.w &&
+           a.IndexCount == b.IndexCount && a.FirstIndex == b.FirstIndex && a.VertexOffset == b.VertexOffset;
+}
+
+/// @brief Создает вычислительный конвейер отсечения из SPIR-V, загружаемого системой ресурсов.
+static bool CullingPipelineCreate(VulkanAPI *VkAPI, VulkanCulling &culling)
+{
+    auto& LogicalDevice = VkAPI->Device.LogicalDevice;
+
+    BinaryResource BinRes;
+    if (!ResourceSystem::Load(VULKAN_CULLING_SHADER_FILE, eResource::Type::Binary, nullptr, BinRes)) {
+        MWARN("VulkanCullingCreate — не удалось прочитать шейдер отсечения: %s.", VULKAN_CULLING_SHADER_FILE);
+        return false;
+    }
+    VkShaderModuleCreateInfo ModuleInfo = {VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
+    ModuleInfo.codeSize = BinRes.data.Length();
+    ModuleInfo.pCode = reinterpret_cast<u32*>(BinRes.data.Data());
+    VkResult result = vkCreateShaderModule(LogicalDevice, &ModuleInfo, VkAPI->allocator, &culling.module);
+    ResourceSystem::Unload(BinRes);
+    if (!VulkanResultIsSuccess(result)) {
+        MERROR("VulkanCullingCreate — не удалось создать модуль шейдера: '%s'", VulkanResultString(result, true));
+        return false;
+    }
+
+    VkPushConstantRange range{};
+    range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    range.offset = 0;
+    range.size = sizeof(VulkanCullPushConstants);
+
+    VkPipelineLayoutCreateInfo LayoutInfo = {VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+    LayoutInfo.setLayoutCount = 1;
+    LayoutInfo.pSetLayouts = &culling.layout;
+    LayoutInfo.pushConstantRangeCount = 1;
+    LayoutInfo.pPushConstantRanges = &range;
+    result = vkCreatePipelineLayout(LogicalDevice, &LayoutInfo, VkAPI->allocator, &culling.PipelineLayout);
+    if (!VulkanResultIsSuccess(result)) {
+        MERROR("VulkanCullingCreate — не удалось создать макет конвейера: '%s'", VulkanResultString(result, true));
+        return false;
+    }
+
+    VkComputePipelineCreateInfo PipelineInfo = {VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
+    PipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    PipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    PipelineInfo.stage.module = culling.module;
+    PipelineInfo.stage.pName = "main";
+    PipelineInfo.layout = culling.PipelineLayout;
+    result = vkCreateComputePipelines(LogicalDevice, VkAPI->PipelineCache, 1, &PipelineInfo, VkAPI->allocator, &culling.pipeline);
+    if (!VulkanResultIsSuccess(result)) {
+        MERROR("VulkanCullingCreate — не удалось создать вычислительный конвейер: '%s'", VulkanResultString(result, true));
+        return false;
+    }
+    VK_SET_DEBUG_OBJECT_NAME(VkAPI, VK_OBJECT_TYPE_PIPELINE, culling.pipeline, "pipeline_gpu_culling");
+    return true;
+}
+
+/// @brief Создает макет, пул и наборы дескрипторов, по одному набору на кадр в полете.
+static bool CullingDescriptorsCreate(VulkanAPI *VkAPI, VulkanCulling &culling)
+{
+    auto& LogicalDevice = VkAPI->Device.LogicalDevice;
+
+    // Экземпляры читает и вычислительный шейдер, и вершинный шейдер косвенной отрисовки.
+    VkDescriptorSetLayoutBinding bindings[2]{};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT;
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[1].descriptorCount = 1;
+    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo LayoutInfo = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+    LayoutInfo.bindingCount = 2;
+    LayoutInfo.pBindings = bindings;
+    VkResult result = vkCreateDescriptorSetLayout(LogicalDevice, &LayoutInfo, VkAPI->allocator, &culling.layout);
+    if (!VulkanResultIsSuccess(result)) {
+        MERROR("VulkanCullingCreate — не удалось создать макет набора дескрипторов: '%s'", VulkanResultString(result, true));
+        return false;
+    }
+
+    const VkDescriptorPoolSize PoolSize = {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 * culling.FrameCount};
+    VkDescriptorPoolCreateInfo PoolInfo = {VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+    PoolInfo.maxSets = culling.FrameCount;
+    PoolInfo.poolSizeCount = 1;
+    PoolInfo.pPoolSizes = &PoolSize;
+    result = vkCreateDescriptorPool(LogicalDevice, &PoolInfo, VkAPI->allocator, &culling.pool);
+    if (!VulkanResultIsSuccess(result)) {
+        MERROR("VulkanCullingCreate — не удалось создать пул дескрипторов: '%s'", VulkanResultString(result, true));
+        return false;
+    }
+
+    VkDescriptorSetLayout layouts[VULKAN_MAX_FRAMES_IN_FLIGHT] = { culling.layout, culling.layout, culling.layout };
+    VkDescriptorSetAllocateInfo AllocInfo = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+    AllocInfo.descriptorPool = culling.pool;
+    AllocInfo.descriptorSetCount = culling.FrameCount;
+    AllocInfo.pSetLayouts = layouts;
+    result = vkAllocateDescriptorSets(LogicalDevice, &AllocInfo, culling.sets);
+    if (!VulkanResultIsSuccess(result)) {
+        MERROR("VulkanCullingCreate — не удалось выделить наборы дескрипторов: '%s'", VulkanResultString(result, true));
+        return false;
+    }
+
+    for (u32 i = 0; i < culling.FrameCount; ++i) {
+        VkDescriptorBufferInfo BufferInfos[2]{};
+        BufferInfos[0].buffer = reinterpret_cast<VulkanBuffer*>(culling.InstanceBuffer.data)->handle;
+        BufferInfos[0].range = VK_WHOLE_SIZE;
+        BufferInfos[1].buffer = reinterpret_cast<VulkanBuffer*>(culling.CommandBuffers[i].data)->handle;
+        BufferInfos[1].range = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet writes[2]{};
+        for (u32 b = 0; b < 2; ++b) {
+            writes[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[b].dstSet = culling.sets[i];
+            writes[b].dstBinding = b;
+            writes[b].descriptorCount = 1;
+            writes[b].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[b].pBufferInfo = &BufferInfos[b];
+        }
+        vkUpdateDescriptorSets(LogicalDevice, 2, writes, 0, nullptr);
+    }
+    return true;
+}
+
+bool VulkanCullingCreate(VulkanAPI *VkAPI, VulkanCulling &OutCulling)
+{
+    const auto& features = VkAPI->Device.features;
+    // Номер экземпляра в команде — индекс записи, по которому вершинный шейдер находит матрицу модели.
+    if (!features.drawIndirectFirstInstance) {
+        MWARN("VulkanCullingCreate — устройство не поддерживает drawIndirectFirstInstance, отсечение на GPU отключено.");
+        return false;
+    }
+    OutCulling.MultiDraw = features.multiDrawIndirect;
+    OutCulling.FrameCount = MMIN((u32)VkAPI->swapchain.MaxFramesInFlight, (u32)VULKAN_MAX_FRAMES_IN_FLIGHT);
+
+    const u64 InstanceSize = sizeof(VulkanCullInstance) * VULKAN_CULLING_MAX_INSTANCES;
+    if (!VkAPI->RenderBufferCreate("renderbuffer_culling_instances", RenderBufferType::Storage, InstanceSize, false, OutCulling.InstanceBuffer) ||
+        !VkAPI->RenderBufferCreate("renderbuffer_culling_staging", RenderBufferType::Staging, InstanceSize * OutCulling.FrameCount, false, OutCulling.StagingBuffer)) {
+        MERROR("VulkanCullingCreate — не удалось создать буферы экземпляров.");
+        VulkanCullingDestroy(VkAPI, OutCulling);
+        return false;
+    }
+    VkAPI->RenderBufferBind(OutCulling.InstanceBuffer, 0);
+    VkAPI->RenderBufferBind(OutCulling.StagingBuffer, 0);
+    OutCulling.StagingMapped = reinterpret_cast<u8*>(VkAPI->RenderBufferMapMemory(OutCulling.StagingBuffer, 0, VK_WHOLE_SIZE));
+
+    for (u32 i = 0; i < OutCulling.FrameCount; ++i) {
+        if (!VkAPI->RenderBufferCreate("renderbuffer_culling_commands", RenderBufferType::Storage, VULKAN_CULLING_COMMAND_STRIDE * VULKAN_CULLING_MAX_INSTANCES, false, OutCulling.CommandBuffers[i])) {
+            MERROR("VulkanCullingCreate — не удалось создать буфер команд косвенной отрисовки.");
+            VulkanCullingDestroy(VkAPI, OutCulling);
+            return false;
+        }
+        VkAPI->RenderBufferBind(OutCulling.CommandBuffers[i], 0);
+    }
+
+    if (!CullingDescriptorsCreate(VkAPI, OutCulling) || !CullingPipelineCreate(VkAPI, OutCulling)) {
+        VulkanCullingDestroy(VkAPI, OutCulling);
+        return false;
+    }
+
+    OutCulling.instances.Resize(VULKAN_CULLING_MAX_INSTANCES);
+    OutCulling.supported = true;
+    MINFO("Отсечение на GPU: до %u экземпляров, %s.", VULKAN_CULLING_MAX_INSTANCES,
+          OutCulling.MultiDraw ? "одна косвенная отрисовка на партию" : "косвенная отрисовка по одной команде");
+    return true;
+}
+
+void VulkanCullingDestroy(VulkanAPI *VkAPI, VulkanCulling &culling)
+{
+    auto& LogicalDevice = VkAPI->Device.LogicalDevice;
+    if (culling.pipeline) {
+        vkDestroyPipeline(LogicalDevice, culling.pipeline, VkAPI->allocator);
+        culling.pipeline = VK_NULL_HANDLE;
+    }
+    if (culling.PipelineLayout) {
+        vkDestroyPipelineLayout(LogicalDevice, culling.PipelineLayout, VkAPI->allocator);
+        culling.PipelineLayout = VK_NULL_HANDLE;
+    }
+    if (culling.module) {
+        vkDestroyShaderModule(LogicalDevice, culling.module, VkAPI->allocator);
+        culling.module = VK_NULL_HANDLE;
+    }
+    // Наборы освобождаются вместе с пулом.
+    if (culling.pool) {
+        vkDestroyDescriptorPool(LogicalDevice, culling.pool, VkAPI->allocator);
+        culling.pool = VK_NULL_HANDLE;
+    }
+    if (culling.layout) {
+        vkDestroyDescriptorSetLayout(LogicalDevice, culling.layout, VkAPI->allocator);
+        culling.layout = VK_NULL_HANDLE;
+    }
+    for (u32 i = 0; i < VULKAN_MAX_FRAMES_IN_FLIGHT; ++i) {
+        culling.sets[i] = VK_NULL_HANDLE;
+        if (culling.CommandBuffers[i].data) {
+            VkAPI->RenderBufferDestroyInternal(culling.CommandBuffers[i]);
+        }
+    }
+    if (culling.StagingMapped) {
+        VkAPI->RenderBufferUnmapMemory(culling.StagingBuffer, 0, VK_WHOLE_SIZE);
+        culling.StagingMapped = nullptr;
+    }
+    if (culling.StagingBuffer.data) {
+        VkAPI->RenderBufferDestroyInternal(culling.StagingBuffer);
+    }
+    if (culling.InstanceBuffer.data) {
+        VkAPI->RenderBufferDestroyInternal(culling.InstanceBuffer);
+    }
+    culling.count = culling.DirtyBegin = culling.DirtyEnd = 0;
+    culling.supported = false;
+}
+
+bool VulkanCullingUpload(VulkanAPI *VkAPI, VulkanCulling &culling, const GpuCullInstance *instances, u32 count)
+{
+    if (!culling.supported || count > VULKAN_CULLING_MAX_INSTANCES) {
+        return false;
+    }
+
+    // Сначала проверяются все геометрии, чтобы при отказе записи остались прежними.
+    for (u32 i = 0; i < count; ++i) {
+        const auto geometry = instances[i].geometry;
+        if (!geometry || geometry->InternalID == INVALID::ID || !geometry->IndexCount) {
+            return false;
+        }
+        // vertexOffset команды задается в вершинах, а геометрия размещена по смещению в байтах.
+        const auto& BufferData = VkAPI->geometries[geometry->InternalID];
+        if (!geometry->VertexElementSize || BufferData.VertexBufferOffset % geometry->VertexElementSize ||
+            !geometry->IndexElementSize || BufferData.IndexBufferOffset % geometry->IndexElementSize) {
+            return false;
+        }
+    }
+
+    u32 DirtyBegin = culling.DirtyBegin;
+    u32 DirtyEnd = culling.DirtyEnd;
+    for (u32 i = 0; i < count; ++i) {
+        const auto geometry = instances[i].geometry;
+        const auto& BufferData = VkAPI->geometries[geometry->InternalID];
+
+        VulkanCullInstance record;
+        record.model = instances[i].model;
+        const auto& extents = geometry->extents;
+        const f32 hx = (extents.max.x - extents.min.x) * 0.5F;
+        const f32 hy = (extents.max.y - extents.min.y) * 0.5F;
+        const f32 hz = (extents.max.z - extents.min.z) * 0.5F;
+        record.bounds = FVec4(geometry->center.x, geometry->center.y, geometry->center.z, Math::sqrt(hx * hx + hy * hy + hz * hz));
+        record.IndexCount = geometry->IndexCount;
+        record.FirstIndex = (u32)(BufferData.IndexBufferOffset / geometry->IndexElementSize);
+        record.VertexOffset = (i32)(BufferData.VertexBufferOffset / geometry->VertexElementSize);
+
+        // Неизменные записи не загружаются повторно: у статичной сцены буфер устройства не трогается.
+        if (i < culling.count && CullInstanceEqual(culling.instances[i], record)) {
+            continue;
+        }
+        culling.instances[i] = record;
+        if (DirtyBegin == DirtyEnd) {
+            DirtyBegin = i;
+            DirtyEnd = i + 1;
+        } else {
+            DirtyBegin = MMIN(DirtyBegin, i);
+            DirtyEnd = MMAX(DirtyEnd, i + 1);
+        }
+    }
+
+    culling.DirtyBegin = DirtyBegin;
+    culling.DirtyEnd = DirtyEnd;
+    culling.count = count;
+    return true;
+}
+
+void VulkanCullingSetView(VulkanCulling &culling, const Matrix4D &projection, const Matrix4D &view)
+{
+    Frustum frustum;
+    frustum.FromMatrix(view * projection);
+    for (u32 i = 0; i < 6; ++i) {
+        const auto& side = frustum.sides[i];
+        culling.planes[i] = FVec4(side.x, side.y, side.z, -side.distance);
+    }
+}
+
+void VulkanCullingRecord(VulkanAPI *VkAPI, VulkanCulling &culling, VulkanCommandBuffer &CommandBuffer)
+{
+    if (!culling.supported || !culling.count || VkAPI->CurrentFrame >= culling.FrameCount) {
+        return;
+    }
+
+    const auto InstanceHandle = reinterpret_cast<VulkanBuffer*>(culling.InstanceBuffer.data)->handle;
+    const auto CommandHandle = reinterpret_cast<VulkanBuffer*>(culling.CommandBuffers[VkAPI->CurrentFrame].data)->handle;
+
+    if (culling.DirtyBegin != culling.DirtyEnd) {
+        // Раздел промежуточного буфера свободен: ограждение этого кадра в полете уже дождались.
+        const u64 offset = culling.DirtyBegin * sizeof(VulkanCullInstance);
+        const u64 size = (culling.DirtyEnd - culling.DirtyBegin) * sizeof(VulkanCullInstance);
+        const u64 StagingOffset = VkAPI->CurrentFrame * sizeof(VulkanCullInstance) * VULKAN_CULLING_MAX_INSTANCES + offset;
+        MemorySystem::CopyMem(culling.StagingMapped + StagingOffset, &culling.instances[culling.DirtyBegin], size);
+
+        // Предыдущие кадры могут еще читать записи в вычислительном и вершинном шейдерах.
+        VkBufferMemoryBarrier barrier = {VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+        barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.srcQueueFamilyIndex = barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = InstanceHandle;
+        barrier.offset = offset;
+        barrier.size = size;
+        vkCmdPipelineBarrier(CommandBuffer.handle,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+        VkBufferCopy region;
+        region.srcOffset = StagingOffset;
+        region.dstOffset = offset;
+        region.size = size;
+        vkCmdCopyBuffer(CommandBuffer.handle, reinterpret_cast<VulkanBuffer*>(culling.StagingBuffer.data)->handle, InstanceHandle, 1, &region);
+
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(CommandBuffer.handle,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+            0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+        culling.DirtyBegin = culling.DirtyEnd = 0;
+    }
+
+    VulkanCullPushConstants constants;
+    for (u32 i = 0; i < 6; ++i) {
+        constants.planes[i] = culling.planes[i];
+    }
+    constants.count = culling.count;
+
+    vkCmdBindPipeline(CommandBuffer.handle, VK_PIPELINE_BIND_POINT_COMPUTE, culling.pipeline);
+    vkCmdBindDescriptorSets(CommandBuffer.handle, VK_PIPELINE_BIND_POINT_COMPUTE, culling.PipelineLayout, 0, 1, &culling.sets[VkAPI->CurrentFrame], 0, nullptr);
+    vkCmdPushConstants(CommandBuffer.handle, culling.PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(VulkanCullPushConstants), &constants);
+    vkCmdDispatch(CommandBuffer.handle, (culling.count + VULKAN_CULLING_GROUP_SIZE - 1) / VULKAN_CULLING_GROUP_SIZE, 1, 1);
+
+    // Команды становятся видны косвенной отрисовке этого кадра.
+    VkBufferMemoryBarrier barrier = {VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    barrier.srcQueueFamilyIndex = barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = CommandHandle;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(CommandBuffer.handle,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+void VulkanCullingDraw(VulkanAPI *VkAPI, VulkanCulling &culling, VulkanCommandBuffer &CommandBuffer, VkPipelineLayout PipelineLayout, u32 SetIndex, u32 first, u32 count)
+{
+    if (!culling.supported || first + count > culling.count || VkAPI->CurrentFrame >= culling.FrameCount) {
+        return;
+    }
+
+    vkCmdBindDescriptorSets(CommandBuffer.handle, VK_PIPELINE_BIND_POINT_GRAPHICS, PipelineLayout, SetIndex, 1, &culling.sets[VkAPI->CurrentFrame], 0, nullptr);
+
+    // Вершины и индексы всех геометрий лежат в общих буферах, смещения геометрий задаются командами.
+    VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(CommandBuffer.handle, 0, 1, &reinterpret_cast<VulkanBuffer*>(VkAPI->ObjectVertexBuffer.data)->handle, &offset);
+    vkCmdBindIndexBuffer(CommandBuffer.handle, reinterpret_cast<VulkanBuffer*>(VkAPI->ObjectIndexBuffer.data)->handle, 0, VK_INDEX_TYPE_UINT32);
+
+    const auto CommandHandle = reinterpret_cast<VulkanBuffer*>(culling.CommandBuffers[VkAPI->CurrentFrame].data)->handle;
+    if (culling.MultiDraw) {
+        vkCmdDrawIndexedIndirect(CommandBuffer.handle, CommandHandle, first * VULKAN_CULLING_COMMAND_STRIDE, count, VULKAN_CULLING_COMMAND_STRIDE);
+    } else {
+        for (u32 i = 0; i < count; ++i) {
+            vkCmdDrawIndexedIndirect(CommandBuffer.handle, CommandHandle, (first + i) * VULKAN_CULLING_COMMAND_STRIDE, 1, VULKAN_CULLING_COMMAND_STRIDE);
+        }
+    }
+}
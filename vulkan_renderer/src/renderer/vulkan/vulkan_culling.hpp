@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <containers/darray.h>
+#include "renderer/renderbuffer.h"
+#include "renderer/renderer_types.h"
+#include "vulkan_command_buffer.hpp"
+#include "vulkan_recording.hpp"
+
+class VulkanAPI;
+
+constexpr u32 VULKAN_CULLING_MAX_INSTANCES = 8192;                       // Максимальное количество экземпляров, отсекаемых на GPU за кадр.
+constexpr u32 VULKAN_CULLING_SET_INDEX = 2;                              // Номер набора отсечения в конвейере косвенной отрисовки, после глобального набора и набора экземпляра. В режиме без привязки — следующий за таблицей текстур.
+constexpr u32 VULKAN_CULLING_GROUP_SIZE = 64;                            // Размер рабочей группы вычислительного шейдера отсечения.
+constexpr u32 VULKAN_CULLING_COMMAND_STRIDE = sizeof(VkDrawIndexedIndirectCommand);
+constexpr const char* VULKAN_CULLING_SHADER_FILE = "shaders/Builtin.CullCompute.comp.spv";
+
+/// @brief Запись экземпляра в буфере хранения. Раскладка совпадает со структурой cull_instance (std430) в шейдерах.
+struct VulkanCullInstance {
+    Matrix4D model;                                                       // Матрица модели.
+    FVec4 bounds;                                                         // Центр (xyz) и радиус (w) ограничивающей сферы в локальных координатах.
+    u32 IndexCount;
+    u32 FirstIndex;                                                       // Первый индекс геометрии в общем буфере индексов.
+    i32 VertexOffset;                                                     // Первая вершина геометрии в общем буфере вершин.
+    u32 padding;
+
+    constexpr VulkanCullInstance() : model(), bounds(), IndexCount(), FirstIndex(), VertexOffset(), padding() {}
+};
+
+/// @brief Push-константы вычислительного шейдера отсечения.
+struct VulkanCullPushConstants {
+    FVec4 planes[6];                                                      // Плоскости усеченной пирамиды: нормаль внутрь (xyz) и смещение (w).
+    u32 count;                                                            // Количество экземпляров.
+};
+
+/// @brief Отсечение по усеченной пирамиде на GPU. Экземпляры хранятся в буфере устройства и обновляются только
+/// в измененном диапазоне, вычислительный шейдер в начале кадра записывает команды косвенной отрисовки,
+/// у невидимых экземпляров количество экземпляров в команде равно нулю.
+struct VulkanCulling {
+    RenderBuffer InstanceBuffer;                                          // Записи экземпляров в памяти устройства. Общий для всех кадров.
+    RenderBuffer StagingBuffer;                                           // Видимый хосту буфер загрузки, по разделу на кадр в полете.
+    u8* StagingMapped;
+    RenderBuffer CommandBuffers[VULKAN_MAX_FRAMES_IN_FLIGHT];             // Команды косвенной отрисовки, по одному буферу на кадр в полете.
+    DArray<VulkanCullInstance> instances;                                 // Копия записей, загруженных в буфер устройства.
+    u32 count;                                                            // Количество экземпляров.
+    u32 DirtyBegin;                                                       // Начало диапазона записей, ожидающих загрузки.
+    u32 DirtyEnd;                                                         // Конец диапазона записей, ожидающих загрузки. Равен DirtyBegin, если загружать нечего.
+    FVec4 planes[6];
+    VkDescriptorSetLayout layout;                                         // Привязка 0 — экземпляры, 1 — команды.
+    VkDescriptorPool pool;
+    VkDescriptorSet sets[VULKAN_MAX_FRAMES_IN_FLIGHT];
+    VkShaderModule module;
+    VkPipelineLayout PipelineLayout;
+    VkPipeline pipeline;
+    u32 FrameCount;
+    bool MultiDraw;                                                       // Устройство рисует несколько команд одним вызовом.
+    bool supported;
+
+    constexpr VulkanCulling()
+    : InstanceBuffer(), StagingBuffer(), StagingMapped(nullptr), CommandBuffers(), instances(), count(), DirtyBegin(), DirtyEnd(), planes(),
+    layout(), pool(), sets(), module(), PipelineLayout(), pipeline(), FrameCount(), MultiDraw(false), supported(false) {}
+};
+
+/// @brief Создает буферы, наборы дескрипторов и вычислительный конвейер отсечения.
+/// @param VkAPI указатель на Vulkan.
+/// @param OutCulling отсечение.
+/// @return true в случае успеха; false, если устройство не поддерживает косвенную отрисовку с первым экземпляром или шейдер не найден.
+bool VulkanCullingCreate(VulkanAPI* VkAPI, VulkanCulling& OutCulling);
+
+/// @brief Уничтожает ресурсы отсечения. Устройство должно быть свободно.
+/// @param VkAPI указатель на Vulkan.
+/// @param culling отсечение.
+void VulkanCullingDestroy(VulkanAPI* VkAPI, VulkanCulling& culling);
+
+/// @brief Обновляет записи экземпляров. Измененные записи загружаются в буфер устройства при следующей записи отсечения.
+/// @param VkAPI указатель на Vulkan.
+/// @param culling отсечение.
+/// @param instances массив экземпляров.
+/// @param count количество экземпляров.
+/// @return true в случае успеха; false, если экземпляров слишком много или геометрия не может быть нарисована косвенно.
+bool VulkanCullingUpload(VulkanAPI* VkAPI, VulkanCulling& culling, const GpuCullInstance* instances, u32 count);
+
+/// @brief Задает усеченную пирамиду, по которой отсекаются экземпляры.
+/// @param culling отсечение.
+/// @param projection матрица проекции.
+/// @param view матрица вида.
+void VulkanCullingSetView(VulkanCulling& culling, const Matrix4D& projection, const Matrix4D& view);
+
+/// @brief Записывает загрузку измененных записей и вычисление команд отрисовки текущего кадра.
+/// Вызывается в начале записи буфера кадра, вне прохода рендеринга.
+/// @param VkAPI указатель на Vulkan.
+/// @param culling отсечение.
+/// @param CommandBuffer основной буфер команд кадра.
+void VulkanCullingRecord(VulkanAPI* VkAPI, VulkanCulling& culling, VulkanCommandBuffer& CommandBuffer);
+
+/// @brief Рисует экземпляры из команд текущего кадра. Конвейер косвенной отрисовки должен быть привязан.
+/// @param VkAPI указатель на Vulkan.
+/// @param culling отсечение.
+/// @param CommandBuffer буфер команд, в который идет запись.
+/// @param PipelineLayout макет привязанного конвейера косвенной отрисовки.
+/// @param SetIndex индекс набора отсечения в макете.
+/// @param first первый экземпляр.
+/// @param count количество экземпляров.
+void VulkanCullingDraw(VulkanAPI* VkAPI, VulkanCulling& culling, VulkanCommandBuffer& CommandBuffer, VkPipelineLayout PipelineLayout, u32 SetIndex, u32 first, u32 count);
@@ -0,0 +1,55 @@
+#include "vulkan_deferred.hpp"
+#include "vulkan_api.h"
+#include <systems/texture_system.h>
+
+void VulkanDeferredReleaseImage(VulkanDeferredQueue &queue, VulkanImage *image)
+{
+    queue.entries.PushBack(VulkanDeferredRelease(image, queue.SubmittedFrames));
+}
+
+void VulkanDeferredReleaseGeometry(VulkanDeferredQueue &queue, u64 VertexSize, u64 VertexOffset, u64 IndexSize, u64 IndexOffset)
+{
+    queue.entries.PushBack(VulkanDeferredRelease(VertexSize, VertexOffset, IndexSize, IndexOffset, queue.SubmittedFrames));
+}
+
+static void VulkanDeferredFree(VulkanAPI* VkAPI, VulkanDeferredRelease& entry)
+{
+    if (entry.image) {
+        TextureSystem::ReleaseBindlessSlot(entry.image->BindlessIndex);
+        entry.image->BindlessIndex = INVALID::ID;
+        entry.image->Destroy(VkAPI);
+        delete entry.image;
+        entry.image = nullptr;
+    }
+    if (entry.VertexSize && !VkAPI->ObjectVertexBuffer.Free(entry.VertexSize, entry.VertexOffset)) {
+        MERROR("VulkanDeferredCollect не удалось освободить диапазон буфера вершин.");
+    }
+    if (entry.IndexSize && !VkAPI->ObjectIndexBuffer.Free(entry.IndexSize, entry.IndexOffset)) {
+        MERROR("VulkanDeferredCollect не удалось освободить диапазон буфера индексов.");
+    }
+    entry.VertexSize = entry.IndexSize = 0;
+}
+
+void VulkanDeferredCollect(VulkanAPI *VkAPI, VulkanDeferredQueue &queue, bool idle)
+{
+    // Ограждение кадра N дожидаются перед записью кадра N + MaxFramesInFlight, поэтому к этому моменту
+    // завершены все кадры, отправленные не позже чем MaxFramesInFlight кадров назад.
+    const u64 FrameCount = VkAPI->swapchain.MaxFramesInFlight;
+    for (u32 i = 0; i < queue.entries.Length();) {
+        auto& entry = queue.entries[i];
+        if (idle || queue.SubmittedFrames >= entry.frame + FrameCount) {
+            VulkanDeferredFree(VkAPI, entry);
+            // Порядок уничтожения не важен: на место освобожденной записи переносится последняя.
+            entry = queue.entries[queue.entries.Length() - 1];
+            queue.entries.PopBack();
+        } else {
+            ++i;
+        }
+    }
+}
+
+void VulkanDeferredDestroy(VulkanAPI *VkAPI, VulkanDeferredQueue &queue)
+{
+    VulkanDeferredCollect(VkAPI, queue, true);
+    queue.entries.Destroy();
+}
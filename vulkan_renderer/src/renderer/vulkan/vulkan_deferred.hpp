@@ -0,0 +1,55 @@
+#pragma once
+
+#include <containers/darray.h>
+
+class VulkanAPI;
+class VulkanImage;
+
+/// @brief Ресурс, уничтожение которого отложено, пока GPU не завершит кадры, которые могли его использовать.
+struct VulkanDeferredRelease {
+    VulkanImage* image;                                                   // Изображение текстуры вместе с ее ячейкой в таблице без привязки.
+    u64 VertexSize;                                                       // Диапазон геометрии в буфере вершин; 0 — нет.
+    u64 VertexOffset;
+    u64 IndexSize;                                                        // Диапазон геометрии в буфере индексов; 0 — нет.
+    u64 IndexOffset;
+    u64 frame;                                                            // Количество отправленных кадров на момент постановки в очередь.
+
+    constexpr VulkanDeferredRelease() : image(nullptr), VertexSize(), VertexOffset(), IndexSize(), IndexOffset(), frame() {}
+    constexpr VulkanDeferredRelease(VulkanImage* image, u64 frame) : image(image), VertexSize(), VertexOffset(), IndexSize(), IndexOffset(), frame(frame) {}
+    constexpr VulkanDeferredRelease(u64 VertexSize, u64 VertexOffset, u64 IndexSize, u64 IndexOffset, u64 frame) 
+    : image(nullptr), VertexSize(VertexSize), VertexOffset(VertexOffset), IndexSize(IndexSize), IndexOffset(IndexOffset), frame(frame) {}
+};
+
+/// @brief Очередь отложенного уничтожения. Ресурс, поставленный в очередь до отправки кадра N, уничтожается
+/// после ожидания ограждения кадра N, то есть через столько кадров, сколько их в полете, без ожидания простоя устройства.
+/// @note Используется только основным потоком.
+struct VulkanDeferredQueue {
+    DArray<VulkanDeferredRelease> entries;
+    u64 SubmittedFrames;                                                  // Количество кадров, отправленных в графическую очередь.
+
+    constexpr VulkanDeferredQueue() : entries(), SubmittedFrames() {}
+};
+
+/// @brief Откладывает уничтожение изображения текстуры и освобождение ее ячейки в таблице без привязки.
+/// @param queue очередь отложенного уничтожения.
+/// @param image изображение; очередь становится его владельцем.
+void VulkanDeferredReleaseImage(VulkanDeferredQueue& queue, VulkanImage* image);
+
+/// @brief Откладывает освобождение диапазонов геометрии в буферах вершин и индексов.
+/// @param queue очередь отложенного уничтожения.
+/// @param VertexSize размер диапазона в буфере вершин.
+/// @param VertexOffset смещение диапазона в буфере вершин.
+/// @param IndexSize размер диапазона в буфере индексов; 0, если у геометрии нет индексов.
+/// @param IndexOffset смещение диапазона в буфере индексов.
+void VulkanDeferredReleaseGeometry(VulkanDeferredQueue& queue, u64 VertexSize, u64 VertexOffset, u64 IndexSize, u64 IndexOffset);
+
+/// @brief Уничтожает ресурсы, кадры которых завершены. Вызывается основным потоком после ожидания ограждения текущего кадра.
+/// @param VkAPI указатель на Vulkan.
+/// @param queue очередь отложенного уничтожения.
+/// @param idle устройство свободно, поэтому можно уничтожить все ресурсы.
+void VulkanDeferredCollect(VulkanAPI* VkAPI, VulkanDeferredQueue& queue, bool idle);
+
+/// @brief Уничтожает все оставшиеся ресурсы и очередь. Устройство должно быть свободно.
+/// @param VkAPI указатель на Vulkan.
+/// @param queue очередь отложенного уничтожения.
+void VulkanDeferredDestroy(VulkanAPI* VkAPI, VulkanDeferredQueue& queue);
@@ -66,6 +66,9 @@ bool VulkanDevice::Create(VulkanAPI* VkAPI)
     VkPhysicalDeviceFeatures DeviceFeatures = {};
     DeviceFeatures.samplerAnisotropy = VK_TRUE;  // Запросить анизотропию
     DeviceFeatures.fillModeNonSolid = VK_TRUE;   // ЗАДАЧА: Проверить, поддерживается ли?
+    // Косвенная отрисовка для отсечения на GPU. Без этих возможностей отсечение остается на CPU.
+    DeviceFeatures.drawIndirectFirstInstance = features.drawIndirectFirstInstance;
+    DeviceFeatures.multiDrawIndirect = features.multiDrawIndirect;
 
     bool PortabilityRequired = false;
     u32 AvailableExtensionCount = 0;
@@ -143,6 +146,17 @@ bool VulkanDevice::Create(VulkanAPI* VkAPI)
         ExtendedDynamicState.pNext = &LineRasterizationExt;
     }
 
+    // Индексирование дескрипторов для режима без привязки, если поддерживается.
+    VkPhysicalDeviceDescriptorIndexingFeatures DescriptorIndexing = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES};
+    if (supportFlags & DescriptorIndexingBit) {
+        DescriptorIndexing.runtimeDescriptorArray = VK_TRUE;
+        DescriptorIndexing.descriptorBindingPartiallyBound = VK_TRUE;
+        DescriptorIndexing.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        DescriptorIndexing.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+        DescriptorIndexing.pNext = ExtendedDynamicState.pNext;
+        ExtendedDynamicState.pNext = &DescriptorIndexing;
+    }
+
     // Создайте устройство.
     VK_CHECK(vkCreateDevice(
         this->PhysicalDevice,
@@ -376,6 +390,9 @@ bool VulkanDevice::SelectPhysicalDevice(VulkanAPI *VkAPI)
         // Проверьте поддержку растеризации сглаженных линий через расширение.
         VkPhysicalDeviceLineRasterizationFeaturesEXT SmoothLineNext = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_LINE_RASTERIZATION_FEATURES_EXT};
         DynamicStateNext.pNext = &SmoothLineNext;
+        // Проверьте поддержку индексирования дескрипторов для режима без привязки.
+        VkPhysicalDeviceDescriptorIndexingFeatures IndexingNext = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES};
+        SmoothLineNext.pNext = &IndexingNext;
         // Выполните запрос.
         vkGetPhysicalDeviceFeatures2(device, &features2);
 
@@ -472,6 +489,14 @@ bool VulkanDevice::SelectPhysicalDevice(VulkanAPI *VkAPI)
             if (SmoothLineNext.smoothLines) {
                 supportFlags |= LineSmoothRasterisationBit;
             }
+            // Структура функций индексирования дескрипторов входит в ядро начиная с Vulkan 1.2.
+            if ((ApiMaijor > 1 || ApiMinor > 1) &&
+                IndexingNext.runtimeDescriptorArray &&
+                IndexingNext.descriptorBindingPartiallyBound &&
+                IndexingNext.descriptorBindingSampledImageUpdateAfterBind &&
+                IndexingNext.shaderSampledImageArrayNonUniformIndexing) {
+                supportFlags |= DescriptorIndexingBit;
+            }
             break;
         }
     }
@@ -31,6 +31,8 @@ public:
         NativeDynamicFrontFaceBit = 0x08,
         /// @brief Указывает, поддерживает ли устройство динамическую замену лицевой плоскости(face) на основе расширений.
         DynamicFrontFaceBit = 0x10,
+        /// @brief Указывает, поддерживает ли устройство индексирование дескрипторов (Vulkan API >= 1.2), необходимое для режима без привязки (bindless).
+        DescriptorIndexingBit = 0x20,
     };
 
     /// @brief Побитовые флаги поддержки устройств. @see VulkanDevice::SupportFlagBits.
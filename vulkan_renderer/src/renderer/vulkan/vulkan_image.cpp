@@ -5,6 +5,7 @@
 #include "core/asserts.hpp"
 
 VulkanImage::VulkanImage(Config &config)
+: BindlessIndex(INVALID::ID)
 {
     Create(config);
 }
@@ -51,9 +51,12 @@ public:
     u32 height = 0;
     /// @brief Название изображения.
     MString name;
+    /// @brief Слот изображения в массиве текстур режима без привязки (bindless). INVALID::ID, если не выделен.
+    u32 BindlessIndex;
 public:
-    constexpr VulkanImage() : handle(), memory(), view(), MemoryRequirements(), MemoryFlags(), width(), height(), name() {}
-    constexpr VulkanImage(const VulkanImage& vi) : handle(vi.handle), memory(vi.memory), view(vi.view), MemoryRequirements(vi.MemoryRequirements), MemoryFlags(vi.MemoryFlags), width(vi.width), height(vi.height), name(vi.name) {}
+    constexpr VulkanImage() : handle(), memory(), view(), MemoryRequirements(), MemoryFlags(), width(), height(), name(), BindlessIndex(INVALID::ID) {}
+    // ПРИМЕЧАНИЕ: Копия не владеет слотом оригинала.
+    constexpr VulkanImage(const VulkanImage& vi) : handle(vi.handle), memory(vi.memory), view(vi.view), MemoryRequirements(vi.MemoryRequirements), MemoryFlags(vi.MemoryFlags), width(vi.width), height(vi.height), name(vi.name), BindlessIndex(INVALID::ID) {}
     /// @brief Создает новое изображение Vulkan.
     /// @param config конфигурация изображения Vulkan
     VulkanImage(Config& config);
@@ -228,7 +228,7 @@ bool VulkanPipeline::Create(VulkanAPI* VkAPI, const Config& config)
 
     VkResult result = vkCreateGraphicsPipelines(
         VkAPI->Device.LogicalDevice,
-        VK_NULL_HANDLE,
+        VkAPI->PipelineCache,
         1,
         &PipelineCreateInfo,
         VkAPI->allocator,
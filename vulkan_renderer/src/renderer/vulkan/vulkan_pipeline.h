@@ -17,6 +17,25 @@ namespace VulkanTopology
     };
 } // namespace VulkanTopology  
 
+/// @brief Отложенное создание конвейеров шейдера. Конвейеры создает тот, кто первым переведет
+/// состояние из Pending в Building: поток заданий или основной поток, которому конвейер понадобился раньше.
+/// Запись освобождает последний из двух владельцев (задание и шейдер).
+struct VulkanPipelineBuild {
+    enum State : u32 {
+        Pending,
+        Building,
+        Ready,
+        Failed,
+        Cancelled
+    };
+
+    VulkanAPI* VkAPI;
+    struct Shader* shader;
+    u32 PipelineCount;
+    u32 state;
+    u32 RefCount;
+};
+
 class VulkanPipeline
 {
 public:
@@ -0,0 +1,191 @@
+#include "vulkan_pipeline_cache.hpp"
+#include "vulkan_api.h"
+#include "vulkan_utils.h"
+
+#include <platform/filesystem.hpp>
+
+constexpr u32 PIPELINE_CACHE_MAGIC = 0x434C504D; // "MPLC"
+constexpr u32 PIPELINE_CACHE_VERSION = 1;
+
+/// @brief Заголовок файла кеша. Ключ — устройство и версия драйвера: кеш другого драйвера бесполезен,
+/// а некоторые драйверы аварийно завершаются на чужих данных вместо того, чтобы их отбросить.
+struct PipelineCacheFileHeader {
+    u32 magic;
+    u32 version;
+    u32 VendorID;
+    u32 DeviceID;
+    u32 DriverVersion;
+    u8 PipelineCacheUUID[VK_UUID_SIZE];
+    u64 DataSize;
+    u64 hash;                           // Хеш FNV-1a данных кеша.
+};
+
+static u64 HashData(const u8* data, u64 size)
+{
+    u64 hash = 14695981039346656037ULL;
+    for (u64 i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static bool UUIDEqual(const u8* a, const u8* b)
+{
+    for (u32 i = 0; i < VK_UUID_SIZE; ++i) {
+        if (a[i] != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void HeaderFill(VulkanAPI* VkAPI, PipelineCacheFileHeader& header)
+{
+    const auto& properties = VkAPI->Device.properties;
+    header.magic = PIPELINE_CACHE_MAGIC;
+    header.version = PIPELINE_CACHE_VERSION;
+    header.VendorID = properties.vendorID;
+    header.DeviceID = properties.deviceID;
+    header.DriverVersion = properties.driverVersion;
+    MemorySystem::CopyMem(header.PipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+}
+
+/// @brief Проверяет заголовок файла и заголовок, который Vulkan записывает в начало данных кеша.
+static bool HeaderValidate(VulkanAPI* VkAPI, const PipelineCacheFileHeader& header, const u8* data)
+{
+    PipelineCacheFileHeader expected{};
+    HeaderFill(VkAPI, expected);
+    if (header.magic != expected.magic || header.version != expected.version) {
+        MWARN("Кеш конвейеров: неизвестный формат файла.");
+        return false;
+    }
+    if (header.VendorID != expected.VendorID || header.DeviceID != expected.DeviceID || header.DriverVersion != expected.DriverVersion ||
+        !UUIDEqual(header.PipelineCacheUUID, expected.PipelineCacheUUID)) {
+        MINFO("Кеш конвейеров записан другим устройством или драйвером и будет пересоздан.");
+        return false;
+    }
+
+    VkPipelineCacheHeaderVersionOne VkHeader;
+    if (header.DataSize < sizeof(VkHeader)) {
+        MWARN("Кеш конвейеров: данные слишком малы.");
+        return false;
+    }
+    MemorySystem::CopyMem(&VkHeader, data, sizeof(VkHeader));
+    if (VkHeader.headerSize < sizeof(VkHeader) || VkHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+        VkHeader.vendorID != expected.VendorID || VkHeader.deviceID != expected.DeviceID ||
+        !UUIDEqual(VkHeader.pipelineCacheUUID, expected.PipelineCacheUUID)) {
+        MWARN("Кеш конвейеров: заголовок данных Vulkan не совпадает с устройством.");
+        return false;
+    }
+
+    if (HashData(data, header.DataSize) != header.hash) {
+        MWARN("Кеш конвейеров поврежден.");
+        return false;
+    }
+    return true;
+}
+
+/// @brief Читает данные кеша из файла. Возвращает nullptr, если файла нет или он не прошел проверку.
+static u8* ReadCacheFile(VulkanAPI* VkAPI, const char* path, u64& OutSize)
+{
+    OutSize = 0;
+    if (!Filesystem::Exists(path)) {
+        return nullptr;
+    }
+
+    FileHandle f;
+    if (!Filesystem::Open(path, FileModes::Read, true, f)) {
+        return nullptr;
+    }
+
+    PipelineCacheFileHeader header{};
+    u64 FileSize = 0;
+    u64 BytesRead = 0;
+    if (!Filesystem::Size(f, FileSize) || FileSize < sizeof(header) ||
+        !Filesystem::Read(f, sizeof(header), &header, BytesRead) || BytesRead != sizeof(header) ||
+        header.DataSize != FileSize - sizeof(header)) {
+        MWARN("Кеш конвейеров «%s» усечен или поврежден.", path);
+        Filesystem::Close(f);
+        return nullptr;
+    }
+
+    u8* data = reinterpret_cast<u8*>(MemorySystem::Allocate(header.DataSize, Memory::Renderer));
+    if (!Filesystem::Read(f, header.DataSize, data, BytesRead) || BytesRead != header.DataSize || !HeaderValidate(VkAPI, header, data)) {
+        MemorySystem::Free(data, header.DataSize, Memory::Renderer);
+        Filesystem::Close(f);
+        return nullptr;
+    }
+
+    Filesystem::Close(f);
+    OutSize = header.DataSize;
+    return data;
+}
+
+bool VulkanPipelineCacheCreate(VulkanAPI *VkAPI, const char *path, VkPipelineCache &OutCache, bool &OutWarm)
+{
+    u64 size = 0;
+    u8* data = ReadCacheFile(VkAPI, path, size);
+    OutWarm = data != nullptr;
+
+    VkPipelineCacheCreateInfo CreateInfo = {VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+    CreateInfo.initialDataSize = size;
+    CreateInfo.pInitialData = data;
+
+    VkResult result = vkCreatePipelineCache(VkAPI->Device.LogicalDevice, &CreateInfo, VkAPI->allocator, &OutCache);
+    if (data) {
+        MemorySystem::Free(data, size, Memory::Renderer);
+    }
+
+    if (!VulkanResultIsSuccess(result) && OutWarm) {
+        // Драйвер отверг данные — начать с пустого кеша.
+        OutWarm = false;
+        CreateInfo.initialDataSize = 0;
+        CreateInfo.pInitialData = nullptr;
+        result = vkCreatePipelineCache(VkAPI->Device.LogicalDevice, &CreateInfo, VkAPI->allocator, &OutCache);
+    }
+    if (!VulkanResultIsSuccess(result)) {
+        MERROR("Не удалось создать кеш конвейеров: %s", VulkanResultString(result, true));
+        OutCache = VK_NULL_HANDLE;
+        return false;
+    }
+
+    MINFO("Кеш конвейеров %s (%llu байт).", OutWarm ? "загружен" : "пуст", size);
+    return true;
+}
+
+void VulkanPipelineCacheDestroy(VulkanAPI *VkAPI, const char *path, VkPipelineCache &cache)
+{
+    if (!cache) {
+        return;
+    }
+
+    const auto& LogicalDevice = VkAPI->Device.LogicalDevice;
+    size_t AllocatedSize = 0;
+    if (vkGetPipelineCacheData(LogicalDevice, cache, &AllocatedSize, nullptr) == VK_SUCCESS && AllocatedSize > 0) {
+        // Второй вызов записывает в size объем фактически скопированных данных; выделенный объем хранится отдельно.
+        size_t size = AllocatedSize;
+        u8* data = reinterpret_cast<u8*>(MemorySystem::Allocate(AllocatedSize, Memory::Renderer));
+        if (vkGetPipelineCacheData(LogicalDevice, cache, &size, data) == VK_SUCCESS) {
+            PipelineCacheFileHeader header{};
+            HeaderFill(VkAPI, header);
+            header.DataSize = size;
+            header.hash = HashData(data, size);
+
+            FileHandle f;
+            u64 written = 0;
+            if (Filesystem::Open(path, FileModes::Write, true, f)) {
+                if (!Filesystem::Write(f, sizeof(header), &header, written) || !Filesystem::Write(f, size, data, written)) {
+                    MWARN("Не удалось записать кеш конвейеров «%s».", path);
+                }
+                Filesystem::Close(f);
+            } else {
+                MWARN("Не удалось открыть файл кеша конвейеров «%s» для записи.", path);
+            }
+        }
+        MemorySystem::Free(data, AllocatedSize, Memory::Renderer);
+    }
+
+    vkDestroyPipelineCache(LogicalDevice, cache, VkAPI->allocator);
+    cache = VK_NULL_HANDLE;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <defines.h>
+
+class VulkanAPI;
+
+/// @brief Загружает кеш конвейеров из файла и создает VkPipelineCache. Если файла нет, он поврежден
+/// или записан другим устройством либо версией драйвера, создается пустой кеш.
+/// @param VkAPI указатель на Vulkan.
+/// @param path путь к файлу кеша.
+/// @param OutCache кеш конвейеров.
+/// @param OutWarm устанавливается в true, если данные кеша были загружены из файла.
+/// @return true в случае успеха; в противном случае false.
+bool VulkanPipelineCacheCreate(VulkanAPI* VkAPI, const char* path, VkPipelineCache& OutCache, bool& OutWarm);
+
+/// @brief Сохраняет содержимое кеша конвейеров в файл и уничтожает кеш.
+/// @param VkAPI указатель на Vulkan.
+/// @param path путь к файлу кеша.
+/// @param cache кеш конвейеров. После вызова равен VK_NULL_HANDLE.
+void VulkanPipelineCacheDestroy(VulkanAPI* VkAPI, const char* path, VkPipelineCache& cache);
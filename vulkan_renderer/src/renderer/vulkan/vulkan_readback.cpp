@@ -0,0 +1,288 @@
+#include "vulkan_readback.hpp"
+#include "vulkan_api.h"
+#include "vulkan_image.hpp"
+#include "vulkan_buffer.hpp"
+
+/// @brief Промежуточное состояние ячейки: опрашивающий поток копирует результат. Основной поток ячейку не трогает.
+static constexpr u32 READBACK_STATE_READING = VulkanReadbackState::Consumed + 1;
+
+/// @brief Округляет размер выделения. Все выделения кратны 48 байтам, поэтому смещения в кольце
+/// кратны 4 и размеру texel, как того требует копирование изображения в буфер.
+static u64 ReadbackAlign(u64 size)
+{
+    constexpr u64 alignment = 48;
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+/// @brief Возвращает макет, в котором изображение находится между кадрами. Записываемые текстуры
+/// в движке — вложения целей рендеринга, проходы оставляют их в VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL.
+static VkImageLayout ReadbackImageLayout(const Texture* texture)
+{
+    return (texture->flags & Texture::Flag::IsWriteable) ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+}
+
+/// @brief Освобождает память ячейки и возвращает ее в очередь. Вызывается только основным потоком.
+static void ReadbackRelease(VulkanAPI* VkAPI, VulkanReadbackQueue& queue, VulkanReadback& slot)
+{
+    if (slot.dedicated.data) {
+        VkAPI->RenderBufferUnmapMemory(slot.dedicated, 0, VK_WHOLE_SIZE);
+        VkAPI->RenderBufferDestroyInternal(slot.dedicated);
+        slot.DedicatedMapped = nullptr;
+    } else if (slot.size) {
+        queue.buffer.Free(ReadbackAlign(slot.size), slot.offset);
+    }
+    slot.texture = nullptr;
+    slot.size = 0;
+    __atomic_store_n(&slot.ticket, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot.state, VulkanReadbackState::Free, __ATOMIC_RELEASE);
+}
+
+/// @brief Отмечает чтение неудавшимся. Опрос вернет ReadbackStatus::Invalid.
+static void ReadbackFail(VulkanAPI* VkAPI, VulkanReadback& slot)
+{
+    slot.FrameNumber = VkAPI->FrameNumber;
+    __atomic_store_n(&slot.state, VulkanReadbackState::Failed, __ATOMIC_RELEASE);
+}
+
+bool VulkanReadbackCreate(VulkanAPI *VkAPI, u64 size, VulkanReadbackQueue &OutQueue)
+{
+    if (!VkAPI->RenderBufferCreate("renderbuffer_readback_ring", RenderBufferType::Read, size, true, OutQueue.buffer)) {
+        MERROR("VulkanReadbackCreate — не удалось создать кольцо чтения.");
+        return false;
+    }
+    VkAPI->RenderBufferBind(OutQueue.buffer, 0);
+    OutQueue.mapped = reinterpret_cast<u8*>(VkAPI->RenderBufferMapMemory(OutQueue.buffer, 0, VK_WHOLE_SIZE));
+    return true;
+}
+
+void VulkanReadbackDestroy(VulkanAPI *VkAPI, VulkanReadbackQueue &queue)
+{
+    for (u8 i = 0; i < VULKAN_READBACK_SLOT_COUNT; ++i) {
+        auto& slot = queue.slots[i];
+        if (slot.state != VulkanReadbackState::Free) {
+            ReadbackRelease(VkAPI, queue, slot);
+        }
+    }
+
+    if (queue.mapped) {
+        VkAPI->RenderBufferUnmapMemory(queue.buffer, 0, VK_WHOLE_SIZE);
+        VkAPI->RenderBufferDestroyInternal(queue.buffer);
+        queue.mapped = nullptr;
+    }
+
+    MDEBUG("Очередь чтений: забрано %llu результатов, освобождено без опроса: %u.", queue.CompletedCount, queue.ExpiredCount);
+}
+
+u64 VulkanReadbackRequest(VulkanReadbackQueue &queue, Texture *texture, u32 x, u32 y, u32 width, u32 height, u64 ReadOffset, u64 ReadSize)
+{
+    if (!texture || !texture->data) {
+        MERROR("VulkanReadbackRequest требует загруженную текстуру.");
+        return 0;
+    }
+    if (texture->flags & Texture::Flag::Depth) {
+        MERROR("VulkanReadbackRequest — чтение текстур глубины не поддерживается ('%s').", texture->name);
+        return 0;
+    }
+
+    for (u8 i = 0; i < VULKAN_READBACK_SLOT_COUNT; ++i) {
+        auto& slot = queue.slots[i];
+        u32 expected = VulkanReadbackState::Free;
+        if (!__atomic_compare_exchange_n(&slot.state, &expected, VulkanReadbackState::Claimed, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            continue;
+        }
+
+        slot.texture = texture;
+        slot.x = x;
+        slot.y = y;
+        slot.width = width;
+        slot.height = height;
+        slot.ReadOffset = ReadOffset;
+        slot.ReadSize = ReadSize;
+        const u64 ticket = __atomic_add_fetch(&queue.NextTicket, 1, __ATOMIC_ACQ_REL);
+        __atomic_store_n(&slot.ticket, ticket, __ATOMIC_RELEASE);
+        __atomic_store_n(&slot.state, VulkanReadbackState::Requested, __ATOMIC_RELEASE);
+        return ticket;
+    }
+
+    MWARN("VulkanReadbackRequest — все %u ячеек чтения заняты.", VULKAN_READBACK_SLOT_COUNT);
+    return 0;
+}
+
+void VulkanReadbackRecord(VulkanAPI *VkAPI, VulkanReadbackQueue &queue, VulkanCommandBuffer &CommandBuffer)
+{
+    u32 RecordedCount = 0;
+    for (u8 i = 0; i < VULKAN_READBACK_SLOT_COUNT; ++i) {
+        auto& slot = queue.slots[i];
+        if (__atomic_load_n(&slot.state, __ATOMIC_ACQUIRE) != VulkanReadbackState::Requested) {
+            continue;
+        }
+
+        auto texture = slot.texture;
+        auto image = reinterpret_cast<VulkanImage*>(texture->data);
+        if (!image) {
+            MERROR("VulkanReadbackRecord — текстура '%s' была выгружена до чтения.", texture->name);
+            ReadbackFail(VkAPI, slot);
+            continue;
+        }
+
+        // Область прижимается к текущему размеру изображения: цель могла смениться после изменения размера окна.
+        const u32 x = MMIN(slot.x, image->width - 1);
+        const u32 y = MMIN(slot.y, image->height - 1);
+        const u32 width = slot.width ? MMIN(slot.width, image->width - x) : image->width;
+        const u32 height = slot.width ? MMIN(slot.height, image->height - y) : image->height;
+        const u32 channels = texture->ChannelCount > 0 ? texture->ChannelCount : 4;
+        const u32 layers = texture->type == TextureType::Cube ? 6 : 1;
+        const u64 size = (u64)width * height * channels * layers;
+        if (slot.ReadOffset + slot.ReadSize > size) {
+            MERROR("VulkanReadbackRecord — диапазон чтения %llu-%llu вне данных текстуры '%s' (%llu байт).",
+                   slot.ReadOffset, slot.ReadOffset + slot.ReadSize, texture->name, size);
+            ReadbackFail(VkAPI, slot);
+            continue;
+        }
+
+        VkBuffer target;
+        u64 offset = 0;
+        const u64 AllocSize = ReadbackAlign(size);
+        if (queue.mapped && queue.buffer.BufferFreelist.FreeSpace() >= AllocSize && queue.buffer.Allocate(AllocSize, offset)) {
+            target = reinterpret_cast<VulkanBuffer*>(queue.buffer.data)->handle;
+        } else {
+            // Редкие большие чтения (например, снимки экрана) не держат место в кольце.
+            if (!VkAPI->RenderBufferCreate("renderbuffer_readback_dedicated", RenderBufferType::Read, size, false, slot.dedicated)) {
+                MERROR("VulkanReadbackRecord — не удалось создать буфер чтения размером %llu байт.", size);
+                ReadbackFail(VkAPI, slot);
+                continue;
+            }
+            VkAPI->RenderBufferBind(slot.dedicated, 0);
+            slot.DedicatedMapped = reinterpret_cast<u8*>(VkAPI->RenderBufferMapMemory(slot.dedicated, 0, VK_WHOLE_SIZE));
+            target = reinterpret_cast<VulkanBuffer*>(slot.dedicated.data)->handle;
+        }
+        slot.offset = offset;
+        slot.size = size;
+
+        const VkImageLayout layout = ReadbackImageLayout(texture);
+        VkImageMemoryBarrier barrier = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image->handle;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.layerCount = layers;
+
+        // Копирование ждет записи проходов кадра в вложение.
+        barrier.oldLayout = layout;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(
+            CommandBuffer.handle,
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        VkBufferImageCopy region = {};
+        region.bufferOffset = offset;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = layers;
+        region.imageOffset.x = x;
+        region.imageOffset.y = y;
+        region.imageExtent.width = width;
+        region.imageExtent.height = height;
+        region.imageExtent.depth = 1;
+        vkCmdCopyImageToBuffer(CommandBuffer.handle, image->handle, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, target, 1, &region);
+
+        // Вернуть изображение в прежний макет до следующего кадра.
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = layout;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(
+            CommandBuffer.handle,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        slot.frame = VkAPI->CurrentFrame;
+        slot.FrameNumber = VkAPI->FrameNumber;
+        __atomic_store_n(&slot.state, VulkanReadbackState::Recorded, __ATOMIC_RELEASE);
+        RecordedCount++;
+    }
+
+    if (RecordedCount) {
+        // Делает скопированные данные видимыми для CPU после ожидания ограждения кадра.
+        VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(
+            CommandBuffer.handle,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+            0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+}
+
+void VulkanReadbackCollect(VulkanAPI *VkAPI, VulkanReadbackQueue &queue, bool idle)
+{
+    for (u8 i = 0; i < VULKAN_READBACK_SLOT_COUNT; ++i) {
+        auto& slot = queue.slots[i];
+        u32 state = __atomic_load_n(&slot.state, __ATOMIC_ACQUIRE);
+
+        if (state == VulkanReadbackState::Recorded && (idle || slot.frame == VkAPI->CurrentFrame)) {
+            // Ограждение кадра, записавшего копирование, уже дождались.
+            slot.FrameNumber = VkAPI->FrameNumber;
+            __atomic_store_n(&slot.state, VulkanReadbackState::Ready, __ATOMIC_RELEASE);
+            continue;
+        }
+
+        if ((state == VulkanReadbackState::Ready || state == VulkanReadbackState::Failed) &&
+            VkAPI->FrameNumber - slot.FrameNumber > VULKAN_READBACK_EXPIRE_FRAMES) {
+            // Результат никто не забрал. Опрос мог начаться одновременно, поэтому ячейка захватывается атомарно.
+            if (__atomic_compare_exchange_n(&slot.state, &state, VulkanReadbackState::Consumed, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                MWARN("VulkanReadbackCollect — результат чтения %llu не был забран и освобожден.", slot.ticket);
+                queue.ExpiredCount++;
+                state = VulkanReadbackState::Consumed;
+            }
+        }
+
+        if (state == VulkanReadbackState::Consumed) {
+            ReadbackRelease(VkAPI, queue, slot);
+        }
+    }
+}
+
+ReadbackStatus VulkanReadbackPoll(VulkanReadbackQueue &queue, u64 ticket, void *OutMemory)
+{
+    if (!ticket) {
+        return ReadbackStatus::Invalid;
+    }
+
+    for (u8 i = 0; i < VULKAN_READBACK_SLOT_COUNT; ++i) {
+        auto& slot = queue.slots[i];
+        if (__atomic_load_n(&slot.ticket, __ATOMIC_ACQUIRE) != ticket) {
+            continue;
+        }
+
+        u32 state = __atomic_load_n(&slot.state, __ATOMIC_ACQUIRE);
+        switch (state) {
+            case VulkanReadbackState::Claimed:
+            case VulkanReadbackState::Requested:
+            case VulkanReadbackState::Recorded:
+                return ReadbackStatus::Pending;
+            case VulkanReadbackState::Ready:
+                if (!__atomic_compare_exchange_n(&slot.state, &state, READBACK_STATE_READING, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                    // Результат забрал другой поток или он истек.
+                    return ReadbackStatus::Invalid;
+                }
+                {
+                    const u8* source = slot.dedicated.data ? slot.DedicatedMapped : queue.mapped + slot.offset;
+                    MemorySystem::CopyMem(OutMemory, source + slot.ReadOffset, slot.ReadSize);
+                }
+                __atomic_add_fetch(&queue.CompletedCount, 1, __ATOMIC_RELAXED);
+                __atomic_store_n(&slot.state, VulkanReadbackState::Consumed, __ATOMIC_RELEASE);
+                return ReadbackStatus::Ready;
+            case VulkanReadbackState::Failed:
+                __atomic_compare_exchange_n(&slot.state, &state, VulkanReadbackState::Consumed, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+                return ReadbackStatus::Invalid;
+            default:
+                return ReadbackStatus::Invalid;
+        }
+    }
+
+    return ReadbackStatus::Invalid;
+}
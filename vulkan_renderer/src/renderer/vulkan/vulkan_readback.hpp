@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include "renderer/renderbuffer.h"
+#include "renderer/renderer_types.h"
+#include "resources/texture.hpp"
+#include "vulkan_command_buffer.hpp"
+
+class VulkanAPI;
+
+constexpr u8 VULKAN_READBACK_SLOT_COUNT = 32;                            // Максимальное количество одновременно ожидающих чтений.
+constexpr u64 VULKAN_READBACK_RING_SIZE = 16 * 1024 * 1024;              // Размер кольца чтения. Чтения большего размера получают отдельный буфер.
+constexpr u64 VULKAN_READBACK_EXPIRE_FRAMES = 120;                       // Через сколько кадров освобождается готовый, но не забранный результат.
+
+/// @brief Состояние ячейки чтения. Переходы Free -> Claimed -> Requested выполняет запрашивающий поток,
+/// Requested -> Recorded -> Ready и Consumed -> Free — основной поток, Ready -> Consumed — опрашивающий поток.
+namespace VulkanReadbackState {
+    enum : u32 { Free, Claimed, Requested, Recorded, Ready, Failed, Consumed };
+}
+
+/// @brief Одно асинхронное чтение изображения в видимую хосту память.
+struct VulkanReadback {
+    u64 ticket;                                                           // Номер чтения, возвращенный запросившему.
+    Texture* texture;                                                     // Читаемая текстура. Изображение берется из нее при записи команд.
+    u32 x, y, width, height;                                              // Копируемая область изображения. Нулевая ширина означает все изображение.
+    u64 ReadOffset;                                                       // Смещение возвращаемых данных внутри скопированной области.
+    u64 ReadSize;                                                         // Размер возвращаемых данных в байтах.
+    u64 offset;                                                           // Смещение скопированной области в кольце.
+    u64 size;                                                             // Размер скопированной области в байтах.
+    RenderBuffer dedicated;                                               // Отдельный буфер, если область не поместилась в кольцо.
+    u8* DedicatedMapped;                                                  // Отображение отдельного буфера.
+    u64 FrameNumber;                                                      // Кадр, в котором было записано копирование или получен результат.
+    u32 frame;                                                            // Индекс кадра в полете, ограждение которого завершает копирование.
+    u32 state;                                                            // VulkanReadbackState. Изменяется атомарно.
+
+    constexpr VulkanReadback()
+    : ticket(), texture(nullptr), x(), y(), width(), height(), ReadOffset(), ReadSize(), offset(), size(), dedicated(), DedicatedMapped(nullptr), FrameNumber(), frame(), state(VulkanReadbackState::Free) {}
+};
+
+/// @brief Очередь асинхронных чтений из GPU. Запросы принимаются из любого потока записи, копирования
+/// записываются в буфер кадра после всех проходов рендеринга, а результат становится доступен после
+/// ожидания ограждения этого кадра, то есть через столько кадров, сколько их в полете. CPU при этом не ждет GPU.
+struct VulkanReadbackQueue {
+    RenderBuffer buffer;                                                  // Постоянное видимое хосту кольцо со списком свободной памяти.
+    u8* mapped;                                                           // Постоянное отображение кольца.
+    VulkanReadback slots[VULKAN_READBACK_SLOT_COUNT];
+    u64 NextTicket;                                                       // Номер последнего выданного чтения. Изменяется атомарно.
+    u64 CompletedCount;                                                   // Количество чтений, результат которых был забран.
+    u32 ExpiredCount;                                                     // Количество результатов, освобожденных без опроса.
+
+    constexpr VulkanReadbackQueue()
+    : buffer(), mapped(nullptr), slots(), NextTicket(), CompletedCount(), ExpiredCount() {}
+};
+
+/// @brief Создает очередь чтений и ее постоянно отображенное кольцо.
+/// @param VkAPI указатель на Vulkan.
+/// @param size размер кольца в байтах.
+/// @param OutQueue очередь чтений.
+/// @return true в случае успеха; в противном случае false.
+bool VulkanReadbackCreate(VulkanAPI* VkAPI, u64 size, VulkanReadbackQueue& OutQueue);
+
+/// @brief Уничтожает очередь чтений. Устройство должно быть свободно.
+/// @param VkAPI указатель на Vulkan.
+/// @param queue очередь чтений.
+void VulkanReadbackDestroy(VulkanAPI* VkAPI, VulkanReadbackQueue& queue);
+
+/// @brief Ставит чтение области текстуры в очередь. Может вызываться из любого потока.
+/// @param queue очередь чтений.
+/// @param texture читаемая текстура.
+/// @param x координата x области.
+/// @param y координата y области.
+/// @param width ширина области; 0 — все изображение.
+/// @param height высота области.
+/// @param ReadOffset смещение возвращаемых данных внутри области.
+/// @param ReadSize размер возвращаемых данных в байтах.
+/// @return номер чтения; 0, если свободных ячеек нет.
+u64 VulkanReadbackRequest(VulkanReadbackQueue& queue, Texture* texture, u32 x, u32 y, u32 width, u32 height, u64 ReadOffset, u64 ReadSize);
+
+/// @brief Записывает копирования всех поставленных в очередь чтений. Вызывается основным потоком
+/// перед завершением буфера кадра, поэтому копирования видят результат всех проходов кадра.
+/// @param VkAPI указатель на Vulkan.
+/// @param queue очередь чтений.
+/// @param CommandBuffer основной буфер команд кадра.
+void VulkanReadbackRecord(VulkanAPI* VkAPI, VulkanReadbackQueue& queue, VulkanCommandBuffer& CommandBuffer);
+
+/// @brief Отмечает готовыми чтения, ограждение кадра которых уже дождались, и освобождает забранные результаты.
+/// Вызывается основным потоком после ожидания ограждения текущего кадра.
+/// @param VkAPI указатель на Vulkan.
+/// @param queue очередь чтений.
+/// @param idle устройство свободно, поэтому готовы все записанные чтения.
+void VulkanReadbackCollect(VulkanAPI* VkAPI, VulkanReadbackQueue& queue, bool idle);
+
+/// @brief Проверяет чтение и, если оно готово, копирует результат. Может вызываться из любого потока.
+/// @param queue очередь чтений.
+/// @param ticket номер чтения.
+/// @param OutMemory память для результата размером не меньше запрошенного.
+/// @return ReadbackStatus::Ready, если результат скопирован; Pending, если он еще не готов;
+/// Invalid, если номер неизвестен, результат уже забран или чтение не удалось.
+ReadbackStatus VulkanReadbackPoll(VulkanReadbackQueue& queue, u64 ticket, void* OutMemory);
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <containers/darray.h>
+#include "vulkan_command_buffer.hpp"
+
+constexpr u8 VULKAN_MAX_RECORDING_CONTEXTS = 4;  // Максимальное количество контекстов параллельной записи команд.
+constexpr u8 VULKAN_MAX_RECORDED_PASSES = 16;    // Максимальное количество проходов рендеринга, записываемых одним контекстом за кадр.
+constexpr u8 VULKAN_MAX_FRAMES_IN_FLIGHT = 3;    // Количество наборов пулов команд в контексте, по одному на кадр в полете.
+
+/// @brief Проход рендеринга, записанный во вторичный буфер команд. Основной поток начинает проход
+/// с этими параметрами и выполняет в нем вторичный буфер.
+struct VulkanRecordedPass {
+    VkRenderPass renderpass;
+    VkFramebuffer framebuffer;
+    VkRect2D RenderArea;
+    u32 ClearValueCount;
+    VkClearValue ClearValues[2];
+    VkCommandBuffer secondary;
+    const char* name;                                                  // Имя прохода для меток времени. Проход живет дольше кадра.
+};
+
+/// @brief Контекст записи команд. Принадлежит одному потоку на время между RecordingBegin и RecordingEnd.
+/// Каждый проход рендеринга, начатый в контексте, записывается в отдельный вторичный буфер команд из
+/// собственного пула контекста, поэтому потоки не разделяют ни пулы, ни буферы команд.
+struct VulkanRecordingContext {
+    VkCommandPool pools[VULKAN_MAX_FRAMES_IN_FLIGHT];                  // Пулы команд, по одному на кадр в полете.
+    DArray<VulkanCommandBuffer> buffers[VULKAN_MAX_FRAMES_IN_FLIGHT];  // Выделенные вторичные буферы, переиспользуются после сброса пула.
+    u32 UsedCount;                                                     // Количество вторичных буферов, использованных в текущем кадре.
+    u64 FrameNumber;                                                   // Номер кадра, для которого был сброшен пул.
+    VulkanRecordedPass passes[VULKAN_MAX_RECORDED_PASSES];
+    u8 PassCount;
+    VulkanCommandBuffer* current;                                      // Вторичный буфер, в который сейчас идет запись. nullptr вне прохода.
+
+    // Динамическое состояние сохраняется, так как вторичный буфер не наследует его от основного.
+    struct Shader* BoundShader;
+    VkViewport viewport;
+    VkRect2D scissor;
+    VkFrontFace winding;
+
+    constexpr VulkanRecordingContext()
+    : pools(), buffers(), UsedCount(), FrameNumber(INVALID::U64ID), passes(), PassCount(), current(nullptr),
+    BoundShader(nullptr), viewport(), scissor(), winding(VK_FRONT_FACE_COUNTER_CLOCKWISE) {}
+};
@@ -11,8 +11,17 @@ VulkanShader::VulkanShader()
     DescriptorPool(),
     DescriptorSetLayouts(),
     GlobalDescriptorSets(),
+    bindless(false),
+    MaterialDescriptorSet(),
     UniformBuffer(),
+    GlobalRingOffset(),
+    GlobalRingFrame(),
     pipelines(nullptr),
+    PendingBuild(nullptr),
+    IndirectStageConfig(),
+    IndirectStage(),
+    IndirectStageIndex(),
+    IndirectPipeline(nullptr),
     InstanceCount(),
     InstanceStates() 
 {}
@@ -44,7 +44,7 @@ struct VulkanDescriptorSetConfig {
 struct VulkanShaderConfig {
     u8 StageCount;                                                                      // Количество этапов в этом шейдере.
     VulkanShaderStageConfig stages[VulkanShaderConstants::MaxStages];                   // Конфигурация для каждого этапа этого шейдера.
-    VkDescriptorPoolSize PoolSizes[2];                                                  // Массив размеров пула дескрипторов.
+    VkDescriptorPoolSize PoolSizes[3];                                                  // Массив размеров пула дескрипторов.
     u16 MaxDescriptorSetCount;                                                          // Максимальное количество наборов дескрипторов, которые можно выделить из этого шейдера. Обычно должно быть достаточно большое число.
     u8 DescriptorSetCount;                                                              // Общее количество наборов дескрипторов, настроенных для этого шейдера. Имеет значение 1, если используются только глобальные униформы/сэмплеры; иначе 2.
     VulkanDescriptorSetConfig DescriptorSets[2];                                        // Наборы дескрипторов, максимум 2. Индекс 0 = глобальный, 1 = экземпляр.
@@ -73,9 +73,12 @@ struct VulkanShaderDescriptorSetState {
 struct VulkanShaderInstanceState {
     u32 id;                                             // Идентификатор экземпляра. INVALID::ID, если не используется.
     u64 offset;                                         // Смещение в байтах в универсальном буфере экземпляра. 
+    u32 RingOffset;                                     // Динамическое смещение данных экземпляра в кольце униформ.
+    u64 RingFrame;                                      // Кадр кольца, в котором данные скопированы. Срез действителен только в этом кадре.
+    u64 SamplerKeys[3];                                 // Ключ текстур и сэмплеров, записанных в набор дескрипторов каждого кадра. 0, если набор еще не записан.
     VulkanShaderDescriptorSetState DescriptorSetState;  // Состояние набора дескрипторов. 
     struct TextureMap** InstanceTextureMaps;             // Указатели экземпляров текстурных карт, которые используются во время рендеринга. Они устанавливаются вызовами SetSampler.
-    constexpr VulkanShaderInstanceState() : id(INVALID::ID), offset(), DescriptorSetState(), InstanceTextureMaps(nullptr) {}
+    constexpr VulkanShaderInstanceState() : id(INVALID::ID), offset(), RingOffset(), RingFrame(), SamplerKeys(), DescriptorSetState(), InstanceTextureMaps(nullptr) {}
 };
  
 /// @brief Представляет универсальный шейдер Vulkan. 
@@ -90,9 +93,18 @@ struct VulkanShader {
     VkDescriptorPool DescriptorPool;                                    // Пул дескрипторов, используемый для этого шейдера.
     VkDescriptorSetLayout DescriptorSetLayouts[2];                      // Макеты набора дескрипторов, максимум 2. Индекс 0 = глобальный, 1 = экземпляр.
     VkDescriptorSet GlobalDescriptorSets[3];                            // Наборы глобальных дескрипторов, по одному на кадр.
-    RenderBuffer UniformBuffer;                                         // Универсальный буфер, используемый этим шейдером.
+    bool bindless;                                                      // Шейдер работает в режиме без привязки: данные экземпляров читаются из буфера хранения, текстуры — из общей таблицы.
+    VkDescriptorSet MaterialDescriptorSet;                              // Набор с буфером хранения записей материалов. Только в режиме без привязки.
+    RenderBuffer UniformBuffer;                                         // Униформы шейдера, записываемые SetUniform. Вне режима без привязки GPU читает их копии в кольце униформ.
+    u32 GlobalRingOffset;                                               // Динамическое смещение глобальных данных в кольце униформ.
+    u64 GlobalRingFrame;                                                // Кадр кольца, в котором глобальные данные скопированы.
     VulkanPipeline** pipelines;                                         // Массив указателей на конвейеры, связанные с этим шейдером.
     VulkanPipeline** ClockwisePipelines;                                // Массив указателей на конвейеры, связанные с этим шейдером. Намотка по часовой стрелке. Используется только при отсутствии собственной поддержки или поддержки расширений.
+    struct VulkanPipelineBuild* PendingBuild;                           // Незавершенное отложенное создание конвейеров. nullptr, если конвейеры готовы.
+    VulkanShaderStageConfig IndirectStageConfig;                        // Вершинный этап косвенной отрисовки. Пустое имя файла, если шейдер ее не поддерживает.
+    VulkanShaderStage IndirectStage;                                    // Модуль вершинного этапа косвенной отрисовки.
+    u8 IndirectStageIndex;                                              // Индекс вершинного этапа, который он заменяет.
+    VulkanPipeline* IndirectPipeline;                                   // Конвейер косвенной отрисовки экземпляров, отсеченных на GPU. nullptr, если не используется.
     u8 BoundPipelineIndex;                                              // Текущий связанный индекс конвеера.
     VkPrimitiveTopology CurrentTopology;                                // Текущая выбранная топология.
     u32 InstanceCount;                                                  // Экземпляр состояния для всех экземпляров. ЗАДАЧА: динамичным */
@@ -0,0 +1,438 @@
+#include "vulkan_staging.hpp"
+#include "vulkan_api.h"
+#include "vulkan_image.hpp"
+#include "vulkan_buffer.hpp"
+#include "vulkan_utils.h"
+
+#include <core/event.h>
+
+/// @brief Выравнивает смещение в разделе. Смещение копирования в изображение должно быть кратно 4 и размеру texel.
+static u64 StagingAlign(u64 offset, u32 TexelSize)
+{
+    const u64 alignment = TexelSize == 3 ? 48 : 16;
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+/// @brief Сообщает о завершении пакета. Ограждение пакета должно быть в сигнальном состоянии.
+static void StagingComplete(VulkanStagingBatch& batch)
+{
+    batch.submitted = false;
+
+    EventContext context{};
+    context.data.u64[0] = batch.ticket;
+    context.data.u32[2] = batch.TextureCount;
+    context.data.u32[3] = batch.GeometryCount;
+    EventSystem::Fire(EventSystem::RenderUploadsCompleted, nullptr, context);
+}
+
+/// @brief Открывает текущий пакет. Если его раздел еще используется GPU, дожидается ограждения.
+static bool StagingOpen(VulkanAPI* VkAPI, VulkanStagingRing& ring)
+{
+    auto& batch = ring.batches[ring.current];
+    if (batch.open) {
+        return true;
+    }
+
+    if (batch.submitted) {
+        if (vkGetFenceStatus(VkAPI->Device.LogicalDevice, batch.fence) != VK_SUCCESS) {
+            // Загрузки опережают GPU на все кольцо.
+            ring.StallCount++;
+            VkResult result = vkWaitForFences(VkAPI->Device.LogicalDevice, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+            if (!VulkanResultIsSuccess(result)) {
+                MERROR("VulkanStaging — ошибка ожидания пакета загрузок: %s", VulkanResultString(result, true));
+                return false;
+            }
+        }
+        StagingComplete(batch);
+    }
+    VK_CHECK(vkResetFences(VkAPI->Device.LogicalDevice, 1, &batch.fence));
+
+    batch.used = 0;
+    batch.TextureCount = 0;
+    batch.GeometryCount = 0;
+    batch.acquires.Clear();
+    VulkanCommandBufferReset(&batch.TransferBuffer);
+    VulkanCommandBufferReset(&batch.AcquireBuffer);
+    VulkanCommandBufferReset(&batch.GraphicsBuffer);
+    batch.ticket = ++ring.NextTicket;
+    batch.open = true;
+    return true;
+}
+
+/// @brief Выделяет место в разделе текущего пакета. Если раздел заполнен, отправляет пакет и переходит к следующему.
+/// @return смещение в буфере кольца или INVALID::U64ID, если данные больше раздела.
+static u64 StagingAllocate(VulkanAPI* VkAPI, VulkanStagingRing& ring, u64 size, u32 TexelSize)
+{
+    if (!ring.mapped || size > ring.PartitionSize) {
+        return INVALID::U64ID;
+    }
+
+    if (!StagingOpen(VkAPI, ring)) {
+        return INVALID::U64ID;
+    }
+    u64 offset = StagingAlign(ring.batches[ring.current].used, TexelSize);
+    if (offset + size > ring.PartitionSize) {
+        if (!VulkanStagingFlush(VkAPI, ring, false) || !StagingOpen(VkAPI, ring)) {
+            return INVALID::U64ID;
+        }
+        offset = 0;
+    }
+
+    ring.batches[ring.current].used = offset + size;
+    return ring.current * ring.PartitionSize + offset;
+}
+
+/// @brief Начинает запись буфера команд пакета при первом обращении.
+static VulkanCommandBuffer& StagingCommandBuffer(VulkanCommandBuffer& CommandBuffer, bool graphics)
+{
+    if (CommandBuffer.state != COMMAND_BUFFER_STATE_RECORDING) {
+        VulkanCommandBufferBegin(&CommandBuffer, true, false, false);
+        if (graphics) {
+            // Копирования графической очереди могут перезаписывать данные, которые читают предыдущие кадры.
+            vkCmdPipelineBarrier(
+                CommandBuffer.handle,
+                VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                0, 0, nullptr, 0, nullptr, 0, nullptr);
+        }
+    }
+    return CommandBuffer;
+}
+
+bool VulkanStagingCreate(VulkanAPI *VkAPI, u64 PartitionSize, VulkanStagingRing &OutRing)
+{
+    auto& device = VkAPI->Device;
+
+    OutRing.PartitionSize = PartitionSize;
+    OutRing.buffer.name = "renderbuffer_staging_ring";
+    OutRing.buffer.type = RenderBufferType::Staging;
+    OutRing.buffer.TotalSize = PartitionSize * VULKAN_STAGING_BATCH_COUNT;
+    if (!VkAPI->RenderBufferCreateInternal(OutRing.buffer)) {
+        MERROR("VulkanStagingCreate — не удалось создать промежуточный буфер.");
+        return false;
+    }
+    VkAPI->RenderBufferBind(OutRing.buffer, 0);
+    OutRing.mapped = reinterpret_cast<u8*>(VkAPI->RenderBufferMapMemory(OutRing.buffer, 0, VK_WHOLE_SIZE));
+
+    OutRing.dedicated = device.TransferQueueIndex != device.GraphicsQueueIndex;
+    if (OutRing.dedicated) {
+        VkCommandPoolCreateInfo PoolCreateInfo = {VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+        PoolCreateInfo.queueFamilyIndex = device.TransferQueueIndex;
+        PoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        VK_CHECK(vkCreateCommandPool(device.LogicalDevice, &PoolCreateInfo, VkAPI->allocator, &OutRing.TransferPool));
+    }
+
+    for (u8 i = 0; i < VULKAN_STAGING_BATCH_COUNT; ++i) {
+        auto& batch = OutRing.batches[i];
+        if (OutRing.dedicated) {
+            VulkanCommandBufferAllocate(VkAPI, OutRing.TransferPool, true, &batch.TransferBuffer);
+            VulkanCommandBufferAllocate(VkAPI, device.GraphicsCommandPool, true, &batch.AcquireBuffer);
+        }
+        VulkanCommandBufferAllocate(VkAPI, device.GraphicsCommandPool, true, &batch.GraphicsBuffer);
+
+        VkSemaphoreCreateInfo SemaphoreCreateInfo = {VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+        VK_CHECK(vkCreateSemaphore(device.LogicalDevice, &SemaphoreCreateInfo, VkAPI->allocator, &batch.semaphore));
+        VkFenceCreateInfo FenceCreateInfo = {VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+        VK_CHECK(vkCreateFence(device.LogicalDevice, &FenceCreateInfo, VkAPI->allocator, &batch.fence));
+    }
+
+    MINFO("Промежуточное кольцо: %u разделов по %llu МБ, очередь %s.",
+          VULKAN_STAGING_BATCH_COUNT, PartitionSize / (1024 * 1024), OutRing.dedicated ? "передачи" : "графики");
+    return true;
+}
+
+void VulkanStagingDestroy(VulkanAPI *VkAPI, VulkanStagingRing &ring)
+{
+    if (!ring.mapped) {
+        return;
+    }
+    VulkanStagingFlush(VkAPI, ring, true);
+
+    auto& device = VkAPI->Device;
+    for (u8 i = 0; i < VULKAN_STAGING_BATCH_COUNT; ++i) {
+        auto& batch = ring.batches[i];
+        if (ring.dedicated) {
+            VulkanCommandBufferFree(VkAPI, ring.TransferPool, &batch.TransferBuffer);
+            VulkanCommandBufferFree(VkAPI, device.GraphicsCommandPool, &batch.AcquireBuffer);
+        }
+        VulkanCommandBufferFree(VkAPI, device.GraphicsCommandPool, &batch.GraphicsBuffer);
+        vkDestroySemaphore(device.LogicalDevice, batch.semaphore, VkAPI->allocator);
+        vkDestroyFence(device.LogicalDevice, batch.fence, VkAPI->allocator);
+        batch.semaphore = VK_NULL_HANDLE;
+        batch.fence = VK_NULL_HANDLE;
+        batch.acquires.Destroy();
+    }
+    if (ring.TransferPool) {
+        vkDestroyCommandPool(device.LogicalDevice, ring.TransferPool, VkAPI->allocator);
+        ring.TransferPool = VK_NULL_HANDLE;
+    }
+
+    VkAPI->RenderBufferUnmapMemory(ring.buffer, 0, VK_WHOLE_SIZE);
+    VkAPI->RenderBufferDestroyInternal(ring.buffer);
+    ring.mapped = nullptr;
+
+    MDEBUG("Промежуточное кольцо: отправлено %llu КБ, ожиданий освобождения раздела: %u.", ring.SubmittedBytes / 1024, ring.StallCount);
+}
+
+bool VulkanStagingUploadImage(VulkanAPI *VkAPI, VulkanStagingRing &ring, VulkanImage *image, TextureType type, u32 TexelSize, u64 size, const void *pixels, bool IsNew)
+{
+    const u64 offset = StagingAllocate(VkAPI, ring, size, TexelSize);
+    if (offset == INVALID::U64ID) {
+        return false;
+    }
+    MemorySystem::CopyMem(ring.mapped + offset, pixels, size);
+
+    auto& batch = ring.batches[ring.current];
+    auto& device = VkAPI->Device;
+    // Новое изображение еще не принадлежит графической очереди, поэтому его можно загрузить на очереди передачи.
+    const bool transfer = ring.dedicated && IsNew;
+    auto& CommandBuffer = transfer ? StagingCommandBuffer(batch.TransferBuffer, false) : StagingCommandBuffer(batch.GraphicsBuffer, true);
+
+    VkImageMemoryBarrier barrier = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image->handle;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = type == TextureType::Cube ? 6 : 1;
+
+    // Прежнее содержимое не сохраняется.
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(
+        CommandBuffer.handle,
+        transfer ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = offset;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = barrier.subresourceRange.layerCount;
+    region.imageExtent.width = image->width;
+    region.imageExtent.height = image->height;
+    region.imageExtent.depth = 1;
+    vkCmdCopyBufferToImage(
+        CommandBuffer.handle,
+        reinterpret_cast<VulkanBuffer*>(ring.buffer.data)->handle,
+        image->handle,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        1, &region);
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    if (transfer) {
+        // Передача владения графической очереди. Переход макета выполняется один раз, барьер получения повторяет его.
+        barrier.srcQueueFamilyIndex = device.TransferQueueIndex;
+        barrier.dstQueueFamilyIndex = device.GraphicsQueueIndex;
+        barrier.dstAccessMask = 0;
+        vkCmdPipelineBarrier(
+            CommandBuffer.handle,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        batch.acquires.PushBack(barrier);
+    } else {
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(
+            CommandBuffer.handle,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+
+    batch.TextureCount++;
+    return true;
+}
+
+bool VulkanStagingUploadImageRegion(VulkanAPI *VkAPI, VulkanStagingRing &ring, VulkanImage *image, u32 TexelSize, u32 x, u32 y, u32 width, u32 height, const void *pixels)
+{
+    const u64 size = (u64)width * height * TexelSize;
+    const u64 offset = StagingAllocate(VkAPI, ring, size, TexelSize);
+    if (offset == INVALID::U64ID) {
+        return false;
+    }
+    MemorySystem::CopyMem(ring.mapped + offset, pixels, size);
+
+    // Изображение уже читается шейдерами кадров, поэтому область записывается на графической очереди.
+    auto& batch = ring.batches[ring.current];
+    auto& CommandBuffer = StagingCommandBuffer(batch.GraphicsBuffer, true);
+
+    VkImageMemoryBarrier barrier = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image->handle;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+
+    // Прежнее содержимое сохраняется: запись ждет чтений шейдерами из предыдущих кадров.
+    barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(
+        CommandBuffer.handle,
+        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = offset;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset.x = x;
+    region.imageOffset.y = y;
+    region.imageExtent.width = width;
+    region.imageExtent.height = height;
+    region.imageExtent.depth = 1;
+    vkCmdCopyBufferToImage(
+        CommandBuffer.handle,
+        reinterpret_cast<VulkanBuffer*>(ring.buffer.data)->handle,
+        image->handle,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        1, &region);
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(
+        CommandBuffer.handle,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    batch.TextureCount++;
+    return true;
+}
+
+bool VulkanStagingUploadBuffer(VulkanAPI *VkAPI, VulkanStagingRing &ring, VkBuffer dest, u64 offset, u64 size, const void *data)
+{
+    const u64 StagingOffset = StagingAllocate(VkAPI, ring, size, 1);
+    if (StagingOffset == INVALID::U64ID) {
+        return false;
+    }
+    MemorySystem::CopyMem(ring.mapped + StagingOffset, data, size);
+
+    // Буферы вершин и индексов принадлежат графической очереди, поэтому копируются на ней.
+    auto& batch = ring.batches[ring.current];
+    auto& CommandBuffer = StagingCommandBuffer(batch.GraphicsBuffer, true);
+
+    VkBufferCopy region;
+    region.srcOffset = StagingOffset;
+    region.dstOffset = offset;
+    region.size = size;
+    vkCmdCopyBuffer(CommandBuffer.handle, reinterpret_cast<VulkanBuffer*>(ring.buffer.data)->handle, dest, 1, &region);
+
+    batch.GeometryCount++;
+    return true;
+}
+
+bool VulkanStagingFlush(VulkanAPI *VkAPI, VulkanStagingRing &ring, bool wait)
+{
+    auto& batch = ring.batches[ring.current];
+    auto& device = VkAPI->Device;
+
+    if (batch.open) {
+        VkCommandBuffer CommandBuffers[2];
+        u32 CommandBufferCount = 0;
+
+        const bool transfer = batch.TransferBuffer.state == COMMAND_BUFFER_STATE_RECORDING;
+        if (transfer) {
+            VulkanCommandBufferEnd(&batch.TransferBuffer);
+
+            VkSubmitInfo SubmitInfo = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+            SubmitInfo.commandBufferCount = 1;
+            SubmitInfo.pCommandBuffers = &batch.TransferBuffer.handle;
+            SubmitInfo.signalSemaphoreCount = 1;
+            SubmitInfo.pSignalSemaphores = &batch.semaphore;
+            VkResult result = vkQueueSubmit(device.TransferQueue, 1, &SubmitInfo, VK_NULL_HANDLE);
+            if (!VulkanResultIsSuccess(result)) {
+                MERROR("VulkanStagingFlush — ошибка отправки в очередь передачи: %s", VulkanResultString(result, true));
+                return false;
+            }
+            VulkanCommandBufferUpdateSubmitted(&batch.TransferBuffer);
+
+            VulkanCommandBufferBegin(&batch.AcquireBuffer, true, false, false);
+            vkCmdPipelineBarrier(
+                batch.AcquireBuffer.handle,
+                VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                0, 0, nullptr, 0, nullptr, batch.acquires.Length(), batch.acquires.Data());
+            VulkanCommandBufferEnd(&batch.AcquireBuffer);
+            CommandBuffers[CommandBufferCount++] = batch.AcquireBuffer.handle;
+        }
+
+        if (batch.GraphicsBuffer.state == COMMAND_BUFFER_STATE_RECORDING) {
+            // Делает скопированные данные буферов видимыми для чтения вершин и индексов.
+            VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+            vkCmdPipelineBarrier(
+                batch.GraphicsBuffer.handle,
+                VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                0, 1, &barrier, 0, nullptr, 0, nullptr);
+            VulkanCommandBufferEnd(&batch.GraphicsBuffer);
+            CommandBuffers[CommandBufferCount++] = batch.GraphicsBuffer.handle;
+        }
+
+        // Графическая отправка несет ограждение пакета, даже если в ней нет буферов команд.
+        const VkPipelineStageFlags WaitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        VkSubmitInfo SubmitInfo = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+        SubmitInfo.commandBufferCount = CommandBufferCount;
+        SubmitInfo.pCommandBuffers = CommandBuffers;
+        SubmitInfo.waitSemaphoreCount = transfer ? 1 : 0;
+        SubmitInfo.pWaitSemaphores = &batch.semaphore;
+        SubmitInfo.pWaitDstStageMask = &WaitStage;
+        VkResult result = vkQueueSubmit(device.GraphicsQueue, 1, &SubmitInfo, batch.fence);
+        if (!VulkanResultIsSuccess(result)) {
+            MERROR("VulkanStagingFlush — ошибка отправки в графическую очередь: %s", VulkanResultString(result, true));
+            return false;
+        }
+        if (transfer) {
+            VulkanCommandBufferUpdateSubmitted(&batch.AcquireBuffer);
+        }
+        if (batch.GraphicsBuffer.state == COMMAND_BUFFER_STATE_RECORDING_ENDED) {
+            VulkanCommandBufferUpdateSubmitted(&batch.GraphicsBuffer);
+        }
+
+        MTRACE("VulkanStagingFlush — пакет %llu: %u текстур, %u буферов, %llu КБ.",
+               batch.ticket, batch.TextureCount, batch.GeometryCount, batch.used / 1024);
+        ring.SubmittedBytes += batch.used;
+        batch.open = false;
+        batch.submitted = true;
+        ring.current = (ring.current + 1) % VULKAN_STAGING_BATCH_COUNT;
+    }
+
+    if (wait) {
+        // Пакеты завершаются в порядке отправки; самый старый следует за текущим.
+        for (u8 i = 0; i < VULKAN_STAGING_BATCH_COUNT; ++i) {
+            auto& pending = ring.batches[(ring.current + i) % VULKAN_STAGING_BATCH_COUNT];
+            if (pending.submitted) {
+                VK_CHECK(vkWaitForFences(device.LogicalDevice, 1, &pending.fence, VK_TRUE, UINT64_MAX));
+                StagingComplete(pending);
+            }
+        }
+    }
+    return true;
+}
+
+void VulkanStagingCollect(VulkanAPI *VkAPI, VulkanStagingRing &ring)
+{
+    for (u8 i = 0; i < VULKAN_STAGING_BATCH_COUNT; ++i) {
+        auto& batch = ring.batches[(ring.current + i) % VULKAN_STAGING_BATCH_COUNT];
+        if (batch.submitted) {
+            if (vkGetFenceStatus(VkAPI->Device.LogicalDevice, batch.fence) != VK_SUCCESS) {
+                // Более поздние пакеты тоже не завершены.
+                return;
+            }
+            StagingComplete(batch);
+        }
+    }
+}
+
+u64 VulkanStagingTicket(const VulkanStagingRing &ring)
+{
+    const auto& batch = ring.batches[ring.current];
+    return batch.open ? batch.ticket : ring.NextTicket + 1;
+}
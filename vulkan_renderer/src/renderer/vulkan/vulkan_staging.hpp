@@ -0,0 +1,120 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <containers/darray.h>
+#include "renderer/renderbuffer.h"
+#include "resources/texture.hpp"
+#include "vulkan_command_buffer.hpp"
+
+class VulkanAPI;
+class VulkanImage;
+
+constexpr u8 VULKAN_STAGING_BATCH_COUNT = 3;                             // Количество разделов кольца. Пакет, отправленный в кадре N, освобождается не раньше кадра N + 3.
+constexpr u64 VULKAN_STAGING_PARTITION_SIZE = 32 * 1024 * 1024;          // Размер раздела кольца. Загрузки большего размера выполняются через отдельный промежуточный буфер.
+
+/// @brief Пакет загрузок, занимающий один раздел промежуточного кольца. Копирования новых текстур записываются
+/// в буфер очереди передачи (если она выделенная), остальные — в графический буфер. Все буферы пакета
+/// отправляются одной операцией при завершении кадра или при заполнении раздела.
+struct VulkanStagingBatch {
+    VulkanCommandBuffer TransferBuffer;                                   // Копирования на выделенной очереди передачи. Не используется, если очередь общая с графикой.
+    VulkanCommandBuffer AcquireBuffer;                                    // Барьеры получения владения для копирований очереди передачи.
+    VulkanCommandBuffer GraphicsBuffer;                                   // Копирования на графической очереди: буферы и перезапись существующих текстур.
+    DArray<VkImageMemoryBarrier> acquires;                                // Барьеры получения владения, записываемые в AcquireBuffer при отправке.
+    VkSemaphore semaphore;                                                // Сигнализирует графической очереди о завершении копирований очереди передачи.
+    VkFence fence;                                                        // Сигнализирует о завершении всего пакета.
+    u64 used;                                                             // Занятый объем раздела в байтах.
+    u64 ticket;                                                           // Порядковый номер пакета.
+    u32 TextureCount;                                                     // Количество загрузок текстур в пакете.
+    u32 GeometryCount;                                                    // Количество загрузок в буферы в пакете.
+    bool open;                                                            // Пакет принимает загрузки.
+    bool submitted;                                                       // Пакет отправлен, и его ограждение еще не проверено.
+
+    constexpr VulkanStagingBatch()
+    : TransferBuffer(), AcquireBuffer(), GraphicsBuffer(), acquires(), semaphore(), fence(), used(), ticket(), TextureCount(), GeometryCount(), open(false), submitted(false) {}
+};
+
+/// @brief Постоянно отображенное промежуточное кольцо, разделенное на VULKAN_STAGING_BATCH_COUNT разделов.
+/// @note Загрузки записываются только из основного потока, как и прежние одноразовые буферы команд.
+struct VulkanStagingRing {
+    RenderBuffer buffer;                                                  // Видимый хосту буфер на все разделы.
+    u8* mapped;                                                           // Постоянное отображение буфера.
+    u64 PartitionSize;
+    VkCommandPool TransferPool;                                           // Пул команд очереди передачи. VK_NULL_HANDLE, если очередь общая с графикой.
+    bool dedicated;                                                       // Используется ли выделенная очередь передачи.
+    VulkanStagingBatch batches[VULKAN_STAGING_BATCH_COUNT];
+    u8 current;                                                           // Индекс пакета, принимающего загрузки.
+    u64 NextTicket;                                                       // Номер последнего начатого пакета.
+    u64 SubmittedBytes;                                                   // Объем данных, отправленных с начала работы.
+    u32 StallCount;                                                       // Сколько раз загрузке пришлось ждать освобождения раздела.
+
+    constexpr VulkanStagingRing()
+    : buffer(), mapped(nullptr), PartitionSize(), TransferPool(), dedicated(false), batches(), current(), NextTicket(), SubmittedBytes(), StallCount() {}
+};
+
+/// @brief Создает промежуточное кольцо и объекты синхронизации его пакетов.
+/// @param VkAPI указатель на Vulkan.
+/// @param PartitionSize размер одного раздела в байтах.
+/// @param OutRing промежуточное кольцо.
+/// @return true в случае успеха; в противном случае false.
+bool VulkanStagingCreate(VulkanAPI* VkAPI, u64 PartitionSize, VulkanStagingRing& OutRing);
+
+/// @brief Отправляет незавершенный пакет, ожидает все пакеты и уничтожает кольцо.
+/// @param VkAPI указатель на Vulkan.
+/// @param ring промежуточное кольцо.
+void VulkanStagingDestroy(VulkanAPI* VkAPI, VulkanStagingRing& ring);
+
+/// @brief Копирует пиксели в кольцо и записывает загрузку всего изображения в текущий пакет.
+/// Изображение переводится в макет VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+/// @param VkAPI указатель на Vulkan.
+/// @param ring промежуточное кольцо.
+/// @param image изображение.
+/// @param type тип текстуры.
+/// @param TexelSize размер texel в байтах; определяет выравнивание смещения в кольце.
+/// @param size размер данных в байтах.
+/// @param pixels данные пикселей.
+/// @param IsNew изображение только что создано и еще не использовалось: его можно загрузить на очереди передачи.
+/// @return true, если загрузка записана; false, если данные не помещаются в раздел.
+bool VulkanStagingUploadImage(VulkanAPI* VkAPI, VulkanStagingRing& ring, VulkanImage* image, TextureType type, u32 TexelSize, u64 size, const void* pixels, bool IsNew);
+
+/// @brief Копирует пиксели в кольцо и записывает загрузку прямоугольной области двумерного изображения в текущий пакет.
+/// Изображение должно быть в макете VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL; остальное содержимое сохраняется.
+/// @param VkAPI указатель на Vulkan.
+/// @param ring промежуточное кольцо.
+/// @param image изображение.
+/// @param TexelSize размер texel в байтах.
+/// @param x левая граница области в пикселях.
+/// @param y верхняя граница области в пикселях.
+/// @param width ширина области в пикселях.
+/// @param height высота области в пикселях.
+/// @param pixels пиксели области построчно.
+/// @return true, если загрузка записана; false, если данные не помещаются в раздел.
+bool VulkanStagingUploadImageRegion(VulkanAPI* VkAPI, VulkanStagingRing& ring, VulkanImage* image, u32 TexelSize, u32 x, u32 y, u32 width, u32 height, const void* pixels);
+
+/// @brief Копирует данные в кольцо и записывает их загрузку в диапазон локального буфера устройства.
+/// @param VkAPI указатель на Vulkan.
+/// @param ring промежуточное кольцо.
+/// @param dest целевой буфер.
+/// @param offset смещение в целевом буфере.
+/// @param size размер данных в байтах.
+/// @param data данные.
+/// @return true, если загрузка записана; false, если данные не помещаются в раздел.
+bool VulkanStagingUploadBuffer(VulkanAPI* VkAPI, VulkanStagingRing& ring, VkBuffer dest, u64 offset, u64 size, const void* data);
+
+/// @brief Отправляет текущий пакет. Графическая часть пакета отправляется раньше буферов кадра, поэтому
+/// команды кадра видят загруженные данные.
+/// @param VkAPI указатель на Vulkan.
+/// @param ring промежуточное кольцо.
+/// @param wait ожидать ли завершения всех отправленных пакетов.
+/// @return true в случае успеха; в противном случае false.
+bool VulkanStagingFlush(VulkanAPI* VkAPI, VulkanStagingRing& ring, bool wait);
+
+/// @brief Проверяет ограждения отправленных пакетов и сообщает о завершенных событием RenderUploadsCompleted.
+/// @param VkAPI указатель на Vulkan.
+/// @param ring промежуточное кольцо.
+void VulkanStagingCollect(VulkanAPI* VkAPI, VulkanStagingRing& ring);
+
+/// @brief Возвращает номер пакета, в который попадет следующая загрузка.
+u64 VulkanStagingTicket(const VulkanStagingRing& ring);
+
+/// @brief Указывает, есть ли в кольце записанные, но не отправленные загрузки.
+MINLINE bool VulkanStagingHasPending(const VulkanStagingRing& ring) { return ring.batches[ring.current].open; }
@@ -0,0 +1,179 @@
+#include "vulkan_timestamps.hpp"
+#include "vulkan_api.h"
+#include "vulkan_utils.h"
+
+bool VulkanTimestampsCreate(VulkanAPI *VkAPI, VulkanTimestamps &OutTimestamps)
+{
+    auto& device = VkAPI->Device;
+
+    u32 FamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(device.PhysicalDevice, &FamilyCount, nullptr);
+    VkQueueFamilyProperties families[32];
+    FamilyCount = MMIN(FamilyCount, 32U);
+    vkGetPhysicalDeviceQueueFamilyProperties(device.PhysicalDevice, &FamilyCount, families);
+
+    const u32 ValidBits = device.GraphicsQueueIndex >= 0 && (u32)device.GraphicsQueueIndex < FamilyCount
+        ? families[device.GraphicsQueueIndex].timestampValidBits : 0;
+    const f32 period = device.properties.limits.timestampPeriod;
+    if (!ValidBits || period <= 0.F) {
+        MWARN("VulkanTimestampsCreate: графическая очередь не поддерживает метки времени, время проходов на GPU не измеряется.");
+        return false;
+    }
+
+    OutTimestamps.ValidMask = ValidBits >= 64 ? ~0ULL : (1ULL << ValidBits) - 1;
+    OutTimestamps.period = period;
+    OutTimestamps.FrameCount = MMIN((u32)VkAPI->swapchain.MaxFramesInFlight, (u32)VULKAN_MAX_FRAMES_IN_FLIGHT);
+
+    VkQueryPoolCreateInfo PoolCreateInfo = {VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+    PoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    PoolCreateInfo.queryCount = VULKAN_TIMESTAMP_MAX_PASSES * 2;
+    for (u32 i = 0; i < OutTimestamps.FrameCount; ++i) {
+        VK_CHECK(vkCreateQueryPool(device.LogicalDevice, &PoolCreateInfo, VkAPI->allocator, &OutTimestamps.frames[i].pool));
+    }
+
+    OutTimestamps.supported = true;
+    MINFO("Метки времени проходов: %u пулов по %u запросов, %u значащих битов, %.2f нс на деление.",
+          OutTimestamps.FrameCount, PoolCreateInfo.queryCount, ValidBits, period);
+    return true;
+}
+
+void VulkanTimestampsDestroy(VulkanAPI *VkAPI, VulkanTimestamps &timestamps)
+{
+    for (u32 i = 0; i < timestamps.FrameCount; ++i) {
+        auto& frame = timestamps.frames[i];
+        if (frame.pool) {
+            vkDestroyQueryPool(VkAPI->Device.LogicalDevice, frame.pool, VkAPI->allocator);
+            frame.pool = VK_NULL_HANDLE;
+        }
+    }
+    timestamps.supported = false;
+}
+
+void VulkanTimestampsReset(VulkanAPI *VkAPI, VulkanTimestamps &timestamps, VulkanCommandBuffer &CommandBuffer)
+{
+    if (!timestamps.supported || VkAPI->CurrentFrame >= timestamps.FrameCount) {
+        return;
+    }
+
+    auto& frame = timestamps.frames[VkAPI->CurrentFrame];
+    vkCmdResetQueryPool(CommandBuffer.handle, frame.pool, 0, VULKAN_TIMESTAMP_MAX_PASSES * 2);
+    frame.PassCount = 0;
+    frame.pending = true;
+}
+
+u32 VulkanTimestampsBegin(VulkanAPI *VkAPI, VulkanTimestamps &timestamps, VulkanCommandBuffer &CommandBuffer, const char *name)
+{
+    if (!timestamps.supported || VkAPI->CurrentFrame >= timestamps.FrameCount) {
+        return INVALID::ID;
+    }
+
+    auto& frame = timestamps.frames[VkAPI->CurrentFrame];
+    if (!frame.pending || frame.PassCount == VULKAN_TIMESTAMP_MAX_PASSES) {
+        return INVALID::ID;
+    }
+
+    // Статистика накапливается по имени прохода, поэтому пересозданный проход продолжает свою историю.
+    u32 pass = INVALID::ID;
+    for (u32 i = 0; i < timestamps.PassCount; ++i) {
+        if (MString::Equal(timestamps.passes[i].name, name)) {
+            pass = i;
+            break;
+        }
+    }
+    if (pass == INVALID::ID) {
+        if (timestamps.PassCount == VULKAN_TIMESTAMP_MAX_PASSES) {
+            return INVALID::ID;
+        }
+        pass = timestamps.PassCount++;
+        MString::Copy(timestamps.passes[pass].name, name ? name : "", VULKAN_TIMESTAMP_NAME_LENGTH - 1);
+    }
+
+    const u32 query = frame.PassCount++;
+    frame.passes[query] = pass;
+    vkCmdWriteTimestamp(CommandBuffer.handle, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.pool, query * 2);
+    return query;
+}
+
+void VulkanTimestampsEnd(VulkanAPI *VkAPI, VulkanTimestamps &timestamps, VulkanCommandBuffer &CommandBuffer, u32 query)
+{
+    if (query == INVALID::ID) {
+        return;
+    }
+    vkCmdWriteTimestamp(CommandBuffer.handle, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestamps.frames[VkAPI->CurrentFrame].pool, query * 2 + 1);
+}
+
+/// @brief Читает результаты одного кадра в полете.
+static void TimestampsCollectFrame(VulkanAPI *VkAPI, VulkanTimestamps &timestamps, VulkanTimestampFrame &frame)
+{
+    if (!frame.pending) {
+        return;
+    }
+    frame.pending = false;
+    if (!frame.PassCount) {
+        return;
+    }
+
+    // Пара значений на запрос: метка и признак доступности. Без VK_QUERY_RESULT_WAIT_BIT вызов не блокирует,
+    // а незаписанные запросы (например, проход не был завершен) просто пропускаются.
+    u64 results[VULKAN_TIMESTAMP_MAX_PASSES * 2 * 2];
+    const u32 QueryCount = frame.PassCount * 2;
+    VkResult result = vkGetQueryPoolResults(
+        VkAPI->Device.LogicalDevice, frame.pool, 0, QueryCount,
+        sizeof(u64) * 2 * QueryCount, results, sizeof(u64) * 2,
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (result != VK_SUCCESS && result != VK_NOT_READY) {
+        MWARN("VulkanTimestampsCollect: не удалось прочитать метки времени: %s", VulkanResultString(result, true));
+        return;
+    }
+
+    for (u32 q = 0; q < frame.PassCount; ++q) {
+        const u64* begin = &results[q * 4];
+        const u64* end = &results[q * 4 + 2];
+        if (!begin[1] || !end[1]) {
+            continue;
+        }
+
+        const u64 ticks = (end[0] - begin[0]) & timestamps.ValidMask;
+        const f64 ms = ticks * timestamps.period / 1000000.0;
+
+        auto& pass = timestamps.passes[frame.passes[q]];
+        pass.LastMs = ms;
+        pass.SampleSum += ms - pass.samples[pass.SampleIndex];
+        pass.samples[pass.SampleIndex] = ms;
+        pass.SampleIndex = (pass.SampleIndex + 1) % VULKAN_TIMESTAMP_AVERAGE_FRAMES;
+        if (pass.SampleCount < VULKAN_TIMESTAMP_AVERAGE_FRAMES) {
+            pass.SampleCount++;
+        }
+    }
+}
+
+void VulkanTimestampsCollect(VulkanAPI *VkAPI, VulkanTimestamps &timestamps, bool idle)
+{
+    if (!timestamps.supported) {
+        return;
+    }
+
+    if (idle) {
+        for (u32 i = 0; i < timestamps.FrameCount; ++i) {
+            TimestampsCollectFrame(VkAPI, timestamps, timestamps.frames[i]);
+        }
+    } else if (VkAPI->CurrentFrame < timestamps.FrameCount) {
+        TimestampsCollectFrame(VkAPI, timestamps, timestamps.frames[VkAPI->CurrentFrame]);
+    }
+}
+
+u32 VulkanTimestampsQuery(const VulkanTimestamps &timestamps, GpuPassTiming *OutTimings, u32 MaxCount)
+{
+    u32 count = 0;
+    for (u32 i = 0; i < timestamps.PassCount && count < MaxCount; ++i) {
+        const auto& pass = timestamps.passes[i];
+        if (!pass.SampleCount) {
+            continue;
+        }
+        auto& timing = OutTimings[count++];
+        timing.name = pass.name;
+        timing.LastMs = pass.LastMs;
+        timing.AverageMs = pass.SampleSum / pass.SampleCount;
+    }
+    return count;
+}
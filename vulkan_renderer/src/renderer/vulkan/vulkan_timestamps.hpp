@@ -0,0 +1,93 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include "renderer/renderer_types.h"
+#include "vulkan_command_buffer.hpp"
+#include "vulkan_recording.hpp"
+
+class VulkanAPI;
+
+constexpr u32 VULKAN_TIMESTAMP_MAX_PASSES = GPU_PASS_TIMING_MAX;         // Максимальное количество измеряемых проходов за кадр.
+constexpr u32 VULKAN_TIMESTAMP_AVERAGE_FRAMES = 30;                      // Количество кадров в скользящем среднем времени прохода.
+constexpr u32 VULKAN_TIMESTAMP_NAME_LENGTH = 32;                         // Длина сохраняемого имени прохода вместе с нулевым символом.
+
+/// @brief Запросы меток времени одного кадра в полете. Проход занимает два соседних запроса: начало и конец.
+struct VulkanTimestampFrame {
+    VkQueryPool pool;
+    u32 PassCount;                                                        // Количество проходов, начатых в кадре.
+    u32 passes[VULKAN_TIMESTAMP_MAX_PASSES];                              // Индекс статистики прохода для каждой пары запросов.
+    bool pending;                                                         // Кадр записан, а результаты еще не прочитаны.
+
+    constexpr VulkanTimestampFrame() : pool(), PassCount(), passes(), pending(false) {}
+};
+
+/// @brief Статистика времени выполнения прохода на GPU.
+struct VulkanTimestampPass {
+    char name[VULKAN_TIMESTAMP_NAME_LENGTH];
+    f64 LastMs;                                                           // Время прохода в последнем прочитанном кадре.
+    f64 samples[VULKAN_TIMESTAMP_AVERAGE_FRAMES];
+    f64 SampleSum;
+    u32 SampleIndex;
+    u32 SampleCount;
+
+    constexpr VulkanTimestampPass() : name(), LastMs(), samples(), SampleSum(), SampleIndex(), SampleCount() {}
+};
+
+/// @brief Метки времени проходов рендеринга. Проходы обрамляются метками в основном буфере команд кадра,
+/// а результаты читаются без ожидания после ограждения того же кадра в полете, то есть через столько кадров, сколько их в полете.
+struct VulkanTimestamps {
+    VulkanTimestampFrame frames[VULKAN_MAX_FRAMES_IN_FLIGHT];
+    u32 FrameCount;
+    VulkanTimestampPass passes[VULKAN_TIMESTAMP_MAX_PASSES];
+    u32 PassCount;                                                        // Количество проходов, встречавшихся с начала работы.
+    u64 ValidMask;                                                        // Маска значащих битов метки времени графической очереди.
+    f64 period;                                                           // Наносекунд на одно деление метки времени.
+    bool supported;
+
+    constexpr VulkanTimestamps() : frames(), FrameCount(), passes(), PassCount(), ValidMask(), period(), supported(false) {}
+};
+
+/// @brief Создает пулы запросов меток времени, по одному на кадр в полете.
+/// @param VkAPI указатель на Vulkan.
+/// @param OutTimestamps метки времени.
+/// @return true в случае успеха; false, если устройство не поддерживает метки времени на графической очереди.
+bool VulkanTimestampsCreate(VulkanAPI* VkAPI, VulkanTimestamps& OutTimestamps);
+
+/// @brief Уничтожает пулы запросов. Устройство должно быть свободно.
+/// @param VkAPI указатель на Vulkan.
+/// @param timestamps метки времени.
+void VulkanTimestampsDestroy(VulkanAPI* VkAPI, VulkanTimestamps& timestamps);
+
+/// @brief Сбрасывает запросы текущего кадра в полете. Вызывается в начале записи буфера кадра, вне прохода рендеринга.
+/// @param VkAPI указатель на Vulkan.
+/// @param timestamps метки времени.
+/// @param CommandBuffer основной буфер команд кадра.
+void VulkanTimestampsReset(VulkanAPI* VkAPI, VulkanTimestamps& timestamps, VulkanCommandBuffer& CommandBuffer);
+
+/// @brief Записывает метку начала прохода. Вызывается только основным потоком.
+/// @param VkAPI указатель на Vulkan.
+/// @param timestamps метки времени.
+/// @param CommandBuffer основной буфер команд кадра.
+/// @param name имя прохода, по которому накапливается статистика.
+/// @return индекс пары запросов для VulkanTimestampsEnd; INVALID::ID, если метки не поддерживаются или запросы кадра закончились.
+u32 VulkanTimestampsBegin(VulkanAPI* VkAPI, VulkanTimestamps& timestamps, VulkanCommandBuffer& CommandBuffer, const char* name);
+
+/// @brief Записывает метку конца прохода.
+/// @param VkAPI указатель на Vulkan.
+/// @param timestamps метки времени.
+/// @param CommandBuffer основной буфер команд кадра.
+/// @param query индекс пары запросов, полученный от VulkanTimestampsBegin.
+void VulkanTimestampsEnd(VulkanAPI* VkAPI, VulkanTimestamps& timestamps, VulkanCommandBuffer& CommandBuffer, u32 query);
+
+/// @brief Читает результаты кадров, ограждение которых уже дождались, и обновляет статистику проходов. Не ждет GPU.
+/// @param VkAPI указатель на Vulkan.
+/// @param timestamps метки времени.
+/// @param idle устройство свободно, поэтому можно прочитать все записанные кадры.
+void VulkanTimestampsCollect(VulkanAPI* VkAPI, VulkanTimestamps& timestamps, bool idle);
+
+/// @brief Копирует статистику проходов.
+/// @param timestamps метки времени.
+/// @param OutTimings массив для результатов.
+/// @param MaxCount размер массива.
+/// @return количество записанных проходов.
+u32 VulkanTimestampsQuery(const VulkanTimestamps& timestamps, GpuPassTiming* OutTimings, u32 MaxCount);
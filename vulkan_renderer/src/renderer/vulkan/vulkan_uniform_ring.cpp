@@ -0,0 +1,67 @@
+#include "vulkan_uniform_ring.hpp"
+#include "vulkan_api.h"
+
+bool VulkanUniformRingCreate(VulkanAPI *VkAPI, u64 PartitionSize, VulkanUniformRing &OutRing)
+{
+    OutRing.alignment = MMAX(VkAPI->Device.properties.limits.minUniformBufferOffsetAlignment, (VkDeviceSize)16);
+    OutRing.PartitionSize = Range::GetAligned(PartitionSize, OutRing.alignment);
+    OutRing.FrameCount = MMIN((u32)VkAPI->swapchain.MaxFramesInFlight, (u32)VULKAN_MAX_FRAMES_IN_FLIGHT);
+
+    OutRing.buffer.name = "renderbuffer_uniform_ring";
+    OutRing.buffer.type = RenderBufferType::Uniform;
+    OutRing.buffer.TotalSize = OutRing.PartitionSize * OutRing.FrameCount;
+    if (!VkAPI->RenderBufferCreateInternal(OutRing.buffer)) {
+        MERROR("VulkanUniformRingCreate — не удалось создать буфер кольца униформ.");
+        return false;
+    }
+    VkAPI->RenderBufferBind(OutRing.buffer, 0);
+    OutRing.mapped = reinterpret_cast<u8*>(VkAPI->RenderBufferMapMemory(OutRing.buffer, 0, VK_WHOLE_SIZE));
+
+    MINFO("Кольцо униформ: %u разделов по %llu МБ, выравнивание %llu байт.", OutRing.FrameCount, OutRing.PartitionSize / (1024 * 1024), OutRing.alignment);
+    return true;
+}
+
+void VulkanUniformRingDestroy(VulkanAPI *VkAPI, VulkanUniformRing &ring)
+{
+    if (!ring.mapped) {
+        return;
+    }
+
+    VkAPI->RenderBufferUnmapMemory(ring.buffer, 0, VK_WHOLE_SIZE);
+    VkAPI->RenderBufferDestroyInternal(ring.buffer);
+    ring.mapped = nullptr;
+}
+
+void VulkanUniformRingBegin(VulkanUniformRing &ring, u32 FrameIndex)
+{
+    ring.current = {};
+    ring.partition = FrameIndex < ring.FrameCount ? FrameIndex : 0;
+    ring.used = 0;
+    ring.FrameNumber++;
+}
+
+void VulkanUniformRingEnd(VulkanUniformRing &ring)
+{
+    ring.last = ring.current;
+    if (ring.current.Overflows) {
+        MWARN("Кольцо униформ: %u применений не поместились в раздел %llu МБ.", ring.current.Overflows, ring.PartitionSize / (1024 * 1024));
+    }
+}
+
+bool VulkanUniformRingPush(VulkanUniformRing &ring, const void *data, u64 size, u32 &OutOffset)
+{
+    const u64 AlignedSize = Range::GetAligned(size, ring.alignment);
+    const u64 offset = __atomic_fetch_add(&ring.used, AlignedSize, __ATOMIC_RELAXED);
+    if (!ring.mapped || offset + AlignedSize > ring.PartitionSize) {
+        __atomic_fetch_add(&ring.current.Overflows, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    const u64 address = ring.partition * ring.PartitionSize + offset;
+    MemorySystem::CopyMem(ring.mapped + address, data, size);
+    OutOffset = static_cast<u32>(address);
+
+    __atomic_fetch_add(&ring.current.BytesUploaded, size, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&ring.current.Allocations, 1, __ATOMIC_RELAXED);
+    return true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include "renderer/renderbuffer.h"
+#include "renderer/renderer_types.h"
+#include "vulkan_recording.hpp"
+
+class VulkanAPI;
+
+constexpr u64 VULKAN_UNIFORM_RING_PARTITION_SIZE = 8 * 1024 * 1024;      // Размер раздела кольца униформ, по одному разделу на кадр в полете.
+
+/// @brief Постоянно отображенное кольцо униформ. Глобальные данные и данные экземпляров шейдеров дописываются
+/// в раздел текущего кадра подряд и привязываются динамическими смещениями, поэтому наборы дескрипторов
+/// указывают на кольцо один раз, а данные кадра не перезаписываются, пока GPU читает предыдущие кадры.
+/// @note Выделение атомарно: униформы применяются и на потоках записи команд.
+struct VulkanUniformRing {
+    RenderBuffer buffer;                                                  // Видимый хосту универсальный буфер на все разделы.
+    u8* mapped;                                                           // Постоянное отображение буфера.
+    u64 PartitionSize;
+    u64 alignment;                                                        // Выравнивание динамических смещений, minUniformBufferOffsetAlignment устройства.
+    u32 FrameCount;                                                       // Количество разделов.
+    u32 partition;                                                        // Раздел текущего кадра.
+    u64 FrameNumber;                                                      // Номер кадра кольца. Выделение действительно только в кадре, в котором сделано.
+    u64 used;                                                             // Занятый объем раздела текущего кадра.
+    UniformUploadStats current;                                           // Статистика текущего кадра.
+    UniformUploadStats last;                                              // Статистика последнего завершенного кадра.
+
+    constexpr VulkanUniformRing()
+    : buffer(), mapped(nullptr), PartitionSize(), alignment(), FrameCount(), partition(), FrameNumber(1), used(), current(), last() {}
+};
+
+/// @brief Создает и отображает кольцо униформ.
+/// @param VkAPI указатель на Vulkan.
+/// @param PartitionSize размер раздела одного кадра в байтах.
+/// @param OutRing кольцо униформ.
+/// @return true в случае успеха; в противном случае false.
+bool VulkanUniformRingCreate(VulkanAPI* VkAPI, u64 PartitionSize, VulkanUniformRing& OutRing);
+
+/// @brief Уничтожает кольцо униформ. Устройство должно быть свободно.
+/// @param VkAPI указатель на Vulkan.
+/// @param ring кольцо униформ.
+void VulkanUniformRingDestroy(VulkanAPI* VkAPI, VulkanUniformRing& ring);
+
+/// @brief Начинает кадр: переключается на раздел кадра в полете и сбрасывает статистику кадра.
+/// Вызывается после ожидания ограждения кадра, когда GPU уже не читает этот раздел.
+/// @param ring кольцо униформ.
+/// @param FrameIndex индекс кадра в полете.
+void VulkanUniformRingBegin(VulkanUniformRing& ring, u32 FrameIndex);
+
+/// @brief Завершает кадр: сохраняет его статистику как статистику последнего завершенного кадра.
+/// @param ring кольцо униформ.
+void VulkanUniformRingEnd(VulkanUniformRing& ring);
+
+/// @brief Копирует данные в раздел текущего кадра.
+/// @param ring кольцо униформ.
+/// @param data данные.
+/// @param size размер данных в байтах; выделяется с выравниванием кольца.
+/// @param OutOffset динамическое смещение данных от начала буфера.
+/// @return true в случае успеха; false, если раздел кадра заполнен.
+bool VulkanUniformRingPush(VulkanUniformRing& ring, const void* data, u64 size, u32& OutOffset);
+
+/// @brief Учитывает записи дескрипторов в статистике кадра.
+/// @param ring кольцо униформ.
+/// @param count количество записанных дескрипторов.
+MINLINE void VulkanUniformRingCountDescriptorUpdates(VulkanUniformRing& ring, u32 count) { __atomic_fetch_add(&ring.current.DescriptorUpdates, count, __ATOMIC_RELAXED); }